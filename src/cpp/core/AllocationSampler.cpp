@@ -0,0 +1,251 @@
+/*
+ * AllocationSampler.cpp
+ *
+ * Copyright (C) 2009-16 by RStudio, Inc.
+ *
+ * Unless you have received this program directly from RStudio pursuant
+ * to the terms of a commercial license agreement with RStudio, then
+ * this program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http://www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ *
+ */
+
+#include <core/AllocationSampler.hpp>
+
+#if defined(RSTUDIO_ALLOCATION_SAMPLER) && !defined(_WIN32)
+
+#include <execinfo.h>
+#include <pthread.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <new>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <core/Backtrace.hpp>
+
+namespace {
+
+const int kMaxFrames = 16;
+const int kRingSize = 4096;
+
+struct SampledAllocation
+{
+   void* frames[kMaxFrames];
+   int frameCount;
+   std::size_t size;
+};
+
+// ring buffer and sampler state. NOTE: this code runs inside operator
+// new so it can't use the usual core synchronization helpers (they
+// allocate) -- raw pthread primitives and plain statics only
+SampledAllocation s_ring[kRingSize];
+int s_ringPos = 0;
+pthread_mutex_t s_ringMutex = PTHREAD_MUTEX_INITIALIZER;
+volatile bool s_active = false;
+unsigned s_interval = 0;
+
+// per-thread allocation countdown and re-entrancy guard (backtrace
+// and backtrace_symbols allocate internally)
+__thread unsigned t_allocCount = 0;
+__thread bool t_inHook = false;
+
+void recordAllocation(std::size_t size)
+{
+   if (!s_active || t_inHook)
+      return;
+
+   if (++t_allocCount < s_interval)
+      return;
+   t_allocCount = 0;
+
+   t_inHook = true;
+
+   // capture the stack outside the lock
+   SampledAllocation sample;
+   sample.size = size;
+   sample.frameCount = ::backtrace(sample.frames, kMaxFrames);
+
+   ::pthread_mutex_lock(&s_ringMutex);
+   s_ring[s_ringPos] = sample;
+   s_ringPos = (s_ringPos + 1) % kRingSize;
+   ::pthread_mutex_unlock(&s_ringMutex);
+
+   t_inHook = false;
+}
+
+// symbolize a single frame, demangling the function name embedded in
+// the backtrace_symbols output ("module(mangled+0xNN) [0xADDR]")
+std::string symbolizeFrame(void* addr)
+{
+   char** symbols = ::backtrace_symbols(&addr, 1);
+   if (symbols == NULL)
+      return std::string();
+   std::string result(symbols[0] != NULL ? symbols[0] : "");
+   ::free(symbols);
+
+   std::size_t begin = result.find('(');
+   std::size_t end = result.find('+', begin != std::string::npos ? begin : 0);
+   if (begin != std::string::npos && end != std::string::npos &&
+       end > begin + 1)
+   {
+      std::string name = result.substr(begin + 1, end - begin - 1);
+      result = result.substr(0, begin + 1) +
+               rstudio::core::backtrace::demangle(name) +
+               result.substr(end);
+   }
+   return result;
+}
+
+// per-callsite aggregate
+struct StackTotals
+{
+   StackTotals() : count(0), bytes(0) {}
+   unsigned count;
+   std::size_t bytes;
+};
+
+typedef std::map<std::vector<void*>, StackTotals> StackMap;
+
+bool bytesGreaterThan(const std::pair<std::vector<void*>, StackTotals>& a,
+                      const std::pair<std::vector<void*>, StackTotals>& b)
+{
+   return a.second.bytes > b.second.bytes;
+}
+
+} // anonymous namespace
+
+// global operator new/delete replacements. these are pulled into the
+// final link because initialize() (below, same translation unit) is
+// referenced from session startup when the sampler is compiled in
+void* operator new(std::size_t size) throw (std::bad_alloc)
+{
+   void* p = ::malloc(size != 0 ? size : 1);
+   if (p == NULL)
+      throw std::bad_alloc();
+   recordAllocation(size);
+   return p;
+}
+
+void* operator new[](std::size_t size) throw (std::bad_alloc)
+{
+   void* p = ::malloc(size != 0 ? size : 1);
+   if (p == NULL)
+      throw std::bad_alloc();
+   recordAllocation(size);
+   return p;
+}
+
+void operator delete(void* p) throw ()
+{
+   if (p != NULL)
+      ::free(p);
+}
+
+void operator delete[](void* p) throw ()
+{
+   if (p != NULL)
+      ::free(p);
+}
+
+namespace rstudio {
+namespace core {
+namespace allocation_sampler {
+
+void initialize(unsigned interval)
+{
+   if (interval == 0)
+      interval = 1;
+   s_interval = interval;
+   s_active = true;
+}
+
+bool enabled()
+{
+   return s_active;
+}
+
+void dump(std::ostream& os)
+{
+   // snapshot the ring buffer
+   std::vector<SampledAllocation> samples;
+   samples.reserve(kRingSize);
+   ::pthread_mutex_lock(&s_ringMutex);
+   for (int i = 0; i < kRingSize; i++)
+   {
+      if (s_ring[i].frameCount > 0)
+         samples.push_back(s_ring[i]);
+   }
+   ::pthread_mutex_unlock(&s_ringMutex);
+
+   // aggregate by call stack
+   StackMap stacks;
+   for (std::size_t i = 0; i < samples.size(); i++)
+   {
+      std::vector<void*> key(samples[i].frames,
+                             samples[i].frames + samples[i].frameCount);
+      StackTotals& totals = stacks[key];
+      totals.count++;
+      totals.bytes += samples[i].size;
+   }
+
+   // order by sampled bytes
+   std::vector<std::pair<std::vector<void*>, StackTotals> > ordered(
+                                             stacks.begin(), stacks.end());
+   std::sort(ordered.begin(), ordered.end(), bytesGreaterThan);
+
+   os << "Sampled allocation profile (" << samples.size()
+      << " samples, 1 in " << s_interval << " allocations)\n\n";
+
+   for (std::size_t i = 0; i < ordered.size(); i++)
+   {
+      os << ordered[i].second.bytes << " bytes in "
+         << ordered[i].second.count << " samples:\n";
+
+      const std::vector<void*>& frames = ordered[i].first;
+
+      // skip the first two frames (recordAllocation and operator new)
+      for (std::size_t f = 2; f < frames.size(); f++)
+         os << "   " << symbolizeFrame(frames[f]) << "\n";
+      os << "\n";
+   }
+}
+
+} // namespace allocation_sampler
+} // namespace core
+} // namespace rstudio
+
+#else // sampler not compiled in -- everything is a no-op
+
+#include <ostream>
+
+namespace rstudio {
+namespace core {
+namespace allocation_sampler {
+
+void initialize(unsigned)
+{
+}
+
+bool enabled()
+{
+   return false;
+}
+
+void dump(std::ostream&)
+{
+}
+
+} // namespace allocation_sampler
+} // namespace core
+} // namespace rstudio
+
+#endif
@@ -0,0 +1,158 @@
+/*
+ * AsyncLogWriter.cpp
+ *
+ * Copyright (C) 2009-12 by RStudio, Inc.
+ *
+ * Unless you have received this program directly from RStudio pursuant
+ * to the terms of a commercial license agreement with RStudio, then
+ * this program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http://www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ *
+ */
+
+#include <core/AsyncLogWriter.hpp>
+
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <core/Thread.hpp>
+
+namespace rstudio {
+namespace core {
+
+namespace {
+
+// maximum number of messages buffered ahead of the writer thread
+// (messages beyond this are dropped and accounted for in a summary
+// message written once the backlog clears)
+const std::size_t kMaxPendingEntries = 2000;
+
+// maximum time a queued message waits before it is written
+const long kFlushIntervalMs = 100;
+
+} // anonymous namespace
+
+AsyncLogWriter::AsyncLogWriter(boost::shared_ptr<LogWriter> pTarget)
+   : pTarget_(pTarget),
+     droppedEntries_(0),
+     stopRequested_(false)
+{
+   core::thread::safeLaunchThread(
+            boost::bind(&AsyncLogWriter::writerThread, this),
+            &thread_);
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+   try
+   {
+      LOCK_MUTEX(mutex_)
+      {
+         stopRequested_ = true;
+      }
+      END_LOCK_MUTEX
+      condition_.notify_all();
+
+      if (thread_.joinable())
+         thread_.join();
+   }
+   catch(...)
+   {
+   }
+}
+
+void AsyncLogWriter::log(core::system::LogLevel level,
+                         const std::string& message)
+{
+   log(std::string(), level, message);
+}
+
+void AsyncLogWriter::log(const std::string& programIdentity,
+                         core::system::LogLevel level,
+                         const std::string& message)
+{
+   LogEntry entry;
+   entry.programIdentity = programIdentity;
+   entry.level = level;
+   entry.message = message;
+
+   LOCK_MUTEX(mutex_)
+   {
+      if (pendingEntries_.size() < kMaxPendingEntries)
+         pendingEntries_.push_back(entry);
+      else
+         droppedEntries_++;
+   }
+   END_LOCK_MUTEX
+
+   condition_.notify_one();
+}
+
+void AsyncLogWriter::setLogToStderr(bool logToStderr)
+{
+   pTarget_->setLogToStderr(logToStderr);
+}
+
+void AsyncLogWriter::writerThread()
+{
+   try
+   {
+      while (true)
+      {
+         // wait for work (or for the periodic flush interval to
+         // elapse) then take ownership of the pending entries
+         std::deque<LogEntry> entries;
+         unsigned int dropped = 0;
+         bool stop = false;
+         {
+            boost::unique_lock<boost::mutex> lock(mutex_);
+            while (pendingEntries_.empty() && !stopRequested_)
+            {
+               condition_.timed_wait(
+                  lock,
+                  boost::posix_time::milliseconds(kFlushIntervalMs));
+            }
+
+            entries.swap(pendingEntries_);
+            std::swap(dropped, droppedEntries_);
+            stop = stopRequested_;
+         }
+
+         // write the batch (outside the lock so logging threads
+         // never block on the target writer)
+         BOOST_FOREACH(const LogEntry& entry, entries)
+         {
+            if (entry.programIdentity.empty())
+               pTarget_->log(entry.level, entry.message);
+            else
+               pTarget_->log(entry.programIdentity,
+                             entry.level,
+                             entry.message);
+         }
+
+         if (dropped > 0)
+         {
+            pTarget_->log(
+               core::system::kLogLevelWarning,
+               "dropped " + boost::lexical_cast<std::string>(dropped) +
+               " log message(s) (log buffer full)");
+         }
+
+         if (stop)
+            return;
+      }
+   }
+   catch(...)
+   {
+      // can't log the failure (we are the logger) so just exit the
+      // thread -- subsequent messages will queue until the buffer
+      // fills and then be dropped
+   }
+}
+
+} // namespace core
+} // namespace rstudio
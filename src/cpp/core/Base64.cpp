@@ -76,12 +76,16 @@ public:
    
    Error operator()(const Byte* pData, std::size_t n, std::string* pOutput)
    {
+      // encode directly into the output string -- for large payloads
+      // (e.g. multi-MB plot images) a separate scratch buffer would
+      // mean an extra allocation plus a full-size copy
       std::size_t size = encoded_size(n);
-      boost::scoped_array<Byte> pBuffer(new Byte[size + 1]);
-      pBuffer[size] = '\0';
-      
+      pOutput->resize(size);
+      if (size == 0)
+         return Success();
+
       Byte* pTable = &table_[0];
-      Byte* it = pBuffer.get();
+      Byte* it = reinterpret_cast<Byte*>(&(*pOutput)[0]);
       while (n >= 3)
       {
          *it++ = pTable[pData[0] >> 2];
@@ -110,7 +114,6 @@ public:
       *it++ = '=';
 
 FINISH:
-      pOutput->assign((const char*) pBuffer.get(), size);
       return Success();
    }
 
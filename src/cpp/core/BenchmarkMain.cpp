@@ -0,0 +1,277 @@
+/*
+ * BenchmarkMain.cpp
+ *
+ * Copyright (C) 2009-12 by RStudio, Inc.
+ *
+ * Unless you have received this program directly from RStudio pursuant
+ * to the terms of a commercial license agreement with RStudio, then
+ * this program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http://www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ *
+ */
+
+// Micro-benchmarks for hot core primitives. Each benchmark runs a fixed
+// number of warmup iterations followed by timed iterations, and results
+// are written to stdout as json (one object per benchmark with iteration
+// count, total time, and per-operation time) so runs from successive
+// releases can be compared mechanically:
+//
+//    rstudio-core-benchmarks > results.json
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <core/Base64.hpp>
+#include <core/Error.hpp>
+#include <core/FileInfo.hpp>
+#include <core/FilePath.hpp>
+#include <core/FileSerializer.hpp>
+#include <core/Log.hpp>
+#include <core/SafeConvert.hpp>
+#include <core/json/Json.hpp>
+#include <core/http/Request.hpp>
+#include <core/http/RequestParser.hpp>
+#include <core/r_util/RTokenizer.hpp>
+#include <core/system/FileScanner.hpp>
+
+using namespace rstudio;
+using namespace rstudio::core;
+
+namespace {
+
+const int kWarmupIterations = 20;
+const int kTimedIterations = 500;
+
+// benchmark fixtures (built once, before timing begins)
+std::string s_jsonInput;
+json::Value s_jsonValue;
+std::string s_httpRequest;
+std::wstring s_rCode;
+std::string s_base64Input;
+FilePath s_scanDir;
+
+void buildFixtures()
+{
+   // moderately sized json document (shaped like an rpc request)
+   json::Object object;
+   object["method"] = "save_document";
+   json::Array params;
+   for (int i = 0; i < 100; i++)
+   {
+      json::Object param;
+      param["index"] = i;
+      param["name"] = "parameter-name-" + safe_convert::numberToString(i);
+      param["value"] = std::string(100, 'x');
+      params.push_back(param);
+   }
+   object["params"] = params;
+   s_jsonValue = object;
+   std::ostringstream ostr;
+   json::write(s_jsonValue, ostr);
+   s_jsonInput = ostr.str();
+
+   // typical browser request
+   s_httpRequest =
+      "POST /rpc/save_document HTTP/1.1\r\n"
+      "Host: localhost:8787\r\n"
+      "Connection: keep-alive\r\n"
+      "Content-Type: application/json\r\n"
+      "Accept-Encoding: gzip, deflate\r\n"
+      "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36\r\n"
+      "Cookie: user-id=user|Thu%2C%2001%20Jan%202015; csrf-token=abcdef\r\n"
+      "Content-Length: 16\r\n"
+      "\r\n"
+      "{\"params\": [42]}";
+
+   // representative chunk of R code
+   std::wstring rFragment =
+      L"add <- function(x, y = 1) {\n"
+      L"   # add two values\n"
+      L"   if (!is.numeric(x)) stop(\"x must be numeric\")\n"
+      L"   x + y * 2.5e-1\n"
+      L"}\n"
+      L"result <- vapply(seq_len(100), add, numeric(1), y = 2L)\n";
+   for (int i = 0; i < 20; i++)
+      s_rCode += rFragment;
+
+   // 64k of binary-ish data
+   s_base64Input.reserve(64 * 1024);
+   for (int i = 0; i < 64 * 1024; i++)
+      s_base64Input.push_back(static_cast<char>(i % 251));
+}
+
+Error buildScanDir()
+{
+   Error error = FilePath::tempFilePath(&s_scanDir);
+   if (error)
+      return error;
+   error = s_scanDir.ensureDirectory();
+   if (error)
+      return error;
+
+   for (int dir = 0; dir < 10; dir++)
+   {
+      FilePath subDir = s_scanDir.complete(
+                           "dir-" + safe_convert::numberToString(dir));
+      error = subDir.ensureDirectory();
+      if (error)
+         return error;
+      for (int file = 0; file < 20; file++)
+      {
+         FilePath filePath = subDir.complete(
+                           "file-" + safe_convert::numberToString(file));
+         error = writeStringToFile(filePath, "contents");
+         if (error)
+            return error;
+      }
+   }
+   return Success();
+}
+
+// individual benchmarks -- each performs one operation per call
+
+void benchmarkJsonParse()
+{
+   json::Value value;
+   if (!json::parse(s_jsonInput, &value))
+      std::cerr << "json parse failed" << std::endl;
+}
+
+void benchmarkJsonWrite()
+{
+   std::ostringstream ostr;
+   json::write(s_jsonValue, ostr);
+}
+
+void benchmarkRequestParser()
+{
+   http::RequestParser parser;
+   http::Request request;
+   http::RequestParser::status status = parser.parse(
+                                             request,
+                                             s_httpRequest.data(),
+                                             s_httpRequest.data() +
+                                                s_httpRequest.size());
+   if (status != http::RequestParser::complete)
+      std::cerr << "request parse failed" << std::endl;
+}
+
+void benchmarkRTokenizer()
+{
+   r_util::RTokenizer tokenizer(s_rCode);
+   r_util::RToken token;
+   int count = 0;
+   while ((token = tokenizer.nextToken()))
+      count++;
+   if (count == 0)
+      std::cerr << "tokenizer produced no tokens" << std::endl;
+}
+
+void benchmarkFilePathOperations()
+{
+   FilePath path("/usr/local/share/doc/package/README.md");
+   FilePath completed = path.parent().complete("sub/dir/file.txt");
+   if (completed.extensionLowerCase() != ".txt" ||
+       path.stem() != "README" ||
+       completed.isWithin(path))
+   {
+      std::cerr << "unexpected file path results" << std::endl;
+   }
+}
+
+void benchmarkBase64Encode()
+{
+   std::string encoded;
+   Error error = base64::encode(s_base64Input, &encoded);
+   if (error)
+      std::cerr << "base64 encode failed" << std::endl;
+}
+
+void benchmarkScanFiles()
+{
+   tree<FileInfo> scannedFiles;
+   core::system::FileScannerOptions options;
+   options.recursive = true;
+   Error error = core::system::scanFiles(FileInfo(s_scanDir),
+                                         options,
+                                         &scannedFiles);
+   if (error)
+      std::cerr << "scan files failed" << std::endl;
+}
+
+json::Object runBenchmark(const std::string& name,
+                          const boost::function<void()>& benchmark,
+                          int iterations)
+{
+   using namespace boost::posix_time;
+
+   for (int i = 0; i < kWarmupIterations; i++)
+      benchmark();
+
+   ptime startTime = microsec_clock::universal_time();
+   for (int i = 0; i < iterations; i++)
+      benchmark();
+   double totalMicros = (microsec_clock::universal_time() - startTime)
+                                                   .total_microseconds();
+
+   json::Object resultJson;
+   resultJson["name"] = name;
+   resultJson["iterations"] = iterations;
+   resultJson["total_us"] = totalMicros;
+   resultJson["per_op_us"] = totalMicros / iterations;
+   return resultJson;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+   buildFixtures();
+   Error error = buildScanDir();
+   if (error)
+   {
+      std::cerr << error.summary() << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   json::Array resultsJson;
+   resultsJson.push_back(runBenchmark("json_parse",
+                                      benchmarkJsonParse,
+                                      kTimedIterations));
+   resultsJson.push_back(runBenchmark("json_write",
+                                      benchmarkJsonWrite,
+                                      kTimedIterations));
+   resultsJson.push_back(runBenchmark("http_request_parser",
+                                      benchmarkRequestParser,
+                                      kTimedIterations));
+   resultsJson.push_back(runBenchmark("r_tokenizer",
+                                      benchmarkRTokenizer,
+                                      kTimedIterations));
+   resultsJson.push_back(runBenchmark("file_path_operations",
+                                      benchmarkFilePathOperations,
+                                      kTimedIterations));
+   resultsJson.push_back(runBenchmark("base64_encode",
+                                      benchmarkBase64Encode,
+                                      kTimedIterations));
+   // directory scans are comparatively slow, use fewer iterations
+   resultsJson.push_back(runBenchmark("scan_files",
+                                      benchmarkScanFiles,
+                                      kTimedIterations / 10));
+
+   json::writeFormatted(resultsJson, std::cout);
+   std::cout << std::endl;
+
+   Error removeError = s_scanDir.remove();
+   if (removeError)
+      LOG_ERROR(removeError);
+
+   return EXIT_SUCCESS;
+}
@@ -22,6 +22,7 @@
 #include <core/SafeConvert.hpp>
 
 #include <boost/lexical_cast.hpp>
+#include <boost/pool/singleton_pool.hpp>
 
 #ifdef _WIN32
 #include <boost/system/windows_error.hpp>
@@ -36,8 +37,40 @@ struct Error::Impl
    ErrorProperties properties ;
    Error cause ;
    ErrorLocation location ;
+
+   // pooled allocation (errors are created constantly -- including
+   // "expected" errors from file probes during directory scans -- so
+   // avoid a trip to the global heap for each one)
+   void* operator new(std::size_t size);
+   void operator delete(void* pMem, std::size_t size);
 };
 
+void* Error::Impl::operator new(std::size_t size)
+{
+   typedef boost::singleton_pool<Impl, sizeof(Impl)> Pool;
+
+   if (size != sizeof(Impl))
+      return ::operator new(size);
+
+   void* pMem = Pool::malloc();
+   if (pMem == NULL)
+      throw std::bad_alloc();
+   return pMem;
+}
+
+void Error::Impl::operator delete(void* pMem, std::size_t size)
+{
+   typedef boost::singleton_pool<Impl, sizeof(Impl)> Pool;
+
+   if (pMem == NULL)
+      return;
+
+   if (size != sizeof(Impl))
+      ::operator delete(pMem);
+   else
+      Pool::free(pMem);
+}
+
 Error::Error()
    : pImpl_()
 {
@@ -244,22 +277,67 @@ Error pathNotFoundError(const std::string& path, const ErrorLocation& location)
    return error;
 }
    
-struct ErrorLocation::Impl 
+struct ErrorLocation::Impl
 {
-   Impl() : line(0) 
+   Impl() : functionPtr(""), filePtr(""), line(0)
    {
    }
-   
+
    Impl(const char* function, const char* file, long line)
-      : function(function), file(file), line(line) 
+      : functionPtr(function), filePtr(file), line(line)
    {
    }
-   
-   std::string function ;
-   std::string file ;
+
+   // locations are captured via the ERROR_LOCATION macro so the function
+   // and file pointers always reference string literals -- retain the
+   // pointers and materialize std::string copies only if an accessor is
+   // actually called (most errors are never logged or printed)
+   void materialize() const
+   {
+      if (function.empty() && file.empty())
+      {
+         function = functionPtr ;
+         file = filePtr ;
+      }
+   }
+
+   const char* functionPtr ;
+   const char* filePtr ;
    long line ;
+   mutable std::string function ;
+   mutable std::string file ;
+
+   // pooled allocation (one location is captured per error)
+   void* operator new(std::size_t size);
+   void operator delete(void* pMem, std::size_t size);
 };
 
+void* ErrorLocation::Impl::operator new(std::size_t size)
+{
+   typedef boost::singleton_pool<Impl, sizeof(Impl)> Pool;
+
+   if (size != sizeof(Impl))
+      return ::operator new(size);
+
+   void* pMem = Pool::malloc();
+   if (pMem == NULL)
+      throw std::bad_alloc();
+   return pMem;
+}
+
+void ErrorLocation::Impl::operator delete(void* pMem, std::size_t size)
+{
+   typedef boost::singleton_pool<Impl, sizeof(Impl)> Pool;
+
+   if (pMem == NULL)
+      return;
+
+   if (size != sizeof(Impl))
+      ::operator delete(pMem);
+   else
+      Pool::free(pMem);
+}
+
 ErrorLocation::ErrorLocation()
    : pImpl_(new Impl()) 
 {
@@ -280,13 +358,15 @@ bool ErrorLocation::hasLocation() const
    return line() > 0 ;
 }
 
-const std::string& ErrorLocation::function() const 
+const std::string& ErrorLocation::function() const
 {
+   pImpl_->materialize();
    return pImpl_->function ;
 }
 
-const std::string& ErrorLocation::file() const 
+const std::string& ErrorLocation::file() const
 {
+   pImpl_->materialize();
    return pImpl_->file ;
 }
 
@@ -16,22 +16,39 @@
 #include <core/Exec.hpp>
 
 #include <core/Error.hpp>
+#include <core/PerformanceTimer.hpp>
 
 namespace rstudio {
 namespace core {
 
-ExecBlock& ExecBlock::add(Function function) 
-{ 
-   functions_.push_back(function); 
+ExecBlock& ExecBlock::add(Function function)
+{
+   functions_.push_back(std::make_pair(std::string(), function));
    return *this;
-}   
-   
+}
+
+ExecBlock& ExecBlock::add(const char* name, Function function)
+{
+   functions_.push_back(std::make_pair(std::string(name), function));
+   return *this;
+}
+
 Error ExecBlock::execute() const
 {
-   for (std::vector<Function>::const_iterator
+   for (std::vector<std::pair<std::string, Function> >::const_iterator
             it = functions_.begin(); it != functions_.end(); ++it)
    {
-      Error error = (*it)();
+      Error error;
+      if (it->first.empty())
+      {
+         error = (it->second)();
+      }
+      else
+      {
+         // the name lives in functions_ so it safely outlives the timer
+         ScopedPerformanceTimer timer(it->first.c_str());
+         error = (it->second)();
+      }
       if (error)
          return error ;
    }
@@ -15,6 +15,10 @@
 
 #include <core/FileInfo.hpp>
 
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
 #include <core/FilePath.hpp>
 
 namespace rstudio {
@@ -22,16 +26,37 @@ namespace core {
 
 FileInfo::FileInfo(const FilePath& filePath, bool isSymlink)
    :  absolutePath_(filePath.absolutePath()),
-      isDirectory_(filePath.isDirectory()),
+      isDirectory_(false),
       size_(0),
       lastWriteTime_(0),
       isSymlink_(isSymlink)
 {
+#ifndef _WIN32
+   // a single stat answers all of the questions asked below -- the
+   // accessor-based path used on windows performs a separate status
+   // query for each one, which adds up when FileInfo objects are
+   // built during directory enumeration. note we use ::stat (not
+   // ::lstat) to match the symlink-following behavior of
+   // FilePath::isDirectory; a failed stat yields the same result as
+   // a non-existent path does below
+   struct stat st;
+   if (::stat(absolutePath_.c_str(), &st) == 0)
+   {
+      isDirectory_ = S_ISDIR(st.st_mode);
+      if (!isDirectory_)
+      {
+         size_ = st.st_size;
+         lastWriteTime_ = st.st_mtime;
+      }
+   }
+#else
+   isDirectory_ = filePath.isDirectory();
    if (!isDirectory_ && filePath.exists())
    {
       size_ = filePath.size();
       lastWriteTime_ = filePath.lastWriteTime();
    }
+#endif
 }
 
 FileInfo::FileInfo(const std::string& absolutePath,
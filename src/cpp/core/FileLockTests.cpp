@@ -99,6 +99,47 @@ TEST_CASE("File Locking")
       s_lockFilePath.removeIfExists();
    }
 
+   SECTION("A lease-based lock can only be acquired once")
+   {
+      Error error;
+
+      LeaseBasedFileLock lock1;
+      LeaseBasedFileLock lock2;
+
+      error = lock1.acquire(s_lockFilePath);
+      if (error)
+         LOG_ERROR(error);
+
+      CHECK((error == Success()));
+      CHECK(lock1.isLocked(s_lockFilePath));
+
+      error = lock2.acquire(s_lockFilePath);
+      if (error)
+         LOG_ERROR(error);
+
+      CHECK_FALSE((error == Success()));
+
+      // release and re-acquire
+      error = lock1.release();
+      if (error)
+         LOG_ERROR(error);
+
+      CHECK((error == Success()));
+
+      error = lock2.acquire(s_lockFilePath);
+      if (error)
+         LOG_ERROR(error);
+
+      CHECK((error == Success()));
+
+      error = lock2.release();
+      if (error)
+         LOG_ERROR(error);
+
+      // clean up the lockfile when we're done
+      s_lockFilePath.removeIfExists();
+   }
+
    SECTION("child processes generated by ::fork() don't clear registry")
    {
       LinkBasedFileLock lock;
@@ -17,6 +17,7 @@
 
 #include <algorithm>
 #include <fstream>
+#include <map>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -30,6 +31,7 @@
 #include <boost/filesystem.hpp>
 #include <boost/iostreams/stream.hpp>
 #include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/thread/tss.hpp>
 
 #include <core/StringUtils.hpp>
 #include <core/system/System.hpp>
@@ -120,6 +122,77 @@ internal_string fromString(const std::string& value)
 
 #endif
 
+// per-thread stat cache, active only while a ScopedStatCache is alive on
+// the thread (see FilePath.hpp). entries memoize the results of the
+// status/last_write_time/file_size queries behind exists/isDirectory/
+// lastWriteTime/size so that a handler which interrogates the same path
+// repeatedly performs a single stat. mutating operations clear the whole
+// cache (rather than a single entry) because they can affect other
+// cached paths, e.g. removing a directory removes its children
+struct StatCacheEntry
+{
+   StatCacheEntry()
+      : hasStatus(false),
+        hasLastWriteTime(false),
+        lastWriteTime(0),
+        hasSize(false),
+        size(0)
+   {
+   }
+   bool hasStatus;
+   boost::filesystem::file_status status;
+   bool hasLastWriteTime;
+   std::time_t lastWriteTime;
+   bool hasSize;
+   uintmax_t size;
+};
+
+struct StatCache
+{
+   StatCache() : depth(0) {}
+   int depth;
+   std::map<std::string, StatCacheEntry> entries;
+};
+
+boost::thread_specific_ptr<StatCache> s_pStatCache;
+
+// entry for the path within this thread's cache (NULL if no scope is
+// active). note that map insertions never invalidate existing entry
+// pointers, so the pointer stays valid while additional paths are cached
+StatCacheEntry* statCacheEntry(const path_t& path)
+{
+   StatCache* pCache = s_pStatCache.get();
+   if (pCache == NULL || pCache->depth == 0)
+      return NULL;
+
+   return &(pCache->entries[BOOST_FS_PATH2STR(path)]);
+}
+
+boost::filesystem::file_status cachedStatus(const path_t& path)
+{
+   StatCacheEntry* pEntry = statCacheEntry(path);
+   if (pEntry != NULL)
+   {
+      if (!pEntry->hasStatus)
+      {
+         pEntry->status = boost::filesystem::status(path);
+         pEntry->hasStatus = true;
+      }
+      return pEntry->status;
+   }
+   else
+   {
+      return boost::filesystem::status(path);
+   }
+}
+
+void invalidateStatCache()
+{
+   StatCache* pCache = s_pStatCache.get();
+   if (pCache != NULL)
+      pCache->entries.clear();
+}
+
 void logError(path_t path,
               const boost::filesystem::filesystem_error& e,
               const ErrorLocation& errorLocation);
@@ -318,7 +391,7 @@ bool FilePath::exists() const
 {
     try
     {
-       return !empty() && boost::filesystem::exists(pImpl_->path) ;
+       return !empty() && boost::filesystem::exists(cachedStatus(pImpl_->path)) ;
     }
     catch(const boost::filesystem::filesystem_error& e)
     {
@@ -345,10 +418,27 @@ uintmax_t FilePath::size() const
 {
    try
    {
-      if (!exists() || !boost::filesystem::is_regular_file(pImpl_->path))
+      if (empty())
          return 0;
-      else
-         return boost::filesystem::file_size(pImpl_->path) ;
+
+      StatCacheEntry* pEntry = statCacheEntry(pImpl_->path);
+      if (pEntry != NULL && pEntry->hasSize)
+         return pEntry->size;
+
+      uintmax_t size = 0;
+      boost::filesystem::file_status status = cachedStatus(pImpl_->path);
+      if (boost::filesystem::exists(status) &&
+          boost::filesystem::is_regular_file(status))
+      {
+         size = boost::filesystem::file_size(pImpl_->path);
+      }
+
+      if (pEntry != NULL)
+      {
+         pEntry->hasSize = true;
+         pEntry->size = size;
+      }
+      return size;
    }
    catch(const boost::filesystem::filesystem_error& e)
    {
@@ -559,8 +649,9 @@ void FilePath::setLastWriteTime(std::time_t time) const
    {
       if (!exists())
          return;
-      else
-         boost::filesystem::last_write_time(pImpl_->path, time);
+
+      boost::filesystem::last_write_time(pImpl_->path, time);
+      invalidateStatCache();
    }
    catch(const boost::filesystem::filesystem_error& e)
    {
@@ -573,10 +664,20 @@ std::time_t FilePath::lastWriteTime() const
 {
    try
    {
-      if (!exists())
-         return 0;
-      else
-         return boost::filesystem::last_write_time(pImpl_->path) ;
+      StatCacheEntry* pEntry = statCacheEntry(pImpl_->path);
+      if (pEntry != NULL && pEntry->hasLastWriteTime)
+         return pEntry->lastWriteTime;
+
+      std::time_t lastWriteTime = 0;
+      if (exists())
+         lastWriteTime = boost::filesystem::last_write_time(pImpl_->path);
+
+      if (pEntry != NULL)
+      {
+         pEntry->hasLastWriteTime = true;
+         pEntry->lastWriteTime = lastWriteTime;
+      }
+      return lastWriteTime;
    }
    catch(const boost::filesystem::filesystem_error& e)
    {
@@ -662,6 +763,7 @@ Error FilePath::remove() const
          boost::filesystem::remove_all(pImpl_->path);
       else
          boost::filesystem::remove(pImpl_->path) ;
+      invalidateStatCache();
       return Success() ;
    }
    catch(const boost::filesystem::filesystem_error& e)
@@ -685,6 +787,7 @@ Error FilePath::move(const FilePath& targetPath) const
    try
    {
       boost::filesystem::rename(pImpl_->path, targetPath.pImpl_->path) ;
+      invalidateStatCache();
       return Success() ;
    }
    catch(const boost::filesystem::filesystem_error& e)
@@ -702,6 +805,7 @@ Error FilePath::copy(const FilePath& targetPath) const
    try
    {
       boost::filesystem::copy_file(pImpl_->path, targetPath.pImpl_->path) ;
+      invalidateStatCache();
       return Success() ;
    }
    catch(const boost::filesystem::filesystem_error& e)
@@ -750,16 +854,18 @@ bool FilePath::isDirectory() const
 {
    try
    {
-      if (!exists())
+      if (empty())
          return false;
-      else
-      {
-         return boost::filesystem::is_directory(pImpl_->path)
-      #ifdef _WIN32
-               || isJunction()
-      #endif
-               ;
-      }
+
+      boost::filesystem::file_status status = cachedStatus(pImpl_->path);
+      if (!boost::filesystem::exists(status))
+         return false;
+
+      return boost::filesystem::is_directory(status)
+   #ifdef _WIN32
+            || isJunction()
+   #endif
+            ;
    }
    catch(const boost::filesystem::filesystem_error& e)
    {
@@ -788,6 +894,7 @@ Error FilePath::createDirectory(const std::string& name) const
       else
          targetDirectory = BOOST_FS_COMPLETE(name, pImpl_->path) ;
       boost::filesystem::create_directories(targetDirectory) ;
+      invalidateStatCache();
       return Success() ;
    }
    catch(const boost::filesystem::filesystem_error& e)
@@ -1104,6 +1211,7 @@ Error FilePath::open_w(boost::shared_ptr<std::ostream>* pStream, bool truncate)
       }
 
       pStream->reset(pResult);
+      invalidateStatCache();
    }
    catch(const std::exception& e)
    {
@@ -1167,6 +1275,27 @@ bool compareAbsolutePathNoCase(const FilePath& file1, const FilePath& file2)
    return file1Lower < file2Lower;
 }
 
+ScopedStatCache::ScopedStatCache()
+{
+   if (s_pStatCache.get() == NULL)
+      s_pStatCache.reset(new StatCache());
+
+   s_pStatCache->depth++;
+}
+
+ScopedStatCache::~ScopedStatCache()
+{
+   try
+   {
+      StatCache* pCache = s_pStatCache.get();
+      if (pCache != NULL && --pCache->depth == 0)
+         pCache->entries.clear();
+   }
+   catch(...)
+   {
+   }
+}
+
 struct RecursiveDirectoryIterator::Impl
 {
    explicit Impl(path_t path)
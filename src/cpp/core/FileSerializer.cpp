@@ -23,6 +23,7 @@
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 
 #include <core/FilePath.hpp>
 #include <core/StringUtils.hpp>
@@ -30,6 +31,95 @@
 namespace rstudio {
 namespace core {
 
+struct MemoryMappedFile::Impl
+{
+   boost::iostreams::mapped_file_source source;
+};
+
+MemoryMappedFile::MemoryMappedFile()
+   : pImpl_(new Impl())
+{
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+   try
+   {
+      close();
+   }
+   catch(...)
+   {
+   }
+}
+
+Error MemoryMappedFile::open(const core::FilePath& filePath)
+{
+   close();
+
+   if (!filePath.exists())
+   {
+      Error error = systemError(boost::system::errc::no_such_file_or_directory,
+                                ERROR_LOCATION);
+      error.addProperty("path", filePath.absolutePath());
+      return error;
+   }
+
+   // zero-length files can't be mapped. note that virtual files
+   // (e.g. under /proc) also stat as zero-length even when they have
+   // contents, so callers must fall back to a stream read rather
+   // than treating this as an empty file
+   if (filePath.size() == 0)
+   {
+      Error error = systemError(boost::system::errc::invalid_argument,
+                                ERROR_LOCATION);
+      error.addProperty("path", filePath.absolutePath());
+      return error;
+   }
+
+   try
+   {
+      pImpl_->source.open(filePath.absolutePath());
+      if (!pImpl_->source.is_open())
+         return systemError(boost::system::errc::io_error, ERROR_LOCATION);
+      return Success();
+   }
+   catch(const std::exception& e)
+   {
+      Error error = systemError(boost::system::errc::io_error,
+                                ERROR_LOCATION);
+      error.addProperty("what", e.what());
+      error.addProperty("path", filePath.absolutePath());
+      return error;
+   }
+}
+
+void MemoryMappedFile::close()
+{
+   if (pImpl_->source.is_open())
+      pImpl_->source.close();
+}
+
+bool MemoryMappedFile::isOpen() const
+{
+   return pImpl_->source.is_open();
+}
+
+const char* MemoryMappedFile::data() const
+{
+   if (pImpl_->source.is_open())
+      return pImpl_->source.data();
+   else
+      return NULL;
+}
+
+std::size_t MemoryMappedFile::size() const
+{
+   if (pImpl_->source.is_open())
+      return pImpl_->source.size();
+   else
+      return 0;
+}
+
 std::string stringifyStringPair(const std::pair<std::string,std::string>& pair)
 {
    return pair.first + "=\"" + string_utils::jsonLiteralEscape(pair.second) + "\"" ;
@@ -214,13 +304,28 @@ Error readStringFromFile(const FilePath& filePath,
       // reading the entire file
       else
       {
-         // set exception mask (required for proper reporting of errors)
-         pIfs->exceptions(std::istream::failbit | std::istream::badbit);
+         // map the file and copy its contents directly (avoids the
+         // stream machinery and repeated buffer growth); fall back
+         // to a stream read for files which can't be mapped
+         MemoryMappedFile mappedFile;
+         Error error = mappedFile.open(filePath);
+         if (!error)
+         {
+            if (mappedFile.size() > 0)
+               pStr->assign(mappedFile.data(), mappedFile.size());
+            else
+               pStr->clear();
+         }
+         else
+         {
+            // set exception mask (required for proper reporting of errors)
+            pIfs->exceptions(std::istream::failbit | std::istream::badbit);
 
-         // copy file to string stream
-         std::ostringstream ostr;
-         boost::iostreams::copy(*pIfs, ostr);
-         *pStr = ostr.str();
+            // copy file to string stream
+            std::ostringstream ostr;
+            boost::iostreams::copy(*pIfs, ostr);
+            *pStr = ostr.str();
+         }
       }
 
       string_utils::convertLineEndings(pStr, lineEnding);
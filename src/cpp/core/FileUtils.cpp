@@ -13,8 +13,10 @@
  *
  */
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <vector>
 
 #include <boost/bind.hpp>
 
@@ -56,6 +58,20 @@ bool copySourceFile(const FilePath& sourceDir,
    return true;
 }
 
+bool addCacheFile(std::vector<FilePath>* pFiles,
+                  int level,
+                  const FilePath& filePath)
+{
+   if (!filePath.isDirectory())
+      pFiles->push_back(filePath);
+   return true;
+}
+
+bool lastWriteTimeLessThan(const FilePath& a, const FilePath& b)
+{
+   return a.lastWriteTime() < b.lastWriteTime();
+}
+
 } // anonymous namespace
 
 FilePath uniqueFilePath(const FilePath& parent, const std::string& prefix)
@@ -133,6 +149,47 @@ Error copyDirectory(const FilePath& sourceDirectory,
      boost::bind(copySourceFile, sourceDirectory, targetDirectory, _2));
 }
 
+Error trimCacheDirectory(const FilePath& cacheDirectory,
+                         uintmax_t maxSizeBytes)
+{
+   // nothing to do if the directory doesn't exist
+   if (!cacheDirectory.exists())
+      return Success();
+
+   // collect the files in the cache and compute current usage
+   std::vector<FilePath> files;
+   Error error = cacheDirectory.childrenRecursive(
+                           boost::bind(addCacheFile, &files, _1, _2));
+   if (error)
+      return error;
+
+   uintmax_t totalSize = 0;
+   for (std::size_t i = 0; i < files.size(); i++)
+      totalSize += files[i].size();
+
+   // already within budget
+   if (totalSize <= maxSizeBytes)
+      return Success();
+
+   // evict least-recently-written files until we fit. removal failures
+   // are logged and skipped (a file busy elsewhere shouldn't prevent
+   // trimming the rest of the cache)
+   std::sort(files.begin(), files.end(), lastWriteTimeLessThan);
+   for (std::size_t i = 0;
+        i < files.size() && totalSize > maxSizeBytes;
+        i++)
+   {
+      uintmax_t fileSize = files[i].size();
+      error = files[i].remove();
+      if (error)
+         LOG_ERROR(error);
+      else
+         totalSize -= fileSize;
+   }
+
+   return Success();
+}
+
 
 } // namespace file_utils
 } // namespace core
@@ -17,31 +17,89 @@
 
 #include <sstream>
 
-#include <boost/crc.hpp>
+#include <boost/cstdint.hpp>
 #include <boost/lexical_cast.hpp>
 
 #include <core/SafeConvert.hpp>
 
 namespace rstudio {
 namespace core {
-namespace hash {   
+namespace hash {
+
+namespace {
+
+// slicing-by-four crc32 (polynomial 0xEDB88320, identical checksums to
+// boost::crc_32_type which processes one table lookup per byte). crc32
+// backs caching decisions on hot paths (e.g. document autosave), so
+// process four bytes per step instead
+struct Crc32Tables
+{
+   Crc32Tables()
+   {
+      for (boost::uint32_t i = 0; i < 256; i++)
+      {
+         boost::uint32_t crc = i;
+         for (int bit = 0; bit < 8; bit++)
+            crc = (crc & 1) ? ((crc >> 1) ^ 0xEDB88320u) : (crc >> 1);
+         tables[0][i] = crc;
+      }
+      for (int slice = 1; slice < 4; slice++)
+      {
+         for (boost::uint32_t i = 0; i < 256; i++)
+         {
+            boost::uint32_t crc = tables[slice-1][i];
+            tables[slice][i] = (crc >> 8) ^ tables[0][crc & 0xFF];
+         }
+      }
+   }
+
+   boost::uint32_t tables[4][256];
+};
+
+const Crc32Tables s_crc32Tables;
+
+boost::uint32_t crc32(const char* pData, std::size_t n)
+{
+   const unsigned char* pBytes =
+                     reinterpret_cast<const unsigned char*>(pData);
+   const boost::uint32_t (&t)[4][256] = s_crc32Tables.tables;
+
+   boost::uint32_t crc = 0xFFFFFFFFu;
+   while (n >= 4)
+   {
+      crc ^= static_cast<boost::uint32_t>(pBytes[0])        |
+             (static_cast<boost::uint32_t>(pBytes[1]) << 8)  |
+             (static_cast<boost::uint32_t>(pBytes[2]) << 16) |
+             (static_cast<boost::uint32_t>(pBytes[3]) << 24);
+      crc = t[3][crc & 0xFF]         ^
+            t[2][(crc >> 8) & 0xFF]  ^
+            t[1][(crc >> 16) & 0xFF] ^
+            t[0][crc >> 24];
+      pBytes += 4;
+      n -= 4;
+   }
+   while (n-- > 0)
+      crc = (crc >> 8) ^ t[0][(crc ^ *pBytes++) & 0xFF];
+
+   return crc ^ 0xFFFFFFFFu;
+}
+
+} // anonymous namespace
 
 std::string crc32Hash(const std::string& content)
 {
-   boost::crc_32_type result;
-   result.process_bytes(content.data(), content.length());
-   return safe_convert::numberToString(result.checksum());
+   return safe_convert::numberToString(
+                              crc32(content.data(), content.length()));
 }
 
 std::string crc32HexHash(const std::string& content)
 {
    // compute checksum
-   boost::crc_32_type result;
-   result.process_bytes(content.data(), content.length());
+   boost::uint32_t checksum = crc32(content.data(), content.length());
 
    // return hex representation
    std::ostringstream output;
-   output << std::uppercase << std::hex << result.checksum();
+   output << std::uppercase << std::hex << checksum;
    return output.str();
 }
    
@@ -18,6 +18,8 @@
 #include <iostream>
 #include <iomanip>
 
+#include <core/BoostThread.hpp>
+
 using namespace boost::posix_time;
 
 namespace rstudio {
@@ -123,12 +125,119 @@ std::ostream& operator << (std::ostream& os, const PerformanceTimer& t)
    
    // restore old output flags
    os.setf(oldFlags);
-   
+
    return os;
 }
-         
 
-} // namespace core 
+
+namespace {
+
+// process-wide accumulator for ScopedPerformanceTimer. a single mutex
+// is adequate here: the cost of one uncontended lock per timed scope is
+// well below the measurement noise of the scopes worth timing
+boost::mutex s_performanceStatsMutex;
+std::map<std::string,PerformanceStats> s_performanceStats;
+
+// activity stack for the (single) tracked thread -- see
+// trackActivityOnCurrentThread. also guarded by s_performanceStatsMutex;
+// entries are the section name (owned by the enclosing scope, which by
+// construction outlives its stack entry) and when it was entered
+bool s_trackActivity = false;
+boost::thread::id s_activityThreadId;
+std::vector<std::pair<const char*, boost::posix_time::ptime> >
+                                                         s_activityStack;
+
+inline bool onTrackedThread()
+{
+   return s_trackActivity &&
+          boost::this_thread::get_id() == s_activityThreadId;
+}
+
+} // anonymous namespace
+
+ScopedPerformanceTimer::ScopedPerformanceTimer(const char* section)
+   : section_(section),
+     startTime_(microsec_clock::universal_time()),
+     tracked_(false)
+{
+   if (onTrackedThread())
+   {
+      try
+      {
+         boost::lock_guard<boost::mutex> lock(s_performanceStatsMutex);
+         s_activityStack.push_back(std::make_pair(section, startTime_));
+         tracked_ = true;
+      }
+      catch(...)
+      {
+      }
+   }
+}
+
+ScopedPerformanceTimer::~ScopedPerformanceTimer()
+{
+   try
+   {
+      double micros = (microsec_clock::universal_time() - startTime_)
+                                                   .total_microseconds();
+      boost::lock_guard<boost::mutex> lock(s_performanceStatsMutex);
+      if (tracked_ && !s_activityStack.empty())
+         s_activityStack.pop_back();
+      PerformanceStats& stats = s_performanceStats[section_];
+      stats.count++;
+      stats.totalMicroseconds += micros;
+      if (micros > stats.maxMicroseconds)
+         stats.maxMicroseconds = micros;
+   }
+   catch(...)
+   {
+   }
+}
+
+void trackActivityOnCurrentThread()
+{
+   // called once at startup, before any thread calls currentActivity
+   s_activityThreadId = boost::this_thread::get_id();
+   s_trackActivity = true;
+}
+
+bool currentActivity(std::string* pSection,
+                     boost::posix_time::ptime* pStartTime)
+{
+   boost::lock_guard<boost::mutex> lock(s_performanceStatsMutex);
+   if (s_activityStack.empty())
+      return false;
+   *pSection = s_activityStack.back().first;
+   *pStartTime = s_activityStack.back().second;
+   return true;
+}
+
+void performanceStatistics(std::map<std::string,PerformanceStats>* pStats)
+{
+   boost::lock_guard<boost::mutex> lock(s_performanceStatsMutex);
+   *pStats = s_performanceStats;
+}
+
+void writePerformanceStatistics(std::ostream& os)
+{
+   std::map<std::string,PerformanceStats> stats;
+   performanceStatistics(&stats);
+
+   std::ios::fmtflags oldFlags = os.setf(std::ios::fixed);
+   for (std::map<std::string,PerformanceStats>::const_iterator it =
+           stats.begin(); it != stats.end(); ++it)
+   {
+      os << std::setprecision(1)
+         << it->first << ": "
+         << it->second.count << " calls, "
+         << (it->second.totalMicroseconds * 0.001) << " ms total, "
+         << (it->second.maxMicroseconds * 0.001) << " ms max"
+         << std::endl;
+   }
+   os.setf(oldFlags);
+}
+
+} // namespace core
 } // namespace rstudio
 
 
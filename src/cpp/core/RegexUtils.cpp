@@ -15,6 +15,7 @@
 
 #include <core/RegexUtils.hpp>
 
+#include <map>
 #include <vector>
 
 #include <boost/regex.hpp>
@@ -25,11 +26,40 @@
 #include <boost/iostreams/filtering_stream.hpp>
 
 #include <core/StringUtils.hpp>
+#include <core/Thread.hpp>
 
 namespace rstudio {
 namespace core {
 namespace regex_utils {
 
+namespace {
+
+// cache of compiled patterns (node-based map so references handed out by
+// cached() remain valid as the cache grows)
+boost::mutex s_cacheMutex;
+std::map<std::string, boost::regex> s_cachedPatterns;
+
+} // anonymous namespace
+
+const boost::regex& cached(const std::string& pattern)
+{
+   LOCK_MUTEX(s_cacheMutex)
+   {
+      std::map<std::string, boost::regex>::const_iterator it =
+                                             s_cachedPatterns.find(pattern);
+      if (it != s_cachedPatterns.end())
+         return it->second;
+
+      return s_cachedPatterns.insert(
+               std::make_pair(pattern, boost::regex(pattern))).first->second;
+   }
+   END_LOCK_MUTEX
+
+   // keep compiler happy (unreachable -- mutex failures log and fall out)
+   static boost::regex emptyPattern;
+   return emptyPattern;
+}
+
 boost::regex wildcardPatternToRegex(const std::string& pattern)
 {
    // split into componenents
@@ -25,9 +25,18 @@
 namespace rstudio {
 namespace core {
 
+namespace {
+
+// maximum number of journal entries accumulated before the journal
+// is compacted back into the settings file
+const int kMaxJournalEntries = 100;
+
+} // anonymous namespace
+
 Settings::Settings()
    : updatePending_(false),
-     isDirty_(false)
+     isDirty_(false),
+     journalEntries_(0)
 {
 }
 
@@ -35,14 +44,16 @@ Settings::~Settings()
 {
 }
 
-Error Settings::initialize(const FilePath& filePath) 
+Error Settings::initialize(const FilePath& filePath)
 {
    settingsFile_ = filePath ;
+   journalFile_ = FilePath(filePath.absolutePath() + ".journal");
    settingsMap_.clear() ;
+   journalEntries_ = 0;
    Error error = core::readStringMapFromFile(settingsFile_, &settingsMap_) ;
    if (error)
    {
-      // we don't consider file-not-found and error because it is a 
+      // we don't consider file-not-found and error because it is a
       // common initialization case
       if (error.code() != boost::system::errc::no_such_file_or_directory)
       {
@@ -50,7 +61,21 @@ Error Settings::initialize(const FilePath& filePath)
          return error ;
       }
    }
-   
+
+   // apply any values journaled since the settings file was last
+   // written, then compact them into the settings file
+   if (journalFile_.exists())
+   {
+      error = replayJournal();
+      if (error)
+      {
+         error.addProperty("settings-file", settingsFile_);
+         return error;
+      }
+
+      writeSettings();
+   }
+
    return Success() ;
 }
 
@@ -60,9 +85,11 @@ void Settings::set(const std::string& name, const std::string& value)
    {
       settingsMap_[name] = value ;
       isDirty_ = true;
-      
+
       if (!updatePending_)
-         writeSettings() ;
+         journalValue(name);
+      else
+         pendingWrites_.push_back(name);
    }
 }
    
@@ -145,15 +172,94 @@ void Settings::endUpdate()
 {
    updatePending_ = false ;
    if (isDirty_)
+   {
+      // append all of the values modified during the update as a
+      // single journal write
+      std::string entries;
+      for (std::vector<std::string>::const_iterator
+            it = pendingWrites_.begin(); it != pendingWrites_.end(); ++it)
+      {
+         entries.append(stringifyStringPair(
+               std::make_pair(*it, settingsMap_[*it])));
+         entries.append("\n");
+         journalEntries_++;
+      }
+      pendingWrites_.clear();
+      isDirty_ = false;
+
+      Error error = core::appendToFile(journalFile_, entries);
+      if (error)
+      {
+         LOG_ERROR(error);
+         writeSettings();
+      }
+      else if (journalEntries_ > kMaxJournalEntries)
+      {
+         writeSettings();
+      }
+   }
+}
+
+// append a single modified value to the journal (an append is much
+// cheaper than the full rewrite writeSettings does, which produces
+// visible stalls when the settings file lives on e.g. NFS and is
+// written dozens of times during startup). the journal is compacted
+// back into the settings file on load and when it grows large
+void Settings::journalValue(const std::string& name)
+{
+   isDirty_ = false;
+   Error error = core::appendToFile(
+            journalFile_,
+            stringifyStringPair(std::make_pair(name, settingsMap_[name])) +
+            "\n");
+   if (error)
+   {
+      // fall back to a full rewrite
+      LOG_ERROR(error);
+      writeSettings();
+      return;
+   }
+
+   if (++journalEntries_ > kMaxJournalEntries)
       writeSettings();
 }
 
-void Settings::writeSettings() 
+Error Settings::replayJournal()
+{
+   // read the raw journal lines -- note that these must be applied
+   // in order (last write wins) so we can't read them directly into
+   // a map the way readStringMapFromFile does
+   std::vector<std::string> lines;
+   Error error = core::readStringVectorFromFile(journalFile_, &lines);
+   if (error)
+      return error;
+
+   for (std::vector<std::string>::const_iterator
+         it = lines.begin(); it != lines.end(); ++it)
+   {
+      std::pair<const std::string, std::string> entry;
+      if (parseStringPair(*it, &entry) == ReadCollectionAddLine)
+         settingsMap_[entry.first] = entry.second;
+   }
+
+   return Success();
+}
+
+void Settings::writeSettings()
 {
    isDirty_ = false;
-   Error error = core::writeStringMapToFile(settingsFile_, settingsMap_) ; 
+   Error error = core::writeStringMapToFile(settingsFile_, settingsMap_) ;
    if (error)
-     LOG_ERROR(error);
+   {
+      LOG_ERROR(error);
+      return;
+   }
+
+   // the settings file now includes everything in the journal (note
+   // we only remove the journal after a successful write -- if we
+   // crash in between, replaying it on the next load is idempotent)
+   journalFile_.removeIfExists();
+   journalEntries_ = 0;
 }
 
 
@@ -234,6 +234,39 @@ bool detectLineEndings(const FilePath& filePath, LineEnding* pType)
    return false;
 }
 
+bool isAsciiString(const std::string& str)
+{
+   // scan a machine word at a time for a byte with the high bit set --
+   // misaligned leading/trailing bytes are checked individually
+   const unsigned long kHighBits = 0x8080808080808080ULL &
+                                   static_cast<unsigned long>(-1);
+
+   const char* it = str.data();
+   const char* end = it + str.length();
+
+   while (it != end &&
+          (reinterpret_cast<std::size_t>(it) % sizeof(unsigned long)) != 0)
+   {
+      if (static_cast<unsigned char>(*it++) > 0x7F)
+         return false;
+   }
+
+   for ( ; static_cast<std::size_t>(end - it) >= sizeof(unsigned long);
+        it += sizeof(unsigned long))
+   {
+      if (*reinterpret_cast<const unsigned long*>(it) & kHighBits)
+         return false;
+   }
+
+   while (it != end)
+   {
+      if (static_cast<unsigned char>(*it++) > 0x7F)
+         return false;
+   }
+
+   return true;
+}
+
 std::string utf8ToSystem(const std::string& str,
                          bool escapeInvalidChars)
 {
@@ -241,6 +274,11 @@ std::string utf8ToSystem(const std::string& str,
       return std::string();
 
 #ifdef _WIN32
+   // ASCII strings are invariant under every ANSI code page, so they can
+   // skip the wide-character round trip entirely
+   if (isAsciiString(str))
+      return str;
+
    wchar_t wide[str.length() + 1];
    int chars = ::MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, wide, sizeof(wide));
    if (chars < 0)
@@ -278,6 +316,9 @@ std::string systemToUtf8(const std::string& str)
       return std::string();
 
 #ifdef _WIN32
+   if (isAsciiString(str))
+      return str;
+
    wchar_t wide[str.length() + 1];
    int chars = ::MultiByteToWideChar(CP_ACP, 0, str.c_str(), str.length(), wide, sizeof(wide));
    if (chars < 0)
@@ -422,13 +463,52 @@ std::string singleQuotedStrEscape(const std::string& str)
    return escape(escapes, subs, str);
 }
 
+namespace {
+
+// control bytes deleted by filterControlChars: 0x00-0x08 and 0x0E-0x1F
+// (\t \n \v \f \r are preserved). same set the regex formerly used here
+// matched -- the explicit test lets us scan for spans rather than run a
+// regex over every byte
+inline bool isFilteredControlChar(char ch)
+{
+   unsigned char uch = static_cast<unsigned char>(ch);
+   return uch <= 0x08 || (uch >= 0x0E && uch <= 0x1F);
+}
+
+} // anonymous namespace
+
 std::string filterControlChars(const std::string& str)
 {
    // Delete control chars, which can cause errors in JSON parsing (especially
-   // \0003)
-   return boost::regex_replace(str,
-                               boost::regex("[\\0000-\\0010\\0016-\\0037]+"),
-                               "");
+   // \0003). scan for the first control byte -- most output contains none,
+   // in which case we return the input without rewriting it (this runs over
+   // full vcs/compile output payloads so the clean case needs to be cheap)
+   std::string::size_type i = 0;
+   std::string::size_type n = str.size();
+   while (i < n && !isFilteredControlChar(str[i]))
+      i++;
+   if (i == n)
+      return str;
+
+   // copy the remainder as bulk spans of clean bytes, skipping runs of
+   // control bytes between them
+   std::string result;
+   result.reserve(n);
+   result.append(str, 0, i);
+   while (i < n)
+   {
+      if (isFilteredControlChar(str[i]))
+      {
+         i++;
+         continue;
+      }
+
+      std::string::size_type spanStart = i;
+      while (i < n && !isFilteredControlChar(str[i]))
+         i++;
+      result.append(str, spanStart, i - spanStart);
+   }
+   return result;
 }
 
 namespace {
@@ -508,7 +588,7 @@ bool parseVersion(const std::string& str, uint64_t* pVersion)
    return true;
 }
 
-void trimLeadingLines(int maxLines, std::string* pLines)
+void trimLeadingLines(int maxLines, std::string* pLines, std::string* pTrimmed)
 {
    if (pLines->length() > static_cast<unsigned int>(maxLines*2))
    {
@@ -521,6 +601,8 @@ void trimLeadingLines(int maxLines, std::string* pLines)
          {
             if (++lineCount > maxLines)
             {
+               if (pTrimmed != NULL)
+                  pTrimmed->assign(*pLines, 0, pos - pLines->begin());
                pLines->erase(pLines->begin(), pos);
                break;
             }
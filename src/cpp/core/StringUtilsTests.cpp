@@ -55,6 +55,16 @@ context("isSubsequence")
       expect_true(trimWhitespace("abc") == "abc");
       expect_true(trimWhitespace("") == "");
    }
+
+   test_that("filterControlChars works")
+   {
+      expect_true(filterControlChars("") == "");
+      expect_true(filterControlChars("abc") == "abc");
+      expect_true(filterControlChars("a\tb\nc\r\n") == "a\tb\nc\r\n");
+      expect_true(filterControlChars(std::string("a\0b", 3)) == "ab");
+      expect_true(filterControlChars("\033[31mred\033[0m") == "[31mred[0m");
+      expect_true(filterControlChars("\001\002\003") == "");
+   }
 }
 
 } // end namespace string_utils
@@ -14,6 +14,8 @@
  */
 
 #include <core/Thread.hpp>
+
+#include <boost/bind.hpp>
 #include <core/Macros.hpp>
 
 #include <core/system/System.hpp>
@@ -22,6 +24,107 @@ namespace rstudio {
 namespace core {
 namespace thread {
 
+ThreadPool::ThreadPool(std::size_t numThreads)
+   : numThreads_(numThreads),
+     stopped_(false)
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+   try
+   {
+      stop();
+   }
+   catch(...)
+   {
+   }
+}
+
+void ThreadPool::start()
+{
+   for (std::size_t i = 0; i < numThreads_; i++)
+   {
+      boost::shared_ptr<boost::thread> pThread(new boost::thread());
+      safeLaunchThread(boost::bind(&ThreadPool::workerMain, this),
+                       pThread.get());
+      threads_.push_back(pThread);
+   }
+}
+
+void ThreadPool::schedule(const boost::function<void()>& task)
+{
+   // ignore empty tasks (an empty task is the worker exit signal)
+   if (!task)
+      return;
+
+   LOCK_MUTEX(stateMutex_)
+   {
+      if (stopped_)
+         return;
+   }
+   END_LOCK_MUTEX
+
+   queue_.enque(task);
+}
+
+void ThreadPool::stop()
+{
+   LOCK_MUTEX(stateMutex_)
+   {
+      if (stopped_)
+         return;
+      stopped_ = true;
+   }
+   END_LOCK_MUTEX
+
+   // enque one exit signal per worker -- these land behind any tasks
+   // already queued, so queued work is drained before the workers exit
+   for (std::size_t i = 0; i < threads_.size(); i++)
+      queue_.enque(boost::function<void()>());
+
+   // join the workers (but don't wait forever on a wedged task)
+   for (std::size_t i = 0; i < threads_.size(); i++)
+   {
+      if (threads_[i]->joinable())
+      {
+         if (!threads_[i]->timed_join(boost::posix_time::seconds(3)))
+            LOG_WARNING_MESSAGE("ThreadPool worker didn't stop within 3 sec");
+
+         threads_[i]->detach();
+      }
+   }
+   threads_.clear();
+}
+
+void ThreadPool::workerMain()
+{
+   try
+   {
+      while (true)
+      {
+         // wait for a task
+         boost::function<void()> task;
+         if (!queue_.deque(&task, boost::posix_time::time_duration(
+                                     boost::posix_time::not_a_date_time)))
+            continue;
+
+         // an empty task signals exit
+         if (!task)
+            break;
+
+         // execute the task (one misbehaving task shouldn't take down
+         // the worker)
+         try
+         {
+            task();
+         }
+         CATCH_UNEXPECTED_EXCEPTION
+      }
+   }
+   CATCH_UNEXPECTED_EXCEPTION
+}
+
 void safeLaunchThread(boost::function<void()> threadMain,
                       boost::thread* pThread)
 {
@@ -15,10 +15,16 @@
 
 #include <core/YamlUtil.hpp>
 
+#include <map>
+#include <string>
+
 #include <boost/regex.hpp>
 
 #include <core/Error.hpp>
+#include <core/Hash.hpp>
 #include <core/Log.hpp>
+#include <core/SafeConvert.hpp>
+#include <core/Thread.hpp>
 
 #include <core/FileSerializer.hpp>
 
@@ -34,6 +40,61 @@ boost::regex& reYaml()
    return instance;
 }
 
+// memoized header scans keyed by content hash. type detection, render
+// preflight, and lint all re-scan the same (unchanged) document
+// contents many times per editing session, and the regex scan is
+// linear in document size; hashing the content is much cheaper than
+// re-running the scan. guarded by a mutex since core has no thread
+// affinity guarantees
+struct YamlHeaderScan
+{
+   YamlHeaderScan() : hasHeader(false) {}
+   bool hasHeader;
+   std::string header;
+};
+
+const std::size_t kMaxHeaderScanCacheEntries = 32;
+boost::mutex s_headerScanCacheMutex;
+std::map<std::string, YamlHeaderScan> s_headerScanCache;
+
+YamlHeaderScan scanYamlHeader(const std::string& content)
+{
+   // key on length as well as hash so a crc32 collision between two
+   // documents can't hand one of them the other's header
+   std::string contentHash =
+         safe_convert::numberToString(content.length()) + ":" +
+         hash::crc32HexHash(content);
+
+   LOCK_MUTEX(s_headerScanCacheMutex)
+   {
+      std::map<std::string, YamlHeaderScan>::const_iterator it =
+                                       s_headerScanCache.find(contentHash);
+      if (it != s_headerScanCache.end())
+         return it->second;
+   }
+   END_LOCK_MUTEX
+
+   YamlHeaderScan scan;
+   boost::smatch match;
+   if (boost::regex_search(content.begin(), content.end(), match, reYaml()))
+   {
+      scan.hasHeader = true;
+      if (match.size() >= 1)
+         scan.header = match[1];
+   }
+
+   LOCK_MUTEX(s_headerScanCacheMutex)
+   {
+      // bound the cache (documents being actively edited churn hashes)
+      if (s_headerScanCache.size() >= kMaxHeaderScanCacheEntries)
+         s_headerScanCache.clear();
+      s_headerScanCache[contentHash] = scan;
+   }
+   END_LOCK_MUTEX
+
+   return scan;
+}
+
 } // anonymous namespace
 
 bool hasYamlHeader(const FilePath& filePath)
@@ -48,7 +109,7 @@ bool hasYamlHeader(const FilePath& filePath)
 
 bool hasYamlHeader(const std::string& content)
 {
-   return boost::regex_search(content.begin(), content.end(), reYaml());
+   return scanYamlHeader(content).hasHeader;
 }
 
 std::string extractYamlHeader(const FilePath& filePath)
@@ -63,14 +124,7 @@ std::string extractYamlHeader(const FilePath& filePath)
 
 std::string extractYamlHeader(const std::string& content)
 {
-   std::string result;
-   boost::smatch match;
-   
-   if (boost::regex_search(content.begin(), content.end(), match, reYaml()))
-      if (match.size() >= 1)
-         result = match[1];
-   
-   return result;
+   return scanYamlHeader(content).header;
 }
 
 } // namespace yaml
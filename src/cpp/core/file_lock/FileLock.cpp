@@ -38,8 +38,9 @@ void initialize()
 
 namespace {
 
-const char * const kLockTypeAdvisory  = "advisory";
-const char * const kLockTypeLinkBased = "linkbased";
+const char * const kLockTypeAdvisory   = "advisory";
+const char * const kLockTypeLinkBased  = "linkbased";
+const char * const kLockTypeLeaseBased = "leasebased";
 
 const char * const kLocksConfPath    = "/etc/rstudio/file-locks";
 const double kDefaultRefreshRate     = 20.0;
@@ -49,8 +50,9 @@ std::string lockTypeToString(FileLock::LockType type)
 {
    switch (type)
    {
-   case FileLock::LOCKTYPE_ADVISORY:  return kLockTypeAdvisory;
-   case FileLock::LOCKTYPE_LINKBASED: return kLockTypeLinkBased;
+   case FileLock::LOCKTYPE_ADVISORY:   return kLockTypeAdvisory;
+   case FileLock::LOCKTYPE_LINKBASED:  return kLockTypeLinkBased;
+   case FileLock::LOCKTYPE_LEASEBASED: return kLockTypeLeaseBased;
    }
    
    // not reached
@@ -65,6 +67,8 @@ FileLock::LockType stringToLockType(const std::string& lockType)
       return FileLock::LOCKTYPE_ADVISORY;
    else if (boost::iequals(lockType, kLockTypeLinkBased))
       return FileLock::LOCKTYPE_LINKBASED;
+   else if (boost::iequals(lockType, kLockTypeLeaseBased))
+      return FileLock::LOCKTYPE_LEASEBASED;
    
    LOG_WARNING_MESSAGE("unrecognized lock type '" + lockType + "'");
    return FileLock::LOCKTYPE_LINKBASED;
@@ -133,6 +137,10 @@ void FileLock::initialize(const Settings& settings)
    // refresh rate
    double refreshRate = getFieldPositive(settings, "refresh-rate", kDefaultRefreshRate);
    FileLock::s_refreshRate = boost::posix_time::seconds(refreshRate);
+
+   // lease duration (lease-based locks only; defaults to the timeout interval)
+   double leaseDuration = getFieldPositive(settings, "lease-duration", timeoutInterval);
+   FileLock::s_leaseDuration = boost::posix_time::seconds(leaseDuration);
    
    // logging
    bool loggingEnabled = settings.getBool("enable-logging", false);
@@ -156,6 +164,7 @@ void FileLock::initialize(const Settings& settings)
 FileLock::LockType FileLock::s_defaultType(FileLock::LOCKTYPE_LINKBASED);
 boost::posix_time::seconds FileLock::s_timeoutInterval(kDefaultTimeoutInterval);
 boost::posix_time::seconds FileLock::s_refreshRate(kDefaultRefreshRate);
+boost::posix_time::seconds FileLock::s_leaseDuration(kDefaultTimeoutInterval);
 bool FileLock::s_loggingEnabled(false);
 
 boost::shared_ptr<FileLock> FileLock::create(LockType type)
@@ -164,8 +173,9 @@ boost::shared_ptr<FileLock> FileLock::create(LockType type)
    
    switch (type)
    {
-   case LOCKTYPE_ADVISORY:  return boost::shared_ptr<FileLock>(new AdvisoryFileLock());
-   case LOCKTYPE_LINKBASED: return boost::shared_ptr<FileLock>(new LinkBasedFileLock());
+   case LOCKTYPE_ADVISORY:   return boost::shared_ptr<FileLock>(new AdvisoryFileLock());
+   case LOCKTYPE_LINKBASED:  return boost::shared_ptr<FileLock>(new LinkBasedFileLock());
+   case LOCKTYPE_LEASEBASED: return boost::shared_ptr<FileLock>(new LeaseBasedFileLock());
    }
    
    // shouldn't be reached
@@ -183,6 +193,7 @@ void FileLock::refresh()
    verifyInitialized();
    AdvisoryFileLock::refresh();
    LinkBasedFileLock::refresh();
+   LeaseBasedFileLock::refresh();
 }
 
 void FileLock::cleanUp()
@@ -190,6 +201,7 @@ void FileLock::cleanUp()
    verifyInitialized();
    AdvisoryFileLock::cleanUp();
    LinkBasedFileLock::cleanUp();
+   LeaseBasedFileLock::cleanUp();
 }
 
 namespace {
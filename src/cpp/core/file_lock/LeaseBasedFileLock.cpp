@@ -0,0 +1,436 @@
+/*
+ * LeaseBasedFileLock.cpp
+ *
+ * Copyright (C) 2009-12 by RStudio, Inc.
+ *
+ * Unless you have received this program directly from RStudio pursuant
+ * to the terms of a commercial license agreement with RStudio, then
+ * this program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http://www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ *
+ */
+
+#include <core/FileLock.hpp>
+
+#include <errno.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <map>
+#include <vector>
+
+#include <core/SafeConvert.hpp>
+#include <core/Thread.hpp>
+#include <core/Error.hpp>
+#include <core/Log.hpp>
+#include <core/FilePath.hpp>
+#include <core/FileSerializer.hpp>
+#include <core/system/System.hpp>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/foreach.hpp>
+#include <boost/system/error_code.hpp>
+
+#define DEBUG(__X__)                                                           \
+   do                                                                          \
+   {                                                                           \
+      if (::rstudio::core::FileLock::isLoggingEnabled())                       \
+      {                                                                        \
+         std::stringstream ss;                                                 \
+         ss << "(PID " << ::getpid() << "): " << __X__;                        \
+         LOG_DEBUG_MESSAGE(ss.str());                                          \
+      }                                                                        \
+   } while (0)
+
+namespace rstudio {
+namespace core {
+
+namespace {
+
+// NOTE: a different prefix than the link-based lock so that proxy files
+// from the two backends never collide
+const char * const kLeaseLockPrefix =
+      ".rstudio-lease-41c29";
+
+std::string pidString()
+{
+   PidType pid = system::currentProcessId();
+   return safe_convert::numberToString((long) pid);
+}
+
+std::string hostName()
+{
+   char buffer[256];
+   int status = ::gethostname(buffer, 255);
+   if (status)
+      LOG_ERROR(systemError(errno, ERROR_LOCATION));
+   return std::string(buffer);
+}
+
+std::string threadId()
+{
+   std::stringstream ss;
+   ss << boost::this_thread::get_id();
+   return ss.str();
+}
+
+std::string proxyLockFileName()
+{
+   return std::string()
+         + kLeaseLockPrefix
+         + "-" + hostName()
+         + "-" + pidString()
+         + "-" + threadId();
+}
+
+// current time as milliseconds since the unix epoch (the resolution the
+// lease expiry is recorded at)
+boost::int64_t nowMilliseconds()
+{
+   using namespace boost::posix_time;
+   ptime epoch(boost::gregorian::date(1970, 1, 1));
+   return (microsec_clock::universal_time() - epoch).total_milliseconds();
+}
+
+boost::int64_t leaseDurationMilliseconds()
+{
+   return static_cast<boost::int64_t>(
+            FileLock::getLeaseDuration().total_seconds()) * 1000;
+}
+
+std::string leaseContents(boost::int64_t expiry)
+{
+   return safe_convert::numberToString(expiry);
+}
+
+// read the expiry recorded in a lease lockfile. returns false if the file
+// couldn't be read or didn't parse -- e.g. it was written by the link-based
+// backend, or a refresh rewrite was in flight -- in which case the caller
+// falls back to write-time staleness
+bool readLeaseExpiry(const FilePath& lockFilePath, boost::int64_t* pExpiry)
+{
+   std::string contents;
+   Error error = core::readStringFromFile(lockFilePath, &contents);
+   if (error)
+      return false;
+
+   boost::algorithm::trim(contents);
+   boost::int64_t expiry = safe_convert::stringTo<boost::int64_t>(contents, -1);
+   if (expiry < 0)
+      return false;
+
+   *pExpiry = expiry;
+   return true;
+}
+
+bool isLockFileStale(const FilePath& lockFilePath)
+{
+   return LeaseBasedFileLock::isLockFileStale(lockFilePath);
+}
+
+} // end anonymous namespace
+
+bool LeaseBasedFileLock::isLockFileStale(const FilePath& lockFilePath)
+{
+   // a lease lockfile is stale the moment its recorded expiry passes --
+   // no need to wait out the global timeout interval
+   boost::int64_t expiry = 0;
+   if (readLeaseExpiry(lockFilePath, &expiry))
+      return nowMilliseconds() > expiry;
+
+   // no parseable lease -- fall back to write-time staleness
+   double seconds = s_timeoutInterval.total_seconds();
+   double diff = ::difftime(::time(NULL), lockFilePath.lastWriteTime());
+   return diff >= seconds;
+}
+
+namespace {
+
+void cleanStaleLockfiles(const FilePath& dir)
+{
+   std::vector<FilePath> children;
+   Error error = dir.children(&children);
+   if (error)
+      LOG_ERROR(error);
+
+   BOOST_FOREACH(const FilePath& filePath, children)
+   {
+      if (boost::algorithm::starts_with(filePath.filename(), kLeaseLockPrefix) &&
+          isLockFileStale(filePath))
+      {
+         Error error = filePath.removeIfExists();
+         if (error)
+            LOG_ERROR(error);
+      }
+   }
+}
+
+class LeaseRegistration : boost::noncopyable
+{
+public:
+
+   void registerLock(const FilePath& lockFilePath)
+   {
+      LOCK_MUTEX(mutex_)
+      {
+         // schedule the first renewal at the lease midpoint
+         registration_[lockFilePath] =
+                        nowMilliseconds() + leaseDurationMilliseconds() / 2;
+      }
+      END_LOCK_MUTEX
+   }
+
+   void deregisterLock(const FilePath& lockFilePath)
+   {
+      LOCK_MUTEX(mutex_)
+      {
+         registration_.erase(lockFilePath);
+      }
+      END_LOCK_MUTEX
+   }
+
+   // renew held leases in a single pass. locks whose leases still have
+   // more than half their duration remaining are skipped, so a refresh
+   // sweep touches only the locks that actually need renewal rather than
+   // rewriting every lockfile every time
+   void refreshLocks()
+   {
+      LOCK_MUTEX(mutex_)
+      {
+         boost::int64_t now = nowMilliseconds();
+         for (std::map<FilePath, boost::int64_t>::iterator
+                 it = registration_.begin();
+              it != registration_.end();
+              ++it)
+         {
+            if (now < it->second)
+               continue;
+
+            // rewrite the lease in place. this isn't atomic, but a reader
+            // that catches a partial write simply fails to parse the lease
+            // and falls back to write-time staleness -- and the write time
+            // was just bumped by this very write
+            DEBUG("Renewing lease: " << it->first.absolutePath());
+            boost::int64_t expiry = now + leaseDurationMilliseconds();
+            Error error = core::writeStringToFile(it->first,
+                                                  leaseContents(expiry));
+            if (error)
+               LOG_ERROR(error);
+            else
+               it->second = now + leaseDurationMilliseconds() / 2;
+         }
+      }
+      END_LOCK_MUTEX
+   }
+
+   void clearLocks()
+   {
+      LOCK_MUTEX(mutex_)
+      {
+         for (std::map<FilePath, boost::int64_t>::const_iterator
+                 it = registration_.begin();
+              it != registration_.end();
+              ++it)
+         {
+            Error error = it->first.removeIfExists();
+            if (error)
+               LOG_ERROR(error);
+            DEBUG("Clearing lock: " << it->first.absolutePath());
+         }
+         registration_.clear();
+      }
+      END_LOCK_MUTEX
+   }
+
+private:
+
+   boost::mutex mutex_;
+   std::map<FilePath, boost::int64_t> registration_;
+};
+
+LeaseRegistration& leaseRegistration()
+{
+   static LeaseRegistration instance;
+   return instance;
+}
+
+Error writeLockFile(const FilePath& lockFilePath)
+{
+
+#ifndef _WIN32
+
+   // generate proxy lockfile
+   FilePath proxyPath = lockFilePath.parent().complete(proxyLockFileName());
+
+   // since the proxy lockfile should be unique, it should _never_ be possible
+   // for a collision to be found. if that does happen, it must be a leftover
+   // from a previous process that crashed in this stage
+   Error error = proxyPath.removeIfExists();
+   if (error)
+      LOG_ERROR(error);
+
+   // ensure the proxy file is created (with the initial lease recorded in
+   // it -- linking shares the inode so the lockfile picks up the contents),
+   // and remove it when we're done
+   RemoveOnExitScope scope(proxyPath, ERROR_LOCATION);
+   boost::int64_t expiry = nowMilliseconds() + leaseDurationMilliseconds();
+   error = core::writeStringToFile(proxyPath, leaseContents(expiry));
+   if (error)
+   {
+      // log the error since it isn't expected and could get swallowed
+      // upstream by a caller ignoring lock_not_available errors
+      LOG_ERROR(error);
+      return error;
+   }
+
+   // attempt to link to the desired location -- ignore return value
+   // and just stat our original link after, as that's a more reliable
+   // indicator of success on old NFS systems
+   int status = ::link(
+            proxyPath.absolutePathNative().c_str(),
+            lockFilePath.absolutePathNative().c_str());
+
+   // Log errors (remove this if it is too noisy on NFS)
+   if (status == -1)
+      LOG_ERROR(systemError(errno, ERROR_LOCATION));
+
+   struct stat info;
+   int errc = ::stat(proxyPath.absolutePathNative().c_str(), &info);
+   if (errc)
+   {
+      // log the error since it isn't expected and could get swallowed
+      // upstream by a caller ignoring lock_not_available errors
+      Error error = systemError(errno, ERROR_LOCATION);
+      LOG_ERROR(error);
+      return error;
+   }
+
+   // assume that a failure here is the result of someone else
+   // acquiring the lock before we could
+   if (info.st_nlink != 2)
+      return fileExistsError(ERROR_LOCATION);
+
+   return Success();
+
+#else
+
+   return systemError(boost::system::errc::function_not_supported, ERROR_LOCATION);
+
+#endif
+}
+
+} // end anonymous namespace
+
+struct LeaseBasedFileLock::Impl
+{
+   FilePath lockFilePath;
+};
+
+LeaseBasedFileLock::LeaseBasedFileLock()
+   : pImpl_(new Impl())
+{
+}
+
+LeaseBasedFileLock::~LeaseBasedFileLock()
+{
+}
+
+FilePath LeaseBasedFileLock::lockFilePath() const
+{
+   return pImpl_->lockFilePath;
+}
+
+bool LeaseBasedFileLock::isLocked(const FilePath& lockFilePath) const
+{
+   if (!lockFilePath.exists())
+      return false;
+
+   return !isLockFileStale(lockFilePath);
+}
+
+Error LeaseBasedFileLock::acquire(const FilePath& lockFilePath)
+{
+   // if the lock file exists...
+   if (lockFilePath.exists())
+   {
+      // ... and its lease has expired, it's a leftover lock from a
+      // previously (crashed?) process. remove it and acquire our own lock
+      if (isLockFileStale(lockFilePath))
+      {
+         // note that multiple processes may attempt to remove this
+         // file at the same time, so errors shouldn't be fatal
+         DEBUG("Removing stale lockfile: " << lockFilePath.absolutePath());
+         Error error = lockFilePath.remove();
+         if (error)
+            LOG_ERROR(error);
+      }
+
+      // ... the lease is still live -- someone else has the lock
+      else
+      {
+         DEBUG("No lock available: " << lockFilePath.absolutePath());
+         return systemError(boost::system::errc::no_lock_available,
+                            ERROR_LOCATION);
+      }
+   }
+
+   // ensure the parent directory exists
+   Error error = lockFilePath.parent().ensureDirectory();
+   if (error)
+      return error;
+
+   // write the lock file -- this step _must_ be atomic and so only one
+   // competing process should be able to succeed here
+   error = writeLockFile(lockFilePath);
+   if (error)
+   {
+      DEBUG("Failed to acquire lock (lost race?): " << lockFilePath.absolutePath());
+      return systemError(boost::system::errc::no_lock_available,
+                         error,
+                         ERROR_LOCATION);
+   }
+
+   // clean any other stale lockfiles in that directory
+   cleanStaleLockfiles(lockFilePath.parent());
+
+   // register our lock (for lease renewal)
+   pImpl_->lockFilePath = lockFilePath;
+   leaseRegistration().registerLock(lockFilePath);
+   DEBUG("Acquired lock: " << lockFilePath.absolutePath());
+   return Success();
+}
+
+Error LeaseBasedFileLock::release()
+{
+   const FilePath& lockFilePath = pImpl_->lockFilePath;
+   DEBUG("Released lock: " << lockFilePath.absolutePath());
+
+   Error error = lockFilePath.remove();
+   if (error)
+      LOG_ERROR(error);
+
+   pImpl_->lockFilePath = FilePath();
+   leaseRegistration().deregisterLock(lockFilePath);
+   return error;
+}
+
+void LeaseBasedFileLock::refresh()
+{
+   leaseRegistration().refreshLocks();
+}
+
+void LeaseBasedFileLock::cleanUp()
+{
+   leaseRegistration().clearLocks();
+}
+
+} // namespace core
+} // namespace rstudio
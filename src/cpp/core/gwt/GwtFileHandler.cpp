@@ -92,11 +92,22 @@ void handleFileRequest(const std::string& wwwLocalPath,
       return;
    }
    
+   // large files are transmitted zero-copy from disk (sendfile/mmap)
+   // rather than read into the response body. this deliberately skips
+   // gzip compression -- for payloads of this size the memcpy and
+   // compressor cpu cost more than the transfer savings on the
+   // connections we serve
+   const boost::uintmax_t kStreamFileThreshold = 1024 * 1024;
+   bool streamFile = filePath.size() >= kStreamFileThreshold;
+
    // case: files designated to be cached "forever"
    if (regex_match(uri, boost::regex(".*\\.cache\\..*")))
    {
       pResponse->setCacheForeverHeaders();
-      pResponse->setFile(filePath, request);
+      if (streamFile)
+         pResponse->setStreamFile(filePath, request);
+      else
+         pResponse->setFile(filePath, request);
    }
    
    // case: files designated to never be cached 
@@ -133,7 +144,27 @@ void handleFileRequest(const std::string& wwwLocalPath,
    {
       // since these are application components we force revalidation
       pResponse->setCacheWithRevalidationHeaders();
-      pResponse->setCacheableFile(filePath, request);
+      if (streamFile)
+      {
+         // preserve the revalidation semantics of setCacheableFile
+         using namespace boost::posix_time;
+         ptime lastModifiedDate = from_time_t(filePath.lastWriteTime());
+         pResponse->setHeader("Last-Modified",
+                              http::util::httpDate(lastModifiedDate));
+         if (lastModifiedDate == request.ifModifiedSince())
+         {
+            pResponse->removeHeader("Content-Type");
+            pResponse->setStatusCode(http::status::NotModified);
+         }
+         else
+         {
+            pResponse->setStreamFile(filePath, request);
+         }
+      }
+      else
+      {
+         pResponse->setCacheableFile(filePath, request);
+      }
    }
   
 }
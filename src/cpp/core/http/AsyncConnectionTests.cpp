@@ -0,0 +1,220 @@
+/*
+ * AsyncConnectionTests.cpp
+ *
+ * Copyright (C) 2009-16 by RStudio, Inc.
+ *
+ * Unless you have received this program directly from RStudio pursuant
+ * to the terms of a commercial license agreement with RStudio, then
+ * this program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http://www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ *
+ */
+
+#include <cstring>
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <core/http/AsyncConnectionImpl.hpp>
+#include <core/http/Request.hpp>
+#include <core/http/Response.hpp>
+
+// NOTE: TestThat.hpp must follow the asio includes -- its context()
+// macro would otherwise rewrite identifiers inside the asio headers
+#include <tests/TestThat.hpp>
+
+namespace rstudio {
+namespace core {
+namespace http {
+
+namespace {
+
+typedef AsyncConnectionImpl<boost::asio::ip::tcp> TcpConnection;
+
+// body source which serves a string in fixed-size blocks (sized smaller
+// than the connection's stream buffer so multi-chunk framing is
+// exercised)
+class StringBodySource : public ResponseBodySource
+{
+public:
+   StringBodySource(const std::string& body, std::size_t blockSize)
+      : body_(body), blockSize_(blockSize), offset_(0)
+   {
+   }
+
+   Error read(char* pBuffer, std::size_t bufferSize, std::size_t* pBytesRead)
+   {
+      std::size_t bytes = std::min(std::min(bufferSize, blockSize_),
+                                   body_.size() - offset_);
+      if (bytes > 0)
+         ::memcpy(pBuffer, body_.data() + offset_, bytes);
+      offset_ += bytes;
+      *pBytesRead = bytes;
+      return Success();
+   }
+
+private:
+   std::string body_;
+   std::size_t blockSize_;
+   std::size_t offset_;
+};
+
+void streamingHandler(const std::string& body,
+                      std::size_t blockSize,
+                      boost::shared_ptr<TcpConnection> pConnection,
+                      http::Request*)
+{
+   pConnection->response().setStatusCode(status::Ok);
+   pConnection->response().setContentType("text/plain");
+   boost::shared_ptr<ResponseBodySource> pSource(
+                                 new StringBodySource(body, blockSize));
+   pConnection->writeStreamedResponse(pSource);
+}
+
+void acceptHandler(boost::shared_ptr<TcpConnection> pConnection,
+                   const boost::system::error_code& e)
+{
+   if (!e)
+      pConnection->startReading();
+}
+
+// drive a request through a live connection on the loopback interface
+// and return the raw response bytes (the connection closes the socket
+// when the response is complete)
+std::string requestStreamedResponse(const std::string& body,
+                                    std::size_t blockSize)
+{
+   using boost::asio::ip::tcp;
+
+   // listen on an ephemeral loopback port
+   boost::asio::io_service ioService;
+   tcp::acceptor acceptor(
+            ioService,
+            tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+   unsigned short port = acceptor.local_endpoint().port();
+
+   // accept one connection and hand it to the streaming handler
+   boost::shared_ptr<TcpConnection> pConnection(new TcpConnection(
+            ioService,
+            boost::bind(streamingHandler, body, blockSize, _1, _2)));
+   acceptor.async_accept(pConnection->socket(),
+                         boost::bind(acceptHandler,
+                                     pConnection,
+                                     boost::asio::placeholders::error));
+
+   // service the connection on a background thread (run returns once
+   // the response is written and the socket is closed)
+   boost::thread serviceThread(
+            boost::bind(&boost::asio::io_service::run, &ioService));
+
+   // issue a blocking client request and read to connection close
+   std::string response;
+   try
+   {
+      tcp::socket clientSocket(ioService);
+      clientSocket.connect(tcp::endpoint(
+                              boost::asio::ip::address_v4::loopback(),
+                              port));
+      std::string request =
+            "GET /stream HTTP/1.1\r\n"
+            "Host: localhost\r\n"
+            "\r\n";
+      boost::asio::write(clientSocket, boost::asio::buffer(request));
+
+      boost::system::error_code ec;
+      for (;;)
+      {
+         boost::array<char, 8192> buffer;
+         std::size_t bytesRead = clientSocket.read_some(
+                                    boost::asio::buffer(buffer), ec);
+         if (bytesRead > 0)
+            response.append(buffer.data(), bytesRead);
+         if (ec)
+            break;
+      }
+   }
+   catch(...)
+   {
+   }
+
+   serviceThread.join();
+   return response;
+}
+
+// split a raw response into headers and a de-chunked body; returns
+// false if the chunked framing is malformed
+bool parseChunkedResponse(const std::string& raw,
+                          std::string* pHeaders,
+                          std::string* pBody)
+{
+   std::size_t headerEnd = raw.find("\r\n\r\n");
+   if (headerEnd == std::string::npos)
+      return false;
+   *pHeaders = raw.substr(0, headerEnd);
+
+   std::size_t pos = headerEnd + 4;
+   for (;;)
+   {
+      // chunk size line (hex)
+      std::size_t lineEnd = raw.find("\r\n", pos);
+      if (lineEnd == std::string::npos)
+         return false;
+      std::istringstream sizeStream(raw.substr(pos, lineEnd - pos));
+      std::size_t chunkSize = 0;
+      sizeStream >> std::hex >> chunkSize;
+      if (sizeStream.fail())
+         return false;
+      pos = lineEnd + 2;
+
+      // terminating chunk
+      if (chunkSize == 0)
+         return true;
+
+      // chunk data plus trailing crlf
+      if (pos + chunkSize + 2 > raw.size())
+         return false;
+      pBody->append(raw, pos, chunkSize);
+      if (raw.compare(pos + chunkSize, 2, "\r\n") != 0)
+         return false;
+      pos += chunkSize + 2;
+   }
+}
+
+} // anonymous namespace
+
+context("Async Connection Chunked Streaming")
+{
+   test_that("A multi-block body round trips via chunked encoding")
+   {
+      // a body large enough to require several chunks at this block size
+      std::string body;
+      for (int i = 0; i < 10000; i++)
+         body += "0123456789";
+      std::string raw = requestStreamedResponse(body, 8192);
+
+      std::string headers, streamedBody;
+      expect_true(parseChunkedResponse(raw, &headers, &streamedBody));
+      expect_true(headers.find("200 OK") != std::string::npos);
+      expect_true(headers.find("Transfer-Encoding: chunked") !=
+                  std::string::npos);
+      expect_true(streamedBody == body);
+   }
+
+   test_that("An empty body yields only the terminating chunk")
+   {
+      std::string raw = requestStreamedResponse("", 8192);
+
+      std::string headers, streamedBody;
+      expect_true(parseChunkedResponse(raw, &headers, &streamedBody));
+      expect_true(streamedBody.empty());
+   }
+}
+
+} // namespace http
+} // namespace core
+} // namespace rstudio
@@ -0,0 +1,198 @@
+/*
+ * LocalStreamSocketPool.cpp
+ *
+ * Copyright (C) 2009-16 by RStudio, Inc.
+ *
+ * Unless you have received this program directly from RStudio pursuant
+ * to the terms of a commercial license agreement with RStudio, then
+ * this program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http://www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ *
+ */
+
+#include <core/http/LocalStreamSocketPool.hpp>
+
+#include <map>
+
+#include <core/Log.hpp>
+
+namespace rstudio {
+namespace core {
+namespace http {
+
+namespace {
+
+// how long an idle connection is retained before being reaped. kept
+// comfortably short so a session which goes away while connections
+// are parked doesn't leave us holding dead sockets for long
+const int kIdleTimeoutSeconds = 30;
+
+} // anonymous namespace
+
+
+LocalStreamSocketPool::Slot::~Slot()
+{
+   try
+   {
+      ptrPool_->completed(ptrSocket_, pIoService_);
+   }
+   catch(...)
+   {
+   }
+}
+
+void LocalStreamSocketPool::Slot::recycle(boost::shared_ptr<Socket> ptrSocket)
+{
+   ptrSocket_ = ptrSocket;
+}
+
+
+boost::shared_ptr<LocalStreamSocketPool> LocalStreamSocketPool::forStreamPath(
+                                             const std::string& streamPath)
+{
+   static boost::mutex s_mutex;
+   static std::map<std::string, boost::shared_ptr<LocalStreamSocketPool> >
+                                                                     s_pools;
+   LOCK_MUTEX(s_mutex)
+   {
+      std::map<std::string,
+               boost::shared_ptr<LocalStreamSocketPool> >::const_iterator it =
+                                                   s_pools.find(streamPath);
+      if (it != s_pools.end())
+         return it->second;
+
+      boost::shared_ptr<LocalStreamSocketPool> ptrPool(
+                                             new LocalStreamSocketPool());
+      s_pools[streamPath] = ptrPool;
+      return ptrPool;
+   }
+   END_LOCK_MUTEX
+
+   // keep compiler happy
+   return boost::shared_ptr<LocalStreamSocketPool>();
+}
+
+LocalStreamSocketPool::LocalStreamSocketPool(std::size_t maxInFlight,
+                                             std::size_t maxIdle)
+   : maxInFlight_(maxInFlight),
+     maxIdle_(maxIdle),
+     inFlight_(0)
+{
+}
+
+void LocalStreamSocketPool::acquire(boost::asio::io_service& ioService,
+                                    const AcquiredHandler& handler)
+{
+   boost::shared_ptr<Slot> ptrSlot;
+   boost::shared_ptr<Socket> ptrSocket;
+   LOCK_MUTEX(mutex_)
+   {
+      reapIdleConnections();
+
+      if (inFlight_ < maxInFlight_)
+      {
+         inFlight_++;
+         ptrSlot.reset(new Slot(shared_from_this()));
+         ptrSlot->pIoService_ = &ioService;
+         ptrSocket = removeIdleConnection(&ioService);
+      }
+      else
+      {
+         pendingAcquires_.push_back(PendingAcquire(&ioService, handler));
+         return;
+      }
+   }
+   END_LOCK_MUTEX
+
+   // invoke the handler outside the lock
+   handler(ptrSlot, ptrSocket);
+}
+
+void LocalStreamSocketPool::completed(boost::shared_ptr<Socket> ptrSocket,
+                                      boost::asio::io_service* pIoService)
+{
+   boost::shared_ptr<Slot> ptrSlot;
+   boost::shared_ptr<Socket> ptrIdleSocket;
+   AcquiredHandler handler;
+   LOCK_MUTEX(mutex_)
+   {
+      inFlight_--;
+
+      // retain the connection for reuse if it's still open and we
+      // have room (otherwise just let it close when the last
+      // reference goes away)
+      if (ptrSocket && ptrSocket->is_open() &&
+          idleConnections_.size() < maxIdle_)
+      {
+         idleConnections_.push_back(IdleConnection(
+               ptrSocket,
+               pIoService,
+               boost::posix_time::microsec_clock::universal_time()));
+      }
+
+      reapIdleConnections();
+
+      // dispense a queued acquire now that a slot is free
+      if (!pendingAcquires_.empty())
+      {
+         PendingAcquire pending = pendingAcquires_.front();
+         pendingAcquires_.pop_front();
+
+         inFlight_++;
+         ptrSlot.reset(new Slot(shared_from_this()));
+         ptrSlot->pIoService_ = pending.pIoService;
+         ptrIdleSocket = removeIdleConnection(pending.pIoService);
+         handler = pending.handler;
+      }
+   }
+   END_LOCK_MUTEX
+
+   if (handler)
+      handler(ptrSlot, ptrIdleSocket);
+}
+
+boost::shared_ptr<LocalStreamSocketPool::Socket>
+LocalStreamSocketPool::removeIdleConnection(
+                                    boost::asio::io_service* pIoService)
+{
+   // prefer the most recently parked connection (it's the least
+   // likely to have gone stale). connections are bound to the
+   // io_service they were created against so only hand back a
+   // connection parked by a client of the same io_service
+   for (std::deque<IdleConnection>::reverse_iterator it =
+                                                idleConnections_.rbegin();
+        it != idleConnections_.rend();
+        ++it)
+   {
+      if (it->pIoService == pIoService)
+      {
+         boost::shared_ptr<Socket> ptrSocket = it->ptrSocket;
+         idleConnections_.erase(it.base() - 1);
+         return ptrSocket;
+      }
+   }
+   return boost::shared_ptr<Socket>();
+}
+
+void LocalStreamSocketPool::reapIdleConnections()
+{
+   boost::posix_time::ptime staleTime =
+         boost::posix_time::microsec_clock::universal_time() -
+         boost::posix_time::seconds(kIdleTimeoutSeconds);
+
+   // idle connections are appended in time order so reap from the front
+   while (!idleConnections_.empty() &&
+          idleConnections_.front().idleSince < staleTime)
+   {
+      boost::system::error_code ec;
+      idleConnections_.front().ptrSocket->close(ec);
+      idleConnections_.pop_front();
+   }
+}
+
+} // namespace http
+} // namespace core
+} // namespace rstudio
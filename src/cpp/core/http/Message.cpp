@@ -147,6 +147,7 @@ void Message::reset()
    httpVersion_.clear() ;
    headers_.clear() ;
    body_.clear() ;
+   bodyParts_.clear() ;
    
    // allow additional reseting by subclasses
    resetMembers() ;
@@ -200,6 +201,13 @@ std::vector<boost::asio::const_buffer> Message::toBuffers(
    // body
    buffers.push_back(boost::asio::buffer(body_)) ;
 
+   // additional body blocks (scatter/gather -- see setStreamedBody)
+   for (std::vector<std::string>::const_iterator
+        it = bodyParts_.begin(); it != bodyParts_.end(); ++it)
+   {
+      buffers.push_back(boost::asio::buffer(*it)) ;
+   }
+
    // return the buffers
    return buffers ;
 }
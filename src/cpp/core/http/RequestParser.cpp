@@ -22,6 +22,8 @@ namespace rstudio {
 namespace core {
 namespace http {
 
+const std::size_t RequestParser::kMaxBodyPrealloc;
+
 RequestParser::RequestParser()
   : state_(method_start), 
     content_length_(0), 
@@ -0,0 +1,119 @@
+/*
+ * RequestParserTests.cpp
+ *
+ * Copyright (C) 2009-16 by RStudio, Inc.
+ *
+ * Unless you have received this program directly from RStudio pursuant
+ * to the terms of a commercial license agreement with RStudio, then
+ * this program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http://www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ *
+ */
+
+#include <tests/TestThat.hpp>
+
+#include <core/http/Request.hpp>
+#include <core/http/RequestParser.hpp>
+
+namespace rstudio {
+namespace core {
+namespace http {
+
+context("Http Request Parser")
+{
+   test_that("A complete request parses in one pass")
+   {
+      std::string input =
+            "POST /rpc/console_input HTTP/1.1\r\n"
+            "Host: localhost\r\n"
+            "Content-Type: application/json\r\n"
+            "Content-Length: 12\r\n"
+            "\r\n"
+            "{\"a\":\"abc\"}\n";
+
+      RequestParser parser;
+      Request request;
+      RequestParser::status status = parser.parse(request,
+                                                  input.data(),
+                                                  input.data() +
+                                                  input.length());
+      expect_true(status == RequestParser::complete);
+      expect_true(request.method() == "POST");
+      expect_true(request.uri() == "/rpc/console_input");
+      expect_true(request.headerValue("Host") == "localhost");
+      expect_true(request.body() == "{\"a\":\"abc\"}\n");
+   }
+
+   test_that("A request split across buffers parses correctly")
+   {
+      std::string input =
+            "GET /index.htm HTTP/1.1\r\n"
+            "Accept-Encoding: gzip\r\n"
+            "\r\n";
+
+      RequestParser parser;
+      Request request;
+
+      // feed one byte at a time to exercise every split point
+      RequestParser::status status = RequestParser::incomplete;
+      for (std::size_t i = 0; i < input.length(); i++)
+      {
+         status = parser.parse(request,
+                               input.data() + i,
+                               input.data() + i + 1);
+         if (i < input.length() - 1)
+            expect_true(status == RequestParser::incomplete);
+      }
+      expect_true(status == RequestParser::complete);
+      expect_true(request.method() == "GET");
+      expect_true(request.uri() == "/index.htm");
+      expect_true(request.headerValue("Accept-Encoding") == "gzip");
+   }
+
+   test_that("A body split across buffers is accumulated")
+   {
+      std::string headers =
+            "POST /upload HTTP/1.1\r\n"
+            "Content-Length: 10\r\n"
+            "\r\n";
+
+      RequestParser parser;
+      Request request;
+      RequestParser::status status = parser.parse(request,
+                                                  headers.data(),
+                                                  headers.data() +
+                                                  headers.length());
+      expect_true(status == RequestParser::incomplete);
+
+      std::string part1 = "01234";
+      std::string part2 = "56789";
+      status = parser.parse(request,
+                            part1.data(),
+                            part1.data() + part1.length());
+      expect_true(status == RequestParser::incomplete);
+      status = parser.parse(request,
+                            part2.data(),
+                            part2.data() + part2.length());
+      expect_true(status == RequestParser::complete);
+      expect_true(request.body() == "0123456789");
+   }
+
+   test_that("Malformed requests are rejected")
+   {
+      std::string input = "BOGUS\x01 / HTTP/1.1\r\n\r\n";
+      RequestParser parser;
+      Request request;
+      RequestParser::status status = parser.parse(request,
+                                                  input.data(),
+                                                  input.data() +
+                                                  input.length());
+      expect_true(status == RequestParser::error);
+   }
+}
+
+} // namespace http
+} // namespace core
+} // namespace rstudio
@@ -61,6 +61,33 @@ void Response::setContentEncoding(const std::string& encoding)
    setHeader("Content-Encoding", encoding);
 }
 
+void Response::setStreamFile(const FilePath& filePath, const Request& request)
+{
+   if (!filePath.exists())
+   {
+      setNotFoundError(request.uri());
+      return;
+   }
+
+   // the bytes are transmitted directly from disk so no filtering or
+   // compression is possible
+   removeHeader("Content-Encoding");
+   setContentType(filePath.mimeContentType());
+   setContentLength(filePath.size());
+   streamFilePath_ = filePath.absolutePath();
+}
+
+void Response::setChunkedTransferEncoding()
+{
+   removeHeader("Content-Length");
+   setHeader("Transfer-Encoding", "chunked");
+}
+
+bool Response::isChunkedTransferEncoding() const
+{
+   return headerValue("Transfer-Encoding") == "chunked";
+}
+
 void Response::setCacheWithRevalidationHeaders()
 {
    setHeader("Expires", http::util::httpDate());
@@ -128,6 +155,131 @@ Error Response::setBody(const std::string& content)
    return setBody(is);
 }
 
+namespace {
+
+// streambuf which appends written data to a sequence of bounded-size
+// blocks (each block later becomes its own const_buffer via toBuffers)
+class BodyPartsStreamBuf : public std::streambuf
+{
+   static const std::size_t kBlockSize = 64 * 1024;
+
+public:
+   explicit BodyPartsStreamBuf(std::vector<std::string>* pParts)
+      : pParts_(pParts)
+   {
+   }
+
+protected:
+   virtual int_type overflow(int_type ch)
+   {
+      if (ch != traits_type::eof())
+      {
+         char c = traits_type::to_char_type(ch);
+         xsputn(&c, 1);
+      }
+      return ch;
+   }
+
+   virtual std::streamsize xsputn(const char* pData, std::streamsize count)
+   {
+      std::streamsize remaining = count;
+      while (remaining > 0)
+      {
+         if (pParts_->empty() || pParts_->back().length() >= kBlockSize)
+         {
+            pParts_->push_back(std::string());
+            pParts_->back().reserve(kBlockSize);
+         }
+
+         std::string& block = pParts_->back();
+         std::size_t available = kBlockSize - block.length();
+         std::size_t write = std::min(static_cast<std::size_t>(remaining),
+                                      available);
+         block.append(pData, write);
+         pData += write;
+         remaining -= write;
+      }
+      return count;
+   }
+
+private:
+   std::vector<std::string>* pParts_;
+};
+
+} // anonymous namespace
+
+Error Response::gzipCompressBody()
+{
+#ifdef _WIN32
+   // never gzip on win32 (see setBody)
+   return Success();
+#else
+   try
+   {
+      // compress into a new block list (so arbitrarily large bodies
+      // never require a single contiguous allocation)
+      std::vector<std::string> compressedParts;
+      BodyPartsStreamBuf streamBuf(&compressedParts);
+      std::ostream compressedStream(&streamBuf);
+
+      boost::iostreams::filtering_ostream filteringStream;
+      filteringStream.push(boost::iostreams::gzip_compressor());
+      filteringStream.push(compressedStream);
+
+      filteringStream.write(body_.data(), body_.length());
+      for (std::size_t i = 0; i < bodyParts_.size(); i++)
+         filteringStream.write(bodyParts_[i].data(), bodyParts_[i].length());
+      filteringStream.reset(); // flush the compressor
+
+      // swap in the compressed body
+      body_.clear();
+      bodyParts_.swap(compressedParts);
+
+      // update headers
+      setContentEncoding(kGzipEncoding);
+      std::size_t contentLength = 0;
+      for (std::size_t i = 0; i < bodyParts_.size(); i++)
+         contentLength += bodyParts_[i].length();
+      setContentLength(contentLength);
+
+      return Success();
+   }
+   catch(const std::exception& e)
+   {
+      Error error = systemError(boost::system::errc::io_error,
+                                ERROR_LOCATION);
+      error.addProperty("what", e.what());
+      return error;
+   }
+#endif
+}
+
+Error Response::setStreamedBody(
+               const boost::function<void(std::ostream&)>& writeBody)
+{
+   // reset any existing body
+   body_.clear();
+   bodyParts_.clear();
+
+   // stream directly into the body block list
+   BodyPartsStreamBuf streamBuf(&bodyParts_);
+   std::ostream bodyStream(&streamBuf);
+   writeBody(bodyStream);
+   if (bodyStream.fail())
+   {
+      bodyParts_.clear();
+      return systemError(boost::system::errc::io_error, ERROR_LOCATION);
+   }
+
+   // set content length from the accumulated blocks
+   std::size_t contentLength = 0;
+   for (std::size_t i = 0; i < bodyParts_.size(); i++)
+      contentLength += bodyParts_[i].length();
+   setContentLength(contentLength);
+
+   return Success();
+}
+
 Error Response::setCacheableBody(const FilePath& filePath,
                                  const Request& request)
 {
@@ -157,7 +309,80 @@ void Response::setDynamicHtml(const std::string& html,
 void Response::setRangeableFile(const FilePath& filePath,
                                 const Request& request)
 {
-   // read the file in from disk
+   // if a byte range was requested then read only that range from disk --
+   // this path serves arbitrarily large files (e.g. file downloads) and a
+   // range request shouldn't pull the entire file into memory
+   std::string range = request.headerValue("Range");
+   boost::regex re("bytes=(\\d*)\\-(\\d*)");
+   boost::smatch match;
+   if (boost::regex_match(range, match, re))
+   {
+      // determine the byte range (same semantics as the string overload)
+      const size_t kNone = -1;
+      size_t begin = safe_convert::stringTo<size_t>(match[1], kNone);
+      size_t end = safe_convert::stringTo<size_t>(match[2], kNone);
+      size_t total = filePath.size();
+
+      if (end == kNone)
+      {
+         end = total-1;
+      }
+      if (begin == kNone)
+      {
+         begin = total - end;
+         end = total-1;
+      }
+
+      if (begin <= end && end < total)
+      {
+         // open the file and seek to the beginning of the range
+         boost::shared_ptr<std::istream> pIfs;
+         Error error = filePath.open_r(&pIfs);
+         if (error)
+         {
+            setError(error);
+            return;
+         }
+
+         std::string contents;
+         try
+         {
+            pIfs->exceptions(std::istream::failbit | std::istream::badbit);
+            pIfs->seekg(begin);
+            contents.resize(end - begin + 1);
+            pIfs->read(&(contents[0]), contents.size());
+         }
+         catch(const std::ios_base::failure& e)
+         {
+            Error error = systemError(boost::system::errc::io_error,
+                                      ERROR_LOCATION);
+            error.addProperty("what", e.what());
+            error.addProperty("path", filePath.absolutePath());
+            setError(error);
+            return;
+         }
+
+         // specify partial content
+         setContentType(filePath.mimeContentType());
+         setStatusCode(http::status::PartialContent);
+
+         // set the byte range
+         addHeader("Accept-Ranges", "bytes");
+         boost::format fmt("bytes %1%-%2%/%3%");
+         addHeader("Content-Range", boost::str(fmt % begin % end % total));
+
+         // always attempt gzip
+         if (request.acceptsEncoding(http::kGzipEncoding))
+            setContentEncoding(http::kGzipEncoding);
+
+         // set body
+         setBody(contents);
+         return;
+      }
+   }
+
+   // no (valid) range requested -- read the file in from disk and let the
+   // string overload generate the full response or range error
    std::string contents;
    Error error = core::readStringFromFile(filePath, &contents);
    if (error)
@@ -290,6 +515,7 @@ void Response::resetMembers()
 	statusCode_ = status::Ok ;
 	statusCodeStr_.clear() ;
 	statusMessage_.clear() ;
+	streamFilePath_.clear() ;
 }
    
 void Response::removeCachingHeaders()
@@ -24,6 +24,7 @@
 
 #include <core/http/SocketProxy.hpp>
 
+#include <algorithm>
 #include <iostream>
 
 #include <boost/bind.hpp>
@@ -41,28 +42,140 @@ namespace rstudio {
 namespace core {
 namespace http {
 
+namespace {
+
+// read buffer sizing bounds -- interactive traffic (e.g. shiny
+// reactivity over websockets) stays at the minimum while bulk
+// transfers (file downloads through the proxy) grow toward the
+// maximum
+const std::size_t kMinReadBufferSize = 8192;
+const std::size_t kMaxReadBufferSize = 256 * 1024;
+
+// stop reading ahead of the writer once this much data is queued
+// (bounds memory when one side is much faster than the other)
+const std::size_t kMaxQueuedBytes = 1024 * 1024;
+
+} // anonymous namespace
+
+SocketProxy::Relay::Relay()
+   : readBufferSize(kMinReadBufferSize),
+     queuedBytes(0),
+     readPending(false),
+     writePending(false)
+{
+}
+
 void SocketProxy::readClient()
 {
-   ptrClient_->asyncReadSome(
-        boost::asio::buffer(clientBuffer_),
-         boost::bind(
-            &SocketProxy::handleClientRead,
-            SocketProxy::shared_from_this(),
-            boost::asio::placeholders::error,
-            boost::asio::placeholders::bytes_transferred));
+   LOCK_MUTEX(socketMutex_)
+   {
+      startRead(true);
+   }
+   END_LOCK_MUTEX
 }
 
 void SocketProxy::readServer()
 {
-   ptrServer_->asyncReadSome(
-        boost::asio::buffer(serverBuffer_),
+   LOCK_MUTEX(socketMutex_)
+   {
+      startRead(false);
+   }
+   END_LOCK_MUTEX
+}
+
+void SocketProxy::startRead(bool fromClient)
+{
+   Relay& relay = fromClient ? clientToServer_ : serverToClient_;
+   core::http::Socket& source = fromClient ? *ptrClient_ : *ptrServer_;
+
+   relay.readBuffer.resize(relay.readBufferSize);
+   relay.readPending = true;
+   source.asyncReadSome(
+        boost::asio::buffer(&(relay.readBuffer[0]), relay.readBuffer.size()),
          boost::bind(
-            &SocketProxy::handleServerRead,
+            fromClient ? &SocketProxy::handleClientRead
+                       : &SocketProxy::handleServerRead,
             SocketProxy::shared_from_this(),
             boost::asio::placeholders::error,
             boost::asio::placeholders::bytes_transferred));
 }
 
+void SocketProxy::startWrite(Relay* pRelay)
+{
+   // coalesce everything queued into a single scatter-gather write
+   pRelay->writingChunks.swap(pRelay->queuedChunks);
+   pRelay->queuedBytes = 0;
+
+   std::vector<boost::asio::const_buffer> buffers;
+   buffers.reserve(pRelay->writingChunks.size());
+   for (std::deque<std::string>::const_iterator
+        it = pRelay->writingChunks.begin();
+        it != pRelay->writingChunks.end();
+        ++it)
+   {
+      buffers.push_back(boost::asio::buffer(*it));
+   }
+
+   bool toServer = (pRelay == &clientToServer_);
+   core::http::Socket& dest = toServer ? *ptrServer_ : *ptrClient_;
+
+   pRelay->writePending = true;
+   dest.asyncWrite(buffers,
+                   boost::bind(
+                      toServer ? &SocketProxy::handleServerWrite
+                               : &SocketProxy::handleClientWrite,
+                      SocketProxy::shared_from_this(),
+                      boost::asio::placeholders::error,
+                      boost::asio::placeholders::bytes_transferred));
+}
+
+void SocketProxy::onRead(Relay* pRelay, std::size_t bytesTransferred)
+{
+   pRelay->readPending = false;
+
+   // adapt the read buffer to the traffic -- grow when reads are
+   // filling it, shrink back when they are mostly empty
+   if (bytesTransferred == pRelay->readBufferSize)
+   {
+      pRelay->readBufferSize = std::min(pRelay->readBufferSize * 2,
+                                        kMaxReadBufferSize);
+   }
+   else if (bytesTransferred < pRelay->readBufferSize / 4)
+   {
+      pRelay->readBufferSize = std::max(pRelay->readBufferSize / 2,
+                                        kMinReadBufferSize);
+   }
+
+   // queue the chunk
+   pRelay->queuedChunks.push_back(std::string(&(pRelay->readBuffer[0]),
+                                              bytesTransferred));
+   pRelay->queuedBytes += bytesTransferred;
+
+   // batch it into a write if one isn't already in flight
+   if (!pRelay->writePending)
+      startWrite(pRelay);
+
+   // keep reading ahead of the writer (the in-flight write and the
+   // next read overlap) unless too much data is already queued, in
+   // which case the read is resumed when the write completes
+   if (pRelay->queuedBytes < kMaxQueuedBytes)
+      startRead(pRelay == &clientToServer_);
+}
+
+void SocketProxy::onWriteComplete(Relay* pRelay)
+{
+   pRelay->writePending = false;
+   pRelay->writingChunks.clear();
+
+   // write anything which arrived while the last write was in flight
+   if (!pRelay->queuedChunks.empty())
+      startWrite(pRelay);
+
+   // resume reading if we had stalled on the queued-bytes watermark
+   if (!pRelay->readPending)
+      startRead(pRelay == &clientToServer_);
+}
+
 void SocketProxy::handleClientRead(const boost::system::error_code& e,
                                    std::size_t bytesTransferred)
 {
@@ -74,15 +187,7 @@ void SocketProxy::handleClientRead(const boost::system::error_code& e,
    {
       if (!e)
       {
-         std::vector<boost::asio::const_buffer> buffers;
-         buffers.push_back(boost::asio::buffer(clientBuffer_.data(),
-                                               bytesTransferred));
-         ptrServer_->asyncWrite(buffers,
-                                boost::bind(
-                                   &SocketProxy::handleServerWrite,
-                                   SocketProxy::shared_from_this(),
-                                   boost::asio::placeholders::error,
-                                   boost::asio::placeholders::bytes_transferred));
+         onRead(&clientToServer_, bytesTransferred);
       }
       else
       {
@@ -99,15 +204,7 @@ void SocketProxy::handleServerRead(const boost::system::error_code& e,
    {
       if (!e)
       {
-         std::vector<boost::asio::const_buffer> buffers;
-         buffers.push_back(boost::asio::buffer(serverBuffer_.data(),
-                                               bytesTransferred));
-         ptrClient_->asyncWrite(buffers,
-                                boost::bind(
-                                   &SocketProxy::handleClientWrite,
-                                   SocketProxy::shared_from_this(),
-                                   boost::asio::placeholders::error,
-                                   boost::asio::placeholders::bytes_transferred));
+         onRead(&serverToClient_, bytesTransferred);
       }
       else
       {
@@ -120,27 +217,35 @@ void SocketProxy::handleServerRead(const boost::system::error_code& e,
 void SocketProxy::handleClientWrite(const boost::system::error_code& e,
                                     std::size_t bytesTransferred)
 {
-   if (!e)
-   {
-      readServer();
-   }
-   else
+   LOCK_MUTEX(socketMutex_)
    {
-      handleError(e, ERROR_LOCATION);
+      if (!e)
+      {
+         onWriteComplete(&serverToClient_);
+      }
+      else
+      {
+         handleError(e, ERROR_LOCATION);
+      }
    }
+   END_LOCK_MUTEX
 }
 
 void SocketProxy::handleServerWrite(const boost::system::error_code& e,
                                     std::size_t bytesTransferred)
 {
-   if (!e)
-   {
-      readClient();
-   }
-   else
+   LOCK_MUTEX(socketMutex_)
    {
-      handleError(e, ERROR_LOCATION);
+      if (!e)
+      {
+         onWriteComplete(&clientToServer_);
+      }
+      else
+      {
+         handleError(e, ERROR_LOCATION);
+      }
    }
+   END_LOCK_MUTEX
 }
 
 namespace {
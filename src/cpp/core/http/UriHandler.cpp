@@ -73,25 +73,64 @@ void UriHandler::operator()(const Request& request,
    function_(request, cont);
 }
    
-void UriHandlers::add(const UriHandler& handler) 
+void UriHandlers::add(const UriHandler& handler)
 {
    uriHandlers_.push_back(handler);
+
+   // rebuild the dispatch trie from scratch. registration is rare and
+   // the handler set is small, so a full rebuild is cheap -- and since
+   // lookups share trie nodes across copies of UriHandlers (the nodes
+   // are held by shared_ptr) rebuilding with fresh nodes ensures an add
+   // to one copy never mutates a trie another copy is reading
+   boost::shared_ptr<PrefixNode> pRoot(new PrefixNode());
+   for (std::size_t h = 0; h < uriHandlers_.size(); h++)
+   {
+      PrefixNode* pNode = pRoot.get();
+      const std::string& prefix = uriHandlers_[h].prefix();
+      for (std::size_t i = 0; i < prefix.length(); i++)
+      {
+         boost::shared_ptr<PrefixNode>& pChild = pNode->children[prefix[i]];
+         if (!pChild)
+            pChild.reset(new PrefixNode());
+         pNode = pChild.get();
+      }
+
+      // first registration of a given prefix wins (matches the order
+      // the previous linear scan would have found them in)
+      if (pNode->handlerIndex == -1)
+         pNode->handlerIndex = static_cast<int>(h);
+   }
+   prefixTree_ = pRoot;
 }
 
 UriAsyncHandlerFunction UriHandlers::handlerFor(const std::string& uri) const
 {
-   std::vector<UriHandler>::const_iterator handler = std::find_if(
-                              uriHandlers_.begin(), 
-                              uriHandlers_.end(), 
-                              boost::bind(&UriHandler::matches, _1, uri));
-   if ( handler != uriHandlers_.end() )
+   // walk the trie along the uri collecting every registered prefix it
+   // passes through. the linear scan this replaces returned the first
+   // registered handler whose prefix matched (not the longest match),
+   // so among the prefixes found we select the earliest registration
+   int match = -1;
+   const PrefixNode* pNode = prefixTree_.get();
+   for (std::size_t i = 0; pNode != NULL; i++)
    {
-      return handler->function();
+      if (pNode->handlerIndex != -1 &&
+          (match == -1 || pNode->handlerIndex < match))
+      {
+         match = pNode->handlerIndex;
+      }
+
+      if (i == uri.length())
+         break;
+
+      std::map<char, boost::shared_ptr<PrefixNode> >::const_iterator it =
+                                              pNode->children.find(uri[i]);
+      pNode = (it != pNode->children.end()) ? it->second.get() : NULL;
    }
+
+   if (match != -1)
+      return uriHandlers_[match].function();
    else
-   {
       return UriAsyncHandlerFunction();
-   }
 }
    
 } // namespace http
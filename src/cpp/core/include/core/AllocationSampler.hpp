@@ -0,0 +1,47 @@
+/*
+ * AllocationSampler.hpp
+ *
+ * Copyright (C) 2009-16 by RStudio, Inc.
+ *
+ * Unless you have received this program directly from RStudio pursuant
+ * to the terms of a commercial license agreement with RStudio, then
+ * this program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http://www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ *
+ */
+
+#ifndef CORE_ALLOCATION_SAMPLER_HPP
+#define CORE_ALLOCATION_SAMPLER_HPP
+
+#include <iosfwd>
+
+namespace rstudio {
+namespace core {
+namespace allocation_sampler {
+
+// sampled allocation tracking for attributing slow rss growth in
+// long-lived production sessions, where a full heap profiler can't be
+// attached. compiled in only when RSTUDIO_ALLOCATION_SAMPLER is
+// defined (cmake option of the same name); all functions are no-ops
+// otherwise. when active, every Nth call to operator new records the
+// allocation size and call stack in a fixed-size ring buffer; dump()
+// aggregates the sampled stacks by call site and symbolizes them via
+// core::backtrace
+
+// begin sampling (interval is the number of allocations per sample)
+void initialize(unsigned interval);
+
+// whether the sampler is compiled in and active
+bool enabled();
+
+// aggregate, symbolize, and write out the ring buffer contents
+void dump(std::ostream& os);
+
+} // namespace allocation_sampler
+} // namespace core
+} // namespace rstudio
+
+#endif // CORE_ALLOCATION_SAMPLER_HPP
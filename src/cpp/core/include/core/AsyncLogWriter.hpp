@@ -0,0 +1,80 @@
+/*
+ * AsyncLogWriter.hpp
+ *
+ * Copyright (C) 2009-12 by RStudio, Inc.
+ *
+ * Unless you have received this program directly from RStudio pursuant
+ * to the terms of a commercial license agreement with RStudio, then
+ * this program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http://www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ *
+ */
+
+#ifndef ASYNC_LOG_WRITER_HPP
+#define ASYNC_LOG_WRITER_HPP
+
+#include <deque>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+
+#include <core/BoostThread.hpp>
+#include <core/LogWriter.hpp>
+
+namespace rstudio {
+namespace core {
+
+// decorates another LogWriter so that messages are written on a
+// dedicated background thread rather than inline on the calling
+// thread (which for FileLogWriter means an open-append-close, and
+// potentially an fsync-bound stall, per message). messages are queued
+// into a bounded buffer -- if a sustained error storm outruns the
+// writer the excess messages are dropped and a summary of the drop is
+// logged once the backlog clears
+class AsyncLogWriter : public LogWriter, boost::noncopyable
+{
+public:
+   explicit AsyncLogWriter(boost::shared_ptr<LogWriter> pTarget);
+
+   // flushes any pending messages before returning
+   virtual ~AsyncLogWriter();
+
+   virtual void log(core::system::LogLevel level,
+                    const std::string& message);
+
+   virtual void log(const std::string& programIdentity,
+                    core::system::LogLevel level,
+                    const std::string& message);
+
+   virtual void setLogToStderr(bool logToStderr);
+
+private:
+   struct LogEntry
+   {
+      LogEntry() : level(core::system::kLogLevelInfo) {}
+
+      std::string programIdentity;
+      core::system::LogLevel level;
+      std::string message;
+   };
+
+   void writerThread();
+
+   boost::shared_ptr<LogWriter> pTarget_;
+
+   boost::mutex mutex_;
+   boost::condition_variable condition_;
+   std::deque<LogEntry> pendingEntries_;
+   unsigned int droppedEntries_;
+   bool stopRequested_;
+
+   boost::thread thread_;
+};
+
+} // namespace core
+} // namespace rstudio
+
+#endif // ASYNC_LOG_WRITER_HPP
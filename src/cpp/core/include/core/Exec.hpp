@@ -16,6 +16,8 @@
 #ifndef CORE_EXEC_HPP
 #define CORE_EXEC_HPP
 
+#include <string>
+#include <utility>
 #include <vector>
 
 #include <boost/function.hpp>
@@ -23,47 +25,58 @@
 namespace rstudio {
 namespace core {
 
-class Error ;   
-   
+class Error ;
+
 class ExecBlock
 {
 public:
-   typedef boost::function<core::Error()> Function ; 
+   typedef boost::function<core::Error()> Function ;
 
 public:
    ExecBlock() {}
-  
+
     // COPYING: via compiler (copyable members)
-   
+
    // add to the block
    ExecBlock& add(Function function) ;
-   
+
+   // add to the block with a name -- named functions are timed into the
+   // performance statistics accumulator (see PerformanceTimer.hpp) when
+   // the block executes, which gives e.g. per-module timings for the
+   // session startup sequence
+   ExecBlock& add(const char* name, Function function) ;
+
    // easy init style (based on idiom in boost::program_options)
    class EasyInit;
    EasyInit addFunctions() { return EasyInit(this); }
-   
+
    // execute the block
    core::Error execute() const;
-   
+
    // allow an ExecBlock to act as a boost::function<core::Error()>
    core::Error operator()() const;
-   
+
 public:
    // easy init helper class
    class EasyInit
    {
    public:
       EasyInit(ExecBlock* pExecBlock) : pExecBlock_(pExecBlock) {}
-      EasyInit& operator()(Function function) 
+      EasyInit& operator()(Function function)
       {
          pExecBlock_->add(function);
          return *this;
       }
+      EasyInit& operator()(const char* name, Function function)
+      {
+         pExecBlock_->add(name, function);
+         return *this;
+      }
    private:
       ExecBlock* pExecBlock_ ;
    };
 private:
-   std::vector<Function> functions_ ;
+   std::vector<std::pair<std::string, Function> > functions_ ;
 };
    
 
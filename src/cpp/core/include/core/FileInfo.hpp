@@ -89,7 +89,19 @@ public:
    }
    
 public:
+   // NOTE: this deliberately returns a non-shared copy (via c_str) so
+   // that FileInfo objects can be freely copied across threads without
+   // copy-on-write string aliasing
    std::string absolutePath() const { return absolutePath_.c_str(); }
+
+   // read-only reference to the stored path -- used by the comparison
+   // helpers below so that sorting and searching large tree<FileInfo>
+   // collections (e.g. file monitor registrations covering hundreds of
+   // thousands of files) doesn't materialize two path copies per
+   // comparison. callers which store or modify the result should use
+   // absolutePath() instead
+   const std::string& absolutePathRef() const { return absolutePath_; }
+
    bool isDirectory() const { return isDirectory_; }
    uintmax_t size() const { return size_; }
    std::time_t lastWriteTime() const { return lastWriteTime_; }
@@ -105,7 +117,8 @@ private:
    
 inline int fileInfoPathCompare(const FileInfo& a, const FileInfo& b)
 {
-   int result = ::strcmp(a.absolutePath().c_str(), b.absolutePath().c_str());
+   int result = ::strcmp(a.absolutePathRef().c_str(),
+                         b.absolutePathRef().c_str());
 
    if (result != 0)
       return result;
@@ -124,12 +137,12 @@ inline bool fileInfoPathLessThan(const FileInfo& a, const FileInfo& b)
 
 inline bool fileInfoHasPath(const FileInfo& fileInfo, const std::string& path)
 {
-   return fileInfo.absolutePath() == path;
+   return fileInfo.absolutePathRef() == path;
 }
 
 inline FilePath toFilePath(const FileInfo& fileInfo)
 {
-   return FilePath(fileInfo.absolutePath());
+   return FilePath(fileInfo.absolutePathRef());
 }
 
 inline FileInfo toFileInfo(const FilePath& filePath)
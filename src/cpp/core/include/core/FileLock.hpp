@@ -43,7 +43,7 @@ class FileLock : boost::noncopyable
 {
 public:
    
-   enum LockType { LOCKTYPE_ADVISORY, LOCKTYPE_LINKBASED };
+   enum LockType { LOCKTYPE_ADVISORY, LOCKTYPE_LINKBASED, LOCKTYPE_LEASEBASED };
    
    // initialize (read configuration)
    static void initialize(FilePath locksConfPath = FilePath());
@@ -86,6 +86,7 @@ public:
    static LockType getDefaultType() { return s_defaultType; }
    static boost::posix_time::seconds getTimeoutInterval() { return s_timeoutInterval; }
    static boost::posix_time::seconds getRefreshRate() { return s_refreshRate; }
+   static boost::posix_time::seconds getLeaseDuration() { return s_leaseDuration; }
    static bool isLoggingEnabled() { return s_loggingEnabled; }
    static bool isNoLockAvailable(const Error& error)
    {
@@ -96,6 +97,7 @@ protected:
    static LockType s_defaultType;
    static boost::posix_time::seconds s_timeoutInterval;
    static boost::posix_time::seconds s_refreshRate;
+   static boost::posix_time::seconds s_leaseDuration;
    static bool s_loggingEnabled;
 };
 
@@ -138,6 +140,33 @@ private:
    boost::scoped_ptr<Impl> pImpl_;
 };
 
+// variant of the link-based lock which records its own lease expiry in the
+// lockfile contents rather than relying on the global timeout applied to
+// the file's write time. this makes staleness detection immediate once a
+// lease expires (instead of waiting out the full timeout interval) and
+// allows refresh sweeps to skip locks whose leases still have plenty of
+// runway, reducing metadata traffic on network filesystems. like write-time
+// staleness, it assumes loosely synchronized clocks between hosts
+class LeaseBasedFileLock : public FileLock
+{
+public:
+   static bool isLockFileStale(const FilePath& lockFilePath);
+   static void refresh();
+   static void cleanUp();
+
+   Error acquire(const FilePath& lockFilePath);
+   Error release();
+   bool isLocked(const FilePath& lockFilePath) const;
+   FilePath lockFilePath() const;
+
+   LeaseBasedFileLock();
+   ~LeaseBasedFileLock();
+
+private:
+   struct Impl;
+   boost::scoped_ptr<Impl> pImpl_;
+};
+
 } // namespace core
 } // namespace rstudio
 
@@ -206,6 +206,22 @@ std::ostream& operator << (std::ostream& stream, const FilePath& fp) ;
 
 bool compareAbsolutePathNoCase(const FilePath& file1, const FilePath& file2);
 
+// Opt-in stat cache for the current thread. While an instance is alive,
+// FilePath queries which stat the filesystem (exists, isDirectory, size,
+// lastWriteTime) memoize their results, so a handler which interrogates
+// the same path several times (exists -> isDirectory -> lastWriteTime)
+// performs a single stat -- a meaningful savings on network filesystems.
+// Mutating operations invalidate the cache; scopes may nest (the cache
+// is discarded when the outermost scope exits). Intended to be created
+// at the top of an RPC or event handler rather than held long-term,
+// since changes made by other processes aren't observed while active.
+class ScopedStatCache : boost::noncopyable
+{
+public:
+   ScopedStatCache();
+   virtual ~ScopedStatCache();
+};
+
 class RestoreCurrentPathScope : boost::noncopyable
 {
 public:
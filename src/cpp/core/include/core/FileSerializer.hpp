@@ -16,6 +16,8 @@
 #ifndef CORE_FILE_SERIALIZER_HPP
 #define CORE_FILE_SERIALIZER_HPP
 
+#include <cstring>
+
 #include <string>
 #include <map>
 #include <iterator>
@@ -27,6 +29,8 @@
 #include <boost/iostreams/filtering_stream.hpp>
 
 #include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
 #include <boost/algorithm/string/trim.hpp>
 
 #include <core/Error.hpp>
@@ -36,6 +40,41 @@
 namespace rstudio {
 namespace core {
 
+// maps a file into memory and exposes its contents without copying.
+// the data pointer remains valid for the lifetime of the object (or
+// until close is called). mapping fails for zero-length files and
+// for special files (e.g. fifos or /proc entries, which also stat
+// as zero-length) so callers should fall back to a stream read when
+// open returns an error
+class MemoryMappedFile : boost::noncopyable
+{
+public:
+   MemoryMappedFile();
+   ~MemoryMappedFile();
+
+   Error open(const core::FilePath& filePath);
+   void close();
+
+   bool isOpen() const;
+
+   // NULL for an empty file
+   const char* data() const;
+   std::size_t size() const;
+
+private:
+   struct Impl;
+   boost::shared_ptr<Impl> pImpl_;
+};
+
+// lineEnding is the type of line ending you want the resulting string to have
+Error readStringFromFile(const core::FilePath& filePath,
+                         std::string* pStr,
+                         string_utils::LineEnding lineEnding=string_utils::LineEndingPassthrough,
+                         int startLine = 0,
+                         int endLine = 0,
+                         int startCharacter = 0,
+                         int endCharacter = 0);
+
 template <typename CollectionType>
 Error writeCollectionToFile(
          const core::FilePath& filePath, 
@@ -86,38 +125,36 @@ enum ReadCollectionAction
 };
    
 template <typename CollectionType>
-Error readCollectionFromFile(
-         const core::FilePath& filePath,
+Error readCollectionFromMemory(
+         const char* pBegin,
+         const char* pEnd,
          CollectionType* pCollection,
-         boost::function<ReadCollectionAction(const std::string& line, 
+         boost::function<ReadCollectionAction(const std::string& line,
                                  typename CollectionType::value_type* pValue)>
                          parseFunction,
                          bool trimAndIgnoreBlankLines=true)
 {
-   using namespace boost::system::errc ;
-   
-   // open the file stream
-   boost::shared_ptr<std::istream> pIfs;
-   Error error = filePath.open_r(&pIfs);
-   if (error)
-      return error;
-   
    // create insert iterator
-   std::insert_iterator<CollectionType> insertIterator(*pCollection, 
+   std::insert_iterator<CollectionType> insertIterator(*pCollection,
                                                        pCollection->begin());
 
    try
    {
-      // read each line
+      // single pass over the buffer. NOTE: only newline-terminated
+      // lines are processed (the previous getline-based reader
+      // stopped at eof before processing a final unterminated line,
+      // and writeCollectionToFile always terminates the final line)
       std::string nextLine ;
-      while (true)
+      while (pBegin < pEnd)
       {
-         // read the next line
-         std::getline(*pIfs, nextLine) ;
-         if (pIfs->eof())
+         // locate the end of the next line
+         const char* pNewline = static_cast<const char*>(
+                              ::memchr(pBegin, '\n', pEnd - pBegin));
+         if (pNewline == NULL)
             break;
-         else if (pIfs->fail())
-            return systemError(io_error, ERROR_LOCATION);
+
+         nextLine.assign(pBegin, pNewline);
+         pBegin = pNewline + 1;
 
          // trim whitespace then ignore it if it is a blank line
          if (trimAndIgnoreBlankLines)
@@ -149,13 +186,54 @@ Error readCollectionFromFile(
       Error error = systemError(boost::system::errc::io_error,
                                 ERROR_LOCATION);
       error.addProperty("what", e.what());
-      error.addProperty("path", filePath.absolutePath());
       return error;
    }
-   
+
    return Success() ;
 }
 
+template <typename CollectionType>
+Error readCollectionFromFile(
+         const core::FilePath& filePath,
+         CollectionType* pCollection,
+         boost::function<ReadCollectionAction(const std::string& line,
+                                 typename CollectionType::value_type* pValue)>
+                         parseFunction,
+                         bool trimAndIgnoreBlankLines=true)
+{
+   // map the file and parse it in a single pass over the mapping
+   MemoryMappedFile mappedFile;
+   Error error = mappedFile.open(filePath);
+   if (!error)
+   {
+      error = readCollectionFromMemory<CollectionType>(
+                                 mappedFile.data(),
+                                 mappedFile.data() + mappedFile.size(),
+                                 pCollection,
+                                 parseFunction,
+                                 trimAndIgnoreBlankLines);
+      if (error)
+         error.addProperty("path", filePath.absolutePath());
+      return error;
+   }
+
+   // fall back to a stream read for files which can't be mapped
+   std::string contents;
+   error = readStringFromFile(filePath, &contents);
+   if (error)
+      return error;
+
+   error = readCollectionFromMemory<CollectionType>(
+                              contents.data(),
+                              contents.data() + contents.size(),
+                              pCollection,
+                              parseFunction,
+                              trimAndIgnoreBlankLines);
+   if (error)
+      error.addProperty("path", filePath.absolutePath());
+   return error;
+}
+
 template <typename ContentType>
 Error appendToFile(const core::FilePath& filePath,
                        const ContentType& content)
@@ -266,6 +344,13 @@ Error readStructVectorFromFile(const core::FilePath& filePath,
 ReadCollectionAction parseString(const std::string& line, std::string* pStr);
 std::string stringifyString(const std::string& str);
 
+// convenince methods for name="value" pairs (the format used by
+// writeStringMapToFile / readStringMapFromFile)
+std::string stringifyStringPair(const std::pair<std::string,std::string>& pair);
+ReadCollectionAction parseStringPair(
+                     const std::string& line,
+                     std::pair<const std::string,std::string>* pPair);
+
       
 Error writeStringMapToFile(const core::FilePath& filePath,
                            const std::map<std::string,std::string>& map) ;
@@ -286,15 +371,6 @@ Error writeStringToFile(const core::FilePath& filePath,
                         string_utils::LineEnding lineEnding=string_utils::LineEndingPassthrough,
                         bool truncate = true);
 
-// lineEnding is the type of line ending you want the resulting string to have
-Error readStringFromFile(const core::FilePath& filePath,
-                         std::string* pStr,
-                         string_utils::LineEnding lineEnding=string_utils::LineEndingPassthrough,
-                         int startLine = 0,
-                         int endLine = 0,
-                         int startCharacter = 0,
-                         int endCharacter = 0);
-
 // read a string from a file with a filter
 template <typename Filter>
 Error readStringFromFile(
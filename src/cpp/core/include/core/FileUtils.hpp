@@ -16,6 +16,8 @@
 #ifndef CORE_FILEUTILS_HPP
 #define CORE_FILEUTILS_HPP
 
+#include <stdint.h>
+
 #include <string>
 
 
@@ -40,6 +42,13 @@ bool isWindowsReservedName(const std::string& name);
 Error copyDirectory(const FilePath& sourceDirectory,
                     const FilePath& targetDirectory);
 
+// remove the least-recently-written files from a cache directory until
+// its contents fit within maxSizeBytes. intended for bounding cache
+// directories which otherwise grow without limit (the contents must be
+// regenerable or individually expendable)
+Error trimCacheDirectory(const FilePath& cacheDirectory,
+                         uintmax_t maxSizeBytes);
+
 } // namespace file_utils
 } // namespace core
 } // namespace rstudio
@@ -17,6 +17,7 @@
 #define CORE_PERFORMANCE_TIMER_HPP
 
 #include <iosfwd>
+#include <map>
 #include <vector>
 #include <string>
 
@@ -57,10 +58,60 @@ private:
 
 std::ostream& operator << (std::ostream& os, const PerformanceTimer& t) ;
 
-} // namespace core 
+
+// accumulating profiler built on the same clock. a ScopedPerformanceTimer
+// adds the elapsed time of its enclosing scope to a process-wide
+// accumulator keyed by section name (call count, total and max duration),
+// cheap enough to leave compiled into production builds. use the
+// TIME_SCOPE macro at the top of a function or block and retrieve the
+// aggregate table with performanceStatistics()
+class ScopedPerformanceTimer : boost::noncopyable
+{
+public:
+   explicit ScopedPerformanceTimer(const char* section);
+   ~ScopedPerformanceTimer();
+   // COPYING: boost::noncopyable
+
+private:
+   const char* section_;
+   boost::posix_time::ptime startTime_;
+   bool tracked_;
+};
+
+struct PerformanceStats
+{
+   PerformanceStats() : count(0), totalMicroseconds(0), maxMicroseconds(0) {}
+   double count;
+   double totalMicroseconds;
+   double maxMicroseconds;
+};
+
+// snapshot of all accumulated sections (section name -> stats)
+void performanceStatistics(std::map<std::string,PerformanceStats>* pStats);
+
+// write the accumulated sections to a stream as one line per section
+void writePerformanceStatistics(std::ostream& os);
+
+// stall attribution: after this is called (once, from the thread to be
+// observed -- e.g. the session main thread) ScopedPerformanceTimer
+// instances on that thread also maintain a stack of currently active
+// sections, which other threads can sample with currentActivity
+void trackActivityOnCurrentThread();
+
+// innermost section currently active on the tracked thread, along with
+// when it was entered (returns false if no section is active or no
+// thread is being tracked)
+bool currentActivity(std::string* pSection,
+                     boost::posix_time::ptime* pStartTime);
+
+} // namespace core
 } // namespace rstudio
 
 #define TIME_FUNCTION core::PerformanceTimer t(BOOST_CURRENT_FUNCTION);
 
+#define TIME_SCOPE(section) \
+      rstudio::core::ScopedPerformanceTimer \
+                        rstudio_core_scoped_perf_timer_(section);
+
 #endif // CORE_PERFORMANCE_TIMER_HPP
 
@@ -58,6 +58,16 @@ public:
       }
    }
 
+   virtual bool due(const boost::posix_time::ptime& now) const
+   {
+      return !finished_ && (now > nextExecutionTime_);
+   }
+
+   virtual boost::posix_time::ptime nextExecutionTime() const
+   {
+      return nextExecutionTime_;
+   }
+
    virtual boost::posix_time::time_duration period()
    {
       return period_;
@@ -39,6 +39,13 @@ boost::regex wildcardPatternToRegex(const std::string& pattern);
 // returns an empty regex)
 boost::regex regexIfWildcardPattern(const std::string& term);
 
+// returns a reference to a lazily compiled, process-lifetime cached regex
+// for the given pattern. intended for the fixed set of literal patterns
+// used on request hot paths (compiling boost::regex costs milliseconds);
+// don't use it for patterns derived from user input, which would grow the
+// cache without bound
+const boost::regex& cached(const std::string& pattern);
+
 bool textMatches(const std::string& text,
                  const boost::regex& regex,
                  bool prefixOnly,
@@ -43,6 +43,25 @@ public:
 public:
    virtual void execute() = 0;
 
+   // whether a call to execute would actually perform work at the
+   // specified time (e.g. a periodic command is not due until its
+   // period elapses). allows schedulers to skip idle commands without
+   // executing them -- the time is passed in so one clock read can
+   // service an entire scheduling pass
+   virtual bool due(const boost::posix_time::ptime& now) const
+   {
+      return !finished_;
+   }
+
+   // the next time at which the command will become due, or
+   // not_a_date_time for commands which perform work on every pass
+   // (e.g. incremental commands). allows schedulers to skip scanning
+   // their command lists entirely until something is due
+   virtual boost::posix_time::ptime nextExecutionTime() const
+   {
+      return boost::posix_time::ptime(boost::posix_time::not_a_date_time);
+   }
+
    bool finished() const { return finished_; }
 
 protected:
@@ -18,6 +18,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 
 #include <boost/utility.hpp>
 #include <boost/function.hpp>
@@ -59,12 +60,17 @@ public:
 
 private:
    void writeSettings() ;
+   void journalValue(const std::string& name);
+   Error replayJournal();
 
 private:
    FilePath settingsFile_ ;
+   FilePath journalFile_ ;
    std::map<std::string, std::string> settingsMap_ ;
    bool updatePending_ ;
    bool isDirty_;
+   int journalEntries_;
+   std::vector<std::string> pendingWrites_;
 };
 
 }
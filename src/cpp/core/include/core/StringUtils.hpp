@@ -73,6 +73,11 @@ bool subsequenceIndices(std::string const& sequence,
 
 std::string getExtension(std::string const& str);
 
+// true if the string contains only 7-bit (ASCII) characters -- such
+// strings are identical in every ASCII-compatible encoding, so encoding
+// conversions can pass them through untouched
+bool isAsciiString(const std::string& str);
+
 std::string utf8ToSystem(const std::string& str,
                          bool escapeInvalidChars=false);
 std::string systemToUtf8(const std::string& str);
@@ -216,7 +221,11 @@ inline bool stringNotEmpty(const std::string& str)
    return !str.empty();
 }
 
-void trimLeadingLines(int maxLines, std::string* pLines);
+// trim all but the last maxLines lines from pLines (optionally capturing
+// the trimmed prefix in pTrimmed)
+void trimLeadingLines(int maxLines,
+                      std::string* pLines,
+                      std::string* pTrimmed = NULL);
 
 void stripQuotes(std::string* pStr);
 std::string strippedOfQuotes(const std::string& str);
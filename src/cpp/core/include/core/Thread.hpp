@@ -17,9 +17,11 @@
 #define CORE_THREAD_HPP
 
 #include <queue>
+#include <vector>
 
 #include <boost/utility.hpp>
 #include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <core/BoostErrors.hpp>
 #include <core/BoostThread.hpp>
@@ -150,6 +152,15 @@ public:
       END_LOCK_MUTEX
    }
 
+   void clear()
+   {
+      LOCK_MUTEX(mutex_)
+      {
+         map_.clear();
+      }
+      END_LOCK_MUTEX
+   }
+
 private:
    boost::mutex mutex_;
    std::map<K,V> map_;
@@ -287,6 +298,43 @@ private:
    std::queue<T> queue_;
 };
 
+// fixed-size pool of background worker threads servicing a shared fifo
+// task queue. prefer scheduling short-lived background work here over
+// launching a dedicated thread per task (thread creation isn't free and
+// one-off threads accumulate quickly under load). note that tasks which
+// block indefinitely don't belong in a pool -- they would tie up a
+// worker permanently and should keep their own dedicated thread
+class ThreadPool : boost::noncopyable
+{
+public:
+   explicit ThreadPool(std::size_t numThreads);
+   virtual ~ThreadPool();
+
+   // COPYING: boost::noncopyable
+
+   // launch the worker threads (tasks scheduled before start simply
+   // remain queued until it is called)
+   void start();
+
+   // schedule a task for execution on one of the workers (tasks are
+   // dequeued in fifo order). no-op after stop
+   void schedule(const boost::function<void()>& task);
+
+   // stop accepting new work, drain tasks already queued, then join
+   // the workers. called automatically at destruction
+   void stop();
+
+private:
+   void workerMain();
+
+private:
+   std::size_t numThreads_;
+   std::vector<boost::shared_ptr<boost::thread> > threads_;
+   ThreadsafeQueue<boost::function<void()> > queue_;
+   boost::mutex stateMutex_;
+   bool stopped_;
+};
+
 void safeLaunchThread(boost::function<void()> threadMain,
                       boost::thread* pThread = NULL);
       
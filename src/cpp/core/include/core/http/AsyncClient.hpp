@@ -16,6 +16,8 @@
 #ifndef CORE_HTTP_ASYNC_CLIENT_HPP
 #define CORE_HTTP_ASYNC_CLIENT_HPP
 
+#include <cstdlib>
+
 #include <boost/shared_ptr.hpp>
 #include <boost/function.hpp>
 #include <boost/enable_shared_from_this.hpp>
@@ -169,12 +171,16 @@ protected:
    void writeRequest()
    {
       // specify closing of the connection after the request unless this is
-      // an attempt to upgrade to websockets
+      // an attempt to upgrade to websockets or the subclass pools
+      // connections (in which case ask the server to keep the socket open)
       Header overrideHeader;
       if (!boost::algorithm::iequals(request_.headerValue("Connection"),
                                      "Upgrade"))
       {
-         overrideHeader = Header::connectionClose();
+         if (connectionReusable())
+            overrideHeader = Header::connectionKeepAlive();
+         else
+            overrideHeader = Header::connectionClose();
       }
 
       // write
@@ -233,6 +239,10 @@ private:
                   boost::posix_time::microsec_clock::universal_time() +
                   connectionRetryContext_.profile.maxWait;
 
+            // the profile's retryInterval seeds the backoff sequence
+            connectionRetryContext_.nextRetryInterval =
+                  connectionRetryContext_.profile.retryInterval;
+
             firstAttempt = true;
          }
 
@@ -270,11 +280,31 @@ private:
 
    bool scheduleRetry()
    {
+      // compute the wait for this attempt: exponential backoff with
+      // jitter. fixed-interval retries from many clients stay
+      // synchronized and hammer a server exactly when it is least able
+      // to respond (e.g. a session stalled in gc); doubling the
+      // interval and randomizing each wait (50%-150%) spreads the
+      // retries out while still probing quickly at first
+      boost::posix_time::time_duration interval =
+                                 connectionRetryContext_.nextRetryInterval;
+      if (interval.is_not_a_date_time())
+         interval = connectionRetryContext_.profile.retryInterval;
+      boost::posix_time::time_duration wait =
+            boost::posix_time::milliseconds(
+               interval.total_milliseconds() * (50 + ::rand() % 100) / 100);
+
+      // double the interval for the next attempt (bounded so a long
+      // maxWait still yields several attempts near the end of the
+      // retry window)
+      boost::posix_time::time_duration maxInterval =
+                              connectionRetryContext_.profile.maxWait / 4;
+      connectionRetryContext_.nextRetryInterval =
+            (interval * 2 < maxInterval) ? interval * 2 : maxInterval;
+
       // set expiration
       boost::system::error_code ec;
-      connectionRetryContext_.retryTimer.expires_from_now(
-                  connectionRetryContext_.profile.retryInterval,
-                  ec);
+      connectionRetryContext_.retryTimer.expires_from_now(wait, ec);
 
       // attempt to schedule retry timer (should always succeed but
       // include error check to be paranoid/robust)
@@ -327,7 +357,8 @@ private:
          }
          else
          {
-            handleErrorCode(ec, ERROR_LOCATION);
+            if (!retryStaleConnection(ec))
+               handleErrorCode(ec, ERROR_LOCATION);
          }
       }
       CATCH_UNEXPECTED_ASYNC_CLIENT_EXCEPTION
@@ -360,7 +391,8 @@ private:
          }
          else
          {
-            handleErrorCode(ec, ERROR_LOCATION);
+            if (!retryStaleConnection(ec))
+               handleErrorCode(ec, ERROR_LOCATION);
          }
       }
       CATCH_UNEXPECTED_ASYNC_CLIENT_EXCEPTION
@@ -400,6 +432,29 @@ private:
       return false;
    }
 
+   // hooks for subclasses which pool connections: when connectionReusable
+   // returns true the request is written with Connection: keep-alive and
+   // a completed response hands the still-open socket to recycleConnection
+   // rather than closing it
+   virtual bool connectionReusable()
+   {
+      return false;
+   }
+
+   virtual void recycleConnection()
+   {
+   }
+
+   // hook for subclasses which pool connections: a pooled socket can go
+   // stale while parked (the server closed it) in which case the failure
+   // surfaces when writing the request or reading the status line. return
+   // true to indicate a fresh connection attempt has been initiated and
+   // normal error handling should be suppressed
+   virtual bool retryStaleConnection(const boost::system::error_code& ec)
+   {
+      return false;
+   }
+
    void handleReadHeaders(const boost::system::error_code& ec)
    {
       try
@@ -456,8 +511,16 @@ private:
 
    void closeAndRespond()
    {
-      if (!keepConnectionAlive())
+      if (connectionReusable() &&
+          !boost::algorithm::iequals(response_.headerValue("Connection"),
+                                     "close"))
+      {
+         recycleConnection();
+      }
+      else if (!keepConnectionAlive())
+      {
          close();
+      }
 
       if (responseHandler_)
          responseHandler_(response_);
@@ -481,12 +544,14 @@ private:
    {
       ConnectionRetryContext(boost::asio::io_service& ioService)
          : stopTryingTime(boost::posix_time::not_a_date_time),
+           nextRetryInterval(boost::posix_time::not_a_date_time),
            retryTimer(ioService)
       {
       }
 
       http::ConnectionRetryProfile profile;
       boost::posix_time::ptime stopTryingTime;
+      boost::posix_time::time_duration nextRetryInterval;
       boost::asio::deadline_timer retryTimer;
    };
 
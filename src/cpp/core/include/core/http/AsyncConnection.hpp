@@ -42,6 +42,45 @@ typedef boost::function<void(boost::asio::io_service&,
 
 typedef boost::function<void(const std::string&,Response*)> ResponseFilter;
 
+// policy governing automatic response compression (configured on the
+// server via AsyncServerImpl::setResponseCompression and applied by the
+// connection just before the response is written)
+struct ResponseCompressionPolicy
+{
+   ResponseCompressionPolicy()
+      : enabled(false), minimumSize(1024)
+   {
+      // compressible content types (prefix match)
+      contentTypePrefixes.push_back("text/");
+      contentTypePrefixes.push_back("application/json");
+      contentTypePrefixes.push_back("application/javascript");
+      contentTypePrefixes.push_back("application/x-javascript");
+      contentTypePrefixes.push_back("image/svg+xml");
+   }
+
+   bool enabled;
+   std::size_t minimumSize;
+   std::vector<std::string> contentTypePrefixes;
+};
+
+// pull-based source of response body data. the connection reads and
+// writes one block at a time (pulling the next block only after the
+// previous one has been written to the socket) so arbitrarily large
+// bodies can be streamed with bounded memory. read is always invoked
+// from the connection's io_service thread.
+class ResponseBodySource
+{
+public:
+   virtual ~ResponseBodySource() {}
+
+   // fill the caller's buffer with the next block of body data and set
+   // *pBytesRead to the number of bytes provided (0 indicates the end
+   // of the body)
+   virtual Error read(char* pBuffer,
+                      std::size_t bufferSize,
+                      std::size_t* pBytesRead) = 0;
+};
+
 // abstract base (insulate clients from knowledge of protocol-specifics)
 class AsyncConnection : public Socket
 {
@@ -54,6 +93,11 @@ public:
    // request
    virtual const http::Request& request() const = 0;
 
+   // mutable access to the request -- for handlers (e.g. proxies) which
+   // relay the request elsewhere and want to take ownership of its body
+   // rather than copying it
+   virtual http::Request& mutableRequest() = 0;
+
    // populate or set response then call writeResponse when done
    virtual http::Response& response() = 0;
    virtual void writeResponse(bool close = true) = 0;
@@ -62,6 +106,13 @@ public:
    virtual void writeResponse(const http::Response& response,
                               bool close = true) = 0;
    virtual void writeError(const Error& error) = 0;
+
+   // write the response headers then stream the body from the source
+   // using chunked transfer-encoding (headers/status should be set on
+   // response() prior to calling; any buffered body is ignored)
+   virtual void writeStreamedResponse(
+                     boost::shared_ptr<ResponseBodySource> bodySource,
+                     bool close = true) = 0;
 };
 
 } // namespace http
@@ -16,8 +16,20 @@
 #ifndef CORE_HTTP_ASYNC_CONNECTION_IMPL_HPP
 #define CORE_HTTP_ASYNC_CONNECTION_IMPL_HPP
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
 #include <boost/array.hpp>
+#include <boost/cstdint.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/function.hpp>
 #include <boost/enable_shared_from_this.hpp>
 
@@ -58,9 +70,18 @@ public:
         socket_(ioService),
         handler_(handler),
         requestFilter_(requestFilter),
-        responseFilter_(responseFilter)
-        
+        responseFilter_(responseFilter),
+        chunkTrailer_("\r\n")
+
    {
+#ifndef _WIN32
+      fileFd_ = -1;
+      fileOffset_ = 0;
+      pFileMap_ = NULL;
+      fileMapSize_ = 0;
+#endif
+      fileBytesRemaining_ = 0;
+      keepAliveEnabled_ = false;
    }
    
    typename ProtocolType::socket& socket() 
@@ -73,6 +94,20 @@ public:
       readSome();
    }
 
+   // allow the connection to be re-used for subsequent requests after a
+   // response is written (negotiated per-request -- http/1.0 clients and
+   // requests bearing Connection: close still get a dedicated connection)
+   void setKeepAliveEnabled(bool enabled)
+   {
+      keepAliveEnabled_ = enabled;
+   }
+
+   // automatic response compression policy (see AsyncServerImpl)
+   void setResponseCompressionPolicy(const ResponseCompressionPolicy& policy)
+   {
+      compressionPolicy_ = policy;
+   }
+
    virtual boost::asio::io_service& ioService()
    {
       return ioService_;
@@ -83,6 +118,11 @@ public:
       return request_;
    }
 
+   virtual http::Request& mutableRequest()
+   {
+      return request_;
+   }
+
    virtual http::Response& response()
    {
       return response_;
@@ -90,15 +130,41 @@ public:
 
    virtual void writeResponse(bool close = true)
    {
+      // keep the connection open for the next request when keep-alive
+      // is enabled and the client supports it
+      if (close && keepAliveEnabled_ && requestSupportsKeepAlive())
+         close = false;
+
       // add extra response headers
       response_.setHeader("Date", util::httpDate());
       if (close)
          response_.setHeader("Connection", "close");
+      else
+         response_.setHeader("Connection", "keep-alive");
 
       // call the response filter if we have one
       if (responseFilter_)
          responseFilter_(originalUri_, &response_);
 
+      // compress the body if the policy and the client allow it
+      applyCompressionPolicy();
+
+      // zero-copy file transmission (see Response::setStreamFile) --
+      // write the headers then send the file's bytes directly
+      if (!response_.streamFilePath().empty())
+      {
+         boost::asio::async_write(
+             socket_,
+             response_.toBuffers(),
+             boost::bind(
+                  &AsyncConnectionImpl<ProtocolType>::handleFileHeadersWritten,
+                  AsyncConnectionImpl<ProtocolType>::shared_from_this(),
+                  boost::asio::placeholders::error,
+                  close)
+         );
+         return;
+      }
+
       // write
       boost::asio::async_write(
           socket_,
@@ -123,6 +189,40 @@ public:
       writeResponse();
    }
 
+   virtual void writeStreamedResponse(
+                     boost::shared_ptr<ResponseBodySource> bodySource,
+                     bool close = true)
+   {
+      // note the body source (pulled from as each block completes)
+      bodySource_ = bodySource;
+
+      // add extra response headers
+      response_.setHeader("Date", util::httpDate());
+      if (close)
+         response_.setHeader("Connection", "close");
+
+      // chunked transfer-encoding (the length of the body isn't known
+      // up front). note chunked requires http/1.1 -- callers serving
+      // http/1.0 clients should fall back to a buffered writeResponse
+      response_.setChunkedTransferEncoding();
+
+      // call the response filter if we have one
+      if (responseFilter_)
+         responseFilter_(originalUri_, &response_);
+
+      // write the headers (the response body is empty so toBuffers
+      // yields only the status line and headers), then stream chunks
+      boost::asio::async_write(
+          socket_,
+          response_.toBuffers(),
+          boost::bind(
+               &AsyncConnectionImpl<ProtocolType>::handleStreamWrite,
+               AsyncConnectionImpl<ProtocolType>::shared_from_this(),
+               boost::asio::placeholders::error,
+               close)
+      );
+   }
+
    // satisfy lower-level http::Socket interface (used when the connection
    // is upgraded to a websocket connection and no longer conforms to the
    // request/response protocol used by the class in the ordinary course
@@ -254,23 +354,370 @@ private:
             if (!http::isConnectionTerminatedError(error))
                LOG_ERROR(error);
          }
-         
+
          // close the socket
-         if (close)
+         if (close || e)
          {
             Error error = closeSocket(socket_);
             if (error)
                LOG_ERROR(error);
-         }
 
-         //
-         // no more async operations are initiated here so the shared_ptr to 
-         // this connection no more references and is automatically destroyed
-         //
+            //
+            // no more async operations are initiated here so the shared_ptr
+            // to this connection no more references and is automatically
+            // destroyed
+            //
+         }
+         else
+         {
+            // keep-alive -- reset state and wait for the next request on
+            // this connection (the pending read keeps the object alive)
+            startNextRequest();
+         }
       }
       CATCH_UNEXPECTED_EXCEPTION
    }
+
+   void applyCompressionPolicy()
+   {
+      if (!compressionPolicy_.enabled)
+         return;
+
+      // client must accept gzip; skip responses which are already
+      // encoded, zero-copy file responses, and bodies below the
+      // minimum worthwhile size
+      if (!request_.acceptsEncoding(kGzipEncoding))
+         return;
+      if (!response_.contentEncoding().empty())
+         return;
+      if (!response_.streamFilePath().empty())
+         return;
+      if (response_.contentLength() < compressionPolicy_.minimumSize)
+         return;
+
+      // content type must be in the compressible set
+      std::string contentType = response_.contentType();
+      bool compressible = false;
+      for (std::size_t i = 0;
+           i < compressionPolicy_.contentTypePrefixes.size();
+           i++)
+      {
+         if (boost::algorithm::istarts_with(
+                  contentType,
+                  compressionPolicy_.contentTypePrefixes[i]))
+         {
+            compressible = true;
+            break;
+         }
+      }
+      if (!compressible)
+         return;
+
+      Error error = response_.gzipCompressBody();
+      if (error)
+         LOG_ERROR(error);
+   }
+
+   bool requestSupportsKeepAlive() const
+   {
+      // streamed file responses manage their own write sequence but end
+      // in handleWrite as well, so the same negotiation applies. http/1.0
+      // clients must opt in; http/1.1 clients must opt out
+      std::string connection = request_.headerValue("Connection");
+      if (request_.isHttp10())
+         return boost::algorithm::iequals(connection, "keep-alive");
+      else
+         return !boost::algorithm::iequals(connection, "close");
+   }
+
+   void startNextRequest()
+   {
+      // NOTE: any bytes the client pipelined after the previous request
+      // are discarded (browsers don't pipeline; they multiplex over a
+      // small set of serially re-used connections)
+      originalUri_.clear();
+      requestParser_.reset();
+      request_.reset();
+      response_.reset();
+      readSome();
+   }
    
+   // zero-copy file transmission (see Response::setStreamFile)
+
+   void handleFileHeadersWritten(const boost::system::error_code& e,
+                                 bool close)
+   {
+      try
+      {
+         if (e)
+         {
+            handleStreamError(Error(e, ERROR_LOCATION));
+            return;
+         }
+
+#ifndef _WIN32
+         // open the file
+         fileFd_ = ::open(response_.streamFilePath().c_str(), O_RDONLY);
+         if (fileFd_ == -1)
+         {
+            handleStreamError(systemError(errno, ERROR_LOCATION));
+            return;
+         }
+
+         struct stat st;
+         if (::fstat(fileFd_, &st) == -1)
+         {
+            handleStreamError(systemError(errno, ERROR_LOCATION));
+            return;
+         }
+         fileBytesRemaining_ = st.st_size;
+         fileOffset_ = 0;
+
+         if (fileBytesRemaining_ == 0)
+         {
+            finishFileStream(close);
+            return;
+         }
+
+#ifdef __linux__
+         // transmit directly from the page cache to the socket
+         sendFileBlock(close);
+#else
+         // no sendfile -- map the file and write the mapped region
+         // (zero-copy into user space; the kernel reads pages on demand)
+         fileMapSize_ = fileBytesRemaining_;
+         pFileMap_ = ::mmap(NULL, fileMapSize_, PROT_READ, MAP_PRIVATE,
+                            fileFd_, 0);
+         if (pFileMap_ == MAP_FAILED)
+         {
+            pFileMap_ = NULL;
+            handleStreamError(systemError(errno, ERROR_LOCATION));
+            return;
+         }
+
+         boost::asio::async_write(
+             socket_,
+             boost::asio::buffer(pFileMap_, fileMapSize_),
+             boost::bind(
+                  &AsyncConnectionImpl<ProtocolType>::handleFileMapWritten,
+                  AsyncConnectionImpl<ProtocolType>::shared_from_this(),
+                  boost::asio::placeholders::error,
+                  close)
+         );
+#endif
+#else
+         // buffered fallback on win32
+         Error error = FilePath(response_.streamFilePath()).open_r(
+                                                            &fileStream_);
+         if (error)
+         {
+            handleStreamError(error);
+            return;
+         }
+         writeFileBlockBuffered(close);
+#endif
+      }
+      CATCH_UNEXPECTED_EXCEPTION
+   }
+
+#ifdef __linux__
+   void sendFileBlock(bool close)
+   {
+      while (fileBytesRemaining_ > 0)
+      {
+         std::size_t maxBytes = static_cast<std::size_t>(
+            std::min<boost::uint64_t>(fileBytesRemaining_, 1024 * 1024));
+         ssize_t sent = ::sendfile(socket_.native_handle(),
+                                   fileFd_,
+                                   &fileOffset_,
+                                   maxBytes);
+         if (sent > 0)
+         {
+            fileBytesRemaining_ -= sent;
+         }
+         else if (sent == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+         {
+            // socket buffer full -- wait for writability then resume
+            socket_.async_write_some(
+               boost::asio::null_buffers(),
+               boost::bind(
+                    &AsyncConnectionImpl<ProtocolType>::handleFileWritable,
+                    AsyncConnectionImpl<ProtocolType>::shared_from_this(),
+                    boost::asio::placeholders::error,
+                    close));
+            return;
+         }
+         else
+         {
+            handleStreamError(systemError(errno, ERROR_LOCATION));
+            return;
+         }
+      }
+      finishFileStream(close);
+   }
+
+   void handleFileWritable(const boost::system::error_code& e, bool close)
+   {
+      try
+      {
+         if (e)
+            handleStreamError(Error(e, ERROR_LOCATION));
+         else
+            sendFileBlock(close);
+      }
+      CATCH_UNEXPECTED_EXCEPTION
+   }
+#elif !defined(_WIN32)
+   void handleFileMapWritten(const boost::system::error_code& e, bool close)
+   {
+      try
+      {
+         if (e)
+            handleStreamError(Error(e, ERROR_LOCATION));
+         else
+            finishFileStream(close);
+      }
+      CATCH_UNEXPECTED_EXCEPTION
+   }
+#else
+   void writeFileBlockBuffered(bool close)
+   {
+      fileStream_->read(streamBuffer_.data(), streamBuffer_.size());
+      std::streamsize bytesRead = fileStream_->gcount();
+      if (bytesRead <= 0)
+      {
+         finishFileStream(close);
+         return;
+      }
+
+      boost::asio::async_write(
+          socket_,
+          boost::asio::buffer(streamBuffer_.data(),
+                              static_cast<std::size_t>(bytesRead)),
+          boost::bind(
+               &AsyncConnectionImpl<ProtocolType>::handleFileBlockWritten,
+               AsyncConnectionImpl<ProtocolType>::shared_from_this(),
+               boost::asio::placeholders::error,
+               close)
+      );
+   }
+
+   void handleFileBlockWritten(const boost::system::error_code& e, bool close)
+   {
+      try
+      {
+         if (e)
+            handleStreamError(Error(e, ERROR_LOCATION));
+         else
+            writeFileBlockBuffered(close);
+      }
+      CATCH_UNEXPECTED_EXCEPTION
+   }
+#endif
+
+   void finishFileStream(bool close)
+   {
+      cleanupFileStream();
+      handleWrite(boost::system::error_code(), close);
+   }
+
+   void cleanupFileStream()
+   {
+#ifndef _WIN32
+      if (pFileMap_ != NULL)
+      {
+         ::munmap(pFileMap_, fileMapSize_);
+         pFileMap_ = NULL;
+      }
+      if (fileFd_ != -1)
+      {
+         ::close(fileFd_);
+         fileFd_ = -1;
+      }
+#else
+      fileStream_.reset();
+#endif
+   }
+
+   // shared error path for streamed (chunked and file) responses -- an
+   // error response can't be sent mid-stream so log and drop the
+   // connection
+   void handleStreamError(const Error& error)
+   {
+      if (!http::isConnectionTerminatedError(error))
+         LOG_ERROR(error);
+      cleanupFileStream();
+      bodySource_.reset();
+      Error closeError = closeSocket(socket_);
+      if (closeError)
+         LOG_ERROR(closeError);
+   }
+
+   void handleStreamWrite(const boost::system::error_code& e, bool close)
+   {
+      try
+      {
+         if (e)
+         {
+            handleStreamError(Error(e, ERROR_LOCATION));
+            return;
+         }
+
+         // stream complete -- finish up as handleWrite would
+         if (!bodySource_)
+         {
+            handleWrite(e, close);
+            return;
+         }
+
+         writeNextChunk(close);
+      }
+      CATCH_UNEXPECTED_EXCEPTION
+   }
+
+   void writeNextChunk(bool close)
+   {
+      // pull the next block from the source
+      std::size_t bytesRead = 0;
+      Error error = bodySource_->read(streamBuffer_.data(),
+                                      streamBuffer_.size(),
+                                      &bytesRead);
+      if (error)
+      {
+         // mid-stream failure -- the client sees a truncated chunked body
+         handleStreamError(error);
+         return;
+      }
+
+      // format the chunk (size line in hex, data, trailing crlf); a
+      // zero-length read is the end of the body, which in chunked
+      // encoding is the terminating 0-length chunk
+      std::vector<boost::asio::const_buffer> buffers;
+      std::ostringstream sizeStream;
+      sizeStream << std::hex << bytesRead << "\r\n";
+      chunkHeader_ = sizeStream.str();
+      buffers.push_back(boost::asio::buffer(chunkHeader_));
+      if (bytesRead > 0)
+         buffers.push_back(boost::asio::buffer(streamBuffer_.data(),
+                                               bytesRead));
+      buffers.push_back(boost::asio::buffer(chunkTrailer_));
+
+      // after the terminating chunk release the source so the write
+      // completion handler knows the stream is done
+      if (bytesRead == 0)
+         bodySource_.reset();
+
+      boost::asio::async_write(
+          socket_,
+          buffers,
+          boost::bind(
+               &AsyncConnectionImpl<ProtocolType>::handleStreamWrite,
+               AsyncConnectionImpl<ProtocolType>::shared_from_this(),
+               boost::asio::placeholders::error,
+               close)
+      );
+   }
+
    void readSome()
    {
       socket_.async_read_some(
@@ -294,6 +741,27 @@ private:
    std::string originalUri_;
    http::Request request_;
    http::Response response_;
+   bool keepAliveEnabled_;
+   ResponseCompressionPolicy compressionPolicy_;
+
+   // chunked streaming state (see writeStreamedResponse). the chunk
+   // header/trailer members provide stable storage for the duration of
+   // each async_write
+   boost::shared_ptr<ResponseBodySource> bodySource_;
+   boost::array<char, 65536> streamBuffer_ ;
+   std::string chunkHeader_;
+   std::string chunkTrailer_;
+
+   // zero-copy file transmission state (see handleFileHeadersWritten)
+   boost::uint64_t fileBytesRemaining_;
+#ifndef _WIN32
+   int fileFd_;
+   off_t fileOffset_;
+   void* pFileMap_;
+   std::size_t fileMapSize_;
+#else
+   boost::shared_ptr<std::istream> fileStream_;
+#endif
 };
    
 
@@ -62,6 +62,7 @@ public:
         acceptorService_(),
         scheduledCommandInterval_(boost::posix_time::seconds(3)),
         scheduledCommandTimer_(acceptorService_.ioService()),
+        keepAliveEnabled_(true),
         running_(false)
    {
    }
@@ -135,6 +136,25 @@ public:
       responseFilter_ = responseFilter;
    }
 
+   // automatically gzip response bodies (negotiated via Accept-Encoding)
+   // subject to the policy's minimum-size and content-type filters
+   virtual void setResponseCompression(
+                           const ResponseCompressionPolicy& policy)
+   {
+      BOOST_ASSERT(!running_);
+      compressionPolicy_ = policy;
+   }
+
+   // allow clients to re-use connections across requests (negotiated
+   // per-request with the client -- see AsyncConnectionImpl). on by
+   // default since connection setup (and tls handshake for ssl
+   // deployments) dominates small rpc round-trip time
+   virtual void setKeepAliveEnabled(bool enabled)
+   {
+      BOOST_ASSERT(!running_);
+      keepAliveEnabled_ = enabled;
+   }
+
    virtual Error runSingleThreaded()
    {
 
@@ -257,7 +277,11 @@ private:
          boost::bind(&AsyncServerImpl<ProtocolType>::connectionResponseFilter,
                      this, _1, _2)
       ));
-      
+
+      // apply keep-alive and compression policies
+      ptrNextConnection_->setKeepAliveEnabled(keepAliveEnabled_);
+      ptrNextConnection_->setResponseCompressionPolicy(compressionPolicy_);
+
       // wait for next connection
       acceptorService_.asyncAccept(
          ptrNextConnection_->socket(), 
@@ -498,6 +522,8 @@ private:
    std::vector<boost::shared_ptr<ScheduledCommand> > scheduledCommands_;
    RequestFilter requestFilter_;
    ResponseFilter responseFilter_;
+   bool keepAliveEnabled_;
+   ResponseCompressionPolicy compressionPolicy_;
    bool running_;
 };
 
@@ -30,10 +30,11 @@
 
 #include <core/http/AsyncClient.hpp>
 #include <core/http/LocalStreamSocketUtils.hpp>
+#include <core/http/LocalStreamSocketPool.hpp>
 
 namespace rstudio {
 namespace core {
-namespace http {  
+namespace http {
 
 class LocalStreamAsyncClient
    : public AsyncClient<boost::asio::local::stream_protocol::socket>
@@ -47,23 +48,87 @@ public:
                                                 http::ConnectionRetryProfile())
      : AsyncClient<boost::asio::local::stream_protocol::socket>(ioService,
                                                                 logToStderr),
-       socket_(ioService),
+       ptrSocket_(new boost::asio::local::stream_protocol::socket(ioService)),
        localStreamPath_(localStreamPath),
-       validateUid_(validateUid)
+       validateUid_(validateUid),
+       reuseSocket_(false),
+       usedPooledSocket_(false),
+       retriedStaleConnection_(false)
    {
       setConnectionRetryProfile(retryProfile);
    }
 
+   // share a socket pool with other clients of the same stream. must be
+   // called prior to execute. when reuseSocket is true a successfully
+   // completed connection is parked in the pool for the next request
+   // (callers must ensure the io_service outlives the pool's idle
+   // connections -- one-shot io_services should pass false to
+   // participate only in the shared in-flight limit)
+   void setConnectionPool(boost::shared_ptr<LocalStreamSocketPool> ptrPool,
+                          bool reuseSocket = true)
+   {
+      ptrPool_ = ptrPool;
+      reuseSocket_ = reuseSocket;
+   }
+
 protected:
 
    virtual boost::asio::local::stream_protocol::socket& socket()
    {
-      return socket_;
+      return *ptrSocket_;
    }
 
 private:
 
    virtual void connectAndWriteRequest()
+   {
+      // if we have a pool then acquire an in-flight slot (and possibly
+      // an already-connected socket) before proceeding. note this may
+      // be a retry, in which case we already hold our slot
+      if (ptrPool_ && !ptrSlot_)
+      {
+         // keep the io_service alive while we wait for a slot (a
+         // queued acquire leaves it with no outstanding work, which
+         // would cause a blocking client's run() to return early)
+         ptrWaitingWork_.reset(
+                  new boost::asio::io_service::work(ioService()));
+
+         ptrPool_->acquire(ioService(),
+                           boost::bind(&LocalStreamAsyncClient::onSlotAcquired,
+                                       sharedFromThis(),
+                                       _1,
+                                       _2));
+         return;
+      }
+
+      connectToStream();
+   }
+
+   void onSlotAcquired(
+            boost::shared_ptr<LocalStreamSocketPool::Slot> ptrSlot,
+            boost::shared_ptr<LocalStreamSocketPool::Socket> ptrSocket)
+   {
+      try
+      {
+         ptrSlot_ = ptrSlot;
+         ptrWaitingWork_.reset();
+
+         if (ptrSocket)
+         {
+            // reuse the pooled connection -- skip straight to the write
+            ptrSocket_ = ptrSocket;
+            usedPooledSocket_ = true;
+            writeRequest();
+         }
+         else
+         {
+            connectToStream();
+         }
+      }
+      CATCH_UNEXPECTED_ASYNC_CLIENT_EXCEPTION
+   }
+
+   void connectToStream()
    {
       // validate if requested
       if (validateUid_.is_initialized() && localStreamPath_.exists())
@@ -122,6 +187,43 @@ private:
       CATCH_UNEXPECTED_ASYNC_CLIENT_EXCEPTION
    }
 
+   virtual bool connectionReusable()
+   {
+      return ptrPool_ && reuseSocket_;
+   }
+
+   virtual void recycleConnection()
+   {
+      if (ptrSlot_)
+         ptrSlot_->recycle(ptrSocket_);
+      ptrSlot_.reset();
+   }
+
+   virtual bool retryStaleConnection(const boost::system::error_code& ec)
+   {
+      // a pooled connection can go stale while parked (e.g. the session
+      // exited) -- since the server never saw the request it's safe to
+      // transparently retry on a fresh connection (once)
+      if (!usedPooledSocket_ || retriedStaleConnection_)
+         return false;
+      retriedStaleConnection_ = true;
+
+      close();
+      ptrSocket_.reset(new boost::asio::local::stream_protocol::socket(
+                                                               ioService()));
+      connectToStream();
+      return true;
+   }
+
+   virtual bool stopReadingAndRespond()
+   {
+      // pooled connections remain open after the response so the body
+      // is delimited by content-length rather than the server closing
+      // the socket
+      return connectionReusable() &&
+             response_.containsHeader("Content-Length") &&
+             response_.body().length() >= response_.contentLength();
+   }
 
    const boost::shared_ptr<LocalStreamAsyncClient> sharedFromThis()
    {
@@ -132,12 +234,18 @@ private:
    }
 
 private:
-   boost::asio::local::stream_protocol::socket socket_;
+   boost::shared_ptr<boost::asio::local::stream_protocol::socket> ptrSocket_;
    core::FilePath localStreamPath_;
    boost::optional<UidType> validateUid_;
+   boost::shared_ptr<LocalStreamSocketPool> ptrPool_;
+   boost::shared_ptr<LocalStreamSocketPool::Slot> ptrSlot_;
+   boost::shared_ptr<boost::asio::io_service::work> ptrWaitingWork_;
+   bool reuseSocket_;
+   bool usedPooledSocket_;
+   bool retriedStaleConnection_;
 };
-   
-   
+
+
 } // namespace http
 } // namespace core
 } // namespace rstudio
@@ -34,6 +34,13 @@ inline Error sendRequest(const FilePath& localStreamPath,
    boost::shared_ptr<LocalStreamAsyncClient> pClient(
          new LocalStreamAsyncClient(ioService, localStreamPath, true));
 
+   // participate in the shared per-stream in-flight limit (but not in
+   // socket reuse -- the io_service created above doesn't outlive the
+   // request so pooled connections can't be parked against it)
+   pClient->setConnectionPool(
+         LocalStreamSocketPool::forStreamPath(localStreamPath.absolutePath()),
+         false);
+
    // execute blocking request
    return sendRequest<boost::asio::local::stream_protocol::socket>(ioService,
                                                                    pClient,
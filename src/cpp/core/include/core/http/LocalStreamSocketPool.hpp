@@ -0,0 +1,153 @@
+/*
+ * LocalStreamSocketPool.hpp
+ *
+ * Copyright (C) 2009-16 by RStudio, Inc.
+ *
+ * Unless you have received this program directly from RStudio pursuant
+ * to the terms of a commercial license agreement with RStudio, then
+ * this program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http://www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ *
+ */
+
+#ifndef CORE_HTTP_LOCAL_STREAM_SOCKET_POOL_HPP
+#define CORE_HTTP_LOCAL_STREAM_SOCKET_POOL_HPP
+
+#include <deque>
+#include <string>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/function.hpp>
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+
+#include <core/Thread.hpp>
+
+namespace rstudio {
+namespace core {
+namespace http {
+
+// Pool of connected unix domain sockets for a single stream endpoint.
+// It serves two purposes: retaining connected sockets between requests
+// so hot paths (e.g. proxying of session rpc) can skip the connect
+// handshake, and enforcing a maximum number of in-flight requests per
+// endpoint shared by all clients of the pool (acquires beyond the limit
+// are queued and dispensed as earlier requests complete)
+class LocalStreamSocketPool :
+      public boost::enable_shared_from_this<LocalStreamSocketPool>,
+      boost::noncopyable
+{
+public:
+   typedef boost::asio::local::stream_protocol::socket Socket;
+
+   // tracks one in-flight request against the pool. when the request
+   // completes successfully the holder recycles the connected socket
+   // back into the pool; otherwise the destructor simply releases the
+   // in-flight slot (so error paths can't leak slots)
+   class Slot : boost::noncopyable
+   {
+   public:
+      ~Slot();
+
+      // hand a still-connected socket back to the pool for reuse
+      void recycle(boost::shared_ptr<Socket> ptrSocket);
+
+   private:
+      friend class LocalStreamSocketPool;
+      explicit Slot(boost::shared_ptr<LocalStreamSocketPool> ptrPool)
+         : ptrPool_(ptrPool), pIoService_(NULL)
+      {
+      }
+
+      boost::shared_ptr<LocalStreamSocketPool> ptrPool_;
+      boost::shared_ptr<Socket> ptrSocket_;
+      boost::asio::io_service* pIoService_;
+   };
+
+   // handler invoked when a slot becomes available. the socket is an
+   // idle pooled connection when one is available for the caller's
+   // io_service, otherwise null (meaning the caller should connect)
+   typedef boost::function<void(boost::shared_ptr<Slot>,
+                                boost::shared_ptr<Socket>)> AcquiredHandler;
+
+   // get the shared pool for a stream path
+   static boost::shared_ptr<LocalStreamSocketPool> forStreamPath(
+                                          const std::string& streamPath);
+
+   explicit LocalStreamSocketPool(std::size_t maxInFlight = 16,
+                                  std::size_t maxIdle = 4);
+
+   // acquire an in-flight slot -- invokes the handler immediately when
+   // under the limit, otherwise queues it until a slot frees up. note
+   // that queued handlers are invoked on whatever thread completes the
+   // releasing request
+   void acquire(boost::asio::io_service& ioService,
+                const AcquiredHandler& handler);
+
+private:
+   friend class Slot;
+
+   // called by ~Slot -- releases the in-flight slot, optionally
+   // returning a reusable socket, and dispenses a queued acquire
+   void completed(boost::shared_ptr<Socket> ptrSocket,
+                  boost::asio::io_service* pIoService);
+
+   // remove and return an idle connection bound to the specified
+   // io_service (or null). mutex_ must be held
+   boost::shared_ptr<Socket> removeIdleConnection(
+                                 boost::asio::io_service* pIoService);
+
+   // close and discard idle connections which have exceeded the idle
+   // timeout. mutex_ must be held
+   void reapIdleConnections();
+
+private:
+   struct IdleConnection
+   {
+      IdleConnection(boost::shared_ptr<Socket> ptrSocket,
+                     boost::asio::io_service* pIoService,
+                     boost::posix_time::ptime idleSince)
+         : ptrSocket(ptrSocket),
+           pIoService(pIoService),
+           idleSince(idleSince)
+      {
+      }
+
+      boost::shared_ptr<Socket> ptrSocket;
+      boost::asio::io_service* pIoService;
+      boost::posix_time::ptime idleSince;
+   };
+
+   struct PendingAcquire
+   {
+      PendingAcquire(boost::asio::io_service* pIoService,
+                     const AcquiredHandler& handler)
+         : pIoService(pIoService), handler(handler)
+      {
+      }
+
+      boost::asio::io_service* pIoService;
+      AcquiredHandler handler;
+   };
+
+   boost::mutex mutex_;
+   std::size_t maxInFlight_;
+   std::size_t maxIdle_;
+   std::size_t inFlight_;
+   std::deque<IdleConnection> idleConnections_;
+   std::deque<PendingAcquire> pendingAcquires_;
+};
+
+} // namespace http
+} // namespace core
+} // namespace rstudio
+
+#endif // CORE_HTTP_LOCAL_STREAM_SOCKET_POOL_HPP
@@ -96,10 +96,17 @@ public:
                               const Header& overrideHeader = Header()) const ;
    
 protected:
-   // body_ is protected so that sub-classes set it directly (facilitating the 
+   // body_ is protected so that sub-classes set it directly (facilitating the
    // RVO for potentially large buffers). note this means that you MUST always
    // remember to call setContentLength after setting the body!
    std::string body_;
+
+   // additional body blocks appended after body_ when the message bytes
+   // are requested (see Response::setStreamedBody). kept as a list of
+   // bounded-size blocks so large bodies never require one contiguous
+   // allocation -- each block becomes its own const_buffer in toBuffers.
+   // note that body() does NOT include these blocks
+   std::vector<std::string> bodyParts_;
    
    void appendSpaceBuffer(
          std::vector<boost::asio::const_buffer>& buffers) const ;
@@ -110,6 +117,24 @@ protected:
    void assign(const Message& message, const Headers& extraHeaders)
    {
       body_ = message.body_;
+      bodyParts_ = message.bodyParts_;
+      httpVersionMajor_ = message.httpVersionMajor_;
+      httpVersionMinor_ = message.httpVersionMinor_;
+      headers_ = message.headers_;
+      overrideHeader_ = message.overrideHeader_;
+      httpVersion_ = message.httpVersion_;
+
+      std::for_each(extraHeaders.begin(), extraHeaders.end(),
+                    boost::bind(&Message::setExtraHeader, this, _1));
+   }
+
+   // variant of assign which takes ownership of the source message's body
+   // (leaving it empty) -- use when relaying a message whose body won't be
+   // consulted again so large bodies aren't held in memory twice
+   void assignWithSwappedBody(Message& message, const Headers& extraHeaders)
+   {
+      body_.swap(message.body_);
+      bodyParts_.swap(message.bodyParts_);
       httpVersionMajor_ = message.httpVersionMajor_;
       httpVersionMinor_ = message.httpVersionMinor_;
       headers_ = message.headers_;
@@ -49,6 +49,27 @@ public:
       queryParams_ = request.queryParams_;
    }
 
+   // variant of assign which takes ownership of the source request's body
+   // (leaving it empty) -- use when relaying a request (e.g. an upload)
+   // whose body won't be consulted again. note that un-parsed form fields
+   // travel with the body, so parse them from the target from then on
+   void assignWithSwappedBody(Request& request,
+                              const Headers& extraHeaders = Headers())
+   {
+      Message::assignWithSwappedBody(request, extraHeaders);
+      method_ = request.method_;
+      uri_ = request.uri_;
+      remoteUid_ = request.remoteUid_;
+      parsedCookies_ = request.parsedCookies_;
+      cookies_ = request.cookies_;
+      parsedFormFields_ = request.parsedFormFields_;
+      formFields_ = request.formFields_;
+      files_ = request.files_;
+      emptyFile_ = request.emptyFile_;
+      parsedQueryParams_ = request.parsedQueryParams_;
+      queryParams_ = request.queryParams_;
+   }
+
 public:
    const std::string& method() const { return method_; }
    void setMethod(const std::string& method) { method_ = method; }
@@ -17,6 +17,9 @@
 #ifndef CORE_HTTP_REQUEST_PARSER_HPP
 #define CORE_HTTP_REQUEST_PARSER_HPP
 
+#include <algorithm>
+#include <iterator>
+
 #include <core/http/Request.hpp>
 
 namespace rstudio {
@@ -27,6 +30,12 @@ namespace http {
 class RequestParser
 {
 public:
+  // cap on how much body space we preallocate up front. the declared
+  // Content-Length is attacker-controlled (this parser runs pre-auth on
+  // rserver's public port), so reserve at most this much and let larger
+  // bodies grow as bytes actually arrive
+  static const std::size_t kMaxBodyPrealloc = 65536;
+
   /// Construct ready to parse the request method.
   RequestParser();
 
@@ -49,6 +58,21 @@ public:
        // header parsing
       if (!parsing_body_)
       {
+         // bulk fast path -- when the parser is inside a run of ordinary
+         // characters (method, uri, header name, or header value), scan
+         // ahead to the next delimiter and append the whole run at once
+         // rather than a byte at a time. the delimiter itself still goes
+         // through consume so all state-transition logic stays in one
+         // place
+         InputIterator runEnd = findRunEnd(begin, end);
+         if (runEnd != begin)
+         {
+            appendRun(req, begin, runEnd);
+            begin = runEnd;
+            if (begin == end)
+               return incomplete;
+         }
+
          status st = consume(req, *begin++);
          if ( st == error )
          {
@@ -71,7 +95,19 @@ public:
       // body parsing
       else
       {
-         req.body_.push_back(*begin++) ;
+         // bulk-append all available body bytes (preallocating up to the
+         // cap so large uploads don't churn through string growth
+         // reallocations; the reserve is a pure optimization so we never
+         // trust the declared length for more than the cap)
+         if (req.body_.empty())
+            req.body_.reserve(std::min(content_length_, kMaxBodyPrealloc));
+         std::size_t bytesNeeded = content_length_ - req.body_.size();
+         std::size_t bytesAvailable = std::distance(begin, end);
+         std::size_t bytesToCopy = std::min(bytesNeeded, bytesAvailable);
+         InputIterator bodyEnd = begin;
+         std::advance(bodyEnd, bytesToCopy);
+         req.body_.append(begin, bodyEnd);
+         begin = bodyEnd;
          if (req.body_.size() == content_length_)
             return complete ;
       }
@@ -83,6 +119,77 @@ private:
   /// Handle the next character of input.
   status consume(Request& req, char input);
 
+  /// Scan ahead to the end of the current run of ordinary characters
+  /// (stops at the state's delimiter or at any character which needs
+  /// individual validation by consume). returns begin for states which
+  /// have no bulk fast path.
+  template <typename InputIterator>
+  InputIterator findRunEnd(InputIterator begin, InputIterator end) const
+  {
+    char delimiter;
+    switch (state_)
+    {
+    case method:
+    case uri:
+      delimiter = ' ';
+      break;
+    case header_name:
+      delimiter = ':';
+      break;
+    case header_value:
+      delimiter = '\r';
+      break;
+    default:
+      return begin;
+    }
+
+    InputIterator it = begin;
+    while (it != end && *it != delimiter && isOrdinaryRunChar(*it))
+      ++it;
+    return it;
+  }
+
+  /// Append a run of ordinary characters to the field currently being
+  /// parsed (only called for the states handled by findRunEnd).
+  template <typename InputIterator>
+  void appendRun(Request& req, InputIterator begin, InputIterator end)
+  {
+    switch (state_)
+    {
+    case method:
+      req.method_.append(begin, end);
+      break;
+    case uri:
+      req.uri_.append(begin, end);
+      break;
+    case header_name:
+      req.headers_.back().name.append(begin, end);
+      break;
+    case header_value:
+      req.headers_.back().value.append(begin, end);
+      break;
+    default:
+      break;
+    }
+  }
+
+  /// Check whether a character can be bulk-consumed in the current
+  /// state without individual inspection by consume.
+  bool isOrdinaryRunChar(char c) const
+  {
+    switch (state_)
+    {
+    case method:
+    case header_name:
+      return is_char(c) && !is_ctl(c) && !is_tspecial(c);
+    case uri:
+    case header_value:
+      return !is_ctl(c);
+    default:
+      return false;
+    }
+  }
+
   /// Check if a byte is an HTTP character.
   static bool is_char(int c);
 
@@ -18,6 +18,7 @@
 
 #include <iostream>
 #include <sstream>
+#include <boost/function.hpp>
 #include <boost/type_traits/is_same.hpp>
 #include <boost/iostreams/copy.hpp>
 #include <boost/iostreams/concepts.hpp>
@@ -96,6 +97,7 @@ public:
       statusCode_ = response.statusCode_;
       statusCodeStr_ = response.statusCodeStr_;
       statusMessage_ = response.statusMessage_;
+      streamFilePath_ = response.streamFilePath_;
    }
 
 public:   
@@ -107,6 +109,19 @@ public:
       
    std::string contentEncoding() const;
    void setContentEncoding(const std::string& encoding);
+
+   // mark the response as using chunked transfer-encoding (removes any
+   // content-length since the two are mutually exclusive). the body is
+   // then delivered incrementally by the connection -- see
+   // AsyncConnection::writeStreamedResponse
+   void setChunkedTransferEncoding();
+   bool isChunkedTransferEncoding() const;
+
+   // compress the existing body (including any streamed body blocks) in
+   // place with gzip, setting Content-Encoding and Content-Length
+   // accordingly. no-op on win32 (see setBody). callers are responsible
+   // for verifying that the client accepts gzip
+   Error gzipCompressBody();
    
    void setCacheWithRevalidationHeaders();
    void setCacheForeverHeaders();
@@ -118,7 +133,16 @@ public:
    void addCookie(const Cookie& cookie) ;
    
    Error setBody(const std::string& content);
-   
+
+   // stream the body directly into the response's scatter/gather buffer
+   // list. the writer is passed an ostream which appends to a sequence of
+   // bounded-size blocks, each sent as its own const_buffer -- no
+   // intermediate whole-body string is ever built (important for multi-MB
+   // payloads e.g. json-rpc responses from the data viewer)
+   Error setStreamedBody(
+               const boost::function<void(std::ostream&)>& writeBody);
+
+
    Error setCacheableBody(const std::string& content,
                           const Request& request)
    {
@@ -247,7 +271,16 @@ public:
    }
 
    void setDynamicHtml(const std::string& html, const Request& request);
-   
+
+   // serve the body directly from a file on disk. rather than reading the
+   // file into the response body the path is recorded and the connection
+   // transmits the content using a zero-copy primitive (sendfile on linux,
+   // mmap + write elsewhere) after the headers are written. no filtering
+   // or compression is applied on this path. honored by async connections
+   // only -- see AsyncConnectionImpl::writeResponse
+   void setStreamFile(const FilePath& filePath, const Request& request);
+   const std::string& streamFilePath() const { return streamFilePath_; }
+
    void setFile(const FilePath& filePath, const Request& request)
    {
       NullOutputFilter nullFilter;
@@ -353,6 +386,10 @@ private:
 
    // string storage for integer members (need for toBuffers)
    mutable std::string statusCodeStr_ ;
+
+   // file to transmit zero-copy in lieu of a buffered body
+   // (see setStreamFile)
+   std::string streamFilePath_ ;
 };
 
 std::ostream& operator << (std::ostream& stream, const Response& r) ;
@@ -16,9 +16,10 @@
 #ifndef CORE_HTTP_SOCKET_PROXY_HPP
 #define CORE_HTTP_SOCKET_PROXY_HPP
 
+#include <deque>
 #include <string>
+#include <vector>
 
-#include <boost/array.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/enable_shared_from_this.hpp>
 
@@ -49,6 +50,25 @@ private:
    {
    }
 
+   // state for one direction of the relay. reads are double-buffered:
+   // the next read is initiated while the previous write is still in
+   // flight and chunks which arrive in the interim are coalesced into
+   // a single scatter-gather write. the read buffer adapts to the
+   // traffic (grows during bulk transfers, shrinks back for
+   // interactive traffic)
+   struct Relay
+   {
+      Relay();
+
+      std::vector<char> readBuffer;
+      std::deque<std::string> queuedChunks;
+      std::deque<std::string> writingChunks;
+      std::size_t readBufferSize;
+      std::size_t queuedBytes;
+      bool readPending;
+      bool writePending;
+   };
+
    void readClient();
    void readServer();
 
@@ -60,6 +80,13 @@ private:
                           std::size_t bytesTransferred);
    void handleServerWrite(const boost::system::error_code& e,
                           std::size_t bytesTransferred);
+
+   // relay helpers (socketMutex_ must be held)
+   void startRead(bool fromClient);
+   void startWrite(Relay* pRelay);
+   void onRead(Relay* pRelay, std::size_t bytesTransferred);
+   void onWriteComplete(Relay* pRelay);
+
    void handleError(const boost::system::error_code& e,
                     const core::ErrorLocation& location);
 
@@ -68,8 +95,8 @@ private:
 private:
    boost::shared_ptr<core::http::Socket> ptrClient_;
    boost::shared_ptr<core::http::Socket> ptrServer_;
-   boost::array<char, 8192> clientBuffer_;
-   boost::array<char, 8192> serverBuffer_;
+   Relay clientToServer_;
+   Relay serverToClient_;
    boost::mutex socketMutex_;
 };
 
@@ -1,7 +1,7 @@
 /*
  * TcpIpAsyncConnector.hpp
  *
- * Copyright (C) 2009-12 by RStudio, Inc.
+ * Copyright (C) 2009-16 by RStudio, Inc.
  *
  * Unless you have received this program directly from RStudio pursuant
  * to the terms of a commercial license agreement with RStudio, then
@@ -16,13 +16,22 @@
 #ifndef CORE_HTTP_TCP_IP_ASYNC_CONNECTOR_HPP
 #define CORE_HTTP_TCP_IP_ASYNC_CONNECTOR_HPP
 
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
 #include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/enable_shared_from_this.hpp>
 
+#include <boost/asio/deadline_timer.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/placeholders.hpp>
 
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <core/Thread.hpp>
 
 #include <core/http/TcpIpSocketUtils.hpp>
 
@@ -41,7 +50,83 @@
 
 namespace rstudio {
 namespace core {
-namespace http {  
+namespace http {
+
+namespace tcp_resolver_cache {
+
+// process-wide cache of resolved endpoints, shared by all connectors
+// (and thus all outbound clients) so repeated requests to the same
+// host skip dns entirely while the entry is fresh. successful
+// endpoints are promoted to the front of their entry, which steers
+// subsequent connects away from unreachable address families (e.g. an
+// ipv6 route that black-holes in a dual-stack environment)
+
+struct Entry
+{
+   std::vector<boost::asio::ip::tcp::endpoint> endpoints;
+   boost::posix_time::ptime expiry;
+};
+
+struct Cache
+{
+   boost::mutex mutex;
+   std::map<std::string, Entry> entries;
+};
+
+// NOTE: function-local static in an inline function so there is a
+// single instance program-wide even though this header is included
+// from many translation units
+inline Cache& instance()
+{
+   static Cache cache;
+   return cache;
+}
+
+inline bool lookup(const std::string& key,
+                   std::vector<boost::asio::ip::tcp::endpoint>* pEndpoints)
+{
+   Cache& cache = instance();
+   boost::mutex::scoped_lock lock(cache.mutex);
+   std::map<std::string, Entry>::const_iterator it = cache.entries.find(key);
+   if (it == cache.entries.end())
+      return false;
+   if (boost::posix_time::microsec_clock::universal_time() > it->second.expiry)
+      return false;
+   *pEndpoints = it->second.endpoints;
+   return true;
+}
+
+inline void store(const std::string& key,
+                  const std::vector<boost::asio::ip::tcp::endpoint>& endpoints)
+{
+   Cache& cache = instance();
+   boost::mutex::scoped_lock lock(cache.mutex);
+   Entry& entry = cache.entries[key];
+   entry.endpoints = endpoints;
+   entry.expiry = boost::posix_time::microsec_clock::universal_time() +
+                  boost::posix_time::seconds(60);
+}
+
+inline void promote(const std::string& key,
+                    const boost::asio::ip::tcp::endpoint& endpoint)
+{
+   Cache& cache = instance();
+   boost::mutex::scoped_lock lock(cache.mutex);
+   std::map<std::string, Entry>::iterator it = cache.entries.find(key);
+   if (it == cache.entries.end())
+      return;
+   std::vector<boost::asio::ip::tcp::endpoint>& endpoints =
+                                                   it->second.endpoints;
+   std::vector<boost::asio::ip::tcp::endpoint>::iterator pos =
+            std::find(endpoints.begin(), endpoints.end(), endpoint);
+   if (pos != endpoints.end() && pos != endpoints.begin())
+   {
+      endpoints.erase(pos);
+      endpoints.insert(endpoints.begin(), endpoint);
+   }
+}
+
+} // namespace tcp_resolver_cache
 
 class TcpIpAsyncConnector :
       public boost::enable_shared_from_this<TcpIpAsyncConnector>,
@@ -55,7 +140,10 @@ public:
    TcpIpAsyncConnector(boost::asio::io_service& ioService,
                        boost::asio::ip::tcp::socket* pSocket)
      : pSocket_(pSocket),
-       resolver_(ioService)
+       resolver_(ioService),
+       staggerTimer_(ioService),
+       endpointIndex_(0),
+       connected_(false)
    {
    }
 
@@ -69,6 +157,14 @@ public:
       connectedHandler_ = connectedHandler;
       errorHandler_ = errorHandler;
 
+      // serve endpoints from the shared resolver cache when fresh
+      cacheKey_ = address + ":" + port;
+      if (tcp_resolver_cache::lookup(cacheKey_, &endpoints_))
+      {
+         tryNextEndpoint();
+         return;
+      }
+
       // start an async resolve
       boost::asio::ip::tcp::resolver::query query(address, port);
       resolver_.async_resolve(
@@ -89,14 +185,18 @@ private:
       {
          if (!ec)
          {
+            // snapshot the endpoints and cache them for subsequent
+            // connects to the same host
+            for (boost::asio::ip::tcp::resolver::iterator end;
+                 endpoint_iterator != end;
+                 ++endpoint_iterator)
+            {
+               endpoints_.push_back(*endpoint_iterator);
+            }
+            tcp_resolver_cache::store(cacheKey_, endpoints_);
+
             // try endpoints until we successfully connect with one
-            boost::asio::ip::tcp::endpoint endpoint = *endpoint_iterator;
-            pSocket_->async_connect(
-               endpoint,
-               boost::bind(&TcpIpAsyncConnector::handleConnect,
-                           TcpIpAsyncConnector::shared_from_this(),
-                           boost::asio::placeholders::error,
-                           ++endpoint_iterator));
+            tryNextEndpoint();
          }
          else
          {
@@ -106,33 +206,99 @@ private:
       CATCH_UNEXPECTED_ASYNC_CONNECTOR_EXCEPTION
    }
 
-   void handleConnect(
-         const boost::system::error_code& ec,
-         boost::asio::ip::tcp::resolver::iterator endpoint_iterator)
+   void tryNextEndpoint()
    {
       try
       {
-         if (!ec)
+         if (endpointIndex_ >= endpoints_.size())
          {
-            if (connectedHandler_)
-               connectedHandler_();
+            // exhausted all endpoints -- report the last connect error
+            boost::system::error_code ec = lastConnectError_;
+            if (ec.value() == 0)
+               ec = boost::asio::error::host_not_found;
+            handleErrorCode(ec, ERROR_LOCATION);
+            return;
          }
-         else if (endpoint_iterator !=
-                  boost::asio::ip::tcp::resolver::iterator())
+
+         boost::asio::ip::tcp::endpoint endpoint =
+                                          endpoints_[endpointIndex_];
+         pSocket_->async_connect(
+            endpoint,
+            boost::bind(&TcpIpAsyncConnector::handleConnect,
+                        TcpIpAsyncConnector::shared_from_this(),
+                        boost::asio::placeholders::error));
+
+         // if there are fallback endpoints then don't wait for the full
+         // os connect timeout before trying them -- close the socket
+         // after a short stagger interval (per the happy eyeballs
+         // approach, rfc 6555) so an unreachable first address family
+         // costs milliseconds rather than seconds. NOTE: we stagger
+         // rather than race in parallel because the socket is owned by
+         // our caller (there's no second socket to race with)
+         if ((endpointIndex_ + 1) < endpoints_.size())
          {
-            // try next endpoint
-            pSocket_->close();
-            boost::asio::ip::tcp::endpoint endpoint = *endpoint_iterator;
-            pSocket_->async_connect(
-               endpoint,
-               boost::bind(&TcpIpAsyncConnector::handleConnect,
+            staggerTimer_.expires_from_now(
+                              boost::posix_time::milliseconds(300));
+            staggerTimer_.async_wait(
+               boost::bind(&TcpIpAsyncConnector::handleStaggerTimeout,
                            TcpIpAsyncConnector::shared_from_this(),
-                           boost::asio::placeholders::error,
-                           ++endpoint_iterator));
+                           boost::asio::placeholders::error));
+         }
+      }
+      CATCH_UNEXPECTED_ASYNC_CONNECTOR_EXCEPTION
+   }
+
+   void handleStaggerTimeout(const boost::system::error_code& ec)
+   {
+      try
+      {
+         if (ec == boost::asio::error::operation_aborted)
+            return;
+         if (connected_)
+            return;
+
+         // closing the socket causes the pending async_connect to
+         // complete with operation_aborted; handleConnect then advances
+         // to the next endpoint (keeping a single advance path)
+         boost::system::error_code closeEc;
+         pSocket_->close(closeEc);
+      }
+      CATCH_UNEXPECTED_ASYNC_CONNECTOR_EXCEPTION
+   }
+
+   void handleConnect(const boost::system::error_code& ec)
+   {
+      try
+      {
+         staggerTimer_.cancel();
+
+         if (!ec)
+         {
+            connected_ = true;
+
+            // promote the endpoint that won so later connects to this
+            // host try it first
+            tcp_resolver_cache::promote(cacheKey_,
+                                        endpoints_[endpointIndex_]);
+
+            if (connectedHandler_)
+               connectedHandler_();
          }
          else
          {
-            handleErrorCode(ec, ERROR_LOCATION);
+            // remember the last real connect error (a stagger timeout
+            // surfaces as operation_aborted, which isn't informative)
+            if (ec != boost::asio::error::operation_aborted ||
+                lastConnectError_.value() == 0)
+            {
+               lastConnectError_ = ec;
+            }
+
+            // try next endpoint
+            boost::system::error_code closeEc;
+            pSocket_->close(closeEc);
+            endpointIndex_++;
+            tryNextEndpoint();
          }
       }
       CATCH_UNEXPECTED_ASYNC_CONNECTOR_EXCEPTION
@@ -162,6 +328,12 @@ private:
 private:
    boost::asio::ip::tcp::socket* pSocket_;
    boost::asio::ip::tcp::resolver resolver_;
+   boost::asio::deadline_timer staggerTimer_;
+   std::string cacheKey_;
+   std::vector<boost::asio::ip::tcp::endpoint> endpoints_;
+   std::size_t endpointIndex_;
+   bool connected_;
+   boost::system::error_code lastConnectError_;
    ConnectedHandler connectedHandler_;
    ErrorHandler errorHandler_;
 };
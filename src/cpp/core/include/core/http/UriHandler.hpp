@@ -16,10 +16,12 @@
 #ifndef CORE_HTTP_URI_HANDLER_HPP
 #define CORE_HTTP_URI_HANDLER_HPP
 
+#include <map>
 #include <string>
 #include <vector>
 
 #include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <core/http/Response.hpp>
 
@@ -49,9 +51,11 @@ public:
    UriHandler(const std::string& prefix, const UriHandlerFunction& function);
 
    // COPYING: via compiler
-   
+
    bool matches(const std::string& uri) const;
-   
+
+   const std::string& prefix() const { return prefix_; }
+
    UriAsyncHandlerFunction function() const;
   
    // implement UriHandlerFunction concept
@@ -73,9 +77,20 @@ public:
    void add(const UriHandler& handler);
    
    UriAsyncHandlerFunction handlerFor(const std::string& uri) const;
-   
+
+private:
+   // node in the prefix trie used for dispatch (lookup walks the uri
+   // character by character rather than testing every registered prefix)
+   struct PrefixNode
+   {
+      PrefixNode() : handlerIndex(-1) {}
+      std::map<char, boost::shared_ptr<PrefixNode> > children;
+      int handlerIndex; // index into uriHandlers_ (-1 if no prefix ends here)
+   };
+
 private:
    std::vector<UriHandler> uriHandlers_;
+   boost::shared_ptr<PrefixNode> prefixTree_;
 };
 
 inline void notFoundHandler(const Request& request, Response* pResponse)
@@ -0,0 +1,130 @@
+/*
+ * JsonSax.hpp
+ *
+ * Copyright (C) 2009-16 by RStudio, Inc.
+ *
+ * Unless you have received this program directly from RStudio pursuant
+ * to the terms of a commercial license agreement with RStudio, then
+ * this program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http://www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ *
+ */
+
+#ifndef CORE_JSON_SAX_HPP
+#define CORE_JSON_SAX_HPP
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <core/json/Json.hpp>
+
+namespace rstudio {
+namespace core {
+namespace json {
+
+// chunked arena allocator used for parse-time string storage. strings
+// decoded during a parse (escape sequences, member names, etc.) are
+// carved out of large contiguous blocks rather than individually
+// heap-allocated, then released all at once when the arena is cleared
+// or destroyed.
+class Arena : boost::noncopyable
+{
+public:
+   explicit Arena(std::size_t chunkSize = 64 * 1024);
+   ~Arena();
+
+   // allocate storage from the arena (never returns NULL; degenerates
+   // to a dedicated block for requests larger than the chunk size)
+   char* allocate(std::size_t bytes);
+
+   // release all storage owned by the arena
+   void clear();
+
+private:
+   std::size_t chunkSize_;
+   std::size_t bytesAvailable_;
+   char* pNext_;
+   std::vector<char*> chunks_;
+};
+
+// handler interface for streaming parse events. string data passed to
+// the handler points into either the input buffer or the parser's arena
+// and is valid only for the duration of the callback -- handlers which
+// need to retain it must copy. return false from any callback to abort
+// the parse.
+class SaxHandler
+{
+public:
+   virtual ~SaxHandler() {}
+
+   virtual bool onBeginObject() = 0;
+   virtual bool onEndObject() = 0;
+   virtual bool onBeginArray() = 0;
+   virtual bool onEndArray() = 0;
+   virtual bool onMemberName(const char* pData, std::size_t length) = 0;
+   virtual bool onString(const char* pData, std::size_t length) = 0;
+   virtual bool onBool(bool value) = 0;
+   virtual bool onInt(boost::int64_t value) = 0;
+   virtual bool onDouble(double value) = 0;
+   virtual bool onNull() = 0;
+};
+
+// parse json input, delivering events to the handler as each token is
+// recognized (no DOM is built). returns false on malformed input or if
+// the handler aborted the parse. safe to call concurrently from
+// multiple threads (unlike the spirit-based parser there is no shared
+// parser state).
+bool saxParse(const char* pInput, std::size_t length, SaxHandler* pHandler);
+bool saxParse(const std::string& input, SaxHandler* pHandler);
+
+// SaxHandler which builds a json::Value from the event stream. used to
+// implement json::parse but also available to callers which want to
+// build a DOM for a subtree while streaming the rest.
+class ValueBuilder : public SaxHandler, boost::noncopyable
+{
+public:
+   explicit ValueBuilder(Value* pValue);
+   virtual ~ValueBuilder();
+
+   virtual bool onBeginObject();
+   virtual bool onEndObject();
+   virtual bool onBeginArray();
+   virtual bool onEndArray();
+   virtual bool onMemberName(const char* pData, std::size_t length);
+   virtual bool onString(const char* pData, std::size_t length);
+   virtual bool onBool(bool value);
+   virtual bool onInt(boost::int64_t value);
+   virtual bool onDouble(double value);
+   virtual bool onNull();
+
+private:
+   bool addValue(const Value& value);
+
+private:
+   struct Frame;
+   Value* pValue_;
+   std::vector<Frame*> stack_;
+};
+
+// serialize a value directly to the stream with no intermediate
+// whole-document string
+void saxWrite(const Value& value, std::ostream& os);
+
+// write a correctly escaped json string literal (including the
+// surrounding quotes) to the stream
+void writeEscapedString(const char* pData, std::size_t length,
+                        std::ostream& os);
+
+} // namespace json
+} // namespace core
+} // namespace rstudio
+
+#endif // CORE_JSON_SAX_HPP
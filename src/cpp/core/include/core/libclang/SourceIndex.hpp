@@ -70,6 +70,13 @@ public:
    void removeTranslationUnit(const std::string& filename);
    void removeAllTranslationUnits();
 
+   // bound the total memory retained by indexed translation units --
+   // when the budget is exceeded the least recently used units are
+   // disposed (they are re-parsed on demand if used again). pass 0
+   // to disable the bound
+   void setMemoryBudget(unsigned long budgetBytes);
+   unsigned long memoryBudget() const { return memoryBudget_; }
+
    // get all indexed translation units
    std::map<std::string,TranslationUnit> getIndexedTranslationUnits();
 
@@ -88,23 +95,30 @@ private:
 
    struct StoredTranslationUnit
    {
-      StoredTranslationUnit() : lastWriteTime(0), tu(NULL) {}
+      StoredTranslationUnit() : lastWriteTime(0), lastUsed(0), tu(NULL) {}
       StoredTranslationUnit(const std::vector<std::string>& compileArgs,
                             std::time_t lastWriteTime,
                             CXTranslationUnit tu)
-         : compileArgs(compileArgs), lastWriteTime(lastWriteTime), tu(tu)
+         : compileArgs(compileArgs), lastWriteTime(lastWriteTime),
+           lastUsed(0), tu(tu)
       {
       }
       std::vector<std::string> compileArgs;
       std::time_t lastWriteTime;
+      unsigned long lastUsed;
       CXTranslationUnit tu;
    };
    typedef std::map<std::string,StoredTranslationUnit> TranslationUnits;
    TranslationUnits translationUnits_;
 
+   void enforceMemoryBudget();
+
    CompilationDatabase compilationDB_;
 
    int verbose_;
+
+   unsigned long memoryBudget_;
+   unsigned long accessCounter_;
 };
 
 } // namespace libclang
@@ -17,6 +17,8 @@
 #ifndef CORE_R_UTIL_ACTIVE_SESSIONS_HPP
 #define CORE_R_UTIL_ACTIVE_SESSIONS_HPP
 
+#include <map>
+
 #include <boost/noncopyable.hpp>
 
 #include <core/Error.hpp>
@@ -300,6 +302,12 @@ private:
    std::string id_;
    FilePath scratchPath_;
    FilePath propertiesPath_;
+
+   // cache of property values already read (or written) through this
+   // object -- listing sessions reads the same properties repeatedly
+   // (validation and the activity-level sort comparator both re-read
+   // them) and each miss costs a stat plus a read of a small file
+   mutable std::map<std::string, std::string> propertyCache_;
 };
 
 
@@ -0,0 +1,92 @@
+/*
+ * RStringTable.hpp
+ *
+ * Copyright (C) 2009-2015 by RStudio, Inc.
+ *
+ * Unless you have received this program directly from RStudio pursuant
+ * to the terms of a commercial license agreement with RStudio, then
+ * this program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http://www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ *
+ */
+
+#ifndef CORE_R_UTIL_R_STRING_TABLE_HPP
+#define CORE_R_UTIL_R_STRING_TABLE_HPP
+
+#include <deque>
+#include <map>
+#include <string>
+
+#include <boost/cstdint.hpp>
+#include <boost/utility.hpp>
+
+namespace rstudio {
+namespace core {
+namespace r_util {
+
+// A simple string interning table. Each distinct string handed to
+// intern() is stored exactly once and identified by a 32-bit handle;
+// clients that would otherwise keep many copies of the same symbol
+// name (parse trees, source indexes) can store handles instead and
+// resolve them back through get(). Handles are only meaningful within
+// the table that produced them.
+class RStringTable : boost::noncopyable
+{
+public:
+   typedef boost::uint32_t Handle;
+
+   RStringTable() {}
+
+   // COPYING: boost::noncopyable
+
+   Handle intern(const std::string& value)
+   {
+      std::map<std::string, Handle>::const_iterator it =
+                                                   handles_.find(value);
+      if (it != handles_.end())
+         return it->second;
+
+      Handle handle = static_cast<Handle>(strings_.size());
+      std::pair<std::map<std::string, Handle>::iterator, bool> result =
+            handles_.insert(std::make_pair(value, handle));
+
+      // map keys have stable addresses, so each string is stored once
+      // and the handle index just points back at the key
+      strings_.push_back(&result.first->first);
+      return handle;
+   }
+
+   bool lookup(const std::string& value, Handle* pHandle) const
+   {
+      std::map<std::string, Handle>::const_iterator it =
+                                                   handles_.find(value);
+      if (it == handles_.end())
+         return false;
+
+      *pHandle = it->second;
+      return true;
+   }
+
+   const std::string& get(Handle handle) const
+   {
+      return *strings_[handle];
+   }
+
+   std::size_t size() const
+   {
+      return strings_.size();
+   }
+
+private:
+   std::deque<const std::string*> strings_;
+   std::map<std::string, Handle> handles_;
+};
+
+} // namespace r_util
+} // namespace core
+} // namespace rstudio
+
+#endif // CORE_R_UTIL_R_STRING_TABLE_HPP
@@ -290,7 +290,14 @@ public:
    {
       return currentToken().contentEquals(content);
    }
-   
+
+   // null-terminated overload -- avoids a std::wstring temporary when
+   // comparing against wide literals (the common case)
+   bool contentEquals(const wchar_t* content) const
+   {
+      return currentToken().contentEquals(content);
+   }
+
    bool contentEquals(wchar_t character) const
    {
       return currentToken().contentEquals(character);
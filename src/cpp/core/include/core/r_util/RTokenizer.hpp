@@ -16,6 +16,8 @@
 #ifndef CORE_R_UTIL_R_TOKENIZER_HPP
 #define CORE_R_UTIL_R_TOKENIZER_HPP
 
+#include <cwctype>
+
 #include <string>
 #include <vector>
 #include <deque>
@@ -125,7 +127,36 @@ public:
       return distance == text.size() &&
              std::equal(begin_, end_, text.begin());
    }
-   
+
+   // comparison against a null-terminated string -- callers almost
+   // always pass wide literals, and this overload avoids constructing
+   // a std::wstring temporary per call (these comparisons dominate the
+   // lint pass so the allocations add up quickly)
+   bool contentEquals(const wchar_t* text) const
+   {
+      std::wstring::const_iterator it = begin_;
+      while (it != end_ && *text != L'\0' && *it == *text)
+      {
+         ++it;
+         ++text;
+      }
+      return it == end_ && *text == L'\0';
+   }
+
+   // case-folded variant of the above
+   bool contentEqualsIgnoreCase(const wchar_t* text) const
+   {
+      std::wstring::const_iterator it = begin_;
+      while (it != end_ && *text != L'\0' &&
+             ::towlower(static_cast<wint_t>(*it)) ==
+             ::towlower(static_cast<wint_t>(*text)))
+      {
+         ++it;
+         ++text;
+      }
+      return it == end_ && *text == L'\0';
+   }
+
    bool contentEquals(wchar_t character) const
    {
       return std::distance(begin_, end_) == 1 && *begin_ == character;
@@ -141,12 +172,28 @@ public:
       return std::search(begin_, end_, text.begin(), text.end()) == begin_;
    }
 
+   bool contentStartsWith(const wchar_t* text) const
+   {
+      std::wstring::const_iterator it = begin_;
+      while (it != end_ && *text != L'\0' && *it == *text)
+      {
+         ++it;
+         ++text;
+      }
+      return *text == L'\0';
+   }
+
    bool isOperator(const std::wstring& op) const
    {
       return (type_ == RToken::OPER) &&
               std::equal(begin_, end_, op.begin());
    }
 
+   bool isOperator(const wchar_t* op) const
+   {
+      return (type_ == RToken::OPER) && contentEquals(op);
+   }
+
    bool isType(TokenType type) const
    {
       return type_ == type;
@@ -214,12 +261,33 @@ public:
    {
    }
 
+   // begin tokenizing at an offset within the data (used by
+   // RTokens::update for incremental re-tokenization -- the row,
+   // column, and brace stack describe the lexer state at the offset)
+   RTokenizer(const std::wstring& data,
+              std::size_t offset,
+              std::size_t row,
+              std::size_t column,
+              const std::vector<char>& braceStack)
+      : data_(data),
+        begin_(data_.begin()),
+        end_(data_.end()),
+        pos_(data_.begin() + offset),
+        row_(row),
+        column_(column),
+        braceStack_(braceStack)
+   {
+   }
+
    virtual ~RTokenizer() {}
 
    // COPYING: boost::noncopyable
 
    RToken nextToken();
 
+   const std::wstring& data() const { return data_; }
+   const std::vector<char>& braceStack() const { return braceStack_; }
+
 private:
    RToken matchWhitespace();
    RToken matchNewline();
@@ -293,15 +361,18 @@ public:
    const_iterator end() const { return tokens_.end(); }
    
    RTokens()
-      : tokenizer_(L""),
-        dummyToken_(RToken::ERR)
+      : pTokenizer_(new RTokenizer(L"")),
+        dummyToken_(RToken::ERR),
+        flags_(None)
    {}
-   
+
    explicit RTokens(const std::wstring& code, int flags = None)
-      : tokenizer_(code), dummyToken_(RToken::ERR)
+      : pTokenizer_(new RTokenizer(code)),
+        dummyToken_(RToken::ERR),
+        flags_(flags)
    {
       RToken token;
-      while ((token = tokenizer_.nextToken()))
+      while ((token = pTokenizer_->nextToken()))
       {
          if ((flags & StripWhitespace) && token.type() == RToken::WHITESPACE)
             continue;
@@ -312,7 +383,18 @@ public:
          push_back(token);
       }
    }
-   
+
+   // incrementally re-tokenize after an edit which replaced
+   // removedLength characters at changeBegin with insertedLength
+   // characters (code is the post-edit document). tokens before the
+   // edit are reused as-is and tokens after it are reused with their
+   // positions shifted, so the cost scales with the size of the edit
+   // rather than the size of the document
+   void update(const std::wstring& code,
+               std::size_t changeBegin,
+               std::size_t removedLength,
+               std::size_t insertedLength);
+
    friend std::ostream& operator <<(std::ostream& os,
                                     const RTokens& rTokens)
    {
@@ -322,9 +404,10 @@ public:
    }
 
 private:
-    RTokenizer tokenizer_;
+    boost::shared_ptr<RTokenizer> pTokenizer_;
     Tokens tokens_;
     RToken dummyToken_;
+    int flags_;
 };
 
 namespace token_utils {
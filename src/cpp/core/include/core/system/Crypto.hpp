@@ -48,6 +48,11 @@ core::Error base64Decode(const std::string& data,
 
 core::Error rsaInit();
 
+// generate the rsa keypair on a background thread (generation takes
+// 100-300ms). rsaPublicKey and rsaPrivateDecrypt block until the
+// keypair is available
+void rsaInitAsync();
+
 void rsaPublicKey(std::string* pExponent, std::string* pModulo);
 
 core::Error rsaPrivateDecrypt(const std::string& pCipherText, std::string* pPlainText);
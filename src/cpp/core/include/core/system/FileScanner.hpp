@@ -39,12 +39,20 @@ namespace system {
 struct FileScannerOptions
 {
    FileScannerOptions()
-      : recursive(false), yield(false)
+      : recursive(false), yield(false), threads(1)
    {
    }
 
    bool recursive;
    bool yield;
+
+   // number of threads used to scan subdirectories (values greater
+   // than 1 apply only to recursive scans and are currently honored
+   // only by the posix implementation). NOTE: when threads > 1 the
+   // filter and onBeforeScanDir callbacks are invoked from worker
+   // threads and must therefore be thread-safe
+   int threads;
+
    boost::function<bool(const FileInfo&)> filter;
    boost::function<Error(const FileInfo&)> onBeforeScanDir;
 };
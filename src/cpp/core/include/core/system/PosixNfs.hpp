@@ -17,6 +17,7 @@
 #define CORE_SYSTEM_POSIX_NFS_HPP
 
 #include <string>
+#include <vector>
 
 namespace rstudio {
 namespace core {
@@ -34,7 +35,19 @@ namespace nfs {
 
 core::Error statWithCacheClear(const core::FilePath& path, bool *pCleared,
                                struct stat* pSt);
-   
+
+// synchronize a directory to stable storage (open + fsync). on nfs
+// this acts as a write barrier for recently created/renamed entries
+// in the directory and refreshes its attribute cache
+core::Error flushDirectoryCache(const core::FilePath& directory);
+
+// batched write barrier for a set of files: issues one directory
+// synchronization per unique parent directory rather than one flush
+// per file. file contents themselves are already flushed by close()
+// under nfs close-to-open consistency, so after a sweep that writes or
+// moves many files only the containing directories need a barrier
+core::Error writeBarrier(const std::vector<core::FilePath>& files);
+
 } // nfs
 } // namespace system
 } // namespace core
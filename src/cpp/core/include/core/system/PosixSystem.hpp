@@ -90,6 +90,18 @@ struct SysInfo
 
 core::Error systemInformation(SysInfo* pSysInfo);
 
+// process and host memory usage (in KB). limitKb is the effective
+// ceiling for this process: its cgroup memory limit when one is in
+// force, otherwise total physical memory
+struct MemoryUsage
+{
+   MemoryUsage() : rssKb(0), limitKb(0) {}
+   long long rssKb;
+   long long limitKb;
+};
+
+core::Error processMemoryUsage(MemoryUsage* pUsage);
+
 core::Error pidof(const std::string& process, std::vector<PidType>* pPids);
 
 struct ProcessInfo
@@ -0,0 +1,88 @@
+/*
+ * MultiPatternScanner.hpp
+ *
+ * Copyright (C) 2009-12 by RStudio, Inc.
+ *
+ * Unless you have received this program directly from RStudio pursuant
+ * to the terms of a commercial license agreement with RStudio, then
+ * this program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http://www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ *
+ */
+
+#ifndef CORE_TEXT_MULTI_PATTERN_SCANNER_HPP
+#define CORE_TEXT_MULTI_PATTERN_SCANNER_HPP
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/utility.hpp>
+
+namespace rstudio {
+namespace core {
+namespace text {
+
+// Aho-Corasick multi-pattern scanner. Build once from a set of literal
+// patterns, then scan text in a single pass regardless of how many
+// patterns there are (vs. one full scan per pattern with repeated
+// contains/replace calls). For chunked streams use a Scan object, which
+// carries automaton state across feed() calls so a pattern is still
+// found when it straddles a chunk boundary.
+class MultiPatternScanner : boost::noncopyable
+{
+public:
+   explicit MultiPatternScanner(const std::vector<std::string>& patterns);
+
+   // COPYING: boost::noncopyable
+
+   // single-buffer convenience scan
+   bool containsAny(const std::string& text) const;
+
+   // incremental scan over a chunked stream
+   class Scan
+   {
+   public:
+      explicit Scan(const MultiPatternScanner& scanner)
+         : pScanner_(&scanner), state_(0)
+      {
+      }
+
+      // COPYING: via compiler (copyable members)
+
+      void feed(const std::string& chunk);
+
+      bool matched() const { return !matches_.empty(); }
+
+      // indexes (into the pattern vector) of the patterns seen so far
+      const std::set<std::size_t>& matches() const { return matches_; }
+
+   private:
+      const MultiPatternScanner* pScanner_;
+      int state_;
+      std::set<std::size_t> matches_;
+   };
+
+private:
+   struct Node
+   {
+      Node() : fail(0) {}
+      int fail;
+      std::map<char,int> transitions;
+      std::vector<std::size_t> matches;
+   };
+
+   int step(int state, char ch) const;
+
+   std::vector<Node> nodes_;
+};
+
+} // namespace text
+} // namespace core
+} // namespace rstudio
+
+#endif // CORE_TEXT_MULTI_PATTERN_SCANNER_HPP
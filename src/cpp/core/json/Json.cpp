@@ -15,6 +15,7 @@
 
 #include <core/json/Json.hpp>
 #include <core/json/JsonRpc.hpp>
+#include <core/json/JsonSax.hpp>
 
 #include <cstdlib>
 #include <sstream>
@@ -118,27 +119,17 @@ bool fillMap(const Object& object, std::map< std::string, std::vector<std::strin
 
 bool parse(const std::string& input, Value* pValue)
 {
-   // two threads simultaneously using the json parser has been observed
-   // to crash the process. protect it globally with a mutex. note this was
-   // probably a result of not defining BOOST_SPIRIT_THREADSAFE (which we
-   // have subsequently defined) however since there isn't much documentation 
-   // on the behavior of boost spirit w/ threads and the specific behavior
-   // of this constant we leave in mutex just to be sure   
-      
-   static boost::mutex s_spiritMutex ;
-   LOCK_MUTEX(s_spiritMutex)
-   {
-      return json_spirit::read(input, *pValue);
-   }
-   END_LOCK_MUTEX
-   
-   // mutex related error
-   return false;
+   // parse with the streaming engine (see JsonSax.cpp). unlike the
+   // spirit-based recursive descent parser it has no shared state so no
+   // global mutex is required, and string storage is arena-allocated
+   // rather than churned through the heap
+   ValueBuilder builder(pValue);
+   return saxParse(input, &builder);
 }
 
 void write(const Value& value, std::ostream& os)
 {
-   json_spirit::write(value, os);
+   saxWrite(value, os);
 }
 
 void writeFormatted(const Value& value, std::ostream& os)
@@ -148,7 +139,9 @@ void writeFormatted(const Value& value, std::ostream& os)
 
 std::string write(const Value& value)
 {
-   return json_spirit::write(value);
+   std::ostringstream os;
+   saxWrite(value, os);
+   return os.str();
 }
 
 std::string writeFormatted(const Value& value)
@@ -17,6 +17,8 @@
 
 #include <sstream>
 
+#include <boost/bind.hpp>
+
 #include <core/Log.hpp>
 #include <core/http/Response.hpp>
 
@@ -272,10 +274,12 @@ void setJsonRpcResponse(const core::json::JsonRpcResponse& jsonRpcResponse,
    if (pResponse->contentType().empty())
        pResponse->setContentType(kJsonContentType) ; 
    
-   // set body 
-   std::stringstream responseStream ;
-   jsonRpcResponse.write(responseStream);
-   Error error = pResponse->setBody(responseStream);
+   // stream the serialized response directly into the response's
+   // scatter/gather output buffers (avoids building the whole body as an
+   // intermediate string then copying it -- significant for multi-MB
+   // payloads from the data viewer and environment pane)
+   Error error = pResponse->setStreamedBody(
+            boost::bind(&JsonRpcResponse::write, &jsonRpcResponse, _1));
    
    // report error to client if one occurred
    if (error)
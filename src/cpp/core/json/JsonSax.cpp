@@ -0,0 +1,723 @@
+/*
+ * JsonSax.cpp
+ *
+ * Copyright (C) 2009-16 by RStudio, Inc.
+ *
+ * Unless you have received this program directly from RStudio pursuant
+ * to the terms of a commercial license agreement with RStudio, then
+ * this program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http://www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ *
+ */
+
+#include <core/json/JsonSax.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+
+#include <boost/foreach.hpp>
+
+namespace rstudio {
+namespace core {
+namespace json {
+
+// Arena
+
+Arena::Arena(std::size_t chunkSize)
+   : chunkSize_(chunkSize),
+     bytesAvailable_(0),
+     pNext_(NULL)
+{
+}
+
+Arena::~Arena()
+{
+   clear();
+}
+
+char* Arena::allocate(std::size_t bytes)
+{
+   // oversized requests get their own block (keep the current chunk
+   // available for subsequent small allocations)
+   if (bytes > chunkSize_)
+   {
+      char* pBlock = static_cast<char*>(::operator new(bytes));
+      chunks_.push_back(pBlock);
+      return pBlock;
+   }
+
+   if (bytes > bytesAvailable_)
+   {
+      pNext_ = static_cast<char*>(::operator new(chunkSize_));
+      chunks_.push_back(pNext_);
+      bytesAvailable_ = chunkSize_;
+   }
+
+   char* pResult = pNext_;
+   pNext_ += bytes;
+   bytesAvailable_ -= bytes;
+   return pResult;
+}
+
+void Arena::clear()
+{
+   for (std::size_t i = 0; i < chunks_.size(); i++)
+      ::operator delete(chunks_[i]);
+   chunks_.clear();
+   pNext_ = NULL;
+   bytesAvailable_ = 0;
+}
+
+namespace {
+
+// streaming parser implementation. a hand-written scanner over the raw
+// input buffer -- strings without escapes are delivered as zero-copy
+// slices of the input; strings with escapes are decoded into the arena.
+class Parser : boost::noncopyable
+{
+public:
+   Parser(const char* pInput, std::size_t length, SaxHandler* pHandler)
+      : pCursor_(pInput),
+        pEnd_(pInput + length),
+        pHandler_(pHandler),
+        arena_(64 * 1024)
+   {
+   }
+
+   bool parse()
+   {
+      skipWhitespace();
+      if (!parseValue())
+         return false;
+      skipWhitespace();
+
+      // trailing garbage is malformed input
+      return pCursor_ == pEnd_;
+   }
+
+private:
+   void skipWhitespace()
+   {
+      while (pCursor_ != pEnd_ &&
+             (*pCursor_ == ' ' || *pCursor_ == '\t' ||
+              *pCursor_ == '\r' || *pCursor_ == '\n'))
+      {
+         pCursor_++;
+      }
+   }
+
+   bool parseValue()
+   {
+      if (pCursor_ == pEnd_)
+         return false;
+
+      switch (*pCursor_)
+      {
+         case '{':
+            return parseObject();
+         case '[':
+            return parseArray();
+         case '"':
+         {
+            const char* pData;
+            std::size_t length;
+            if (!parseString(&pData, &length))
+               return false;
+            return pHandler_->onString(pData, length);
+         }
+         case 't':
+            return parseLiteral("true", 4) && pHandler_->onBool(true);
+         case 'f':
+            return parseLiteral("false", 5) && pHandler_->onBool(false);
+         case 'n':
+            return parseLiteral("null", 4) && pHandler_->onNull();
+         default:
+            return parseNumber();
+      }
+   }
+
+   bool parseObject()
+   {
+      pCursor_++; // consume '{'
+      if (!pHandler_->onBeginObject())
+         return false;
+
+      skipWhitespace();
+      if (pCursor_ != pEnd_ && *pCursor_ == '}')
+      {
+         pCursor_++;
+         return pHandler_->onEndObject();
+      }
+
+      while (true)
+      {
+         skipWhitespace();
+         if (pCursor_ == pEnd_ || *pCursor_ != '"')
+            return false;
+
+         const char* pName;
+         std::size_t nameLength;
+         if (!parseString(&pName, &nameLength))
+            return false;
+         if (!pHandler_->onMemberName(pName, nameLength))
+            return false;
+
+         skipWhitespace();
+         if (pCursor_ == pEnd_ || *pCursor_ != ':')
+            return false;
+         pCursor_++;
+
+         skipWhitespace();
+         if (!parseValue())
+            return false;
+
+         skipWhitespace();
+         if (pCursor_ == pEnd_)
+            return false;
+         else if (*pCursor_ == ',')
+            pCursor_++;
+         else if (*pCursor_ == '}')
+         {
+            pCursor_++;
+            return pHandler_->onEndObject();
+         }
+         else
+            return false;
+      }
+   }
+
+   bool parseArray()
+   {
+      pCursor_++; // consume '['
+      if (!pHandler_->onBeginArray())
+         return false;
+
+      skipWhitespace();
+      if (pCursor_ != pEnd_ && *pCursor_ == ']')
+      {
+         pCursor_++;
+         return pHandler_->onEndArray();
+      }
+
+      while (true)
+      {
+         skipWhitespace();
+         if (!parseValue())
+            return false;
+
+         skipWhitespace();
+         if (pCursor_ == pEnd_)
+            return false;
+         else if (*pCursor_ == ',')
+            pCursor_++;
+         else if (*pCursor_ == ']')
+         {
+            pCursor_++;
+            return pHandler_->onEndArray();
+         }
+         else
+            return false;
+      }
+   }
+
+   bool parseLiteral(const char* pLiteral, std::size_t length)
+   {
+      if (static_cast<std::size_t>(pEnd_ - pCursor_) < length)
+         return false;
+      if (::memcmp(pCursor_, pLiteral, length) != 0)
+         return false;
+      pCursor_ += length;
+      return true;
+   }
+
+   bool parseString(const char** ppData, std::size_t* pLength)
+   {
+      pCursor_++; // consume opening quote
+      const char* pBegin = pCursor_;
+
+      // fast path: scan for the closing quote; if no escape sequence is
+      // encountered the string is a zero-copy slice of the input
+      while (pCursor_ != pEnd_)
+      {
+         char ch = *pCursor_;
+         if (ch == '"')
+         {
+            *ppData = pBegin;
+            *pLength = pCursor_ - pBegin;
+            pCursor_++;
+            return true;
+         }
+         else if (ch == '\\')
+         {
+            return parseEscapedString(pBegin, ppData, pLength);
+         }
+         pCursor_++;
+      }
+
+      // unterminated string
+      return false;
+   }
+
+   bool parseEscapedString(const char* pBegin,
+                           const char** ppData,
+                           std::size_t* pLength)
+   {
+      // decoded output is never longer than the encoded input; size the
+      // arena block for the worst case (remaining input)
+      char* pOutBegin = arena_.allocate(pEnd_ - pBegin);
+      char* pOut = pOutBegin;
+
+      // copy the portion already scanned (up to the first escape)
+      ::memcpy(pOut, pBegin, pCursor_ - pBegin);
+      pOut += pCursor_ - pBegin;
+
+      while (pCursor_ != pEnd_)
+      {
+         char ch = *pCursor_;
+         if (ch == '"')
+         {
+            *ppData = pOutBegin;
+            *pLength = pOut - pOutBegin;
+            pCursor_++;
+            return true;
+         }
+         else if (ch == '\\')
+         {
+            pCursor_++;
+            if (pCursor_ == pEnd_)
+               return false;
+
+            switch (*pCursor_)
+            {
+               case '"':  *pOut++ = '"';  break;
+               case '\\': *pOut++ = '\\'; break;
+               case '/':  *pOut++ = '/';  break;
+               case 'b':  *pOut++ = '\b'; break;
+               case 'f':  *pOut++ = '\f'; break;
+               case 'n':  *pOut++ = '\n'; break;
+               case 'r':  *pOut++ = '\r'; break;
+               case 't':  *pOut++ = '\t'; break;
+               case 'u':
+               {
+                  unsigned int codepoint;
+                  if (!parseUnicodeEscape(&codepoint))
+                     return false;
+                  pOut = appendUtf8(pOut, codepoint);
+                  continue; // escape already consumed
+               }
+               default:
+                  return false;
+            }
+            pCursor_++;
+         }
+         else
+         {
+            *pOut++ = ch;
+            pCursor_++;
+         }
+      }
+
+      // unterminated string
+      return false;
+   }
+
+   bool parseUnicodeEscape(unsigned int* pCodepoint)
+   {
+      pCursor_++; // consume 'u'
+      unsigned int codepoint;
+      if (!parseHex4(&codepoint))
+         return false;
+
+      // combine utf-16 surrogate pairs
+      if (codepoint >= 0xD800 && codepoint <= 0xDBFF)
+      {
+         if ((pEnd_ - pCursor_) < 6 ||
+             pCursor_[0] != '\\' || pCursor_[1] != 'u')
+         {
+            return false;
+         }
+         pCursor_ += 2;
+
+         unsigned int low;
+         if (!parseHex4(&low))
+            return false;
+         if (low < 0xDC00 || low > 0xDFFF)
+            return false;
+
+         codepoint = 0x10000 +
+                     ((codepoint - 0xD800) << 10) +
+                     (low - 0xDC00);
+      }
+
+      *pCodepoint = codepoint;
+      return true;
+   }
+
+   bool parseHex4(unsigned int* pValue)
+   {
+      if ((pEnd_ - pCursor_) < 4)
+         return false;
+
+      unsigned int value = 0;
+      for (int i = 0; i < 4; i++)
+      {
+         char ch = *pCursor_++;
+         value <<= 4;
+         if (ch >= '0' && ch <= '9')
+            value += ch - '0';
+         else if (ch >= 'a' && ch <= 'f')
+            value += ch - 'a' + 10;
+         else if (ch >= 'A' && ch <= 'F')
+            value += ch - 'A' + 10;
+         else
+            return false;
+      }
+      *pValue = value;
+      return true;
+   }
+
+   static char* appendUtf8(char* pOut, unsigned int codepoint)
+   {
+      if (codepoint < 0x80)
+      {
+         *pOut++ = static_cast<char>(codepoint);
+      }
+      else if (codepoint < 0x800)
+      {
+         *pOut++ = static_cast<char>(0xC0 | (codepoint >> 6));
+         *pOut++ = static_cast<char>(0x80 | (codepoint & 0x3F));
+      }
+      else if (codepoint < 0x10000)
+      {
+         *pOut++ = static_cast<char>(0xE0 | (codepoint >> 12));
+         *pOut++ = static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+         *pOut++ = static_cast<char>(0x80 | (codepoint & 0x3F));
+      }
+      else
+      {
+         *pOut++ = static_cast<char>(0xF0 | (codepoint >> 18));
+         *pOut++ = static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+         *pOut++ = static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+         *pOut++ = static_cast<char>(0x80 | (codepoint & 0x3F));
+      }
+      return pOut;
+   }
+
+   bool parseNumber()
+   {
+      const char* pBegin = pCursor_;
+      bool isDouble = false;
+
+      if (pCursor_ != pEnd_ && *pCursor_ == '-')
+         pCursor_++;
+
+      while (pCursor_ != pEnd_)
+      {
+         char ch = *pCursor_;
+         if (ch >= '0' && ch <= '9')
+         {
+            pCursor_++;
+         }
+         else if (ch == '.' || ch == 'e' || ch == 'E' ||
+                  ch == '+' || ch == '-')
+         {
+            isDouble = true;
+            pCursor_++;
+         }
+         else
+         {
+            break;
+         }
+      }
+
+      if (pCursor_ == pBegin)
+         return false;
+
+      // numbers are always followed by a structural character or
+      // whitespace so a bounded copy for strtod/strtoll is safe
+      char buffer[64];
+      std::size_t length = pCursor_ - pBegin;
+      if (length >= sizeof(buffer))
+         return false;
+      ::memcpy(buffer, pBegin, length);
+      buffer[length] = '\0';
+
+      char* pNumEnd = NULL;
+      if (isDouble)
+      {
+         double value = ::strtod(buffer, &pNumEnd);
+         if (pNumEnd != buffer + length)
+            return false;
+         return pHandler_->onDouble(value);
+      }
+      else
+      {
+#ifdef _WIN32
+         boost::int64_t value = ::_strtoi64(buffer, &pNumEnd, 10);
+#else
+         boost::int64_t value = ::strtoll(buffer, &pNumEnd, 10);
+#endif
+         if (pNumEnd != buffer + length)
+            return false;
+         return pHandler_->onInt(value);
+      }
+   }
+
+private:
+   const char* pCursor_;
+   const char* pEnd_;
+   SaxHandler* pHandler_;
+   Arena arena_;
+};
+
+} // anonymous namespace
+
+bool saxParse(const char* pInput, std::size_t length, SaxHandler* pHandler)
+{
+   Parser parser(pInput, length, pHandler);
+   return parser.parse();
+}
+
+bool saxParse(const std::string& input, SaxHandler* pHandler)
+{
+   return saxParse(input.data(), input.length(), pHandler);
+}
+
+// ValueBuilder
+
+struct ValueBuilder::Frame
+{
+   Frame(bool isObject) : isObject(isObject) {}
+   bool isObject;
+   Object object;
+   Array array;
+   std::string pendingName;
+};
+
+ValueBuilder::ValueBuilder(Value* pValue)
+   : pValue_(pValue)
+{
+}
+
+ValueBuilder::~ValueBuilder()
+{
+   for (std::size_t i = 0; i < stack_.size(); i++)
+      delete stack_[i];
+}
+
+bool ValueBuilder::addValue(const Value& value)
+{
+   if (stack_.empty())
+   {
+      *pValue_ = value;
+   }
+   else
+   {
+      Frame* pFrame = stack_.back();
+      if (pFrame->isObject)
+         pFrame->object[pFrame->pendingName] = value;
+      else
+         pFrame->array.push_back(value);
+   }
+   return true;
+}
+
+bool ValueBuilder::onBeginObject()
+{
+   stack_.push_back(new Frame(true));
+   return true;
+}
+
+bool ValueBuilder::onEndObject()
+{
+   Frame* pFrame = stack_.back();
+   stack_.pop_back();
+   Object object;
+   object.swap(pFrame->object);
+   delete pFrame;
+   return addValue(object);
+}
+
+bool ValueBuilder::onBeginArray()
+{
+   stack_.push_back(new Frame(false));
+   return true;
+}
+
+bool ValueBuilder::onEndArray()
+{
+   Frame* pFrame = stack_.back();
+   stack_.pop_back();
+   Array array;
+   array.swap(pFrame->array);
+   delete pFrame;
+   return addValue(array);
+}
+
+bool ValueBuilder::onMemberName(const char* pData, std::size_t length)
+{
+   stack_.back()->pendingName.assign(pData, length);
+   return true;
+}
+
+bool ValueBuilder::onString(const char* pData, std::size_t length)
+{
+   return addValue(Value(std::string(pData, length)));
+}
+
+bool ValueBuilder::onBool(bool value)
+{
+   return addValue(Value(value));
+}
+
+bool ValueBuilder::onInt(boost::int64_t value)
+{
+   return addValue(Value(value));
+}
+
+bool ValueBuilder::onDouble(double value)
+{
+   return addValue(Value(value));
+}
+
+bool ValueBuilder::onNull()
+{
+   return addValue(Value());
+}
+
+// streaming writer
+
+void writeEscapedString(const char* pData, std::size_t length,
+                        std::ostream& os)
+{
+   os.put('"');
+   const char* pEnd = pData + length;
+   const char* pRun = pData;
+   while (pData != pEnd)
+   {
+      unsigned char ch = static_cast<unsigned char>(*pData);
+      if (ch == '"' || ch == '\\' || ch < 0x20)
+      {
+         // flush the unescaped run then write the escape
+         if (pData != pRun)
+            os.write(pRun, pData - pRun);
+
+         switch (ch)
+         {
+            case '"':  os.write("\\\"", 2); break;
+            case '\\': os.write("\\\\", 2); break;
+            case '\b': os.write("\\b", 2);  break;
+            case '\f': os.write("\\f", 2);  break;
+            case '\n': os.write("\\n", 2);  break;
+            case '\r': os.write("\\r", 2);  break;
+            case '\t': os.write("\\t", 2);  break;
+            default:
+            {
+               char buffer[8];
+               ::sprintf(buffer, "\\u%04X", static_cast<unsigned int>(ch));
+               os.write(buffer, 6);
+               break;
+            }
+         }
+         pRun = pData + 1;
+      }
+      pData++;
+   }
+   if (pData != pRun)
+      os.write(pRun, pData - pRun);
+   os.put('"');
+}
+
+namespace {
+
+void writeValue(const Value& value, std::ostream& os)
+{
+   switch (value.type())
+   {
+      case json_spirit::obj_type:
+      {
+         os.put('{');
+         const Object& object = value.get_obj();
+         Object::const_iterator it = object.begin();
+         for ( ; it != object.end(); ++it)
+         {
+            if (it != object.begin())
+               os.put(',');
+            writeEscapedString(it->first.data(), it->first.length(), os);
+            os.put(':');
+            writeValue(it->second, os);
+         }
+         os.put('}');
+         break;
+      }
+      case json_spirit::array_type:
+      {
+         os.put('[');
+         const Array& array = value.get_array();
+         for (std::size_t i = 0; i < array.size(); i++)
+         {
+            if (i > 0)
+               os.put(',');
+            writeValue(array[i], os);
+         }
+         os.put(']');
+         break;
+      }
+      case json_spirit::str_type:
+      {
+         const std::string& str = value.get_str();
+         writeEscapedString(str.data(), str.length(), os);
+         break;
+      }
+      case json_spirit::bool_type:
+      {
+         if (value.get_bool())
+            os.write("true", 4);
+         else
+            os.write("false", 5);
+         break;
+      }
+      case json_spirit::int_type:
+      {
+         char buffer[32];
+#ifdef _WIN32
+         int length = ::sprintf(buffer, "%I64d",
+                                static_cast<boost::int64_t>(value.get_int64()));
+#else
+         int length = ::sprintf(buffer, "%lld",
+                                static_cast<long long>(value.get_int64()));
+#endif
+         os.write(buffer, length);
+         break;
+      }
+      case json_spirit::real_type:
+      {
+         char buffer[64];
+         int length = ::sprintf(buffer, "%.17g", value.get_real());
+         os.write(buffer, length);
+         break;
+      }
+      case json_spirit::null_type:
+      default:
+      {
+         os.write("null", 4);
+         break;
+      }
+   }
+}
+
+} // anonymous namespace
+
+void saxWrite(const Value& value, std::ostream& os)
+{
+   writeValue(value, os);
+}
+
+} // namespace json
+} // namespace core
+} // namespace rstudio
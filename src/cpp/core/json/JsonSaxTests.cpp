@@ -0,0 +1,99 @@
+/*
+ * JsonSaxTests.cpp
+ *
+ * Copyright (C) 2009-16 by RStudio, Inc.
+ *
+ * Unless you have received this program directly from RStudio pursuant
+ * to the terms of a commercial license agreement with RStudio, then
+ * this program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http://www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ *
+ */
+
+#include <tests/TestThat.hpp>
+
+#include <sstream>
+
+#include <core/json/Json.hpp>
+#include <core/json/JsonSax.hpp>
+
+namespace rstudio {
+namespace core {
+namespace json {
+
+context("Json Streaming Engine")
+{
+   test_that("Scalar values parse correctly")
+   {
+      Value value;
+      expect_true(parse("true", &value));
+      expect_true(value.get_bool() == true);
+
+      expect_true(parse("42", &value));
+      expect_true(value.get_int() == 42);
+
+      expect_true(parse("-3.5", &value));
+      expect_true(value.get_real() == -3.5);
+
+      expect_true(parse("null", &value));
+      expect_true(value.is_null());
+
+      expect_true(parse("\"hello\"", &value));
+      expect_true(value.get_str() == "hello");
+   }
+
+   test_that("Escape sequences are decoded")
+   {
+      Value value;
+      expect_true(parse("\"a\\nb\\t\\\"c\\\"\"", &value));
+      expect_true(value.get_str() == "a\nb\t\"c\"");
+
+      // unicode escape (including a surrogate pair)
+      expect_true(parse("\"\\u00e9\\ud83d\\ude00\"", &value));
+      expect_true(value.get_str() == "\xC3\xA9\xF0\x9F\x98\x80");
+   }
+
+   test_that("Objects and arrays round-trip")
+   {
+      std::string input =
+            "{\"a\":[1,2,3],\"b\":{\"c\":\"d\"},\"e\":null,\"f\":false}";
+      Value value;
+      expect_true(parse(input, &value));
+      expect_true(write(value) == input);
+   }
+
+   test_that("Malformed input is rejected")
+   {
+      Value value;
+      expect_false(parse("{\"a\":}", &value));
+      expect_false(parse("[1,2", &value));
+      expect_false(parse("\"unterminated", &value));
+      expect_false(parse("{} trailing", &value));
+      expect_false(parse("tru", &value));
+   }
+
+   test_that("Control characters are escaped on write")
+   {
+      Value value("a\nb\x01");
+      std::ostringstream os;
+      saxWrite(value, os);
+      expect_true(os.str() == "\"a\\nb\\u0001\"");
+   }
+
+   test_that("Arena satisfies large and small allocations")
+   {
+      Arena arena(256);
+      char* pSmall = arena.allocate(16);
+      expect_true(pSmall != NULL);
+      char* pLarge = arena.allocate(1024);
+      expect_true(pLarge != NULL);
+      arena.clear();
+   }
+}
+
+} // namespace json
+} // namespace core
+} // namespace rstudio
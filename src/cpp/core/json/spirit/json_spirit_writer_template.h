@@ -64,6 +64,48 @@ namespace json_spirit
     template< class String_type >
     String_type add_esc_chars( const String_type& s )
     {
+#ifdef HANDLE_UTF8
+        typedef typename String_type::value_type Char_type;
+        typedef typename String_type::size_type  Size_type;
+
+        // NOTE: (patch) copy unescaped runs in bulk rather than appending
+        // character by character -- strings serialized on hot paths (e.g.
+        // console output client events) are dominated by long runs with
+        // nothing to escape, and the per-character loop was a measurable
+        // cpu cost. when nothing at all needs escaping the string is
+        // returned as-is
+        String_type result;
+        Size_type runBegin = 0;
+        const Size_type size = s.size();
+
+        for( Size_type i = 0; i < size; ++i )
+        {
+            const Char_type c( s[i] );
+
+            switch( c )
+            {
+                case '"': case '\\': case '\b': case '\f':
+                case '\n': case '\r': case '\t':
+                {
+                    if( result.empty() )
+                        result.reserve( size + size / 8 );
+                    result.append( s, runBegin, i - runBegin );
+                    add_esc_char( c, result );
+                    runBegin = i + 1;
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+
+        if( runBegin == 0 )
+            return s;
+
+        result.append( s, runBegin, size - runBegin );
+
+        return result;
+#else
         typedef typename String_type::const_iterator Iter_type;
         typedef typename String_type::value_type     Char_type;
 
@@ -77,11 +119,6 @@ namespace json_spirit
 
             if( add_esc_char( c, result ) ) continue;
 
-#ifdef HANDLE_UTF8
-           
-           result += c;
-           
-#else
             const wint_t unsigned_c( ( c >= 0 ) ? c : 256 + c );
 
             if( iswprint( unsigned_c ) )
@@ -92,10 +129,10 @@ namespace json_spirit
             {
                 result += non_printable_to_string< String_type >( unsigned_c );
             }
-#endif
         }
 
         return result;
+#endif
     }
 
     // this class generates the JSON text,
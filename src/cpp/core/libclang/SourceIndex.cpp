@@ -33,8 +33,17 @@ namespace {
 
 inline unsigned applyTranslationUnitOptions(unsigned defaultOptions)
 {
-   // for now just reflect back the defaults
-   return defaultOptions;
+   // ask clang to build a precompiled preamble for the translation
+   // unit and to cache code completion results. with heavy headers
+   // (e.g. Rcpp) the preamble is nearly the entire cost of a parse,
+   // so completions and reparses that reuse it run in milliseconds
+   // rather than seconds. clang revalidates the preamble on each
+   // reparse and rebuilds it only when the include region changes.
+   // (these are typically already part of the default editing options
+   // but we don't want to depend on that across libclang versions)
+   return defaultOptions |
+          CXTranslationUnit_PrecompiledPreamble |
+          CXTranslationUnit_CacheCompletionResults;
 }
 
 bool isHeaderExtension(const std::string& ex)
@@ -42,6 +51,33 @@ bool isHeaderExtension(const std::string& ex)
    return ex == ".h" || ex == ".hh" || ex == ".hpp";
 }
 
+// total memory clang reports for a translation unit (same accounting
+// as TranslationUnit::printResourceUsage)
+unsigned long translationUnitMemoryUsage(CXTranslationUnit tu)
+{
+   CXTUResourceUsage usage = clang().getCXTUResourceUsage(tu);
+
+   unsigned long totalBytes = 0;
+   for (unsigned i = 0; i < usage.numEntries; i++)
+   {
+      CXTUResourceUsageEntry entry = usage.entries[i];
+      if (entry.kind >= CXTUResourceUsage_MEMORY_IN_BYTES_BEGIN &&
+          entry.kind <= CXTUResourceUsage_MEMORY_IN_BYTES_END)
+      {
+         totalBytes += entry.amount;
+      }
+   }
+
+   clang().disposeCXTUResourceUsage(usage);
+   return totalBytes;
+}
+
+// default bound on memory retained by indexed translation units; a
+// single Rcpp translation unit can occupy several hundred MB so this
+// allows a handful of hot units while preventing unbounded growth as
+// the user touches more files
+const unsigned long kDefaultMemoryBudget = 1024UL * 1024UL * 1024UL;
+
 } // anonymous namespace
 
 bool SourceIndex::isSourceFile(const FilePath& filePath)
@@ -67,6 +103,49 @@ SourceIndex::SourceIndex(CompilationDatabase compilationDB, int verbose)
    verbose_ = verbose;
    index_ = clang().createIndex(0, (verbose_ > 0) ? 1 : 0);
    compilationDB_ = compilationDB;
+   memoryBudget_ = kDefaultMemoryBudget;
+   accessCounter_ = 0;
+}
+
+void SourceIndex::setMemoryBudget(unsigned long budgetBytes)
+{
+   memoryBudget_ = budgetBytes;
+   enforceMemoryBudget();
+}
+
+void SourceIndex::enforceMemoryBudget()
+{
+   if (memoryBudget_ == 0)
+      return;
+
+   // always retain at least the most recently used unit (even a
+   // single large unit over the budget is more useful than nothing)
+   while (translationUnits_.size() > 1)
+   {
+      unsigned long totalBytes = 0;
+      TranslationUnits::iterator lruIt = translationUnits_.end();
+      for (TranslationUnits::iterator it = translationUnits_.begin();
+           it != translationUnits_.end();
+           ++it)
+      {
+         totalBytes += translationUnitMemoryUsage(it->second.tu);
+         if (lruIt == translationUnits_.end() ||
+             it->second.lastUsed < lruIt->second.lastUsed)
+         {
+            lruIt = it;
+         }
+      }
+
+      if (totalBytes <= memoryBudget_)
+         break;
+
+      if (verbose_ > 0)
+         std::cerr << "CLANG EVICT INDEX (over memory budget): "
+                   << lruIt->first << std::endl;
+
+      clang().disposeTranslationUnit(lruIt->second.tu);
+      translationUnits_.erase(lruIt);
+   }
 }
 
 SourceIndex::~SourceIndex()
@@ -187,6 +266,7 @@ TranslationUnit SourceIndex::getTranslationUnit(const std::string& filename,
       {
          if (verbose_ > 0)
             std::cerr << "  (Index already up to date)" << std::endl;
+         stored.lastUsed = ++accessCounter_;
          return TranslationUnit(filename, stored.tu, &unsavedFiles_);
       }
 
@@ -214,6 +294,7 @@ TranslationUnit SourceIndex::getTranslationUnit(const std::string& filename,
          {
             // update last write time
             stored.lastWriteTime = lastWriteTime;
+            stored.lastUsed = ++accessCounter_;
 
             // return it
             return TranslationUnit(filename, stored.tu, &unsavedFiles_);
@@ -256,9 +337,31 @@ TranslationUnit SourceIndex::getTranslationUnit(const std::string& filename,
    // save and return it if we succeeded
    if (tu != NULL)
    {
+      // reparse immediately: clang only generates the precompiled
+      // preamble during a reparse, so paying that cost now (while the
+      // file is merely being indexed) means the first completion or
+      // diagnostic request finds the preamble already built
+      int ret = clang().reparseTranslationUnit(
+                             tu,
+                             unsavedFiles().numUnsavedFiles(),
+                             unsavedFiles().unsavedFilesArray(),
+                             applyTranslationUnitOptions(
+                                   clang().defaultReparseOptions(tu)));
+      if (ret != 0)
+      {
+         LOG_ERROR_MESSAGE("Error generating preamble for translation unit " +
+                           filename);
+         clang().disposeTranslationUnit(tu);
+         return TranslationUnit();
+      }
+
       translationUnits_[filename] = StoredTranslationUnit(args,
                                                           lastWriteTime,
                                                           tu);
+      translationUnits_[filename].lastUsed = ++accessCounter_;
+
+      // evict older units if we've exceeded the memory budget
+      enforceMemoryBudget();
 
       TranslationUnit unit(filename, tu, &unsavedFiles_);
       if (verbose_ > 0)
@@ -16,6 +16,7 @@
 #include <core/markdown/Markdown.hpp>
 
 #include <iostream>
+#include <deque>
 
 #include <boost/foreach.hpp>
 #include <boost/scoped_ptr.hpp>
@@ -26,6 +27,7 @@
 
 #include <core/Error.hpp>
 #include <core/FilePath.hpp>
+#include <core/Thread.hpp>
 #include <core/StringUtils.hpp>
 #include <core/FileSerializer.hpp>
 #include <core/HtmlUtils.hpp>
@@ -307,6 +309,86 @@ void stripMetadata(std::string* pInput)
    }
 }
 
+// cache of recently rendered documents. markdown rendering is invoked
+// repeatedly with identical input (e.g. the live preview re-renders on
+// a timer and help topics are revisited) so remember the last few
+// renderings and return them directly when the input and rendering
+// options match. note that we cache whole documents rather than
+// individual blocks -- sundown resolves reference style links (and we
+// apply the mathjax filter) across the entire document, so blocks can't
+// be rendered and spliced independently.
+const std::size_t kMaxRenderCacheEntries = 16;
+
+struct RenderCacheEntry
+{
+   std::string key;
+   std::string output;
+};
+
+boost::mutex s_renderCacheMutex;
+std::deque<RenderCacheEntry> s_renderCache;
+
+std::string renderCacheKey(const std::string& input,
+                           const Extensions& extensions,
+                           const HTMLOptions& options)
+{
+   // prefix the input with a signature of the rendering options
+   std::string key;
+   key.reserve(input.length() + 24);
+   key.push_back(extensions.noIntraEmphasis ? '1' : '0');
+   key.push_back(extensions.tables ? '1' : '0');
+   key.push_back(extensions.fencedCode ? '1' : '0');
+   key.push_back(extensions.autolink ? '1' : '0');
+   key.push_back(extensions.laxSpacing ? '1' : '0');
+   key.push_back(extensions.spaceHeaders ? '1' : '0');
+   key.push_back(extensions.strikethrough ? '1' : '0');
+   key.push_back(extensions.superscript ? '1' : '0');
+   key.push_back(extensions.ignoreMath ? '1' : '0');
+   key.push_back(extensions.stripMetadata ? '1' : '0');
+   key.push_back(extensions.htmlPreserve ? '1' : '0');
+   key.push_back(options.useXHTML ? '1' : '0');
+   key.push_back(options.hardWrap ? '1' : '0');
+   key.push_back(options.smartypants ? '1' : '0');
+   key.push_back(options.safelink ? '1' : '0');
+   key.push_back(options.toc ? '1' : '0');
+   key.push_back(options.skipHTML ? '1' : '0');
+   key.push_back(options.skipStyle ? '1' : '0');
+   key.push_back(options.skipImages ? '1' : '0');
+   key.push_back(options.skipLinks ? '1' : '0');
+   key.push_back(options.escape ? '1' : '0');
+   key.push_back('\n');
+   key.append(input);
+   return key;
+}
+
+bool lookupRenderCache(const std::string& key, std::string* pOutput)
+{
+   boost::mutex::scoped_lock lock(s_renderCacheMutex);
+   for (std::deque<RenderCacheEntry>::const_iterator
+            it = s_renderCache.begin();
+        it != s_renderCache.end();
+        ++it)
+   {
+      if (it->key == key)
+      {
+         *pOutput = it->output;
+         return true;
+      }
+   }
+   return false;
+}
+
+void storeRenderCache(const std::string& key, const std::string& output)
+{
+   boost::mutex::scoped_lock lock(s_renderCacheMutex);
+   RenderCacheEntry entry;
+   entry.key = key;
+   entry.output = output;
+   s_renderCache.push_back(entry);
+   if (s_renderCache.size() > kMaxRenderCacheEntries)
+      s_renderCache.pop_front();
+}
+
 } // anonymous namespace
 
 // render markdown to HTML -- assumes UTF-8 encoding
@@ -351,112 +433,129 @@ Error markdownToHTML(const std::string& markdownInput,
                      std::string* pHTMLOutput)
 
 {
-   // exclude fenced code blocks
-   using namespace rstudio::core::html_utils;
-   std::vector<ExcludePattern> excludePatterns;
-   excludePatterns.push_back(ExcludePattern(boost::regex("^`{3,}[^\\n]*?$"),
-                                            boost::regex("^`{3,}\\s*$")));
-
-   // exclude inline verbatim code
-   excludePatterns.push_back(ExcludePattern(boost::regex("`[^\\n]+?`")));
-
-   // exclude indented code blocks
-   excludePatterns.push_back(ExcludePattern(
-      boost::regex("(\\A|\\A\\s*\\n|\\n\\s*\\n)(( {4}|\\t)[^\\n]*\\n)*(( {4}|\\t)[^\\n]*)")));
-
-   std::string input = markdownInput;
-   boost::scoped_ptr<MathJaxFilter> pMathFilter;
-   if (extensions.ignoreMath)
+   // consult the render cache before doing any work
+   std::string cacheKey = renderCacheKey(markdownInput, extensions, options);
+   std::string htmlOutput;
+   if (lookupRenderCache(cacheKey, &htmlOutput))
    {
-      pMathFilter.reset(new MathJaxFilter(excludePatterns,
-                                          &input,
-                                          pHTMLOutput));
+      pHTMLOutput->append(htmlOutput);
+      return Success();
    }
 
-   // respect html-preserve
-   html_utils::HtmlPreserver htmlPreserver;
-   if (extensions.htmlPreserve)
-      htmlPreserver.preserve(&input);
+   // render into htmlOutput -- the math filter restores its contents when
+   // it goes out of scope so this block must end before we cache the result
+   {
+      // exclude fenced code blocks
+      using namespace rstudio::core::html_utils;
+      std::vector<ExcludePattern> excludePatterns;
+      excludePatterns.push_back(ExcludePattern(boost::regex("^`{3,}[^\\n]*?$"),
+                                               boost::regex("^`{3,}\\s*$")));
+
+      // exclude inline verbatim code
+      excludePatterns.push_back(ExcludePattern(boost::regex("`[^\\n]+?`")));
+
+      // exclude indented code blocks
+      excludePatterns.push_back(ExcludePattern(
+         boost::regex("(\\A|\\A\\s*\\n|\\n\\s*\\n)(( {4}|\\t)[^\\n]*\\n)*(( {4}|\\t)[^\\n]*)")));
+
+      std::string input = markdownInput;
+      boost::scoped_ptr<MathJaxFilter> pMathFilter;
+      if (extensions.ignoreMath)
+      {
+         pMathFilter.reset(new MathJaxFilter(excludePatterns,
+                                             &input,
+                                             &htmlOutput));
+      }
+
+      // respect html-preserve
+      html_utils::HtmlPreserver htmlPreserver;
+      if (extensions.htmlPreserve)
+         htmlPreserver.preserve(&input);
 
-   // strip yaml front-matter / pandoc metadata if requested
-   if (extensions.stripMetadata)
-      stripMetadata(&input);
+      // strip yaml front-matter / pandoc metadata if requested
+      if (extensions.stripMetadata)
+         stripMetadata(&input);
 
-   // special case of empty input after stripping metadata
-   if (input.empty())
-   {
-      *pHTMLOutput = input;
-      return Success();
-   }
+      // special case of empty input after stripping metadata
+      if (input.empty())
+      {
+         *pHTMLOutput = input;
+         return Success();
+      }
 
-   // setup input buffer
-   SundownBuffer inputBuffer(input);
-   if (!inputBuffer.allocated())
-      return allocationError(ERROR_LOCATION);
+      // setup input buffer
+      SundownBuffer inputBuffer(input);
+      if (!inputBuffer.allocated())
+         return allocationError(ERROR_LOCATION);
 
-   // render table of contents if requested
-   if (options.toc)
-   {
+      // render table of contents if requested
+      if (options.toc)
+      {
+         struct sd_callbacks htmlCallbacks;
+         struct html_renderopt htmlOptions;
+         ::sdhtml_toc_renderer(&htmlCallbacks, &htmlOptions);
+         std::string tocOutput;
+         Error error = renderMarkdown(inputBuffer,
+                                      extensions,
+                                      options.smartypants,
+                                      &htmlCallbacks,
+                                      &htmlOptions,
+                                      &tocOutput);
+         if (error)
+            return error;
+         htmlOutput.append("<div id=\"toc\">\n");
+         htmlOutput.append("<div id=\"toc_header\">Table of Contents</div>\n");
+         htmlOutput.append(tocOutput);
+         htmlOutput.append("</div>\n");
+         htmlOutput.append("\n");
+      }
+
+      // setup html renderer
       struct sd_callbacks htmlCallbacks;
       struct html_renderopt htmlOptions;
-      ::sdhtml_toc_renderer(&htmlCallbacks, &htmlOptions);
-      std::string tocOutput;
+      int htmlRenderMode = 0;
+      if (options.useXHTML)
+         htmlRenderMode |= HTML_USE_XHTML;
+      if (options.hardWrap)
+         htmlRenderMode |= HTML_HARD_WRAP;
+      if (options.toc)
+         htmlRenderMode |= HTML_TOC;
+      if (options.safelink)
+         htmlRenderMode |= HTML_SAFELINK;
+      if (options.skipHTML)
+         htmlRenderMode |= HTML_SKIP_HTML;
+      if (options.skipStyle)
+         htmlRenderMode |= HTML_SKIP_STYLE;
+      if (options.skipImages)
+         htmlRenderMode |= HTML_SKIP_IMAGES;
+      if (options.skipLinks)
+         htmlRenderMode |= HTML_SKIP_LINKS;
+      if (options.escape)
+         htmlRenderMode |= HTML_ESCAPE;
+      ::sdhtml_renderer(&htmlCallbacks, &htmlOptions, htmlRenderMode);
+
+      // render page
+      std::string output;
       Error error = renderMarkdown(inputBuffer,
                                    extensions,
                                    options.smartypants,
                                    &htmlCallbacks,
                                    &htmlOptions,
-                                   &tocOutput);
+                                   &output);
       if (error)
          return error;
-      pHTMLOutput->append("<div id=\"toc\">\n");
-      pHTMLOutput->append("<div id=\"toc_header\">Table of Contents</div>\n");
-      pHTMLOutput->append(tocOutput);
-      pHTMLOutput->append("</div>\n");
-      pHTMLOutput->append("\n");
-   }
 
-   // setup html renderer
-   struct sd_callbacks htmlCallbacks;
-   struct html_renderopt htmlOptions;
-   int htmlRenderMode = 0;
-   if (options.useXHTML)
-      htmlRenderMode |= HTML_USE_XHTML;
-   if (options.hardWrap)
-      htmlRenderMode |= HTML_HARD_WRAP;
-   if (options.toc)
-      htmlRenderMode |= HTML_TOC;
-   if (options.safelink)
-      htmlRenderMode |= HTML_SAFELINK;
-   if (options.skipHTML)
-      htmlRenderMode |= HTML_SKIP_HTML;
-   if (options.skipStyle)
-      htmlRenderMode |= HTML_SKIP_STYLE;
-   if (options.skipImages)
-      htmlRenderMode |= HTML_SKIP_IMAGES;
-   if (options.skipLinks)
-      htmlRenderMode |= HTML_SKIP_LINKS;
-   if (options.escape)
-      htmlRenderMode |= HTML_ESCAPE;
-   ::sdhtml_renderer(&htmlCallbacks, &htmlOptions, htmlRenderMode);
-
-   // render page
-   std::string output;
-   Error error = renderMarkdown(inputBuffer,
-                                extensions,
-                                options.smartypants,
-                                &htmlCallbacks,
-                                &htmlOptions,
-                                &output);
-   if (error)
-      return error;
+      // append output
+      htmlOutput.append(output);
 
-   // append output
-   pHTMLOutput->append(output);
+      // restore htmlPreserve
+      if (extensions.htmlPreserve)
+         htmlPreserver.restore(&htmlOutput);
+   }
 
-   // restore htmlPreserve
-   if (extensions.htmlPreserve)
-      htmlPreserver.restore(pHTMLOutput);
+   // cache and return the rendering
+   storeRenderCache(cacheKey, htmlOutput);
+   pHTMLOutput->append(htmlOutput);
 
    return Success();
 }
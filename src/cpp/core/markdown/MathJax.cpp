@@ -46,6 +46,16 @@ MathJaxFilter::MathJaxFilter(const std::vector<html_utils::ExcludePattern>& excl
                              std::string* pHTMLOutput)
    : pHTMLOutput_(pHTMLOutput)
 {
+   // every equation form we recognize contains either a '$' or a "\["
+   // or "\(" sequence -- documents without any of them (the common
+   // case) can skip the exclude-range scan and regex passes entirely
+   if (pInput->find('$') == std::string::npos &&
+       pInput->find("\\[") == std::string::npos &&
+       pInput->find("\\(") == std::string::npos)
+   {
+      return;
+   }
+
    // divide the document into ranges (some of which will be processed
    // and some of which will not -- we don't process some regions so that
    // we don't need to worry about mathjax ambiguity within code regions)
@@ -46,27 +46,36 @@ void ActiveSession::writeProperty(const std::string& name,
    Error error = core::writeStringToFile(propertyFile, value);
    if (error)
       LOG_ERROR(error);
+   else
+      propertyCache_[name] = value;
 }
 
 std::string ActiveSession::readProperty(const std::string& name) const
 {
    using namespace rstudio::core;
+
+   // consult the cache first (missing properties are cached as empty
+   // so that repeated queries for them don't re-stat the file)
+   std::map<std::string, std::string>::const_iterator it =
+                                                propertyCache_.find(name);
+   if (it != propertyCache_.end())
+      return it->second;
+
+   std::string value;
    FilePath readPath = propertiesPath_.childPath(name);
    if (readPath.exists())
    {
-      std::string value;
       Error error = core::readStringFromFile(readPath, &value);
       if (error)
       {
          LOG_ERROR(error);
          return std::string();
       }
-      return boost::algorithm::trim_copy(value);
-   }
-   else
-   {
-      return std::string();
+      value = boost::algorithm::trim_copy(value);
    }
+
+   propertyCache_[name] = value;
+   return value;
 }
 
 Error ActiveSessions::create(const std::string& project,
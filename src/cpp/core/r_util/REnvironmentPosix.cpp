@@ -17,6 +17,7 @@
 
 #include <iostream>
 #include <algorithm>
+#include <map>
 
 #include <boost/regex.hpp>
 #include <boost/tokenizer.hpp>
@@ -28,6 +29,8 @@
 #include <core/Error.hpp>
 #include <core/FilePath.hpp>
 #include <core/ConfigUtils.hpp>
+#include <core/Thread.hpp>
+#include <core/SafeConvert.hpp>
 #include <core/system/System.hpp>
 #include <core/system/Process.hpp>
 #include <core/system/Environment.hpp>
@@ -555,6 +558,35 @@ bool detectRLocationsUsingR(const std::string& rScriptPath,
 }
 #endif
 
+// cache of successful environment detections. detection spawns R child
+// processes ("R RHOME", the ldpaths script) which costs hundreds of
+// milliseconds per call -- significant when many sessions launch against
+// the same (unchanged) R installation. entries are keyed by the resolved
+// script path and its last-write time plus the ld inputs, so upgrading
+// or switching R invalidates naturally; cached results are still
+// re-validated against the filesystem on every hit (which requires no
+// process spawns). guarded by a mutex since rserver probes R versions
+// from multiple threads
+struct DetectedREnvironment
+{
+   std::string rScriptPath;
+   std::string version;
+   EnvironmentVars vars;
+   FilePath rLibPath;
+};
+boost::mutex s_detectionCacheMutex;
+std::map<std::string, DetectedREnvironment> s_detectionCache;
+
+std::string detectionCacheKey(const std::string& rScriptPath,
+                              const FilePath& ldPathsScript,
+                              const std::string& ldLibraryPath)
+{
+   return rScriptPath + "\n" +
+          safe_convert::numberToString(FilePath(rScriptPath).lastWriteTime()) +
+          "\n" + ldPathsScript.absolutePath() +
+          "\n" + ldLibraryPath;
+}
+
 } // anonymous namespace
 
 
@@ -591,6 +623,49 @@ bool detectREnvironment(const FilePath& whichRScript,
       *pRScriptPath = sysRScript.absolutePath();
    }
 
+   // serve from the detection cache when this R binary has already been
+   // probed (re-validating against the filesystem, which spawns nothing)
+   std::string cacheKey = detectionCacheKey(*pRScriptPath,
+                                            ldPathsScript,
+                                            ldLibraryPath);
+   {
+      DetectedREnvironment cached;
+      bool haveCached = false;
+      LOCK_MUTEX(s_detectionCacheMutex)
+      {
+         std::map<std::string, DetectedREnvironment>::const_iterator it =
+                                             s_detectionCache.find(cacheKey);
+         if (it != s_detectionCache.end())
+         {
+            cached = it->second;
+            haveCached = true;
+         }
+      }
+      END_LOCK_MUTEX
+
+      if (haveCached)
+      {
+         std::string validateErrMsg;
+         if (validateREnvironment(cached.vars,
+                                  cached.rLibPath,
+                                  &validateErrMsg))
+         {
+            *pRScriptPath = cached.rScriptPath;
+            *pVersion = cached.version;
+            *pVars = cached.vars;
+            return true;
+         }
+
+         // stale entry (e.g. a partially removed installation) -- drop
+         // it and re-probe
+         LOCK_MUTEX(s_detectionCacheMutex)
+         {
+            s_detectionCache.erase(cacheKey);
+         }
+         END_LOCK_MUTEX
+      }
+   }
+
    // detect R locations
    FilePath rHomePath, rLibPath;
    config_utils::Variables scriptVars;
@@ -680,7 +755,23 @@ bool detectREnvironment(const FilePath& whichRScript,
    if (error)
       LOG_ERROR(error);
 
-   return validateREnvironment(*pVars, rLibPath, pErrMsg);
+   // cache successful detections so subsequent launches against this
+   // R binary skip the child-process probes entirely
+   bool valid = validateREnvironment(*pVars, rLibPath, pErrMsg);
+   if (valid)
+   {
+      DetectedREnvironment detected;
+      detected.rScriptPath = *pRScriptPath;
+      detected.version = *pVersion;
+      detected.vars = *pVars;
+      detected.rLibPath = rLibPath;
+      LOCK_MUTEX(s_detectionCacheMutex)
+      {
+         s_detectionCache[cacheKey] = detected;
+      }
+      END_LOCK_MUTEX
+   }
+   return valid;
 }
 
 
@@ -880,6 +880,21 @@ Error writeProjectFile(const FilePath& projectFilePath,
       contents.append(boost::str(tutorialFmt % config.tutorialPath));
    }
 
+   // skip the write if the file already has exactly this content.
+   // project files commonly live on network file systems where
+   // identical rewrites are costly, and an unnecessary write also
+   // triggers a spurious file-change notification for anyone
+   // monitoring the project directory
+   if (projectFilePath.exists())
+   {
+      std::string existingContents;
+      Error error = readStringFromFile(projectFilePath,
+                                       &existingContents,
+                                       string_utils::LineEndingPosix);
+      if (!error && existingContents == contents)
+         return Success();
+   }
+
    // write it
    return writeStringToFile(projectFilePath,
                             contents,
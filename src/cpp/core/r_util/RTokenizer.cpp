@@ -510,6 +510,209 @@ std::string RToken::asString() const
    return ss.str();
 }
 
+namespace {
+
+// replay a token's effect on the bracket stack (mirrors the handling
+// of `[`, `[[`, `]`, and `]]` in RTokenizer::nextToken)
+void applyTokenToBraceStack(const RToken& token, std::vector<char>* pStack)
+{
+   switch (token.type())
+   {
+   case RToken::LBRACKET:
+   case RToken::LDBRACKET:
+      pStack->push_back(token.type());
+      break;
+   case RToken::RBRACKET:
+   case RToken::RDBRACKET:
+      if (!pStack->empty())
+         pStack->pop_back();
+      break;
+   default:
+      break;
+   }
+}
+
+} // anonymous namespace
+
+void RTokens::update(const std::wstring& code,
+                     std::size_t changeBegin,
+                     std::size_t removedLength,
+                     std::size_t insertedLength)
+{
+   // sanity check the edit range (retokenize from scratch rather
+   // than produce a corrupt token stream if it is inconsistent)
+   if (changeBegin + insertedLength > code.size() ||
+       changeBegin + removedLength > pTokenizer_->data().size())
+   {
+      *this = RTokens(code, flags_);
+      return;
+   }
+
+   // find the reusable prefix: tokens ending strictly before the
+   // change. a token's extent depends only on the text from its own
+   // start, and the character which terminated it is also unchanged,
+   // so these tokens are unaffected (a token ending exactly at
+   // changeBegin could be extended by the insertion so it is not
+   // part of the prefix). the exception is ERR tokens: a lone ` or %
+   // lexes as a one character ERR only because its closing delimiter
+   // is missing, and an insertion after it can supply that delimiter,
+   // so the prefix can't extend past an ERR token
+   std::size_t prefixCount = 0;
+   while (prefixCount < tokens_.size())
+   {
+      const RToken& token = tokens_[prefixCount];
+      if (token.type() != RToken::ERR &&
+          token.offset() + token.length() < changeBegin)
+         prefixCount++;
+      else
+         break;
+   }
+
+   if (prefixCount == 0)
+   {
+      *this = RTokens(code, flags_);
+      return;
+   }
+
+   // compute the lexer state at the end of the prefix: restart
+   // position, row/column, and bracket stack
+   const RToken& lastPrefix = tokens_[prefixCount - 1];
+   std::size_t restartOffset = lastPrefix.offset() + lastPrefix.length();
+   std::size_t restartRow = lastPrefix.row();
+   std::size_t restartColumn = lastPrefix.column();
+   updatePosition(lastPrefix.begin(),
+                  lastPrefix.length(),
+                  &restartRow,
+                  &restartColumn);
+
+   std::vector<char> braceStack;
+   for (std::size_t i = 0; i < prefixCount; i++)
+      applyTokenToBraceStack(tokens_[i], &braceStack);
+
+   boost::shared_ptr<RTokenizer> pTokenizer(new RTokenizer(code,
+                                                           restartOffset,
+                                                           restartRow,
+                                                           restartColumn,
+                                                           braceStack));
+   const std::wstring& data = pTokenizer->data();
+
+   // rebase the prefix tokens onto the new buffer
+   Tokens tokens;
+   tokens.reserve(tokens_.size() + 4);
+   for (std::size_t i = 0; i < prefixCount; i++)
+   {
+      const RToken& token = tokens_[i];
+      tokens.push_back(RToken(token.type(),
+                              data.begin() + token.offset(),
+                              data.begin() + token.offset() + token.length(),
+                              token.offset(),
+                              token.row(),
+                              token.column()));
+   }
+
+   // locate the first old token at or beyond the end of the removed
+   // range (candidates for reuse), tracking the bracket stack state
+   // in front of it as we go
+   std::size_t oldChangeEnd = changeBegin + removedLength;
+   std::size_t newChangeEnd = changeBegin + insertedLength;
+   std::ptrdiff_t delta = static_cast<std::ptrdiff_t>(insertedLength) -
+                          static_cast<std::ptrdiff_t>(removedLength);
+
+   std::size_t suffixIndex = prefixCount;
+   std::vector<char> oldBraceStack = braceStack;
+   while (suffixIndex < tokens_.size() &&
+          tokens_[suffixIndex].offset() < oldChangeEnd)
+   {
+      applyTokenToBraceStack(tokens_[suffixIndex], &oldBraceStack);
+      suffixIndex++;
+   }
+
+   // re-lex forward from the restart point until we synchronize with
+   // the old token stream: a freshly lexed token which starts beyond
+   // the inserted text, aligns with an old token, and was reached
+   // with the same bracket stack must be followed by an identical
+   // stream (the remaining text is unchanged), so the old tokens can
+   // be reused with their positions shifted
+   bool synced = false;
+   std::size_t syncIndex = 0;
+   std::ptrdiff_t syncRowDelta = 0;
+   std::ptrdiff_t syncColumnDelta = 0;
+   std::size_t syncOldRow = 0;
+
+   while (true)
+   {
+      std::vector<char> stackBefore = pTokenizer->braceStack();
+      RToken token = pTokenizer->nextToken();
+      if (!token)
+         break;
+
+      if (token.offset() >= newChangeEnd)
+      {
+         std::ptrdiff_t oldOffset =
+               static_cast<std::ptrdiff_t>(token.offset()) - delta;
+         while (suffixIndex < tokens_.size() &&
+                static_cast<std::ptrdiff_t>(tokens_[suffixIndex].offset()) <
+                                                                     oldOffset)
+         {
+            applyTokenToBraceStack(tokens_[suffixIndex], &oldBraceStack);
+            suffixIndex++;
+         }
+
+         if (suffixIndex < tokens_.size())
+         {
+            const RToken& oldToken = tokens_[suffixIndex];
+            if (static_cast<std::ptrdiff_t>(oldToken.offset()) == oldOffset &&
+                oldToken.type() == token.type() &&
+                oldToken.length() == token.length() &&
+                oldBraceStack == stackBefore)
+            {
+               synced = true;
+               syncIndex = suffixIndex;
+               syncRowDelta = static_cast<std::ptrdiff_t>(token.row()) -
+                              static_cast<std::ptrdiff_t>(oldToken.row());
+               syncColumnDelta = static_cast<std::ptrdiff_t>(token.column()) -
+                                 static_cast<std::ptrdiff_t>(oldToken.column());
+               syncOldRow = oldToken.row();
+               break;
+            }
+         }
+      }
+
+      if ((flags_ & StripWhitespace) && token.type() == RToken::WHITESPACE)
+         continue;
+      if ((flags_ & StripComments) && token.type() == RToken::COMMENT)
+         continue;
+
+      tokens.push_back(token);
+   }
+
+   // rebase the reusable suffix: offsets shift by the edit delta,
+   // rows shift by the row delta, and columns shift only for tokens
+   // on the same row as the synchronization point (later rows are
+   // untouched text)
+   if (synced)
+   {
+      for (std::size_t i = syncIndex; i < tokens_.size(); i++)
+      {
+         const RToken& token = tokens_[i];
+         std::size_t offset = token.offset() + delta;
+         std::size_t row = token.row() + syncRowDelta;
+         std::size_t column = (token.row() == syncOldRow)
+                                 ? token.column() + syncColumnDelta
+                                 : token.column();
+         tokens.push_back(RToken(token.type(),
+                                 data.begin() + offset,
+                                 data.begin() + offset + token.length(),
+                                 offset,
+                                 row,
+                                 column));
+      }
+   }
+
+   pTokenizer_ = pTokenizer;
+   tokens_.swap(tokens);
+}
+
 } // namespace r_util
 } // namespace core 
 } // namespace rstudio
@@ -385,8 +385,15 @@ struct HunspellSpellingEngine::Impl
 
    void useDictionary(const std::string& langId)
    {
+      // defer (re-)loading of the dictionary until the next spelling
+      // request -- parsing the .dic/.aff pair allocates several megabytes
+      // and this is called whenever user settings change, including for
+      // sessions that never issue a spelling request
       if (dictionaryContextChanged(langId))
-         resetDictionaries(langId);
+      {
+         currentLangId_ = langId;
+         pSpellChecker_.reset();
+      }
    }
 
    SpellChecker& spellChecker()
@@ -16,6 +16,7 @@
 #include "ChildProcess.hpp"
 
 #include <fcntl.h>
+#include <poll.h>
 #include <signal.h>
 #include <unistd.h>
 
@@ -32,6 +33,7 @@
 #include <sys/types.h>
 
 #include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include <core/Error.hpp>
 #include <core/Log.hpp>
@@ -366,6 +368,29 @@ Error ChildProcess::run()
    int fdError[2] = {0,0};
    int fdMaster = 0;
 
+   // build exec args and environment before forking. the strings are
+   // heap allocated so they remain valid in the child through the exec,
+   // and constructing them here keeps the child from allocating between
+   // fork and exec (the scoped_ptrs release the parent's copies; the
+   // child's address space has its own)
+   std::vector<std::string> execArgs;
+   execArgs.push_back(exe_);
+   execArgs.insert(execArgs.end(), args_.begin(), args_.end());
+   using core::system::ProcessArgs;
+   boost::scoped_ptr<ProcessArgs> pProcessArgs(new ProcessArgs(execArgs));
+   boost::scoped_ptr<ProcessArgs> pEnvironment;
+   if (options_.environment)
+   {
+      std::vector<std::string> env;
+      const Options& options = options_.environment.get();
+      for (Options::const_iterator
+               it = options.begin(); it != options.end(); ++it)
+      {
+         env.push_back(it->first + "=" + it->second);
+      }
+      pEnvironment.reset(new ProcessArgs(env));
+   }
+
    // pseudoterminal mode: fork using the special forkpty call
    if (options_.pseudoterminal)
    {
@@ -542,32 +567,13 @@ Error ChildProcess::run()
          }
       }
 
-      // build args (on heap so they stay around after exec)
-      // create set of args to pass (needs to include the cmd)
-      std::vector<std::string> args;
-      args.push_back(exe_);
-      args.insert(args.end(), args_.begin(), args_.end());
-      using core::system::ProcessArgs;
-      ProcessArgs* pProcessArgs = new ProcessArgs(args);
-
-      if (options_.environment)
+      // execute using the args/environment built prior to the fork
+      if (pEnvironment)
       {
-         // build env (on heap, see comment above)
-         std::vector<std::string> env;
-         const Options& options = options_.environment.get();
-         for (Options::const_iterator
-                  it = options.begin(); it != options.end(); ++it)
-         {
-            env.push_back(it->first + "=" + it->second);
-         }
-         ProcessArgs* pEnvironment = new ProcessArgs(env);
-
-         // execute
          ::execve(exe_.c_str(), pProcessArgs->args(), pEnvironment->args());
       }
       else
       {
-         // execute
          ::execv(exe_.c_str(), pProcessArgs->args()) ;
       }
 
@@ -733,8 +739,42 @@ void AsyncChildProcess::poll()
       }
    }
 
+   // determine which output pipes actually have data (or eof) for us with
+   // a single poll(2) call -- sessions can be supervising many quiescent
+   // children (terminals, builds, version control) and unconditional reads
+   // cost two syscalls per child on every tick. if poll fails for any
+   // reason just fall back to reading both pipes unconditionally
+   bool checkStdout = !pAsyncImpl_->finishedStdout_;
+   bool checkStderr = !pAsyncImpl_->finishedStderr_;
+   struct pollfd pfds[2];
+   int nfds = 0;
+   int stdoutIndex = -1, stderrIndex = -1;
+   if (checkStdout)
+   {
+      pfds[nfds].fd = pImpl_->fdStdout;
+      pfds[nfds].events = POLLIN;
+      pfds[nfds].revents = 0;
+      stdoutIndex = nfds++;
+   }
+   if (checkStderr)
+   {
+      pfds[nfds].fd = pImpl_->fdStderr;
+      pfds[nfds].events = POLLIN;
+      pfds[nfds].revents = 0;
+      stderrIndex = nfds++;
+   }
+   if (nfds > 0 && ::poll(pfds, nfds, 0) >= 0)
+   {
+      // note that a pipe at eof reports POLLHUP, so exited children are
+      // always read (and their finished flags set) rather than skipped
+      if (stdoutIndex != -1)
+         checkStdout = pfds[stdoutIndex].revents != 0;
+      if (stderrIndex != -1)
+         checkStderr = pfds[stderrIndex].revents != 0;
+   }
+
    // check stdout and fire event if we got output
-   if (!pAsyncImpl_->finishedStdout_)
+   if (checkStdout)
    {
       bool eof;
       std::string out;
@@ -754,7 +794,7 @@ void AsyncChildProcess::poll()
    }
 
    // check stderr and fire event if we got output
-   if (!pAsyncImpl_->finishedStderr_)
+   if (checkStderr)
    {
       bool eof;
       std::string err;
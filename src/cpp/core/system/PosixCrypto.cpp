@@ -32,6 +32,7 @@
 
 #include <core/Log.hpp>
 #include <core/Error.hpp>
+#include <core/Thread.hpp>
 
 // openssl calls on lion are are all marked as deprecated
 #ifdef __clang__
@@ -250,9 +251,17 @@ namespace {
 RSA* s_pRSA;
 std::string s_modulo;
 std::string s_exponent;
-}
 
-core::Error rsaInit()
+// keypair generation state -- generation takes 100-300ms so it can be
+// performed on a background thread at init (rsaInitAsync); accessors
+// block until the keypair is available
+boost::mutex s_rsaInitMutex;
+boost::condition s_rsaInitCondition;
+bool s_rsaInitStarted = false;
+bool s_rsaInitComplete = false;
+Error s_rsaInitError;
+
+Error generateRsaKey()
 {
    const int KEY_SIZE = 1024;
    const int ENTROPY_BYTES = 4096;
@@ -285,16 +294,73 @@ core::Error rsaInit()
    return Success();
 }
 
+// block until the keypair is available -- waits out an in-flight
+// background generation, or generates on demand if no init was performed
+Error ensureRsaInit()
+{
+   boost::mutex::scoped_lock lock(s_rsaInitMutex);
+
+   while (s_rsaInitStarted && !s_rsaInitComplete)
+      s_rsaInitCondition.wait(lock);
+
+   if (!s_rsaInitComplete)
+   {
+      s_rsaInitStarted = true;
+      s_rsaInitError = generateRsaKey();
+      s_rsaInitComplete = true;
+   }
+
+   return s_rsaInitError;
+}
+
+void rsaInitThread()
+{
+   Error error = generateRsaKey();
+
+   boost::mutex::scoped_lock lock(s_rsaInitMutex);
+   s_rsaInitError = error;
+   s_rsaInitComplete = true;
+   s_rsaInitCondition.notify_all();
+}
+
+} // anonymous namespace
+
+core::Error rsaInit()
+{
+   return ensureRsaInit();
+}
+
+void rsaInitAsync()
+{
+   // only the first call launches the generation thread
+   {
+      boost::mutex::scoped_lock lock(s_rsaInitMutex);
+      if (s_rsaInitStarted)
+         return;
+      s_rsaInitStarted = true;
+   }
+
+   core::thread::safeLaunchThread(rsaInitThread);
+}
+
 void rsaPublicKey(std::string* pExponent, std::string* pModulo)
 {
+   Error error = ensureRsaInit();
+   if (error)
+      LOG_ERROR(error);
+
    pModulo->assign(s_modulo.begin(), s_modulo.end());
    pExponent->assign(s_exponent.begin(), s_exponent.end());
 }
 
 core::Error rsaPrivateDecrypt(const std::string& cipherText, std::string* pPlainText)
 {
+   Error error = ensureRsaInit();
+   if (error)
+      return error;
+
    std::vector<unsigned char> cipherTextBytes;
-   Error error = base64Decode(cipherText, &cipherTextBytes);
+   error = base64Decode(cipherText, &cipherTextBytes);
    if (error)
       return error;
 
@@ -19,6 +19,8 @@
 
 #include <boost/algorithm/string/predicate.hpp>
 
+#include <core/Thread.hpp>
+
 extern char **environ;
 
 namespace rstudio {
@@ -34,14 +36,56 @@ bool optionIsNamed(const Option& option, const std::string& name)
 
 } // namespace impl
 
+namespace {
+
+// cached snapshot of the process environment. environment() is called
+// when building the environment for nearly every child process we spawn
+// (git status polls, postback scripts, R processes) and re-parsing the
+// full environ block each time is measurable at that rate.
+boost::mutex s_environmentMutex;
+Options s_environmentSnapshot;
+std::size_t s_environmentFingerprint = 0;
+
+// cheap fingerprint of the environ block used to validate the snapshot.
+// setenv/unsetenv (including calls which don't come through our wrappers
+// below, e.g. Sys.setenv within R) install newly allocated entries into
+// environ, so comparing the entry pointers detects modification without
+// re-parsing. in-place mutation of a previously installed string (legal
+// only via putenv) would not be detected, however no code in this
+// process modifies the environment that way.
+std::size_t environFingerprint()
+{
+   std::size_t fingerprint = 0;
+   for (char** env = environ; *env; ++env)
+      fingerprint = (fingerprint * 31) + reinterpret_cast<std::size_t>(*env);
+   return fingerprint;
+}
+
+} // anonymous namespace
+
 void environment(Options* pEnvironment)
 {
-   for (char **env = environ; *env; ++env)
+   LOCK_MUTEX(s_environmentMutex)
    {
-      Option envVar;
-      if (parseEnvVar(std::string(*env), &envVar))
-         pEnvironment->push_back(envVar);
+      std::size_t fingerprint = environFingerprint();
+      if (s_environmentSnapshot.empty() ||
+          fingerprint != s_environmentFingerprint)
+      {
+         s_environmentSnapshot.clear();
+         for (char **env = environ; *env; ++env)
+         {
+            Option envVar;
+            if (parseEnvVar(std::string(*env), &envVar))
+               s_environmentSnapshot.push_back(envVar);
+         }
+         s_environmentFingerprint = fingerprint;
+      }
+
+      pEnvironment->insert(pEnvironment->end(),
+                           s_environmentSnapshot.begin(),
+                           s_environmentSnapshot.end());
    }
+   END_LOCK_MUTEX
 }
 
 std::string getenv(const std::string& name)
@@ -16,14 +16,21 @@
 #include <core/system/FileScanner.hpp>
 
 #include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/stat.h>
 
+#include <algorithm>
+#include <vector>
+
+#include <boost/bind.hpp>
 #include <boost/foreach.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <core/Error.hpp>
 #include <core/Log.hpp>
-#include <core/FilePath.hpp>
 #include <core/BoostThread.hpp>
+#include <core/Thread.hpp>
 
 #include "config.h"
 
@@ -62,8 +69,18 @@ int alphasort(const dirent** lhs, const dirent** rhs)
    return strcmp((*lhs)->d_name, (*rhs)->d_name);
 }
 
+// a directory entry as reported by scandir. type is the dirent d_type --
+// DT_UNKNOWN on filesystems which don't fill it in, in which case the
+// consumer falls back to lstat
+struct DirEntry
+{
+   DirEntry() : type(DT_UNKNOWN) {}
+   std::string name;
+   unsigned char type;
+};
+
 // wrapper for scandir api
-Error scanDir(const std::string& dirPath, std::vector<std::string>* pNames)
+Error scanDir(const std::string& dirPath, std::vector<DirEntry>* pEntries)
 {
    // read directory contents into namelist
    struct dirent **namelist;
@@ -79,36 +96,34 @@ Error scanDir(const std::string& dirPath, std::vector<std::string>* pNames)
    }
 
    // extract the namelist then free it
+   pEntries->resize(entries);
    for(int i=0; i<entries; i++)
    {
-      // get the name (then free it)
-      std::string name(namelist[i]->d_name,
-#ifdef __APPLE__
-                       namelist[i]->d_namlen);
-#else
-                       namelist[i]->d_reclen);
-#endif
+      // get the name and type (then free the entry)
+      DirEntry& entry = (*pEntries)[i];
+      entry.name.assign(namelist[i]->d_name);
+      entry.type = namelist[i]->d_type;
       ::free(namelist[i]);
-
-      // add to the vector
-      pNames->push_back(name);
    }
    ::free(namelist);
 
    return Success();
 }
 
-} // anonymous namespace
-
-Error scanFiles(const tree<FileInfo>::iterator_base& fromNode,
-                const FileScannerOptions& options,
-                tree<FileInfo>* pTree)
+// serial scanner -- the options.threads > 1 case is driven by
+// scanFilesParallel (below) which fans first-level subdirectories
+// out to workers that each run this serially over their subtree
+Error scanFilesImpl(const tree<FileInfo>::iterator_base& fromNode,
+                    const FileScannerOptions& options,
+                    tree<FileInfo>* pTree)
 {
    // clear all existing
    pTree->erase_children(fromNode);
 
-   // create FilePath for root
-   FilePath rootPath(fromNode->absolutePath());
+   // root directory path (all child paths are derived from it by direct
+   // string append below -- constructing a boost::filesystem path per
+   // entry dominated profiles of directory-heavy scans)
+   std::string rootDir = fromNode->absolutePath();
 
    // yield if requested (only applies to recursive scans)
    if (options.recursive && options.yield)
@@ -123,49 +138,82 @@ Error scanFiles(const tree<FileInfo>::iterator_base& fromNode,
    }
 
    // read directory contents
-   std::vector<std::string> names;
-   Error error = scanDir(fromNode->absolutePath(), &names);
+   std::vector<DirEntry> dirEntries;
+   Error error = scanDir(rootDir, &dirEntries);
    if (error)
       return error;
 
-   // iterate over the names
-   BOOST_FOREACH(const std::string& name, names)
+#ifdef __linux__
+   // open the directory so file attributes can be read with ::fstatat
+   // relative to it -- having the kernel re-resolve the full absolute
+   // path for every entry (as ::lstat does) is a measurable cost on
+   // deep trees and a per-component round trip on network filesystems.
+   // on failure we simply fall back to ::lstat below
+   int dirFd = ::open(rootDir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+#endif
+
+   // iterate over the entries
+   std::string path;
+   path.reserve(rootDir.length() + 64);
+   BOOST_FOREACH(const DirEntry& entry, dirEntries)
    {
       // compute the path
-      std::string path = rootPath.childPath(name).absolutePath();
-
-      // get the attributes
-      struct stat st;
-      int res = ::lstat(path.c_str(), &st);
-      if (res == -1)
-      {
-         if (errno != ENOENT && errno != EACCES)
-         {
-            Error error = systemError(errno, ERROR_LOCATION);
-            error.addProperty("path", path);
-            LOG_ERROR(error);
-         }
-         continue;
-      }
+      path.assign(rootDir);
+      if (path.empty() || path[path.length()-1] != '/')
+         path += '/';
+      path += entry.name;
 
-      // create the FileInfo
+      // create the FileInfo. for directories d_type alone determines the
+      // FileInfo we build (a symlink to a directory reports DT_LNK, not
+      // DT_DIR, so a DT_DIR entry is never a symlink) which lets us skip
+      // the lstat entirely; files need it anyway for size and mtime, and
+      // DT_UNKNOWN falls back to it as well
       FileInfo fileInfo;
-      bool isSymlink = S_ISLNK(st.st_mode);
-      if (S_ISDIR(st.st_mode))
+      if (entry.type == DT_DIR)
       {
-         fileInfo = FileInfo(path, true, isSymlink);
+         fileInfo = FileInfo(path, true, false);
       }
       else
       {
-         fileInfo = FileInfo(path,
-                             false,
-                             st.st_size,
+         // get the attributes (relative to the open directory if we
+         // have it so only the entry name needs resolving)
+         struct stat st;
+#ifdef __linux__
+         int res = (dirFd != -1)
+               ? ::fstatat(dirFd, entry.name.c_str(), &st,
+                           AT_SYMLINK_NOFOLLOW)
+               : ::lstat(path.c_str(), &st);
+#else
+         int res = ::lstat(path.c_str(), &st);
+#endif
+         if (res == -1)
+         {
+            if (errno != ENOENT && errno != EACCES)
+            {
+               Error error = systemError(errno, ERROR_LOCATION);
+               error.addProperty("path", path);
+               LOG_ERROR(error);
+            }
+            continue;
+         }
+
+         bool isSymlink = S_ISLNK(st.st_mode);
+         if (S_ISDIR(st.st_mode))
+         {
+            fileInfo = FileInfo(path, true, isSymlink);
+         }
+         else
+         {
+            fileInfo = FileInfo(path,
+                                false,
+                                st.st_size,
 #ifdef __APPLE__
-                             st.st_mtimespec.tv_sec,
+                                st.st_mtimespec.tv_sec,
 #else
-                             st.st_mtime,
+                                st.st_mtime,
 #endif
-                             isSymlink);
+                                isSymlink);
+         }
       }
 
       // apply the filter (if any)
@@ -184,7 +232,7 @@ Error scanFiles(const tree<FileInfo>::iterator_base& fromNode,
                // to cause us to abort the entire scan. yes the tree
                // will be incomplete however it will be even more incompete
                // if we fail entirely
-               Error error = scanFiles(child, options, pTree);
+               Error error = scanFilesImpl(child, options, pTree);
                if (error)
                   LOG_ERROR(error);
             }
@@ -196,10 +244,145 @@ Error scanFiles(const tree<FileInfo>::iterator_base& fromNode,
       }
    }
 
+#ifdef __linux__
+   // done with the directory (note this is held open across recursion
+   // into subdirectories, so a scan keeps one fd per level of depth)
+   if (dirFd != -1)
+      ::close(dirFd);
+#endif
+
    // return success
    return Success();
 }
 
+// a unit of parallel scan work -- a first-level subdirectory node in
+// the caller's tree along with the private tree its worker fills in
+// (merged back into the caller's tree after the workers complete)
+struct ScanJob
+{
+   tree<FileInfo>::sibling_iterator node;
+   boost::shared_ptr<tree<FileInfo> > pSubtree;
+};
+
+// worker thread function -- pulls jobs off the shared queue until it
+// is exhausted (dynamic assignment so workers which draw shallow
+// subtrees automatically pick up the remaining deep ones)
+void scanSubtrees(std::vector<ScanJob>* pJobs,
+                  std::size_t* pNextJob,
+                  boost::mutex* pJobsMutex,
+                  const FileScannerOptions& options)
+{
+   try
+   {
+      while (true)
+      {
+         // claim the next job (if any)
+         ScanJob* pJob = NULL;
+         LOCK_MUTEX(*pJobsMutex)
+         {
+            if (*pNextJob < pJobs->size())
+               pJob = &((*pJobs)[(*pNextJob)++]);
+         }
+         END_LOCK_MUTEX
+
+         // no more work
+         if (pJob == NULL)
+            return;
+
+         // scan the subtree -- failures within a subtree are logged
+         // rather than propagated (the same policy as the serial
+         // scanner applies to its recursion)
+         Error error = scanFilesImpl(pJob->pSubtree->begin(),
+                                     options,
+                                     pJob->pSubtree.get());
+         if (error)
+            LOG_ERROR(error);
+      }
+   }
+   CATCH_UNEXPECTED_EXCEPTION
+}
+
+Error scanFilesParallel(const tree<FileInfo>::iterator_base& fromNode,
+                        const FileScannerOptions& options,
+                        tree<FileInfo>* pTree)
+{
+   // subtree scans (and the root level scan) are always serial
+   FileScannerOptions serialOptions(options);
+   serialOptions.threads = 1;
+
+   // scan the root level on the calling thread
+   FileScannerOptions levelOptions(serialOptions);
+   levelOptions.recursive = false;
+   Error error = scanFilesImpl(fromNode, levelOptions, pTree);
+   if (error)
+      return error;
+
+   // build one job per first-level subdirectory
+   std::vector<ScanJob> jobs;
+   for (tree<FileInfo>::sibling_iterator it = pTree->begin(fromNode);
+        it != pTree->end(fromNode);
+        ++it)
+   {
+      if (it->isDirectory() && !it->isSymlink())
+      {
+         ScanJob job;
+         job.node = it;
+         job.pSubtree.reset(new tree<FileInfo>());
+         job.pSubtree->set_head(*it);
+         jobs.push_back(job);
+      }
+   }
+   if (jobs.empty())
+      return Success();
+
+   // fan the jobs out to a pool of workers
+   std::size_t nextJob = 0;
+   boost::mutex jobsMutex;
+   std::size_t numThreads = std::min<std::size_t>(options.threads,
+                                                  jobs.size());
+   if (numThreads > 1)
+   {
+      boost::thread_group workers;
+      for (std::size_t i = 0; i < numThreads; i++)
+      {
+         workers.create_thread(boost::bind(scanSubtrees,
+                                           &jobs,
+                                           &nextJob,
+                                           &jobsMutex,
+                                           serialOptions));
+      }
+      workers.join_all();
+   }
+   else
+   {
+      scanSubtrees(&jobs, &nextJob, &jobsMutex, serialOptions);
+   }
+
+   // merge each subtree back into the caller's tree (in place of the
+   // directory node appended by the root level scan). note the merge
+   // copies nodes rather than splicing them -- the subtrees use a
+   // different allocator instance so a copy is the safe option
+   BOOST_FOREACH(const ScanJob& job, jobs)
+   {
+      if (!job.pSubtree->empty())
+         pTree->replace(job.node, job.pSubtree->begin());
+   }
+
+   return Success();
+}
+
+} // anonymous namespace
+
+Error scanFiles(const tree<FileInfo>::iterator_base& fromNode,
+                const FileScannerOptions& options,
+                tree<FileInfo>* pTree)
+{
+   if (options.recursive && options.threads > 1)
+      return scanFilesParallel(fromNode, options, pTree);
+   else
+      return scanFilesImpl(fromNode, options, pTree);
+}
+
 } // namespace system
 } // namespace core
 } // namespace rstudio
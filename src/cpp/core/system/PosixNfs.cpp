@@ -18,6 +18,12 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/stat.h>
+
+#include <set>
+#include <string>
+
+#include <boost/foreach.hpp>
+
 #include <core/Error.hpp>
 #include <core/FilePath.hpp>
 
@@ -73,6 +79,52 @@ core::Error statWithCacheClear(const core::FilePath& path,
    return core::Success();
 }
 
+core::Error flushDirectoryCache(const core::FilePath& directory)
+{
+   int fd = ::open(directory.absolutePath().c_str(), O_RDONLY);
+   if (fd == -1)
+   {
+      Error error = systemError(errno, ERROR_LOCATION);
+      error.addProperty("path", directory.absolutePath());
+      return error;
+   }
+
+   Error error;
+   if (::fsync(fd) == -1)
+   {
+      // EINVAL just means the filesystem doesn't support syncing a
+      // directory fd (the open/close alone refreshed the cache)
+      if (errno != EINVAL)
+      {
+         error = systemError(errno, ERROR_LOCATION);
+         error.addProperty("path", directory.absolutePath());
+      }
+   }
+
+   ::close(fd);
+   return error;
+}
+
+core::Error writeBarrier(const std::vector<core::FilePath>& files)
+{
+   // group by parent directory so each directory (and thus each mount)
+   // is synchronized exactly once no matter how many files it holds
+   std::set<std::string> directories;
+   BOOST_FOREACH(const core::FilePath& filePath, files)
+   {
+      directories.insert(filePath.parent().absolutePath());
+   }
+
+   Error lastError;
+   BOOST_FOREACH(const std::string& directory, directories)
+   {
+      Error error = flushDirectoryCache(FilePath(directory));
+      if (error)
+         lastError = error;
+   }
+   return lastError;
+}
+
 } // namespace nfs
 } // namespace system
 } // namespace core
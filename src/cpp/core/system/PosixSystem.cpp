@@ -17,6 +17,7 @@
 
 #include <stdio.h>
 
+#include <fstream>
 #include <iostream>
 #include <vector>
 
@@ -61,6 +62,7 @@
 #include <core/Log.hpp>
 #include <core/FilePath.hpp>
 #include <core/FileInfo.hpp>
+#include <core/AsyncLogWriter.hpp>
 #include <core/FileLogWriter.hpp>
 #include <core/Exec.hpp>
 #include <core/SyslogLogWriter.hpp>
@@ -213,7 +215,11 @@ void initializeLog(const std::string& programIdentity,
    if (s_pLogWriter)
       delete s_pLogWriter;
 
-   s_pLogWriter = new FileLogWriter(programIdentity, logLevel, logDir);
+   // wrap the file writer so messages are written asynchronously
+   // (file writes open-append-close per message, so a slow or
+   // wedged log volume would otherwise stall the logging thread)
+   s_pLogWriter = new AsyncLogWriter(boost::shared_ptr<LogWriter>(
+            new FileLogWriter(programIdentity, logLevel, logDir)));
 }
 
 void setLogToStderr(bool logToStderr)
@@ -882,6 +888,50 @@ Error systemInformation(SysInfo* pSysInfo)
    return Success();
 }
 
+Error processMemoryUsage(MemoryUsage* pUsage)
+{
+   long long pageKb = ::sysconf(_SC_PAGESIZE) / 1024;
+
+#ifndef __APPLE__
+   // resident set size from /proc/self/statm (second field, in pages)
+   std::ifstream statmStream("/proc/self/statm");
+   if (!statmStream)
+      return systemError(errno, ERROR_LOCATION);
+   long long sizePages = 0, residentPages = 0;
+   statmStream >> sizePages >> residentPages;
+   pUsage->rssKb = residentPages * pageKb;
+#else
+   // peak resident set size (current rss isn't cheaply available here;
+   // ru_maxrss is in bytes on darwin)
+   struct rusage usage;
+   if (::getrusage(RUSAGE_SELF, &usage) == -1)
+      return systemError(errno, ERROR_LOCATION);
+   pUsage->rssKb = usage.ru_maxrss / 1024;
+#endif
+
+   // physical memory
+   long long physKb = static_cast<long long>(::sysconf(_SC_PHYS_PAGES)) *
+                      pageKb;
+   pUsage->limitKb = physKb;
+
+#ifndef __APPLE__
+   // when a cgroup memory limit is in force it is the effective ceiling
+   // (limits at or beyond physical memory -- including the "unlimited"
+   // sentinel -- aren't meaningful, so keep physical memory for those)
+   std::ifstream limitStream("/sys/fs/cgroup/memory/memory.limit_in_bytes");
+   if (limitStream)
+   {
+      long long limitBytes = 0;
+      limitStream >> limitBytes;
+      long long limitKb = limitBytes / 1024;
+      if (limitKb > 0 && limitKb < physKb)
+         pUsage->limitKb = limitKb;
+   }
+#endif
+
+   return Success();
+}
+
 namespace  {
 
 void toPids(const std::vector<std::string>& lines, std::vector<PidType>* pPids)
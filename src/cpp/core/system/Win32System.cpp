@@ -39,6 +39,7 @@
 #include <core/Log.hpp>
 #include <core/LogWriter.hpp>
 #include <core/Error.hpp>
+#include <core/AsyncLogWriter.hpp>
 #include <core/FileLogWriter.hpp>
 #include <core/StderrLogWriter.hpp>
 #include <core/FilePath.hpp>
@@ -195,7 +196,11 @@ void initializeLog(const std::string& programIdentity, int logLevel, const FileP
    if (s_pLogWriter)
       delete s_pLogWriter;
 
-   s_pLogWriter = new FileLogWriter(programIdentity, logLevel, settingsDir);
+   // wrap the file writer so messages are written asynchronously
+   // (file writes open-append-close per message, so a slow or
+   // wedged log volume would otherwise stall the logging thread)
+   s_pLogWriter = new AsyncLogWriter(boost::shared_ptr<LogWriter>(
+            new FileLogWriter(programIdentity, logLevel, settingsDir)));
 }
 
 void setLogToStderr(bool logToStderr)
@@ -109,7 +109,7 @@ Iterator findFile(Iterator begin, Iterator end, const std::string& path)
 template <typename Iterator>
 Iterator findFile(Iterator begin, Iterator end, const FileInfo& fileInfo)
 {
-   return findFile(begin, end, fileInfo.absolutePath());
+   return findFile(begin, end, fileInfo.absolutePathRef());
 }
 
 std::list<void*> activeEventContexts();
@@ -21,11 +21,14 @@
 #include <sys/types.h>
 #include <sys/inotify.h>
 
+#include <map>
 #include <set>
+#include <utility>
 
 #include <boost/utility.hpp>
 #include <boost/foreach.hpp>
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/hashed_index.hpp>
@@ -34,6 +37,9 @@
 #include <core/Log.hpp>
 #include <core/Error.hpp>
 #include <core/FileInfo.hpp>
+#include <core/SafeConvert.hpp>
+
+#include <core/system/Environment.hpp>
 
 #include <core/system/FileScanner.hpp>
 #include <core/system/System.hpp>
@@ -177,8 +183,132 @@ public:
    boost::function<bool(const FileInfo&)> filter;
    tree<FileInfo> fileTree;
    Callbacks callbacks;
+
+   // changes accumulated but not yet delivered to onFilesChanged --
+   // delivery is debounced so that event storms (e.g. R CMD INSTALL
+   // touching thousands of files) are delivered as a few large batches
+   // rather than a stream of small ones
+   std::vector<FileChangeEvent> pendingChanges;
+   boost::posix_time::ptime lastChangeTime;
 };
 
+// debounce window applied between draining the inotify descriptor and
+// firing onFilesChanged (it fires once no new events have arrived for
+// this long). configurable via RSTUDIO_FILE_MONITOR_DEBOUNCE_MS, with
+// 0 restoring fire-per-drain behavior
+boost::posix_time::time_duration debounceInterval()
+{
+   static int s_debounceMs = -1;
+   if (s_debounceMs < 0)
+   {
+      const int kDefaultDebounceMs = 100;
+      s_debounceMs = kDefaultDebounceMs;
+      std::string debounceMs = getenv("RSTUDIO_FILE_MONITOR_DEBOUNCE_MS");
+      if (!debounceMs.empty())
+      {
+         s_debounceMs = safe_convert::stringTo<int>(debounceMs,
+                                                    kDefaultDebounceMs);
+         if (s_debounceMs < 0)
+            s_debounceMs = kDefaultDebounceMs;
+      }
+   }
+   return boost::posix_time::milliseconds(s_debounceMs);
+}
+
+// a raw inotify event captured while draining the descriptor (the read
+// buffer is reused across reads so the name must be copied out)
+struct RawEvent
+{
+   RawEvent() : wd(-1), mask(0) {}
+   RawEvent(int wd, uint32_t mask, const std::string& name)
+      : wd(wd), mask(mask), name(name)
+   {
+   }
+   int wd;
+   uint32_t mask;
+   std::string name;
+};
+
+// logical change type for a raw inotify event mask (mirrors the
+// interpretation performed by processEvent)
+FileChangeEvent::Type rawEventType(uint32_t mask)
+{
+   if (mask & (IN_CREATE | IN_MOVED_TO))
+      return FileChangeEvent::FileAdded;
+   else if (mask & (IN_DELETE | IN_MOVED_FROM))
+      return FileChangeEvent::FileRemoved;
+   else if (mask & IN_MODIFY)
+      return FileChangeEvent::FileModified;
+   else
+      return FileChangeEvent::None;
+}
+
+// coalesce a newly read raw event against those already pending for the
+// same (watch, name) pair: repeated events of one type merge into one,
+// a modify following a create folds into the create (file state is
+// inspected after the drain so the create observes the final contents),
+// a delete following a create cancels both, and a delete following a
+// modify turns the modify into the delete. canceled events are left in
+// place with a mask of 0 (processing ignores them) so recorded indexes
+// remain valid
+void coalesceRawEvent(const RawEvent& event,
+                      std::vector<RawEvent>* pEvents,
+                      std::map<std::pair<int,std::string>,size_t>* pIndexes)
+{
+   FileChangeEvent::Type type = rawEventType(event.mask);
+
+   // events we don't interpret (and events on the root, which have no
+   // name) pass through uncoalesced
+   if (type == FileChangeEvent::None || event.name.empty())
+   {
+      pEvents->push_back(event);
+      return;
+   }
+
+   std::pair<int,std::string> key(event.wd, event.name);
+   std::map<std::pair<int,std::string>,size_t>::iterator it =
+                                                      pIndexes->find(key);
+   if (it == pIndexes->end())
+   {
+      pEvents->push_back(event);
+      (*pIndexes)[key] = pEvents->size() - 1;
+      return;
+   }
+
+   RawEvent& pending = (*pEvents)[it->second];
+   FileChangeEvent::Type pendingType = rawEventType(pending.mask);
+
+   if (pendingType == type)
+   {
+      // duplicate -- merge (drop the new event)
+   }
+   else if (pendingType == FileChangeEvent::FileAdded &&
+            type == FileChangeEvent::FileModified)
+   {
+      // create followed by modify -- the create suffices
+   }
+   else if (pendingType == FileChangeEvent::FileAdded &&
+            type == FileChangeEvent::FileRemoved)
+   {
+      // create followed by delete -- cancel both
+      pending.mask = 0;
+      pIndexes->erase(it);
+   }
+   else if (pendingType == FileChangeEvent::FileModified &&
+            type == FileChangeEvent::FileRemoved)
+   {
+      // modify followed by delete -- the delete supersedes in place
+      pending.mask = event.mask;
+   }
+   else
+   {
+      // any other sequence (e.g. delete followed by re-create) must
+      // preserve both events in order
+      pEvents->push_back(event);
+      it->second = pEvents->size() - 1;
+   }
+}
+
 void terminateWithMonitoringError(FileEventContext* pContext,
                                   const Error& error)
 {
@@ -287,28 +417,18 @@ void closeContext(FileEventContext* pContext)
 }
 
 Error processEvent(FileEventContext* pContext,
-                   struct inotify_event* pEvent,
+                   const RawEvent& rawEvent,
                    std::vector<FileChangeEvent>* pFileChanges)
 {
    // determine event type
-   FileChangeEvent::Type eventType = FileChangeEvent::None;
-   if (pEvent->mask & IN_CREATE)
-      eventType = FileChangeEvent::FileAdded;
-   else if (pEvent->mask & IN_DELETE)
-      eventType = FileChangeEvent::FileRemoved;
-   else if (pEvent->mask & IN_MODIFY)
-      eventType = FileChangeEvent::FileModified;
-   else if (pEvent->mask & IN_MOVED_TO)
-      eventType = FileChangeEvent::FileAdded;
-   else if (pEvent->mask & IN_MOVED_FROM)
-      eventType = FileChangeEvent::FileRemoved;
+   FileChangeEvent::Type eventType = rawEventType(rawEvent.mask);
 
    // return event if we got a valid event type and the event applies to a
-   // child of the monitored directory (len == 0 occurs for root element)
-   if ((eventType != FileChangeEvent::None) && (pEvent->len > 0))
+   // child of the monitored directory (empty name occurs for root element)
+   if ((eventType != FileChangeEvent::None) && !rawEvent.name.empty())
    {
       // find the FileInfo for this wd (ignore if we can't find one)
-      Watch watch = pContext->watches.find(pEvent->wd);
+      Watch watch = pContext->watches.find(rawEvent.wd);
       if (watch.empty())
          return Success();
 
@@ -325,7 +445,7 @@ Error processEvent(FileEventContext* pContext,
 
       // get file info
       FilePath filePath = FilePath(parentIt->absolutePath()).complete(
-                                                                 pEvent->name);
+                                                               rawEvent.name);
 
 
       // if the file exists then collect as many extended attributes
@@ -337,7 +457,8 @@ Error processEvent(FileEventContext* pContext,
       }
       else
       {
-         fileInfo = FileInfo(filePath.absolutePath(), pEvent->mask & IN_ISDIR);
+         fileInfo = FileInfo(filePath.absolutePath(),
+                             rawEvent.mask & IN_ISDIR);
       }
 
       // if this doesn't meet the filter then ignore
@@ -555,8 +676,13 @@ void run(const boost::function<void()>& checkForInput)
             continue;
          }
 
-         // loop reading from this context's fd until EAGAIN or EWOULDBLOCK
-         std::vector<FileChangeEvent> fileChanges;
+         // drain all raw events from this context's fd (until EAGAIN or
+         // EWOULDBLOCK), coalescing per-path as we go -- file state is
+         // inspected only once per surviving event, after the drain
+         std::vector<RawEvent> rawEvents;
+         std::map<std::pair<int,std::string>,size_t> rawEventIndexes;
+         bool overflowed = false;
+         bool terminated = false;
          while (true)
          {
             // read
@@ -574,6 +700,7 @@ void run(const boost::function<void()>& checkForInput)
                // out of the read loop for this context)
                terminateWithMonitoringError(pContext,
                                             systemError(errno, ERROR_LOCATION));
+               terminated = true;
                break;
             }
 
@@ -589,6 +716,19 @@ void run(const boost::function<void()>& checkForInput)
                // we start over because we missed events
                if (pEvent->mask & IN_Q_OVERFLOW)
                {
+                  // flush changes which predate the overflow (the tree
+                  // already reflects them so the rescan won't re-emit
+                  // them) and discard raw events from this drain (the
+                  // rescan covers those)
+                  if (!pContext->pendingChanges.empty())
+                  {
+                     std::vector<FileChangeEvent> changes;
+                     changes.swap(pContext->pendingChanges);
+                     pContext->callbacks.onFilesChanged(changes);
+                  }
+                  rawEvents.clear();
+                  rawEventIndexes.clear();
+
                   // remove all watches
                   removeAllWatches(pContext);
 
@@ -601,30 +741,72 @@ void run(const boost::function<void()>& checkForInput)
                         &pContext->fileTree,
                         pContext->callbacks.onFilesChanged);
                   if (error)
+                  {
                      terminateWithMonitoringError(pContext, error);
+                     terminated = true;
+                  }
 
                   // always break here -- we've generated events based on
                   // a fresh scan so any other events in the queue would
                   // be duplicates
+                  overflowed = true;
                   break;
                }
 
-               // process the event
-               Error error = processEvent(pContext, pEvent, &fileChanges);
-               if (error)
-               {
-                  terminateWithMonitoringError(pContext, error);
-                  break;
-               }
+               // capture and coalesce the raw event
+               RawEvent rawEvent(pEvent->wd,
+                                 pEvent->mask,
+                                 (pEvent->len > 0) ? std::string(pEvent->name)
+                                                   : std::string());
+               coalesceRawEvent(rawEvent, &rawEvents, &rawEventIndexes);
 
                // advance to next event
                i += kEventSize + pEvent->len;
             }
+
+            if (overflowed || terminated)
+               break;
+         }
+
+         // the context was unregistered (and deleted) on termination
+         if (terminated)
+            continue;
+
+         // process the coalesced events
+         std::vector<FileChangeEvent> fileChanges;
+         BOOST_FOREACH(const RawEvent& rawEvent, rawEvents)
+         {
+            Error error = processEvent(pContext, rawEvent, &fileChanges);
+            if (error)
+            {
+               terminateWithMonitoringError(pContext, error);
+               terminated = true;
+               break;
+            }
          }
+         if (terminated)
+            continue;
 
-         // fire any events we got
+         // accumulate the changes, then deliver them once no new events
+         // have arrived for the debounce window (checkForInput below
+         // waits up to 250ms so delivery occurs on a subsequent pass)
+         using namespace boost::posix_time;
          if (!fileChanges.empty())
-            pContext->callbacks.onFilesChanged(fileChanges);
+         {
+            std::copy(fileChanges.begin(),
+                      fileChanges.end(),
+                      std::back_inserter(pContext->pendingChanges));
+            pContext->lastChangeTime = microsec_clock::universal_time();
+         }
+
+         if (!pContext->pendingChanges.empty() &&
+             (microsec_clock::universal_time() - pContext->lastChangeTime) >=
+                                                         debounceInterval())
+         {
+            std::vector<FileChangeEvent> changes;
+            changes.swap(pContext->pendingChanges);
+            pContext->callbacks.onFilesChanged(changes);
+         }
       }
 
       // check for input (register/unregister of monitors)
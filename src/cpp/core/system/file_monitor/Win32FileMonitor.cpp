@@ -37,8 +37,31 @@ namespace file_monitor {
 
 namespace {
 
-// buffer size for notifications (cannot be > 64kb for network drives)
+// buffer size for notifications (cannot be > 64kb for network drives).
+// for local volumes we use a much larger buffer -- heavy churn (e.g.
+// R CMD check writing and deleting temp trees) can easily produce more
+// notifications between reads than 32kb holds, and every overflow forces
+// a rescan
 const std::size_t kBuffSize = 32768;
+const std::size_t kLocalBuffSize = 512 * 1024;
+
+bool isNetworkVolume(const FilePath& filePath)
+{
+   std::wstring path = filePath.absolutePathW();
+
+   // unc paths are network paths
+   if (path.length() >= 2 && path[0] == L'\\' && path[1] == L'\\')
+      return true;
+
+   // check the drive type for drive-letter paths
+   if (path.length() >= 3 && path[1] == L':')
+   {
+      std::wstring root = path.substr(0, 3);
+      return ::GetDriveTypeW(root.c_str()) == DRIVE_REMOTE;
+   }
+
+   return false;
+}
 
 class FileEventContext : boost::noncopyable
 {
@@ -307,6 +330,65 @@ bool isRecoverableByRestart(const Error& error)
 Error readDirectoryChanges(FileEventContext* pContext);
 void enqueRestartMonitoring(FileEventContext* pContext);
 
+// targeted recovery after a notification buffer overflow. creating,
+// deleting, or renaming an entry updates the last-write time of its
+// parent directory, so directories whose recorded time still matches
+// the disk can keep their subtree snapshots; only subtrees rooted at a
+// changed directory are re-scanned. note that content-only
+// modifications don't touch the parent directory time, so a file
+// modified (but not created or removed) during the overflow window in
+// an otherwise untouched directory can be missed -- that's the tradeoff
+// for not walking the entire tree, and the large notification buffer
+// makes the overflow window itself rare
+Error rescanChangedDirectories(FileEventContext* pContext)
+{
+   // collect the roots needing a rescan (we can't mutate the tree while
+   // iterating it). iteration is in pre-order so ancestors are visited
+   // first -- directories inside an already-collected root are skipped
+   // since the recursive rescan of the root covers them
+   std::vector<FileInfo> rescanRoots;
+   tree<FileInfo>::iterator it = pContext->fileTree.begin();
+   for ( ; it != pContext->fileTree.end(); ++it)
+   {
+      if (!it->isDirectory())
+         continue;
+
+      FilePath dirPath(it->absolutePath());
+
+      bool covered = false;
+      for (std::size_t i = 0; i < rescanRoots.size(); i++)
+      {
+         if (dirPath.isWithin(FilePath(rescanRoots[i].absolutePath())))
+         {
+            covered = true;
+            break;
+         }
+      }
+      if (covered)
+         continue;
+
+      FileInfo currentInfo(dirPath);
+      if (currentInfo.lastWriteTime() != it->lastWriteTime())
+         rescanRoots.push_back(*it);
+   }
+
+   // rescan each changed subtree (added/removed entries, including whole
+   // new directory trees, are discovered and reported from here)
+   for (std::size_t i = 0; i < rescanRoots.size(); i++)
+   {
+      Error error = impl::discoverAndProcessFileChanges(
+                                       rescanRoots[i],
+                                       pContext->recursive,
+                                       pContext->filter,
+                                       &(pContext->fileTree),
+                                       pContext->callbacks.onFilesChanged);
+      if (error)
+         return error;
+   }
+
+   return Success();
+}
+
 void restartMonitoring(FileEventContext* pContext)
 {
    // start monitoring again (always do this before the scan so we don't
@@ -434,13 +516,25 @@ VOID CALLBACK FileChangeCompletionRoutine(DWORD dwErrorCode,									// completi
       return;
    }
 
-   // check for buffer overflow. this means there are too many file changes
-   // for the systme to keep up with -- in this case try to restart monitoring
-   // (after a 1 second delay) and repeat the restart up to 10 times
+   // check for buffer overflow. this means there were too many file changes
+   // for the notification buffer to hold -- restart the read immediately
+   // (so we don't miss events which occur while recovering) and then do a
+   // targeted rescan of just the directories which changed
    if(dwNumberOfBytesTransfered == 0)
    {
-      // attempt to restart monitoring
-      enqueRestartMonitoring(pContext);
+      Error error = readDirectoryChanges(pContext);
+      if (error)
+      {
+         // fall back to the delayed restart path (which performs a full
+         // rescan once the read is successfully re-established)
+         enqueRestartMonitoring(pContext);
+         return;
+      }
+
+      error = rescanChangedDirectories(pContext);
+      if (error)
+         terminateWithMonitoringError(pContext, error);
+
       return;
    }
 
@@ -510,6 +604,14 @@ Handle registerMonitor(const core::FilePath& filePath,
    pContext->rootPath = FilePath(wpath);
    pContext->recursive = recursive;
 
+   // use the large notification buffer for local volumes (network volumes
+   // reject reads larger than 64kb so they keep the small default)
+   if (!isNetworkVolume(pContext->rootPath))
+   {
+      pContext->receiveBuffer.resize(kLocalBuffSize);
+      pContext->handlingBuffer.resize(kLocalBuffSize);
+   }
+
    // open the directory
    pContext->hDirectory = ::CreateFileW(
                      filePath.absolutePathW().c_str(),
@@ -0,0 +1,157 @@
+/*
+ * MultiPatternScanner.cpp
+ *
+ * Copyright (C) 2009-12 by RStudio, Inc.
+ *
+ * Unless you have received this program directly from RStudio pursuant
+ * to the terms of a commercial license agreement with RStudio, then
+ * this program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http://www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ *
+ */
+
+#include <core/text/MultiPatternScanner.hpp>
+
+#include <queue>
+
+namespace rstudio {
+namespace core {
+namespace text {
+
+MultiPatternScanner::MultiPatternScanner(
+                              const std::vector<std::string>& patterns)
+{
+   // build the trie
+   nodes_.push_back(Node());
+   for (std::size_t i = 0; i < patterns.size(); i++)
+   {
+      const std::string& pattern = patterns[i];
+      if (pattern.empty())
+         continue;
+
+      int state = 0;
+      for (std::string::const_iterator ch = pattern.begin();
+           ch != pattern.end();
+           ++ch)
+      {
+         std::map<char,int>::const_iterator it =
+                                    nodes_[state].transitions.find(*ch);
+         if (it != nodes_[state].transitions.end())
+         {
+            state = it->second;
+         }
+         else
+         {
+            nodes_.push_back(Node());
+            int next = nodes_.size() - 1;
+            nodes_[state].transitions[*ch] = next;
+            state = next;
+         }
+      }
+      nodes_[state].matches.push_back(i);
+   }
+
+   // compute failure links breadth-first and fold each node's failure
+   // target matches into the node (so a match is reported from the node
+   // itself without walking the failure chain during scans)
+   std::queue<int> queue;
+   for (std::map<char,int>::const_iterator it =
+           nodes_[0].transitions.begin();
+        it != nodes_[0].transitions.end();
+        ++it)
+   {
+      nodes_[it->second].fail = 0;
+      queue.push(it->second);
+   }
+
+   while (!queue.empty())
+   {
+      int current = queue.front();
+      queue.pop();
+
+      for (std::map<char,int>::const_iterator it =
+              nodes_[current].transitions.begin();
+           it != nodes_[current].transitions.end();
+           ++it)
+      {
+         char ch = it->first;
+         int child = it->second;
+
+         int fail = nodes_[current].fail;
+         while (fail != 0 &&
+                nodes_[fail].transitions.find(ch) ==
+                                          nodes_[fail].transitions.end())
+         {
+            fail = nodes_[fail].fail;
+         }
+
+         std::map<char,int>::const_iterator failIt =
+                                       nodes_[fail].transitions.find(ch);
+         if (failIt != nodes_[fail].transitions.end() &&
+             failIt->second != child)
+         {
+            nodes_[child].fail = failIt->second;
+         }
+         else
+         {
+            nodes_[child].fail = 0;
+         }
+
+         const std::vector<std::size_t>& failMatches =
+                                          nodes_[nodes_[child].fail].matches;
+         nodes_[child].matches.insert(nodes_[child].matches.end(),
+                                      failMatches.begin(),
+                                      failMatches.end());
+
+         queue.push(child);
+      }
+   }
+}
+
+int MultiPatternScanner::step(int state, char ch) const
+{
+   for (;;)
+   {
+      std::map<char,int>::const_iterator it =
+                                    nodes_[state].transitions.find(ch);
+      if (it != nodes_[state].transitions.end())
+         return it->second;
+      if (state == 0)
+         return 0;
+      state = nodes_[state].fail;
+   }
+}
+
+bool MultiPatternScanner::containsAny(const std::string& text) const
+{
+   int state = 0;
+   for (std::string::const_iterator ch = text.begin();
+        ch != text.end();
+        ++ch)
+   {
+      state = step(state, *ch);
+      if (!nodes_[state].matches.empty())
+         return true;
+   }
+   return false;
+}
+
+void MultiPatternScanner::Scan::feed(const std::string& chunk)
+{
+   for (std::string::const_iterator ch = chunk.begin();
+        ch != chunk.end();
+        ++ch)
+   {
+      state_ = pScanner_->step(state_, *ch);
+      const std::vector<std::size_t>& matches =
+                                       pScanner_->nodes_[state_].matches;
+      matches_.insert(matches.begin(), matches.end());
+   }
+}
+
+} // namespace text
+} // namespace core
+} // namespace rstudio
@@ -0,0 +1,353 @@
+/*
+ * EventStreamWriter.cpp
+ *
+ * Copyright (C) 2009-12 by RStudio, Inc.
+ *
+ * Unless you have received this program directly from RStudio pursuant
+ * to the terms of a commercial license agreement with RStudio, then
+ * this program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http://www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ *
+ */
+
+#include <monitor/events/EventStreamWriter.hpp>
+
+#include <string.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+
+#include <core/Error.hpp>
+#include <core/Log.hpp>
+#include <core/Thread.hpp>
+#include <core/SafeConvert.hpp>
+
+using namespace rstudio::core;
+
+namespace rstudio {
+namespace monitor {
+
+namespace {
+
+// current record format version (see framing notes in the header)
+const unsigned char kRecordVersion = 1;
+
+// flush whenever this much serialized event data is pending (a flush is
+// also performed every kFlushIntervalMs regardless)
+const std::size_t kFlushThresholdBytes = 64 * 1024;
+
+// maximum buffered event data -- events beyond this are dropped and
+// accounted for in a warning logged by the next flush
+const std::size_t kMaxBufferBytes = 1024 * 1024;
+
+// maximum time a buffered event waits before it is written
+const long kFlushIntervalMs = 1000;
+
+// segment file names (events.NNNNNN.gz)
+const char * const kSegmentPrefix = "events.";
+const char * const kSegmentSuffix = ".gz";
+
+std::string segmentName(std::size_t ordinal)
+{
+   return boost::str(boost::format("%1%%2$06d%3%") % kSegmentPrefix
+                                                   % ordinal
+                                                   % kSegmentSuffix);
+}
+
+// parse the ordinal out of a segment file name (returns 0, an invalid
+// ordinal, for files which aren't stream segments)
+std::size_t segmentOrdinal(const FilePath& filePath)
+{
+   std::string name = filePath.filename();
+   if (!boost::algorithm::starts_with(name, kSegmentPrefix) ||
+       !boost::algorithm::ends_with(name, kSegmentSuffix))
+   {
+      return 0;
+   }
+
+   std::string ordinal = name.substr(
+            ::strlen(kSegmentPrefix),
+            name.length() - ::strlen(kSegmentPrefix)
+                          - ::strlen(kSegmentSuffix));
+   return safe_convert::stringTo<std::size_t>(ordinal, 0);
+}
+
+// little-endian serialization helpers
+void appendUInt32(std::string* pBuffer, boost::uint32_t value)
+{
+   for (int i = 0; i < 4; i++)
+      pBuffer->push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+}
+
+void appendInt64(std::string* pBuffer, boost::int64_t value)
+{
+   for (int i = 0; i < 8; i++)
+      pBuffer->push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+}
+
+boost::int64_t millisecondsSinceEpoch(const boost::posix_time::ptime& time)
+{
+   using namespace boost::posix_time;
+   ptime epoch(boost::gregorian::date(1970,1,1));
+   return (time - epoch).total_milliseconds();
+}
+
+// append a framed record for the event (see the header for the format)
+void appendEventRecord(const Event& event, std::string* pBuffer)
+{
+   std::string record;
+   record.reserve(32 + event.username().length() + event.data().length());
+
+   record.push_back(static_cast<char>(kRecordVersion));
+   record.push_back(static_cast<char>(event.scope()));
+   appendUInt32(&record, static_cast<boost::uint32_t>(event.id()));
+   appendInt64(&record, millisecondsSinceEpoch(event.timestamp()));
+   appendUInt32(&record, static_cast<boost::uint32_t>(event.pid()));
+   appendUInt32(&record,
+                static_cast<boost::uint32_t>(event.username().length()));
+   record.append(event.username());
+   appendUInt32(&record, static_cast<boost::uint32_t>(event.data().length()));
+   record.append(event.data());
+
+   appendUInt32(pBuffer, static_cast<boost::uint32_t>(record.length()));
+   pBuffer->append(record);
+}
+
+} // anonymous namespace
+
+EventStreamWriter::EventStreamWriter(const FilePath& streamDir,
+                                     boost::uintmax_t maxSegmentBytes,
+                                     std::size_t maxSegments)
+   : streamDir_(streamDir),
+     maxSegmentBytes_(maxSegmentBytes),
+     maxSegments_(maxSegments),
+     segmentOrdinal_(1),
+     segmentBytes_(0),
+     droppedEvents_(0),
+     stopRequested_(false),
+     started_(false)
+{
+}
+
+EventStreamWriter::~EventStreamWriter()
+{
+   try
+   {
+      stop();
+   }
+   catch(...)
+   {
+   }
+}
+
+Error EventStreamWriter::start()
+{
+   // ensure the stream directory exists
+   Error error = streamDir_.ensureDirectory();
+   if (error)
+      return error;
+
+   // continue appending to the highest segment already present (so a
+   // restart doesn't orphan a partially filled segment)
+   std::vector<FilePath> children;
+   error = streamDir_.children(&children);
+   if (error)
+      return error;
+   BOOST_FOREACH(const FilePath& child, children)
+   {
+      std::size_t ordinal = segmentOrdinal(child);
+      if (ordinal >= segmentOrdinal_)
+      {
+         segmentOrdinal_ = ordinal;
+         segmentBytes_ = child.size();
+      }
+   }
+
+   // launch the flush thread
+   core::thread::safeLaunchThread(
+            boost::bind(&EventStreamWriter::flushThreadMain, this),
+            &flushThread_);
+   started_ = true;
+
+   return Success();
+}
+
+void EventStreamWriter::stop()
+{
+   if (!started_)
+      return;
+   started_ = false;
+
+   LOCK_MUTEX(mutex_)
+   {
+      stopRequested_ = true;
+   }
+   END_LOCK_MUTEX
+   condition_.notify_all();
+
+   if (flushThread_.joinable())
+      flushThread_.join();
+}
+
+void EventStreamWriter::writeEvent(const Event& event)
+{
+   // serialize outside the lock
+   std::string record;
+   appendEventRecord(event, &record);
+
+   bool flushNow = false;
+   LOCK_MUTEX(mutex_)
+   {
+      if (buffer_.length() < kMaxBufferBytes)
+         buffer_.append(record);
+      else
+         droppedEvents_++;
+
+      flushNow = buffer_.length() >= kFlushThresholdBytes;
+   }
+   END_LOCK_MUTEX
+
+   if (flushNow)
+      condition_.notify_one();
+}
+
+void EventStreamWriter::flushThreadMain()
+{
+   try
+   {
+      while (true)
+      {
+         // wait for a batch (or for the flush interval to elapse) then
+         // take ownership of the pending event data
+         std::string buffer;
+         unsigned int dropped = 0;
+         bool stop = false;
+         {
+            boost::unique_lock<boost::mutex> lock(mutex_);
+            while (buffer_.empty() && !stopRequested_)
+            {
+               condition_.timed_wait(
+                  lock,
+                  boost::posix_time::milliseconds(kFlushIntervalMs));
+            }
+
+            buffer.swap(buffer_);
+            std::swap(dropped, droppedEvents_);
+            stop = stopRequested_;
+         }
+
+         // compress and append the batch (outside the lock so event
+         // producers never block on compression or disk i/o)
+         if (!buffer.empty())
+            flushBuffer(buffer);
+
+         if (dropped > 0)
+         {
+            LOG_WARNING_MESSAGE(
+               "dropped " + boost::lexical_cast<std::string>(dropped) +
+               " monitor event(s) (event stream buffer full)");
+         }
+
+         if (stop)
+            return;
+      }
+   }
+   catch(const std::exception& e)
+   {
+      LOG_ERROR_MESSAGE(std::string("event stream writer terminated: ") +
+                        e.what());
+   }
+   catch(...)
+   {
+      LOG_ERROR_MESSAGE("event stream writer terminated: unknown error");
+   }
+}
+
+void EventStreamWriter::flushBuffer(const std::string& buffer)
+{
+   rotateSegmentIfNecessary();
+
+   // compress the batch into a single complete gzip member (members
+   // concatenate into a valid gzip stream, and a member either makes it
+   // to disk in full or is discarded by the reader, so a crash can never
+   // corrupt previously written batches)
+   std::ostringstream compressedStream;
+   boost::iostreams::filtering_ostream filteringStream;
+   filteringStream.push(boost::iostreams::gzip_compressor());
+   filteringStream.push(compressedStream);
+   filteringStream.write(buffer.data(), buffer.length());
+   filteringStream.reset(); // flush the compressor
+   std::string compressed = compressedStream.str();
+
+   // append to the active segment
+   FilePath segmentPath = streamDir_.complete(segmentName(segmentOrdinal_));
+   std::ofstream segmentStream(segmentPath.absolutePath().c_str(),
+                               std::ios::out | std::ios::binary |
+                               std::ios::app);
+   if (!segmentStream)
+   {
+      LOG_ERROR_MESSAGE("unable to open event stream segment: " +
+                        segmentPath.absolutePath());
+      return;
+   }
+   segmentStream.write(compressed.data(), compressed.length());
+   segmentStream.flush();
+   if (segmentStream.fail())
+   {
+      LOG_ERROR_MESSAGE("error writing event stream segment: " +
+                        segmentPath.absolutePath());
+      return;
+   }
+
+   segmentBytes_ += compressed.length();
+}
+
+void EventStreamWriter::openActiveSegment()
+{
+   segmentOrdinal_++;
+   segmentBytes_ = 0;
+}
+
+void EventStreamWriter::rotateSegmentIfNecessary()
+{
+   if (segmentBytes_ < maxSegmentBytes_)
+      return;
+
+   // move to the next segment
+   openActiveSegment();
+
+   // remove segments older than the retention window
+   std::vector<FilePath> children;
+   Error error = streamDir_.children(&children);
+   if (error)
+   {
+      LOG_ERROR(error);
+      return;
+   }
+   BOOST_FOREACH(const FilePath& child, children)
+   {
+      std::size_t ordinal = segmentOrdinal(child);
+      if (ordinal > 0 && (ordinal + maxSegments_) <= segmentOrdinal_)
+      {
+         error = child.remove();
+         if (error)
+            LOG_ERROR(error);
+      }
+   }
+}
+
+} // namespace monitor
+} // namespace rstudio
@@ -0,0 +1,117 @@
+/*
+ * EventStreamWriter.hpp
+ *
+ * Copyright (C) 2009-12 by RStudio, Inc.
+ *
+ * Unless you have received this program directly from RStudio pursuant
+ * to the terms of a commercial license agreement with RStudio, then
+ * this program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http://www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ *
+ */
+
+#ifndef MONITOR_EVENTS_EVENT_STREAM_WRITER_HPP
+#define MONITOR_EVENTS_EVENT_STREAM_WRITER_HPP
+
+#include <string>
+
+#include <boost/utility.hpp>
+#include <boost/cstdint.hpp>
+
+#include <core/FilePath.hpp>
+#include <core/BoostThread.hpp>
+
+#include <monitor/events/Event.hpp>
+
+namespace rstudio {
+namespace core {
+   class Error;
+}
+}
+
+namespace rstudio {
+namespace monitor {
+
+// appends events to an on-disk stream suitable for high-volume ingestion
+// (e.g. session activity events fed to a capacity planning pipeline).
+// writeEvent only serializes the event and appends it to an in-memory
+// buffer under a brief lock; a background thread periodically swaps the
+// buffer out, gzip-compresses the batch, and appends it to the current
+// segment file, so callers never wait on compression or disk i/o
+//
+// stream layout: the stream directory contains segment files named
+// events.NNNNNN.gz (NNNNNN is a zero-padded ordinal; writing continues
+// with the highest ordinal present and rotates to a new segment once the
+// current one exceeds maxSegmentBytes, removing the oldest segments
+// beyond maxSegments). each flush appends one complete gzip member, so
+// segments remain valid gzip files after a crash -- at worst the final
+// (partially written) member is discarded by the reader
+//
+// record framing: the decompressed contents of a segment are a sequence
+// of length-prefixed records; all integers are little-endian:
+//
+//   uint32   length of the remainder of the record (bytes)
+//   uint8    format version (currently 1)
+//   uint8    event scope
+//   int32    event id
+//   int64    timestamp (milliseconds since the unix epoch)
+//   int32    pid
+//   uint32   username length, followed by that many bytes (utf-8)
+//   uint32   data length, followed by that many bytes (utf-8)
+//
+class EventStreamWriter : boost::noncopyable
+{
+public:
+   EventStreamWriter(const core::FilePath& streamDir,
+                     boost::uintmax_t maxSegmentBytes = 4 * 1024 * 1024,
+                     std::size_t maxSegments = 10);
+   virtual ~EventStreamWriter();
+
+   // create the stream directory, locate the active segment, and launch
+   // the background flush thread
+   core::Error start();
+
+   // flush any buffered events and stop the background thread (also
+   // called by the destructor)
+   void stop();
+
+   // append an event to the stream (threadsafe; returns immediately).
+   // events are silently dropped (and the drop count logged by the next
+   // flush) if the writer falls persistently behind
+   void writeEvent(const Event& event);
+
+private:
+   void flushThreadMain();
+   void flushBuffer(const std::string& buffer);
+   void openActiveSegment();
+   void rotateSegmentIfNecessary();
+
+private:
+   // stream configuration
+   core::FilePath streamDir_;
+   boost::uintmax_t maxSegmentBytes_;
+   std::size_t maxSegments_;
+
+   // current segment
+   std::size_t segmentOrdinal_;
+   boost::uintmax_t segmentBytes_;
+
+   // event buffer (guarded by mutex_)
+   boost::mutex mutex_;
+   boost::condition_variable condition_;
+   std::string buffer_;
+   unsigned int droppedEvents_;
+   bool stopRequested_;
+
+   // background flush thread
+   bool started_;
+   boost::thread flushThread_;
+};
+
+} // namespace monitor
+} // namespace rstudio
+
+#endif // MONITOR_EVENTS_EVENT_STREAM_WRITER_HPP
@@ -0,0 +1,96 @@
+/*
+ * MetricsSegment.hpp
+ *
+ * Copyright (C) 2009-12 by RStudio, Inc.
+ *
+ * Unless you have received this program directly from RStudio pursuant
+ * to the terms of a commercial license agreement with RStudio, then
+ * this program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http://www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ *
+ */
+
+#ifndef MONITOR_METRICS_METRICS_SEGMENT_HPP
+#define MONITOR_METRICS_METRICS_SEGMENT_HPP
+
+#include <string>
+#include <vector>
+
+#include <boost/utility.hpp>
+#include <boost/cstdint.hpp>
+
+#include <core/FilePath.hpp>
+
+#include <monitor/metrics/Metric.hpp>
+
+namespace rstudio {
+namespace core {
+   class Error;
+}
+}
+
+namespace rstudio {
+namespace monitor {
+namespace metrics {
+
+// a per-host shared memory segment through which sessions publish
+// frequently sampled metrics (event loop lag, rpc latency, memory) and
+// from which a single rserver-side scraper aggregates them, avoiding a
+// round of ipc per metric point. the segment is a fixed-size file mapped
+// MAP_SHARED by every participant:
+//
+//   header:  magic, format version, slot count, entries per slot
+//   slots:   sequence counter, owner pid, owner identity, and a fixed
+//            array of (name, value, count) entries
+//
+// each session owns exactly one slot (acquired by atomically claiming a
+// slot whose owner pid is 0 or no longer running) and is the only writer
+// to it. slot consistency uses a sequence lock: the writer increments
+// the sequence counter before and after updating entries (odd == update
+// in progress) and the scraper retries a slot whose counter was odd or
+// changed during the read. publishing a metric is therefore two counter
+// increments and a handful of stores -- no locks, no syscalls
+//
+// entries accumulate (value is a running sum, count the number of
+// samples) so a 1-second scrape can derive rates and means without any
+// coordination with sessions; the scraper does not reset entries
+//
+// only implemented for posix; on windows open() returns an error
+class MetricsSegment : boost::noncopyable
+{
+public:
+   MetricsSegment();
+   virtual ~MetricsSegment();
+
+   // map the segment (creating and initializing the file if necessary --
+   // it should live on a memory backed filesystem, e.g. /dev/shm)
+   core::Error open(const core::FilePath& segmentPath);
+
+   bool isOpen() const;
+
+   // claim a slot for this process (publisher side)
+   core::Error acquireSlot(const std::string& identity);
+
+   // accumulate a sample into the named entry of this process' slot
+   // (creating the entry if needed; samples beyond the slot's fixed
+   // entry capacity are silently dropped)
+   void publishMetric(const std::string& name, double value);
+
+   // read all slots owned by live processes (scraper side), appending
+   // one Metric per entry with the owner identity as its scope; slots
+   // owned by exited processes are released
+   core::Error collectMetrics(std::vector<Metric>* pMetrics);
+
+private:
+   struct Impl;
+   Impl* pImpl_;
+};
+
+} // namespace metrics
+} // namespace monitor
+} // namespace rstudio
+
+#endif // MONITOR_METRICS_METRICS_SEGMENT_HPP
@@ -0,0 +1,391 @@
+/*
+ * MetricsSegment.cpp
+ *
+ * Copyright (C) 2009-12 by RStudio, Inc.
+ *
+ * Unless you have received this program directly from RStudio pursuant
+ * to the terms of a commercial license agreement with RStudio, then
+ * this program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http://www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ *
+ */
+
+#include <monitor/metrics/MetricsSegment.hpp>
+
+#include <string.h>
+
+#include <core/Error.hpp>
+#include <core/Log.hpp>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace rstudio::core;
+
+namespace rstudio {
+namespace monitor {
+namespace metrics {
+
+namespace {
+
+const boost::uint32_t kSegmentMagic = 0x52534D53;   // "RSMS"
+const boost::uint32_t kSegmentVersion = 1;
+const boost::uint32_t kSlotCount = 512;
+const boost::uint32_t kEntriesPerSlot = 16;
+
+const std::size_t kEntryNameLength = 24;
+const std::size_t kIdentityLength = 32;
+
+// number of times the scraper re-reads a slot which mutated under it
+// before giving up (the writer's critical section is a few stores, so
+// one retry nearly always suffices)
+const int kMaxReadAttempts = 10;
+
+#ifdef __GNUC__
+
+inline void memoryBarrier()
+{
+   __sync_synchronize();
+}
+
+inline bool compareAndSwap(volatile boost::uint32_t* pValue,
+                           boost::uint32_t oldValue,
+                           boost::uint32_t newValue)
+{
+   return __sync_bool_compare_and_swap(pValue, oldValue, newValue);
+}
+
+#else
+
+// non-gcc fallback (single-threaded semantics only)
+inline void memoryBarrier()
+{
+}
+
+inline bool compareAndSwap(volatile boost::uint32_t* pValue,
+                           boost::uint32_t oldValue,
+                           boost::uint32_t newValue)
+{
+   if (*pValue != oldValue)
+      return false;
+   *pValue = newValue;
+   return true;
+}
+
+#endif
+
+// on-segment structures (see layout notes in the header)
+struct Entry
+{
+   char name[kEntryNameLength];
+   double value;
+   boost::uint64_t count;
+};
+
+struct Slot
+{
+   volatile boost::uint32_t sequence;
+   volatile boost::uint32_t pid;
+   char identity[kIdentityLength];
+   Entry entries[kEntriesPerSlot];
+};
+
+struct Header
+{
+   boost::uint32_t magic;
+   boost::uint32_t version;
+   boost::uint32_t slotCount;
+   boost::uint32_t entriesPerSlot;
+};
+
+inline std::size_t segmentSize()
+{
+   return sizeof(Header) + kSlotCount * sizeof(Slot);
+}
+
+} // anonymous namespace
+
+struct MetricsSegment::Impl
+{
+   Impl()
+      : fd(-1),
+        pHeader(NULL),
+        pSlots(NULL),
+        pOwnSlot(NULL)
+   {
+   }
+
+   int fd;
+   Header* pHeader;
+   Slot* pSlots;
+   Slot* pOwnSlot;
+};
+
+MetricsSegment::MetricsSegment()
+   : pImpl_(new Impl())
+{
+}
+
+MetricsSegment::~MetricsSegment()
+{
+   try
+   {
+#ifndef _WIN32
+      if (pImpl_->pHeader != NULL)
+         ::munmap(pImpl_->pHeader, segmentSize());
+      if (pImpl_->fd != -1)
+         ::close(pImpl_->fd);
+#endif
+      delete pImpl_;
+   }
+   catch(...)
+   {
+   }
+}
+
+bool MetricsSegment::isOpen() const
+{
+   return pImpl_->pHeader != NULL;
+}
+
+#ifndef _WIN32
+
+Error MetricsSegment::open(const FilePath& segmentPath)
+{
+   // open (creating if necessary -- readable/writeable by every session
+   // user on the host)
+   int fd = ::open(segmentPath.absolutePath().c_str(),
+                   O_RDWR | O_CREAT,
+                   0666);
+   if (fd == -1)
+      return systemError(errno, ERROR_LOCATION);
+
+   // size the file (idempotent; a freshly created file is zero filled)
+   if (::ftruncate(fd, segmentSize()) == -1)
+   {
+      Error error = systemError(errno, ERROR_LOCATION);
+      ::close(fd);
+      return error;
+   }
+
+   // map it
+   void* pMapped = ::mmap(NULL,
+                          segmentSize(),
+                          PROT_READ | PROT_WRITE,
+                          MAP_SHARED,
+                          fd,
+                          0);
+   if (pMapped == MAP_FAILED)
+   {
+      Error error = systemError(errno, ERROR_LOCATION);
+      ::close(fd);
+      return error;
+   }
+
+   Header* pHeader = static_cast<Header*>(pMapped);
+
+   // initialize the header if we are first in (the magic is claimed with
+   // a compare-and-swap so concurrent creators initialize exactly once)
+   if (pHeader->magic != kSegmentMagic &&
+       compareAndSwap(&pHeader->magic, 0, kSegmentMagic))
+   {
+      pHeader->version = kSegmentVersion;
+      pHeader->slotCount = kSlotCount;
+      pHeader->entriesPerSlot = kEntriesPerSlot;
+      memoryBarrier();
+   }
+
+   // reject a segment from an incompatible version
+   if (pHeader->magic != kSegmentMagic ||
+       pHeader->version != kSegmentVersion ||
+       pHeader->slotCount != kSlotCount ||
+       pHeader->entriesPerSlot != kEntriesPerSlot)
+   {
+      ::munmap(pMapped, segmentSize());
+      ::close(fd);
+      return systemError(boost::system::errc::protocol_error,
+                         ERROR_LOCATION);
+   }
+
+   pImpl_->fd = fd;
+   pImpl_->pHeader = pHeader;
+   pImpl_->pSlots = reinterpret_cast<Slot*>(pHeader + 1);
+   return Success();
+}
+
+Error MetricsSegment::acquireSlot(const std::string& identity)
+{
+   if (!isOpen())
+      return systemError(boost::system::errc::bad_file_descriptor,
+                         ERROR_LOCATION);
+
+   boost::uint32_t pid = static_cast<boost::uint32_t>(::getpid());
+   for (boost::uint32_t i = 0; i < kSlotCount; i++)
+   {
+      Slot* pSlot = &pImpl_->pSlots[i];
+
+      // claim free slots and slots abandoned by exited processes
+      boost::uint32_t owner = pSlot->pid;
+      if (owner != 0 && (::kill(owner, 0) != -1 || errno != ESRCH))
+         continue;
+      if (!compareAndSwap(&pSlot->pid, owner, pid))
+         continue;
+
+      // the slot is ours -- reset it (we are now its only writer)
+      pSlot->sequence++;
+      memoryBarrier();
+      ::memset(pSlot->identity, 0, kIdentityLength);
+      identity.copy(pSlot->identity, kIdentityLength - 1);
+      ::memset(pSlot->entries, 0, kEntriesPerSlot * sizeof(Entry));
+      memoryBarrier();
+      pSlot->sequence++;
+
+      pImpl_->pOwnSlot = pSlot;
+      return Success();
+   }
+
+   return systemError(boost::system::errc::no_buffer_space, ERROR_LOCATION);
+}
+
+void MetricsSegment::publishMetric(const std::string& name, double value)
+{
+   Slot* pSlot = pImpl_->pOwnSlot;
+   if (pSlot == NULL)
+      return;
+
+   // locate the entry (we are the slot's only writer so scanning and
+   // claiming entries requires no synchronization)
+   Entry* pEntry = NULL;
+   for (boost::uint32_t i = 0; i < kEntriesPerSlot; i++)
+   {
+      Entry* pCandidate = &pSlot->entries[i];
+      if (pCandidate->name[0] == '\0' ||
+          ::strncmp(pCandidate->name, name.c_str(), kEntryNameLength) == 0)
+      {
+         pEntry = pCandidate;
+         break;
+      }
+   }
+   if (pEntry == NULL)
+      return; // slot full -- drop the sample
+
+   // accumulate under the sequence lock
+   pSlot->sequence++;
+   memoryBarrier();
+   if (pEntry->name[0] == '\0')
+   {
+      ::memset(pEntry->name, 0, kEntryNameLength);
+      name.copy(pEntry->name, kEntryNameLength - 1);
+   }
+   pEntry->value += value;
+   pEntry->count++;
+   memoryBarrier();
+   pSlot->sequence++;
+}
+
+Error MetricsSegment::collectMetrics(std::vector<Metric>* pMetrics)
+{
+   if (!isOpen())
+      return systemError(boost::system::errc::bad_file_descriptor,
+                         ERROR_LOCATION);
+
+   for (boost::uint32_t i = 0; i < kSlotCount; i++)
+   {
+      Slot* pSlot = &pImpl_->pSlots[i];
+      boost::uint32_t pid = pSlot->pid;
+      if (pid == 0)
+         continue;
+
+      // release slots abandoned by exited processes
+      if (::kill(pid, 0) == -1 && errno == ESRCH)
+      {
+         compareAndSwap(&pSlot->pid, pid, 0);
+         continue;
+      }
+
+      // copy the slot out under the sequence lock (retry if the owner
+      // updated it mid-read)
+      char identity[kIdentityLength];
+      Entry entries[kEntriesPerSlot];
+      bool consistent = false;
+      for (int attempt = 0; attempt < kMaxReadAttempts; attempt++)
+      {
+         boost::uint32_t sequence = pSlot->sequence;
+         if (sequence % 2 != 0)
+            continue;
+         memoryBarrier();
+         ::memcpy(identity, const_cast<char*>(pSlot->identity),
+                  kIdentityLength);
+         ::memcpy(entries, const_cast<Entry*>(pSlot->entries),
+                  kEntriesPerSlot * sizeof(Entry));
+         memoryBarrier();
+         if (pSlot->sequence == sequence)
+         {
+            consistent = true;
+            break;
+         }
+      }
+      if (!consistent)
+         continue;
+
+      // append one metric per entry (value is the running sum; the
+      // sample count is appended alongside so the scraper can derive
+      // rates and means between scrapes)
+      identity[kIdentityLength-1] = '\0';
+      std::string scope(identity);
+      for (boost::uint32_t e = 0; e < kEntriesPerSlot; e++)
+      {
+         if (entries[e].name[0] == '\0')
+            break;
+         entries[e].name[kEntryNameLength-1] = '\0';
+         std::string name(entries[e].name);
+         pMetrics->push_back(Metric(scope,
+                                    1,
+                                    MetricData(name, entries[e].value),
+                                    "counter"));
+         pMetrics->push_back(Metric(scope,
+                                    1,
+                                    MetricData(name + "_count",
+                                       static_cast<double>(entries[e].count)),
+                                    "counter"));
+      }
+   }
+
+   return Success();
+}
+
+#else
+
+Error MetricsSegment::open(const FilePath& segmentPath)
+{
+   return systemError(boost::system::errc::not_supported, ERROR_LOCATION);
+}
+
+Error MetricsSegment::acquireSlot(const std::string& identity)
+{
+   return systemError(boost::system::errc::not_supported, ERROR_LOCATION);
+}
+
+void MetricsSegment::publishMetric(const std::string& name, double value)
+{
+}
+
+Error MetricsSegment::collectMetrics(std::vector<Metric>* pMetrics)
+{
+   return systemError(boost::system::errc::not_supported, ERROR_LOCATION);
+}
+
+#endif
+
+} // namespace metrics
+} // namespace monitor
+} // namespace rstudio
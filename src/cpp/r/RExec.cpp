@@ -364,8 +364,7 @@ Error RFunction::call(SEXP evalNS, SEXP* pResultSEXP, sexp::Protect* pProtect)
    return call(evalNS, true, pResultSEXP, pProtect);
 }
 
-Error RFunction::call(SEXP evalNS, bool safely, SEXP* pResultSEXP,
-                      sexp::Protect* pProtect)
+Error RFunction::createCall(SEXP* pCallSEXP, sexp::Protect* pProtect) const
 {
    // verify the function
    if (functionSEXP_ == R_UnboundValue)
@@ -376,18 +375,18 @@ Error RFunction::call(SEXP evalNS, bool safely, SEXP* pResultSEXP,
          error.addProperty("symbol", functionName_);
       return error;
    }
-   
+
    // create the call object (LANGSXP) with the correct number of elements
    SEXP callSEXP ;
    pProtect->add(callSEXP = Rf_allocVector(LANGSXP, 1 + params_.size()));
-   SET_TAG(callSEXP, R_NilValue); // just like do_ascall() does 
-   
+   SET_TAG(callSEXP, R_NilValue); // just like do_ascall() does
+
    // assign the function to the first element of the call
    SETCAR(callSEXP, functionSEXP_);
-   
+
    // assign parameters to the subseqent elements of the call
    SEXP nextSlotSEXP = CDR(callSEXP);
-   for (std::vector<Param>::const_iterator 
+   for (std::vector<Param>::const_iterator
             it = params_.begin(); it != params_.end(); ++it)
    {
       SETCAR(nextSlotSEXP, it->valueSEXP);
@@ -396,19 +395,95 @@ Error RFunction::call(SEXP evalNS, bool safely, SEXP* pResultSEXP,
          SET_TAG(nextSlotSEXP, Rf_install(it->name.c_str()));
       nextSlotSEXP = CDR(nextSlotSEXP);
    }
-   
+
+   // return the call
+   *pCallSEXP = callSEXP;
+   return Success();
+}
+
+Error RFunction::call(SEXP evalNS, bool safely, SEXP* pResultSEXP,
+                      sexp::Protect* pProtect)
+{
+   // create the call object
+   SEXP callSEXP ;
+   Error error = createCall(&callSEXP, pProtect);
+   if (error)
+      return error;
+
    // call the function
-   Error error = safely ?
+   error = safely ?
             evaluateExpressions(callSEXP, evalNS, pResultSEXP, pProtect) :
             evaluateExpressionsUnsafe(callSEXP, evalNS, pResultSEXP, pProtect,
                   EvalTry);
    if (error)
       return error;
-   
+
    // return success
    return Success();
 }
 
+Error RFunctionBatch::call(std::vector<SEXP>* pResultsSEXP,
+                           sexp::Protect* pProtect)
+{
+   return call(R_GlobalEnv, pResultsSEXP, pProtect);
+}
+
+Error RFunctionBatch::call(SEXP evalNS,
+                           std::vector<SEXP>* pResultsSEXP,
+                           sexp::Protect* pProtect)
+{
+   // short circuit for an empty batch
+   pResultsSEXP->clear();
+   if (functions_.empty())
+      return Success();
+
+   // lookup base::list (used to collect the positional results)
+   SEXP listSEXP = sexp::findFunction("list", "base");
+   if (listSEXP == R_UnboundValue)
+   {
+      LOG_ERROR_MESSAGE("Failed to find function: 'list'");
+      Error error(errc::SymbolNotFoundError, ERROR_LOCATION);
+      error.addProperty("symbol", "list");
+      return error;
+   }
+
+   // wrap the individual calls in a single call to base::list -- this
+   // evaluates every call within one interpreter entry (one top level
+   // error handling context and one protect/unprotect) rather than
+   // paying the evaluation setup cost once per call
+   SEXP batchSEXP ;
+   pProtect->add(batchSEXP = Rf_allocVector(LANGSXP, 1 + functions_.size()));
+   SET_TAG(batchSEXP, R_NilValue);
+   SETCAR(batchSEXP, listSEXP);
+   SEXP nextSlotSEXP = CDR(batchSEXP);
+   for (std::vector<boost::shared_ptr<RFunction> >::const_iterator
+            it = functions_.begin(); it != functions_.end(); ++it)
+   {
+      SEXP callSEXP ;
+      Error error = (*it)->createCall(&callSEXP, pProtect);
+      if (error)
+         return error;
+
+      SETCAR(nextSlotSEXP, callSEXP);
+      nextSlotSEXP = CDR(nextSlotSEXP);
+   }
+
+   // evaluate the batch
+   SEXP resultsSEXP ;
+   Error error = evaluateExpressions(batchSEXP, evalNS, &resultsSEXP,
+                                     pProtect);
+   if (error)
+      return error;
+
+   // unpack the positional results
+   int numResults = sexp::length(resultsSEXP);
+   pResultsSEXP->reserve(numResults);
+   for (int i = 0; i < numResults; i++)
+      pResultsSEXP->push_back(VECTOR_ELT(resultsSEXP, i));
+
+   return Success();
+}
+
 FilePath rBinaryPath()
 {
    FilePath binPath = FilePath(R_HomeDir()).complete("bin");
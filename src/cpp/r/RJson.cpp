@@ -154,6 +154,76 @@ Error jsonValueFromVectorElement(SEXP vectorSEXP,
 }  
 
 
+// Bulk converters for the common atomic vector types. These hoist the type
+// dispatch out of the per-element loop and construct each value in place in
+// preallocated array storage, rather than routing every element through
+// jsonValueFromVectorElement (which default-constructs a null variant,
+// switches on the vector type, then copies the result into the array). For
+// million-element vectors the per-element boxing dominates conversion time.
+
+void jsonArrayFromRealVector(SEXP vectorSEXP, core::json::Array* pArray)
+{
+   int n = Rf_length(vectorSEXP);
+   pArray->reserve(n);
+   const double* pData = REAL(vectorSEXP);
+   for (int i=0; i<n; i++)
+   {
+      if (!ISNAN(pData[i]))
+         pArray->push_back(core::json::Value(pData[i]));
+      else
+         pArray->push_back(core::json::Value());
+   }
+}
+
+void jsonArrayFromIntegerVector(SEXP vectorSEXP, core::json::Array* pArray)
+{
+   int n = Rf_length(vectorSEXP);
+   pArray->reserve(n);
+   const int* pData = INTEGER(vectorSEXP);
+   for (int i=0; i<n; i++)
+   {
+      if (pData[i] != NA_INTEGER)
+         pArray->push_back(core::json::Value(pData[i]));
+      else
+         pArray->push_back(core::json::Value());
+   }
+}
+
+void jsonArrayFromLogicalVector(SEXP vectorSEXP, core::json::Array* pArray)
+{
+   int n = Rf_length(vectorSEXP);
+   pArray->reserve(n);
+   const int* pData = LOGICAL(vectorSEXP);
+   for (int i=0; i<n; i++)
+   {
+      if (pData[i] != NA_LOGICAL)
+         pArray->push_back(core::json::Value(pData[i] == TRUE));
+      else
+         pArray->push_back(core::json::Value());
+   }
+}
+
+void jsonArrayFromStringVector(SEXP vectorSEXP, core::json::Array* pArray)
+{
+   int n = Rf_length(vectorSEXP);
+   pArray->reserve(n);
+   for (int i=0; i<n; i++)
+   {
+      SEXP stringSEXP = STRING_ELT(vectorSEXP, i);
+      if (stringSEXP != NA_STRING)
+      {
+         // construct the json value directly from the element's buffer
+         // (avoids an intermediate std::string per element)
+         pArray->push_back(
+                  core::json::Value(r::sexp::asStringView(vectorSEXP, i, true)));
+      }
+      else
+      {
+         pArray->push_back(core::json::Value());
+      }
+   }
+}
+
 Error jsonValueArrayFromList(SEXP listSEXP, core::json::Value* pValue)
 {
    // value array to return
@@ -349,19 +419,50 @@ Error jsonValueFromVector(SEXP vectorSEXP, core::json::Value* pValue)
    }
 
    core::json::Array vectorValues ;
-   for (int i=0; i<vectorLength; i++)
+
+   // bulk conversion paths for the common atomic types (see comments on
+   // the converters above); everything else falls back to the generic
+   // per-element path
+   switch(TYPEOF(vectorSEXP))
    {
-      core::json::Value elementValue ;
-      Error error = jsonValueFromVectorElement(vectorSEXP, i, &elementValue);
-      if (error)
-         return error;
-      
-      vectorValues.push_back(elementValue);
+      case REALSXP:
+      {
+         jsonArrayFromRealVector(vectorSEXP, &vectorValues);
+         break;
+      }
+      case INTSXP:
+      {
+         jsonArrayFromIntegerVector(vectorSEXP, &vectorValues);
+         break;
+      }
+      case LGLSXP:
+      {
+         jsonArrayFromLogicalVector(vectorSEXP, &vectorValues);
+         break;
+      }
+      case STRSXP:
+      {
+         jsonArrayFromStringVector(vectorSEXP, &vectorValues);
+         break;
+      }
+      default:
+      {
+         for (int i=0; i<vectorLength; i++)
+         {
+            core::json::Value elementValue ;
+            Error error = jsonValueFromVectorElement(vectorSEXP, i, &elementValue);
+            if (error)
+               return error;
+
+            vectorValues.push_back(elementValue);
+         }
+         break;
+      }
    }
-   
+
    *pValue = vectorValues;
    return Success();
-}   
+}
    
    
 Error jsonValueFromList(SEXP listSEXP, core::json::Value* pValue)
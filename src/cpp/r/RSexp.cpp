@@ -148,6 +148,16 @@ bool asLogical(SEXP object)
    return Rf_asLogical(object) ? true : false;
 }
 
+const char* asStringView(SEXP strSEXP, int i, bool asUtf8)
+{
+   SEXP charSEXP = STRING_ELT(strSEXP, i);
+   if (charSEXP == NA_STRING)
+      return "";
+
+   return asUtf8 ? Rf_translateCharUTF8(charSEXP) :
+                   Rf_translateChar(charSEXP);
+}
+
 bool fillVectorString(SEXP object, std::vector<std::string>* pVector)
 {
    if (TYPEOF(object) != STRSXP)
@@ -425,8 +435,70 @@ int length(SEXP object)
 {
    return Rf_length(object);
 }
- 
-   
+
+bool isPlainAtomicVector(SEXP object)
+{
+   // character vectors are deliberately excluded: their size is
+   // dominated by the character data hanging off each element, which
+   // can't be measured without traversal, so approximateVectorBytes
+   // would badly understate them
+   switch (TYPEOF(object))
+   {
+      case LGLSXP:
+      case INTSXP:
+      case REALSXP:
+      case CPLXSXP:
+      case RAWSXP:
+         break;
+      default:
+         return false;
+   }
+
+   // any attribute (class, dim, names, etc.) can change how the object
+   // should be displayed, so only unadorned vectors qualify
+   return ATTRIB(object) == R_NilValue;
+}
+
+double approximateVectorBytes(SEXP object)
+{
+   double elementBytes = 0;
+   switch (TYPEOF(object))
+   {
+      case LGLSXP:
+      case INTSXP:
+         elementBytes = 4;
+         break;
+      case REALSXP:
+         elementBytes = 8;
+         break;
+      case CPLXSXP:
+         elementBytes = 16;
+         break;
+      case RAWSXP:
+         elementBytes = 1;
+         break;
+      default:
+         return 0;
+   }
+
+   // vector header plus payload (mirrors object.size for flat vectors)
+   return 56 + (elementBytes * static_cast<double>(Rf_length(object)));
+}
+
+std::string implicitVectorClass(SEXP object)
+{
+   switch (TYPEOF(object))
+   {
+      case LGLSXP:  return "logical";
+      case INTSXP:  return "integer";
+      case REALSXP: return "numeric";
+      case CPLXSXP: return "complex";
+      case RAWSXP:  return "raw";
+      default:      return std::string();
+   }
+}
+
+
 bool isLanguage(SEXP object)
 {
    return Rf_isLanguage(object);
@@ -631,10 +703,12 @@ Error extract(SEXP valueSEXP, std::vector<std::string>* pVector)
    if (TYPEOF(valueSEXP) != STRSXP)
       return Error(errc::UnexpectedDataTypeError, ERROR_LOCATION);
 
+   int n = Rf_length(valueSEXP);
    pVector->clear();
-   for (int i=0; i<Rf_length(valueSEXP); i++)
+   pVector->reserve(n);
+   for (int i=0; i<n; i++)
       pVector->push_back(Rf_translateChar(STRING_ELT(valueSEXP, i)));
-   
+
    return Success();
 }
 
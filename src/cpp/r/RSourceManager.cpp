@@ -22,6 +22,7 @@
 
 #include <core/Error.hpp>
 #include <core/FilePath.hpp>
+#include <core/Hash.hpp>
 #include <core/Log.hpp>
 
 #include <r/RExec.hpp>
@@ -95,6 +96,10 @@ void SourceManager::reSourceTools(const core::FilePath& filePath)
    
 Error SourceManager::source(const FilePath& filePath, bool local)
 {
+   // source via the parse cache when one is configured
+   if (!parseCachePath_.empty())
+      return cachedSource(filePath, local);
+
    std::string localPrefix = local ? "local(" : "";
    std::string localParam = local ? "TRUE" : "FALSE" ;
    std::string localSuffix = local ? ")" : "";
@@ -125,6 +130,65 @@ Error SourceManager::source(const FilePath& filePath, bool local)
    return r::exec::executeString(rCode); 
 }
 
+Error SourceManager::cachedSource(const FilePath& filePath, bool local)
+{
+   // cache file keyed by the source path (stem retained for legibility)
+   std::string path = filePath.absolutePath();
+   FilePath cacheFilePath = parseCachePath_.complete(
+            filePath.stem() + "_" + core::hash::crc32HexHash(path) + ".rds");
+   std::string cachePath = cacheFilePath.absolutePath();
+
+   // do \ escaping (for windows)
+   boost::algorithm::replace_all(path, "\\", "\\\\");
+   std::string escapedCachePath = cachePath;
+   boost::algorithm::replace_all(escapedCachePath, "\\", "\\\\");
+
+   // keep source refs only for debug builds (mirrors source() below)
+#ifdef NDEBUG
+   std::string keepSource = "FALSE";
+#else
+   std::string keepSource = "TRUE";
+#endif
+
+   // deserialize the parsed expressions when the cache entry is current,
+   // otherwise parse the file and refresh the cache entry (written via a
+   // temp file + rename so concurrent sessions never read a partial
+   // entry; any failure to read or write the cache just re-parses).
+   // expressions are evaluated in a local frame or globalenv to match
+   // the local semantics of source()
+   std::string rCode = std::string() +
+      "local({" +
+      "  src <- \"" + path + "\";" +
+      "  cache <- \"" + escapedCachePath + "\";" +
+      "  envir <- if (" + (local ? "TRUE" : "FALSE") + ")" +
+      "     environment() else globalenv();" +
+      "  exprs <- NULL;" +
+      "  times <- file.info(c(cache, src))$mtime;" +
+      "  if (!any(is.na(times)) && times[[1]] >= times[[2]])" +
+      "     exprs <- tryCatch(readRDS(cache), error = function(e) NULL);" +
+      "  if (is.null(exprs)) {" +
+      "     exprs <- parse(src, keep.source = " + keepSource + "," +
+      "                    encoding = \"UTF-8\");" +
+      "     dir.create(dirname(cache), recursive = TRUE," +
+      "                showWarnings = FALSE);" +
+      "     tmp <- tempfile(tmpdir = dirname(cache));" +
+      "     tryCatch({" +
+      "        saveRDS(exprs, tmp);" +
+      "        file.rename(tmp, cache);" +
+      "     }, error = function(e) unlink(tmp));" +
+      "  };" +
+      "  for (expr in exprs)" +
+      "     eval(expr, envir);" +
+      "  invisible(NULL);" +
+      "})";
+
+   // record that we sourced the file
+   recordSourcedFile(filePath, local);
+
+   // evaluate
+   return r::exec::executeString(rCode);
+}
+
 void SourceManager::recordSourcedFile(const FilePath& filePath, bool local)
 {
    SourcedFileInfo fileInfo(filePath.lastWriteTime(), local); 
@@ -22,6 +22,7 @@
 
 #include <boost/utility.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/function.hpp>
 
 #include <core/Error.hpp>
@@ -231,7 +232,11 @@ public:
    
 private:
    void commonInit(const std::string& functionName);
-   
+
+   // allow RFunctionBatch to build the call object for batched evaluation
+   friend class RFunctionBatch;
+   core::Error createCall(SEXP* pCallSEXP, sexp::Protect* pProtect) const;
+
 private:
    // preserve SEXPs
    r::sexp::SEXPPreserver preserver_;
@@ -255,6 +260,32 @@ private:
    std::vector<Param> params_ ;
 };
 
+// batch multiple function invocations into a single R evaluation (one
+// protect/unprotect and one error handling scope rather than one per
+// call). results are returned positionally, one per added function
+class RFunctionBatch : boost::noncopyable
+{
+public:
+   RFunctionBatch()
+   {
+   }
+
+   // COPYING: boost::noncopyable
+
+   void add(const boost::shared_ptr<RFunction>& pFunction)
+   {
+      functions_.push_back(pFunction);
+   }
+
+   core::Error call(std::vector<SEXP>* pResultsSEXP, sexp::Protect* pProtect);
+   core::Error call(SEXP evalNS,
+                    std::vector<SEXP>* pResultsSEXP,
+                    sexp::Protect* pProtect);
+
+private:
+   std::vector<boost::shared_ptr<RFunction> > functions_;
+};
+
 void warning(const std::string& warning);
    
 void message(const std::string& message);
@@ -72,6 +72,16 @@ SEXP findFunction(const std::string& name,
 std::string typeAsString(SEXP object);
 std::string classOf(SEXP objectSEXP);
 int length(SEXP object);
+
+// header-only inspection helpers: these read type and length directly
+// from the SEXP header, without evaluating promises, firing methods,
+// or traversing contents, so they're safe and cheap to call on any
+// binding (used to fast-path environment pane listings). restricted to
+// fixed-width element types -- character vectors don't qualify since
+// their size can't be computed without traversing the elements
+bool isPlainAtomicVector(SEXP object);
+double approximateVectorBytes(SEXP object);
+std::string implicitVectorClass(SEXP object);
    
 SEXP getNames(SEXP sexp);
 bool setNames(SEXP sexp, const std::vector<std::string>& names);
@@ -98,6 +108,13 @@ int asInteger(SEXP object);
 double asReal(SEXP object);
 bool asLogical(SEXP object);
 
+// zero-copy view of a character vector element -- returns the element's
+// underlying buffer without constructing a std::string. the buffer is
+// owned by the R runtime (translations live in R's transient allocation
+// pool) so it must be consumed before control returns to R. NA elements
+// yield the empty string
+const char* asStringView(SEXP strSEXP, int i, bool asUtf8 = false);
+
 bool fillVectorString(SEXP object, std::vector<std::string>* pVector);
 bool fillSetString(SEXP object, std::set<std::string>* pSet);
 
@@ -50,6 +50,16 @@ public:
    
    bool autoReload() const { return autoReload_; }
    void setAutoReload(bool autoReload) { autoReload_ = autoReload; }
+
+   // directory used to cache parsed expressions for sourced files. when
+   // set, files are parsed once and the expression list is persisted as
+   // an .rds alongside-cache keyed by source path; subsequent sessions
+   // deserialize rather than re-parse (stale entries are detected by
+   // comparing modification times). empty path disables the cache
+   void setParseCachePath(const core::FilePath& parseCachePath)
+   {
+      parseCachePath_ = parseCachePath;
+   }
    
    core::Error sourceTools(const core::FilePath& filePath);
    void ensureToolsLoaded();
@@ -75,12 +85,14 @@ private:
    
    // helper functions
    core::Error source(const core::FilePath& filePath, bool local);
+   core::Error cachedSource(const core::FilePath& filePath, bool local);
    void reSourceTools(const core::FilePath& filePath);
    void recordSourcedFile(const core::FilePath& filePath, bool local);
    void reloadSourceIfNecessary(const SourcedFileMap::value_type& value);
    
    // members
    bool autoReload_ ;
+   core::FilePath parseCachePath_;
    SourcedFileMap sourcedFiles_ ;
    std::vector<core::FilePath> toolsFilePaths_;
 };
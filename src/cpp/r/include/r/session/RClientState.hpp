@@ -16,6 +16,7 @@
 #ifndef R_SESSION_CLIENT_STATE_HPP
 #define R_SESSION_CLIENT_STATE_HPP
 
+#include <set>
 #include <string>
 
 #include <boost/utility.hpp>
@@ -90,6 +91,12 @@ private:
    core::json::Object temporaryState_ ;
    core::json::Object persistentState_ ;
    core::json::Object projectPersistentState_;
+
+   // scopes mutated since the last commit -- used to rewrite only the
+   // state files whose contents have actually changed
+   std::set<std::string> dirtyTemporary_;
+   std::set<std::string> dirtyPersistent_;
+   std::set<std::string> dirtyProjectPersistent_;
 };
       
 } // namespace session
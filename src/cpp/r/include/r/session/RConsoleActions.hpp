@@ -67,12 +67,17 @@ public:
    core::Error loadFromFile(const core::FilePath& filePath);
    core::Error saveToFile(const core::FilePath& filePath) const;
 
+private:
+   // NOTE: callers must hold mutex_
+   void evictToContentLimit();
+
 private:
    // protect data using a mutex because background threads (e.g.
    // console output capture threads) can interact with console actions
    mutable boost::mutex mutex_;
    boost::circular_buffer<core::json::Value> actionsType_;
    boost::circular_buffer<core::json::Value> actionsData_;
+   std::size_t totalDataSize_;
    std::vector<std::string> pendingInput_;
 };
 
@@ -83,21 +83,51 @@ void mergeState(const json::Object& sourceState,
 }
 
 void commitState(const json::Object& stateContainer,
+                 const std::set<std::string>& dirtyScopes,
+                 bool commitAllScopes,
                  const std::string& fileExt,
                  const core::FilePath& stateDir)
 {
    for (json::Object::const_iterator
         it = stateContainer.begin(); it != stateContainer.end(); ++it)
    {
+      // skip scopes which haven't changed since the last commit (unless
+      // we are re-creating the state directory from scratch)
+      if (!commitAllScopes && dirtyScopes.find(it->first) == dirtyScopes.end())
+         continue;
+
       // generate json
       std::ostringstream ostr ;
       json::writeFormatted(it->second, ostr);
-      
+
       // write to file
       FilePath stateFile = stateDir.complete(it->first + fileExt);
       Error error = writeStringToFile(stateFile, ostr.str());
       if (error)
-         LOG_ERROR(error);   
+         LOG_ERROR(error);
+   }
+}
+
+void removeStateFiles(const core::FilePath& stateDir,
+                      const std::string& fileExt)
+{
+   std::vector<FilePath> childPaths;
+   Error error = stateDir.children(&childPaths);
+   if (error)
+   {
+      LOG_ERROR(error);
+      return;
+   }
+
+   for (std::vector<FilePath>::const_iterator
+        it = childPaths.begin(); it != childPaths.end(); ++it)
+   {
+      if (it->extension() == fileExt)
+      {
+         error = it->removeIfExists();
+         if (error)
+            LOG_ERROR(error);
+      }
    }
 }
    
@@ -195,11 +225,14 @@ void ClientState::restoreProjectState(const FilePath& stateFile)
       restoreState(stateFile, &projectPersistentState_);
 }
    
-void ClientState::clear()  
+void ClientState::clear()
 {
    temporaryState_.clear();
    persistentState_.clear();
    projectPersistentState_.clear();
+   dirtyTemporary_.clear();
+   dirtyPersistent_.clear();
+   dirtyProjectPersistent_.clear();
 }
  
 void ClientState::putTemporary(const std::string& scope, 
@@ -213,6 +246,12 @@ void ClientState::putTemporary(const std::string& scope,
    
 void ClientState::putTemporary(const json::Object& temporaryState)
 {
+   for (json::Object::const_iterator it = temporaryState.begin();
+        it != temporaryState.end();
+        ++it)
+   {
+      dirtyTemporary_.insert(it->first);
+   }
    mergeState(temporaryState, &temporaryState_);
 }
 
@@ -227,6 +266,12 @@ void ClientState::putPersistent(const std::string& scope,
 
 void ClientState::putPersistent(const json::Object& persistentState)
 {
+   for (json::Object::const_iterator it = persistentState.begin();
+        it != persistentState.end();
+        ++it)
+   {
+      dirtyPersistent_.insert(it->first);
+   }
    mergeState(persistentState, &persistentState_);
 }
 
@@ -259,6 +304,12 @@ json::Value ClientState::getProjectPersistent(std::string scope,
 void ClientState::putProjectPersistent(
                               const json::Object& projectPersistentState)
 {
+   for (json::Object::const_iterator it = projectPersistentState.begin();
+        it != projectPersistentState.end();
+        ++it)
+   {
+      dirtyProjectPersistent_.insert(it->first);
+   }
    mergeState(projectPersistentState, &projectPersistentState_);
 }
 
@@ -267,24 +318,53 @@ Error ClientState::commit(ClientStateCommitType commitType,
                           const core::FilePath& stateDir,
                           const core::FilePath& projectStateDir)
 {
-   // remove and re-create the stateDirs
-   Error error = removeAndRecreateStateDir(stateDir);
-   if (error)
-      return error;
-   error = removeAndRecreateStateDir(projectStateDir);
-   if (error)
-      return error;
+   // if a state directory doesn't yet exist then this is our first commit
+   // into it -- create it and write every scope. otherwise leave it in
+   // place and rewrite only the scopes which have changed since the last
+   // commit (commits run frequently and most leave the bulk of the
+   // state untouched)
+   Error error;
+   bool fullGlobalCommit = !stateDir.exists();
+   if (fullGlobalCommit)
+   {
+      error = removeAndRecreateStateDir(stateDir);
+      if (error)
+         return error;
+   }
+   bool fullProjectCommit = !projectStateDir.exists();
+   if (fullProjectCommit)
+   {
+      error = removeAndRecreateStateDir(projectStateDir);
+      if (error)
+         return error;
+   }
 
    // always commit persistent state
-   commitState(persistentState_, kPersistentExt, stateDir);
-   commitState(projectPersistentState_, kProjPersistentExt, projectStateDir);
-  
+   commitState(persistentState_, dirtyPersistent_, fullGlobalCommit,
+               kPersistentExt, stateDir);
+   commitState(projectPersistentState_, dirtyProjectPersistent_,
+               fullProjectCommit, kProjPersistentExt, projectStateDir);
+   dirtyPersistent_.clear();
+   dirtyProjectPersistent_.clear();
+
    // commit all state if requested
    if (commitType == ClientStateCommitAll)
-      commitState(temporaryState_, kTemporaryExt, stateDir);
+   {
+      commitState(temporaryState_, dirtyTemporary_, fullGlobalCommit,
+                  kTemporaryExt, stateDir);
+      dirtyTemporary_.clear();
+   }
    else
+   {
       temporaryState_.clear();
-   
+      dirtyTemporary_.clear();
+
+      // the directory wasn't wiped, so remove any temporary state
+      // files written by a previous full commit
+      if (!fullGlobalCommit)
+         removeStateFiles(stateDir, kTemporaryExt);
+   }
+
    return Success();
 }
    
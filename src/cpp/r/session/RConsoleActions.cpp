@@ -33,9 +33,21 @@ namespace rstudio {
 namespace r {
 namespace session {
 
-namespace {   
+namespace {
 const char * const kActionType = "type";
 const char * const kActionData = "data";
+
+// overall size limit for retained console action data. the circular
+// buffer bounds the number of actions but a single action can carry an
+// arbitrarily large string (e.g. printing a very large object), so we
+// also enforce a content budget by evicting the oldest actions
+const std::size_t kMaxActionsDataSize = 512 * 1024;
+
+std::size_t actionDataSize(const json::Value& data)
+{
+   return json::isType<std::string>(data) ? data.get_str().size() : 0;
+}
+
 }
    
 ConsoleActions& consoleActions()
@@ -45,6 +57,7 @@ ConsoleActions& consoleActions()
 }
    
 ConsoleActions::ConsoleActions()
+   : totalDataSize_(0)
 {
    setCapacity(1000);
 }
@@ -102,16 +115,36 @@ void ConsoleActions::add(int type, const std::string& data)
           actionsData_.back().get_str().size() < 512)
       {
          actionsData_.back() = actionsData_.back().get_str() + data;
+         totalDataSize_ += data.size();
       }
       else
       {
+         // account for the action the circular buffer is about to evict
+         if (actionsData_.full() && !actionsData_.empty())
+            totalDataSize_ -= actionDataSize(actionsData_.front());
+
          actionsType_.push_back(type);
          actionsData_.push_back(data);
+         totalDataSize_ += data.size();
       }
+
+      // enforce the overall content budget
+      evictToContentLimit();
    }
    END_LOCK_MUTEX
 }
 
+void ConsoleActions::evictToContentLimit()
+{
+   // always retain at least the most recent action
+   while (totalDataSize_ > kMaxActionsDataSize && actionsData_.size() > 1)
+   {
+      totalDataSize_ -= actionDataSize(actionsData_.front());
+      actionsType_.pop_front();
+      actionsData_.pop_front();
+   }
+}
+
 void ConsoleActions::notifyInterrupt()
 {
    LOCK_MUTEX(mutex_)
@@ -128,6 +161,7 @@ void ConsoleActions::reset()
       // clear the existing actions
       actionsType_.clear();
       actionsData_.clear();
+      totalDataSize_ = 0;
    }
    END_LOCK_MUTEX
 }
@@ -162,6 +196,7 @@ Error ConsoleActions::loadFromFile(const FilePath& filePath)
    {
       actionsType_.clear();
       actionsData_.clear();
+      totalDataSize_ = 0;
 
       if (filePath.exists())
       {
@@ -208,10 +243,19 @@ Error ConsoleActions::loadFromFile(const FilePath& filePath)
          {
             LOG_WARNING_MESSAGE("unexpected json type in: " + actionsJson);
          }
+
+         // recompute the content size and re-apply the budget (the file
+         // may have been written by a version without the size limit)
+         for (boost::circular_buffer<json::Value>::const_iterator it =
+                 actionsData_.begin(); it != actionsData_.end(); ++it)
+         {
+            totalDataSize_ += actionDataSize(*it);
+         }
+         evictToContentLimit();
       }
    }
    END_LOCK_MUTEX
-   
+
    return Success();
 }
    
@@ -1407,6 +1407,11 @@ Error run(const ROptions& options, const RCallbacks& callbacks)
    
    // set source reloading behavior
    sourceManager().setAutoReload(options.autoReloadSource);
+
+   // cache parsed expressions for sourced rstudio .R files in user scratch
+   // (shared across this user's sessions; entries go stale by mtime)
+   sourceManager().setParseCachePath(
+            s_options.userScratchPath.complete("parsed-source-cache"));
      
    // initialize suspended session path
    FilePath userScratch = s_options.userScratchPath;
@@ -1536,9 +1541,15 @@ void ensureDeserialized()
 {
    if (s_deferredDeserializationAction)
    {
+      // clear the action before running it -- the restore can take minutes
+      // for large workspaces, and connections handled from R's polled event
+      // loop during that window call back into ensureDeserialized (a second
+      // run of the restore against a partially restored session is not safe)
+      boost::function<void()> deferredDeserializationAction;
+      deferredDeserializationAction.swap(s_deferredDeserializationAction);
+
       // do the deferred action
-      s_deferredDeserializationAction();
-      s_deferredDeserializationAction.clear();
+      deferredDeserializationAction();
    }
 }
    
@@ -16,7 +16,9 @@
 #include "RSessionState.hpp"
 
 #include <algorithm>
+#include <map>
 
+#include <boost/bind.hpp>
 #include <boost/function.hpp>
 #include <boost/foreach.hpp>
 
@@ -28,6 +30,7 @@
 #include <core/system/Environment.hpp>
 
 #include <r/RExec.hpp>
+#include <r/RSexp.hpp>
 #include <r/ROptions.hpp>
 #include <r/RErrorCategory.hpp>
 #include <r/session/RSession.hpp>
@@ -94,8 +97,41 @@ bool isRLocationVariable(const std::string& name)
          name == "R_SHARE_DIR";
 }
 
+void insertEnvVar(std::map<std::string,std::string>* pVars,
+                  const std::string& name,
+                  const std::string& value)
+{
+   (*pVars)[name] = value;
+}
+
 Error saveEnvironmentVars(const FilePath& envFile)
 {
+   // get the current environment
+   core::system::Options env;
+   core::system::environment(&env);
+
+   // if a previously saved file matches the current environment then leave
+   // it alone -- suspends happen frequently and the environment rarely
+   // changes between them, so this usually saves the rewrite entirely
+   if (envFile.exists())
+   {
+      core::Settings existingSettings;
+      Error error = existingSettings.initialize(envFile);
+      if (!error)
+      {
+         std::map<std::string,std::string> existingVars;
+         existingSettings.forEach(boost::bind(insertEnvVar,
+                                              &existingVars, _1, _2));
+         std::map<std::string,std::string> currentVars;
+         BOOST_FOREACH(const core::system::Option& var, env)
+         {
+            currentVars[var.first] = var.second;
+         }
+         if (existingVars == currentVars)
+            return Success();
+      }
+   }
+
    // remove then create settings file
    Error error = envFile.removeIfExists();
    if (error)
@@ -105,9 +141,7 @@ Error saveEnvironmentVars(const FilePath& envFile)
    if (error)
       return error;
 
-   // get environment and write it to the file
-   core::system::Options env;
-   core::system::environment(&env);
+   // write the environment to the file
    envSettings.beginUpdate();
    BOOST_FOREACH(const core::system::Option& var, env)
    {
@@ -295,7 +329,11 @@ bool save(const FilePath& statePath,
    Settings settings;
    bool saved = true;
    initSaveContext(statePath, &settings, &saved);
-   
+
+   // batch all settings modified below into a single sequential write
+   // when we're done (rather than one write per setting)
+   settings.beginUpdate();
+
    // check and save packrat mode status
    bool packratModeOn = r::session::utils::isPackratModeOn();
    settings.set(kPackratModeOn, packratModeOn);
@@ -356,13 +394,21 @@ bool save(const FilePath& statePath,
    // save working context
    saveWorkingContext(statePath, &settings, &saved);
 
-   // save search path (disable save compression if requested)
-   if (disableSaveCompression)
-   {
-      error = r::exec::RFunction(".rs.disableSaveCompression").call();
-      if (error)
-         LOG_ERROR(error);
-   }
+   // disable save compression while the search path / global environment
+   // are written. R's single-threaded deflate dominates suspend time for
+   // large workspaces (multi-gigabyte images take minutes to compress),
+   // and since suspended state is transient local scratch data the disk
+   // space tradeoff is the right one. we capture the previous save
+   // defaults so they can be restored below -- this matters when the
+   // suspend is subsequently aborted and the session continues running
+   // (when disableSaveCompression was requested explicitly the process
+   // is guaranteed to exit, so no restore is performed)
+   r::sexp::Protect rProtect;
+   SEXP previousSaveDefaultsSEXP = R_NilValue;
+   error = r::exec::RFunction(".rs.disableSaveCompression").call(
+                                    &previousSaveDefaultsSEXP, &rProtect);
+   if (error)
+      LOG_ERROR(error);
 
    if (!excludePackages)
    {
@@ -383,6 +429,18 @@ bool save(const FilePath& statePath,
       }
    }
 
+   // restore the previous save defaults (see comment above)
+   if (!disableSaveCompression && previousSaveDefaultsSEXP != R_NilValue)
+   {
+      error = r::exec::RFunction(".rs.restoreSaveDefaults",
+                                 previousSaveDefaultsSEXP).call();
+      if (error)
+         LOG_ERROR(error);
+   }
+
+   // flush the settings in one write
+   settings.endUpdate();
+
    // return status
    return saved;
 }
@@ -396,6 +454,9 @@ bool saveMinimal(const core::FilePath& statePath,
    bool saved = true;
    initSaveContext(statePath, &settings, &saved);
 
+   // batch settings writes (see save above)
+   settings.beginUpdate();
+
    // set r profile on restore
    settings.set(kRProfileOnRestore, true);
 
@@ -424,7 +485,8 @@ bool saveMinimal(const core::FilePath& statePath,
       }
    }
 
-
+   // flush the settings in one write
+   settings.endUpdate();
 
    // return status
    return saved;
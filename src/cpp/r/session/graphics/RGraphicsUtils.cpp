@@ -150,13 +150,15 @@ bool validateRequirements(std::string* pMessage)
 
 std::string extraBitmapParams()
 {
+   std::string params;
+
 #if defined(_WIN32)
 
-   // no extra params for windows
+   // no platform-specific params for windows
 
 #elif defined(__APPLE__)
 
-   return ", type = \"quartz\", antialias=\"default\"";
+   params += ", type = \"quartz\", antialias=\"default\"";
 
 #else
 
@@ -166,13 +168,22 @@ std::string extraBitmapParams()
       if (r::util::hasRequiredVersion("2.14") &&
           r::util::hasCapability("cairo"))
       {
-         return ", type = \"cairo\"";
+         params += ", type = \"cairo\"";
       }
    }
 
 #endif
 
-   return "";
+   // append any user-specified device arguments (e.g. antialias or device
+   // type tuning for sessions generating many plots). arguments are passed
+   // through to the bitmap device verbatim, so only arguments supported by
+   // the grDevices version in use should be specified
+   std::string userParams = r::options::getOption<std::string>(
+                                    "rstudio.extraBitmapParams", "", false);
+   if (!userParams.empty())
+      params += ", " + userParams;
+
+   return params;
 }
 
 struct RestorePreviousGraphicsDeviceScope::Impl
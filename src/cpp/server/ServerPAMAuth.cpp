@@ -295,6 +295,39 @@ void setSignInCookies(const core::http::Request& request,
                             pResponse);
 }
 
+// bound on concurrent pam conversations. sign-ins run synchronously on the
+// server's i/o threads and a pam conversation can take seconds when the
+// directory service is slow, so never let sign-ins occupy the entire pool
+// and starve proxy traffic -- always leave at least one thread free
+boost::mutex s_pamLoginsMutex;
+int s_activePamLogins = 0;
+
+bool acquirePamLoginSlot()
+{
+   int maxLogins = std::max(1, server::options().wwwThreadPoolSize() - 1);
+   LOCK_MUTEX(s_pamLoginsMutex)
+   {
+      if (s_activePamLogins >= maxLogins)
+         return false;
+
+      s_activePamLogins++;
+      return true;
+   }
+   END_LOCK_MUTEX
+
+   // keep compiler happy
+   return false;
+}
+
+void releasePamLoginSlot()
+{
+   LOCK_MUTEX(s_pamLoginsMutex)
+   {
+      s_activePamLogins--;
+   }
+   END_LOCK_MUTEX
+}
+
 void doSignIn(const http::Request& request,
               http::Response* pResponse)
 {
@@ -352,7 +385,24 @@ void doSignIn(const http::Request& request,
 
    onUserUnauthenticated(username);
 
-   if ( pamLogin(username, password) && server::auth::validateUser(username))
+   // turn away sign-ins beyond the concurrency bound immediately (with a
+   // try-again message) rather than queueing them on an i/o thread
+   if (!acquirePamLoginSlot())
+   {
+      pResponse->setMovedTemporarily(
+            request,
+            applicationSignInURL(request,
+                                 appUri,
+                                 kErrorServer));
+      return;
+   }
+
+   bool authenticated = pamLogin(username, password) &&
+                        server::auth::validateUser(username);
+
+   releasePamLoginSlot();
+
+   if (authenticated)
    {
       if (appUri.size() > 0 && appUri[0] != '/')
          appUri = "/" + appUri;
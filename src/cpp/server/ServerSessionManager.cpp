@@ -167,6 +167,16 @@ SessionManager::SessionManager()
                                            this, _1, _2);
 }
 
+// NOTE: sessions are forked on demand rather than claimed from a pool of
+// pre-initialized template processes. a template session would have to run
+// R initialization before knowing its user, but nearly everything that
+// makes startup expensive is user-specific and happens before or during
+// that initialization: the PAM session (which can mount home directories),
+// the user's environment and .Rprofile, project and settings reads, and
+// the setuid itself (rsession must never execute user-influenced code
+// with root-initialized state in its address space). specializing after
+// init would either skip those steps or re-run them, forfeiting the
+// savings. launch latency work therefore belongs in rsession startup.
 Error SessionManager::launchSession(boost::asio::io_service& ioService,
       const r_util::SessionContext& context)
 {
@@ -582,12 +582,19 @@ void proxyRequest(
    boost::shared_ptr<http::LocalStreamAsyncClient> pClient(
     new http::LocalStreamAsyncClient(ptrConnection->ioService(), streamPath, false, uid));
 
+   // pool connections to the session so back-to-back rpc requests don't
+   // pay the connect handshake (and so concurrent requests to a single
+   // session are bounded by the pool's in-flight limit)
+   pClient->setConnectionPool(
+         http::LocalStreamSocketPool::forStreamPath(streamPath.absolutePath()));
+
    // setup retry context
    if (!connectionRetryProfile.empty())
       pClient->setConnectionRetryProfile(connectionRetryProfile);
 
-   // assign request
-   pClient->request().assign(ptrConnection->request());
+   // assign the request, taking ownership of its body -- uploads can be
+   // large and the connection's copy isn't consulted after the relay
+   pClient->request().assignWithSwappedBody(ptrConnection->mutableRequest());
 
    // call request filter if we have one
    if (s_proxyRequestFilter)
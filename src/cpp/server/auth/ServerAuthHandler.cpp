@@ -18,6 +18,7 @@
 
 #include <server/auth/ServerAuthHandler.hpp>
 
+#include <core/Thread.hpp>
 #include <core/json/JsonRpc.hpp>
 
 #include <server/ServerUriHandlers.hpp>
@@ -36,6 +37,12 @@ namespace {
 // global auth handler
 Handler s_handler;
 
+// cache of user identifier -> local username mappings. the conversion runs
+// on every authenticated request and can consult the directory service, so
+// remember results for identifiers which have already been authenticated.
+// the cache is dropped on sign-out and repopulated on the next request
+core::thread::ThreadsafeMap<std::string, std::string> s_localUsernameCache;
+
 void updateCredentialsNotSupported(
       boost::shared_ptr<core::http::AsyncConnection> pConnection)
 {
@@ -68,7 +75,15 @@ std::string getUserIdentifier(const core::http::Request& request)
 
 std::string userIdentifierToLocalUsername(const std::string& userIdentifier)
 {
-   return s_handler.userIdentifierToLocalUsername(userIdentifier);
+   if (s_localUsernameCache.contains(userIdentifier))
+      return s_localUsernameCache.get(userIdentifier);
+
+   std::string username = s_handler.userIdentifierToLocalUsername(
+                                                            userIdentifier);
+   if (!username.empty())
+      s_localUsernameCache.set(userIdentifier, username);
+
+   return username;
 }
 
 bool mainPageFilter(const core::http::Request& request,
@@ -99,9 +114,11 @@ void registerHandler(const Handler& handler)
    // register uri handlers
    uri_handlers::addBlocking(kSignIn, s_handler.signIn);
 
+   // route sign-out through our wrapper so cached identifier mappings
+   // are invalidated along with the credentials
    uri_handlers::addBlocking(kSignOut,
                              auth::secureHttpHandler(
-                                boost::bind(s_handler.signOut, _2, _3)));
+                                boost::bind(handler::signOut, _2, _3)));
 
    uri_handlers::add(kRefreshCredentialsAndContinue,
                      s_handler.refreshCredentialsThenContinue);
@@ -133,6 +150,10 @@ void setSignInCookies(const core::http::Request& request,
 
 void signOut(const http::Request& request, http::Response* pResponse)
 {
+   // drop cached identifier mappings so they are re-resolved (and thus
+   // re-validated against the directory) after the next sign-in
+   s_localUsernameCache.clear();
+
    s_handler.signOut(request, pResponse);
 }
 
@@ -17,12 +17,16 @@
 
 #include "modules/SessionConsole.hpp"
 
+#include <algorithm>
+
+#include <boost/bind.hpp>
 #include <boost/foreach.hpp>
 
 
 #include <core/BoostThread.hpp>
 #include <core/Thread.hpp>
 #include <core/json/Json.hpp>
+#include <core/SafeConvert.hpp>
 #include <core/StringUtils.hpp>
 
 #include <r/session/RConsoleActions.hpp>
@@ -34,8 +38,102 @@ namespace session {
  
 namespace {
 ClientEventQueue* s_pClientEventQueue = NULL;
+
+// idempotent full-state events -- the client renders only the most
+// recent one so earlier undelivered instances can be dropped
+// (replace-by-type)
+bool isReplaceByTypeEvent(int type)
+{
+   return type == client_events::kBusy ||
+          type == client_events::kWorkingDirChanged ||
+          type == client_events::kPlotsStateChanged ||
+          type == client_events::kSaveActionChanged;
+}
+
+bool hasEventType(const ClientEvent& event, int type)
+{
+   return event.type() == type;
+}
+
+// control events whose delivery must stay prompt regardless of how much
+// bulk output is queued (e.g. the busy indicator clearing after an
+// interrupt, or a modal prompt the user must answer). these are queued
+// in a separate lane which is delivered ahead of everything else; only
+// events whose rendering doesn't depend on ordering relative to console
+// output belong here
+bool isControlEvent(int type)
+{
+   return type == client_events::kBusy ||
+          type == client_events::kUserPrompt ||
+          type == client_events::kShowWarningBar;
+}
+
+// compile-output style events (payloads of the form {type, output})
+// which can be coalesced by appending their output text -- the analog
+// of the batching we already do for console output
+bool isAppendMergeEvent(int type)
+{
+   return type == client_events::kBuildOutput ||
+          type == client_events::kCompilePdfOutputEvent ||
+          type == client_events::kRmdRenderOutput;
+}
+
+// budget for the accumulated output of a merged bulk event -- bounds how
+// much text a runaway tool can queue between deliveries (console output
+// has its own cap in flushPendingConsoleOutput)
+const std::size_t kMaxMergedOutputBytes = 512 * 1024;
+
+// attempt to merge an event into the previous pending event of the
+// same type. succeeds only when both payloads are objects which agree
+// on every field other than their output text
+bool appendMergeEvent(const ClientEvent& event, ClientEvent* pLastEvent)
+{
+   if (event.type() != pLastEvent->type())
+      return false;
+
+   if (event.data().type() != json::ObjectType ||
+       pLastEvent->data().type() != json::ObjectType)
+   {
+      return false;
+   }
+
+   json::Object src = event.data().get_obj();
+   json::Object dst = pLastEvent->data().get_obj();
+   json::Object::const_iterator srcIt = src.find("output");
+   json::Object::const_iterator dstIt = dst.find("output");
+   if (srcIt == src.end() || dstIt == dst.end() ||
+       srcIt->second.type() != json::StringType ||
+       dstIt->second.type() != json::StringType)
+   {
+      return false;
+   }
+
+   // all other fields must match
+   std::string mergedOutput = dstIt->second.get_str() +
+                              srcIt->second.get_str();
+   src.erase("output");
+   dst.erase("output");
+   if (src != dst)
+      return false;
+
+   // enforce the bulk lane budget: drop the oldest text and note the
+   // elision (the tail is what the user needs to see)
+   if (mergedOutput.size() > kMaxMergedOutputBytes)
+   {
+      std::size_t dropped = mergedOutput.size() - kMaxMergedOutputBytes;
+      mergedOutput = "... (" +
+                     safe_convert::numberToString(dropped) +
+                     " characters of output dropped)\n" +
+                     mergedOutput.substr(dropped);
+   }
+
+   dst["output"] = mergedOutput;
+   *pLastEvent = ClientEvent(event.type(), dst);
+   return true;
 }
 
+} // anonymous namespace
+
 void initializeClientEventQueue()
 {
    BOOST_ASSERT(s_pClientEventQueue == NULL);
@@ -89,14 +187,50 @@ void ClientEventQueue::add(const ClientEvent& event)
          flushPendingConsoleOutput();
          enqueueClientOutputEvent(event.type(), event.data().get_str());
       }
+      else if (isControlEvent(event.type()))
+      {
+         // control events bypass the bulk/interactive lanes entirely --
+         // during an output flood they would otherwise queue behind
+         // megabytes of text (replace-by-type applies within the lane)
+         if (isReplaceByTypeEvent(event.type()))
+         {
+            controlEvents_.erase(std::remove_if(controlEvents_.begin(),
+                                                controlEvents_.end(),
+                                                boost::bind(hasEventType,
+                                                            _1,
+                                                            event.type())),
+                                 controlEvents_.end());
+         }
+         controlEvents_.push_back(event);
+      }
       else
       {
-         // flush existing console output prior to adding an 
+         // flush existing console output prior to adding an
          // action of another type
          flushPendingConsoleOutput() ;
-         
-         // add event to queue
-         pendingEvents_.push_back(event) ;
+
+         // drop any undelivered earlier instance of an idempotent
+         // state event (the client only renders the most recent one,
+         // and a tight loop can produce thousands of them between
+         // deliveries)
+         if (isReplaceByTypeEvent(event.type()))
+         {
+            pendingEvents_.erase(std::remove_if(pendingEvents_.begin(),
+                                                pendingEvents_.end(),
+                                                boost::bind(hasEventType,
+                                                            _1,
+                                                            event.type())),
+                                 pendingEvents_.end());
+         }
+
+         // merge adjacent output events of the same type, otherwise
+         // add the event to the queue
+         if (!(isAppendMergeEvent(event.type()) &&
+               !pendingEvents_.empty() &&
+               appendMergeEvent(event, &pendingEvents_.back())))
+         {
+            pendingEvents_.push_back(event) ;
+         }
       }
       
       lastEventAddTime_ = boost::posix_time::microsec_clock::universal_time();
@@ -111,7 +245,9 @@ bool ClientEventQueue::hasEvents()
 {
    LOCK_MUTEX(*pMutex_)
    {
-      return pendingEvents_.size() > 0 || pendingConsoleOutput_.length() > 0;
+      return controlEvents_.size() > 0 ||
+             pendingEvents_.size() > 0 ||
+             pendingConsoleOutput_.length() > 0;
    }
    END_LOCK_MUTEX
    
@@ -123,17 +259,24 @@ void ClientEventQueue::remove(std::vector<ClientEvent>* pEvents)
 {
    LOCK_MUTEX(*pMutex_)
    {
+      // control lane first so (e.g.) interrupt acknowledgments are
+      // processed by the client ahead of any bulk output
+      pEvents->insert(pEvents->end(),
+                      controlEvents_.begin(),
+                      controlEvents_.end());
+      controlEvents_.clear();
+
       // flush any pending output
       flushPendingConsoleOutput();
-      
+
       // copy the events to the caller
-      pEvents->insert(pEvents->begin(), 
-                      pendingEvents_.begin(), 
+      pEvents->insert(pEvents->end(),
+                      pendingEvents_.begin(),
                       pendingEvents_.end());
-   
+
       // clear pending events
       pendingEvents_.clear();
-   } 
+   }
    END_LOCK_MUTEX
 }
    
@@ -142,6 +285,7 @@ void ClientEventQueue::clear()
    LOCK_MUTEX(*pMutex_)
    {
       pendingConsoleOutput_.clear();
+      controlEvents_.clear();
       pendingEvents_.clear();
    }
    END_LOCK_MUTEX
@@ -194,14 +338,61 @@ void ClientEventQueue::flushPendingConsoleOutput()
       // truncate it to the amount that the client can show. Too much output
       // can overwhelm the client, causing it to become unresponsive.
       int limit = r::session::consoleActions().capacity() + 1;
-      string_utils::trimLeadingLines(limit, &pendingConsoleOutput_);
+      std::string trimmed;
+      string_utils::trimLeadingLines(limit, &pendingConsoleOutput_, &trimmed);
+
+      // spill the trimmed text to a scratch file rather than discarding
+      // it -- during (e.g.) a million-line print the overflow is often
+      // exactly the part the user wanted -- and note in-band where it
+      // went so the user can open it from the console
+      if (!trimmed.empty())
+      {
+         Error error = spillConsoleOutput(trimmed);
+         if (!error)
+         {
+            pendingConsoleOutput_.insert(
+               0,
+               "... (truncated console output written to " +
+               spilledOutputFile_.absolutePath() + ")");
+         }
+         else
+         {
+            LOG_ERROR(error);
+         }
+      }
 
-      enqueueClientOutputEvent(client_events::kConsoleWriteOutput, 
+      enqueueClientOutputEvent(client_events::kConsoleWriteOutput,
             pendingConsoleOutput_);
       pendingConsoleOutput_.clear() ;
    }
 }
 
+Error ClientEventQueue::spillConsoleOutput(const std::string& output)
+{
+   // create the spill file and open an append stream on first use --
+   // successive truncations append, so everything trimmed during the
+   // session lands in a single predictable place. we deliberately use
+   // a plain temp file here (rather than an R tempfile) since this can
+   // be called from any thread adding events to the queue
+   if (!pSpilledOutputStream_)
+   {
+      Error error = FilePath::tempFilePath(&spilledOutputFile_);
+      if (error)
+         return error;
+
+      error = spilledOutputFile_.open_w(&pSpilledOutputStream_);
+      if (error)
+         return error;
+   }
+
+   pSpilledOutputStream_->write(output.data(), output.size());
+   pSpilledOutputStream_->flush();
+   if (pSpilledOutputStream_->fail())
+      return systemError(boost::system::errc::io_error, ERROR_LOCATION);
+
+   return Success();
+}
+
 void ClientEventQueue::enqueueClientOutputEvent(
       int event, const std::string& text)
 {
@@ -23,7 +23,11 @@
 #include <boost/utility.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 
+#include <boost/shared_ptr.hpp>
+
 #include <core/BoostThread.hpp>
+#include <core/Error.hpp>
+#include <core/FilePath.hpp>
 
 #include <session/SessionClientEvent.hpp>
 
@@ -72,7 +76,9 @@ private:
    void flushPendingConsoleOutput();
 
    void enqueueClientOutputEvent(int event, const std::string& text);
- 
+
+   core::Error spillConsoleOutput(const std::string& output);
+
 private:
    // synchronization objects. heap based so they are never destructed
    // we don't want them destructed because in desktop mode we don't
@@ -85,10 +91,14 @@ private:
    // instance data
    std::string pendingConsoleOutput_ ;
    std::string activeConsole_;
-   std::vector<ClientEvent> pendingEvents_ ; 
+   std::vector<ClientEvent> controlEvents_ ;
+   std::vector<ClientEvent> pendingEvents_ ;
    boost::posix_time::ptime lastEventAddTime_;
-   
 
+   // scratch file receiving console output which exceeds the client
+   // delivery budget (created lazily on first truncation)
+   core::FilePath spilledOutputFile_;
+   boost::shared_ptr<std::ostream> pSpilledOutputStream_;
 };
 
 } // namespace session
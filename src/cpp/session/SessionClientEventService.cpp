@@ -14,8 +14,10 @@
  */
 
 #include <algorithm>
+#include <sstream>
 
 #include <boost/function.hpp>
+#include <boost/algorithm/string/predicate.hpp>
 
 #include <core/BoostThread.hpp>
 #include <core/Log.hpp>
@@ -27,6 +29,8 @@
 
 
 #include <core/http/Request.hpp>
+#include <core/http/Response.hpp>
+#include <core/http/SocketUtils.hpp>
 
 #include <session/SessionOptions.hpp>
 #include <session/SessionHttpConnectionListener.hpp>
@@ -184,10 +188,145 @@ void ClientEventService::setClientEventResult(
 }
 
 
+std::string ClientEventService::pendingEventsAsFrame(int* pLastEventId)
+{
+   LOCK_MUTEX(mutex_)
+   {
+      if (clientEvents_.empty())
+         return std::string();
+
+      // the id field allows the client to resume from the right place
+      // (via Last-Event-ID) when it reconnects after a dropped stream
+      const json::Object& lastEvent = clientEvents_.back().get_obj();
+      *pLastEventId = lastEvent.find("id")->second.get_int();
+
+      // json events never contain raw newlines so the entire batch
+      // fits in a single data line
+      std::ostringstream ostr;
+      ostr << "id: " << *pLastEventId << "\n";
+      ostr << "data: ";
+      json::write(clientEvents_, ostr);
+      ostr << "\n\n";
+      return ostr.str();
+   }
+   END_LOCK_MUTEX
+
+   // keep compiler happy
+   return std::string();
+}
+
+bool ClientEventService::streamEvents(
+                           boost::shared_ptr<HttpConnection> ptrConnection,
+                           int* pNextEventId,
+                           bool* pInterrupted)
+{
+   using namespace boost::posix_time;
+
+   // streams deliver each batch as it occurs so we use only the short
+   // coalescing delay (there is no long-poll style maximum request
+   // time -- an idle stream just emits periodic keep-alive comments so
+   // both sides can detect a half-open connection)
+   time_duration batchDelay = milliseconds(20);
+   time_duration keepAliveInterval = seconds(10);
+   if (options().programMode() == kSessionProgramModeDesktop)
+      batchDelay = milliseconds(2);
+
+   // begin the server-sent event stream (if the connection type doesn't
+   // support streaming then return false so the caller can fall back
+   // to servicing this request as a standard long-poll)
+   http::Response response;
+   response.setNoCacheHeaders();
+   response.setContentType("text/event-stream");
+   Error error = ptrConnection->beginEventStream(response);
+   if (error)
+      return false;
+
+   // get alias to client event queue
+   ClientEventQueue& clientEventQueue = session::clientEventQueue();
+
+   while (true)
+   {
+      // wait for the next event
+      bool haveEvents = false;
+      try
+      {
+         haveEvents = havePendingClientEvents() ||
+                      clientEventQueue.hasEvents() ||
+                      clientEventQueue.waitForEvent(keepAliveInterval);
+
+         // wait for additional events that occur in rapid succession
+         if (haveEvents)
+         {
+            while (clientEventQueue.waitForEvent(batchDelay))
+            {
+            }
+         }
+      }
+      catch(const boost::thread_interrupted&)
+      {
+         // stop streaming -- but still flush any final events (e.g.
+         // the quit event) before we go
+         *pInterrupted = true;
+         haveEvents = havePendingClientEvents() ||
+                      clientEventQueue.hasEvents();
+      }
+
+      // build the frame
+      std::string frame;
+      int lastEventId = -1;
+      if (haveEvents)
+      {
+         // deque the events, convert to json, and add to our list
+         std::vector<ClientEvent> events;
+         clientEventQueue.remove(&events);
+         for (std::vector<ClientEvent>::const_iterator
+              it = events.begin(); it != events.end(); ++it)
+         {
+            json::Object event;
+            it->asJsonObject((*pNextEventId)++, &event);
+            addClientEvent(event);
+         }
+
+         frame = pendingEventsAsFrame(&lastEventId);
+      }
+
+      // keep-alive comment frame when there is nothing to deliver
+      if (frame.empty())
+         frame = ": keepalive\n\n";
+
+      // write it -- a failed write means the client is gone (its
+      // events remain in our list for redelivery when it reconnects)
+      error = ptrConnection->writeEventStreamData(frame);
+      if (error)
+      {
+         if (!http::isConnectionTerminatedError(error))
+            LOG_ERROR(error);
+         break;
+      }
+
+      // the write succeeded so consider the events delivered
+      if (lastEventId != -1)
+         erasePreviouslyDeliveredEvents(lastEventId);
+
+      if (*pInterrupted)
+         break;
+   }
+
+   ptrConnection->close();
+   return true;
+}
+
+// NOTE: the event service is strictly single-consumer: one client id is
+// active at a time and events are delivered over a single long-poll or
+// event-stream connection (satellite windows receive their events from
+// the main window on the client side, not via connections of their own).
+// a request bearing any other client id is rejected with InvalidClientId.
+// each event batch is therefore serialized exactly once per delivery --
+// there is no per-window fan-out which could share a serialized buffer
 void ClientEventService::run()
 {
    try
-   {    
+   {
       // default time durations
       using namespace boost::posix_time;
       time_duration maxRequestSec = seconds(50);
@@ -284,6 +423,24 @@ void ClientEventService::run()
          // would never see any events!)
          nextEventId = std::max(nextEventId, lastClientEventIdSeen + 1);
 
+         // if the client requested a server-sent event stream then hand
+         // the connection to the streaming loop (it returns when the
+         // client disconnects or the thread is interrupted). if the
+         // connection type doesn't support streaming then fall through
+         // and service this request as a standard long-poll
+         if (boost::algorithm::icontains(
+                  ptrConnection->request().headerValue("Accept"),
+                  "text/event-stream"))
+         {
+            bool interrupted = false;
+            if (streamEvents(ptrConnection, &nextEventId, &interrupted))
+            {
+               if (interrupted)
+                  stopServer = true;
+               continue;
+            }
+         }
+
          // check for events (and wait a specified internal if there are none)
          try
          {
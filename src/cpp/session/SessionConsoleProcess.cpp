@@ -50,6 +50,12 @@ namespace {
 
 const int kDefaultMaxOutputLines = 500;
 
+// minimum interval between console process output events. output arriving
+// faster than this is batched and delivered as a single event (each event
+// is trimmed to the line count the client can show anyway, so batching
+// drops only output that would never be rendered)
+const int kOutputEventIntervalMs = 150;
+
 ConsoleProcess::ConsoleProcess()
    : dialog_(false), showOnOutput_(false), interactionMode_(InteractionNever),
      maxOutputLines_(kDefaultMaxOutputLines), started_(true),
@@ -212,6 +218,17 @@ bool ConsoleProcess::onContinue(core::system::ProcessOperations& ops)
    if (interrupt_)
       return false;
 
+   // deliver output batched during a previous burst once its delivery
+   // interval has elapsed
+   using namespace boost::posix_time;
+   if (!pendingOutput_.empty() &&
+       (lastOutputEventTime_.is_not_a_date_time() ||
+        microsec_clock::universal_time() >=
+           lastOutputEventTime_ + milliseconds(kOutputEventIntervalMs)))
+   {
+      flushPendingOutput();
+   }
+
    // process input queue
    while (!inputQueue_.empty())
    {
@@ -262,16 +279,57 @@ void ConsoleProcess::enqueOutputEvent(const std::string &output, bool error)
    // copy to output buffer
    appendToOutputBuffer(output);
 
+   // error output is sent immediately (flush pending standard output
+   // first so relative ordering is preserved)
+   if (error)
+   {
+      flushPendingOutput();
+
+      std::string trimmedOutput = output;
+      string_utils::trimLeadingLines(maxOutputLines_, &trimmedOutput);
+
+      json::Object data;
+      data["handle"] = handle_;
+      data["error"] = true;
+      data["output"] = trimmedOutput;
+      module_context::enqueClientEvent(
+            ClientEvent(client_events::kConsoleProcessOutput, data));
+      return;
+   }
+
+   // batch the output; if we are within the delivery interval then leave
+   // it pending (it is flushed by the next poll tick, a prompt, or exit)
+   pendingOutput_.append(output);
+
+   using namespace boost::posix_time;
+   if (!lastOutputEventTime_.is_not_a_date_time() &&
+       microsec_clock::universal_time() <
+          lastOutputEventTime_ + milliseconds(kOutputEventIntervalMs))
+   {
+      return;
+   }
+
+   flushPendingOutput();
+}
+
+void ConsoleProcess::flushPendingOutput()
+{
+   if (pendingOutput_.empty())
+      return;
+
+   std::string output;
+   output.swap(pendingOutput_);
+   lastOutputEventTime_ = boost::posix_time::microsec_clock::universal_time();
+
    // If there's more output than the client can even show, then
    // truncate it to the amount that the client can show. Too much
    // output can overwhelm the client, making it unresponsive.
-   std::string trimmedOutput = output;
-   string_utils::trimLeadingLines(maxOutputLines_, &trimmedOutput);
+   string_utils::trimLeadingLines(maxOutputLines_, &output);
 
    json::Object data;
    data["handle"] = handle_;
-   data["error"] = error;
-   data["output"] = trimmedOutput;
+   data["error"] = false;
+   data["output"] = output;
    module_context::enqueClientEvent(
          ClientEvent(client_events::kConsoleProcessOutput, data));
 }
@@ -327,6 +385,9 @@ void ConsoleProcess::maybeConsolePrompt(core::system::ProcessOperations& ops,
 void ConsoleProcess::handleConsolePrompt(core::system::ProcessOperations& ops,
                                          const std::string& prompt)
 {
+   // deliver any batched output before the prompt so it arrives in order
+   flushPendingOutput();
+
    // if there is a custom prmopt handler then give it a chance to
    // handle the prompt first
    if (onPrompt_)
@@ -360,6 +421,9 @@ void ConsoleProcess::handleConsolePrompt(core::system::ProcessOperations& ops,
 
 void ConsoleProcess::onExit(int exitCode)
 {
+   // deliver any remaining batched output ahead of the exit event
+   flushPendingOutput();
+
    exitCode_.reset(exitCode);
 
    json::Object data;
@@ -44,6 +44,12 @@
 #include <core/FilePath.hpp>
 #include <core/FileLock.hpp>
 #include <core/Exec.hpp>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include <core/PerformanceTimer.hpp>
+#include <core/SafeConvert.hpp>
 #include <core/Scope.hpp>
 #include <core/Settings.hpp>
 #include <core/Thread.hpp>
@@ -103,6 +109,8 @@ extern "C" const char *locale2charset(const char *);
 
 #include "SessionClientEventQueue.hpp"
 
+#include "http/SessionHttpConnectionUtils.hpp"
+
 #include <session/SessionRUtil.hpp>
 
 #include "modules/SessionAbout.hpp"
@@ -152,6 +160,7 @@ extern "C" const char *locale2charset(const char *);
 #include "modules/viewer/SessionViewer.hpp"
 #include "modules/SessionDiagnostics.hpp"
 #include "modules/SessionMarkers.hpp"
+#include "modules/SessionMemoryTelemetry.hpp"
 #include "modules/SessionSnippets.hpp"
 #include "modules/SessionUserCommands.hpp"
 #include "modules/SessionRAddins.hpp"
@@ -200,7 +209,67 @@ http::UriHandlerFunction s_defaultUriHandler;
 
 // json rpc methods
 core::json::JsonRpcAsyncMethods s_jsonRpcMethods;
-   
+
+// per-method execution statistics for rpc methods registered through
+// registerRpcMethod (updated by instrumentedRpcMethod, reported by the
+// get_rpc_method_stats diagnostics rpc)
+struct RpcMethodStats
+{
+   RpcMethodStats()
+      : count(0), totalTimeMs(0), maxTimeMs(0)
+   {
+      std::fill(histogram, histogram + 5, 0.0);
+   }
+   double count;
+   double totalTimeMs;
+   double maxTimeMs;
+   // latency buckets: <1ms, <10ms, <100ms, <1s, >=1s
+   double histogram[5];
+};
+
+boost::mutex s_rpcMethodStatsMutex;
+std::map<std::string, RpcMethodStats> s_rpcMethodStats;
+
+void recordRpcMethodExecution(const std::string& name, double timeMs)
+{
+   LOCK_MUTEX(s_rpcMethodStatsMutex)
+   {
+      RpcMethodStats& stats = s_rpcMethodStats[name];
+      stats.count++;
+      stats.totalTimeMs += timeMs;
+      stats.maxTimeMs = std::max(stats.maxTimeMs, timeMs);
+
+      int bucket;
+      if (timeMs < 1)
+         bucket = 0;
+      else if (timeMs < 10)
+         bucket = 1;
+      else if (timeMs < 100)
+         bucket = 2;
+      else if (timeMs < 1000)
+         bucket = 3;
+      else
+         bucket = 4;
+      stats.histogram[bucket]++;
+   }
+   END_LOCK_MUTEX
+}
+
+core::Error instrumentedRpcMethod(
+                           const std::string& name,
+                           const core::json::JsonRpcFunction& function,
+                           const core::json::JsonRpcRequest& request,
+                           core::json::JsonRpcResponse* pResponse)
+{
+   using namespace boost::posix_time;
+   ptime startTime = microsec_clock::universal_time();
+   core::Error error = function(request, pResponse);
+   time_duration duration = microsec_clock::universal_time() - startTime;
+   recordRpcMethodExecution(name, duration.total_microseconds() / 1000.0);
+   return error;
+}
+
+
 // R browseUrl handlers
 std::vector<module_context::RBrowseUrlHandler> s_rBrowseUrlHandlers;
    
@@ -277,10 +346,24 @@ void handleUSR2(int unused)
    // set the r interrupt flag (always)
    rstudio::r::exec::setInterruptsPending(true);
 
-   // note that a suspend is being forced. 
+   // note that a suspend is being forced.
    s_forceSuspend = 1;
 }
 
+// out-of-band interrupt notification -- invoked on the listener thread
+// as soon as an interrupt rpc arrives (see connection::notifyIfInterrupt)
+// so the interrupt takes effect even when the main connection queue is
+// backed up. setting the interrupt flag is the same single-word write
+// the USR2 signal handler above performs. the rpc itself is still
+// queued and processed on the foreground as usual
+void notifyInterruptArrived()
+{
+   // only accept interrupts while R is processing input (same guard
+   // as the foreground handler)
+   if (s_rProcessingInput)
+      rstudio::r::exec::setInterruptsPending(true);
+}
+
 // version of the executable -- this is the legacy version designator. we
 // set it to double max so that it always invalidates legacy clients
 double s_version = std::numeric_limits<double>::max();
@@ -803,32 +886,286 @@ void endHandleRpcRequestIndirect(
    module_context::enqueClientEvent(evt);
 }
 
+// speculative rpc prefetch -- some rpcs are reliably followed by further
+// rpcs whose content is fully determined by the trigger (e.g. opening a
+// document). modules register builders via registerRpcPrefetch; when a
+// trigger method completes we execute the predicted follow-ups at idle
+// time and cache their responses briefly, so the client's matching
+// request is answered immediately instead of re-executing the handler
+std::multimap<std::string, module_context::RpcPrefetchBuilderFunction>
+                                                        s_rpcPrefetchBuilders;
+
+struct SpeculativeResponse
+{
+   json::JsonRpcResponse response;
+   boost::posix_time::ptime createdAt;
+};
+std::map<std::string, SpeculativeResponse> s_speculativeResponses;
+
+// speculated responses are served only briefly -- the session state the
+// handler consulted can drift, so anything the client doesn't claim
+// promptly is discarded
+const int kSpeculativeResponseTtlSeconds = 5;
+
+std::string speculativeResponseKey(const json::JsonRpcRequest& request)
+{
+   std::ostringstream ostr;
+   ostr << request.method << "\n";
+   json::write(json::Value(request.params), ostr);
+   return ostr.str();
+}
+
+// continuation used to capture a speculatively executed rpc's outcome
+void captureSpeculativeRpcResponse(json::JsonRpcResponse* pCapturedResponse,
+                                   core::Error* pCapturedError,
+                                   const core::Error& executeError,
+                                   json::JsonRpcResponse* pJsonRpcResponse)
+{
+   *pCapturedError = executeError;
+   if (!executeError && pJsonRpcResponse != NULL)
+      *pCapturedResponse = *pJsonRpcResponse;
+}
+
+void executeSpeculativeRpc(const json::JsonRpcRequest& request)
+{
+   json::JsonRpcAsyncMethods::const_iterator it =
+                                       s_jsonRpcMethods.find(request.method);
+   if (it == s_jsonRpcMethods.end() || !it->second.first)
+      return;
+
+   SpeculativeResponse speculative;
+   speculative.createdAt = boost::posix_time::microsec_clock::universal_time();
+   Error executeError;
+   it->second.second(request,
+                     boost::bind(captureSpeculativeRpcResponse,
+                                 &speculative.response,
+                                 &executeError,
+                                 _1,
+                                 _2));
+
+   // cache only clean direct responses; if the handler failed (or has an
+   // after-response side effect keyed to response delivery) let the real
+   // request execute normally
+   if (executeError)
+      return;
+   if (speculative.response.hasAfterResponse())
+   {
+      speculative.response.runAfterResponse();
+      return;
+   }
+
+   s_speculativeResponses[speculativeResponseKey(request)] = speculative;
+}
+
+void endHandleRpcRequestDirectWithPrefetch(
+      boost::shared_ptr<HttpConnection> ptrConnection,
+      boost::posix_time::ptime executeStartTime,
+      const json::JsonRpcRequest& request,
+      const core::Error& executeError,
+      json::JsonRpcResponse* pJsonRpcResponse)
+{
+   // respond to the client first -- speculation must never delay the
+   // trigger rpc itself
+   endHandleRpcRequestDirect(ptrConnection,
+                             executeStartTime,
+                             executeError,
+                             pJsonRpcResponse);
+
+   if (executeError || pJsonRpcResponse == NULL)
+      return;
+
+   // offer the trigger request/response to each registered builder and
+   // schedule idle-time execution of any follow-ups they predict
+   json::Object responseJson = pJsonRpcResponse->getRawResponse();
+   std::pair<std::multimap<std::string,
+                   module_context::RpcPrefetchBuilderFunction>::const_iterator,
+             std::multimap<std::string,
+                   module_context::RpcPrefetchBuilderFunction>::const_iterator>
+         range = s_rpcPrefetchBuilders.equal_range(request.method);
+   for ( ; range.first != range.second; ++range.first)
+   {
+      json::JsonRpcRequest prefetchRequest;
+      if (range.first->second(request, responseJson, &prefetchRequest))
+      {
+         prefetchRequest.sourceWindow = request.sourceWindow;
+         prefetchRequest.clientId = request.clientId;
+         prefetchRequest.version = request.version;
+         prefetchRequest.clientVersion = request.clientVersion;
+
+         // execute as a background connection so speculative execution
+         // doesn't trigger client-visible change detection
+         prefetchRequest.isBackgroundConnection = true;
+
+         module_context::scheduleDelayedWork(
+                  boost::posix_time::milliseconds(20),
+                  boost::bind(executeSpeculativeRpc, prefetchRequest),
+                  true); // require idle
+      }
+   }
+}
+
+// continuation used to capture a batched sub-request's response in place
+void endBatchedRpcRequest(json::JsonRpcResponse* pCapturedResponse,
+                          const core::Error& executeError,
+                          json::JsonRpcResponse* pJsonRpcResponse)
+{
+   if (executeError)
+      pCapturedResponse->setError(executeError);
+   else if (pJsonRpcResponse != NULL)
+      *pCapturedResponse = *pJsonRpcResponse;
+}
+
+// execute an array of json-rpc requests in a single http round trip and
+// event-loop pass. the client can use this to coalesce bursts of related
+// rpcs (e.g. the state-fetching calls fired at IDE startup) into one
+// request so high-latency connections pay for a single round trip rather
+// than one per call. each entry is a {method, params} object and the
+// result is an array of raw response objects in the same order. only
+// direct-return methods can participate -- async-handle methods and
+// nested batches yield an error entry (the batch itself still succeeds)
+Error executeBatch(const json::JsonRpcRequest& request,
+                   json::JsonRpcResponse* pResponse)
+{
+   json::Array requestsJson;
+   Error error = json::readParams(request.params, &requestsJson);
+   if (error)
+      return error;
+
+   json::Array responsesJson;
+   BOOST_FOREACH(const json::Value& valueJson, requestsJson)
+   {
+      // parse the sub-request (inheriting the connection context of the
+      // batch request, which was already validated)
+      json::JsonRpcRequest subRequest;
+      subRequest.sourceWindow = request.sourceWindow;
+      subRequest.clientId = request.clientId;
+      subRequest.version = request.version;
+      subRequest.clientVersion = request.clientVersion;
+      subRequest.isBackgroundConnection = request.isBackgroundConnection;
+
+      json::JsonRpcResponse subResponse;
+      Error subError;
+      if (json::isType<json::Object>(valueJson))
+      {
+         json::Object requestJson = valueJson.get_obj();
+         subError = json::readObject(requestJson,
+                                     "method", &subRequest.method,
+                                     "params", &subRequest.params);
+      }
+      else
+      {
+         subError = Error(json::errc::InvalidRequest, ERROR_LOCATION);
+      }
+
+      if (!subError)
+      {
+         json::JsonRpcAsyncMethods::const_iterator it =
+                                    s_jsonRpcMethods.find(subRequest.method);
+         if (it == s_jsonRpcMethods.end() ||
+             !it->second.first ||                  // async-handle method
+             subRequest.method == "execute_batch") // no nested batches
+         {
+            subError = Error(json::errc::MethodNotFound, ERROR_LOCATION);
+            subError.addProperty("method", subRequest.method);
+         }
+         else
+         {
+            // time each method individually, just as if it had been
+            // dispatched as its own request
+            std::string rpcSection = "rpc." + subRequest.method;
+            core::ScopedPerformanceTimer timer(rpcSection.c_str());
+            it->second.second(subRequest,
+                              boost::bind(endBatchedRpcRequest,
+                                          &subResponse, _1, _2));
+         }
+      }
+
+      if (subError)
+         subResponse.setError(subError);
+
+      // after-response handlers normally run once the response is on the
+      // wire; for batched sub-requests run them before the next entry so
+      // later entries observe their effects
+      if (subResponse.hasAfterResponse())
+         subResponse.runAfterResponse();
+
+      responsesJson.push_back(subResponse.getRawResponse());
+   }
+
+   pResponse->setResult(responsesJson);
+   return Success();
+}
+
 void handleRpcRequest(const core::json::JsonRpcRequest& request,
                       boost::shared_ptr<HttpConnection> ptrConnection,
                       ConnectionType connectionType)
 {
    // record the time just prior to execution of the event
    // (so we can determine if any events were added during execution)
-   using namespace boost::posix_time; 
+   using namespace boost::posix_time;
    ptime executeStartTime = microsec_clock::universal_time();
-   
+
+   // time the handler (this also publishes the method as the main
+   // thread's current activity for the event loop watchdog)
+   std::string rpcSection = "rpc." + request.method;
+   core::ScopedPerformanceTimer timer(rpcSection.c_str());
+
+   // serve a speculatively computed response if we have a fresh one for
+   // exactly this request; any other rpc invalidates outstanding
+   // speculation, since its handler may change the state the speculated
+   // responses were computed from
+   if (!s_speculativeResponses.empty())
+   {
+      std::map<std::string, SpeculativeResponse>::iterator specIt =
+                 s_speculativeResponses.find(speculativeResponseKey(request));
+      if (specIt != s_speculativeResponses.end() &&
+          (executeStartTime - specIt->second.createdAt) <
+              boost::posix_time::seconds(kSpeculativeResponseTtlSeconds))
+      {
+         json::JsonRpcResponse response = specIt->second.response;
+         s_speculativeResponses.erase(specIt);
+         endHandleRpcRequestDirect(ptrConnection,
+                                   executeStartTime,
+                                   Success(),
+                                   &response);
+         return;
+      }
+      s_speculativeResponses.clear();
+   }
+
    // execute the method
    json::JsonRpcAsyncMethods::const_iterator it =
                                      s_jsonRpcMethods.find(request.method);
    if (it != s_jsonRpcMethods.end())
    {
-      std::pair<bool, json::JsonRpcAsyncFunction> reg = it->second;
-      json::JsonRpcAsyncFunction handlerFunction = reg.second;
+      // reference the registration in place -- copying the boost::function
+      // would allocate on every rpc request
+      const std::pair<bool, json::JsonRpcAsyncFunction>& reg = it->second;
+      const json::JsonRpcAsyncFunction& handlerFunction = reg.second;
 
       if (reg.first)
       {
-         // direct return
-         handlerFunction(request,
-                         boost::bind(endHandleRpcRequestDirect,
-                                     ptrConnection,
-                                     executeStartTime,
-                                     _1,
-                                     _2));
+         // direct return (scheduling speculative prefetch of predicted
+         // follow-on rpcs when any are registered for this method)
+         if (s_rpcPrefetchBuilders.count(request.method) > 0)
+         {
+            handlerFunction(request,
+                            boost::bind(endHandleRpcRequestDirectWithPrefetch,
+                                        ptrConnection,
+                                        executeStartTime,
+                                        request,
+                                        _1,
+                                        _2));
+         }
+         else
+         {
+            handlerFunction(request,
+                            boost::bind(endHandleRpcRequestDirect,
+                                        ptrConnection,
+                                        executeStartTime,
+                                        _1,
+                                        _2));
+         }
       }
       else
       {
@@ -1190,6 +1527,146 @@ void setupForkHandlers()
 }
 #endif
 
+// event loop watchdog: the main thread records a heartbeat each time it
+// passes through waitForMethod or the polled event handler; a background
+// thread logs a stall report -- attributed to the main thread's current
+// activity (see core::currentActivity) -- whenever the heartbeat goes
+// stale, and a recovery message when it resumes
+boost::mutex s_heartbeatMutex;
+boost::posix_time::ptime s_lastHeartbeat;
+
+void eventLoopHeartbeat()
+{
+   LOCK_MUTEX(s_heartbeatMutex)
+   {
+      s_lastHeartbeat = boost::posix_time::microsec_clock::universal_time();
+   }
+   END_LOCK_MUTEX
+}
+
+void eventLoopWatchdog()
+{
+   using namespace boost::posix_time;
+
+   // stall threshold (seconds, overridable for support diagnostics)
+   int thresholdSeconds = safe_convert::stringTo<int>(
+            core::system::getenv("RSTUDIO_SESSION_STALL_THRESHOLD"), 10);
+   if (thresholdSeconds < 1)
+      thresholdSeconds = 1;
+
+   bool stallReported = false;
+   while (true)
+   {
+      boost::this_thread::sleep(seconds(1));
+
+      // read the heartbeat (not yet set means the loop hasn't started)
+      ptime lastHeartbeat;
+      LOCK_MUTEX(s_heartbeatMutex)
+      {
+         lastHeartbeat = s_lastHeartbeat;
+      }
+      END_LOCK_MUTEX
+      if (lastHeartbeat.is_not_a_date_time())
+         continue;
+
+      time_duration lag = microsec_clock::universal_time() - lastHeartbeat;
+      if (lag.total_seconds() >= thresholdSeconds)
+      {
+         // report each stall episode once, attributed to whatever the
+         // main thread is currently executing
+         if (!stallReported)
+         {
+            stallReported = true;
+
+            std::string activity = "R code or other uninstrumented activity";
+            std::string section;
+            ptime activityStart;
+            if (core::currentActivity(&section, &activityStart))
+            {
+               long activeSeconds = (microsec_clock::universal_time() -
+                                     activityStart).total_seconds();
+               activity = section + " (active for " +
+                          safe_convert::numberToString(activeSeconds) +
+                          " seconds)";
+            }
+
+            LOG_WARNING_MESSAGE(
+               "session event loop stalled for " +
+               safe_convert::numberToString(lag.total_seconds()) +
+               " seconds; executing: " + activity);
+         }
+      }
+      else if (stallReported)
+      {
+         stallReported = false;
+         LOG_INFO_MESSAGE("session event loop recovered");
+      }
+   }
+}
+
+// tiered idle state shedding: sessions which are idle but not yet
+// eligible for suspend hold a lot of reclaimable memory. after a period
+// without client activity (and without R executing) we drop
+// reconstructible caches via the onMemoryPressure event (clang
+// translation units, unused notebook caches); after a longer period we
+// additionally run a full R gc and return freed allocator pages to the
+// operating system. all of this state is touched from the main thread
+// only (waitForMethod, the polled event handler, and idle periodic work)
+boost::posix_time::ptime s_lastClientActivity;
+bool s_droppedIdleCaches = false;
+bool s_releasedIdleMemory = false;
+
+void recordClientActivity()
+{
+   s_lastClientActivity = boost::posix_time::second_clock::universal_time();
+   s_droppedIdleCaches = false;
+   s_releasedIdleMemory = false;
+}
+
+bool checkIdleStateShedding()
+{
+   using namespace boost::posix_time;
+
+   // idle tier thresholds in minutes (0 disables a tier)
+   static int s_shedCachesMinutes = safe_convert::stringTo<int>(
+         core::system::getenv("RSTUDIO_SESSION_IDLE_SHED_MINUTES"), 5);
+   static int s_releaseMemoryMinutes = safe_convert::stringTo<int>(
+         core::system::getenv("RSTUDIO_SESSION_IDLE_RELEASE_MINUTES"), 15);
+
+   if (s_lastClientActivity.is_not_a_date_time())
+      return true;
+
+   long idleMinutes = (second_clock::universal_time() -
+                       s_lastClientActivity).total_seconds() / 60;
+
+   // first tier: drop caches which can be rebuilt on demand
+   if (!s_droppedIdleCaches &&
+       s_shedCachesMinutes > 0 &&
+       idleMinutes >= s_shedCachesMinutes)
+   {
+      s_droppedIdleCaches = true;
+      module_context::events().onMemoryPressure();
+   }
+
+   // second tier: collect the R heap and return freed allocator pages
+   // to the operating system
+   if (!s_releasedIdleMemory &&
+       s_releaseMemoryMinutes > 0 &&
+       idleMinutes >= s_releaseMemoryMinutes)
+   {
+      s_releasedIdleMemory = true;
+      Error error = rstudio::r::exec::executeString(
+                                          "invisible(base::gc(FALSE))");
+      if (error)
+         LOG_ERROR(error);
+#ifdef __GLIBC__
+      ::malloc_trim(0);
+#endif
+   }
+
+   return true;
+}
+
 void polledEventHandler()
 {
    // if R is getting called after a fork this is likely multicore or
@@ -1205,6 +1682,12 @@ void polledEventHandler()
       return;
    }
 
+   // record that the event loop is alive (even if we throttle below).
+   // we only get here while R is executing, which also counts as
+   // activity for idle state shedding
+   eventLoopHeartbeat();
+   recordClientActivity();
+
    // static lastPerformed value used for throttling
    using namespace boost::posix_time;
    static ptime s_lastPerformed;
@@ -1413,6 +1896,9 @@ bool waitForMethod(const std::string& method,
    // wait until we get the method we are looking for
    while(true)
    {
+      // record that the event loop is alive
+      eventLoopHeartbeat();
+
       // suspend if necessary (does not return if a suspend occurs)
       suspendIfRequested(allowSuspend);
 
@@ -1487,6 +1973,9 @@ bool waitForMethod(const std::string& method,
          // since we got a connection we can reset the timeout time
          timeoutTime = timeoutTimeFromNow();
 
+         // a connection is also client activity for idle state shedding
+         recordClientActivity();
+
          // after we've processed at least one waitForMethod it is now safe to
          // initialize the polledEventHandler (which is used to maintain rsession
          // responsiveness even when R is executing code received at the console).
@@ -1633,9 +2122,49 @@ Error ping(const core::json::JsonRpcRequest& request,
    return Success();
 }
 
+// diagnostics rpc: report per-method call counts and latency for every
+// rpc method registered through registerRpcMethod
+Error getRpcMethodStats(const core::json::JsonRpcRequest& request,
+                        json::JsonRpcResponse* pResponse)
+{
+   json::Object statsJson;
+   LOCK_MUTEX(s_rpcMethodStatsMutex)
+   {
+      for (std::map<std::string, RpcMethodStats>::const_iterator it =
+              s_rpcMethodStats.begin(); it != s_rpcMethodStats.end(); ++it)
+      {
+         const RpcMethodStats& stats = it->second;
+         json::Object methodJson;
+         methodJson["count"] = stats.count;
+         methodJson["total_time_ms"] = stats.totalTimeMs;
+         methodJson["max_time_ms"] = stats.maxTimeMs;
+         json::Array histogramJson;
+         for (int i = 0; i < 5; i++)
+            histogramJson.push_back(stats.histogram[i]);
+         methodJson["latency_histogram"] = histogramJson;
+         statsJson[it->first] = methodJson;
+      }
+   }
+   END_LOCK_MUTEX
+
+   pResponse->setResult(statsJson);
+   return Success();
+}
+
 
 Error startHttpConnectionListener()
 {
+   // route interrupt rpcs to the out-of-band fast path (must be
+   // registered before the listener thread launches)
+   connection::setInterruptNotifyHandler(notifyInterruptArrived);
+
+   // admission control for staleness-prone rpcs: when a backlog drains
+   // after R has been busy only the newest queued ask for each of
+   // these methods is serviced (older ones are answered immediately,
+   // and the client's invalidation tokens discard those replies)
+   HttpConnectionQueue::registerSupersededMethod("get_completions");
+   HttpConnectionQueue::registerSupersededMethod("lint_r_source_document");
+
    initializeHttpConnectionListener();
    return httpConnectionListener().start();
 }
@@ -1778,96 +2307,101 @@ Error rInit(const rstudio::r::session::RInitInfo& rInitInfo)
       // json-rpc listeners
       (bind(registerRpcMethod, kConsoleInput, bufferConsoleInput))
       (bind(registerRpcMethod, "suspend_for_restart", suspendForRestart))
-      (bind(registerRpcMethod, "ping", ping))
+      (bind(registerThreadSafeRpcMethod, "ping", ping))
+      (bind(registerRpcMethod, "execute_batch", executeBatch))
+      (bind(registerRpcMethod, "get_rpc_method_stats", getRpcMethodStats))
 
       // signal handlers
       (registerSignalHandlers)
 
       // main module context
-      (module_context::initialize)
+      ("init.module_context", module_context::initialize)
 
       // projects (early project init required -- module inits below
       // can then depend on e.g. computed defaultEncoding)
-      (projects::initialize)
+      ("init.projects", projects::initialize)
 
       // source database
-      (source_database::initialize)
+      ("init.source_database", source_database::initialize)
 
       // content urls
-      (content_urls::initialize)
+      ("init.content_urls", content_urls::initialize)
 
       // overlay R
-      (bind(sourceModuleRFile, "SessionOverlay.R"))
-   
+      ("init.overlay_r", bind(sourceModuleRFile, "SessionOverlay.R"))
+
       // addins
-      (addins::initialize)
+      ("init.addins", addins::initialize)
 
       // console processes
-      (console_process::initialize)
-         
+      ("init.console_process", console_process::initialize)
+
       // r utils
-      (r_utils::initialize)
-
-      // modules with c++ implementations
-      (modules::spelling::initialize)
-      (modules::lists::initialize)
-      (modules::path::initialize)
-      (modules::limits::initialize)
-      (modules::ask_pass::initialize)
-      (modules::agreement::initialize)
-      (modules::console::initialize)
+      ("init.r_utils", r_utils::initialize)
+
+      // modules with c++ implementations (named so the execution of each
+      // initializer is timed into the performance statistics accumulator
+      // -- see the startup profiling dump below)
+      ("init.spelling", modules::spelling::initialize)
+      ("init.lists", modules::lists::initialize)
+      ("init.path", modules::path::initialize)
+      ("init.limits", modules::limits::initialize)
+      ("init.ask_pass", modules::ask_pass::initialize)
+      ("init.agreement", modules::agreement::initialize)
+      ("init.console", modules::console::initialize)
 #ifdef RSTUDIO_SERVER
-      (modules::crypto::initialize)
+      ("init.crypto", modules::crypto::initialize)
 #endif
-      (modules::code_search::initialize)
-      (modules::clang::initialize)
-      (modules::connections::initialize)
-      (modules::files::initialize)
-      (modules::find::initialize)
-      (modules::environment::initialize)
-      (modules::dependencies::initialize)
-      (modules::dirty::initialize)
-      (modules::workbench::initialize)
-      (modules::data::initialize)
-      (modules::help::initialize)
-      (modules::presentation::initialize)
-      (modules::plots::initialize)
-      (modules::packages::initialize)
-      (modules::profiler::initialize)
-      (modules::viewer::initialize)
-      (modules::rmarkdown::initialize)
-      (modules::rmarkdown::notebook::initialize)
-      (modules::rpubs::initialize)
-      (modules::shiny::initialize)
-      (modules::source::initialize)
-      (modules::source_control::initialize)
-      (modules::authoring::initialize)
-      (modules::html_preview::initialize)
-      (modules::history::initialize)
-      (modules::build::initialize)
-      (modules::overlay::initialize)
-      (modules::breakpoints::initialize)
-      (modules::errors::initialize)
-      (modules::updates::initialize)
-      (modules::about::initialize)
-      (modules::shiny_viewer::initialize)
-      (modules::rsconnect::initialize)
-      (modules::packrat::initialize)
-      (modules::rhooks::initialize)
-      (modules::r_packages::initialize)
-      (modules::diagnostics::initialize)
-      (modules::markers::initialize)
-      (modules::snippets::initialize)
-      (modules::user_commands::initialize)
-      (modules::r_addins::initialize)
-      (modules::mathjax::initialize)
+      ("init.code_search", modules::code_search::initialize)
+      ("init.clang", modules::clang::initialize)
+      ("init.connections", modules::connections::initialize)
+      ("init.files", modules::files::initialize)
+      ("init.find", modules::find::initialize)
+      ("init.environment", modules::environment::initialize)
+      ("init.dependencies", modules::dependencies::initialize)
+      ("init.dirty", modules::dirty::initialize)
+      ("init.workbench", modules::workbench::initialize)
+      ("init.data", modules::data::initialize)
+      ("init.help", modules::help::initialize)
+      ("init.presentation", modules::presentation::initialize)
+      ("init.plots", modules::plots::initialize)
+      ("init.packages", modules::packages::initialize)
+      ("init.profiler", modules::profiler::initialize)
+      ("init.viewer", modules::viewer::initialize)
+      ("init.rmarkdown", modules::rmarkdown::initialize)
+      ("init.rmarkdown_notebook", modules::rmarkdown::notebook::initialize)
+      ("init.rpubs", modules::rpubs::initialize)
+      ("init.shiny", modules::shiny::initialize)
+      ("init.source", modules::source::initialize)
+      ("init.source_control", modules::source_control::initialize)
+      ("init.authoring", modules::authoring::initialize)
+      ("init.html_preview", modules::html_preview::initialize)
+      ("init.history", modules::history::initialize)
+      ("init.build", modules::build::initialize)
+      ("init.overlay", modules::overlay::initialize)
+      ("init.breakpoints", modules::breakpoints::initialize)
+      ("init.errors", modules::errors::initialize)
+      ("init.updates", modules::updates::initialize)
+      ("init.about", modules::about::initialize)
+      ("init.shiny_viewer", modules::shiny_viewer::initialize)
+      ("init.rsconnect", modules::rsconnect::initialize)
+      ("init.packrat", modules::packrat::initialize)
+      ("init.rhooks", modules::rhooks::initialize)
+      ("init.r_packages", modules::r_packages::initialize)
+      ("init.diagnostics", modules::diagnostics::initialize)
+      ("init.markers", modules::markers::initialize)
+      ("init.memory_telemetry", modules::memory_telemetry::initialize)
+      ("init.snippets", modules::snippets::initialize)
+      ("init.user_commands", modules::user_commands::initialize)
+      ("init.r_addins", modules::r_addins::initialize)
+      ("init.mathjax", modules::mathjax::initialize)
 
       // workers
-      (workers::web_request::initialize)
+      ("init.web_request_worker", workers::web_request::initialize)
 
       // R code
-      (bind(sourceModuleRFile, "SessionCodeTools.R"))
-      (bind(sourceModuleRFile, "SessionCompletionHooks.R"))
+      ("init.code_tools_r", bind(sourceModuleRFile, "SessionCodeTools.R"))
+      ("init.completion_hooks_r", bind(sourceModuleRFile, "SessionCompletionHooks.R"))
    
       // unsupported functions
       (bind(rstudio::r::function_hook::registerUnsupported, "bug.report", "utils"))
@@ -1877,7 +2411,25 @@ Error rInit(const rstudio::r::session::RInitInfo& rInitInfo)
    Error error = initialize.execute();
    if (error)
       return error;
-   
+
+   // dump per-initializer timings when startup profiling is requested
+   if (!core::system::getenv("RSTUDIO_SESSION_PROFILE_STARTUP").empty())
+   {
+      std::ostringstream ostr;
+      core::writePerformanceStatistics(ostr);
+      LOG_INFO_MESSAGE("session startup timings:\n" + ostr.str());
+   }
+
+   // launch the event loop watchdog (stall reports are attributed to
+   // this thread's current timed section, so start tracking it here)
+   core::trackActivityOnCurrentThread();
+   core::thread::safeLaunchThread(eventLoopWatchdog);
+
+   // check periodically for idle tiers whose state can be shed
+   module_context::schedulePeriodicWork(boost::posix_time::minutes(1),
+                                        checkIdleStateShedding,
+                                        true);
+
    // if we are in verify installation mode then we should exit (successfully) now
    if (rsession::options().verifyInstallation())
    {
@@ -1919,6 +2471,13 @@ Error rInit(const rstudio::r::session::RInitInfo& rInitInfo)
       s_jsonRpcMethods.insert(json::adaptMethodToAsync(method));
    }
 
+   // the method table is complete at this point (registration only occurs
+   // during module initialization) and is hit on every rpc request, so
+   // freeze it into its final shape: a low load factor trades a little
+   // memory for fewer string comparisons per lookup
+   s_jsonRpcMethods.max_load_factor(0.5f);
+   s_jsonRpcMethods.rehash(s_jsonRpcMethods.size() * 2);
+
    // add gwt handlers if we are running desktop mode
    if ((rsession::options().programMode() == kSessionProgramModeDesktop) ||
        rsession::options().standalone())
@@ -2572,8 +3131,15 @@ void rSerialization(int action, const FilePath& targetPath)
    {
       serializationActionObject["targetPath"] =
                            module_context::createAliasedPath(targetPath);
+
+      // include the size of the file being loaded/saved (when it exists)
+      // so the client can convey the scale of a lengthy workspace
+      // restore rather than showing an indeterminate status
+      if (targetPath.exists())
+         serializationActionObject["targetSize"] =
+                           static_cast<double>(targetPath.size());
    }
-   
+
    ClientEvent event(kSessionSerialization, serializationActionObject);
    rsession::clientEventQueue().add(event);
 }
@@ -2935,12 +3501,35 @@ Error registerIdleOnlyAsyncRpcMethod(
 Error registerRpcMethod(const std::string& name,
                         const core::json::JsonRpcFunction& function)
 {
+   // wrap the method so per-method execution statistics are recorded
+   // (see getRpcMethodStats)
    s_jsonRpcMethods.insert(
          std::make_pair(name,
-                        std::make_pair(true, json::adaptToAsync(function))));
+                        std::make_pair(true, json::adaptToAsync(
+                           boost::bind(instrumentedRpcMethod,
+                                       name, function, _1, _2)))));
+   return Success();
+}
+
+Error registerRpcPrefetch(const std::string& triggerMethod,
+                          const RpcPrefetchBuilderFunction& builderFunction)
+{
+   s_rpcPrefetchBuilders.insert(
+                           std::make_pair(triggerMethod, builderFunction));
    return Success();
 }
 
+Error registerThreadSafeRpcMethod(const std::string& name,
+                                  const core::json::JsonRpcFunction& function)
+{
+   // route requests arriving over http to the listener thread
+   connection::registerThreadSafeMethod(name, function);
+
+   // also register normally so the method remains callable through
+   // main-thread dispatch paths (e.g. execute_batch)
+   return registerRpcMethod(name, function);
+}
+
 UserPrompt::Response showUserPrompt(const UserPrompt& userPrompt)
 {
    // enque user prompt event
@@ -3270,9 +3859,9 @@ int main (int argc, char * const argv[])
 #ifdef RSTUDIO_SERVER
       if (serverMode)
       {
-         Error error = core::system::crypto::rsaInit();
-         if (error)
-            LOG_ERROR(error);
+         // generate the keypair in the background so startup (and the
+         // first askpass prompt) doesn't wait on rsa key generation
+         core::system::crypto::rsaInitAsync();
       }
 #endif
 
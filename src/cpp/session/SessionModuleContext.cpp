@@ -33,12 +33,15 @@
 #include <core/Settings.hpp>
 #include <core/DateTime.hpp>
 #include <core/FileSerializer.hpp>
+#include <core/FileUtils.hpp>
 #include <core/markdown/Markdown.hpp>
 #include <core/system/FileScanner.hpp>
 #include <core/IncrementalCommand.hpp>
 #include <core/PeriodicCommand.hpp>
 #include <core/collection/Tree.hpp>
 
+#include <core/http/Request.hpp>
+#include <core/http/Response.hpp>
 #include <core/http/Util.hpp>
 
 #include <core/system/Process.hpp>
@@ -577,27 +580,82 @@ typedef std::vector<boost::shared_ptr<ScheduledCommand> >
 ScheduledCommands s_scheduledCommands;
 ScheduledCommands s_idleScheduledCommands;
 
+// earliest time at which anything in each command list becomes due.
+// most background passes find nothing due, so tracking a single
+// deadline per list lets those passes skip scanning the commands
+// entirely. not_a_date_time means the deadline is unknown (or a
+// command in the list works on every pass) and the list must be
+// scanned; pos_infin means nothing will ever become due (empty list)
+boost::posix_time::ptime s_nextCommandDueTime;
+boost::posix_time::ptime s_nextIdleCommandDueTime;
+
 void addScheduledCommand(boost::shared_ptr<ScheduledCommand> pCommand,
                          bool idleOnly)
 {
    if (idleOnly)
+   {
       s_idleScheduledCommands.push_back(pCommand);
+      s_nextIdleCommandDueTime = boost::posix_time::not_a_date_time;
+   }
    else
+   {
       s_scheduledCommands.push_back(pCommand);
+      s_nextCommandDueTime = boost::posix_time::not_a_date_time;
+   }
 }
 
-void executeScheduledCommands(ScheduledCommands* pCommands)
+boost::posix_time::ptime earliestExecutionTime(
+                                       const ScheduledCommands& commands)
 {
-   // make a copy of scheduled commands before executing them
+   boost::posix_time::ptime earliest(boost::posix_time::pos_infin);
+   for (ScheduledCommands::const_iterator it = commands.begin();
+        it != commands.end();
+        ++it)
+   {
+      boost::posix_time::ptime next = (*it)->nextExecutionTime();
+
+      // a command which works on every pass disables the fast path
+      if (next.is_not_a_date_time())
+         return boost::posix_time::ptime(boost::posix_time::not_a_date_time);
+
+      if (next < earliest)
+         earliest = next;
+   }
+   return earliest;
+}
+
+void executeScheduledCommands(ScheduledCommands* pCommands,
+                              boost::posix_time::ptime* pNextDueTime)
+{
+   // fast path: nothing in the list is due yet
+   boost::posix_time::ptime now =
+                  boost::posix_time::microsec_clock::universal_time();
+   if (!pNextDueTime->is_not_a_date_time() && now <= *pNextDueTime)
+      return;
+
+   // make a copy of the commands which are due before executing them
    // (this is because a scheduled command could result in
    // R code executing which in turn could cause the list of
    // scheduled commands to be mutated and these iterators
-   // invalidated)
-   ScheduledCommands commands = *pCommands;
+   // invalidated). on most background passes no command is due, in
+   // which case nothing is copied or executed
+   ScheduledCommands dueCommands;
+   for (ScheduledCommands::const_iterator it = pCommands->begin();
+        it != pCommands->end();
+        ++it)
+   {
+      if ((*it)->due(now))
+         dueCommands.push_back(*it);
+   }
+   if (dueCommands.empty())
+   {
+      *pNextDueTime = earliestExecutionTime(*pCommands);
+      return;
+   }
 
-   // execute all commands
-   std::for_each(commands.begin(),
-                 commands.end(),
+   // execute the commands which are due
+   std::for_each(dueCommands.begin(),
+                 dueCommands.end(),
                  boost::bind(&ScheduledCommand::execute, _1));
 
    // remove any commands which are finished
@@ -607,6 +665,10 @@ void executeScheduledCommands(ScheduledCommands* pCommands)
                     pCommands->end(),
                     boost::bind(&ScheduledCommand::finished, _1)),
                  pCommands->end());
+
+   // executing commands (or R code they ran) may have rescheduled or
+   // mutated the list, so recompute the deadline from scratch
+   *pNextDueTime = earliestExecutionTime(*pCommands);
 }
 
 
@@ -705,6 +767,134 @@ void scheduleDelayedWork(const boost::posix_time::time_duration& period,
                         false);
 }
 
+namespace {
+
+void performCacheTrim(const FilePath& cacheDirectory, uintmax_t maxSizeBytes)
+{
+   Error error = file_utils::trimCacheDirectory(cacheDirectory,
+                                                maxSizeBytes);
+   if (error)
+      LOG_ERROR(error);
+}
+
+} // anonymous namespace
+
+void scheduleCacheTrim(const core::FilePath& cacheDirectory,
+                       uintmax_t maxSizeBytes)
+{
+   // defer the trim until well after startup (and restrict it to idle
+   // time) so bounding the cache never competes with user work
+   scheduleDelayedWork(boost::posix_time::seconds(60),
+                       boost::bind(performCacheTrim,
+                                   cacheDirectory,
+                                   maxSizeBytes),
+                       true);
+}
+
+namespace {
+
+// in-memory cache of static asset content served repeatedly by uri
+// handlers (entries validated against size + last write time)
+struct CachedAsset
+{
+   std::time_t lastWriteTime;
+   uintmax_t size;
+   std::string contentType;
+   std::string content;
+};
+
+std::map<std::string, CachedAsset> s_assetCache;
+std::size_t s_assetCacheBytes = 0;
+
+// bounds: files larger than this aren't cached, and when the cache
+// exceeds its overall budget it is cleared wholesale (the working set
+// refills within a few requests)
+const std::size_t kMaxCachedAssetBytes = 512 * 1024;
+const std::size_t kMaxAssetCacheBytes = 8 * 1024 * 1024;
+
+} // anonymous namespace
+
+void setCacheableFileResponse(const core::FilePath& filePath,
+                              const core::http::Request& request,
+                              core::http::Response* pResponse)
+{
+   if (!filePath.exists())
+   {
+      pResponse->setNotFoundError(request.uri());
+      return;
+   }
+
+   // set Last-Modified and answer revalidations without touching the
+   // file's content (the same protocol Response::setCacheableFile uses)
+   std::time_t lastWriteTime = filePath.lastWriteTime();
+   using namespace boost::posix_time;
+   ptime lastModifiedDate = from_time_t(lastWriteTime);
+   pResponse->setHeader("Last-Modified",
+                        http::util::httpDate(lastModifiedDate));
+   if (lastModifiedDate == request.ifModifiedSince())
+   {
+      pResponse->removeHeader("Content-Type");
+      pResponse->setStatusCode(http::status::NotModified);
+      return;
+   }
+
+   // serve from the cache when the file is unchanged
+   uintmax_t size = filePath.size();
+   std::string content;
+   std::string contentType;
+   std::map<std::string, CachedAsset>::const_iterator it =
+                              s_assetCache.find(filePath.absolutePath());
+   if (it != s_assetCache.end() &&
+       it->second.lastWriteTime == lastWriteTime &&
+       it->second.size == size)
+   {
+      content = it->second.content;
+      contentType = it->second.contentType;
+   }
+   else
+   {
+      // read the file and (if it fits) cache it for subsequent requests
+      Error error = core::readStringFromFile(filePath, &content);
+      if (error)
+      {
+         pResponse->setError(error);
+         return;
+      }
+      contentType = filePath.mimeContentType();
+
+      if (content.size() <= kMaxCachedAssetBytes)
+      {
+         if (s_assetCacheBytes + content.size() > kMaxAssetCacheBytes)
+         {
+            s_assetCache.clear();
+            s_assetCacheBytes = 0;
+         }
+
+         CachedAsset asset;
+         asset.lastWriteTime = lastWriteTime;
+         asset.size = size;
+         asset.contentType = contentType;
+         asset.content = content;
+         s_assetCache[filePath.absolutePath()] = asset;
+         s_assetCacheBytes += content.size();
+      }
+   }
+
+   // respond (gzip if the client accepts it, as Response::setFile does).
+   // a content type already set by the caller takes precedence over the
+   // one derived from the file extension
+   if (pResponse->contentType().empty())
+      pResponse->setContentType(contentType);
+   if (request.acceptsEncoding(http::kGzipEncoding))
+      pResponse->setContentEncoding(http::kGzipEncoding);
+   Error error = pResponse->setBody(content);
+   if (error)
+   {
+      pResponse->setError(http::status::InternalServerError,
+                          error.code().message());
+   }
+}
+
 
 void onBackgroundProcessing(bool isIdle)
 {
@@ -718,9 +908,10 @@ void onBackgroundProcessing(bool isIdle)
    events().onBackgroundProcessing(isIdle);
 
    // execute incremental commands
-   executeScheduledCommands(&s_scheduledCommands);
+   executeScheduledCommands(&s_scheduledCommands, &s_nextCommandDueTime);
    if (isIdle)
-      executeScheduledCommands(&s_idleScheduledCommands);
+      executeScheduledCommands(&s_idleScheduledCommands,
+                               &s_nextIdleCommandDueTime);
 }
 
 core::string_utils::LineEnding lineEndings(const core::FilePath& srcFile)
@@ -1893,6 +2084,11 @@ void beginRpcHandler(json::JsonRpcFunction function,
    CATCH_UNEXPECTED_EXCEPTION
 
 }
+
+// shared worker pool for async rpc handlers (lazily created on first
+// use). previously every async rpc launched its own thread
+boost::shared_ptr<core::thread::ThreadPool> s_pAsyncRpcPool;
+
 } // anonymous namespace
 
 core::Error executeAsync(const json::JsonRpcFunction& function,
@@ -1901,13 +2097,21 @@ core::Error executeAsync(const json::JsonRpcFunction& function,
 {
    // Immediately return a response to the server with a handle that
    // identifies this invocation. In the meantime, kick off the actual
-   // operation on a new thread.
+   // operation on the shared async rpc worker pool.
+
+   // NOTE: executeAsync is only ever called from the main thread (rpc
+   // dispatch) so lazy creation of the pool requires no synchronization
+   if (!s_pAsyncRpcPool)
+   {
+      s_pAsyncRpcPool.reset(new core::thread::ThreadPool(2));
+      s_pAsyncRpcPool->start();
+   }
 
    std::string handle = core::system::generateUuid(true);
-   core::thread::safeLaunchThread(bind(beginRpcHandler,
-                                       function,
-                                       request,
-                                       handle));
+   s_pAsyncRpcPool->schedule(bind(beginRpcHandler,
+                                  function,
+                                  request,
+                                  handle));
    pResponse->setAsyncHandle(handle);
    return Success();
 }
@@ -29,11 +29,16 @@ To create a new postback handler for an action 'foo' do the following:
  
 3) Call module_context::registerPostbackHandler with 'foo' as the name param
    and the function you want called during the postback. The function will
-   be passed a single parameter corresponding to the first command line 
-   argument passed by R to the shell script. 
- 
+   be passed the first command line argument passed by R to the shell
+   script along with a PostbackHandlerContinuation which it must invoke
+   (with an exit code and output for the shell script) when the operation
+   completes. Dispatch is asynchronous: handlers which need to wait on the
+   user or an external service should hold on to the continuation and
+   invoke it later (or wait via registerWaitForMethod, which continues to
+   pump other connections) rather than blocking the event loop.
+
 4) The registration function uses the pShellCommand out param to provide you
-   with the shell command which you in turn provide to R. 
+   with the shell command which you in turn provide to R.
 
 */
 
@@ -73,6 +73,15 @@ namespace {
 // lookup)
 std::map<std::string, std::string> s_idToPath;
 
+// serialized form last written to disk for each document id. put() is
+// called liberally (every autosave and every property tweak, e.g. cursor
+// position) and most calls serialize to exactly the bytes already on
+// disk -- skipping those rewrites keeps multi-MB documents from being
+// re-written to (potentially NFS-mounted) home directories every few
+// seconds. we retain the full serialization (not a hash) so a hash
+// collision can never silently skip persisting a changed document
+std::map<std::string, std::string> s_lastWrittenContents;
+
 struct PropertiesDatabase
 {
    FilePath path;
@@ -258,6 +267,21 @@ void SourceDocument::setContents(const std::string& contents)
    lastContentUpdate_ = date_time::millisecondsSinceEpoch();
 }
 
+// set contents from string (swap-based; see header)
+void SourceDocument::setContents(std::string* pContents)
+{
+   contents_.swap(*pContents);
+   hash_ = hash::crc32Hash(contents_);
+   lastContentUpdate_ = date_time::millisecondsSinceEpoch();
+}
+
+// set the path without reading contents from the file
+void SourceDocument::setPath(const std::string& path)
+{
+   path_ = path;
+   updateLastKnownWriteTime();
+}
+
 // set contents from file
 Error SourceDocument::setPathAndContents(const std::string& path,
                                          bool allowSubstChars)
@@ -677,17 +701,35 @@ Error list(std::vector<boost::shared_ptr<SourceDocument> >* pDocs)
 }
    
 Error put(boost::shared_ptr<SourceDocument> pDoc)
-{   
-   // write to file
+{
+   // serialize the document
+   json::Object jsonDoc;
+   pDoc->writeToJson(&jsonDoc);
+   std::ostringstream ostr;
+   json::writeFormatted(jsonDoc, ostr);
+   std::string contents = ostr.str();
+
+   // write to file -- unless the serialized form is identical to what we
+   // last wrote for this document (the common case for puts triggered by
+   // transient property updates, e.g. cursor position)
    FilePath filePath = source_database::path().complete(pDoc->id());
-   Error error = pDoc->writeToFile(filePath);
-   if (error)
-      return error ;
+   std::map<std::string, std::string>::const_iterator it =
+                                     s_lastWrittenContents.find(pDoc->id());
+   if (it == s_lastWrittenContents.end() ||
+       it->second != contents ||
+       !filePath.exists())
+   {
+      Error error = writeStringToFile(filePath, contents);
+      if (error)
+         return error ;
+
+      s_lastWrittenContents[pDoc->id()] = contents;
+   }
 
    // write properties to durable storage (if there is a path)
    if (!pDoc->path().empty())
    {
-      error = putProperties(pDoc->path(), pDoc->properties());
+      Error error = putProperties(pDoc->path(), pDoc->properties());
       if (error)
          LOG_ERROR(error);
    }
@@ -697,11 +739,14 @@ Error put(boost::shared_ptr<SourceDocument> pDoc)
    
 Error remove(const std::string& id)
 {
+   s_lastWrittenContents.erase(id);
    return source_database::path().complete(id).removeIfExists();
 }
    
 Error removeAll()
 {
+   s_lastWrittenContents.clear();
+
    std::vector<FilePath> files ;
    Error error = source_database::path().children(&files);
    if (error)
@@ -30,6 +30,9 @@
 
 
 #include <core/system/System.hpp>
+#ifndef _WIN32
+#include <core/system/PosixNfs.hpp>
+#endif
 
 #include <session/SessionOptions.hpp>
 #include <session/SessionModuleContext.hpp>
@@ -192,7 +195,9 @@ void attemptToMoveSourceDbFiles(const FilePath& fromPath,
    if (error)
       LOG_ERROR(error);
 
-   // move the files
+   // move the files (collecting targets so a single write barrier can
+   // cover the whole sweep afterwards)
+   std::vector<FilePath> movedFiles;
    BOOST_FOREACH(const FilePath& filePath, children)
    {
       // skip directories (directories can exist because multi-session
@@ -226,7 +231,20 @@ void attemptToMoveSourceDbFiles(const FilePath& fromPath,
       Error error = filePath.move(targetPath);
       if (error)
          LOG_ERROR(error);
+      else
+         movedFiles.push_back(targetPath);
+   }
+
+#ifndef _WIN32
+   // one round of nfs synchronization for the entire sweep (one
+   // directory sync per unique parent) rather than per-file flushes
+   if (!movedFiles.empty())
+   {
+      Error error = core::system::nfs::writeBarrier(movedFiles);
+      if (error)
+         LOG_ERROR(error);
    }
+#endif
 }
 
 // NOTE: the supervisor needs to return a session dir in order for the process
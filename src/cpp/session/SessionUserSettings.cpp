@@ -250,7 +250,9 @@ void UserSettings::onSettingsFileChanged(
       return;
    }
 
-   // update prefs cache
+   // update prefs cache (discard the cached parse of the previous
+   // uiPrefs value first)
+   pUiPrefs_.reset();
    updatePrefsCache(uiPrefs());
 
    // set underlying R repos options
@@ -308,13 +310,20 @@ void UserSettings::setAutoCreatedProfile(bool autoCreated)
 
 core::json::Object UserSettings::uiPrefs() const
 {
-   std::string value = settings_.get(kUiPrefs, "{}");
-   json::Value jsonValue;
-   bool success = core::json::parse(value, &jsonValue);
-   if (success)
-      return jsonValue.get_obj();
-   else
-      return json::Object();
+   // parse on demand then serve from the cache (callers read prefs on
+   // virtually every rpc so re-parsing the json each time adds up)
+   if (!pUiPrefs_)
+   {
+      std::string value = settings_.get(kUiPrefs, "{}");
+      json::Value jsonValue;
+      bool success = core::json::parse(value, &jsonValue);
+      if (success)
+         pUiPrefs_.reset(new json::Object(jsonValue.get_obj()));
+      else
+         pUiPrefs_.reset(new json::Object());
+   }
+
+   return *pUiPrefs_;
 }
 
 void UserSettings::setUiPrefs(const core::json::Object& prefsObject)
@@ -323,6 +332,7 @@ void UserSettings::setUiPrefs(const core::json::Object& prefsObject)
    json::writeFormatted(prefsObject, output);
    settings_.set(kUiPrefs, output.str());
 
+   pUiPrefs_.reset(new json::Object(prefsObject));
    updatePrefsCache(prefsObject);
 }
 
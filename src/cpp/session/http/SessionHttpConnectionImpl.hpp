@@ -18,6 +18,8 @@
 
 
 #include <boost/array.hpp>
+#include <boost/bind.hpp>
+#include <boost/algorithm/string/predicate.hpp>
 
 #include <boost/utility.hpp>
 #include <boost/asio/io_service.hpp>
@@ -57,7 +59,7 @@ public:
 public:
    HttpConnectionImpl(boost::asio::io_service& ioService,
                       const Handler& handler)
-      : socket_(ioService), handler_(handler)
+      : ioService_(ioService), socket_(ioService), handler_(handler)
    {
    }
 
@@ -80,11 +82,20 @@ public:
 
    virtual void sendResponse(const core::http::Response &response)
    {
+      // negotiate connection re-use (so a browser tab can multiplex its
+      // rpc traffic over a small set of persistent connections rather
+      // than paying connection setup on every round trip)
+      std::string connection = request_.headerValue("Connection");
+      bool keepAlive = !request_.isHttp10() &&
+                       !boost::algorithm::iequals(connection, "close");
+
       try
       {
          // write the response
          boost::asio::write(socket_,
                             response.toBuffers(
+                               keepAlive ?
+                                  core::http::Header::connectionKeepAlive() :
                                   core::http::Header::connectionClose()));
       }
       catch(const boost::system::system_error& e)
@@ -96,15 +107,72 @@ public:
          // log the error if it wasn't connection terminated
          if (!core::http::isConnectionTerminatedError(error))
             LOG_ERROR(error);
+
+         keepAlive = false;
       }
       CATCH_UNEXPECTED_EXCEPTION
 
-      // always close connection
+      if (keepAlive)
+      {
+         // reset parsing state then resume reading the next request.
+         // note sendResponse is called from the session main thread so
+         // the read must be initiated on the network thread (the posted
+         // read also keeps this object alive)
+         try
+         {
+            requestParser_.reset();
+            request_.reset();
+            requestId_.clear();
+            ioService_.post(boost::bind(
+                  &HttpConnectionImpl<ProtocolType>::startReading,
+                  HttpConnectionImpl<ProtocolType>::shared_from_this()));
+         }
+         CATCH_UNEXPECTED_EXCEPTION
+      }
+      else
+      {
+         // close connection
+         try
+         {
+            close();
+         }
+         CATCH_UNEXPECTED_EXCEPTION
+      }
+   }
+
+   // event-stream interface -- writes occur synchronously on the
+   // caller's thread (same scheme as sendResponse). the connection is
+   // dedicated to the stream once begun (no further requests are read)
+   virtual core::Error beginEventStream(const core::http::Response& response)
+   {
       try
       {
-         close();
+         boost::asio::write(socket_,
+                            response.toBuffers(
+                                 core::http::Header::connectionClose()));
+         return core::Success();
+      }
+      catch(const boost::system::system_error& e)
+      {
+         core::Error error = core::Error(e.code(), ERROR_LOCATION);
+         error.addProperty("request-uri", request_.uri());
+         return error;
+      }
+   }
+
+   virtual core::Error writeEventStreamData(const std::string& data)
+   {
+      try
+      {
+         boost::asio::write(socket_, boost::asio::buffer(data));
+         return core::Success();
+      }
+      catch(const boost::system::system_error& e)
+      {
+         core::Error error = core::Error(e.code(), ERROR_LOCATION);
+         error.addProperty("request-uri", request_.uri());
+         return error;
       }
-      CATCH_UNEXPECTED_EXCEPTION
    }
 
    // close (occurs automatically after writeResponse, here in case it
@@ -214,6 +282,7 @@ private:
    }
 
 private:
+   boost::asio::io_service& ioService_;
    typename ProtocolType::socket socket_;
    boost::array<char, 8192> buffer_ ;
    core::http::RequestParser requestParser_ ;
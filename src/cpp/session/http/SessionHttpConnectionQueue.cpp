@@ -15,57 +15,225 @@
 
 #include <session/SessionHttpConnectionQueue.hpp>
 
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
 #include <core/Log.hpp>
 #include <core/Error.hpp>
 #include <core/Thread.hpp>
 
 #include <core/http/Request.hpp>
 
+#include <core/json/JsonRpc.hpp>
+
 using namespace rstudio::core ;
 
 namespace rstudio {
 namespace session {
 
+namespace {
+
+// methods registered as superseded-by-newer. guarded by a mutex since
+// registration occurs on the main thread during startup while the
+// consumer thread snapshots the set when collapsing a drained backlog
+boost::mutex s_supersededMethodsMutex;
+std::set<std::string> s_supersededMethods;
+
+std::string rpcMethodFromUri(const std::string& uri)
+{
+   std::string::size_type pos = uri.rfind("/rpc/");
+   if (pos == std::string::npos)
+      return std::string();
+   return uri.substr(pos + 5);
+}
+
+} // anonymous namespace
+
+void HttpConnectionQueue::registerSupersededMethod(const std::string& method)
+{
+   boost::mutex::scoped_lock lock(s_supersededMethodsMutex);
+   s_supersededMethods.insert(method);
+}
+
+HttpConnectionQueue::HttpConnectionQueue()
+   : pIncoming_(NULL),
+#ifdef _WIN32
+     pMutex_(new boost::mutex()),
+     pWaitCondition_(new boost::condition()),
+#endif
+     pTimeMutex_(new boost::mutex())
+{
+#ifndef _WIN32
+   // create the (non-blocking) wakeup pipe. if creation fails (which
+   // should never occur in practice) then waitForConnection degrades
+   // to a short sleep based poll of the queue
+   wakeupFds_[0] = wakeupFds_[1] = -1;
+   if (::pipe(wakeupFds_) == 0)
+   {
+      for (int i = 0; i < 2; i++)
+      {
+         int flags = ::fcntl(wakeupFds_[i], F_GETFL, 0);
+         if (flags != -1)
+            ::fcntl(wakeupFds_[i], F_SETFL, flags | O_NONBLOCK);
+      }
+   }
+   else
+   {
+      LOG_ERROR(systemError(errno, ERROR_LOCATION));
+   }
+#endif
+}
+
 void HttpConnectionQueue::enqueConnection(
                               boost::shared_ptr<HttpConnection> ptrConnection)
 {
-   LOCK_MUTEX(*pMutex_)
+   // lock-free push onto the incoming stack
+   Node* pNode = new Node(ptrConnection);
+   Node* pHead = pIncoming_.load(boost::memory_order_relaxed);
+   do
    {
-      // enque
-      queue_.push(ptrConnection);
+      pNode->pNext = pHead;
    }
-   END_LOCK_MUTEX
+   while (!pIncoming_.compare_exchange_weak(pHead,
+                                            pNode,
+                                            boost::memory_order_release,
+                                            boost::memory_order_relaxed));
+
+   // wake the consumer if it's waiting
+   wakeConsumer();
+}
 
+void HttpConnectionQueue::wakeConsumer()
+{
+#ifndef _WIN32
+   if (wakeupFds_[1] != -1)
+   {
+      // a full pipe just means the consumer already has plenty of
+      // pending wakeups, so EAGAIN can be safely ignored
+      char byte = 0;
+      int result = ::write(wakeupFds_[1], &byte, 1);
+      if (result == -1 && errno != EAGAIN && errno != EINTR)
+         LOG_ERROR(systemError(errno, ERROR_LOCATION));
+   }
+#else
    pWaitCondition_->notify_all();
+#endif
 }
 
+void HttpConnectionQueue::drainIncoming()
+{
+   // take the entire incoming stack in one shot. the stack is in
+   // lifo order so reverse it while transferring to the consumer's
+   // fifo (only called when the fifo is empty so the push_front
+   // traversal can't interleave with older entries)
+   Node* pNode = pIncoming_.exchange(NULL, boost::memory_order_acquire);
+   while (pNode != NULL)
+   {
+      consumerQueue_.push_front(pNode->ptrConnection);
+      Node* pNext = pNode->pNext;
+      delete pNode;
+      pNode = pNext;
+   }
 
-boost::shared_ptr<HttpConnection> HttpConnectionQueue::doDequeConnection()
+   // apply staleness policies to the drained backlog
+   collapseSuperseded();
+}
+
+void HttpConnectionQueue::collapseSuperseded()
 {
-   LOCK_MUTEX(*pMutex_)
+   // nothing to collapse unless there's an actual backlog
+   if (consumerQueue_.size() < 2)
+      return;
+
+   // snapshot the registry
+   std::set<std::string> supersededMethods;
+   LOCK_MUTEX(s_supersededMethodsMutex)
    {
-      if (!queue_.empty())
-      {
-         // remove it
-         boost::shared_ptr<HttpConnection> next = queue_.front();
-         queue_.pop();
+      supersededMethods = s_supersededMethods;
+   }
+   END_LOCK_MUTEX
+   if (supersededMethods.empty())
+      return;
 
-         // note last connection time
-         lastConnectionTime_ =
-                     boost::posix_time::second_clock::universal_time();
+   // walk newest to oldest, flagging all but the newest request for
+   // each superseded method
+   std::vector<bool> drop(consumerQueue_.size(), false);
+   std::set<std::string> seen;
+   for (std::size_t i = consumerQueue_.size(); i > 0; i--)
+   {
+      std::string method = rpcMethodFromUri(
+                                 consumerQueue_[i-1]->request().uri());
+      if (method.empty() ||
+          supersededMethods.find(method) == supersededMethods.end())
+      {
+         continue;
+      }
+      if (!seen.insert(method).second)
+         drop[i-1] = true;
+   }
+   if (seen.empty())
+      return;
 
-         // return it
-         return next;
+   // answer the dropped requests immediately and retain the rest.
+   // MethodUnexpected is used because clients already treat it as an
+   // invalidated ask (their own invalidation tokens discard the reply)
+   std::deque<boost::shared_ptr<HttpConnection> > retained;
+   for (std::size_t i = 0; i < consumerQueue_.size(); i++)
+   {
+      if (drop[i])
+      {
+         try
+         {
+            consumerQueue_[i]->sendJsonRpcError(
+                  Error(json::errc::MethodUnexpected, ERROR_LOCATION));
+         }
+         catch(...)
+         {
+         }
       }
       else
       {
-         return boost::shared_ptr<HttpConnection>();
+         retained.push_back(consumerQueue_[i]);
       }
    }
-   END_LOCK_MUTEX
+   consumerQueue_.swap(retained);
+}
+
+boost::shared_ptr<HttpConnection> HttpConnectionQueue::doDequeConnection()
+{
+   // replenish the consumer fifo if necessary
+   if (consumerQueue_.empty())
+      drainIncoming();
+
+   if (!consumerQueue_.empty())
+   {
+      // remove it
+      boost::shared_ptr<HttpConnection> next = consumerQueue_.front();
+      consumerQueue_.pop_front();
+
+      // note last connection time
+      LOCK_MUTEX(*pTimeMutex_)
+      {
+         lastConnectionTime_ =
+                     boost::posix_time::second_clock::universal_time();
+      }
+      END_LOCK_MUTEX
 
-   // keep compiler happy
-   return boost::shared_ptr<HttpConnection>();
+      // return it
+      return next;
+   }
+   else
+   {
+      return boost::shared_ptr<HttpConnection>();
+   }
 }
 
 boost::shared_ptr<HttpConnection> HttpConnectionQueue::dequeConnection()
@@ -94,22 +262,54 @@ boost::shared_ptr<HttpConnection> HttpConnectionQueue::dequeConnection(
 
 std::string HttpConnectionQueue::peekNextConnectionUri()
 {
-   LOCK_MUTEX(*pMutex_)
-   {
-      if (!queue_.empty())
-         return queue_.front()->request().uri();
-      else
-         return std::string();
-   }
-   END_LOCK_MUTEX
+   // replenish the consumer fifo if necessary
+   if (consumerQueue_.empty())
+      drainIncoming();
 
-   // keep compiler happy
-   return std::string();
+   if (!consumerQueue_.empty())
+      return consumerQueue_.front()->request().uri();
+   else
+      return std::string();
 }
 
 bool HttpConnectionQueue::waitForConnection(
                      const boost::posix_time::time_duration& waitDuration)
 {
+#ifndef _WIN32
+   if (wakeupFds_[0] != -1)
+   {
+      struct pollfd pfd;
+      pfd.fd = wakeupFds_[0];
+      pfd.events = POLLIN;
+      pfd.revents = 0;
+      int result = ::poll(&pfd, 1, waitDuration.total_milliseconds());
+      if (result > 0)
+      {
+         // consume all pending wakeup bytes (they are merely a signal
+         // -- the actual connections live in the incoming stack)
+         char buffer[128];
+         while (::read(wakeupFds_[0], buffer, sizeof(buffer)) > 0)
+         {
+         }
+         return true;
+      }
+      else
+      {
+         if (result == -1 && errno != EINTR)
+            LOG_ERROR(systemError(errno, ERROR_LOCATION));
+         return false;
+      }
+   }
+   else
+   {
+      // no wakeup pipe (degraded mode) -- just sleep briefly and
+      // report that the caller should re-check the queue
+      boost::this_thread::sleep(
+               boost::posix_time::milliseconds(
+                  std::min<long>(waitDuration.total_milliseconds(), 25)));
+      return true;
+   }
+#else
    using namespace boost;
    try
    {
@@ -123,11 +323,12 @@ bool HttpConnectionQueue::waitForConnection(
       LOG_ERROR(waitError);
       return false ;
    }
+#endif
 }
 
 boost::posix_time::ptime HttpConnectionQueue::lastConnectionTime()
 {
-    LOCK_MUTEX(*pMutex_)
+    LOCK_MUTEX(*pTimeMutex_)
     {
       return lastConnectionTime_;
     }
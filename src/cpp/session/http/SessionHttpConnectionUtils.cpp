@@ -16,13 +16,19 @@
 
 #include "SessionHttpConnectionUtils.hpp"
 
+#include <map>
+#include <sstream>
+
 
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 
 #include <core/FilePath.hpp>
 #include <core/Log.hpp>
 #include <core/Error.hpp>
+#include <core/Thread.hpp>
 #include <core/FileSerializer.hpp>
+#include <core/system/Environment.hpp>
 
 
 #include <core/http/Response.hpp>
@@ -38,6 +44,19 @@
 namespace rstudio {
 namespace session {
 
+core::Error HttpConnection::beginEventStream(const core::http::Response&)
+{
+   // streaming not supported by this connection type
+   return core::systemError(boost::system::errc::not_supported,
+                            ERROR_LOCATION);
+}
+
+core::Error HttpConnection::writeEventStreamData(const std::string&)
+{
+   return core::systemError(boost::system::errc::not_supported,
+                            ERROR_LOCATION);
+}
+
 void HttpConnection::sendJsonRpcError(const core::Error& error)
 {
    core::json::JsonRpcResponse jsonRpcResponse;
@@ -209,6 +228,87 @@ bool checkForSuspend(boost::shared_ptr<HttpConnection> ptrConnection)
 }
 #endif
 
+namespace {
+
+// registered thread-safe methods. guarded by a mutex since registration
+// occurs on the main thread during module initialization while lookups
+// occur on the listener thread
+boost::mutex s_threadSafeMethodsMutex;
+std::map<std::string, core::json::JsonRpcFunction> s_threadSafeMethods;
+
+} // anonymous namespace
+
+void registerThreadSafeMethod(const std::string& name,
+                              const core::json::JsonRpcFunction& function)
+{
+   boost::mutex::scoped_lock lock(s_threadSafeMethodsMutex);
+   s_threadSafeMethods[name] = function;
+}
+
+bool checkForThreadSafeMethod(boost::shared_ptr<HttpConnection> ptrConnection)
+{
+   // extract the method name from the uri
+   std::string uri = ptrConnection->request().uri();
+   std::string::size_type pos = uri.rfind("/rpc/");
+   if (pos == std::string::npos)
+      return false;
+   std::string method = uri.substr(pos + 5);
+
+   // look for a registered handler
+   core::json::JsonRpcFunction function;
+   {
+      boost::mutex::scoped_lock lock(s_threadSafeMethodsMutex);
+      std::map<std::string, core::json::JsonRpcFunction>::const_iterator it =
+                                              s_threadSafeMethods.find(method);
+      if (it == s_threadSafeMethods.end())
+         return false;
+      function = it->second;
+   }
+
+   // parse the request (as with suspend_session above, client-id and
+   // version validation are skipped for methods handled on the listener
+   // thread)
+   core::json::JsonRpcRequest jsonRpcRequest;
+   core::Error error = core::json::parseJsonRpcRequest(
+                                             ptrConnection->request().body(),
+                                             &jsonRpcRequest);
+   if (error)
+   {
+      ptrConnection->sendJsonRpcError(error);
+      return true;
+   }
+
+   // execute the handler and respond
+   core::json::JsonRpcResponse response;
+   error = function(jsonRpcRequest, &response);
+   if (error)
+      ptrConnection->sendJsonRpcError(error);
+   else
+      ptrConnection->sendJsonRpcResponse(response);
+
+   return true;
+}
+
+namespace {
+
+// handler invoked on the listener thread when an interrupt rpc arrives.
+// set once during startup (before the listener thread is launched) so
+// no synchronization is required for the reads below
+boost::function<void()> s_interruptNotifyHandler;
+
+} // anonymous namespace
+
+void setInterruptNotifyHandler(const boost::function<void()>& handler)
+{
+   s_interruptNotifyHandler = handler;
+}
+
+void notifyIfInterrupt(boost::shared_ptr<HttpConnection> ptrConnection)
+{
+   if (s_interruptNotifyHandler && isMethod(ptrConnection, "interrupt"))
+      s_interruptNotifyHandler();
+}
+
 bool authenticate(boost::shared_ptr<HttpConnection> ptrConnection,
                   const std::string& secret)
 {
@@ -220,6 +320,50 @@ bool authenticate(boost::shared_ptr<HttpConnection> ptrConnection,
    return secret == ptrConnection->request().headerValue("X-Shared-Secret");
 }
 
+namespace {
+
+// traffic log state. resolved once on first use -- only the listener
+// thread calls logTrafficIfEnabled so no synchronization is required
+bool s_trafficLogChecked = false;
+core::FilePath s_trafficLogPath;
+
+} // anonymous namespace
+
+void logTrafficIfEnabled(boost::shared_ptr<HttpConnection> ptrConnection)
+{
+   if (!s_trafficLogChecked)
+   {
+      std::string trafficLog = core::system::getenv(
+                                          "RSTUDIO_SESSION_TRAFFIC_LOG");
+      if (!trafficLog.empty())
+         s_trafficLogPath = core::FilePath(trafficLog);
+      s_trafficLogChecked = true;
+   }
+
+   if (s_trafficLogPath.empty())
+      return;
+
+   // one json object per line -- time is milliseconds since the unix
+   // epoch so the replay harness can reproduce inter-request pacing
+   const core::http::Request& request = ptrConnection->request();
+   boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+   boost::posix_time::ptime now =
+                     boost::posix_time::microsec_clock::universal_time();
+   core::json::Object recordJson;
+   recordJson["time"] = static_cast<double>(
+                                 (now - epoch).total_milliseconds());
+   recordJson["method"] = request.method();
+   recordJson["uri"] = request.uri();
+   recordJson["body"] = request.body();
+
+   std::ostringstream ostr;
+   core::json::write(recordJson, ostr);
+   ostr << "\n";
+   core::Error error = core::appendToFile(s_trafficLogPath, ostr.str());
+   if (error)
+      LOG_ERROR(error);
+}
+
 } // namespace connection
 } // namespace session
 } // namespace rstudio
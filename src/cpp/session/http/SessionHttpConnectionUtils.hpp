@@ -22,6 +22,8 @@
 
 #include <boost/function.hpp>
 
+#include <core/json/JsonRpc.hpp>
+
 namespace rstudio {
 namespace core {
 namespace http {
@@ -50,9 +52,37 @@ bool checkForAbort(boost::shared_ptr<HttpConnection> ptrConnection,
 
 bool checkForSuspend(boost::shared_ptr<HttpConnection> ptrConnection);
 
+// registry of rpc methods whose handlers touch neither R nor any
+// main-thread session state. requests for these methods are executed
+// directly on the listener thread (see checkForThreadSafeMethod below)
+// rather than queued behind the R event loop
+void registerThreadSafeMethod(const std::string& name,
+                              const core::json::JsonRpcFunction& function);
+
+bool checkForThreadSafeMethod(boost::shared_ptr<HttpConnection> ptrConnection);
+
+// out-of-band interrupt notification. the registered handler is invoked
+// on the listener thread as soon as an 'interrupt' rpc is received --
+// before the connection waits its turn on the main connection queue --
+// so the interrupt reaches R immediately even when the queue is deep
+// (e.g. during output floods). the connection is still queued and then
+// handled normally on the foreground thread. the handler must be set
+// before the listener is started (it is read without synchronization)
+void setInterruptNotifyHandler(const boost::function<void()>& handler);
+
+void notifyIfInterrupt(boost::shared_ptr<HttpConnection> ptrConnection);
+
 bool authenticate(boost::shared_ptr<HttpConnection> ptrConnection,
                   const std::string& secret);
 
+// opt-in traffic capture for the replay harness (tests/replay). when
+// the RSTUDIO_SESSION_TRAFFIC_LOG environment variable names a file,
+// every authenticated request is appended to it as one json object per
+// line ({"time", "method", "uri", "body"}) with a millisecond
+// timestamp so the harness can reproduce inter-request pacing. called
+// on the listener thread only
+void logTrafficIfEnabled(boost::shared_ptr<HttpConnection> ptrConnection);
+
 
 } // namespace connection
 } // namespace session
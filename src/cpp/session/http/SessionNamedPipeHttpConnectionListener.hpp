@@ -347,6 +347,10 @@ private:
          return;
       }
 
+      // capture traffic for the replay harness if enabled (opt-in via
+      // RSTUDIO_SESSION_TRAFFIC_LOG, see tests/replay)
+      connection::logTrafficIfEnabled(ptrHttpConnection);
+
       // check for the special rpc/abort endpoint and abort if requested
       // we do this in the background listener thread so it can always
       // be processed even if the foreground thread is deadlocked or otherwise
@@ -365,6 +369,12 @@ private:
       if (connection::checkForSuspend(ptrHttpConnection))
          return;
 
+      // check for a method marked thread-safe and if we get one execute
+      // it here on the listener thread so it doesn't wait on (or tie up)
+      // the R event loop
+      if (connection::checkForThreadSafeMethod(ptrHttpConnection))
+         return;
+
       // place the connection on the correct queue
       if (connection::isGetEvents(ptrHttpConnection))
          eventsConnectionQueue_.enqueConnection(ptrHttpConnection);
@@ -19,6 +19,7 @@
 #include <string>
 
 #include <boost/utility.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <core/BoostThread.hpp>
 
@@ -34,6 +35,8 @@ namespace core {
 namespace rstudio {
 namespace session {
 
+class HttpConnection;
+
 // singleton
 class ClientEventService;
 ClientEventService& clientEventService();
@@ -57,6 +60,15 @@ public:
 private:
    void run();
 
+   // stream events over a persistent server-sent events connection.
+   // returns false if the connection doesn't support streaming (in
+   // which case the caller should respond with a standard long-poll)
+   bool streamEvents(boost::shared_ptr<HttpConnection> ptrConnection,
+                     int* pNextEventId,
+                     bool* pInterrupted);
+
+   std::string pendingEventsAsFrame(int* pLastEventId);
+
    void erasePreviouslyDeliveredEvents(int lastClientEventIdSeen);
    bool havePendingClientEvents();
    void addClientEvent(const core::json::Object& eventObject);
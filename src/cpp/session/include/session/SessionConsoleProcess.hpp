@@ -21,6 +21,7 @@
 #include <boost/signals.hpp>
 #include <boost/circular_buffer.hpp>
 #include <boost/enable_shared_from_this.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 
 #include <core/system/Process.hpp>
 #include <core/Log.hpp>
@@ -147,6 +148,7 @@ private:
    std::string bufferedOutput() const;
    void appendToOutputBuffer(const std::string& str);
    void enqueOutputEvent(const std::string& output, bool error);
+   void flushPendingOutput();
    void handleConsolePrompt(core::system::ProcessOperations& ops,
                             const std::string& prompt);
    void maybeConsolePrompt(core::system::ProcessOperations& ops,
@@ -181,6 +183,11 @@ private:
    // to recover some history
    boost::circular_buffer<char> outputBuffer_;
 
+   // Output batched during rapid-fire delivery (coalesced into one
+   // client event per interval so output storms can't flood the client)
+   std::string pendingOutput_;
+   boost::posix_time::ptime lastOutputEventTime_;
+
    boost::optional<int> exitCode_;
 
    boost::function<bool(const std::string&, Input*)> onPrompt_;
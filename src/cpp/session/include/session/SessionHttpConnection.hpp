@@ -62,6 +62,14 @@ public:
    virtual const core::http::Request& request() = 0;
    virtual void sendResponse(const core::http::Response& response) = 0;
 
+   // optional event-stream interface: begin a server-sent events
+   // response (the connection remains open after the headers are
+   // written) then write frames as data becomes available. connection
+   // types which don't support streaming return an error from
+   // beginEventStream (callers should fall back to request/response)
+   virtual core::Error beginEventStream(const core::http::Response& response);
+   virtual core::Error writeEventStreamData(const std::string& data);
+
    void sendJsonRpcError(const core::Error& error);
    void sendJsonRpcResponse();
    void sendJsonRpcResponse(
@@ -16,11 +16,12 @@
 #ifndef SESSION_HTTP_CONNECTION_QUEUE_HPP
 #define SESSION_HTTP_CONNECTION_QUEUE_HPP
 
-#include <queue>
+#include <deque>
 
 #include <boost/shared_ptr.hpp>
 
 #include <boost/utility.hpp>
+#include <boost/atomic.hpp>
 
 #include <core/BoostThread.hpp>
 
@@ -35,17 +36,21 @@ namespace core {
 namespace rstudio {
 namespace session {
 
+// multi-producer single-consumer connection queue. producers (listener
+// threads) push onto a lock-free stack; the consumer moves pushed
+// connections into a private deque (restoring fifo order) so the
+// dequeue hot path never takes a lock. producers wake a waiting
+// consumer through a pipe (posix) or condition variable (win32)
 class HttpConnectionQueue : boost::noncopyable
 {
 public:
-   HttpConnectionQueue()
-      : pMutex_(new boost::mutex()),
-        pWaitCondition_(new boost::condition())
-   {
-   }
+   HttpConnectionQueue();
 
    void enqueConnection(boost::shared_ptr<HttpConnection> ptrConnection);
 
+   // NOTE: dequeConnection and peekNextConnectionUri are consumer-side
+   // methods (they must only be called from the single consumer thread)
+
    boost::shared_ptr<HttpConnection> dequeConnection();
 
    boost::shared_ptr<HttpConnection> dequeConnection(
@@ -55,11 +60,45 @@ public:
 
    boost::posix_time::ptime lastConnectionTime();
 
+   // admission control: register an rpc method for which only the most
+   // recently received queued request is meaningful (completion and
+   // lint style asks, whose results are superseded by any newer ask).
+   // when the consumer drains a backlog -- e.g. after R has been busy
+   // -- older queued requests for these methods are answered
+   // immediately with MethodUnexpected rather than executed, so
+   // post-busy recovery only services the latest ask of each kind
+   static void registerSupersededMethod(const std::string& method);
+
 private:
+   // node in the lock-free producer stack
+   struct Node
+   {
+      explicit Node(boost::shared_ptr<HttpConnection> ptrConnection)
+         : ptrConnection(ptrConnection), pNext(NULL)
+      {
+      }
+      boost::shared_ptr<HttpConnection> ptrConnection;
+      Node* pNext;
+   };
+
    boost::shared_ptr<HttpConnection> doDequeConnection();
+   void drainIncoming();
+   void collapseSuperseded();
    bool waitForConnection(const boost::posix_time::time_duration& waitDuration);
+   void wakeConsumer();
 
 private:
+   // incoming lock-free stack (newest first -- reversed when drained)
+   boost::atomic<Node*> pIncoming_;
+
+   // consumer's private fifo (only touched by the consumer thread)
+   std::deque<boost::shared_ptr<HttpConnection> > consumerQueue_;
+
+#ifndef _WIN32
+   // wakeup pipe -- producers write a byte after pushing and the
+   // consumer polls the read end when it needs to wait
+   int wakeupFds_[2];
+#else
    // synchronization objects. heap based so they are never destructed
    // we don't want them destructed because in desktop mode we don't
    // explicitly stop the queue and this sometimes results in mutex
@@ -67,14 +106,16 @@ private:
    // it is being destroyed
    boost::mutex* pMutex_ ;
    boost::condition* pWaitCondition_ ;
+#endif
 
-   // instance data
+   // the last connection time is read from other threads (the main
+   // thread inspects the event queue's time) so it has its own lock
+   // (heap based for the same reason as above)
+   boost::mutex* pTimeMutex_ ;
    boost::posix_time::ptime lastConnectionTime_;
-   std::queue<boost::shared_ptr<HttpConnection> > queue_;
 };
 
 } // namespace session
 } // namespace rstudio
 
 #endif // SESSION_HTTP_CONNECTION_QUEUE_HPP
-
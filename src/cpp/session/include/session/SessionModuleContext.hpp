@@ -221,6 +221,31 @@ core::Error registerIdleOnlyAsyncRpcMethod(
 core::Error registerRpcMethod(const std::string& name,
                               const core::json::JsonRpcFunction& function);
 
+// register an rpc method whose handler is safe to execute off the main
+// thread -- i.e. it touches neither R nor any main-thread session state.
+// requests for the method are handled directly on the http listener
+// thread so they are never queued behind console execution or other
+// long-running rpcs. the method also remains registered for main-thread
+// dispatch (e.g. for execute_batch)
+core::Error registerThreadSafeRpcMethod(
+                              const std::string& name,
+                              const core::json::JsonRpcFunction& function);
+
+// register a speculative prefetch for a predictable rpc sequence. after
+// triggerMethod completes successfully the builder is offered the trigger
+// request and raw response; if it can fully determine a follow-on request
+// the client is about to make it fills in *pPrefetchRequest and returns
+// true, and the follow-on method is executed during idle time with its
+// response cached briefly so the client's matching rpc is answered
+// without re-executing the handler
+typedef boost::function<bool(const core::json::JsonRpcRequest&,
+                             const core::json::Object&,
+                             core::json::JsonRpcRequest*)>
+                                                   RpcPrefetchBuilderFunction;
+core::Error registerRpcPrefetch(
+                        const std::string& triggerMethod,
+                        const RpcPrefetchBuilderFunction& builderFunction);
+
 
 core::Error executeAsync(const core::json::JsonRpcFunction& function,
                          const core::json::JsonRpcRequest& request,
@@ -333,6 +358,7 @@ struct Events : boost::noncopyable
    boost::signal<void ()>                    onQuit;
    boost::signal<void (const std::string&)>  onPackageLoaded;
    boost::signal<void ()>                    onPackageLibraryMutated;
+   boost::signal<void ()>                    onMemoryPressure;
    boost::signal<void ()>                    onPreferencesSaved;
    boost::signal<void (const DistributedEvent&)>
                                              onDistributedEvent;
@@ -390,6 +416,23 @@ void scheduleDelayedWork(const boost::posix_time::time_duration& period,
                          const boost::function<void()> &execute,
                          bool idleOnly = true);
 
+// bound the disk space consumed by a module cache directory beneath the
+// scratch path: schedules a deferred idle-time trim which removes the
+// least-recently-written files until the directory fits within
+// maxSizeBytes. only appropriate for caches whose files are regenerable
+// or individually expendable
+void scheduleCacheTrim(const core::FilePath& cacheDirectory,
+                       uintmax_t maxSizeBytes);
+
+// serve a static file the way Response::setCacheableFile does (304 via
+// Last-Modified revalidation) but through a small in-memory content
+// cache, so frequently requested assets (help css/js, mathjax) don't
+// cost a filesystem open/read per request. cache entries are validated
+// against the file's size and last write time
+void setCacheableFileResponse(const core::FilePath& filePath,
+                              const core::http::Request& request,
+                              core::http::Response* pResponse);
+
 
 core::string_utils::LineEnding lineEndings(const core::FilePath& filePath);
 
@@ -68,6 +68,16 @@ public:
    // set contents from string
    void setContents(const std::string& contents);
 
+   // swap-based variant of the above -- takes the contents from
+   // *pContents (leaving it empty) rather than copying them, which
+   // matters for very large documents
+   void setContents(std::string* pContents);
+
+   // set the path without reading contents from the file (the last
+   // known write time is refreshed from the file on disk). used when
+   // the caller has just written the document's contents itself
+   void setPath(const std::string& path);
+
    // set contents from file
    core::Error setPathAndContents(const std::string& path,
                                   bool allowSubstChars = true);
@@ -233,6 +233,11 @@ private:
    core::FilePath settingsFilePath_;
    core::Settings settings_;
 
+   // cached copy of the parsed uiPrefs object (uiPrefs is stored as a
+   // json string so without this cache every read re-parses it; reset
+   // whenever the underlying setting changes)
+   mutable boost::scoped_ptr<core::json::Object> pUiPrefs_;
+
    // cached prefs values
    mutable boost::scoped_ptr<bool> pUseSpacesForTab_;
    mutable boost::scoped_ptr<int> pNumSpacesForTab_;
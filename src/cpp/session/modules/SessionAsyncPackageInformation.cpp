@@ -18,18 +18,24 @@
 
 #include "SessionAsyncPackageInformation.hpp"
 
+#include <map>
 #include <string>
 #include <vector>
 #include <sstream>
 
 #include <core/FilePath.hpp>
+#include <core/FileSerializer.hpp>
 #include <core/json/Json.hpp>
 #include <core/json/JsonRpc.hpp>
 #include <core/Error.hpp>
+#include <core/r_util/RPackageInfo.hpp>
+#include <core/system/Environment.hpp>
 
 #include <boost/format.hpp>
 #include <boost/algorithm/string.hpp>
 
+#include <r/RExec.hpp>
+
 #include <session/SessionModuleContext.hpp>
 
 #include <core/Macros.hpp>
@@ -81,6 +87,81 @@ public:
 
 namespace {
 
+// On-disk cache of harvested package information. Harvesting spawns a
+// child R process and loads every namespace, which dominates the time
+// to first completion after startup; the cache lets us satisfy
+// completions for unchanged packages without touching R at all. One
+// JSON file per package under the user scratch path, validated against
+// the package version and DESCRIPTION mtime (and a format version so
+// we can change the schema without migration logic).
+const int kCacheFormatVersion = 1;
+
+// paths for packages in the current update, so that onCompleted can
+// write back cache entries for the packages it harvested
+std::map<std::string, FilePath> s_packagePaths;
+
+FilePath packageInformationCachePath()
+{
+   return module_context::userScratchPath().childPath("pkg-info-cache");
+}
+
+// optional machine-wide cache, shared read-only between all sessions
+// on a server. an administrator populates it (typically by copying a
+// warmed per-user cache for the site library) and exports the path
+// via RSTUDIO_SHARED_PKG_INFO_CACHE; sessions then only harvest
+// packages not covered there, so the site library is indexed once per
+// machine rather than once per session
+FilePath sharedPackageInformationCachePath()
+{
+   std::string path =
+         core::system::getenv("RSTUDIO_SHARED_PKG_INFO_CACHE");
+   if (path.empty())
+      return FilePath();
+
+   return FilePath(path);
+}
+
+FilePath cachePathForPackage(const std::string& pkgName)
+{
+   return packageInformationCachePath().childPath(pkgName + ".json");
+}
+
+FilePath locatePackageDirectory(const std::string& pkgName,
+                                const std::vector<std::string>& libPaths)
+{
+   for (std::vector<std::string>::const_iterator it = libPaths.begin();
+        it != libPaths.end();
+        ++it)
+   {
+      FilePath pkgPath = FilePath(*it).childPath(pkgName);
+      if (pkgPath.childPath("DESCRIPTION").exists())
+         return pkgPath;
+   }
+
+   return FilePath();
+}
+
+bool packageCacheKey(const FilePath& pkgPath,
+                     std::string* pVersion,
+                     double* pMtime)
+{
+   if (pkgPath.empty())
+      return false;
+
+   FilePath descriptionPath = pkgPath.childPath("DESCRIPTION");
+   if (!descriptionPath.exists())
+      return false;
+
+   core::r_util::RPackageInfo pkgInfo;
+   Error error = pkgInfo.read(pkgPath);
+   if (error)
+      return false;
+
+   *pVersion = pkgInfo.version();
+   *pMtime = static_cast<double>(descriptionPath.lastWriteTime());
+   return true;
+}
+
 void fillFormalInfo(const json::Array& formalNamesJson,
                     const json::Array& formalInfoJsonArray,
                     FunctionInformation* pInfo)
@@ -137,9 +218,151 @@ bool fillFunctionInfo(const json::Object& functionObjectJson,
       
       (*pInfo)[functionName] = info;
    }
-   
+
+   return true;
+
+}
+
+bool parsePackageInformation(const json::Object& objectJson,
+                             core::r_util::PackageInformation* pPkgInfo)
+{
+   json::Array exportsJson;
+   json::Array typesJson;
+   json::Object functionInfoJson;
+
+   Error error = json::readObject(objectJson,
+                                  "package", &(pPkgInfo->package),
+                                  "exports", &exportsJson,
+                                  "types", &typesJson,
+                                  "function_info", &functionInfoJson);
+
+   if (error)
+   {
+      LOG_ERROR(error);
+      return false;
+   }
+
+   if (!json::fillVectorString(exportsJson, &(pPkgInfo->exports)))
+      LOG_ERROR_MESSAGE("Failed to read JSON 'objects' array to vector");
+
+   if (!json::fillVectorInt(typesJson, &(pPkgInfo->types)))
+      LOG_ERROR_MESSAGE("Failed to read JSON 'types' array to vector");
+
+   if (!fillFunctionInfo(functionInfoJson, pPkgInfo->package, &(pPkgInfo->functionInfo)))
+      LOG_ERROR_MESSAGE("Failed to read JSON 'functions' object to map");
+
    return true;
-   
+}
+
+bool loadPackageInformationFromCacheFile(const std::string& pkgName,
+                                         const FilePath& pkgPath,
+                                         const FilePath& cachePath)
+{
+   if (!cachePath.exists())
+      return false;
+
+   // NOTE: whole-file reads go through the memory-mapping path in
+   // FileSerializer, so warm startups don't copy the cache through
+   // stream buffers
+   std::string contents;
+   Error error = core::readStringFromFile(cachePath, &contents);
+   if (error)
+   {
+      LOG_ERROR(error);
+      return false;
+   }
+
+   json::Value value;
+   if (!json::parse(contents, &value) || !json::isType<json::Object>(value))
+      return false;
+
+   int cacheVersion = 0;
+   std::string pkgVersion;
+   double mtime = 0;
+   json::Object infoJson;
+   error = json::readObject(value.get_obj(),
+                            "cache_version", &cacheVersion,
+                            "package_version", &pkgVersion,
+                            "description_mtime", &mtime,
+                            "info", &infoJson);
+   if (error)
+      return false;
+
+   if (cacheVersion != kCacheFormatVersion)
+      return false;
+
+   // stale if the installed package's version or mtime have moved on
+   std::string currentVersion;
+   double currentMtime = 0;
+   if (!packageCacheKey(pkgPath, &currentVersion, &currentMtime))
+      return false;
+
+   if (pkgVersion != currentVersion || mtime != currentMtime)
+      return false;
+
+   core::r_util::PackageInformation pkgInfo;
+   if (!parsePackageInformation(infoJson, &pkgInfo))
+      return false;
+
+   if (pkgInfo.package != pkgName)
+      return false;
+
+   DEBUG("Loaded cached package information for '" << pkgName << "'");
+   RSourceIndex::addPackageInformation(pkgName, pkgInfo);
+   return true;
+}
+
+bool loadPackageInformationFromCache(const std::string& pkgName,
+                                     const FilePath& pkgPath)
+{
+   // prefer the machine-wide cache when configured, then fall back to
+   // the per-user cache
+   FilePath sharedCachePath = sharedPackageInformationCachePath();
+   if (!sharedCachePath.empty() &&
+       loadPackageInformationFromCacheFile(
+             pkgName,
+             pkgPath,
+             sharedCachePath.childPath(pkgName + ".json")))
+   {
+      return true;
+   }
+
+   return loadPackageInformationFromCacheFile(
+            pkgName,
+            pkgPath,
+            cachePathForPackage(pkgName));
+}
+
+void savePackageInformationToCache(const std::string& pkgName,
+                                   const json::Object& infoJson)
+{
+   std::map<std::string, FilePath>::const_iterator it =
+         s_packagePaths.find(pkgName);
+   if (it == s_packagePaths.end())
+      return;
+
+   std::string version;
+   double mtime = 0;
+   if (!packageCacheKey(it->second, &version, &mtime))
+      return;
+
+   json::Object cacheJson;
+   cacheJson["cache_version"] = kCacheFormatVersion;
+   cacheJson["package_version"] = version;
+   cacheJson["description_mtime"] = mtime;
+   cacheJson["info"] = infoJson;
+
+   Error error = packageInformationCachePath().ensureDirectory();
+   if (error)
+   {
+      LOG_ERROR(error);
+      return;
+   }
+
+   error = core::writeStringToFile(cachePathForPackage(pkgName),
+                                   json::write(cacheJson));
+   if (error)
+      LOG_ERROR(error);
 }
 
 } // anonymous namespace
@@ -177,10 +400,6 @@ void AsyncPackageInformationProcess::onCompleted(int exitStatus)
    // }
    for (std::size_t i = 0; i < n; ++i)
    {
-      json::Array exportsJson;
-      json::Array typesJson;
-      json::Object functionInfoJson;
-      
       core::r_util::PackageInformation pkgInfo;
 
       if (splat[i].empty())
@@ -199,37 +418,22 @@ void AsyncPackageInformationProcess::onCompleted(int exitStatus)
          LOG_ERROR_MESSAGE("Failed to parse JSON: '" + subset + "'");
          continue;
       }
-      
+
       // Ensure that this parsed as an Object -- this might have parsed as
       // something else if e.g. we got malformed output on load of a package
       if (!json::isType<json::Object>(value))
          continue;
-      
-      Error error = json::readObject(value.get_obj(),
-                                     "package", &pkgInfo.package,
-                                     "exports", &exportsJson,
-                                     "types", &typesJson,
-                                     "function_info", &functionInfoJson);
 
-      if (error)
-      {
-         LOG_ERROR(error);
+      if (!parsePackageInformation(value.get_obj(), &pkgInfo))
          continue;
-      }
 
       DEBUG("Adding entry for package: '" << pkgInfo.package << "'");
 
-      if (!json::fillVectorString(exportsJson, &(pkgInfo.exports)))
-         LOG_ERROR_MESSAGE("Failed to read JSON 'objects' array to vector");
-
-      if (!json::fillVectorInt(typesJson, &(pkgInfo.types)))
-         LOG_ERROR_MESSAGE("Failed to read JSON 'types' array to vector");
-
-      if (!fillFunctionInfo(functionInfoJson, pkgInfo.package, &(pkgInfo.functionInfo)))
-         LOG_ERROR_MESSAGE("Failed to read JSON 'functions' object to map");
-      
       // Update the index
       core::r_util::RSourceIndex::addPackageInformation(pkgInfo.package, pkgInfo);
+
+      // Persist for the next session
+      savePackageInformationToCache(pkgInfo.package, value.get_obj());
    }
 
 }
@@ -247,7 +451,33 @@ void AsyncPackageInformationProcess::update()
    
    s_pkgsToUpdate_ =
       RSourceIndex::getAllUnindexedPackages();
-   
+
+   // satisfy what we can from the on-disk cache; only packages that
+   // changed (or were never harvested) need the child R process.
+   // NOTE: we run on the main thread here so it's safe to ask R for
+   // the current library paths
+   std::vector<std::string> libPaths;
+   Error error = r::exec::RFunction(".libPaths").call(&libPaths);
+   if (error)
+      LOG_ERROR(error);
+
+   s_packagePaths.clear();
+   std::vector<std::string> pkgsNeedingUpdate;
+   for (std::vector<std::string>::const_iterator it = s_pkgsToUpdate_.begin();
+        it != s_pkgsToUpdate_.end();
+        ++it)
+   {
+      FilePath pkgPath = locatePackageDirectory(*it, libPaths);
+      if (!pkgPath.empty())
+         s_packagePaths[*it] = pkgPath;
+
+      if (loadPackageInformationFromCache(*it, pkgPath))
+         continue;
+
+      pkgsNeedingUpdate.push_back(*it);
+   }
+   s_pkgsToUpdate_ = pkgsNeedingUpdate;
+
    // alias for readability
    const std::vector<std::string>& pkgs = s_pkgsToUpdate_;
    
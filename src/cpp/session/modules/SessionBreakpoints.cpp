@@ -16,6 +16,7 @@
 #include "environment/EnvironmentUtils.hpp"
 
 #include <algorithm>
+#include <map>
 
 #include <boost/bind.hpp>
 #include <boost/format.hpp>
@@ -194,6 +195,28 @@ std::vector<int> getShinyBreakpointLines(const ShinyFunction& sf)
    return lines;
 }
 
+// Cached sync state for get_function_state requests. Resolving and
+// deparsing the function in R is the expensive part of servicing the
+// request, and a function's sync state can only change when its source
+// file changes on disk or when R code is executed (which may redefine
+// the function) -- so results are cached keyed by function/file/package
+// and invalidated on those events (file identity is checked below; the
+// whole cache is discarded on console prompt).
+struct FunctionSyncState
+{
+   FunctionSyncState() : lastWriteTime(0), size(0), inSync(false) {}
+   std::time_t lastWriteTime;
+   uintmax_t size;
+   bool inSync;
+};
+std::map<std::string, FunctionSyncState> s_functionSyncStateCache;
+
+void onConsolePrompt(const std::string&)
+{
+   // R code was just executed and may have redefined functions
+   s_functionSyncStateCache.clear();
+}
+
 // Runs a series of pre-flight checks to determine whether we can set a
 // breakpoint at the given location, and, if we can, what kind of breakpoint
 // we should set.
@@ -212,30 +235,62 @@ Error getFunctionState(const json::JsonRpcRequest& request,
    }
 
    // check whether the function is in a package
-   packageName = module_context::packageNameForSourceFile(
-                    module_context::resolveAliasedPath(fileName));
-
-   // get the source refs and code for the function
-   SEXP srcRefs = NULL;
-   Protect protect;
-   std::string functionCode;
-   error = r::exec::RFunction(".rs.getFunctionSourceRefs",
-                              functionName,
-                              fileName,
-                              packageName)
-         .call(&srcRefs, &protect);
-   if (!error)
+   FilePath sourceFilePath = module_context::resolveAliasedPath(fileName);
+   packageName = module_context::packageNameForSourceFile(sourceFilePath);
+
+   // consult the cache -- a hit means neither the file nor (since the
+   // last console prompt) the function can have changed, so the R-side
+   // resolution and deparse can be skipped entirely
+   std::string cacheKey = functionName + "\n" + fileName + "\n" + packageName;
+   std::map<std::string, FunctionSyncState>::const_iterator cacheIt =
+                                    s_functionSyncStateCache.find(cacheKey);
+   if (cacheIt != s_functionSyncStateCache.end() &&
+       sourceFilePath.exists() &&
+       sourceFilePath.lastWriteTime() == cacheIt->second.lastWriteTime &&
+       sourceFilePath.size() == cacheIt->second.size)
+   {
+      inSync = cacheIt->second.inSync;
+   }
+   else
    {
-      error = r::exec::RFunction(".rs.getFunctionSourceCode",
+      // get the source refs and code for the function (a single call --
+      // resolving the function is the expensive part)
+      SEXP stateSEXP = NULL;
+      Protect protect;
+      error = r::exec::RFunction(".rs.getFunctionSourceState",
                                  functionName,
                                  fileName,
                                  packageName)
-            .call(&functionCode);
+            .call(&stateSEXP, &protect);
+
+      // compare with the disk if we were able to get the source code;
+      // otherwise, assume it's out of sync
+      if (!error && TYPEOF(stateSEXP) != NILSXP)
+      {
+         SEXP srcRefs = NULL;
+         std::string functionCode;
+         error = r::sexp::getNamedListSEXP(stateSEXP, "refs", &srcRefs);
+         if (!error)
+            error = r::sexp::getNamedListElement(stateSEXP,
+                                                 "code",
+                                                 &functionCode);
+         if (!error)
+         {
+            inSync = !environment::functionDiffersFromSource(srcRefs,
+                                                             functionCode);
+
+            // cache the result against the file's current identity
+            if (sourceFilePath.exists())
+            {
+               FunctionSyncState syncState;
+               syncState.lastWriteTime = sourceFilePath.lastWriteTime();
+               syncState.size = sourceFilePath.size();
+               syncState.inSync = inSync;
+               s_functionSyncStateCache[cacheKey] = syncState;
+            }
+         }
+      }
    }
-   // compare with the disk if we were able to get the source code;
-   // otherwise, assume it's out of sync
-   if (!error)
-      inSync = !environment::functionDiffersFromSource(srcRefs, functionCode);
 
    response["sync_state"] = inSync;
    response["package_name"] = packageName;
@@ -623,6 +678,9 @@ Error initialize()
    using boost::bind;
    using namespace module_context;
 
+   // discard cached function sync state whenever R code is executed
+   events().onConsolePrompt.connect(bind(onConsolePrompt, _1));
+
    ExecBlock initBlock ;
    initBlock.addFunctions()
       (bind(registerRpcMethod, "get_function_state", getFunctionState))
@@ -18,7 +18,10 @@
 
 #include "SessionCodeSearch.hpp"
 
+#include <deque>
 #include <iostream>
+#include <map>
+#include <sstream>
 #include <vector>
 #include <set>
 
@@ -37,6 +40,9 @@
 #include <core/SafeConvert.hpp>
 #include <core/collection/Tree.hpp>
 
+#include <core/json/Json.hpp>
+#include <core/json/JsonRpc.hpp>
+
 #include <core/r_util/RSourceIndex.hpp>
 
 #include <core/system/FileChangeEvent.hpp>
@@ -132,26 +138,77 @@ bool enforceMaxResults(std::size_t maxResults,
 }
 
 
+// bitmask summarizing which (case-folded) characters occur within a
+// range of text: one bit per ascii letter, one for digits, and one
+// for everything else. used as a cheap prefilter for subsequence
+// matching -- a query which uses a character class the candidate
+// lacks cannot possibly match, so the candidate can be rejected
+// without running the full subsequence scan
+unsigned int charMask(const std::string& text,
+                      std::string::size_type begin,
+                      std::string::size_type end)
+{
+   unsigned int mask = 0;
+   for (std::string::size_type i = begin; i < end; i++)
+   {
+      char ch = text[i];
+      if (ch >= 'A' && ch <= 'Z')
+         ch += 'a' - 'A';
+
+      if (ch >= 'a' && ch <= 'z')
+         mask |= 1u << (ch - 'a');
+      else if (ch >= '0' && ch <= '9')
+         mask |= 1u << 26;
+      else
+         mask |= 1u << 27;
+   }
+   return mask;
+}
+
+// character mask for the name (last path element) of a file
+unsigned int nameCharMask(const FileInfo& fileInfo)
+{
+   const std::string& absolutePath = fileInfo.absolutePath();
+   std::string::size_type lastSlash = absolutePath.rfind('/');
+   std::string::size_type begin =
+         (lastSlash == std::string::npos) ? 0 : lastSlash + 1;
+   return charMask(absolutePath, begin, absolutePath.length());
+}
+
+// true if the query's character mask guarantees it cannot match
+// within the candidate's character mask
+inline bool charMaskRejects(unsigned int candidateMask,
+                            unsigned int queryMask)
+{
+   return (queryMask & ~candidateMask) != 0;
+}
+
 // index entries we are managing
 struct Entry
 {
    explicit Entry()
+      : charMask(0)
    {
    }
 
    explicit Entry(const FileInfo& fileInfo)
-      : fileInfo(fileInfo)
+      : fileInfo(fileInfo), charMask(nameCharMask(fileInfo))
    {
    }
-   
+
    Entry(const FileInfo& fileInfo,
          boost::shared_ptr<core::r_util::RSourceIndex> pIndex)
-      : fileInfo(fileInfo), pIndex(pIndex)
+      : fileInfo(fileInfo), pIndex(pIndex), charMask(nameCharMask(fileInfo))
    {
    }
-   
+
    FileInfo fileInfo;
    boost::shared_ptr<core::r_util::RSourceIndex> pIndex;
+
+   // character mask of the file's name (computed once at insertion
+   // so that searches can prefilter entries without touching their
+   // paths)
+   unsigned int charMask;
    
    bool hasIndex() const { return pIndex.get() != NULL; }
    
@@ -423,6 +480,74 @@ private:
    
 };
 
+// bump this whenever the on-disk format of the persistent index
+// cache changes (older caches are silently discarded)
+const int kIndexCacheVersion = 2;
+
+// persistent index cache serialization. the cache stores, for each
+// indexed source file, the identity of the file when it was parsed
+// (last write time + size) alongside the symbols extracted from it,
+// so that subsequent sessions can restore the index for unchanged
+// files without re-reading or re-parsing them
+
+json::Object sourceItemToJson(const r_util::RSourceItem& item)
+{
+   json::Object itemJson;
+   itemJson["type"] = item.type();
+   itemJson["name"] = item.name();
+   itemJson["brace_level"] = item.braceLevel();
+   itemJson["line"] = item.line();
+   itemJson["column"] = item.column();
+   json::Array signatureJson;
+   BOOST_FOREACH(const r_util::RS4MethodParam& param, item.signature())
+   {
+      json::Object paramJson;
+      paramJson["name"] = param.name();
+      paramJson["type"] = param.type();
+      signatureJson.push_back(paramJson);
+   }
+   itemJson["signature"] = signatureJson;
+   return itemJson;
+}
+
+bool sourceItemFromJson(const json::Value& itemValue, r_util::RSourceItem* pItem)
+{
+   if (!json::isType<json::Object>(itemValue))
+      return false;
+
+   int type, braceLevel, line, column;
+   std::string name;
+   json::Array signatureJson;
+   Error error = json::readObject(itemValue.get_obj(),
+                                  "type", &type,
+                                  "name", &name,
+                                  "brace_level", &braceLevel,
+                                  "line", &line,
+                                  "column", &column,
+                                  "signature", &signatureJson);
+   if (error)
+      return false;
+
+   std::vector<r_util::RS4MethodParam> signature;
+   BOOST_FOREACH(const json::Value& paramValue, signatureJson)
+   {
+      if (!json::isType<json::Object>(paramValue))
+         return false;
+
+      std::string paramName, paramType;
+      error = json::readObject(paramValue.get_obj(),
+                               "name", &paramName,
+                               "type", &paramType);
+      if (error)
+         return false;
+
+      signature.push_back(r_util::RS4MethodParam(paramName, paramType));
+   }
+
+   *pItem = r_util::RSourceItem(type, name, signature, braceLevel, line, column);
+   return true;
+}
+
 class SourceFileIndex : boost::noncopyable
 {
 public:
@@ -458,7 +583,7 @@ public:
       for ( ; begin != end; ++begin)
       {
          FileChangeEvent addEvent(FileChangeEvent::FileAdded, *begin);
-         indexingQueue_.push(addEvent);
+         indexingQueue_.push_back(addEvent);
       }
 
       // schedule indexing if necessary. perform up to 200ms of work
@@ -478,8 +603,22 @@ public:
 
    void enqueFileChange(const core::system::FileChangeEvent& event)
    {
-      // add to the queue
-      indexingQueue_.push(event);
+      // coalesce with the most recently queued event if it refers to
+      // the same file (editors and build tools commonly emit bursts
+      // of writes to a single file -- only the final state needs to
+      // be indexed)
+      if (!indexingQueue_.empty() &&
+          indexingQueue_.back().type() == event.type() &&
+          indexingQueue_.back().fileInfo().absolutePath() ==
+                                       event.fileInfo().absolutePath())
+      {
+         indexingQueue_.back() = event;
+      }
+      else
+      {
+         // add to the queue
+         indexingQueue_.push_back(event);
+      }
 
       // schedule indexing if necessary. don't index anything immediately
       // (this is to defend against large numbers of files being enqued
@@ -581,7 +720,23 @@ public:
 
       // create wildcard pattern if the search has a '*'
       boost::regex pattern = regex_utils::regexIfWildcardPattern(term);
-      
+
+      // We allow the user to submit queries of the form e.g.
+      // <query>:<row><column>; make sure we only take items
+      // on the query up to ':'
+      std::string::size_type queryEnd = term.find(":");
+      if (queryEnd == std::string::npos)
+         queryEnd = term.length();
+
+      // character mask of the query -- candidates whose names lack a
+      // character class the query uses can be rejected without
+      // touching their paths (only sound for non-wildcard queries:
+      // both prefix and subsequence matches require every query
+      // character to appear in the name)
+      unsigned int queryMask = prefixOnly ?
+               charMask(term, 0, term.length()) :
+               charMask(term, 0, queryEnd);
+
       // get the start and end iterators -- default to all leaves
       EntryTree::leaf_iterator it = pEntries_->begin_leaf();
       
@@ -607,13 +762,17 @@ public:
       for (; pEntries_->is_valid(it); ++it)
       {
          const Entry& entry = *it;
-         
+
          DEBUG("Node: '" << (*it).fileInfo.absolutePath() << "'");
-         
+
+         // check the character mask prefilter before anything else
+         if (pattern.empty() && charMaskRejects(entry.charMask, queryMask))
+            continue;
+
          // skip if it's not a source file
          if (sourceFilesOnly && !isSourceFile(entry.fileInfo))
             continue;
-         
+
          // get file and name
          FilePath filePath(entry.fileInfo.absolutePath());
          std::string name = filePath.filename();
@@ -633,13 +792,6 @@ public:
                matches = boost::algorithm::istarts_with(name, term);
             else
             {
-               // We allow the user to submit queries of the form e.g.
-               // <query>:<row><column>; make sure we only take items
-               // on the query up to ':'
-               std::string::size_type queryEnd = term.find(":");
-               if (queryEnd == std::string::npos)
-                  queryEnd = term.length();
-
                matches = string_utils::isSubsequence(name,
                                                      term,
                                                      queryEnd,
@@ -674,6 +826,8 @@ public:
       if (parentItr == pEntries_->end())
          return;
       
+      unsigned int queryMask = charMask(term, 0, term.length());
+
       EntryTree::iterator it = parentItr.begin();
       EntryTree::iterator end = parentItr.end();
       for (; it != end; ++it)
@@ -681,6 +835,9 @@ public:
          const FileInfo& fileInfo = (*it).fileInfo;
          if (fileInfo.isDirectory())
          {
+            if (charMaskRejects((*it).charMask, queryMask))
+               continue;
+
             int lastSlashIndex = fileInfo.absolutePath().rfind('/');
 
             std::string fileName =
@@ -716,6 +873,8 @@ public:
       if (parentItr == pEntries_->end())
          return;
 
+      unsigned int queryMask = charMask(term, 0, term.length());
+
       EntryTree::iterator it = parentItr.begin();
       EntryTree::iterator end = parentItr.end();
       for (; it != end; ++it)
@@ -726,6 +885,10 @@ public:
          if (fileInfo.empty())
             continue;
 
+         // check the character mask prefilter before touching the path
+         if (charMaskRejects((*it).charMask, queryMask))
+            continue;
+
          int lastSlashIndex = fileInfo.absolutePath().rfind('/');
 
          std::string fileName =
@@ -771,10 +934,136 @@ public:
    void clear()
    {
       indexing_ = false;
-      indexingQueue_ = std::queue<core::system::FileChangeEvent>();
+      indexingQueue_.clear();
+      knownFiles_.clear();
       pEntries_->clear();
    }
 
+   // load the persistent index cache from the project scratch path
+   // (no-op if there is no project or no cache has been written yet)
+   void loadIndexCache()
+   {
+      FilePath cachePath = indexCachePath();
+      if (cachePath.empty() || !cachePath.exists())
+         return;
+
+      std::string contents;
+      Error error = core::readStringFromFile(cachePath, &contents);
+      if (error)
+      {
+         LOG_ERROR(error);
+         return;
+      }
+
+      // a corrupt or incompatible cache isn't an error -- we simply
+      // rebuild the index from scratch
+      json::Value indexValue;
+      if (!json::parse(contents, &indexValue) ||
+          !json::isType<json::Object>(indexValue))
+      {
+         return;
+      }
+
+      int version;
+      json::Object entriesJson;
+      error = json::readObject(indexValue.get_obj(),
+                               "version", &version,
+                               "entries", &entriesJson);
+      if (error || version != kIndexCacheVersion)
+         return;
+
+      BOOST_FOREACH(const json::Object::value_type& entry, entriesJson)
+      {
+         if (json::isType<json::Object>(entry.second))
+            indexCache_[entry.first] = entry.second.get_obj();
+      }
+
+      // warm the entry tree from the snapshot of files known at save
+      // time: every file whose identity still matches (a quick stat
+      // sweep) is restored immediately, so Go To File and workspace
+      // symbol search are populated as soon as the project opens.
+      // files which changed, appeared, or vanished while the session
+      // was down are simply skipped here -- the file monitor's full
+      // enumeration reconciles them as usual
+      json::Array filesJson;
+      error = json::readObject(indexValue.get_obj(), "files", &filesJson);
+      if (error)
+         return;
+
+      BOOST_FOREACH(const json::Value& fileValue, filesJson)
+      {
+         if (!json::isType<json::Object>(fileValue))
+            continue;
+
+         std::string path;
+         double size, lastWriteTime;
+         Error fileError = json::readObject(fileValue.get_obj(),
+                                            "path", &path,
+                                            "size", &size,
+                                            "last_write_time", &lastWriteTime);
+         if (fileError)
+            continue;
+
+         FilePath filePath(path);
+         if (!filePath.exists() ||
+             static_cast<double>(filePath.size()) != size ||
+             static_cast<double>(filePath.lastWriteTime()) != lastWriteTime)
+         {
+            continue;
+         }
+
+         updateIndexEntry(FileInfo(path,
+                                   false,
+                                   filePath.size(),
+                                   filePath.lastWriteTime()));
+      }
+   }
+
+   // save the persistent index cache. only entries which were
+   // validated or refreshed during this session are written (this
+   // prunes entries for files which no longer exist)
+   void saveIndexCache()
+   {
+      FilePath cachePath = indexCachePath();
+      if (cachePath.empty())
+         return;
+
+      json::Object entriesJson;
+      BOOST_FOREACH(const std::string& path, usedCacheKeys_)
+      {
+         std::map<std::string, json::Object>::const_iterator it =
+                                                   indexCache_.find(path);
+         if (it != indexCache_.end())
+            entriesJson[path] = it->second;
+      }
+
+      // snapshot the identity of every file currently in the entry
+      // tree so the next session can rebuild it without waiting for
+      // the initial file monitor scan
+      json::Array filesJson;
+      typedef std::map<std::string, FileInfo>::value_type KnownFile;
+      BOOST_FOREACH(const KnownFile& file, knownFiles_)
+      {
+         json::Object fileJson;
+         fileJson["path"] = file.second.absolutePath();
+         fileJson["size"] = static_cast<double>(file.second.size());
+         fileJson["last_write_time"] =
+                        static_cast<double>(file.second.lastWriteTime());
+         filesJson.push_back(fileJson);
+      }
+
+      json::Object indexJson;
+      indexJson["version"] = kIndexCacheVersion;
+      indexJson["entries"] = entriesJson;
+      indexJson["files"] = filesJson;
+
+      std::ostringstream ostr;
+      json::write(indexJson, ostr);
+      Error error = core::writeStringToFile(cachePath, ostr.str());
+      if (error)
+         LOG_ERROR(error);
+   }
+
 private:
 
    bool dequeAndIndex()
@@ -785,7 +1074,7 @@ private:
       {
          // remove the event from the queue
          FileChangeEvent event = indexingQueue_.front();
-         indexingQueue_.pop();
+         indexingQueue_.pop_front();
 
          // process the change
          const FileInfo& fileInfo = event.fileInfo();
@@ -816,6 +1105,16 @@ private:
 
    void updateIndexEntry(const FileInfo& fileInfo)
    {
+      // skip files which are already indexed and unchanged. the
+      // monitor can deliver redundant events for a single change,
+      // and the full enumeration performed when monitoring starts
+      // consists mostly of files we have already seen -- only the
+      // actual deltas need to be (re)indexed
+      std::map<std::string, FileInfo>::iterator knownIt =
+                                 knownFiles_.find(fileInfo.absolutePath());
+      if (knownIt != knownFiles_.end() && knownIt->second == fileInfo)
+         return;
+
       // index the source if necessary
       boost::shared_ptr<r_util::RSourceIndex> pIndex;
 
@@ -828,39 +1127,57 @@ private:
 
       if (isIndexableSourceFile(fileInfo))
       {
-         std::string code;
-         Error error = module_context::readAndDecodeFile(
+         // consult the persistent cache first -- if the file is
+         // unchanged since it was last parsed we can restore its
+         // symbols without reading or parsing it
+         if (!restoreEntryFromCache(fileInfo, &pIndex))
+         {
+            std::string code;
+            Error error = module_context::readAndDecodeFile(
                                  filePath,
                                  projects::projectContext().defaultEncoding(),
                                  true,
                                  &code);
-         if (error)
-         {
-            // log if not path not found error (this can happen if the
-            // file was removed after entering the indexing queue)
-            if (!core::isPathNotFoundError(error))
+            if (error)
             {
-               error.addProperty("src-file", filePath.absolutePath());
-               LOG_ERROR(error);
+               // log if not path not found error (this can happen if the
+               // file was removed after entering the indexing queue)
+               if (!core::isPathNotFoundError(error))
+               {
+                  error.addProperty("src-file", filePath.absolutePath());
+                  LOG_ERROR(error);
+               }
+               return;
             }
-            return;
-         }
 
-         // add index entry
-         std::string context = module_context::createAliasedPath(filePath);
-         pIndex.reset(new r_util::RSourceIndex(context, code));
+            // add index entry
+            std::string context = module_context::createAliasedPath(filePath);
+            pIndex.reset(new r_util::RSourceIndex(context, code));
+
+            // refresh the persistent cache
+            cacheEntry(fileInfo, pIndex);
+         }
       }
 
       // attempt to add the entry
       Entry entry(fileInfo, pIndex);
       pEntries_->insertEntry(entry);
 
+      // remember the file's identity so that redundant events for it
+      // can be skipped
+      knownFiles_[fileInfo.absolutePath()] = fileInfo;
+
       // kick off an update
       r_packages::AsyncPackageInformationProcess::update();
    }
 
    void removeIndexEntry(const FileInfo& fileInfo)
    {
+      // drop any cached copy
+      indexCache_.erase(fileInfo.absolutePath());
+      usedCacheKeys_.erase(fileInfo.absolutePath());
+      knownFiles_.erase(fileInfo.absolutePath());
+
       // create a fake entry with a null source index to pass to find
       Entry entry(fileInfo, boost::shared_ptr<r_util::RSourceIndex>());
 
@@ -874,6 +1191,95 @@ private:
       }
    }
 
+   // attempt to restore the index for a file from the persistent
+   // cache. succeeds only when the cached last write time and size
+   // match the file exactly
+   bool restoreEntryFromCache(const FileInfo& fileInfo,
+                              boost::shared_ptr<r_util::RSourceIndex>* pIndex)
+   {
+      std::map<std::string, json::Object>::const_iterator it =
+                                 indexCache_.find(fileInfo.absolutePath());
+      if (it == indexCache_.end())
+         return false;
+
+      double lastWriteTime, size;
+      std::string context;
+      json::Array packagesJson, itemsJson;
+      Error error = json::readObject(it->second,
+                                     "last_write_time", &lastWriteTime,
+                                     "size", &size,
+                                     "context", &context,
+                                     "packages", &packagesJson,
+                                     "items", &itemsJson);
+      if (error)
+         return false;
+
+      // verify that the file is unchanged
+      if (lastWriteTime != static_cast<double>(fileInfo.lastWriteTime()) ||
+          size != static_cast<double>(fileInfo.size()))
+      {
+         return false;
+      }
+
+      // rebuild the index from the cached symbols
+      boost::shared_ptr<r_util::RSourceIndex> pRestored(
+                        new r_util::RSourceIndex(context, std::string()));
+      BOOST_FOREACH(const json::Value& itemValue, itemsJson)
+      {
+         r_util::RSourceItem item;
+         if (!sourceItemFromJson(itemValue, &item))
+            return false;
+         pRestored->addSourceItem(item);
+      }
+      BOOST_FOREACH(const json::Value& packageValue, packagesJson)
+      {
+         if (!json::isType<std::string>(packageValue))
+            return false;
+         pRestored->addInferredPackage(packageValue.get_str());
+      }
+
+      usedCacheKeys_.insert(fileInfo.absolutePath());
+      *pIndex = pRestored;
+      return true;
+   }
+
+   // record a freshly parsed index in the persistent cache
+   void cacheEntry(const FileInfo& fileInfo,
+                   boost::shared_ptr<r_util::RSourceIndex> pIndex)
+   {
+      json::Object entryJson;
+      entryJson["last_write_time"] =
+                           static_cast<double>(fileInfo.lastWriteTime());
+      entryJson["size"] = static_cast<double>(fileInfo.size());
+      entryJson["context"] = pIndex->context();
+
+      json::Array packagesJson;
+      BOOST_FOREACH(const std::string& pkg, pIndex->getInferredPackages())
+      {
+         packagesJson.push_back(pkg);
+      }
+      entryJson["packages"] = packagesJson;
+
+      json::Array itemsJson;
+      BOOST_FOREACH(const r_util::RSourceItem& item, pIndex->items())
+      {
+         itemsJson.push_back(sourceItemToJson(item));
+      }
+      entryJson["items"] = itemsJson;
+
+      indexCache_[fileInfo.absolutePath()] = entryJson;
+      usedCacheKeys_.insert(fileInfo.absolutePath());
+   }
+
+   static FilePath indexCachePath()
+   {
+      if (!projects::projectContext().hasProject())
+         return FilePath();
+
+      return projects::projectContext().scratchPath().childPath(
+                                                      "code-search-index");
+   }
+
    static bool isSourceFile(const FileInfo& fileInfo)
    {
       FilePath filePath(fileInfo.absolutePath());
@@ -934,7 +1340,20 @@ private:
 
    // indexing queue
    bool indexing_;
-   std::queue<core::system::FileChangeEvent> indexingQueue_;
+   std::deque<core::system::FileChangeEvent> indexingQueue_;
+
+   // identity (size + last write time) of each file currently in the
+   // index -- used to skip re-indexing of unchanged files when the
+   // monitor delivers redundant events
+   std::map<std::string, FileInfo> knownFiles_;
+
+   // persistent index cache (absolute path -> serialized entry).
+   // entries are validated against the file's current last write time
+   // and size before use. usedCacheKeys_ tracks the entries which
+   // were validated or refreshed this session (only those are
+   // persisted when the cache is saved)
+   std::map<std::string, json::Object> indexCache_;
+   std::set<std::string> usedCacheKeys_;
 };
 
 } // anonymous namespace
@@ -955,6 +1374,16 @@ void RSourceIndexes::update(const boost::shared_ptr<SourceDocument>& pDoc)
    if (!pDoc->canContainRCode())
       return;
 
+   // skip re-indexing if the document's contents are unchanged since we
+   // last indexed it -- onDocUpdated also fires for property-only updates
+   // (cursor position, fold state, etc.) which don't affect the index.
+   // the path participates in the check since a save-as needs the index
+   // re-aliased under the new path
+   std::string indexKey = pDoc->path() + "\n" + pDoc->hash();
+   IndexedHashMap::const_iterator hashIt = indexedHashMap_.find(pDoc->id());
+   if (hashIt != indexedHashMap_.end() && hashIt->second == indexKey)
+      return;
+
    // index the source
    std::string code;
    Error error = r_utils::extractRCode(pDoc->contents(), pDoc->type(), &code);
@@ -979,10 +1408,13 @@ void RSourceIndexes::update(const boost::shared_ptr<SourceDocument>& pDoc)
    
    // insert it
    idMap_[pDoc->id()] = pIndex;
-   
+
    // create aliases
    filePathMap_[filePath.absolutePath()] = pIndex;
-   
+
+   // record what we indexed
+   indexedHashMap_[pDoc->id()] = indexKey;
+
    // kick off an update if necessary
    r_packages::AsyncPackageInformationProcess::update();
 }
@@ -990,6 +1422,7 @@ void RSourceIndexes::update(const boost::shared_ptr<SourceDocument>& pDoc)
 void RSourceIndexes::remove(const std::string& id, const std::string&)
 {
    idMap_.erase(id);
+   indexedHashMap_.erase(id);
 
    FilePath filePath;
    Error error = source_database::getPath(id, &filePath);
@@ -1001,6 +1434,7 @@ void RSourceIndexes::removeAll()
 {
    idMap_.clear();
    filePathMap_.clear();
+   indexedHashMap_.clear();
 }
 
 RSourceIndexes& rSourceIndex()
@@ -1258,17 +1692,47 @@ void searchFiles(const std::string& term,
 // (See: CodeSearchOracle.java)
 int scoreMatch(std::string const& suggestion,
                std::string const& query,
-               bool isFile)
+               bool isFile,
+               std::vector<int>* pMatchesScratch)
 {
    // No penalty for perfect matches
    if (suggestion == query)
       return 0;
-   
-   std::vector<int> matches =
-         string_utils::subsequenceIndices(suggestion, query);
-   
+
+   // compute subsequence match indices into the caller-supplied scratch
+   // buffer (same skip-on-no-match semantics as subsequenceIndices) --
+   // callers scoring large candidate sets reuse the buffer across calls
+   // rather than allocating a vector per candidate
+   std::vector<int>& matches = *pMatchesScratch;
+   matches.clear();
+   std::string::size_type prevMatchIndex = -1;
+   for (std::string::size_type i = 0; i < query.length(); i++)
+   {
+      std::string::size_type index = suggestion.find(query[i],
+                                                     prevMatchIndex + 1);
+      if (index == std::string::npos)
+         continue;
+
+      matches.push_back(index);
+      prevMatchIndex = index;
+   }
+
    int totalPenalty = 0;
 
+   // penalties which are the same for every matched character --
+   // computed once here so the match loop below stays tight
+   int perMatchPenalty = 0;
+
+   // More penalty for 'uninteresting' files
+   if (suggestion == "RcppExports.R" ||
+       suggestion == "RcppExports.cpp")
+      perMatchPenalty += 6;
+
+   // More penalty for 'uninteresting' extensions (e.g. .Rd)
+   std::string extension = string_utils::getExtension(suggestion);
+   if (boost::algorithm::to_lower_copy(extension) == ".rd")
+      perMatchPenalty += 6;
+
    // Loop over the matches and assign a score
    for (int j = 0, n = matches.size(); j < n; j++)
    {
@@ -1287,18 +1751,8 @@ int scoreMatch(std::string const& suggestion,
 
       // Less penalty for perfect match (ie, reward case-sensitive match)
       penalty -= suggestion[matchPos] == query[j];
-      
-      // More penalty for 'uninteresting' files
-      if (suggestion == "RcppExports.R" ||
-          suggestion == "RcppExports.cpp")
-         penalty += 6;
-      
-      // More penalty for 'uninteresting' extensions (e.g. .Rd)
-      std::string extension = string_utils::getExtension(suggestion);
-      if (boost::algorithm::to_lower_copy(extension) == ".rd")
-         penalty += 6;
 
-      totalPenalty += penalty;
+      totalPenalty += penalty + perMatchPenalty;
    }
    
    // Penalize files
@@ -1311,6 +1765,14 @@ int scoreMatch(std::string const& suggestion,
    return totalPenalty;
 }
 
+int scoreMatch(std::string const& suggestion,
+               std::string const& query,
+               bool isFile)
+{
+   std::vector<int> matches;
+   return scoreMatch(suggestion, query, isFile, &matches);
+}
+
 struct ScorePairComparator
 {
    inline bool operator()(const std::pair<int, int> lhs,
@@ -1320,6 +1782,23 @@ struct ScorePairComparator
    }
 };
 
+// order the best n entries by score (lower is better) -- callers which
+// only consume the top n results don't need the full set sorted
+void sortScoresToTopN(std::vector< std::pair<int, int> >* pScores, int n)
+{
+   if (n >= 0 && n < static_cast<int>(pScores->size()))
+   {
+      std::partial_sort(pScores->begin(),
+                        pScores->begin() + n,
+                        pScores->end(),
+                        ScorePairComparator());
+   }
+   else
+   {
+      std::sort(pScores->begin(), pScores->end(), ScorePairComparator());
+   }
+}
+
 void filterScores(std::vector< std::pair<int, int> >* pScore1,
                   std::vector< std::pair<int, int> >* pScore2,
                   int maxAmount)
@@ -1577,31 +2056,36 @@ Error searchCode(const json::JsonRpcRequest& request,
    // typedef necessary for BOOST_FOREACH to work with pairs
    typedef std::pair<int, int> PairIntInt;
 
+   // scratch buffer reused across scoreMatch calls
+   std::vector<int> matchesScratch;
+
    // score matches -- returned as a pair, mapping index to score
    std::vector<PairIntInt> fileScores;
    for (std::size_t i = 0; i < paths.size(); ++i)
    {
-      fileScores.push_back(std::make_pair(i, scoreMatch(names[i], term, true)));
+      fileScores.push_back(std::make_pair(
+                        i, scoreMatch(names[i], term, true, &matchesScratch)));
    }
 
-   // sort by score (lower is better)
-   std::sort(fileScores.begin(), fileScores.end(), ScorePairComparator());
+   // sort by score (lower is better) -- only the top maxResults entries
+   // survive filtering below so a partial sort is sufficient
+   sortScoresToTopN(&fileScores, maxResults);
 
    std::vector<PairIntInt> srcItemScores;
    for (std::size_t i = 0; i < srcItems.size(); ++i)
    {
       const SourceItem& item = srcItems[i];
-      
+
       // don't index auto-generated files
       const std::string& context = item.context();
       if (boost::algorithm::ends_with(context, "RcppExports.R") ||
           boost::algorithm::ends_with(context, "RcppExports.cpp"))
          continue;
-         
-      int score = scoreMatch(item.name(), term, false);
+
+      int score = scoreMatch(item.name(), term, false, &matchesScratch);
       srcItemScores.push_back(std::make_pair(i, score));
    }
-   std::sort(srcItemScores.begin(), srcItemScores.end(), ScorePairComparator());
+   sortScoresToTopN(&srcItemScores, maxResults);
 
    // filter so we keep only the top n results -- and proactively
    // update whether there are other entries we didn't report back
@@ -2264,21 +2748,43 @@ void onFileMonitorDisabled()
    s_projectIndex.clear();
 }
 
+void onShutdown(bool terminatedNormally)
+{
+   s_projectIndex.saveIndexCache();
+}
+
+void onSuspend(const r::session::RSuspendOptions&, core::Settings*)
+{
+   s_projectIndex.saveIndexCache();
+}
+
+void onResume(const core::Settings&)
+{
+}
+
 SEXP rs_scoreMatches(SEXP suggestionsSEXP,
                      SEXP querySEXP)
 {
    std::string query = r::sexp::asString(querySEXP);
-   std::vector<std::string> suggestions;
-   if (!r::sexp::fillVectorString(suggestionsSEXP, &suggestions))
+   if (TYPEOF(suggestionsSEXP) != STRSXP)
       return R_NilValue;
-   
-   int n = suggestions.size();
+
+   int n = r::sexp::length(suggestionsSEXP);
    std::vector<int> scores;
    scores.reserve(n);
-   
+
+   // completion popups call this with the entire candidate set on every
+   // keystroke, so score straight from the R vector (reusing the string
+   // and match-index buffers) rather than copying all of the suggestions
+   // into a std::vector first
+   std::string suggestion;
+   std::vector<int> matchesScratch;
    for (int i = 0; i < n; i++)
-      scores.push_back(scoreMatch(suggestions[i], query, false));
-   
+   {
+      suggestion.assign(CHAR(STRING_ELT(suggestionsSEXP, i)));
+      scores.push_back(scoreMatch(suggestion, query, false, &matchesScratch));
+   }
+
    r::sexp::Protect protect;
    return r::sexp::create(scores, &protect);
 }
@@ -2400,7 +2906,19 @@ Error initialize()
    cb.onMonitoringDisabled = onFileMonitorDisabled;
    projects::projectContext().subscribeToFileMonitor("R source file indexing",
                                                      cb);
-   
+
+   // load the persistent project index cache (so that files which
+   // haven't changed since the last session can be restored without
+   // re-reading and re-parsing them) and arrange to save it when the
+   // session shuts down or suspends
+   if (projects::projectContext().hasProject())
+   {
+      s_projectIndex.loadIndexCache();
+      module_context::events().onShutdown.connect(onShutdown);
+      module_context::addSuspendHandler(
+                     module_context::SuspendHandler(onSuspend, onResume));
+   }
+
    // register viewFunction method
    R_CallMethodDef methodDef ;
    methodDef.name = "rs_viewFunction" ;
@@ -92,10 +92,15 @@ public:
    }
 
 private:
-   
+
+  // maps document id to the path + content hash in effect when the
+  // document was last indexed (used to skip redundant re-indexing)
+  typedef std::map<std::string, std::string> IndexedHashMap;
+
   IDMap idMap_;
   FilePathMap filePathMap_;
-  
+  IndexedHashMap indexedHashMap_;
+
 };
 
 RSourceIndexes& rSourceIndex();
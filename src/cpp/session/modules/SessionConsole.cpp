@@ -17,11 +17,10 @@
 #include "SessionConsole.hpp"
 #include "rmarkdown/SessionRmdNotebook.hpp"
 
-#include <boost/algorithm/string/predicate.hpp>
-
 #include <core/Error.hpp>
 #include <core/Exec.hpp>
 #include <core/FilePath.hpp>
+#include <core/text/MultiPatternScanner.hpp>
 
 #include <core/system/OutputCapture.hpp>
 
@@ -40,34 +39,30 @@ namespace console {
 
 namespace {   
 
+// tokens to suppress from stderr output
+std::vector<std::string> suppressedOutputTokens()
+{
+   std::vector<std::string> tokens;
+   tokens.push_back("GLib-WARNING **:");
+   tokens.push_back("GLib-CRITICAL **:");
+   tokens.push_back("GLib-GObject-WARNING **:");
+   tokens.push_back("utoreleaseNoPool");
+   tokens.push_back("select: Interrupted system call");
+   tokens.push_back("Not a git repository");
+   tokens.push_back("is outside repository");
+   tokens.push_back("<Error>: CGContext");
+   return tokens;
+}
+
+// single-pass scanner for the suppressed tokens. built at namespace scope
+// because suppressOutput runs on the output capture thread, where a lazily
+// initialized local static wouldn't be safe
+const core::text::MultiPatternScanner s_suppressedOutputScanner(
+                                                   suppressedOutputTokens());
+
 bool suppressOutput(const std::string& output)
 {
-   // tokens to suppress
-   const char * const kGlibWarningToken = "GLib-WARNING **:";
-   const char * const kGlibCriticalToken = "GLib-CRITICAL **:";
-   const char * const kGlibGObjectWarningToken = "GLib-GObject-WARNING **:";
-   const char * const kAutoreleaseNoPool = "utoreleaseNoPool";
-   const char * const kSelectInterrupted = "select: Interrupted system call";
-   const char * const kNotAGitRepo = "Not a git repository";
-   const char * const kIsOutsideRepo = "is outside repository";
-   const char * const kCGContextError = "<Error>: CGContext";
-
-   // check tokens
-   if (boost::algorithm::contains(output, kGlibWarningToken) ||
-       boost::algorithm::contains(output, kGlibCriticalToken) ||
-       boost::algorithm::contains(output, kGlibGObjectWarningToken) ||
-       boost::algorithm::contains(output, kAutoreleaseNoPool) ||
-       boost::algorithm::contains(output, kSelectInterrupted) ||
-       boost::algorithm::contains(output, kNotAGitRepo) ||
-       boost::algorithm::contains(output, kIsOutsideRepo) ||
-       boost::algorithm::contains(output, kCGContextError))
-   {
-      return true;
-   }
-   else
-   {
-      return false;
-   }
+   return s_suppressedOutputScanner.containsAny(output);
 }
 
 void writeStandardOutput(const std::string& output)
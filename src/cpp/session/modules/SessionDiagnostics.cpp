@@ -24,6 +24,7 @@
 #include "SessionAsyncPackageInformation.hpp"
 #include "SessionRParser.hpp"
 
+#include <map>
 #include <set>
 
 #include <core/Debug.hpp>
@@ -84,10 +85,11 @@ void addUnreferencedSymbol(const ParseItem& item,
    // the parse tree (but defined later)
    ParseNode::SymbolPositions& symbols =
          const_cast<ParseNode::SymbolPositions&>(pNode->getDefinedSymbols());
-   
-   if (symbols.count(item.symbol))
+
+   ParseNode::SymbolHandle handle;
+   if (pNode->lookupSymbol(item.symbol, &handle) && symbols.count(handle))
    {
-      ParseNode::Positions positions = symbols[item.symbol];
+      ParseNode::Positions positions = symbols[handle];
       BOOST_FOREACH(const Position& position, positions)
       {
          lint.symbolDefinedAfterUsage(item, position);
@@ -107,15 +109,15 @@ void doCheckDefinedButNotUsed(ParseNode* pNode, ParseResults& results)
         it != definitions.end();
         ++it)
    {
-      const std::string& symbolName = it->first;
-      
-      if (pNode->isSymbolDefinedButNotUsed(symbolName, true, true))
+      ParseNode::SymbolHandle handle = it->first;
+
+      if (pNode->isSymbolDefinedButNotUsed(handle, true, true))
       {
          ParseNode::Positions* symbolPos = NULL;
-         if (get(definitions, symbolName, &symbolPos))
+         if (get(definitions, handle, &symbolPos))
          {
             results.lint().symbolDefinedButNotUsed(
-                     symbolName,
+                     pNode->symbolName(handle),
                      it->second[0]);
          }
       }
@@ -831,6 +833,89 @@ Error lintRSourceDocument(const json::JsonRpcRequest& request,
    return Success();
 }
 
+// Lint pipeline -- lint requests arrive from the client on every edit
+// burst, and running them synchronously inside the RPC handler blocks
+// unrelated RPCs (e.g. console input) behind a potentially expensive
+// parse. Instead we accept the request immediately, debounce it, and
+// run the lint as idle-only delayed work. A newer request for the same
+// document supersedes any pending one: the superseded request is
+// completed right away with an empty result and only the newest
+// snapshot is actually linted.
+//
+// NOTE: the parse itself must stay on the main thread as it consults
+// R (e.g. to resolve functions for argument checking), so this is a
+// queue in front of the parser rather than a true worker pool.
+struct PendingLint
+{
+   PendingLint() : generation(0) {}
+
+   json::JsonRpcRequest request;
+   json::JsonRpcFunctionContinuation continuation;
+   int generation;
+};
+
+std::map<std::string, PendingLint> s_pendingLints;
+int s_lintGeneration = 0;
+
+const int kLintDebounceMs = 300;
+
+void performDelayedLint(const std::string& documentId, int generation)
+{
+   std::map<std::string, PendingLint>::iterator it =
+         s_pendingLints.find(documentId);
+
+   // a newer request for this document has superseded us
+   if (it == s_pendingLints.end() || it->second.generation != generation)
+      return;
+
+   PendingLint lint = it->second;
+   s_pendingLints.erase(it);
+
+   json::JsonRpcResponse response;
+   Error error = lintRSourceDocument(lint.request, &response);
+   if (lint.continuation)
+      lint.continuation(error, &response);
+}
+
+void lintRSourceDocumentAsync(
+      const json::JsonRpcRequest& request,
+      const json::JsonRpcFunctionContinuation& continuation)
+{
+   std::string documentId;
+   Error error = json::readParam(request.params, 0, &documentId);
+   if (error)
+   {
+      LOG_ERROR(error);
+      json::JsonRpcResponse response;
+      continuation(error, &response);
+      return;
+   }
+
+   // supersede any pending lint for this document -- complete it with
+   // an empty result so the client's callback still fires
+   std::map<std::string, PendingLint>::iterator it =
+         s_pendingLints.find(documentId);
+   if (it != s_pendingLints.end() && it->second.continuation)
+   {
+      json::JsonRpcResponse response;
+      response.setResult(json::Array());
+      it->second.continuation(Success(), &response);
+   }
+
+   PendingLint& lint = s_pendingLints[documentId];
+   lint.request = request;
+   lint.continuation = continuation;
+   lint.generation = ++s_lintGeneration;
+
+   // debounce: run only once the document has been quiet for the
+   // debounce interval (another request arriving first bumps the
+   // generation, making the scheduled callback a no-op)
+   module_context::scheduleDelayedWork(
+            boost::posix_time::milliseconds(kLintDebounceMs),
+            boost::bind(performDelayedLint, documentId, lint.generation),
+            true);
+}
+
 SEXP rs_lintRFile(SEXP filePathSEXP)
 {
    using namespace r::sexp;
@@ -1032,7 +1117,7 @@ core::Error initialize()
    ExecBlock initBlock;
    initBlock.addFunctions()
          (bind(sourceModuleRFile, "SessionDiagnostics.R"))
-         (bind(registerRpcMethod, "lint_r_source_document", lintRSourceDocument));
+         (bind(registerAsyncRpcMethod, "lint_r_source_document", lintRSourceDocumentAsync));
    
    return initBlock.execute();
 
@@ -18,6 +18,7 @@
 
 #include <csignal>
 
+#include <map>
 #include <vector>
 #include <iostream>
 #include <fstream>
@@ -29,6 +30,7 @@
 
 #include <core/Error.hpp>
 #include <core/Log.hpp>
+#include <core/Thread.hpp>
 #include <core/FileSerializer.hpp>
 #include <core/FilePath.hpp>
 #include <core/FileInfo.hpp>
@@ -63,6 +65,7 @@
 
 #include "SessionFilesQuotas.hpp"
 #include "SessionFilesListingMonitor.hpp"
+#include "SessionVCS.hpp"
 
 using namespace rstudio::core ;
 
@@ -117,7 +120,130 @@ void onClientInit()
 {
    quotas::checkQuotaStatus();
 }
-   
+
+// cache of recursive directory aggregates (total size in bytes plus file
+// count). aggregates are computed by a background worker via the
+// "directory_size" rpc (so du-style walks of large directories never block
+// the main thread) and dropped when the project file monitor reports a
+// change beneath a cached directory, so repeat queries answer instantly
+struct DirectoryAggregate
+{
+   DirectoryAggregate() : size(0), fileCount(0) {}
+   double size;
+   double fileCount;
+};
+
+boost::mutex s_directoryAggregatesMutex;
+std::map<std::string, DirectoryAggregate> s_directoryAggregates;
+
+bool accumulateAggregate(DirectoryAggregate* pAggregate,
+                         int level,
+                         const FilePath& path)
+{
+   if (!path.isDirectory())
+   {
+      pAggregate->size += path.size();
+      pAggregate->fileCount += 1;
+   }
+   return true;
+}
+
+// runs on the main thread -- resolve and validate the path here (where we
+// have access to the user home path) and hand the worker an absolute path
+Error initDirectorySize(const json::JsonRpcRequest& request,
+                        std::string* pPath)
+{
+   std::string path;
+   Error error = json::readParam(request.params, 0, &path);
+   if (error)
+      return error;
+
+   FilePath dirPath = module_context::resolveAliasedPath(path);
+   if (!dirPath.exists())
+      return core::fileNotFoundError(dirPath, ERROR_LOCATION);
+
+   *pPath = dirPath.absolutePath();
+   return Success();
+}
+
+// runs on a background thread
+Error computeDirectorySize(const json::JsonRpcRequest& request,
+                           const std::string& path,
+                           json::JsonRpcResponse* pResponse)
+{
+   // satisfy from the cache if we can
+   bool cached = false;
+   DirectoryAggregate aggregate;
+   LOCK_MUTEX(s_directoryAggregatesMutex)
+   {
+      std::map<std::string, DirectoryAggregate>::const_iterator it =
+                                          s_directoryAggregates.find(path);
+      if (it != s_directoryAggregates.end())
+      {
+         aggregate = it->second;
+         cached = true;
+      }
+   }
+   END_LOCK_MUTEX
+
+   if (!cached)
+   {
+      Error error = FilePath(path).childrenRecursive(
+               boost::bind(accumulateAggregate, &aggregate, _1, _2));
+      if (error)
+         return error;
+
+      LOCK_MUTEX(s_directoryAggregatesMutex)
+      {
+         s_directoryAggregates[path] = aggregate;
+      }
+      END_LOCK_MUTEX
+   }
+
+   json::Object resultJson;
+   resultJson["size"] = aggregate.size;
+   resultJson["file_count"] = aggregate.fileCount;
+   resultJson["cached"] = cached;
+   pResponse->setResult(resultJson);
+   return Success();
+}
+
+Error registerDirectorySizeRpc()
+{
+   return module_context::registerRpcAsyncCoupleMethod<std::string>(
+                                                   "directory_size",
+                                                   initDirectorySize,
+                                                   computeDirectorySize);
+}
+
+void onFilesChanged(const std::vector<core::system::FileChangeEvent>& events)
+{
+   // drop cached aggregates for any directory containing a changed file
+   LOCK_MUTEX(s_directoryAggregatesMutex)
+   {
+      BOOST_FOREACH(const core::system::FileChangeEvent& event, events)
+      {
+         std::string path = event.fileInfo().absolutePath();
+         std::map<std::string, DirectoryAggregate>::iterator it =
+                                             s_directoryAggregates.begin();
+         while (it != s_directoryAggregates.end())
+         {
+            const std::string& dir = it->first;
+            if (path.compare(0, dir.length(), dir) == 0 &&
+                (path.length() == dir.length() || path[dir.length()] == '/'))
+            {
+               s_directoryAggregates.erase(it++);
+            }
+            else
+            {
+               ++it;
+            }
+         }
+      }
+   }
+   END_LOCK_MUTEX
+}
+
 
 // extract a set of FilePath object from a list of home path relative strings
 Error extractFilePaths(const json::Array& files, 
@@ -207,18 +333,21 @@ Error listFiles(const json::JsonRpcRequest& request, json::JsonRpcResponse* pRes
    core::json::Array jsonFiles;
    if (monitor)
    {
-      // always stop existing if we have one
-      s_filesListingMonitor.stop();
-
       // install a monitor only if we aren't already covered by the project monitor
       if (!session::projects::projectContext().isMonitoringDirectory(targetPath))
       {
+         // note: start stops any existing monitor itself -- stopping here
+         // first would discard the listing snapshot that a re-navigation
+         // to the currently monitored directory is served from
          error = s_filesListingMonitor.start(targetPath, &jsonFiles);
          if (error)
             return error;
       }
       else
       {
+         // always stop existing if we have one
+         s_filesListingMonitor.stop();
+
          error = FilesListingMonitor::listFiles(targetPath, &jsonFiles);
          if (error)
             return error;
@@ -248,6 +377,94 @@ Error listFiles(const json::JsonRpcRequest& request, json::JsonRpcResponse* pRes
    return Success();
 }
 
+// cached sorted index for the paged listing rpc. built once per directory,
+// subsequent pages are served as range queries against it
+FilePath s_pagedListingPath;
+std::time_t s_pagedListingLastWrite = 0;
+std::vector<FilePath> s_pagedListingFiles;
+
+// paged variant of list_files -- builds a sorted index of the directory
+// once (names only, no per-file metadata) then serves offset/limit ranges
+// from it, hydrating file metadata and vcs decorations only for the
+// requested page. this allows the client to show the first screenful of
+// a very large directory immediately and fetch the rest as it scrolls
+Error listFilesPaged(const json::JsonRpcRequest& request,
+                     json::JsonRpcResponse* pResponse)
+{
+   // get args
+   std::string path;
+   int offset, limit;
+   Error error = json::readParams(request.params, &path, &offset, &limit);
+   if (error)
+      return error;
+   FilePath targetPath = module_context::resolveAliasedPath(path);
+   if (offset < 0)
+      offset = 0;
+
+   // (re)build the sorted index if we are paging a different directory or
+   // the directory has changed since the index was built (adds and removes
+   // update the directory write time; in-place edits to files don't change
+   // which entries exist so they don't invalidate the index)
+   std::time_t lastWrite = targetPath.lastWriteTime();
+   if (targetPath != s_pagedListingPath ||
+       lastWrite != s_pagedListingLastWrite)
+   {
+      s_pagedListingPath = FilePath();
+      s_pagedListingFiles.clear();
+
+      std::vector<FilePath> files;
+      error = targetPath.children(&files);
+      if (error)
+         return error;
+
+      // apply the standard listing filter then sort by name
+      BOOST_FOREACH(const FilePath& filePath, files)
+      {
+         if (module_context::fileListingFilter(FileInfo(filePath)))
+            s_pagedListingFiles.push_back(filePath);
+      }
+      std::sort(s_pagedListingFiles.begin(),
+                s_pagedListingFiles.end(),
+                core::compareAbsolutePathNoCase);
+
+      s_pagedListingPath = targetPath;
+      s_pagedListingLastWrite = lastWrite;
+   }
+
+   // compute the requested range (limit <= 0 means to the end)
+   int totalCount = static_cast<int>(s_pagedListingFiles.size());
+   if (offset > totalCount)
+      offset = totalCount;
+   int end = (limit <= 0) ? totalCount : offset + limit;
+   if (end > totalCount)
+      end = totalCount;
+
+   // hydrate metadata for just this page
+   boost::shared_ptr<source_control::FileDecorationContext> pCtx =
+                        source_control::fileDecorationContext(targetPath);
+   json::Array jsonFiles;
+   for (int i = offset; i < end; i++)
+   {
+      const FilePath& filePath = s_pagedListingFiles[i];
+
+      // files may have been deleted after the index was built
+      if (filePath.exists())
+      {
+         json::Object fileObject = module_context::createFileSystemItem(filePath);
+         pCtx->decorateFile(filePath, &fileObject);
+         jsonFiles.push_back(fileObject);
+      }
+   }
+
+   json::Object result;
+   result["files"] = jsonFiles;
+   result["offset"] = offset;
+   result["total_count"] = totalCount;
+   result["more_available"] = (end < totalCount);
+   pResponse->setResult(result);
+   return Success();
+}
+
 
 // IN: String path
 core::Error createFolder(const core::json::JsonRpcRequest& request,
@@ -726,8 +943,10 @@ void setAttachmentResponse(const http::Request& request,
    pResponse->setHeader("Content-Disposition",
                         "attachment; filename*=UTF-8''"
                         + http::util::urlEncode(filename, false));
+   // serve rangeable so interrupted downloads of large files can be
+   // resumed rather than re-transferred from the beginning
+   pResponse->setRangeableFile(attachmentPath, request);
    pResponse->setHeader("Content-Type", "application/octet-stream");
-   pResponse->setBody(attachmentPath);
 }
    
 void handleMultipleFileExportRequest(const http::Request& request, 
@@ -1006,6 +1225,12 @@ Error initialize()
    // subscribe to events
    events().onClientInit.connect(bind(onClientInit));
 
+   // subscribe to the project file monitor so cached directory
+   // aggregates track changes made beneath monitored directories
+   projects::FileMonitorCallbacks cb;
+   cb.onFilesChanged = onFilesChanged;
+   projects::projectContext().subscribeToFileMonitor("", cb);
+
    RS_REGISTER_CALL_METHOD(rs_readLines, 1);
    RS_REGISTER_CALL_METHOD(rs_pathInfo, 1);
 
@@ -1017,6 +1242,8 @@ Error initialize()
       (bind(registerRpcMethod, "is_text_file", isTextFile))
       (bind(registerRpcMethod, "get_file_contents", getFileContents))
       (bind(registerRpcMethod, "list_files", listFiles))
+      (bind(registerRpcMethod, "list_files_paged", listFilesPaged))
+      (registerDirectorySizeRpc)
       (bind(registerRpcMethod, "create_folder", createFolder))
       (bind(registerRpcMethod, "delete_files", deleteFiles))
       (bind(registerRpcMethod, "copy_file", copyFile))
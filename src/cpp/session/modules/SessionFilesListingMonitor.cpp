@@ -43,6 +43,13 @@ namespace files {
 
 Error FilesListingMonitor::start(const FilePath& filePath, json::Array* pJsonFiles)
 {
+   // if we are already monitoring this directory then serve the listing
+   // from the snapshot we maintain from file monitor events, rather than
+   // re-listing and re-sorting the directory (which stalls on very large
+   // directories)
+   if (snapshotValid_ && !currentHandle_.empty() && filePath == currentPath_)
+      return listFromSnapshot(pJsonFiles);
+
    // always stop existing
    stop();
 
@@ -65,7 +72,8 @@ Error FilesListingMonitor::start(const FilePath& filePath, json::Array* pJsonFil
    cb.onRegistered = boost::bind(&FilesListingMonitor::onRegistered,
                                     this, _1, filePath, prevFiles, _2);
    cb.onRegistrationError =  boost::bind(core::log::logError, _1, ERROR_LOCATION);
-   cb.onFilesChanged = boost::bind(module_context::enqueFileChangedEvents, filePath, _1);
+   cb.onFilesChanged = boost::bind(&FilesListingMonitor::onFilesChanged,
+                                      this, filePath, _1);
    cb.onMonitoringError = boost::bind(core::log::logError, _1, ERROR_LOCATION);
    cb.onUnregistered = boost::bind(&FilesListingMonitor::onUnregistered, this, _1);
    core::system::file_monitor::registerMonitor(filePath,
@@ -78,8 +86,10 @@ Error FilesListingMonitor::start(const FilePath& filePath, json::Array* pJsonFil
 
 void FilesListingMonitor::stop()
 {
-   // reset monitored path and unregister any existing handle
+   // reset monitored path, snapshot, and unregister any existing handle
    currentPath_ = FilePath();
+   snapshot_.clear();
+   snapshotValid_ = false;
    if (!currentHandle_.empty())
    {
       core::system::file_monitor::unregisterMonitor(currentHandle_);
@@ -123,6 +133,47 @@ FileInfo normalizeFileScannerPath(const FileInfo& fileInfo)
    return FileInfo(filePath);
 }
 
+// ordering for the listing snapshot (same ordering the client displays)
+bool fileInfoLessThan(const FileInfo& a, const FileInfo& b)
+{
+   return compareAbsolutePathNoCase(FilePath(a.absolutePath()),
+                                    FilePath(b.absolutePath()));
+}
+
+// incrementally apply a change event to the sorted snapshot -- adds
+// insert in order, removes erase, and modifications update in place.
+// note: the snapshot is keyed by path (FileInfo doesn't carry an inode
+// on all of our platforms) which is also the identity the client uses
+void applyEventToSnapshot(const core::system::FileChangeEvent& event,
+                          std::vector<FileInfo>* pSnapshot)
+{
+   FileInfo fileInfo = normalizeFileScannerPath(event.fileInfo());
+
+   std::vector<FileInfo>::iterator it = std::lower_bound(pSnapshot->begin(),
+                                                         pSnapshot->end(),
+                                                         fileInfo,
+                                                         fileInfoLessThan);
+   bool found = (it != pSnapshot->end()) &&
+                (it->absolutePath() == fileInfo.absolutePath());
+
+   switch (event.type())
+   {
+      case core::system::FileChangeEvent::FileAdded:
+      case core::system::FileChangeEvent::FileModified:
+         if (found)
+            *it = fileInfo;
+         else
+            pSnapshot->insert(it, fileInfo);
+         break;
+      case core::system::FileChangeEvent::FileRemoved:
+         if (found)
+            pSnapshot->erase(it);
+         break;
+      case core::system::FileChangeEvent::None:
+         break;
+   }
+}
+
 } // anonymous namespace
 
 void FilesListingMonitor::onRegistered(core::system::file_monitor::Handle handle,
@@ -151,11 +202,58 @@ void FilesListingMonitor::onRegistered(core::system::file_monitor::Handle handle
                                          module_context::fileListingFilter,
                                          &events);
 
+   // store the scan as our sorted listing snapshot -- it's maintained
+   // incrementally from change events from here on (see onFilesChanged)
+   snapshot_ = currFiles;
+   std::sort(snapshot_.begin(), snapshot_.end(), fileInfoLessThan);
+   snapshotValid_ = true;
+
    // enque any events we discovered
    if (!events.empty())
       module_context::enqueFileChangedEvents(filePath, events);
 }
 
+void FilesListingMonitor::onFilesChanged(
+                  const FilePath& filePath,
+                  const std::vector<core::system::FileChangeEvent>& events)
+{
+   // maintain our sorted snapshot (guard against events enqueued for a
+   // previously monitored directory)
+   if (snapshotValid_ && filePath == currentPath_)
+   {
+      BOOST_FOREACH(const core::system::FileChangeEvent& event, events)
+      {
+         applyEventToSnapshot(event, &snapshot_);
+      }
+   }
+
+   // forward add/remove/update deltas to the client as before
+   module_context::enqueFileChangedEvents(filePath, events);
+}
+
+Error FilesListingMonitor::listFromSnapshot(json::Array* pJsonFiles)
+{
+   using namespace source_control;
+   boost::shared_ptr<FileDecorationContext> pCtx =
+                  source_control::fileDecorationContext(currentPath_);
+
+   // the snapshot is already sorted and filtered -- just verify existence
+   // (a file could be deleted before its remove event is processed)
+   BOOST_FOREACH(const FileInfo& fileInfo, snapshot_)
+   {
+      FilePath filePath(fileInfo.absolutePath());
+      if (filePath.exists())
+      {
+         core::json::Object fileObject =
+                           module_context::createFileSystemItem(filePath);
+         pCtx->decorateFile(filePath, &fileObject);
+         pJsonFiles->push_back(fileObject);
+      }
+   }
+
+   return Success();
+}
+
 void FilesListingMonitor::onUnregistered(core::system::file_monitor::Handle handle)
 {
    // typically we clear our internal state explicitly when a new registration
@@ -166,6 +264,8 @@ void FilesListingMonitor::onUnregistered(core::system::file_monitor::Handle hand
    {
       currentPath_ = FilePath();
       currentHandle_ = core::system::file_monitor::Handle();
+      snapshot_.clear();
+      snapshotValid_ = false;
    }
 }
 
@@ -179,6 +279,10 @@ Error FilesListingMonitor::listFiles(const FilePath& rootPath,
    if (error)
       return error;
 
+   // the loop below stats each file several times (exists, then again
+   // inside createFileSystemItem) -- serve those from a single stat
+   core::ScopedStatCache statCache;
+
    using namespace source_control;
    boost::shared_ptr<FileDecorationContext> pCtx =
                   source_control::fileDecorationContext(rootPath);
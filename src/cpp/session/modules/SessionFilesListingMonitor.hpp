@@ -23,6 +23,7 @@
 
 #include <core/collection/Tree.hpp>
 
+#include <core/FileInfo.hpp>
 #include <core/json/Json.hpp>
 #include <core/system/FileMonitor.hpp>
 
@@ -50,6 +51,8 @@ namespace files {
 class FilesListingMonitor : boost::noncopyable
 {
 public:
+   FilesListingMonitor() : snapshotValid_(false) {}
+
    // kickoff monitoring
    core::Error start(const core::FilePath& filePath, core::json::Array* pJsonFiles);
 
@@ -76,6 +79,16 @@ private:
 
    void onUnregistered(core::system::file_monitor::Handle handle);
 
+   // applies change events to the sorted listing snapshot then forwards
+   // them to the client as deltas
+   void onFilesChanged(
+               const core::FilePath& filePath,
+               const std::vector<core::system::FileChangeEvent>& events);
+
+   // produce a listing from the incrementally maintained snapshot
+   // (avoids re-listing and re-sorting the monitored directory)
+   core::Error listFromSnapshot(core::json::Array* pJsonFiles);
+
    // helpers
    static core::Error listFiles(const core::FilePath& rootPath,
                                 std::vector<core::FilePath>* pFiles,
@@ -84,6 +97,11 @@ private:
 private:
    core::FilePath currentPath_;
    core::system::file_monitor::Handle currentHandle_;
+
+   // sorted snapshot of the monitored directory, maintained
+   // incrementally from file monitor change events
+   std::vector<core::FileInfo> snapshot_;
+   bool snapshotValid_;
 };
 
 
@@ -16,16 +16,21 @@
 #include "SessionFind.hpp"
 
 #include <algorithm>
+#include <cstring>
+#include <deque>
+#include <vector>
 
-#include <boost/algorithm/string.hpp>
+#include <boost/atomic.hpp>
 #include <boost/bind.hpp>
 #include <boost/enable_shared_from_this.hpp>
+#include <boost/regex.hpp>
 
 #include <core/Exec.hpp>
+#include <core/FileSerializer.hpp>
+#include <core/RegexUtils.hpp>
 #include <core/StringUtils.hpp>
-#include <core/system/Environment.hpp>
-#include <core/system/Process.hpp>
-#include <core/system/ShellUtils.hpp>
+#include <core/Thread.hpp>
+#include <core/system/System.hpp>
 
 #include <r/RUtil.hpp>
 
@@ -193,123 +198,210 @@ FindInFilesState& findResults()
    return *s_pFindResults;
 }
 
-class GrepOperation : public boost::enable_shared_from_this<GrepOperation>
+// maximum number of raw matches the searcher threads will buffer
+// ahead of the main thread (bounds memory when matches are plentiful)
+const std::size_t kMaxPendingMatches = 5000;
+
+inline char asciiLower(char ch)
 {
-public:
-   static boost::shared_ptr<GrepOperation> create(const std::string& encoding,
-                                                  const FilePath& tempFile)
-   {
-      return boost::shared_ptr<GrepOperation>(new GrepOperation(encoding,
-                                                                tempFile));
-   }
+   return (ch >= 'A' && ch <= 'Z') ? ch + ('a' - 'A') : ch;
+}
 
-private:
-   GrepOperation(const std::string& encoding,
-                 const FilePath& tempFile)
-      : firstDecodeError_(true), encoding_(encoding), tempFile_(tempFile)
-   {
-      handle_ = core::system::generateUuid(false);
-   }
+// find the next occurrence of needle within haystack starting at
+// 'from'. the case-sensitive path defers to std::string::find (which
+// locates candidate positions with memchr); the insensitive path
+// folds ascii only, as grep does in the C locale
+std::size_t findNext(const std::string& haystack,
+                     std::size_t from,
+                     const std::string& needle,
+                     bool ignoreCase)
+{
+   if (!ignoreCase)
+      return haystack.find(needle, from);
 
-public:
-   std::string handle() const
-   {
-      return handle_;
-   }
+   if (needle.empty() || haystack.size() < needle.size())
+      return std::string::npos;
 
-   core::system::ProcessCallbacks createProcessCallbacks()
+   char first = asciiLower(needle[0]);
+   std::size_t last = haystack.size() - needle.size();
+   for (std::size_t i = from; i <= last; i++)
    {
-      core::system::ProcessCallbacks callbacks;
-      callbacks.onContinue = boost::bind(&GrepOperation::onContinue,
-                                         shared_from_this(),
-                                         _1);
-      callbacks.onStdout = boost::bind(&GrepOperation::onStdout,
-                                       shared_from_this(),
-                                       _1, _2);
-      callbacks.onStderr = boost::bind(&GrepOperation::onStderr,
-                                       shared_from_this(),
-                                       _1, _2);
-      callbacks.onExit = boost::bind(&GrepOperation::onExit,
-                                     shared_from_this(),
-                                     _1);
-      return callbacks;
-   }
+      if (asciiLower(haystack[i]) != first)
+         continue;
 
-private:
-   bool onContinue(const core::system::ProcessOperations& ops) const
-   {
-      return findResults().isRunning() && findResults().handle() == handle();
+      std::size_t j = 1;
+      for (; j < needle.size(); j++)
+      {
+         if (asciiLower(haystack[i + j]) != asciiLower(needle[j]))
+            break;
+      }
+      if (j == needle.size())
+         return i;
    }
+   return std::string::npos;
+}
 
-   std::string decode(const std::string& encoded)
+// extract a literal which must appear in any line matching the given
+// regex pattern (used to prefilter file contents with a fast
+// substring scan before running the regex itself). returns an empty
+// string if no safe literal can be extracted
+std::string extractLiteral(const std::string& pattern)
+{
+   // give up in the presence of constructs which can make any part
+   // of the pattern optional
+   if (pattern.find_first_of("(){}|\\") != std::string::npos)
+      return std::string();
+
+   std::string longest, current;
+   for (std::size_t i = 0; i < pattern.size(); i++)
    {
-      if (encoded.empty())
-         return encoded;
+      char ch = pattern[i];
 
-      std::string decoded;
-      Error error = r::util::iconvstr(encoded, encoding_, "UTF-8", true,
-                                      &decoded);
+      if (ch == '[')
+      {
+         // skip the character class
+         while (i < pattern.size() && pattern[i] != ']')
+            i++;
+         current.clear();
+         continue;
+      }
 
-      // Log error, but only once per grep operation
-      if (error && firstDecodeError_)
+      if (ch == '*' || ch == '?')
       {
-         firstDecodeError_ = false;
-         LOG_ERROR(error);
+         // a quantifier makes the preceding character optional
+         if (!current.empty())
+            current.erase(current.size() - 1);
+         if (current.size() > longest.size())
+            longest = current;
+         current.clear();
+         continue;
       }
 
-      return decoded;
+      if (ch == '.' || ch == '^' || ch == '$' || ch == '+')
+      {
+         // terminates the run ('+' requires at least one occurrence
+         // so the run up to and including the previous character
+         // remains valid)
+         if (current.size() > longest.size())
+            longest = current;
+         current.clear();
+         continue;
+      }
+
+      current += ch;
    }
+   if (current.size() > longest.size())
+      longest = current;
 
-   void processContents(std::string* pContent,
-                        json::Array* pMatchOn,
-                        json::Array* pMatchOff)
-   {
-      using namespace boost;
+   // too short to be a useful prefilter
+   if (longest.size() < 2)
+      return std::string();
 
-      std::string decodedLine;
+   return longest;
+}
 
-      std::string::iterator inputPos = pContent->begin();
+// a single matching line produced by a searcher thread. the line is
+// raw bytes in the file's encoding; matches are byte offset pairs
+// (begin/end) within the line. decoding to UTF-8 happens on the main
+// thread when the result is streamed to the client
+struct FindMatch
+{
+   FindMatch() : lineNum(0) {}
 
-      std::size_t nUtf8CharactersProcessed = 0;
-      smatch match;
-      while (regex_search(std::string(inputPos, pContent->end()), match,
-                          regex("\x1B\\[(\\d\\d)?m(\x1B\\[K)?")))
-      {
-         // decode the current match, and append it
-         std::string decoded = decode(std::string(inputPos, inputPos + match.position()));
-         decodedLine.append(decoded);
-         inputPos += match.position() + match.length();
-         
-         // count the number of UTF-8 characters processed
-         std::size_t charSize;
-         Error error = string_utils::utf8Distance(decoded.begin(),
-                                                  decoded.end(),
-                                                  &charSize);
-         if (error)
-            charSize = decoded.size();
-         nUtf8CharactersProcessed += charSize;
-
-         // update the match state
-         if (match[1] == "01")
-            pMatchOn->push_back(static_cast<int>(nUtf8CharactersProcessed));
-         else
-            pMatchOff->push_back(static_cast<int>(nUtf8CharactersProcessed));
-      }
-      
-      if (inputPos != pContent->end())
-         decodedLine.append(decode(std::string(inputPos, pContent->end())));
+   std::string file;
+   int lineNum;
+   std::string line;
+   std::vector<std::pair<int, int> > matches;
+};
 
-      if (decodedLine.size() > 300)
+// in-process find-in-files operation. a controller thread walks the
+// directory tree, feeding file paths to a small pool of searcher
+// threads which scan raw file bytes; matching lines are queued and
+// drained periodically on the main thread, which decodes them and
+// streams them to the client in batches through the same find_result
+// client events the previous grep-based implementation used
+class FindOperation : public boost::enable_shared_from_this<FindOperation>
+{
+public:
+   static boost::shared_ptr<FindOperation> create(
+                        const std::string& encoding,
+                        const std::string& pattern,
+                        bool asRegex,
+                        bool ignoreCase,
+                        const FilePath& directory,
+                        const std::vector<boost::regex>& includePatterns)
+   {
+      return boost::shared_ptr<FindOperation>(new FindOperation(
+            encoding, pattern, asRegex, ignoreCase, directory,
+            includePatterns));
+   }
+
+private:
+   FindOperation(const std::string& encoding,
+                 const std::string& pattern,
+                 bool asRegex,
+                 bool ignoreCase,
+                 const FilePath& directory,
+                 const std::vector<boost::regex>& includePatterns)
+      : firstDecodeError_(true),
+        encoding_(encoding),
+        pattern_(pattern),
+        asRegex_(asRegex),
+        ignoreCase_(ignoreCase),
+        directory_(directory),
+        includePatterns_(includePatterns),
+        stopRequested_(false),
+        enumerationDone_(false),
+        workersDone_(false)
+   {
+      handle_ = core::system::generateUuid(false);
+
+      if (asRegex_)
       {
-         decodedLine = decodedLine.erase(300);
-         decodedLine.append("...");
+         // NOTE: the pattern was validated by beginFind so this
+         // does not throw
+         boost::regex::flag_type flags = boost::regex::normal;
+         if (ignoreCase_)
+            flags |= boost::regex::icase;
+         regex_.assign(pattern_, flags);
+
+         // literal prefilter for the regex (may be empty)
+         literal_ = extractLiteral(pattern_);
       }
+   }
 
-      *pContent = decodedLine;
+public:
+   std::string handle() const
+   {
+      return handle_;
    }
 
-   void onStdout(const core::system::ProcessOperations& ops, const std::string& data)
+   // launch the background search
+   void start()
    {
+      core::thread::safeLaunchThread(
+            boost::bind(&FindOperation::runController, shared_from_this()));
+   }
+
+   // main thread: drain pending matches and stream them to the
+   // client. returns false when the operation is complete (which
+   // unschedules the periodic work)
+   bool processResults()
+   {
+      // detect cancellation (stop_find rpc or a newer find operation)
+      if (!findResults().isRunning() || findResults().handle() != handle())
+         requestStop();
+
+      // grab the pending matches
+      std::deque<FindMatch> matches;
+      bool complete = false;
+      LOCK_MUTEX(resultsMutex_)
+      {
+         matches.swap(pendingMatches_);
+         complete = workersDone_;
+      }
+      END_LOCK_MUTEX
+
       json::Array files;
       json::Array lineNums;
       json::Array contents;
@@ -324,57 +416,42 @@ private:
       if (!websiteOutputDir.empty())
          websiteOutputDir = "/" + websiteOutputDir + "/";
 
-      stdOutBuf_.append(data);
-      size_t nextLineStart = 0;
-      size_t pos = -1;
-      while (recordsToProcess &&
-             std::string::npos != (pos = stdOutBuf_.find('\n', pos + 1)))
+      BOOST_FOREACH(const FindMatch& match, matches)
       {
-         std::string line = stdOutBuf_.substr(nextLineStart, pos - nextLineStart);
-         nextLineStart = pos + 1;
-
-         boost::smatch match;
-         if (boost::regex_match(line, match, boost::regex("^((?:[a-zA-Z]:)?[^:]+):(\\d+):(.*)")))
-         {
-            std::string file = module_context::createAliasedPath(
-                  FilePath(string_utils::systemToUtf8(match[1])));
-
-            if (file.find("/.Rproj.user/") != std::string::npos)
-               continue;
-            if (file.find("/.git/") != std::string::npos)
-               continue;
-            if (file.find("/.svn/") != std::string::npos)
-               continue;
-            if (file.find("/packrat/lib/") != std::string::npos)
-               continue;
-            if (file.find("/packrat/src/") != std::string::npos)
-               continue;
-            if (file.find("/.Rhistory") != std::string::npos)
-               continue;
-
-            if (!websiteOutputDir.empty() &&
-                file.find(websiteOutputDir) != std::string::npos)
-               continue;
-
-            int lineNum = safe_convert::stringTo<int>(std::string(match[2]), -1);
-            std::string lineContents = match[3];
-            boost::algorithm::trim(lineContents);
-            json::Array matchOn, matchOff;
-            processContents(&lineContents, &matchOn, &matchOff);
-
-            files.push_back(file);
-            lineNums.push_back(lineNum);
-            contents.push_back(lineContents);
-            matchOns.push_back(matchOn);
-            matchOffs.push_back(matchOff);
-
-            recordsToProcess--;
-         }
-      }
-
-      if (nextLineStart)
-      {
-         stdOutBuf_.erase(0, nextLineStart);
+         if (!recordsToProcess)
+            break;
+
+         std::string file = module_context::createAliasedPath(
+                                                   FilePath(match.file));
+
+         if (file.find("/.Rproj.user/") != std::string::npos)
+            continue;
+         if (file.find("/.git/") != std::string::npos)
+            continue;
+         if (file.find("/.svn/") != std::string::npos)
+            continue;
+         if (file.find("/packrat/lib/") != std::string::npos)
+            continue;
+         if (file.find("/packrat/src/") != std::string::npos)
+            continue;
+         if (file.find("/.Rhistory") != std::string::npos)
+            continue;
+
+         if (!websiteOutputDir.empty() &&
+             file.find(websiteOutputDir) != std::string::npos)
+            continue;
+
+         std::string lineContents;
+         json::Array matchOn, matchOff;
+         processMatch(match, &lineContents, &matchOn, &matchOff);
+
+         files.push_back(file);
+         lineNums.push_back(match.lineNum);
+         contents.push_back(lineContents);
+         matchOns.push_back(matchOn);
+         matchOffs.push_back(matchOff);
+
+         recordsToProcess--;
       }
 
       if (files.size() > 0)
@@ -401,28 +478,452 @@ private:
       }
 
       if (recordsToProcess <= 0)
+      {
          findResults().onFindEnd(handle());
+         requestStop();
+      }
+
+      // finish when the workers are done and everything was drained
+      if (complete)
+      {
+         bool drained = false;
+         LOCK_MUTEX(resultsMutex_)
+         {
+            drained = pendingMatches_.empty();
+         }
+         END_LOCK_MUTEX
+
+         if (drained || stopRequested_.load())
+         {
+            findResults().onFindEnd(handle());
+            module_context::enqueClientEvent(
+                  ClientEvent(client_events::kFindOperationEnded, handle()));
+            return false;
+         }
+      }
+      return true;
    }
 
-   void onStderr(const core::system::ProcessOperations& ops, const std::string& data)
+private:
+   void requestStop()
    {
-      LOG_ERROR_MESSAGE("grep: " + data);
+      stopRequested_.store(true);
+      queueCondition_.notify_all();
    }
 
-   void onExit(int exitCode)
+   // controller thread: launch the searcher pool, enumerate the
+   // directory tree into the work queue, then wait for the searchers
+   // to finish
+   void runController()
    {
-      findResults().onFindEnd(handle());
-      module_context::enqueClientEvent(
-            ClientEvent(client_events::kFindOperationEnded, handle()));
-      if (!tempFile_.empty())
-         tempFile_.removeIfExists();
+      try
+      {
+         std::size_t numWorkers = boost::thread::hardware_concurrency();
+         numWorkers = std::max<std::size_t>(1,
+                              std::min<std::size_t>(4, numWorkers));
+
+         boost::thread_group workers;
+         for (std::size_t i = 0; i < numWorkers; i++)
+         {
+            workers.create_thread(
+               boost::bind(&FindOperation::runWorker, shared_from_this()));
+         }
+
+         enumerateDirectory(directory_);
+
+         LOCK_MUTEX(queueMutex_)
+         {
+            enumerationDone_ = true;
+         }
+         END_LOCK_MUTEX
+         queueCondition_.notify_all();
+
+         workers.join_all();
+      }
+      CATCH_UNEXPECTED_EXCEPTION
+
+      LOCK_MUTEX(resultsMutex_)
+      {
+         workersDone_ = true;
+      }
+      END_LOCK_MUTEX
+   }
+
+   void enumerateDirectory(const FilePath& dir)
+   {
+      if (stopRequested_.load())
+         return;
+
+      std::vector<FilePath> children;
+      Error error = dir.children(&children);
+      if (error)
+         return; // unreadable directories are skipped (as grep did)
+
+      BOOST_FOREACH(const FilePath& child, children)
+      {
+         if (stopRequested_.load())
+            return;
+
+         // don't traverse links (mirrors grep -r) -- this also
+         // excludes devices and other special files
+         if (child.isSymlink())
+            continue;
+
+         if (child.isDirectory())
+         {
+            // these are excluded from the results downstream so
+            // don't bother walking them
+            std::string name = child.filename();
+            if (name == ".git" || name == ".svn" || name == ".Rproj.user")
+               continue;
+
+            enumerateDirectory(child);
+         }
+         else
+         {
+            if (!matchesIncludePatterns(child.filename()))
+               continue;
+
+            LOCK_MUTEX(queueMutex_)
+            {
+               workQueue_.push_back(child);
+            }
+            END_LOCK_MUTEX
+            queueCondition_.notify_one();
+         }
+      }
+   }
+
+   bool matchesIncludePatterns(const std::string& name)
+   {
+      if (includePatterns_.empty())
+         return true;
+
+      BOOST_FOREACH(const boost::regex& pattern, includePatterns_)
+      {
+         if (boost::regex_match(name, pattern))
+            return true;
+      }
+      return false;
+   }
+
+   // searcher thread: pull file paths off the work queue until the
+   // enumeration is complete and the queue is exhausted
+   void runWorker()
+   {
+      try
+      {
+         while (!stopRequested_.load())
+         {
+            FilePath filePath;
+            {
+               boost::unique_lock<boost::mutex> lock(queueMutex_);
+               while (workQueue_.empty() &&
+                      !enumerationDone_ &&
+                      !stopRequested_.load())
+               {
+                  queueCondition_.wait(lock);
+               }
+
+               if (workQueue_.empty())
+                  return;
+
+               filePath = workQueue_.front();
+               workQueue_.pop_front();
+            }
+
+            searchFile(filePath);
+         }
+      }
+      CATCH_UNEXPECTED_EXCEPTION
+   }
+
+   void searchFile(const FilePath& filePath)
+   {
+      std::string contents;
+      Error error = core::readStringFromFile(filePath, &contents);
+      if (error)
+         return; // unreadable files are skipped (as grep did)
+
+      // skip binary files (as grep --binary-files=without-match did)
+      std::size_t probeLen = std::min<std::size_t>(contents.size(), 8192);
+      if (probeLen > 0 &&
+          std::memchr(contents.data(), '\0', probeLen) != NULL)
+      {
+         return;
+      }
+
+      if (asRegex_)
+      {
+         // cheap substring prefilter before the regex scan
+         if (!literal_.empty() &&
+             findNext(contents, 0, literal_, ignoreCase_) ==
+                                                      std::string::npos)
+         {
+            return;
+         }
+
+         searchRegex(filePath.absolutePath(), contents);
+      }
+      else
+      {
+         searchFixed(filePath.absolutePath(), contents);
+      }
+   }
+
+   // fixed string search: driven by substring occurrences so that
+   // files and lines without a match are never walked byte by byte
+   void searchFixed(const std::string& file, const std::string& contents)
+   {
+      std::size_t searchFrom = 0;
+      std::size_t countedTo = 0;
+      int lineNum = 1;
+      while (!stopRequested_.load())
+      {
+         std::size_t hit = findNext(contents, searchFrom, pattern_,
+                                    ignoreCase_);
+         if (hit == std::string::npos)
+            break;
+
+         // update the line number incrementally
+         lineNum += std::count(contents.begin() + countedTo,
+                               contents.begin() + hit,
+                               '\n');
+         countedTo = hit;
+
+         // locate the enclosing line
+         std::size_t lineStart = contents.rfind('\n', hit);
+         lineStart = (lineStart == std::string::npos) ? 0 : lineStart + 1;
+         std::size_t lineEnd = contents.find('\n', hit);
+         if (lineEnd == std::string::npos)
+            lineEnd = contents.size();
+
+         // collect all of the matches on this line
+         FindMatch match;
+         match.file = file;
+         match.lineNum = lineNum;
+         match.line = contents.substr(lineStart, lineEnd - lineStart);
+         if (!match.line.empty() && *match.line.rbegin() == '\r')
+            match.line.erase(match.line.size() - 1);
+
+         std::size_t pos = hit;
+         while (pos != std::string::npos && pos < lineEnd)
+         {
+            match.matches.push_back(std::make_pair(
+                     static_cast<int>(pos - lineStart),
+                     static_cast<int>(pos - lineStart + pattern_.size())));
+            pos = findNext(contents, pos + std::max<std::size_t>(
+                              pattern_.size(), 1), pattern_, ignoreCase_);
+         }
+         emitMatch(match);
+
+         searchFrom = lineEnd + 1;
+         if (searchFrom >= contents.size())
+            break;
+      }
+   }
+
+   // regex search: line by line (each matching line may contain
+   // multiple matches)
+   void searchRegex(const std::string& file, const std::string& contents)
+   {
+      int lineNum = 1;
+      const char* pData = contents.data();
+      const char* pEnd = pData + contents.size();
+      const char* pLine = pData;
+      while (pLine <= pEnd && !stopRequested_.load())
+      {
+         const char* pNewline = static_cast<const char*>(
+                        std::memchr(pLine, '\n', pEnd - pLine));
+         const char* pLineEnd = pNewline ? pNewline : pEnd;
+
+         boost::cregex_iterator it(pLine, pLineEnd, regex_);
+         boost::cregex_iterator end;
+         if (it != end)
+         {
+            FindMatch match;
+            match.file = file;
+            match.lineNum = lineNum;
+            match.line.assign(pLine, pLineEnd);
+            if (!match.line.empty() && *match.line.rbegin() == '\r')
+               match.line.erase(match.line.size() - 1);
+
+            for (; it != end; ++it)
+            {
+               int on = static_cast<int>((*it).position());
+               int off = on + static_cast<int>((*it).length());
+               match.matches.push_back(std::make_pair(on, off));
+            }
+            emitMatch(match);
+         }
+
+         if (pNewline == NULL)
+            break;
+         pLine = pNewline + 1;
+         lineNum++;
+      }
+   }
+
+   // queue a match for the main thread (throttling if the main
+   // thread has fallen far behind)
+   void emitMatch(const FindMatch& match)
+   {
+      while (!stopRequested_.load())
+      {
+         bool queued = false;
+         LOCK_MUTEX(resultsMutex_)
+         {
+            if (pendingMatches_.size() < kMaxPendingMatches)
+            {
+               pendingMatches_.push_back(match);
+               queued = true;
+            }
+         }
+         END_LOCK_MUTEX
+
+         if (queued)
+            return;
+
+         boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+      }
+   }
+
+   // decode a raw matching line to UTF-8, converting the byte offset
+   // match ranges to UTF-8 character offsets as we go (and trimming
+   // and truncating the line the same way the grep pipeline did)
+   void processMatch(const FindMatch& match,
+                     std::string* pLineContents,
+                     json::Array* pMatchOn,
+                     json::Array* pMatchOff)
+   {
+      // trim whitespace, shifting the match offsets accordingly
+      std::string line = match.line;
+      std::size_t leading = 0;
+      std::size_t firstPos = line.find_first_not_of(" \t");
+      if (firstPos == std::string::npos)
+      {
+         line.clear();
+      }
+      else
+      {
+         std::size_t lastPos = line.find_last_not_of(" \t");
+         line = line.substr(firstPos, lastPos - firstPos + 1);
+         leading = firstPos;
+      }
+
+      std::string decodedLine;
+      std::size_t nUtf8CharactersProcessed = 0;
+      std::size_t prev = 0;
+
+      typedef std::pair<int, int> MatchRange;
+      BOOST_FOREACH(const MatchRange& range, match.matches)
+      {
+         std::size_t on = clampOffset(range.first - (int)leading,
+                                      line.size());
+         std::size_t off = clampOffset(range.second - (int)leading,
+                                       line.size());
+         if (off < prev)
+            continue;
+         if (on < prev)
+            on = prev;
+
+         appendDecoded(line, prev, on,
+                       &decodedLine, &nUtf8CharactersProcessed);
+         pMatchOn->push_back(
+               static_cast<int>(nUtf8CharactersProcessed));
+
+         appendDecoded(line, on, off,
+                       &decodedLine, &nUtf8CharactersProcessed);
+         pMatchOff->push_back(
+               static_cast<int>(nUtf8CharactersProcessed));
+
+         prev = off;
+      }
+      appendDecoded(line, prev, line.size(),
+                    &decodedLine, &nUtf8CharactersProcessed);
+
+      if (decodedLine.size() > 300)
+      {
+         decodedLine = decodedLine.erase(300);
+         decodedLine.append("...");
+      }
+
+      *pLineContents = decodedLine;
+   }
+
+   static std::size_t clampOffset(int offset, std::size_t size)
+   {
+      if (offset < 0)
+         return 0;
+      if (static_cast<std::size_t>(offset) > size)
+         return size;
+      return static_cast<std::size_t>(offset);
+   }
+
+   void appendDecoded(const std::string& text,
+                      std::size_t begin,
+                      std::size_t end,
+                      std::string* pOut,
+                      std::size_t* pChars)
+   {
+      if (end <= begin)
+         return;
+
+      std::string decoded = decode(text.substr(begin, end - begin));
+
+      std::size_t charSize;
+      Error error = string_utils::utf8Distance(decoded.begin(),
+                                               decoded.end(),
+                                               &charSize);
+      if (error)
+         charSize = decoded.size();
+
+      *pChars += charSize;
+      pOut->append(decoded);
+   }
+
+   std::string decode(const std::string& encoded)
+   {
+      if (encoded.empty())
+         return encoded;
+
+      std::string decoded;
+      Error error = r::util::iconvstr(encoded, encoding_, "UTF-8", true,
+                                      &decoded);
+
+      // Log error, but only once per grep operation
+      if (error && firstDecodeError_)
+      {
+         firstDecodeError_ = false;
+         LOG_ERROR(error);
+      }
+
+      return decoded;
    }
 
    bool firstDecodeError_;
    std::string encoding_;
-   FilePath tempFile_;
-   std::string stdOutBuf_;
+   std::string pattern_;
+   bool asRegex_;
+   bool ignoreCase_;
+   FilePath directory_;
+   std::vector<boost::regex> includePatterns_;
+   boost::regex regex_;
+   std::string literal_;
    std::string handle_;
+
+   boost::atomic<bool> stopRequested_;
+
+   // work queue (controller -> searchers)
+   boost::mutex queueMutex_;
+   boost::condition_variable queueCondition_;
+   std::deque<FilePath> workQueue_;
+   bool enumerationDone_;
+
+   // results queue (searchers -> main thread)
+   boost::mutex resultsMutex_;
+   std::deque<FindMatch> pendingMatches_;
+   bool workersDone_;
 };
 
 } // namespace
@@ -444,26 +945,8 @@ core::Error beginFind(const json::JsonRpcRequest& request,
    if (error)
       return error;
 
-   core::system::ProcessOptions options;
-
-   core::system::Options childEnv;
-   core::system::environment(&childEnv);
-   core::system::setenv(&childEnv, "GREP_COLOR", "01");
-   core::system::setenv(&childEnv, "GREP_COLORS", "ne:fn=:ln=:se=:mt=01");
-#ifdef _WIN32
-   FilePath gnuGrepPath = session::options().gnugrepPath();
-   core::system::addToPath(
-            &childEnv,
-            string_utils::utf8ToSystem(gnuGrepPath.absolutePath()));
-#endif
-   options.environment = childEnv;
-
-   // Put the grep pattern in a file
-   FilePath tempFile = module_context::tempFile("rs_grep", "txt");
-   boost::shared_ptr<std::ostream> pStream;
-   error = tempFile.open_w(&pStream);
-   if (error)
-      return error;
+   // the search scans raw file bytes, so convert the pattern from
+   // UTF-8 to the file encoding
    std::string encoding = projects::projectContext().hasProject() ?
                           projects::projectContext().defaultEncoding() :
                           userSettings().defaultEncoding();
@@ -479,56 +962,58 @@ core::Error beginFind(const json::JsonRpcRequest& request,
       encodedString = searchString;
    }
 
-   *pStream << encodedString << std::endl;
-   pStream.reset(); // release file handle
-
-   boost::shared_ptr<GrepOperation> ptrGrepOp = GrepOperation::create(encoding,
-                                                                      tempFile);
-   core::system::ProcessCallbacks callbacks =
-                                       ptrGrepOp->createProcessCallbacks();
-
-#ifdef _WIN32
-   shell_utils::ShellCommand cmd(gnuGrepPath.complete("grep"));
-#else
-   shell_utils::ShellCommand cmd("grep");
-#endif
-   cmd << "-rHn" << "--binary-files=without-match" << "--color=always";
-#ifndef _WIN32
-   cmd << "--devices=skip";
-#endif
-
-   if (ignoreCase)
-      cmd << "-i";
-
-   // Use -f to pass pattern via file, so we don't have to worry about
-   // escaping double quotes, etc.
-   cmd << "-f";
-   cmd << tempFile;
-   if (!asRegex)
-      cmd << "-F";
+   // validate the regex up front (so a bad pattern surfaces as an
+   // rpc error rather than zero results)
+   if (asRegex)
+   {
+      try
+      {
+         boost::regex validate(encodedString);
+      }
+      catch(const boost::regex_error&)
+      {
+         return systemError(boost::system::errc::invalid_argument,
+                            ERROR_LOCATION);
+      }
+   }
 
-   BOOST_FOREACH(json::Value filePattern, filePatterns)
+   // compile the file patterns (wildcards) into filename regexes
+   std::vector<boost::regex> includePatterns;
+   BOOST_FOREACH(const json::Value& filePattern, filePatterns)
    {
-      cmd << "--include=" + filePattern.get_str();
+      includePatterns.push_back(boost::regex(
+            regex_utils::wildcardPatternToRegex(filePattern.get_str())));
    }
 
-   cmd << shell_utils::EscapeFilesOnly << "--" << shell_utils::EscapeAll;
-   cmd << module_context::resolveAliasedPath(directory);
+   FilePath directoryPath = module_context::resolveAliasedPath(directory);
+
+   boost::shared_ptr<FindOperation> ptrFindOp =
+         FindOperation::create(encoding,
+                               encodedString,
+                               asRegex,
+                               ignoreCase,
+                               directoryPath,
+                               includePatterns);
 
    // Clear existing results
    findResults().clear();
 
-   error = module_context::processSupervisor().runCommand(cmd,
-                                                          options,
-                                                          callbacks);
-   if (error)
-      return error;
-
-   findResults().onFindBegin(ptrGrepOp->handle(),
+   // flag the operation as running before starting the search so the
+   // first processResults doesn't interpret the idle state as a stop
+   findResults().onFindBegin(ptrFindOp->handle(),
                              searchString,
                              directory,
                              asRegex);
-   pResponse->setResult(ptrGrepOp->handle());
+
+   ptrFindOp->start();
+
+   // drain results on the main thread (decoding requires R)
+   module_context::schedulePeriodicWork(
+            boost::posix_time::milliseconds(100),
+            boost::bind(&FindOperation::processResults, ptrFindOp),
+            false);
+
+   pResponse->setResult(ptrFindOp->handle());
 
    return Success();
 }
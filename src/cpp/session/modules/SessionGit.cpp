@@ -43,6 +43,7 @@
 #include <core/Exec.hpp>
 #include <core/FileSerializer.hpp>
 #include <core/GitGraph.hpp>
+#include <core/RegexUtils.hpp>
 #include <core/Scope.hpp>
 #include <core/StringUtils.hpp>
 
@@ -262,11 +263,62 @@ bool isUntracked(const source_control::StatusResult& statusResult,
    return statusResult.getStatus(filePath).status() == "??";
 }
 
+// commands which only inspect the repository -- everything else is
+// presumed to potentially change file status (see Git::runGit)
+bool isReadOnlyGitCommand(const std::string& command)
+{
+   return command == "status" ||
+          command == "log" ||
+          command == "diff" ||
+          command == "show" ||
+          command == "branch" ||
+          command == "rev-parse" ||
+          command == "ls-files" ||
+          command == "for-each-ref" ||
+          command == "cat-file" ||
+          command == "config";
+}
+
+// invalidates the status cache maintained by s_git_ and enqueues a
+// client refresh (defined after s_git_; bound into console process
+// onExit so it must not reference a particular Git instance)
+void invalidateGitStatusCacheAndRefresh();
+
+// upper bound on the number of touched paths we are willing to pass to
+// a single batched 'git status -- <paths>' call -- above this a full
+// rescan is cheaper than an enormous command line
+const size_t kMaxIncrementalStatusPaths = 100;
+
+// expire the cached status after this long -- changes made to the
+// index from outside the session (e.g. git add in a terminal) don't
+// produce file monitor events, so don't serve a cached result forever
+const int kStatusCacheExpirySeconds = 60;
+
+// upper bound on the number of memoized read-only command outputs
+const size_t kMaxCachedCommandOutputs = 50;
+
 class Git : public boost::noncopyable
 {
 private:
    FilePath root_;
 
+   // cached status for the root directory, maintained incrementally
+   // from file monitor change events (see statusForRoot)
+   bool statusCacheEnabled_;
+   bool statusCacheValid_;
+   std::map<std::string,std::string> statusCache_;
+   std::vector<FilePath> statusCachePending_;
+   boost::posix_time::ptime statusCacheTime_;
+
+   // memo of output from read-only commands (diff, log, show, etc.) so
+   // that e.g. clicking back and forth between files in the git pane
+   // doesn't fork/exec a git process per click. cleared whenever the
+   // work tree or repository state changes (see runGit)
+   typedef std::map<std::string, core::system::ProcessResult>
+                                                      CommandOutputCache;
+   CommandOutputCache commandOutputCache_;
+   boost::posix_time::ptime commandOutputCacheTime_;
+
 protected:
    core::Error runGit(const ShellArgs& args,
                       std::string* pStdOut=NULL,
@@ -275,6 +327,44 @@ protected:
    {
       using namespace rstudio::core::system;
 
+      // conservatively invalidate the cached status for any command which
+      // can mutate the repository (invalidate up front since even failed
+      // commands can have partial effects)
+      bool readOnly = !args.args().empty() &&
+                      isReadOnlyGitCommand(args.args().front());
+      if (!readOnly)
+         invalidateStatusCache();
+
+      // for read-only commands (excepting status, which maintains its own
+      // cache) check the output memo -- memoization is only safe when the
+      // file monitor is feeding us change events, and uses the same expiry
+      // as the status cache to bound the staleness of unobserved changes
+      std::string commandKey;
+      if (readOnly && statusCacheEnabled_ && args.args().front() != "status")
+      {
+         using namespace boost::posix_time;
+         if ((microsec_clock::universal_time() - commandOutputCacheTime_) >=
+                                    seconds(kStatusCacheExpirySeconds))
+         {
+            commandOutputCache_.clear();
+            commandOutputCacheTime_ = microsec_clock::universal_time();
+         }
+
+         commandKey = boost::algorithm::join(args.args(), "\n");
+         CommandOutputCache::const_iterator it =
+                                    commandOutputCache_.find(commandKey);
+         if (it != commandOutputCache_.end())
+         {
+            if (pStdOut)
+               *pStdOut = it->second.stdOut;
+            if (pStdErr)
+               *pStdErr = it->second.stdErr;
+            if (pExitCode)
+               *pExitCode = it->second.exitStatus;
+            return Success();
+         }
+      }
+
       ProcessResult result;
       Error error = gitExec(args, root_, &result);
       if (error)
@@ -291,6 +381,12 @@ protected:
       {
          LOG_DEBUG_MESSAGE(result.stdErr);
       }
+      else if (!commandKey.empty())
+      {
+         if (commandOutputCache_.size() >= kMaxCachedCommandOutputs)
+            commandOutputCache_.clear();
+         commandOutputCache_[commandKey] = result;
+      }
 
       return Success();
    }
@@ -329,7 +425,10 @@ protected:
                                      console_process::kDefaultMaxOutputLines);
 #endif
 
-      (*ppCP)->onExit().connect(boost::bind(&enqueueRefreshEvent));
+      // console procs (commit, checkout, push, pull, etc.) mutate the
+      // repository so drop the cached status when they complete
+      (*ppCP)->onExit().connect(
+                     boost::bind(&invalidateGitStatusCacheAndRefresh));
 
       return Success();
    }
@@ -367,11 +466,15 @@ protected:
 
 public:
 
-   Git() : root_(FilePath())
+   Git() : root_(FilePath()),
+           statusCacheEnabled_(false),
+           statusCacheValid_(false)
    {
    }
 
-   Git(const FilePath& root) : root_(root)
+   Git(const FilePath& root) : root_(root),
+                               statusCacheEnabled_(false),
+                               statusCacheValid_(false)
    {
    }
 
@@ -387,20 +490,10 @@ public:
       root_ = path;
    }
 
-   core::Error status(const FilePath& dir,
-                      StatusResult* pStatusResult)
+   void parseStatusOutput(const std::string& output,
+                          std::vector<FileWithStatus>* pFiles)
    {
-      using namespace boost;
-
-      std::vector<FileWithStatus> files;
-
-      std::vector<std::string> lines;
-      std::string output;
-      Error error = runGit(ShellArgs() << "status" << "--porcelain" << "--" << dir,
-                           &output);
-      if (error)
-         return error;
-      lines = split(output);
+      std::vector<std::string> lines = split(output);
 
       for (std::vector<std::string>::iterator it = lines.begin();
            it != lines.end();
@@ -418,14 +511,165 @@ public:
             filePath = filePath.substr(0, filePath.size() - 1);
          file.path = root_.childPath(string_utils::systemToUtf8(filePath));
 
+         pFiles->push_back(file);
+      }
+   }
+
+   core::Error runStatus(const FilePath& dir,
+                         std::vector<FileWithStatus>* pFiles)
+   {
+      std::string output;
+      Error error = runGit(ShellArgs() << "status" << "--porcelain" << "--" << dir,
+                           &output);
+      if (error)
+         return error;
+
+      parseStatusOutput(output, pFiles);
+      return Success();
+   }
+
+   // status for the git root -- served from an incrementally maintained
+   // cache when the file monitor is active so that a status refresh
+   // after every save doesn't require rescanning the whole work tree
+   core::Error statusForRoot(StatusResult* pStatusResult)
+   {
+      using namespace boost::posix_time;
+
+      // determine whether the cache can be used -- it must be fed by an
+      // active file monitor, not expired (changes to the index made from
+      // outside the session aren't visible to the monitor), and have few
+      // enough touched paths for a batched re-check to be worthwhile
+      bool cacheUsable =
+            statusCacheEnabled_ &&
+            statusCacheValid_ &&
+            (microsec_clock::universal_time() - statusCacheTime_) <
+                              seconds(kStatusCacheExpirySeconds) &&
+            statusCachePending_.size() <= kMaxIncrementalStatusPaths;
+
+      if (!cacheUsable)
+      {
+         // full rescan
+         std::vector<FileWithStatus> files;
+         Error error = runStatus(root_, &files);
+         if (error)
+            return error;
+
+         statusCache_.clear();
+         BOOST_FOREACH(const FileWithStatus& file, files)
+         {
+            statusCache_[file.path.absolutePath()] = file.status.status();
+         }
+         statusCachePending_.clear();
+         statusCacheValid_ = true;
+         statusCacheTime_ = microsec_clock::universal_time();
+
+         *pStatusResult = StatusResult(files);
+         return Success();
+      }
+
+      // re-check just the touched paths with a single batched call
+      if (!statusCachePending_.empty())
+      {
+         ShellArgs args;
+         args << "status" << "--porcelain" << "--";
+         appendPathArgs(statusCachePending_, &args);
+
+         std::string output;
+         Error error = runGit(args, &output);
+         if (error)
+            return error;
+
+         std::vector<FileWithStatus> files;
+         parseStatusOutput(output, &files);
+
+         // drop cached entries for the re-checked paths then merge in
+         // whatever git reported for them (a path git didn't report on
+         // is now clean)
+         BOOST_FOREACH(const FilePath& path, statusCachePending_)
+         {
+            statusCache_.erase(path.absolutePath());
+         }
+         BOOST_FOREACH(const FileWithStatus& file, files)
+         {
+            statusCache_[file.path.absolutePath()] = file.status.status();
+         }
+         statusCachePending_.clear();
+      }
+
+      // build the result from the cache
+      std::vector<FileWithStatus> files;
+      for (std::map<std::string,std::string>::const_iterator
+               it = statusCache_.begin(); it != statusCache_.end(); ++it)
+      {
+         FileWithStatus file;
+         file.status = VCSStatus(it->second);
+         file.path = FilePath(it->first);
          files.push_back(file);
       }
 
+      *pStatusResult = StatusResult(files);
+      return Success();
+   }
+
+   core::Error status(const FilePath& dir,
+                      StatusResult* pStatusResult)
+   {
+      if (dir == root_)
+         return statusForRoot(pStatusResult);
+
+      std::vector<FileWithStatus> files;
+      Error error = runStatus(dir, &files);
+      if (error)
+         return error;
+
       *pStatusResult = StatusResult(files);
 
       return Success();
    }
 
+   // the status cache is only enabled while file monitoring covering the
+   // entire work tree is active (we depend on change events to know which
+   // paths to re-check)
+   void enableStatusCache()
+   {
+      statusCacheEnabled_ = true;
+   }
+
+   void disableStatusCache()
+   {
+      statusCacheEnabled_ = false;
+      invalidateStatusCache();
+   }
+
+   void invalidateStatusCache()
+   {
+      statusCacheValid_ = false;
+      statusCache_.clear();
+      statusCachePending_.clear();
+      commandOutputCache_.clear();
+   }
+
+   void markStatusCachePending(const FilePath& filePath)
+   {
+      // any work tree change invalidates memoized diff/log/show output
+      commandOutputCache_.clear();
+
+      if (!statusCacheValid_)
+         return;
+
+      // cap growth -- once over the incremental threshold the next
+      // status request performs a full rescan anyway
+      if (statusCachePending_.size() > kMaxIncrementalStatusPaths)
+         return;
+
+      if (std::find(statusCachePending_.begin(),
+                    statusCachePending_.end(),
+                    filePath) == statusCachePending_.end())
+      {
+         statusCachePending_.push_back(filePath);
+      }
+   }
+
    core::Error add(const std::vector<FilePath>& filePaths)
    {
       return runGit(ShellArgs() << "add" << "--" << filePaths);
@@ -1185,6 +1429,40 @@ public:
 
 Git s_git_;
 
+void invalidateGitStatusCacheAndRefresh()
+{
+   s_git_.invalidateStatusCache();
+   enqueueRefreshEvent();
+}
+
+// hooks for the project file monitor -- these feed the incremental
+// status cache maintained by s_git_
+
+void onFileMonitoringEnabled(const tree<FileInfo>&)
+{
+   // only enable the cache if the monitored directory (the project
+   // directory) covers the entire git work tree -- otherwise changes
+   // outside the monitored scope would go unobserved
+   if (!s_git_.root().empty() &&
+       projects::projectContext().directory() == s_git_.root())
+   {
+      s_git_.enableStatusCache();
+   }
+}
+
+void onFilesChanged(const std::vector<core::system::FileChangeEvent>& events)
+{
+   BOOST_FOREACH(const core::system::FileChangeEvent& event, events)
+   {
+      s_git_.markStatusCachePending(FilePath(event.fileInfo().absolutePath()));
+   }
+}
+
+void onFileMonitoringDisabled()
+{
+   s_git_.disableStatusCache();
+}
+
 FilePath resolveAliasedPath(const std::string& path)
 {
    if (boost::algorithm::starts_with(path, "~/"))
@@ -1628,6 +1906,99 @@ Error vcsDiffFile(const json::JsonRpcRequest& request,
    return Success();
 }
 
+// split a unified diff into its header (everything up to the first hunk)
+// and its individual hunks (each beginning with an @@ line)
+void splitDiffHunks(const std::string& diff,
+                    std::string* pHeader,
+                    std::vector<std::string>* pHunks)
+{
+   std::istringstream istr(diff);
+   std::string line;
+   while (std::getline(istr, line))
+   {
+      line.append("\n");
+      if (boost::algorithm::starts_with(line, "@@"))
+         pHunks->push_back(line);
+      else if (pHunks->empty())
+         pHeader->append(line);
+      else
+         pHunks->back().append(line);
+   }
+}
+
+// windowed variant of git_diff_file -- returns the requested range of
+// hunks plus a continuation cursor rather than the entire diff, so very
+// large diffs can be fetched and rendered incrementally. the underlying
+// diff computation is memoized (see Git::runGit) so paging through
+// windows doesn't re-run git per request
+Error vcsDiffFileChunk(const json::JsonRpcRequest& request,
+                       json::JsonRpcResponse* pResponse)
+{
+   std::string path;
+   int mode;
+   int contextLines;
+   int startHunk;
+   int maxHunks;
+   Error error = json::readParams(request.params,
+                                  &path,
+                                  &mode,
+                                  &contextLines,
+                                  &startHunk,
+                                  &maxHunks);
+   if (error)
+      return error;
+
+   if (contextLines < 0)
+      contextLines = 999999999;
+
+   splitRename(path, NULL, &path);
+
+   std::string output;
+   error = s_git_.diffFile(resolveAliasedPath(path),
+                           static_cast<PatchMode>(mode),
+                           contextLines,
+                           &output);
+   if (error)
+      return error;
+
+   std::string sourceEncoding = projects::projectContext().defaultEncoding();
+   bool usedSourceEncoding;
+   output = convertDiff(output, sourceEncoding, "UTF-8", false,
+                        &usedSourceEncoding);
+   if (!usedSourceEncoding)
+      sourceEncoding = "";
+
+   std::string header;
+   std::vector<std::string> hunks;
+   splitDiffHunks(output, &header, &hunks);
+
+   // resolve the requested window ([startHunk, startHunk + maxHunks),
+   // where maxHunks <= 0 means all remaining hunks)
+   int totalHunks = static_cast<int>(hunks.size());
+   startHunk = std::min(std::max(startHunk, 0), totalHunks);
+   int endHunk = (maxHunks <= 0)
+                     ? totalHunks
+                     : std::min(startHunk + maxHunks, totalHunks);
+
+   // the header is only included with the first window
+   std::string value;
+   if (startHunk == 0)
+      value = header;
+   for (int i = startHunk; i < endHunk; i++)
+      value.append(hunks[i]);
+
+   json::Object result;
+   result["source_encoding"] = sourceEncoding;
+   result["decoded_value"] = value;
+   result["start_hunk"] = startHunk;
+   result["next_hunk"] = endHunk;
+   result["total_hunks"] = totalHunks;
+   result["more_available"] = endHunk < totalHunks;
+   pResponse->setResult(result);
+
+   return Success();
+}
+
 Error vcsApplyPatch(const json::JsonRpcRequest& request,
                     json::JsonRpcResponse* pResponse)
 {
@@ -2154,7 +2525,7 @@ bool ensureSSHAgentIsRunning()
    // it so we can modify rsession's environment to use the new ssh-agent
    // as well.
    boost::sregex_iterator it(result.stdOut.begin(), result.stdOut.end(),
-                             boost::regex("^([A-Za-z0-9_]+)=([^;]+);"));
+                             regex_utils::cached("^([A-Za-z0-9_]+)=([^;]+);"));
    boost::sregex_iterator end;
    for (; it != end; it++)
    {
@@ -2207,7 +2578,7 @@ std::string transformKeyPath(const std::string& path)
 {
 #ifdef _WIN32
    boost::smatch match;
-   if (boost::regex_match(path, match, boost::regex("/([a-zA-Z])/.*")))
+   if (boost::regex_match(path, match, regex_utils::cached("/([a-zA-Z])/.*")))
    {
       return match[1] + std::string(":") + path.substr(2);
    }
@@ -2227,13 +2598,15 @@ void postbackSSHAskPass(const std::string& prompt,
    FilePath keyFile;
 
    // This is what the prompt looks like on OpenSSH_4.6p1 (Windows)
-   if (boost::regex_match(prompt, match, boost::regex("Enter passphrase for key '(.+)': ")))
+   if (boost::regex_match(prompt, match,
+          regex_utils::cached("Enter passphrase for key '(.+)': ")))
    {
       promptToRemember = true;
       keyFile = FilePath(transformKeyPath(match[1]));
    }
    // This is what the prompt looks like on OpenSSH_5.8p1 Debian-7ubuntu1 (Ubuntu 11.10)
-   else if (boost::regex_match(prompt, match, boost::regex("Enter passphrase for (.+): ")))
+   else if (boost::regex_match(prompt, match,
+               regex_utils::cached("Enter passphrase for (.+): ")))
    {
       promptToRemember = true;
       keyFile = FilePath(transformKeyPath(match[1]));
@@ -2620,7 +2993,7 @@ Error augmentGitIgnore(const FilePath& gitIgnoreFile)
       if (error)
          return error;
 
-      if (boost::regex_search(strIgnore, boost::regex("^\\.Rproj\\.user$")))
+      if (boost::regex_search(strIgnore, regex_utils::cached("^\\.Rproj\\.user$")))
          return Success();
 
       bool addExtraNewline = strIgnore.size() > 0
@@ -2808,7 +3181,7 @@ bool initGitBin()
          boost::smatch matches;
          if (boost::regex_search(result.stdOut,
                                  matches,
-                                 boost::regex("\\d+(\\.\\d+)+")))
+                                 regex_utils::cached("\\d+(\\.\\d+)+")))
          {
             string_utils::parseVersion(matches[0], &s_gitVersion);
          }
@@ -2934,6 +3307,18 @@ core::Error initialize()
    // add settings changed handler
    userSettings().onChanged.connect(onUserSettingsChanged);
 
+   // subscribe to the project file monitor so the status cache can be
+   // maintained incrementally (re-checking only touched paths) rather
+   // than rescanning the whole work tree on every refresh
+   if (projects::projectContext().hasProject())
+   {
+      projects::FileMonitorCallbacks cb;
+      cb.onMonitoringEnabled = onFileMonitoringEnabled;
+      cb.onFilesChanged = onFilesChanged;
+      cb.onMonitoringDisabled = onFileMonitoringDisabled;
+      projects::projectContext().subscribeToFileMonitor("Git status", cb);
+   }
+
    // install rpc methods
    using boost::bind;
    using namespace module_context;
@@ -2953,6 +3338,7 @@ core::Error initialize()
       (bind(registerRpcMethod, "git_push", vcsPush))
       (bind(registerRpcMethod, "git_pull", vcsPull))
       (bind(registerRpcMethod, "git_diff_file", vcsDiffFile))
+      (bind(registerRpcMethod, "git_diff_file_chunk", vcsDiffFileChunk))
       (bind(registerRpcMethod, "git_apply_patch", vcsApplyPatch))
       (bind(registerRpcMethod, "git_history_count", vcsHistoryCount))
       (bind(registerRpcMethod, "git_history", vcsHistory))
@@ -157,6 +157,11 @@ public:
       return output;
    }
 
+   FilePath outputFile() const
+   {
+      return outputFile_;
+   }
+
    FilePath htmlPreviewFile()
    {
       FilePath baseFile = requiresKnit() ? knitrOutputFile() : targetFile();
@@ -806,12 +811,53 @@ void setVarFromHtmlResourceFile(const std::string& name,
    setVarFromHtmlResourceFile(name, name + ".html", pVars);
 }
 
+// cache of the most recently generated internal markdown preview. the
+// template merge and base64 image inlining performed below are the
+// expensive part of a preview refresh (several seconds on image-heavy
+// vignettes) and their inputs can't change without a new preview being
+// created or the knitr output file being rewritten, so we key on those
+struct PreviewHtmlCache
+{
+   PreviewHtmlCache() : pPreview(NULL), outputLastWriteTime(0) {}
+   void* pPreview;
+   std::time_t outputLastWriteTime;
+   std::string html;
+};
+PreviewHtmlCache s_previewHtmlCache;
+
+void setPreviewHtmlResponse(const std::string& html,
+                            const http::Request& request,
+                            http::Response* pResponse)
+{
+   // like setDynamicHtml, but with revalidation caching so a refresh of
+   // an unchanged preview document is answered with a 304 rather than
+   // the full body
+   pResponse->setContentType("text/html");
+   pResponse->setCacheWithRevalidationHeaders();
+   if (request.acceptsEncoding(http::kGzipEncoding))
+      pResponse->setContentEncoding(http::kGzipEncoding);
+   Error error = pResponse->setCacheableBody(html, request);
+   if (error)
+      pResponse->setError(error);
+}
+
 void handleInternalMarkdownPreviewRequest(
                                   const http::Request& request,
                                   http::Response* pResponse)
 {
    try
    {
+      // serve from the cache if the generation inputs are unchanged
+      std::time_t outputLastWriteTime =
+                        s_pCurrentPreview_->outputFile().lastWriteTime();
+      if (s_previewHtmlCache.pPreview == s_pCurrentPreview_.get() &&
+          s_previewHtmlCache.outputLastWriteTime == outputLastWriteTime &&
+          !s_previewHtmlCache.html.empty())
+      {
+         setPreviewHtmlResponse(s_previewHtmlCache.html, request, pResponse);
+         return;
+      }
+
       // read input template
       FilePath resPath = session::options().rResourcesPath();
       std::string previewTemplate;
@@ -885,9 +931,12 @@ void handleInternalMarkdownPreviewRequest(
             LOG_ERROR(error);
       }
 
-      // modify outpout then write back to client
+      // modify output, cache it, then write back to client
       modifyOutputForPreview(&previewHtml);
-      pResponse->setDynamicHtml(previewHtml, request);
+      s_previewHtmlCache.pPreview = s_pCurrentPreview_.get();
+      s_previewHtmlCache.outputLastWriteTime = outputLastWriteTime;
+      s_previewHtmlCache.html = previewHtml;
+      setPreviewHtmlResponse(previewHtml, request, pResponse);
    }
    catch(const std::exception& e)
    {
@@ -909,8 +958,10 @@ void handlePreviewRequest(const http::Request& request,
       return;
    }
 
-   // disable caching entirely
-   pResponse->setNoCacheHeaders();
+   // cache with revalidation so unchanged documents and assets are
+   // served as 304s during the edit-preview loop (a regenerated preview
+   // gets a fresh last-modified/etag so staleness isn't possible)
+   pResponse->setCacheWithRevalidationHeaders();
 
    // get the requested path
    std::string path = http::util::pathAfterPrefix(request,
@@ -924,16 +975,18 @@ void handlePreviewRequest(const http::Request& request,
          if (s_pCurrentPreview_->isInternalMarkdown())
             handleInternalMarkdownPreviewRequest(request, pResponse);
          else
-            pResponse->setFile(s_pCurrentPreview_->htmlPreviewFile(),
-                               request);
+            pResponse->setCacheableFile(s_pCurrentPreview_->htmlPreviewFile(),
+                                        request);
       }
       else if (s_pCurrentPreview_->requiresKnit())
       {
-         pResponse->setFile(s_pCurrentPreview_->knitrOutputFile(), request);
+         pResponse->setCacheableFile(s_pCurrentPreview_->knitrOutputFile(),
+                                     request);
       }
       else
       {
-         pResponse->setFile(s_pCurrentPreview_->targetFile(), request);
+         pResponse->setCacheableFile(s_pCurrentPreview_->targetFile(),
+                                     request);
       }
    }
 
@@ -943,7 +996,7 @@ void handlePreviewRequest(const http::Request& request,
 
       FilePath filePath =
             session::options().mathjaxPath().parent().childPath(path);
-      pResponse->setFile(filePath, request);
+      pResponse->setCacheableFile(filePath, request);
    }
 
    // request for dependent file
@@ -951,7 +1004,7 @@ void handlePreviewRequest(const http::Request& request,
    {
       FilePath filePath = s_pCurrentPreview_->targetDirectory().childPath(path);
       addFileSpecificHeaders(filePath, pResponse);
-      pResponse->setFile(filePath, request);
+      pResponse->setCacheableFile(filePath, request);
    }
 }
 
@@ -27,12 +27,14 @@
 
 #include <core/Error.hpp>
 #include <core/Exec.hpp>
+#include <core/Hash.hpp>
 #include <core/Log.hpp>
 
 #include <core/http/Request.hpp>
 #include <core/http/Response.hpp>
 #include <core/http/URL.hpp>
 #include <core/FileSerializer.hpp>
+#include <core/RegexUtils.hpp>
 #include <core/system/Process.hpp>
 #include <core/system/ShellUtils.hpp>
 #include <core/r_util/RPackageInfo.hpp>
@@ -197,7 +199,8 @@ bool handleLocalHttpUrl(const std::string& url)
 // displaying the manual. Redirect these to the appropriate help event
 bool handleRShowDocFile(const core::FilePath& filePath)
 {
-   boost::regex manualRegx(".*/lib/R/(doc/manual/[A-Za-z0-9_\\-]*\\.html)");
+   const boost::regex& manualRegx = regex_utils::cached(
+                     ".*/lib/R/(doc/manual/[A-Za-z0-9_\\-]*\\.html)");
    boost::smatch match;
    if (regex_match(filePath.absolutePath(), match, manualRegx))
    {
@@ -399,33 +402,44 @@ void handleHttpdResult(SEXP httpdSEXP,
       {
          // get file path
          FilePath filePath(fileName);
-         
-         // read file contents
-         std::string contents;
-         Error error = readStringFromFile(filePath, &contents);
-         if (error)
-         {
-            pResponse->setError(error);
-            return;
-         }
 
          if (options().programMode() == kSessionProgramModeServer)
             pResponse->setCacheWithRevalidationHeaders();
 
-         // set body (apply filter to html)
-         if (pResponse->contentType() == kTextHtml)
+         // non-html content (css/js/images -- the bulk of a help page's
+         // requests) is filter-free and immutable per R version, so serve
+         // it through the in-memory asset cache rather than reading the
+         // file on every request
+         if (pResponse->contentType() != kTextHtml &&
+             options().programMode() == kSessionProgramModeServer)
          {
-            if (options().programMode() == kSessionProgramModeServer)
-               pResponse->setCacheableBody(contents, request, htmlFilter);
-            else
-               pResponse->setBody(contents, htmlFilter);
+            module_context::setCacheableFileResponse(filePath,
+                                                     request,
+                                                     pResponse);
          }
          else
          {
-            if (options().programMode() == kSessionProgramModeServer)
-               pResponse->setCacheableBody(contents, request);
+            // read file contents
+            std::string contents;
+            Error error = readStringFromFile(filePath, &contents);
+            if (error)
+            {
+               pResponse->setError(error);
+               return;
+            }
+
+            // set body (apply filter to html)
+            if (pResponse->contentType() == kTextHtml)
+            {
+               if (options().programMode() == kSessionProgramModeServer)
+                  pResponse->setCacheableBody(contents, request, htmlFilter);
+               else
+                  pResponse->setBody(contents, htmlFilter);
+            }
             else
+            {
                pResponse->setBody(contents);
+            }
          }
       }
       else // from dynamic content
@@ -787,7 +801,8 @@ SEXP s_customHandlersEnv = NULL;
 SEXP lookupCustomHandler(const std::string& uri)
 {
    // pick name of handler out of uri
-   boost::regex customRegx(".*/custom/([A-Za-z0-9_\\-]*).*");
+   const boost::regex& customRegx = regex_utils::cached(
+                                    ".*/custom/([A-Za-z0-9_\\-]*).*");
    boost::smatch match;
    if (regex_match(uri, match, customRegx))
    {
@@ -827,6 +842,80 @@ void handleCustomRequest(const http::Request& request,
                       pResponse);
 }
 
+// content-addressed serving for htmlwidget dependency assets. every
+// re-render writes its dependencies (often megabytes of unchanged js
+// libraries) into a fresh widget temp directory, so their urls change
+// each time and the browser cache never hits. lib assets are instead
+// redirected to a stable url derived from their content hash, which is
+// served with cache-forever headers -- a re-render then costs one small
+// redirect per asset instead of a full download
+#define kViewerAssetsDir "__viewer_assets__"
+
+// memoized content hashes keyed on file identity (path/size/mtime) so
+// an asset is only read and hashed once per rendered copy
+std::map<std::string, std::string> s_assetHashCache;
+
+// returns the session-temp-relative url path of the content-addressed
+// copy of the given asset (creating the copy if necessary), or empty on
+// failure
+std::string contentAddressedAssetPath(const FilePath& filePath)
+{
+   std::ostringstream keyStream;
+   keyStream << filePath.absolutePath() << ":" << filePath.size() << ":"
+             << filePath.lastWriteTime();
+   std::string key = keyStream.str();
+
+   std::string hash;
+   std::map<std::string, std::string>::const_iterator it =
+                                             s_assetHashCache.find(key);
+   if (it != s_assetHashCache.end())
+   {
+      hash = it->second;
+   }
+   else
+   {
+      std::string contents;
+      Error error = core::readStringFromFile(filePath, &contents);
+      if (error)
+      {
+         LOG_ERROR(error);
+         return std::string();
+      }
+
+      // include the size in the address to harden the 32-bit hash
+      // against collisions
+      std::ostringstream hashStream;
+      hashStream << core::hash::crc32HexHash(contents) << "-"
+                 << filePath.size();
+      hash = hashStream.str();
+
+      // bound cache growth
+      if (s_assetHashCache.size() > 1000)
+         s_assetHashCache.clear();
+      s_assetHashCache[key] = hash;
+   }
+
+   // ensure the content-addressed copy exists
+   FilePath assetFilePath = r::session::utils::tempDir()
+                                       .childPath(kViewerAssetsDir)
+                                       .childPath(hash)
+                                       .childPath(filePath.filename());
+   if (!assetFilePath.exists())
+   {
+      Error error = assetFilePath.parent().ensureDirectory();
+      if (!error)
+         error = filePath.copy(assetFilePath);
+      if (error)
+      {
+         LOG_ERROR(error);
+         return std::string();
+      }
+   }
+
+   return std::string(kViewerAssetsDir) + "/" + hash + "/" +
+          filePath.filename();
+}
+
 // handle requests for session temporary directory
 void handleSessionRequest(const http::Request& request, http::Response* pResponse)
 {
@@ -854,6 +943,39 @@ void handleSessionRequest(const http::Request& request, http::Response* pRespons
    // form a path to the temporary file
    FilePath tempFilePath = r::session::utils::tempDir().childPath(uri);
 
+   // content-addressed asset urls are immutable -- serve forever-cacheable
+   if (boost::algorithm::starts_with(uri, kViewerAssetsDir "/"))
+   {
+      pResponse->setCacheForeverHeaders();
+      pResponse->setFile(tempFilePath, request);
+      return;
+   }
+
+   // redirect widget dependency assets (under a lib/ directory) to their
+   // content-addressed url so identical libraries are downloaded only
+   // once across re-renders
+   if (uri.find("/lib/") != std::string::npos &&
+       tempFilePath.exists() &&
+       tempFilePath.mimeContentType() != "text/html")
+   {
+      std::string assetPath = contentAddressedAssetPath(tempFilePath);
+      if (!assetPath.empty())
+      {
+         // walk back up to the session root so the redirect works under
+         // any path prefix the session is being served from
+         std::string location;
+         for (std::size_t i = 0; i < uri.size(); i++)
+         {
+            if (uri[i] == '/')
+               location += "../";
+         }
+         location += assetPath;
+
+         pResponse->setMovedTemporarily(request, location);
+         return;
+      }
+   }
+
    // return the file
    pResponse->setCacheWithRevalidationHeaders();
    if (tempFilePath.mimeContentType() == "text/html")
@@ -78,8 +78,8 @@ Error setJsonResultFromHistory(int startIndex,
                                int endIndex,
                                json::JsonRpcResponse* pResponse)
 {
-   // get all entries
-   const std::vector<HistoryEntry>& allEntries = historyArchive().entries();
+   // get a snapshot of all entries
+   std::vector<HistoryEntry> allEntries = historyArchive().entries();
 
    // validate indexes
    int historySize = allEntries.size();
@@ -102,21 +102,6 @@ Error setJsonResultFromHistory(int startIndex,
    return Success();
 }
    
-bool matches(const HistoryEntry& entry,
-             const std::vector<std::string>& searchTerms)
-{   
-   // look for each search term in the input
-   for (std::vector<std::string>::const_iterator it = searchTerms.begin();
-        it != searchTerms.end();
-        ++it)
-   {
-      if (!boost::algorithm::contains(entry.command, *it))
-         return false;
-   }
-   
-   // had all of the search terms, return true
-   return true;
-}
 
 
 void historyRangeAsJson(int startIndex,
@@ -270,26 +255,12 @@ Error searchHistoryArchive(const json::JsonRpcRequest& request,
    boost::char_separator<char> sep;
    boost::tokenizer<boost::char_separator<char> > tok(query, sep);
    std::copy(tok.begin(), tok.end(), std::back_inserter(searchTerms));
-   
-   // examine the items in the history for matches
-   const std::vector<HistoryEntry>& allEntries =  historyArchive().entries();
-   std::vector<HistoryEntry> matchingEntries;
-   for (std::vector<HistoryEntry>::const_reverse_iterator 
-            it = allEntries.rbegin();
-            it != allEntries.rend();
-            ++it)
-   {
-      // check limit
-      if (matchingEntries.size() >= static_cast<std::size_t>(maxEntries))
-         break;
 
-      // look for match
-      if (matches(*it, searchTerms))
-      {
-         // add entry
-         matchingEntries.push_back(*it);
-      }
-   }
+   // examine the items in the history for matches (the search runs
+   // under the archive's lock -- this handler executes on the listener
+   // thread so that searches don't wait behind the R event loop)
+   std::vector<HistoryEntry> matchingEntries;
+   historyArchive().search(searchTerms, maxEntries, &matchingEntries);
 
    // return json
    json::Object entriesJson;
@@ -312,31 +283,14 @@ Error searchHistoryArchiveByPrefix(const json::JsonRpcRequest& request,
    
    // trim the prefix
    boost::algorithm::trim(prefix);
-   
-   // examine the items in the history for matches
-   const std::vector<HistoryEntry>& allEntries = historyArchive().entries();
-   std::set<std::string> matchedCommands;
+
+   // examine the items in the history for matches (see the NOTE in
+   // searchHistoryArchive above -- this also runs on the listener
+   // thread)
    std::vector<HistoryEntry> matchingEntries;
-   for (std::vector<HistoryEntry>::const_reverse_iterator 
-        it = allEntries.rbegin();
-        it != allEntries.rend();
-        ++it)
-   {
-      // check limit
-      if (matchingEntries.size() >= static_cast<std::size_t>(maxEntries))
-         break;
-      
-      // look for match 
-      if (boost::algorithm::starts_with(it->command, prefix))
-      {
-         if (!uniqueOnly || (matchedCommands.count(it->command) == 0))
-         {
-            matchingEntries.push_back(*it);
-            matchedCommands.insert(it->command);
-         }
-      }
-   }
-   
+   historyArchive().searchByPrefix(prefix, maxEntries, uniqueOnly,
+                                   &matchingEntries);
+
    // return json
    json::Object entriesJson;
    historyEntriesAsJson(matchingEntries, &entriesJson);
@@ -398,8 +352,8 @@ Error initialize()
       (bind(registerRpcMethod, "remove_history_items", removeHistoryItems))
       (bind(registerRpcMethod, "clear_history", clearHistory))
       (bind(registerRpcMethod, "get_history_archive_items", getHistoryArchiveItems))
-      (bind(registerRpcMethod, "search_history_archive", searchHistoryArchive))
-      (bind(registerRpcMethod, "search_history_archive_by_prefix", searchHistoryArchiveByPrefix));
+      (bind(registerThreadSafeRpcMethod, "search_history_archive", searchHistoryArchive))
+      (bind(registerThreadSafeRpcMethod, "search_history_archive_by_prefix", searchHistoryArchiveByPrefix));
    return initBlock.execute();
 }
 
@@ -15,8 +15,11 @@
 
 #include "SessionHistoryArchive.hpp"
 
+#include <set>
 #include <string>
 
+#include <boost/algorithm/string/predicate.hpp>
+
 #include <core/Error.hpp>
 #include <core/Log.hpp>
 #include <core/FilePath.hpp>
@@ -50,7 +53,7 @@ FilePath historyDatabaseRotatedFilePath()
    return module_context::userScratchPath().complete(kHistoryDatabase ".1");
 }
 
-void rotateHistoryDatabase()
+bool rotateHistoryDatabase()
 {
    FilePath historyDB = historyDatabaseFilePath();
    if (historyDB.exists() && (historyDB.size() > kHistoryMaxBytes))
@@ -62,7 +65,11 @@ void rotateHistoryDatabase()
 
       // now rotate the file
       historyDB.move(rotatedHistoryDB);
+
+      return true;
    }
+
+   return false;
 }
 
 void writeEntry(double timestamp, const std::string& command, std::ostream* pOS)
@@ -119,6 +126,22 @@ ReadCollectionAction readHistoryEntry(const std::string& line,
    }
 }
 
+bool matches(const HistoryEntry& entry,
+             const std::vector<std::string>& searchTerms)
+{
+   // look for each search term in the input
+   for (std::vector<std::string>::const_iterator it = searchTerms.begin();
+        it != searchTerms.end();
+        ++it)
+   {
+      if (!boost::algorithm::contains(entry.command, *it))
+         return false;
+   }
+
+   // had all of the search terms, return true
+   return true;
+}
+
 } // anonymous namespace
 
 HistoryArchive& historyArchive()
@@ -129,23 +152,104 @@ HistoryArchive& historyArchive()
 
 Error HistoryArchive::add(const std::string& command)
 {
-   // reset the cache (since this write will invalidate the current one,
-   // no sense in keeping our cache around in memory)
-   entries_.clear();
-   entryCacheLastWriteTime_ = -1;
+   // guard access to the entry cache (searches may be running on the
+   // listener thread)
+   boost::mutex::scoped_lock lock(mutex_);
 
-   // rotate if necessary
-   rotateHistoryDatabase();
+   // rotate if necessary -- note that rotation discards the oldest
+   // segment and renumbers the remaining entries, so the in-memory
+   // cache must be rebuilt from disk when it occurs
+   bool rotated = rotateHistoryDatabase();
 
    // write the entry to the file
    std::ostringstream ostrEntry ;
    double currentTime = core::date_time::millisecondsSinceEpoch();
    writeEntry(currentTime, command, &ostrEntry);
    ostrEntry << std::endl;
-   return appendToFile(historyDatabaseFilePath(), ostrEntry.str());
+   Error error = appendToFile(historyDatabaseFilePath(), ostrEntry.str());
+
+   // maintain the in-memory cache incrementally so that servicing the
+   // next history query doesn't require re-reading the entire database
+   // (previously we invalidated the cache on every add)
+   if (error || rotated || entryCacheLastWriteTime_ == -1)
+   {
+      entries_.clear();
+      entryCacheLastWriteTime_ = -1;
+   }
+   else
+   {
+      int nextIndex = entries_.empty() ? 0 : entries_.back().index + 1;
+      entries_.push_back(HistoryEntry(nextIndex, currentTime, command));
+      entryCacheLastWriteTime_ = historyDatabaseFilePath().lastWriteTime();
+   }
+
+   return error;
+}
+
+std::vector<HistoryEntry> HistoryArchive::entries() const
+{
+   // copy out under the lock -- the listener-thread search rpcs can
+   // trigger a cache rebuild at any time, so callers need a stable
+   // snapshot rather than a reference into the cache
+   boost::mutex::scoped_lock lock(mutex_);
+   return ensureEntries();
+}
+
+void HistoryArchive::search(const std::vector<std::string>& searchTerms,
+                            int maxEntries,
+                            std::vector<HistoryEntry>* pEntries) const
+{
+   boost::mutex::scoped_lock lock(mutex_);
+
+   // examine the items in the history for matches (most recent first)
+   const std::vector<HistoryEntry>& allEntries = ensureEntries();
+   for (std::vector<HistoryEntry>::const_reverse_iterator
+            it = allEntries.rbegin();
+            it != allEntries.rend();
+            ++it)
+   {
+      // check limit
+      if (pEntries->size() >= static_cast<std::size_t>(maxEntries))
+         break;
+
+      // look for match
+      if (matches(*it, searchTerms))
+         pEntries->push_back(*it);
+   }
+}
+
+void HistoryArchive::searchByPrefix(const std::string& prefix,
+                                    int maxEntries,
+                                    bool uniqueOnly,
+                                    std::vector<HistoryEntry>* pEntries) const
+{
+   boost::mutex::scoped_lock lock(mutex_);
+
+   // examine the items in the history for matches (most recent first)
+   const std::vector<HistoryEntry>& allEntries = ensureEntries();
+   std::set<std::string> matchedCommands;
+   for (std::vector<HistoryEntry>::const_reverse_iterator
+        it = allEntries.rbegin();
+        it != allEntries.rend();
+        ++it)
+   {
+      // check limit
+      if (pEntries->size() >= static_cast<std::size_t>(maxEntries))
+         break;
+
+      // look for match
+      if (boost::algorithm::starts_with(it->command, prefix))
+      {
+         if (!uniqueOnly || (matchedCommands.count(it->command) == 0))
+         {
+            pEntries->push_back(*it);
+            matchedCommands.insert(it->command);
+         }
+      }
+   }
 }
 
-const std::vector<HistoryEntry>& HistoryArchive::entries() const
+const std::vector<HistoryEntry>& HistoryArchive::ensureEntries() const
 {
    // calculate path to history db
    FilePath historyDBPath = historyDatabaseFilePath();
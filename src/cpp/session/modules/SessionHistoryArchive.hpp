@@ -21,6 +21,8 @@
 
 #include <boost/utility.hpp>
 
+#include <core/BoostThread.hpp>
+
 namespace rstudio {
 namespace core {
    class Error;
@@ -59,9 +61,33 @@ public:
 
 public:
    core::Error add(const std::string& command);
-   const std::vector<HistoryEntry>& entries() const;
+
+   // returns a snapshot of the entries copied out under the lock --
+   // the listener-thread search rpcs can rebuild the cache at any time
+   // (when another session writes the history database), so handing out
+   // a reference to the cache itself wouldn't be safe on any thread
+   std::vector<HistoryEntry> entries() const;
+
+   // search the archive (most recent matches first, up to maxEntries).
+   // these are safe to call from the listener thread so that the
+   // per-keystroke search rpcs can be serviced without waiting on
+   // (or tying up) the R event loop
+   void search(const std::vector<std::string>& searchTerms,
+               int maxEntries,
+               std::vector<HistoryEntry>* pEntries) const;
+
+   void searchByPrefix(const std::string& prefix,
+                       int maxEntries,
+                       bool uniqueOnly,
+                       std::vector<HistoryEntry>* pEntries) const;
+
+private:
+   // read the entries (refreshing from disk as necessary). assumes
+   // the caller holds mutex_
+   const std::vector<HistoryEntry>& ensureEntries() const;
 
 private:
+   mutable boost::mutex mutex_;
    mutable time_t entryCacheLastWriteTime_;
    mutable std::vector<HistoryEntry> entries_;
 };
@@ -16,6 +16,7 @@
 
 #include "SessionLists.hpp"
 
+#include <algorithm>
 #include <map>
 
 #include <boost/bind.hpp>
@@ -68,8 +69,17 @@ FilePath listPath(const std::string& name)
    return s_listsPath.complete(name);
 }
 
-template <typename T>
-Error readList(const std::string& name, T* pList)
+// in-memory cache of list contents (keyed by list name). list queries
+// previously re-read the backing file every time and every update began
+// with such a read -- with the user scratch directory on nfs those
+// synchronous reads showed up in file-open latency. entries are
+// discarded by the directory monitor callback whenever a list file
+// changes underneath us (which includes our own writes -- a cheap
+// refresh, since the callback re-reads the list anyway to notify the
+// client)
+std::map<std::string, std::list<std::string> > s_listCache;
+
+Error readList(const std::string& name, std::list<std::string>* pList)
 {
    // lookup list size (also serves as a validation of list name)
    std::size_t size = listSize(name.c_str());
@@ -81,14 +91,24 @@ Error readList(const std::string& name, T* pList)
       return error;
    }
 
+   // serve from the cache when we can
+   std::map<std::string, std::list<std::string> >::const_iterator it =
+                                                      s_listCache.find(name);
+   if (it != s_listCache.end())
+   {
+      *pList = it->second;
+      return Success();
+   }
+
    // read the list from disk
    pList->clear();
    FilePath listFilePath = listPath(name);
    if (listFilePath.exists())
    {
-      Error error = readCollectionFromFile<T>(listFilePath,
-                                              pList,
-                                              parseString);
+      Error error = readCollectionFromFile<std::list<std::string> >(
+                                                             listFilePath,
+                                                             pList,
+                                                             parseString);
       if (error)
          return error;
 
@@ -96,15 +116,27 @@ Error readList(const std::string& name, T* pList)
          pList->resize(size);
    }
 
+   // cache for subsequent queries
+   s_listCache[name] = *pList;
+
    // return success
    return Success();
 }
 
 
-template <typename T>
-Error writeList(const std::string& name, const T& list)
+Error writeList(const std::string& name, const std::list<std::string>& list)
 {
-   return writeCollectionToFile<T>(listPath(name), list, stringifyString);
+   Error error = writeCollectionToFile<std::list<std::string> >(
+                                                            listPath(name),
+                                                            list,
+                                                            stringifyString);
+   if (error)
+      return error;
+
+   // keep the cache current
+   s_listCache[name] = list;
+
+   return Success();
 }
 
 
@@ -132,6 +164,10 @@ void onListsFileChanged(const core::system::FileChangeEvent& fileChange)
    FilePath filePath(fileChange.fileInfo().absolutePath());
    std::string name = filePath.filename();
 
+   // the file changed underneath us (this fires for our own writes as
+   // well as external ones) so discard any cached copy before reading
+   s_listCache.erase(name);
+
    // read it
    std::list<std::string> list;
    Error error = readList(name, &list);
@@ -233,6 +269,23 @@ Error listInsertItem(bool prepend,
       return error;
    maxSize = listSize(name.c_str());
 
+   // fast path: appending a new value to a list with remaining capacity
+   // only requires appending a line to the backing file. this is the
+   // common case for the user dictionary, which can hold thousands of
+   // entries and was otherwise rewritten in full for every word added
+   if (!prepend &&
+       list.size() < maxSize &&
+       std::find(list.begin(), list.end(), value) == list.end())
+   {
+      list.push_back(value);
+      error = appendToFile(listPath(name), stringifyString(value) + "\n");
+      if (error)
+         return error;
+
+      s_listCache[name] = list;
+      return Success();
+   }
+
    // remove any existing item with this value
    list.remove(value);
 
@@ -0,0 +1,184 @@
+/*
+ * SessionMemoryTelemetry.cpp
+ *
+ * Copyright (C) 2009-12 by RStudio, Inc.
+ *
+ * Unless you have received this program directly from RStudio pursuant
+ * to the terms of a commercial license agreement with RStudio, then
+ * this program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http://www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ *
+ */
+
+#include "SessionMemoryTelemetry.hpp"
+
+#include <boost/format.hpp>
+
+#include <core/Error.hpp>
+#include <core/Log.hpp>
+#include <core/SafeConvert.hpp>
+
+#ifndef _WIN32
+#include <core/system/PosixSystem.hpp>
+#endif
+
+#include <r/RExec.hpp>
+
+#include <session/SessionModuleContext.hpp>
+
+using namespace rstudio::core;
+
+namespace rstudio {
+namespace session {
+namespace modules {
+namespace memory_telemetry {
+
+namespace {
+
+#ifndef _WIN32
+
+// sampling interval
+const int kSampleIntervalSeconds = 5;
+
+// warn the user when rss crosses this fraction of the memory limit
+const double kWarningThreshold = 0.80;
+
+// take action (gc, cache trimming) and warn severely at this fraction
+const double kCriticalThreshold = 0.90;
+
+// re-arm the warnings once usage falls back below this fraction
+const double kRearmThreshold = 0.70;
+
+// warning state (each threshold fires once per episode)
+bool s_warningIssued = false;
+bool s_criticalIssued = false;
+
+// peak rss observed (telemetry, logged at shutdown)
+long long s_peakRssKb = 0;
+
+std::string formatMb(long long kb)
+{
+   return safe_convert::numberToString(kb / 1024) + " MB";
+}
+
+void showMemoryWarningBar(bool severe, const std::string& message)
+{
+   json::Object msgJson;
+   msgJson["severe"] = severe;
+   msgJson["message"] = message;
+   ClientEvent event(client_events::kShowWarningBar, msgJson);
+   module_context::enqueClientEvent(event);
+}
+
+void respondToMemoryPressure(const core::system::MemoryUsage& usage)
+{
+   // give caches a chance to shed what they can
+   module_context::events().onMemoryPressure();
+
+   // run a full R gc and log what it bought us (this is also the only
+   // point where we touch R, and we only get here from idle-time
+   // periodic work)
+   Error error = r::exec::executeString("invisible(base::gc(FALSE))");
+   if (error)
+      LOG_ERROR(error);
+
+   core::system::MemoryUsage after;
+   error = core::system::processMemoryUsage(&after);
+   if (!error)
+   {
+      LOG_WARNING_MESSAGE(
+         "session memory pressure: rss " + formatMb(usage.rssKb) +
+         " of " + formatMb(usage.limitKb) + " limit; " +
+         formatMb(usage.rssKb - after.rssKb) + " reclaimed by gc");
+   }
+}
+
+bool performMemorySample()
+{
+   core::system::MemoryUsage usage;
+   Error error = core::system::processMemoryUsage(&usage);
+   if (error || usage.limitKb <= 0)
+   {
+      // no usable rss/limit facility -- stop sampling
+      return false;
+   }
+
+   if (usage.rssKb > s_peakRssKb)
+      s_peakRssKb = usage.rssKb;
+
+   double fraction = static_cast<double>(usage.rssKb) / usage.limitKb;
+
+   if (fraction >= kCriticalThreshold)
+   {
+      respondToMemoryPressure(usage);
+      if (!s_criticalIssued)
+      {
+         s_criticalIssued = true;
+         s_warningIssued = true;
+         boost::format fmt(
+            "This R session is using %1% of its %2% memory limit and is "
+            "at risk of being terminated by the operating system. Consider "
+            "removing large objects from the workspace (see ls() and rm()) "
+            "or saving your work and restarting R.");
+         showMemoryWarningBar(true, boost::str(fmt % formatMb(usage.rssKb)
+                                                   % formatMb(usage.limitKb)));
+      }
+   }
+   else if (fraction >= kWarningThreshold)
+   {
+      if (!s_warningIssued)
+      {
+         s_warningIssued = true;
+         boost::format fmt(
+            "This R session is using %1% of its %2% memory limit.");
+         showMemoryWarningBar(false, boost::str(fmt % formatMb(usage.rssKb)
+                                                    % formatMb(usage.limitKb)));
+      }
+   }
+   else if (fraction < kRearmThreshold)
+   {
+      // usage receded; warn again if it climbs back
+      s_warningIssued = false;
+      s_criticalIssued = false;
+   }
+
+   return true;
+}
+
+void onShutdown(bool)
+{
+   if (s_peakRssKb > 0)
+      LOG_INFO_MESSAGE("session peak rss: " + formatMb(s_peakRssKb));
+}
+
+#endif // !_WIN32
+
+} // anonymous namespace
+
+Error initialize()
+{
+#ifndef _WIN32
+   // verify the facility before scheduling the sampler (e.g. /proc may
+   // be unavailable on some platforms)
+   core::system::MemoryUsage usage;
+   Error error = core::system::processMemoryUsage(&usage);
+   if (!error && usage.limitKb > 0)
+   {
+      module_context::events().onShutdown.connect(onShutdown);
+      module_context::schedulePeriodicWork(
+               boost::posix_time::seconds(kSampleIntervalSeconds),
+               performMemorySample,
+               true);
+   }
+#endif
+
+   return Success();
+}
+
+} // namespace memory_telemetry
+} // namespace modules
+} // namespace session
+} // namespace rstudio
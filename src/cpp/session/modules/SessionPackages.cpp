@@ -331,6 +331,85 @@ private:
    std::map<std::string, std::vector<std::string> > cache_;
 };
 
+FilePath installedPackagesCachePath()
+{
+   return module_context::scopedScratchPath().childPath("installed-packages");
+}
+
+// refresh state for the installed package metadata cache
+bool s_cacheUpdateRunning = false;
+bool s_cacheUpdateRequested = false;
+bool s_cacheUpdateNotify = false;
+
+// refreshes the installed package metadata cache (see
+// .rs.updateInstalledPackagesCache) in a background R process so that
+// subsequent pane refreshes can be served from the cache rather than by
+// scanning the package libraries on the R thread (which can take several
+// seconds when large site libraries live on networked filesystems)
+class UpdateInstalledPackagesCache : public async_r::AsyncRProcess
+{
+public:
+   static void update(bool notifyWhenComplete)
+   {
+      s_cacheUpdateNotify = s_cacheUpdateNotify || notifyWhenComplete;
+
+      // only one refresh at a time -- if one is already running then have
+      // it make another pass when it completes (the library may have
+      // mutated again underneath it)
+      if (s_cacheUpdateRunning)
+      {
+         s_cacheUpdateRequested = true;
+         return;
+      }
+
+      // build the command
+      std::string cachePath = string_utils::utf8ToSystem(
+               installedPackagesCachePath().absolutePath());
+      boost::algorithm::replace_all(cachePath, "\\", "\\\\");
+      std::string cmd = ".rs.updateInstalledPackagesCache('" +
+                        cachePath + "')";
+
+      // the child needs the package listing helpers
+      std::vector<core::FilePath> sources;
+      sources.push_back(session::options().modulesRSourcePath()
+                           .complete("SessionPackages.R"));
+
+      // kickoff the process
+      s_cacheUpdateRunning = true;
+      s_cacheUpdateRequested = false;
+      boost::shared_ptr<UpdateInstalledPackagesCache> pUpdate(
+                                       new UpdateInstalledPackagesCache());
+      pUpdate->start(cmd.c_str(),
+                     FilePath(),
+                     async_r::R_PROCESS_VANILLA | async_r::R_PROCESS_AUGMENTED,
+                     sources);
+   }
+
+   virtual void onCompleted(int exitStatus)
+   {
+      s_cacheUpdateRunning = false;
+
+      // the library mutated while we were refreshing; go around again
+      if (s_cacheUpdateRequested)
+      {
+         update(false);
+         return;
+      }
+
+      // notify the client; its package state request is then served from
+      // the fresh cache (and on cache failure falls back to a scan)
+      bool notify = s_cacheUpdateNotify;
+      s_cacheUpdateNotify = false;
+      if (notify)
+         enquePackageStateChanged();
+   }
+
+private:
+   UpdateInstalledPackagesCache()
+   {
+   }
+};
+
 void downloadAvailablePackages(const std::string& contribUrl,
                                std::vector<std::string>* pAvailablePackages)
 {
@@ -458,8 +537,11 @@ void rs_packageLibraryMutated()
    // broadcast event to server
    module_context::events().onPackageLibraryMutated();
 
-   // broadcast event to client
-   enquePackageStateChanged();
+   // refresh the installed package cache in the background and notify the
+   // client when it completes (the client's subsequent package state
+   // request is then served from the cache rather than blocking the
+   // console on a library scan)
+   UpdateInstalledPackagesCache::update(true);
 }
 
 void detectLibPathsChanges()
@@ -520,6 +602,10 @@ void onDeferredInit(bool newSession)
 
    // ensure we have a secure connection to CRAN
    module_context::reconcileSecureDownloadConfiguration();
+
+   // warm the installed package cache so the first Packages pane refresh
+   // is served from it
+   UpdateInstalledPackagesCache::update(false);
 }
 
 Error getPackageState(const json::JsonRpcRequest& request,
@@ -591,6 +677,11 @@ Error initialize()
             (DL_FUNC) rs_downloadAvailablePackages,
             1);
    
+   // tell R where the installed package cache lives
+   std::string cachePath = string_utils::utf8ToSystem(
+            installedPackagesCachePath().absolutePath());
+   boost::algorithm::replace_all(cachePath, "\\", "\\\\");
+
    using boost::bind;
    using namespace module_context;
    ExecBlock initBlock ;
@@ -598,7 +689,8 @@ Error initialize()
       (bind(sourceModuleRFile, "SessionPackages.R"))
       (bind(registerRpcMethod, "available_packages", availablePackages))
       (bind(registerRpcMethod, "get_package_state", getPackageState))
-      (bind(r::exec::executeString, ".rs.packages.initialize()"));
+      (bind(r::exec::executeString,
+            ".rs.packages.initialize('" + cachePath + "')"));
    return initBlock.execute();
 }
 
@@ -153,6 +153,7 @@ std::string packratActionName(PackratActionType action)
 static PackratActionType s_runningPackratAction = PACKRAT_ACTION_NONE;
 static bool s_autoSnapshotPending = false;
 static bool s_autoSnapshotRunning = false;
+static bool s_libraryCheckScheduled = false;
 
 // Forward declarations ------------------------------------------------------
 
@@ -217,18 +218,46 @@ std::string updateHash(PackratHashType hashType, PackratHashState hashState,
    return newHash;
 }
 
-// adds content from the given file to the given file if it's a 
+// cache of DESCRIPTION file content, keyed by path and validated by size
+// and write time. the library hash concatenates the content of every
+// DESCRIPTION in the private library; with hundreds of packages re-reading
+// them all on each hash check dominates the cost, while typically only a
+// handful changed. entries for removed packages linger but are tiny and
+// simply go unused
+struct DescContentCacheEntry
+{
+   DescContentCacheEntry() : lastWriteTime(0), size(0) {}
+   std::time_t lastWriteTime;
+   uintmax_t size;
+   std::string content;
+};
+std::map<std::string, DescContentCacheEntry> s_descContentCache;
+
+// adds content from the given file to the given file if it's a
 // DESCRIPTION file (used to summarize library content for hashing)
 bool addDescContent(int level, const FilePath& path, std::string* pDescContent)
 {
-   std::string newDescContent;
-   if (path.filename() == "DESCRIPTION") 
+   if (path.filename() == "DESCRIPTION")
    {
-      Error error = readStringFromFile(path, &newDescContent);
+      std::time_t lastWriteTime = path.lastWriteTime();
+      uintmax_t size = path.size();
+      DescContentCacheEntry& entry = s_descContentCache[path.absolutePath()];
+      if (entry.content.empty() ||
+          entry.lastWriteTime != lastWriteTime ||
+          entry.size != size)
+      {
+         entry.content.clear();
+         Error error = readStringFromFile(path, &entry.content);
+         if (error)
+            entry.content.clear();
+         entry.lastWriteTime = lastWriteTime;
+         entry.size = size;
+      }
+
       // include the path of the file; on Windows the DESCRIPTION file moves
       // inside the library post-installation
       pDescContent->append(path.absolutePath());
-      pDescContent->append(newDescContent);
+      pDescContent->append(entry.content);
    }
    return true;
 }
@@ -565,15 +594,27 @@ void onLibraryUpdate(const std::string& oldHash, const std::string& newHash)
       packages::enquePackageStateChanged();
 }
 
+// performs the library hash check scheduled by onFileChanged
+void performScheduledLibraryCheck()
+{
+   s_libraryCheckScheduled = false;
+
+   // the packrat action state may have changed since the check was scheduled
+   if (s_runningPackratAction != PACKRAT_ACTION_NONE)
+      return;
+
+   checkHashes(HASH_TYPE_LIBRARY, HASH_STATE_OBSERVED, onLibraryUpdate);
+}
+
 void onFileChanged(FilePath sourceFilePath)
 {
    // ignore file changes while Packrat is running
    if (s_runningPackratAction != PACKRAT_ACTION_NONE)
       return;
-   
+
    // we only care about mutations to files in the Packrat library directory
    // (and packrat.lock)
-   FilePath libraryPath = 
+   FilePath libraryPath =
       projects::projectContext().directory().complete(kPackratLibPath);
 
    if (sourceFilePath.filename() == kPackratLockfile)
@@ -581,21 +622,37 @@ void onFileChanged(FilePath sourceFilePath)
       PACKRAT_TRACE("detected change to lockfile " << sourceFilePath);
       checkHashes(HASH_TYPE_LOCKFILE, HASH_STATE_OBSERVED, onLockfileUpdate);
    }
-   else if (sourceFilePath.isWithin(libraryPath) && 
-            (sourceFilePath.isDirectory() || 
+   else if (sourceFilePath.isWithin(libraryPath) &&
+            (sourceFilePath.isDirectory() ||
              sourceFilePath.filename() == "DESCRIPTION"))
    {
-      // ignore changes in the RStudio-managed manipulate and rstudio 
+      // ignore changes in the RStudio-managed manipulate and rstudio
       // directories and the files within them
       if (sourceFilePath.filename() == "manipulate" ||
           sourceFilePath.filename() == "rstudio" ||
-          sourceFilePath.parent().filename() == "manipulate" || 
+          sourceFilePath.parent().filename() == "manipulate" ||
           sourceFilePath.parent().filename() == "rstudio")
       {
          return;
       }
+
+      // drop the cached content for a changed DESCRIPTION (belt and braces
+      // against write-time granularity hiding an in-place rewrite)
+      if (sourceFilePath.filename() == "DESCRIPTION")
+         s_descContentCache.erase(sourceFilePath.absolutePath());
+
+      // coalesce the bursts of events generated by package installs (a
+      // package plus its dependencies can produce hundreds) into a single
+      // hash check performed when the session is next idle
       PACKRAT_TRACE("detected change to library file " << sourceFilePath);
-      checkHashes(HASH_TYPE_LIBRARY, HASH_STATE_OBSERVED, onLibraryUpdate);
+      if (!s_libraryCheckScheduled)
+      {
+         s_libraryCheckScheduled = true;
+         module_context::scheduleDelayedWork(
+                  boost::posix_time::milliseconds(500),
+                  performScheduledLibraryCheck,
+                  true);
+      }
    }
 }
 
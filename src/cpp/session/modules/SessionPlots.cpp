@@ -456,13 +456,13 @@ void setImageFileResponse(const FilePath& imageFilePath,
 {
    // set content type
    pResponse->setContentType(imageFilePath.mimeContentType());
-   
-   // attempt gzip
-   if (request.acceptsEncoding(http::kGzipEncoding))
-      pResponse->setContentEncoding(http::kGzipEncoding);
-   
-   // set file
-   Error error = pResponse->setBody(imageFilePath);
+
+   // NOTE: we deliberately don't gzip encode here -- png is already
+   // compressed so a second pass just burns cpu on every plot served
+   // (on desktop this adds directly to plot display latency)
+
+   // set file (use a large buffer to minimize read round trips)
+   Error error = pResponse->setBody(imageFilePath, std::streamsize(8192));
    if (error)
    {
       if (!core::isPathNotFoundError(error))
@@ -721,16 +721,26 @@ void onClientInit()
    renderGraphicsOutput(false, false);
 }
 
+// duration of the most recent render (used to adaptively drop frames when
+// plots are produced faster than they can be rasterized and encoded)
+long s_lastRenderDurationMs = 0;
+
 void detectChanges(bool activatePlots)
 {
    // check for changes
    using namespace rstudio::r::session;
    if (graphics::display().hasChanges())
    {
+      using namespace boost::posix_time;
+      ptime renderStart = microsec_clock::universal_time();
+
       graphics::display().render(boost::bind(enquePlotsChanged,
                                              _1,
                                              activatePlots,
                                              false));
+
+      s_lastRenderDurationMs = (microsec_clock::universal_time() -
+                                renderStart).total_milliseconds();
    }
 }
 
@@ -750,10 +760,16 @@ void onBackgroundProcessing(bool isIdle)
       // plot animations (typically implemented using Sys.sleep). however,
       // we don't want this to spill over inot incrementally rendering all
       // plots as this will slow down overall plotting performance
-      // considerably.
+      // considerably. additionally, scale the window with the duration of
+      // the previous render so that when plots are generated faster than
+      // they can be rasterized and encoded we drop intermediate frames
+      // rather than falling progressively further behind the console (the
+      // final frame is always rendered when the loop returns to the REPL)
       using namespace boost::posix_time;
       const int kChangeWindowMs = 50;
-      if ((graphics::display().lastChange() + milliseconds(kChangeWindowMs)) <
+      long changeWindowMs = std::max<long>(kChangeWindowMs,
+                                           2 * s_lastRenderDurationMs);
+      if ((graphics::display().lastChange() + milliseconds(changeWindowMs)) <
            boost::posix_time::microsec_clock::universal_time())
       {
          detectChanges(isIdle); // activate plots only when idle
@@ -87,11 +87,16 @@ void onDocPendingRemove(
 }
 
 Error initialize()
-{  
+{
    ExecBlock initBlock ;
-   
+
    source_database::events().onDocPendingRemove.connect(onDocPendingRemove);
 
+   // profiles accumulate without limit -- evict the oldest ones once
+   // the cache exceeds its budget
+   module_context::scheduleCacheTrim(FilePath(profilesCacheDir()),
+                                     100 * 1024 * 1024);
+
    initBlock.addFunctions()
       (boost::bind(module_context::sourceModuleRFile, "SessionProfiler.R"))
       (boost::bind(module_context::registerUriHandler, "/" kProfilesUrlPath "/", handleProfilerResReq));
@@ -31,6 +31,7 @@
 #include <iomanip>
 
 #include <core/Algorithm.hpp>
+#include <core/r_util/RStringTable.hpp>
 #include <core/r_util/RTokenizer.hpp>
 #include <core/r_util/RTokenCursor.hpp>
 #include <core/collection/Position.hpp>
@@ -522,7 +523,12 @@ public:
    
    typedef std::vector< boost::shared_ptr<ParseNode> > Children;
    typedef std::vector<Position> Positions;
-   typedef std::map<std::string, Positions> SymbolPositions;
+
+   // symbol names are interned in a string table shared by all nodes
+   // in a parse tree (see stringTable()), so the symbol maps key on
+   // 32-bit handles rather than full strings
+   typedef core::r_util::RStringTable::Handle SymbolHandle;
+   typedef std::map<SymbolHandle, Positions> SymbolPositions;
    
    typedef std::string PackageName;
    typedef std::set<std::string> Symbols;
@@ -560,7 +566,35 @@ public:
    {
       return pParent_ == NULL;
    }
-   
+
+   // the interning table for symbol names, owned by the root node and
+   // shared by the whole tree. note that this implies symbols should
+   // only be added to a node after it has been attached to its tree
+   // (handles from different tables are not comparable) -- this is
+   // already the case as nodes are attached empty by the parser
+   core::r_util::RStringTable& stringTable() const
+   {
+      ParseNode* pRoot = getRoot();
+      if (!pRoot->pStringTable_)
+         pRoot->pStringTable_.reset(new core::r_util::RStringTable());
+      return *pRoot->pStringTable_;
+   }
+
+   SymbolHandle internSymbol(const std::string& name) const
+   {
+      return stringTable().intern(name);
+   }
+
+   bool lookupSymbol(const std::string& name, SymbolHandle* pHandle) const
+   {
+      return stringTable().lookup(name, pHandle);
+   }
+
+   const std::string& symbolName(SymbolHandle handle) const
+   {
+      return stringTable().get(handle);
+   }
+
    const SymbolPositions& getDefinedSymbols() const
    {
       return definedSymbols_;
@@ -576,38 +610,38 @@ public:
                          const std::string& name)
    {
       DEBUG("--- Adding defined variable '" << name << "' (" << row << ", " << column << ")");
-      definedSymbols_[name].push_back(Position(row, column));
+      definedSymbols_[internSymbol(name)].push_back(Position(row, column));
    }
 
    void addDefinedSymbol(const RToken& rToken)
    {
       DEBUG("--- Adding defined variable '" << rToken.contentAsUtf8() << "'");
-      definedSymbols_[rToken.contentAsUtf8()].push_back(
+      definedSymbols_[internSymbol(rToken.contentAsUtf8())].push_back(
             Position(rToken.row(), rToken.column()));
    }
-   
+
    void addDefinedSymbol(const RToken& rToken,
                          const Position& position)
    {
-      definedSymbols_[rToken.contentAsUtf8()].push_back(position);
+      definedSymbols_[internSymbol(rToken.contentAsUtf8())].push_back(position);
    }
-   
+
    void addReferencedSymbol(int row,
                             int column,
                             const std::string& name)
    {
-      referencedSymbols_[name].push_back(Position(row, column));
+      referencedSymbols_[internSymbol(name)].push_back(Position(row, column));
    }
 
    void addReferencedSymbol(const RToken& rToken)
    {
-      referencedSymbols_[rToken.contentAsUtf8()].push_back(
+      referencedSymbols_[internSymbol(rToken.contentAsUtf8())].push_back(
             Position(rToken.row(), rToken.column()));
    }
-   
+
    void addNseReferencedSymbol(const RToken& rToken)
    {
-      nseReferencedSymbols_[rToken.contentAsUtf8()].push_back(
+      nseReferencedSymbols_[internSymbol(rToken.contentAsUtf8())].push_back(
                Position(rToken.row(), rToken.column()));
    }
    
@@ -733,20 +767,20 @@ public:
 private:
    
    static bool findVariableImpl(const ParseNode* pNode,
-                                const std::string& name,
+                                SymbolHandle handle,
                                 const Position& position,
                                 bool checkPosition,
                                 Position* pFoundPosition)
    {
       if (!pNode) return false;
-      
+
       // First, perform a position-wide search in the current node.
       Positions* pPositions = NULL;
-      core::algorithm::get(pNode->getDefinedSymbols(), name, &pPositions);
-      
+      core::algorithm::get(pNode->getDefinedSymbols(), handle, &pPositions);
+
       if (!pPositions)
          return findVariableImpl(pNode->getParent(),
-                                 name,
+                                 handle,
                                  position,
                                  false,
                                  pFoundPosition);
@@ -772,32 +806,38 @@ private:
       
       return findVariableImpl(
                pNode->getParent(),
-               name,
+               handle,
                position,
                false,
                pFoundPosition);
    }
-   
+
 public:
-   
+
    bool findVariable(const std::string& name,
                      const Position& position,
                      Position* pFoundPosition = NULL) const
    {
+      // a name missing from the string table was never defined
+      // anywhere in this tree
+      SymbolHandle handle;
+      if (!lookupSymbol(name, &handle))
+         return false;
+
       return findVariableImpl(this,
-                              name,
+                              handle,
                               position,
                               true,
                               pFoundPosition);
    }
-   
-   bool symbolHasDefinitionInTree(const std::string& symbol,
+
+   bool symbolHasDefinitionInTree(SymbolHandle handle,
                                   const Position& position) const
    {
-      if (definedSymbols_.count(symbol) != 0)
+      if (definedSymbols_.count(handle) != 0)
       {
-         DEBUG("- Checking for symbol '" << symbol << "' in node");
-         Positions& positions = const_cast<ParseNode*>(this)->definedSymbols_[symbol];
+         DEBUG("- Checking for symbol '" << symbolName(handle) << "' in node");
+         Positions& positions = const_cast<ParseNode*>(this)->definedSymbols_[handle];
          for (Positions::reverse_iterator it = positions.rbegin();
               it != positions.rend();
               ++it)
@@ -808,12 +848,22 @@ public:
                return true;
          }
       }
-      
+
       if (pParent_)
-         return pParent_->symbolHasDefinitionInTree(symbol, position);
-      
+         return pParent_->symbolHasDefinitionInTree(handle, position);
+
       return false;
    }
+
+   bool symbolHasDefinitionInTree(const std::string& symbol,
+                                  const Position& position) const
+   {
+      SymbolHandle handle;
+      if (!lookupSymbol(symbol, &handle))
+         return false;
+
+      return symbolHasDefinitionInTree(handle, position);
+   }
    
    bool symbolHasDefinitionInRange(const std::string& symbol,
                                    const Position& position) const
@@ -839,11 +889,11 @@ public:
            it != referencedSymbols_.end();
            ++it)
       {
-         const std::string& symbol = it->first;
+         const std::string& symbol = symbolName(it->first);
          BOOST_FOREACH(const Position& position, it->second)
          {
             DEBUG("-- Checking for symbol '" << symbol << "' " << position.toString());
-            if (!symbolHasDefinitionInTree(symbol, position) &&
+            if (!symbolHasDefinitionInTree(it->first, position) &&
                 !symbolHasDefinitionInRange(symbol, position))
             {
                DEBUG("--- No definition for symbol '" << symbol << "'");
@@ -860,59 +910,59 @@ public:
       return unresolvedSymbols;
    }
    
-   bool isSymbolUsedInChildNode(const std::string& symbolName)
+   bool isSymbolUsedInChildNode(SymbolHandle handle)
    {
       BOOST_FOREACH(const boost::shared_ptr<ParseNode>& pChild, children_)
       {
-         if (pChild->getReferencedSymbols().count(symbolName))
+         if (pChild->getReferencedSymbols().count(handle))
             return true;
-         
-         if (pChild->isSymbolUsedInChildNode(symbolName))
+
+         if (pChild->isSymbolUsedInChildNode(handle))
             return true;
       }
       return false;
    }
-   
-   bool isSymbolDefinedButNotUsed(const std::string& symbolName,
+
+   bool isSymbolDefinedButNotUsed(SymbolHandle handle,
                                   bool checkChildNodes,
                                   bool checkNseCalls)
    {
-      if (!definedSymbols_.count(symbolName))
+      if (!definedSymbols_.count(handle))
          return false;
-      
-      if (checkChildNodes && isSymbolUsedInChildNode(symbolName))
+
+      if (checkChildNodes && isSymbolUsedInChildNode(handle))
          return false;
-      
+
       std::size_t definitionCount =
-            definedSymbols_[symbolName].size();
-      
+            definedSymbols_[handle].size();
+
       std::size_t useCount = 0;
-      useCount += referencedSymbols_[symbolName].size();
+      useCount += referencedSymbols_[handle].size();
       if (checkNseCalls)
-         useCount += nseReferencedSymbols_[symbolName].size();
-      
-      // NOTE: We record a definition at the same position of 
+         useCount += nseReferencedSymbols_[handle].size();
+
+      // NOTE: We record a definition at the same position of
       // each reference as well, so a symbol is effectively defined
       // but not used if there is only one defintion, and one reference,
       // and they both map to the same position.
       if (definitionCount == 1 &&
           useCount == 1)
       {
-         Position defnPos = definedSymbols_[symbolName][0];
+         Position defnPos = definedSymbols_[handle][0];
          Position usePos;
-         
-         if (referencedSymbols_[symbolName].size())
-            usePos = referencedSymbols_[symbolName][0];
-         else if (nseReferencedSymbols_[symbolName].size())
-            usePos = nseReferencedSymbols_[symbolName][0];
-         
+
+         if (referencedSymbols_[handle].size())
+            usePos = referencedSymbols_[handle][0];
+         else if (nseReferencedSymbols_[handle].size())
+            usePos = nseReferencedSymbols_[handle][0];
+
          return defnPos == usePos;
       }
-      
+
       return false;
-      
+
    }
-   
+
    std::string suggestSimilarSymbolFor(const ParseItem& item) const
    {
       std::string nameLower = boost::algorithm::to_lower_copy(item.symbol);
@@ -920,14 +970,15 @@ public:
            it != definedSymbols_.end();
            ++it)
       {
-         DEBUG("-- '" << it->first << "'");
-         if (nameLower == boost::algorithm::to_lower_copy(it->first))
+         const std::string& name = symbolName(it->first);
+         DEBUG("-- '" << name << "'");
+         if (nameLower == boost::algorithm::to_lower_copy(name))
          {
             BOOST_FOREACH(const Position& position, it->second)
             {
                if (position < item.position)
                {
-                  return it->first;
+                  return name;
                }
             }
          }
@@ -966,7 +1017,11 @@ private:
    // member variables
    std::string name_; // name of scope (usually function name)
    Position position_; // location of opening '{' for scope
-   
+
+   // interning table for symbol names; allocated lazily on the root
+   // node and shared by every node in the tree (see stringTable())
+   boost::shared_ptr<core::r_util::RStringTable> pStringTable_;
+
    // variables defined in this scope, e.g. with 'x <- ...'.
    // map variable names to locations (row, column)
    SymbolPositions definedSymbols_;
@@ -21,6 +21,8 @@
 #include <shlwapi.h>
 #endif
 
+#include <algorithm>
+
 #include <boost/algorithm/string.hpp>
 #include <boost/bind.hpp>
 #include <boost/date_time.hpp>
@@ -79,6 +81,100 @@ bool s_isSvnSshRepository = false;
 /** GLOBAL STATE **/
 FilePath s_workingDir;
 
+// incremental status cache for the working directory, fed by project
+// file monitor change events (mirrors the treatment in SessionGit.cpp).
+// a status refresh re-checks only the touched paths with a single
+// path-scoped 'svn status' call rather than rescanning (and re-parsing
+// xml for) the entire working copy
+
+// upper bound on the number of touched paths passed to a single batched
+// 'svn status' call -- above this a full rescan is cheaper
+const size_t kMaxIncrementalStatusPaths = 100;
+
+// expire the cached status after this long -- changes made from outside
+// the session (e.g. svn commands in a terminal) which don't touch files
+// aren't visible to the monitor, so don't serve a cached result forever
+const int kStatusCacheExpirySeconds = 60;
+
+bool s_statusCacheEnabled = false;
+bool s_statusCacheValid = false;
+std::map<std::string, source_control::VCSStatus> s_statusCache;
+std::vector<FilePath> s_statusCachePending;
+boost::posix_time::ptime s_statusCacheTime;
+
+void invalidateStatusCache()
+{
+   s_statusCacheValid = false;
+   s_statusCache.clear();
+   s_statusCachePending.clear();
+}
+
+// commands which only inspect the working copy -- everything else is
+// presumed to potentially change file status (see runSvn)
+bool isReadOnlySvnCommand(const std::string& command)
+{
+   return command == "status" ||
+          command == "info" ||
+          command == "log" ||
+          command == "diff" ||
+          command == "cat" ||
+          command == "list" ||
+          command == "blame" ||
+          command == "propget" ||
+          command == "proplist";
+}
+
+void markStatusCachePending(const FilePath& filePath)
+{
+   if (!s_statusCacheValid)
+      return;
+
+   // ignore svn administrative directory churn
+   if (filePath.absolutePath().find("/.svn") != std::string::npos)
+      return;
+
+   // cap growth -- once over the incremental threshold the next status
+   // request performs a full rescan anyway
+   if (s_statusCachePending.size() > kMaxIncrementalStatusPaths)
+      return;
+
+   if (std::find(s_statusCachePending.begin(),
+                 s_statusCachePending.end(),
+                 filePath) == s_statusCachePending.end())
+   {
+      s_statusCachePending.push_back(filePath);
+   }
+}
+
+// hooks for the project file monitor -- these feed the incremental
+// status cache
+
+void onFileMonitoringEnabled(const tree<core::FileInfo>&)
+{
+   // only enable the cache if the monitored directory (the project
+   // directory) covers the entire working copy -- otherwise changes
+   // outside the monitored scope would go unobserved
+   if (!s_workingDir.empty() &&
+       projects::projectContext().directory() == s_workingDir)
+   {
+      s_statusCacheEnabled = true;
+   }
+}
+
+void onFilesChanged(const std::vector<core::system::FileChangeEvent>& events)
+{
+   BOOST_FOREACH(const core::system::FileChangeEvent& event, events)
+   {
+      markStatusCachePending(FilePath(event.fileInfo().absolutePath()));
+   }
+}
+
+void onFileMonitoringDisabled()
+{
+   s_statusCacheEnabled = false;
+   invalidateStatusCache();
+}
+
 FilePath resolveAliasedPath(const std::string& path)
 {
    if (boost::algorithm::starts_with(path, "~/"))
@@ -191,6 +287,12 @@ Error runSvn(const ShellArgs& args,
              bool redirectStdErrToStdOut,
              core::system::ProcessResult* pResult)
 {
+   // conservatively invalidate the cached status for any command which
+   // can mutate the working copy (invalidate up front since even failed
+   // commands can have partial effects)
+   if (!args.args().empty() && !isReadOnlySvnCommand(args.args().front()))
+      invalidateStatusCache();
+
    core::system::ProcessOptions options = procOptions();
    if (!workingDir.empty())
       options.workingDir = workingDir;
@@ -276,6 +378,9 @@ core::Error createConsoleProc(const ShellArgs& args,
                                   InteractionPossible,
                                   kDefaultMaxOutputLines);
 
+   // console procs (update, commit, etc.) mutate the working copy so
+   // drop the cached status when they complete
+   (*ppCP)->onExit().connect(boost::bind(&invalidateStatusCache));
    if (enqueueRefreshOnExit)
       (*ppCP)->onExit().connect(boost::bind(&enqueueRefreshEvent));
 
@@ -851,15 +956,14 @@ Error statusToJson(const core::FilePath &path,
    return Success();
 }
 
-Error status(const FilePath& filePath,
-             std::vector<source_control::FileWithStatus>* pFiles)
+Error runStatus(const ShellArgs& pathArgs,
+                std::vector<source_control::FileWithStatus>* pFiles)
 {
    using namespace source_control;
 
    ShellArgs args;
    args << "status" << globalArgs() << "--xml" << "--ignore-externals";
-   if (!filePath.empty())
-      args << "--" << filePath;
+   args << pathArgs.args();
 
    std::string stdOut, stdErr;
    int exitCode;
@@ -954,6 +1058,96 @@ Error status(const FilePath& filePath,
    return Success();
 }
 
+// status for the working directory root -- served from the incrementally
+// maintained cache when the file monitor is active so a refresh doesn't
+// require rescanning (and re-parsing xml for) the whole working copy
+Error statusForWorkingDir(std::vector<source_control::FileWithStatus>* pFiles)
+{
+   using namespace source_control;
+   using namespace boost::posix_time;
+
+   // determine whether the cache can be used -- it must be fed by an
+   // active file monitor, not expired, and have few enough touched paths
+   // for a batched re-check to be worthwhile
+   bool cacheUsable =
+         s_statusCacheEnabled &&
+         s_statusCacheValid &&
+         (microsec_clock::universal_time() - s_statusCacheTime) <
+                           seconds(kStatusCacheExpirySeconds) &&
+         s_statusCachePending.size() <= kMaxIncrementalStatusPaths;
+
+   if (!cacheUsable)
+   {
+      // full rescan
+      std::vector<FileWithStatus> files;
+      Error error = runStatus(ShellArgs(), &files);
+      if (error)
+         return error;
+
+      s_statusCache.clear();
+      BOOST_FOREACH(const FileWithStatus& file, files)
+      {
+         s_statusCache[file.path.absolutePath()] = file.status;
+      }
+      s_statusCachePending.clear();
+      s_statusCacheValid = true;
+      s_statusCacheTime = microsec_clock::universal_time();
+
+      *pFiles = files;
+      return Success();
+   }
+
+   // re-check just the touched paths with a single batched call
+   if (!s_statusCachePending.empty())
+   {
+      ShellArgs pathArgs;
+      pathArgs << "--" << s_statusCachePending;
+
+      std::vector<FileWithStatus> files;
+      Error error = runStatus(pathArgs, &files);
+      if (error)
+         return error;
+
+      // drop cached entries for the re-checked paths then merge in
+      // whatever svn reported for them (a path svn didn't report on
+      // is now clean)
+      BOOST_FOREACH(const FilePath& path, s_statusCachePending)
+      {
+         s_statusCache.erase(path.absolutePath());
+      }
+      BOOST_FOREACH(const FileWithStatus& file, files)
+      {
+         s_statusCache[file.path.absolutePath()] = file.status;
+      }
+      s_statusCachePending.clear();
+   }
+
+   // build the result from the cache
+   for (std::map<std::string, source_control::VCSStatus>::const_iterator
+            it = s_statusCache.begin(); it != s_statusCache.end(); ++it)
+   {
+      FileWithStatus file;
+      file.status = it->second;
+      file.path = FilePath(it->first);
+      pFiles->push_back(file);
+   }
+
+   return Success();
+}
+
+Error status(const FilePath& filePath,
+             std::vector<source_control::FileWithStatus>* pFiles)
+{
+   // an empty path means status for the entire working directory, which
+   // can be served incrementally
+   if (filePath.empty())
+      return statusForWorkingDir(pFiles);
+
+   ShellArgs pathArgs;
+   pathArgs << "--" << filePath;
+   return runStatus(pathArgs, pFiles);
+}
+
 Error status(const FilePath& filePath,
              json::Array* pResults)
 {
@@ -1871,6 +2065,18 @@ Error initialize()
                          boost::regex("^(.+): $"),
                          boost::bind(promptForPassword, _1, _2, _3, _4)));
 
+   // subscribe to the project file monitor so the status cache can be
+   // maintained incrementally (re-checking only touched paths) rather
+   // than rescanning the whole working copy on every refresh
+   if (projects::projectContext().hasProject())
+   {
+      projects::FileMonitorCallbacks cb;
+      cb.onMonitoringEnabled = onFileMonitoringEnabled;
+      cb.onFilesChanged = onFilesChanged;
+      cb.onMonitoringDisabled = onFileMonitoringDisabled;
+      projects::projectContext().subscribeToFileMonitor("SVN status", cb);
+   }
+
    // install rpc methods
    using boost::bind;
    using namespace module_context;
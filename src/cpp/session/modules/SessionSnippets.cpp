@@ -20,6 +20,8 @@
 #include <core/FileSerializer.hpp>
 #include <core/json/Json.hpp>
 
+#include <map>
+
 #include <boost/bind.hpp>
 #include <boost/foreach.hpp>
 
@@ -36,6 +38,26 @@ namespace {
 
 FilePath s_snippetsMonitoredDir;
 
+// cache of snippet file contents -- snippets are assembled and sent to
+// the client wholesale whenever anything in the snippets directory
+// changes, so remember each file's contents and only re-read files
+// whose timestamp or size has changed (large snippet collections make
+// the wholesale read noticeable)
+struct SnippetFileCacheEntry
+{
+   SnippetFileCacheEntry() : lastWriteTime(0), size(0) {}
+   std::time_t lastWriteTime;
+   uintmax_t size;
+   std::string contents;
+};
+std::map<std::string, SnippetFileCacheEntry> s_snippetFileCache;
+
+// the last snippets payload sent to the client -- the directory monitor
+// can fire for changes which don't affect snippet contents (and the
+// client re-parses the entire collection on every notification) so we
+// suppress notifications that would re-send an identical payload
+json::Array s_lastSnippetsJson;
+
 void notifySnippetsChanged()
 {
    Error error = core::writeStringToFile(
@@ -119,23 +141,40 @@ Error getSnippetsAsJson(json::Array* pJsonData)
    if (error)
       return error;
    
+   std::map<std::string, SnippetFileCacheEntry> cache;
    BOOST_FOREACH(const FilePath& filePath, snippetPaths)
    {
       // bail if this doesn't appear to be a snippets file
       std::string mode;
       if (!isSnippetFilePath(filePath, &mode))
          continue;
-      
-      std::string contents;
-      error = readStringFromFile(filePath, &contents);
-      if (error)
-         return error;
-      
+
+      // serve from the cache when the file is unchanged, otherwise
+      // (re-)read it
+      std::time_t lastWriteTime = filePath.lastWriteTime();
+      uintmax_t size = filePath.size();
+      SnippetFileCacheEntry entry = s_snippetFileCache[filePath.absolutePath()];
+      if (entry.lastWriteTime != lastWriteTime || entry.size != size)
+      {
+         entry.contents.clear();
+         error = readStringFromFile(filePath, &entry.contents);
+         if (error)
+            return error;
+         entry.lastWriteTime = lastWriteTime;
+         entry.size = size;
+      }
+      cache[filePath.absolutePath()] = entry;
+
       json::Object snippetJson;
       snippetJson["mode"] = mode;
-      snippetJson["contents"] = contents;
+      snippetJson["contents"] = entry.contents;
       pJsonData->push_back(snippetJson);
    }
+
+   // replace the cache wholesale so entries for deleted files don't
+   // accumulate
+   s_snippetFileCache = cache;
+
    return Success();
 }
 
@@ -151,9 +190,11 @@ void checkAndNotifyClientIfSnippetsAvailable()
       return;
    }
    
-   // if we got some, send them to the client
-   if (!jsonData.empty())
+   // if we got some, send them to the client (unless they're identical
+   // to what the client already has)
+   if (!jsonData.empty() && jsonData != s_lastSnippetsJson)
    {
+      s_lastSnippetsJson = jsonData;
       ClientEvent event(client_events::kSnippetsChanged, jsonData);
       module_context::enqueClientEvent(event);
    }
@@ -243,9 +243,33 @@ Error openDocument(const json::JsonRpcRequest& request,
    pResponse->setResult(jsonDoc);
 
    return Success();
-} 
+}
 
-Error saveDocumentCore(const std::string& contents,
+bool buildExternalEditPrefetch(const json::JsonRpcRequest& request,
+                               const json::Object& responseJson,
+                               json::JsonRpcRequest* pPrefetchRequest)
+{
+   // after opening a document the client promptly checks it for external
+   // edits; that follow-on rpc is fully determined by the id of the
+   // newly opened document so its response can be computed speculatively
+   json::Object::const_iterator it = responseJson.find(json::kRpcResult);
+   if (it == responseJson.end() || !json::isType<json::Object>(it->second))
+      return false;
+
+   const json::Object& docJson = it->second.get_obj();
+   json::Object::const_iterator idIt = docJson.find("id");
+   if (idIt == docJson.end() || !json::isType<std::string>(idIt->second))
+      return false;
+
+   pPrefetchRequest->method = "check_for_external_edit";
+   pPrefetchRequest->params.push_back(idIt->second);
+   return true;
+}
+
+// NOTE: takes ownership of *pContents (they are swapped into the
+// document rather than copied -- this avoids extra O(size) passes for
+// very large documents)
+Error saveDocumentCore(std::string* pContents,
                        const json::Value& jsonPath,
                        const json::Value& jsonType,
                        const json::Value& jsonEncoding,
@@ -264,6 +288,9 @@ Error saveDocumentCore(const std::string& contents,
       fullDocPath = module_context::resolveAliasedPath(path);
    }
 
+   // alias the contents (they are swapped into the document at the end)
+   const std::string& contents = *pContents;
+
    // update dirty state: dirty if there was no path AND the new contents
    // are different from the old contents (and was thus a content autosave
    // as distinct from a fold-spec or scroll-position/selection autosave)
@@ -337,10 +364,10 @@ Error saveDocumentCore(const std::string& contents,
       if (error)
          return error ;
 
-      // set the new path and contents for the document
-      error = pDoc->setPathAndContents(path);
-      if (error)
-         return error ;
+      // set the new path for the document. there is no need to re-read
+      // and re-decode the file we just finished writing -- the document
+      // receives the original UTF-8 contents below
+      pDoc->setPath(path);
 
       // enque file changed event if we need to
       if (!module_context::isDirectoryMonitored(fullDocPath.parent()))
@@ -366,7 +393,7 @@ Error saveDocumentCore(const std::string& contents,
    }
 
    // always update the contents so it holds the original UTF-8 data
-   pDoc->setContents(contents);
+   pDoc->setContents(pContents);
 
    return Success();
 }
@@ -395,11 +422,11 @@ Error saveDocument(const json::JsonRpcRequest& request,
    if (error)
       return error ;
    
-   error = saveDocumentCore(contents, jsonPath, jsonType, jsonEncoding,
+   error = saveDocumentCore(&contents, jsonPath, jsonType, jsonEncoding,
                             jsonFoldSpec, jsonChunkOutput, pDoc);
    if (error)
       return error;
-   
+
    // write to the source_database
    error = sourceDatabasePutWithUpdatedContents(pDoc);
    if (error)
@@ -473,10 +500,12 @@ Error saveDocumentDiff(const json::JsonRpcRequest& request,
       if (error)
          return Success(); // UTF8 decoding failed. Abort differential save.
 
-      contents.erase(rangeBegin, rangeEnd);
-      contents.insert(rangeBegin, replacement.begin(), replacement.end());
-      
-      error = saveDocumentCore(contents, jsonPath, jsonType, jsonEncoding,
+      // single-pass splice (replace shifts the tail once rather than
+      // twice for an erase followed by an insert)
+      contents.replace(rangeBegin, rangeEnd,
+                       replacement.begin(), replacement.end());
+
+      error = saveDocumentCore(&contents, jsonPath, jsonType, jsonEncoding,
                                jsonFoldSpec, jsonChunkOutput, pDoc);
       if (error)
          return error;
@@ -492,6 +521,121 @@ Error saveDocumentDiff(const json::JsonRpcRequest& request,
    return Success();
 }
 
+// multi-region variant of saveDocumentDiff. accepts an array of
+// replacement chunks -- each replaces the subrange [offset, offset+length)
+// of the document as of the supplied hash -- sorted by ascending offset
+// and non-overlapping. clients which diff locally can thereby ship only
+// the changed regions of a large document in a single rpc instead of
+// falling back to a full-content upload when more than one region changed
+Error saveDocumentDiffs(const json::JsonRpcRequest& request,
+                        json::JsonRpcResponse* pResponse)
+{
+   using namespace rstudio::core::string_utils;
+
+   // unique id and jsonPath (can be null for auto-save)
+   std::string id;
+   json::Value jsonPath, jsonType, jsonEncoding, jsonFoldSpec, jsonChunkOutput;
+
+   // replacement chunks and expected document hash
+   json::Array chunksJson;
+   std::string hash;
+
+   // read params
+   Error error = json::readParams(request.params,
+                                  &id,
+                                  &jsonPath,
+                                  &jsonType,
+                                  &jsonEncoding,
+                                  &jsonFoldSpec,
+                                  &jsonChunkOutput,
+                                  &chunksJson,
+                                  &hash);
+   if (error)
+      return error ;
+
+   // if this has no path then it is an autosave, in this case
+   // suppress change detection
+   bool hasPath = json::isType<std::string>(jsonPath);
+   if (!hasPath)
+       pResponse->setSuppressDetectChanges(true);
+
+   // get the doc
+   boost::shared_ptr<SourceDocument> pDoc(new SourceDocument());
+   error = source_database::get(id, pDoc);
+   if (error)
+      return error ;
+
+   // don't even attempt anything if we're not working off the same
+   // original (the client falls back to a full save when no hash is
+   // returned, exactly as with save_document_diff)
+   if (pDoc->hash() != hash)
+      return Success();
+
+   // extract the chunks, validating ascending non-overlapping order
+   std::vector<std::string> replacements;
+   std::vector<int> offsets, lengths;
+   int lastEnd = 0;
+   BOOST_FOREACH(const json::Value& chunkJson, chunksJson)
+   {
+      if (!json::isType<json::Object>(chunkJson))
+         return Error(json::errc::ParamTypeMismatch, ERROR_LOCATION);
+
+      std::string replacement;
+      int offset, length;
+      error = json::readObject(chunkJson.get_obj(),
+                               "replacement", &replacement,
+                               "offset", &offset,
+                               "length", &length);
+      if (error)
+         return error;
+
+      if (offset < lastEnd || length < 0)
+         return Error(json::errc::ParamInvalid, ERROR_LOCATION);
+      lastEnd = offset + length;
+
+      replacements.push_back(replacement);
+      offsets.push_back(offset);
+      lengths.push_back(length);
+   }
+
+   std::string contents(pDoc->contents());
+
+   // apply back to front so that earlier offsets remain valid. offsets
+   // and lengths are specified in characters but contents is in UTF8
+   // bytes, so convert before using
+   for (std::size_t i = replacements.size(); i > 0; --i)
+   {
+      const std::string& replacement = replacements[i-1];
+
+      std::string::iterator rangeBegin = contents.begin();
+      error = utf8Advance(rangeBegin, offsets[i-1], contents.end(),
+                          &rangeBegin);
+      if (error)
+         return Success(); // UTF8 decoding failed. Abort differential save.
+
+      std::string::iterator rangeEnd = rangeBegin;
+      error = utf8Advance(rangeEnd, lengths[i-1], contents.end(), &rangeEnd);
+      if (error)
+         return Success(); // UTF8 decoding failed. Abort differential save.
+
+      contents.replace(rangeBegin, rangeEnd,
+                       replacement.begin(), replacement.end());
+   }
+
+   error = saveDocumentCore(&contents, jsonPath, jsonType, jsonEncoding,
+                            jsonFoldSpec, jsonChunkOutput, pDoc);
+   if (error)
+      return error;
+
+   // write to the source_database
+   error = sourceDatabasePutWithUpdatedContents(pDoc);
+   if (error)
+      return error;
+
+   pResponse->setResult(pDoc->hash());
+   return Success();
+}
+
 Error checkForExternalEdit(const json::JsonRpcRequest& request,
                            json::JsonRpcResponse* pResponse)
 {
@@ -1228,8 +1372,10 @@ Error initialize()
    initBlock.addFunctions()
       (bind(registerRpcMethod, "new_document", newDocument))
       (bind(registerRpcMethod, "open_document", openDocument))
+      (bind(registerRpcPrefetch, "open_document", buildExternalEditPrefetch))
       (bind(registerRpcMethod, "save_document", saveDocument))
       (bind(registerRpcMethod, "save_document_diff", saveDocumentDiff))
+      (bind(registerRpcMethod, "save_document_diffs", saveDocumentDiffs))
       (bind(registerRpcMethod, "check_for_external_edit", checkForExternalEdit))
       (bind(registerRpcMethod, "ignore_external_edit", ignoreExternalEdit))
       (bind(registerRpcMethod, "set_source_document_on_save", setSourceDocumentOnSave))
@@ -15,6 +15,8 @@
 
 #include "SessionSpelling.hpp"
 
+#include <set>
+
 #include <boost/shared_ptr.hpp>
 
 #include <core/Error.hpp>
@@ -42,6 +44,18 @@ namespace {
 // underlying spelling engine
 boost::scoped_ptr<core::spelling::SpellingEngine> s_pSpellingEngine;
 
+// cache of spell check verdicts -- document checking sends the same words
+// (function names, package names, domain vocabulary) over and over as the
+// user edits, so remember past results until the dictionary context changes
+std::set<std::string> s_correctWords;
+std::set<std::string> s_misspelledWords;
+
+void invalidateSpellingCache()
+{
+   s_correctWords.clear();
+   s_misspelledWords.clear();
+}
+
 // R function for testing & debugging
 SEXP rs_checkSpelling(SEXP wordSEXP)
 {
@@ -78,6 +92,7 @@ FilePath userDictionariesDir()
 
 void syncSpellingEngineDictionaries()
 {
+   invalidateSpellingCache();
    s_pSpellingEngine->useDictionary(userSettings().spellingLanguage());
 }
 
@@ -115,13 +130,32 @@ Error checkSpelling(const json::JsonRpcRequest& request,
       }
 
       std::string word = words[i].get_str();
+
+      // consult the verdict cache before the engine
+      if (s_misspelledWords.count(word) > 0)
+      {
+         misspelledIndexes.push_back(static_cast<int>(i));
+         continue;
+      }
+      else if (s_correctWords.count(word) > 0)
+      {
+         continue;
+      }
+
       bool isCorrect = true;
       error = s_pSpellingEngine->checkSpelling(word, &isCorrect);
       if (error)
          return error;
 
       if (!isCorrect)
+      {
+         s_misspelledWords.insert(word);
          misspelledIndexes.push_back(static_cast<int>(i));
+      }
+      else
+      {
+         s_correctWords.insert(word);
+      }
    }
 
    pResponse->setResult(misspelledIndexes);
@@ -25,6 +25,7 @@
 #include <core/Debug.hpp>
 #include <core/Exec.hpp>
 #include <core/StringUtils.hpp>
+#include <core/SafeConvert.hpp>
 #include <core/FileSerializer.hpp>
 
 #include <core/http/Request.hpp>
@@ -35,6 +36,10 @@
 #include <core/system/Environment.hpp>
 #include <core/system/ShellUtils.hpp>
 
+#ifdef RSTUDIO_ALLOCATION_SAMPLER
+#include <core/AllocationSampler.hpp>
+#endif
+
 #include <r/ROptions.hpp>
 #include <r/session/RSession.hpp>
 #include <r/session/RClientState.hpp> 
@@ -186,9 +191,48 @@ Error setClientState(const json::JsonRpcRequest& request,
 }
    
      
+// debounce state for graphics resizes -- applying a new graphics size
+// replays the entire display list through the graphics engine, which for
+// complex plots takes seconds, so we wait for the size to settle rather
+// than re-rendering natively on every resize step (the client scales the
+// existing image during intermediate steps)
+const int kGraphicsResizeDebounceMs = 200;
+r::session::RClientMetrics s_appliedMetrics;
+bool s_haveAppliedMetrics = false;
+r::session::RClientMetrics s_pendingMetrics;
+boost::posix_time::ptime s_pendingMetricsTime;
+bool s_pendingMetricsScheduled = false;
+
+void applyClientMetrics(const r::session::RClientMetrics& metrics)
+{
+   s_appliedMetrics = metrics;
+   s_haveAppliedMetrics = true;
+   r::session::setClientMetrics(metrics);
+}
+
+void applyPendingMetrics()
+{
+   using namespace boost::posix_time;
+
+   // if another update arrived within the debounce window then the user
+   // is still resizing -- check again once the window has passed
+   time_duration elapsed = microsec_clock::universal_time() -
+                           s_pendingMetricsTime;
+   if (elapsed < milliseconds(kGraphicsResizeDebounceMs))
+   {
+      module_context::scheduleDelayedWork(
+               milliseconds(kGraphicsResizeDebounceMs) - elapsed,
+               applyPendingMetrics);
+      return;
+   }
+
+   s_pendingMetricsScheduled = false;
+   applyClientMetrics(s_pendingMetrics);
+}
+
 // IN: WorkbenchMetrics object
 // OUT: Void
-Error setWorkbenchMetrics(const json::JsonRpcRequest& request, 
+Error setWorkbenchMetrics(const json::JsonRpcRequest& request,
                           json::JsonRpcResponse* pResponse)
 {
    // extract fields
@@ -200,10 +244,35 @@ Error setWorkbenchMetrics(const json::JsonRpcRequest& request,
                                  "devicePixelRatio", &(metrics.devicePixelRatio));
    if (error)
       return error;
-   
-   // set the metrics
-   r::session::setClientMetrics(metrics);
-   
+
+   // determine whether this update changes the graphics size (console
+   // width only changes are cheap and can always be applied immediately)
+   bool graphicsSizeChanged =
+         s_haveAppliedMetrics &&
+         (metrics.graphicsWidth != s_appliedMetrics.graphicsWidth ||
+          metrics.graphicsHeight != s_appliedMetrics.graphicsHeight ||
+          metrics.devicePixelRatio != s_appliedMetrics.devicePixelRatio);
+
+   if (!graphicsSizeChanged)
+   {
+      // apply directly
+      applyClientMetrics(metrics);
+   }
+   else
+   {
+      // debounce -- record the pending metrics and schedule a deferred
+      // apply if one isn't already outstanding
+      s_pendingMetrics = metrics;
+      s_pendingMetricsTime = boost::posix_time::microsec_clock::universal_time();
+      if (!s_pendingMetricsScheduled)
+      {
+         s_pendingMetricsScheduled = true;
+         module_context::scheduleDelayedWork(
+               boost::posix_time::milliseconds(kGraphicsResizeDebounceMs),
+               applyPendingMetrics);
+      }
+   }
+
    return Success();
 }
 
@@ -956,21 +1025,57 @@ void handleFileShow(const http::Request& request, http::Response* pResponse)
    pResponse->setCacheableFile(filePath, request);
 }
 
+// uiPrefs as last delivered to the client (via the session init payload
+// at startup, then via ui_prefs_changed events)
+json::Object s_lastNotifiedUiPrefs;
+
 void onUserSettingsChanged()
 {
    // sync underlying R save action
    module_context::syncRSaveAction();
 
+   // onChanged fires for every user settings write, including ones which
+   // don't touch uiPrefs at all (e.g. the CRAN mirror), and the client
+   // re-applies every pref it receives -- so only notify when the prefs
+   // actually differ from what the client already has
+   json::Object uiPrefs = userSettings().uiPrefs();
+   if (uiPrefs == s_lastNotifiedUiPrefs)
+      return;
+   s_lastNotifiedUiPrefs = uiPrefs;
+
    // fire event notifying the client that uiPrefs changed
    json::Object dataJson;
    dataJson["type"] = "global";
-   dataJson["prefs"] = userSettings().uiPrefs();
+   dataJson["prefs"] = uiPrefs;
    ClientEvent event(client_events::kUiPrefsChanged, dataJson);
    module_context::enqueClientEvent(event);
 }
 
+#ifdef RSTUDIO_ALLOCATION_SAMPLER
+
+Error dumpAllocationProfile(const json::JsonRpcRequest& request,
+                            json::JsonRpcResponse* pResponse)
+{
+   // write the symbolized profile to a temp file and hand back its path
+   FilePath profilePath = module_context::tempFile("allocation-profile",
+                                                   "txt");
+   boost::shared_ptr<std::ostream> pStream;
+   Error error = profilePath.open_w(&pStream);
+   if (error)
+      return error;
+
+   core::allocation_sampler::dump(*pStream);
+   pStream->flush();
+
+   pResponse->setResult(
+            module_context::createAliasedPath(profilePath));
+   return Success();
+}
+
+#endif // RSTUDIO_ALLOCATION_SAMPLER
+
 } // anonymous namespace
-   
+
 std::string editFileCommand()
 {
    // NOTE: only registered for server mode
@@ -979,7 +1084,19 @@ std::string editFileCommand()
 
 Error initialize()
 {
-   // register for change notifications on user settings
+#ifdef RSTUDIO_ALLOCATION_SAMPLER
+   // begin sampled allocation tracking (interval overridable for
+   // sessions where the default is too coarse or too costly)
+   std::string interval = core::system::getenv(
+                                    "RSTUDIO_ALLOCATION_SAMPLE_INTERVAL");
+   core::allocation_sampler::initialize(
+            interval.empty() ? 1024 : safe_convert::stringTo<unsigned>(
+                                                         interval, 1024));
+#endif
+
+   // register for change notifications on user settings (the client's
+   // baseline is the uiPrefs included in the session init payload)
+   s_lastNotifiedUiPrefs = userSettings().uiPrefs();
    userSettings().onChanged.connect(onUserSettingsChanged);
 
    // register postback handler for viewPDF (server-only)
@@ -1032,6 +1149,11 @@ Error initialize()
       (bind(registerRpcMethod, "create_ssh_key", createSshKey))
       (bind(registerRpcMethod, "start_shell_dialog", startShellDialog))
       (bind(registerRpcMethod, "execute_code", executeCode));
+#ifdef RSTUDIO_ALLOCATION_SAMPLER
+   initBlock.addFunctions()
+      (bind(registerRpcMethod, "dump_allocation_profile",
+                               dumpAllocationProfile));
+#endif
    return initBlock.execute();
 }
 
@@ -22,6 +22,7 @@
 #include <boost/format.hpp>
 #include <boost/scope_exit.hpp>
 #include <boost/enable_shared_from_this.hpp>
+#include <boost/thread.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/join.hpp>
 
@@ -572,6 +573,21 @@ private:
       // set the not cran env var
       core::system::setenv(&childEnv, "NOT_CRAN", "true");
 
+      // compile package native code in parallel -- R CMD INSTALL drives
+      // src/ compilation through make, which honors MAKEFLAGS. only set it
+      // when the user hasn't expressed their own preference (via the
+      // environment or e.g. ~/.R/Makevars, which takes precedence anyway)
+      if (core::system::getenv("MAKEFLAGS").empty())
+      {
+         unsigned int cores = boost::thread::hardware_concurrency();
+         if (cores > 1)
+         {
+            boost::format fmt("-j%1%");
+            core::system::setenv(&childEnv, "MAKEFLAGS",
+                                 boost::str(fmt % cores));
+         }
+      }
+
       // turn off external applications launching
       core::system::setenv(&childEnv, "R_BROWSER", "false");
       core::system::setenv(&childEnv, "R_PDFVIEWER", "false");
@@ -1242,7 +1258,16 @@ public:
 
    std::string outputAsText()
    {
+      // reserve the full size up front (build output can run to tens of
+      // megabytes and repeated reallocation during append gets expensive)
+      std::string::size_type totalSize = 0;
+      BOOST_FOREACH(const module_context::CompileOutput& compileOutput, output_)
+      {
+         totalSize += compileOutput.output.size();
+      }
+
       std::string output;
+      output.reserve(totalSize);
       BOOST_FOREACH(const module_context::CompileOutput& compileOutput, output_)
       {
          output.append(compileOutput.output);
@@ -1268,12 +1293,17 @@ private:
       std::vector<std::string> lines;
       boost::algorithm::split(lines, output,  boost::algorithm::is_any_of("\n"));
 
-      // apply filter to each line
+      // apply the filter line by line, but coalesce runs of lines with the
+      // same classification into a single block -- verbose builds produce
+      // thousands of lines per read and a client event per line swamps the
+      // event queue (and the client) with json serialization overhead
+      using namespace module_context;
+      std::string block;
+      int blockType = kCompileOutputNormal;
       int size = lines.size();
       for (int i=0; i<size; i++)
       {
          // apply filter
-         using namespace module_context;
          std::string line = lines.at(i);
          int type = errorOutputFilterFunction_(line) ?
                                  kCompileOutputError : kCompileOutputNormal;
@@ -1282,9 +1312,18 @@ private:
          if (i != (size-1))
             line.append("\n");
 
-         // enque the output
-         enqueBuildOutput(type, line);
+         // flush the pending block on a type transition
+         if (type != blockType && !block.empty())
+         {
+            enqueBuildOutput(blockType, block);
+            block.clear();
+         }
+         blockType = type;
+         block.append(line);
       }
+
+      if (!block.empty())
+         enqueBuildOutput(blockType, block);
    }
 
    void onStandardOutput(const std::string& output)
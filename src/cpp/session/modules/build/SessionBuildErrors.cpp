@@ -24,6 +24,7 @@
 #include <boost/algorithm/string/predicate.hpp>
 
 #include <core/Error.hpp>
+#include <core/RegexUtils.hpp>
 #include <core/SafeConvert.hpp>
 #include <core/FileSerializer.hpp>
 
@@ -100,7 +101,8 @@ std::vector<module_context::SourceMarker> parseRErrors(
    using namespace module_context;
    std::vector<SourceMarker> errors;
 
-   boost::regex re("^Error in parse\\(outFile\\) : ([0-9]+?):([0-9]+?): (.+?)\\n"
+   const boost::regex& re = regex_utils::cached(
+                   "^Error in parse\\(outFile\\) : ([0-9]+?):([0-9]+?): (.+?)\\n"
                    "([0-9]+?): (.*?)\\n([0-9]+?): (.+?)$");
    boost::sregex_iterator iter(output.begin(), output.end(), re,
                                boost::regex_constants::match_not_dot_newline);
@@ -162,7 +164,8 @@ std::vector<module_context::SourceMarker> parseGccErrors(
 
    // parse standard gcc errors and warning lines but also pickup "from"
    // prefixed errors and substitute the from file for the error/warning file
-   boost::regex re("(?:from (.+?):([0-9]+?).+?\\n)?"
+   const boost::regex& re = regex_utils::cached(
+                   "(?:from (.+?):([0-9]+?).+?\\n)?"
                    "^(.+?):([0-9]+?):(?:([0-9]+?):)? (error|warning): (.+)$");
    boost::sregex_iterator iter(output.begin(), output.end(), re,
                                boost::regex_constants::match_not_dot_newline);
@@ -65,6 +65,10 @@ bool insertDefinition(const CppDefinition& definition,
 
 typedef boost::function<bool(const CppDefinition&)> DefinitionVisitor;
 
+// schedule an incremental save of the on-disk index (defined below,
+// after the persistence functions)
+void scheduleSaveDefinitionIndex();
+
 CXChildVisitResult cursorVisitor(CXCursor cxCursor,
                                  CXCursor,
                                  CXClientData clientData)
@@ -244,6 +248,10 @@ void fileChangeHandler(const core::system::FileChangeEvent& event)
          libclang::clang().disposeIndex(index);
       }
    }
+
+   // the in-memory index changed -- schedule an incremental save so the
+   // on-disk copy stays current (rather than waiting for a clean shutdown)
+   scheduleSaveDefinitionIndex();
 }
 
 } // anonymous namespace
@@ -551,13 +559,41 @@ void saveDefinitionIndex()
       indexJson.push_back(definitionsJson);
    }
 
+   // use compact serialization -- this file is written incrementally as
+   // source files change and read back via a memory mapped read at startup,
+   // so we want it as small as possible (it's not intended for human eyes)
    std::ostringstream ostr;
-   json::writeFormatted(indexJson, ostr);
+   json::write(indexJson, ostr);
    Error error = writeStringToFile(definitionIndexFilePath(), ostr.str());
    if (error)
       LOG_ERROR(error);
 }
 
+// incrementally persist the index as files change (rather than only at
+// shutdown) so that a suspended or abnormally terminated session doesn't
+// pay for a full re-index of the package at the next startup. saves are
+// coalesced and deferred to idle time since file change events can come
+// in large batches (e.g. after a git checkout)
+bool s_indexSavePending = false;
+
+void saveDefinitionIndexDeferred()
+{
+   s_indexSavePending = false;
+   saveDefinitionIndex();
+}
+
+void scheduleSaveDefinitionIndex()
+{
+   if (s_indexSavePending)
+      return;
+
+   s_indexSavePending = true;
+   module_context::scheduleDelayedWork(
+            boost::posix_time::seconds(5),
+            saveDefinitionIndexDeferred,
+            true); // require idle
+}
+
 void onShutdown(bool terminatedNormally)
 {
    if (terminatedNormally)
@@ -157,6 +157,10 @@ std::string buildFileHash(const FilePath& filePath)
 std::string packageBuildFileHash()
 {
    std::ostringstream ostr;
+   // include the R version in the hash so that configs saved by a
+   // previous session are discarded after an upgrade of R (compiler
+   // flags and include paths can change between R versions)
+   ostr << module_context::rVersion();
    FilePath buildPath = projects::projectContext().buildTargetPath();
    ostr << buildFileHash(buildPath.childPath("DESCRIPTION"));
    FilePath srcPath = buildPath.childPath("src");
@@ -255,7 +259,10 @@ std::vector<std::string> includesForLinkingTo(const std::string& linkingTo)
 
 
 RCompilationDatabase::RCompilationDatabase()
-   : usePrecompiledHeaders_(true), restoredCompilationConfig_(false)
+   : usePrecompiledHeaders_(true),
+     restoredCompilationConfig_(false),
+     restoredSourceCppConfig_(false),
+     packageConfigRevalidationPending_(false)
 {
 }
 
@@ -273,6 +280,44 @@ void RCompilationDatabase::updateForCurrentPackage()
    if (buildFileHash == packageBuildFileHash_)
       return;
 
+   // if we restored a config from a previous session that's merely out of
+   // date (e.g. DESCRIPTION or Makevars was touched) then keep serving it
+   // and revalidate at idle time -- re-probing shells out to R CMD SHLIB
+   // which costs seconds, and stale args are almost always still usable
+   // for completion/diagnostics in the interim
+   if (!packageCompilationConfig_.empty())
+   {
+      if (!packageConfigRevalidationPending_)
+      {
+         packageConfigRevalidationPending_ = true;
+
+         // note: we are a process-lifetime singleton so binding 'this'
+         // into scheduled work is safe
+         module_context::scheduleDelayedWork(
+            boost::posix_time::milliseconds(500),
+            boost::bind(
+               &RCompilationDatabase::revalidatePackageCompilationConfig,
+               this),
+            true); // require idle
+      }
+      return;
+   }
+
+   // no previous config to fall back on -- compute synchronously
+   recomputePackageCompilationConfig();
+}
+
+void RCompilationDatabase::revalidatePackageCompilationConfig()
+{
+   packageConfigRevalidationPending_ = false;
+   recomputePackageCompilationConfig();
+}
+
+void RCompilationDatabase::recomputePackageCompilationConfig()
+{
+   // capture the hash the config will be valid for
+   std::string buildFileHash = packageBuildFileHash();
+
    // start with base args
    std::vector<std::string> args = baseCompilationArgs(true);
 
@@ -401,6 +446,11 @@ FilePath compilationConfigFilePath()
    return module_context::scopedScratchPath().complete("cpp-complilation-config");
 }
 
+FilePath sourceCppConfigFilePath()
+{
+   return module_context::scopedScratchPath().complete("cpp-source-cpp-config");
+}
+
 
 } // anonymous namespace
 
@@ -462,8 +512,121 @@ void RCompilationDatabase::restorePackageCompilationConfig()
    }
 }
 
+void RCompilationDatabase::saveSourceCppConfig()
+{
+   json::Array entriesJson;
+   BOOST_FOREACH(const ConfigMap::value_type& entry, sourceCppConfigMap_)
+   {
+      // only persist entries we have a hash for (the hash is how we
+      // detect that the saved args are still valid for the file)
+      SourceCppHashes::const_iterator it = sourceCppHashes_.find(entry.first);
+      if (it == sourceCppHashes_.end())
+         continue;
+
+      json::Object entryJson;
+      entryJson["file"] = entry.first;
+      entryJson["hash"] = it->second;
+      entryJson["args"] = json::toJsonArray(entry.second.args);
+      entryJson["pch"] = entry.second.PCH;
+      entryJson["is_cpp"] = entry.second.isCpp;
+      entriesJson.push_back(entryJson);
+   }
+
+   json::Object configJson;
+   configJson["r_version"] = module_context::rVersion();
+   configJson["entries"] = entriesJson;
+
+   std::ostringstream ostr;
+   json::writeFormatted(configJson, ostr);
+   Error error = writeStringToFile(sourceCppConfigFilePath(), ostr.str());
+   if (error)
+      LOG_ERROR(error);
+}
+
+void RCompilationDatabase::restoreSourceCppConfig()
+{
+   FilePath configFilePath = sourceCppConfigFilePath();
+   if (!configFilePath.exists())
+      return;
+
+   std::string contents;
+   Error error = readStringFromFile(configFilePath, &contents);
+   if (error)
+   {
+      LOG_ERROR(error);
+      return;
+   }
+
+   json::Value configJson;
+   if (!json::parse(contents, &configJson) ||
+       !json::isType<json::Object>(configJson))
+   {
+      LOG_ERROR_MESSAGE("Error parsing sourceCpp config: " + contents);
+      return;
+   }
+
+   std::string rVersion;
+   json::Array entriesJson;
+   error = json::readObject(configJson.get_obj(),
+                            "r_version", &rVersion,
+                            "entries", &entriesJson);
+   if (error)
+   {
+      error.addProperty("json", contents);
+      LOG_ERROR(error);
+      return;
+   }
+
+   // discard configs saved under a different version of R
+   if (rVersion != module_context::rVersion())
+      return;
+
+   BOOST_FOREACH(const json::Value& entryJson, entriesJson)
+   {
+      if (!json::isType<json::Object>(entryJson))
+         continue;
+
+      std::string file, hash;
+      json::Array argsJson;
+      CompilationConfig config;
+      error = json::readObject(entryJson.get_obj(),
+                               "file", &file,
+                               "hash", &hash,
+                               "args", &argsJson,
+                               "pch", &config.PCH,
+                               "is_cpp", &config.isCpp);
+      if (error)
+      {
+         LOG_ERROR(error);
+         continue;
+      }
+
+      // skip files which no longer exist
+      if (!FilePath::exists(file))
+         continue;
+
+      BOOST_FOREACH(const json::Value& argJson, argsJson)
+      {
+         if (json::isType<std::string>(argJson))
+            config.args.push_back(argJson.get_str());
+      }
+
+      sourceCppConfigMap_[file] = config;
+      sourceCppHashes_[file] = hash;
+   }
+}
+
 void RCompilationDatabase::updateForSourceCpp(const core::FilePath& srcFile)
 {
+   // one time restore of per-file configs saved by previous sessions
+   // (avoids re-running the sourceCpp dry-run probe, which costs seconds
+   // of process spawn, for files whose attributes haven't changed)
+   if (!restoredSourceCppConfig_)
+   {
+      restoreSourceCppConfig();
+      restoredSourceCppConfig_ = true;
+   }
+
    // read the the source cpp hash for this file
    SourceCppFileInfo info = sourceCppFileInfo(srcFile);
 
@@ -497,6 +660,9 @@ void RCompilationDatabase::updateForSourceCpp(const core::FilePath& srcFile)
 
       // save hash to prevent recomputation
       sourceCppHashes_[filename] = info.hash;
+
+      // persist so future sessions can skip the probe entirely
+      saveSourceCppConfig();
    }
 }
 
@@ -62,6 +62,8 @@ private:
                                 core::system::ProcessResult* pResult);
 
    void updateForCurrentPackage();
+   void recomputePackageCompilationConfig();
+   void revalidatePackageCompilationConfig();
    void updateForSourceCpp(const core::FilePath& cppPath);
    std::vector<std::string> compileArgsForPackage(
                                      const core::system::Options& env,
@@ -70,6 +72,8 @@ private:
 
    void savePackageCompilationConfig();
    void restorePackageCompilationConfig();
+   void saveSourceCppConfig();
+   void restoreSourceCppConfig();
 
    // struct used to represent compilation settings
    struct CompilationConfig
@@ -113,6 +117,8 @@ private:
    CompilationConfig packageCompilationConfig_;
    bool usePrecompiledHeaders_;
    bool restoredCompilationConfig_;
+   bool restoredSourceCppConfig_;
+   bool packageConfigRevalidationPending_;
 };
 
 core::libclang::CompilationDatabase rCompilationDatabase();
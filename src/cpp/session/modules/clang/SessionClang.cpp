@@ -15,6 +15,9 @@
 
 #include "SessionClang.hpp"
 
+#include <algorithm>
+#include <deque>
+
 #include <core/Exec.hpp>
 
 #include <core/json/JsonRpc.hpp>
@@ -96,6 +99,54 @@ EmbeddedLibrary embeddedLibClang()
    return embedded;
 }
 
+// queue of editor documents waiting for idle-time translation unit
+// priming. priming parses the translation unit (and builds its
+// precompiled preamble), so the first completion in the file is fast;
+// we process one file per idle callback so startup with many open
+// C++ files doesn't monopolize the session, and the source index's
+// memory budget bounds how many parsed units we retain
+std::deque<std::string> s_primeQueue;
+bool s_primeScheduled = false;
+
+bool primeNextQueuedTranslationUnit()
+{
+   if (s_primeQueue.empty())
+   {
+      s_primeScheduled = false;
+      return false; // no more work, unschedule
+   }
+
+   std::string filename = s_primeQueue.front();
+   s_primeQueue.pop_front();
+
+   // parses the file if it's new to the index, reparses if it has
+   // changed, and is a no-op if it's already up to date
+   rSourceIndex().getTranslationUnit(filename);
+
+   return true;
+}
+
+void enqueueTranslationUnitPriming(const std::string& filename)
+{
+   if (std::find(s_primeQueue.begin(), s_primeQueue.end(), filename) !=
+       s_primeQueue.end())
+   {
+      return;
+   }
+
+   s_primeQueue.push_back(filename);
+
+   if (!s_primeScheduled)
+   {
+      s_primeScheduled = true;
+      module_context::schedulePeriodicWork(
+               boost::posix_time::milliseconds(500),
+               primeNextQueuedTranslationUnit,
+               true,    // require idle
+               false);  // not immediate
+   }
+}
+
 void onSourceDocUpdated(boost::shared_ptr<source_database::SourceDocument> pDoc)
 {
    // ignore if the file doesn't have a path
@@ -125,18 +176,15 @@ void onSourceDocUpdated(boost::shared_ptr<source_database::SourceDocument> pDoc)
             true); // require idle
    }
 
-   // non dirty-files may be eligible for re-priming (i.e. process them again
-   // only if they are already in the source index). the reason we don't do
-   // this for all source doc updates is that it would expose us to an
-   // unbounded number of update operations at IDE startup (based on how
-   // many C++ files are open in the source editing pane)
+   // non-dirty files (e.g. documents restored at IDE startup) are queued
+   // for one-at-a-time priming during idle. previously we only re-primed
+   // files already in the index (to avoid an unbounded number of parse
+   // operations at startup); now that the source index enforces a memory
+   // budget on retained translation units we can prime all open documents
+   // without unbounded resource usage
    else
    {
-      module_context::scheduleDelayedWork(
-            boost::posix_time::milliseconds(100),
-            boost::bind(&SourceIndex::reprimeEditorTranslationUnit,
-                        &(rSourceIndex()), filename),
-            true); // require idle
+      enqueueTranslationUnitPriming(filename);
    }
 }
 
@@ -164,6 +212,13 @@ bool cppIndexingDisabled()
    return ! r::options::getOption<bool>("rstudio.indexCpp", true, false);
 }
 
+void onMemoryPressure()
+{
+   // translation units are pure caches (reparsed on demand) so they can
+   // be dropped wholesale when the session needs to shed memory
+   rSourceIndex().removeAllTranslationUnits();
+}
+
 // diagnostic function to assist in determine whether/where
 // libclang was loaded from (and any errors which occurred
 // that prevented loading, e.g. inadequate version, missing
@@ -259,6 +314,9 @@ Error initialize()
    source_database::events().onDocRemoved.connect(onSourceDocRemoved);
    source_database::events().onRemoveAll.connect(onAllSourceDocsRemoved);
 
+   // drop translation units under memory pressure
+   module_context::events().onMemoryPressure.connect(onMemoryPressure);
+
    return Success();
 }
 
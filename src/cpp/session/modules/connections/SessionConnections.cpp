@@ -15,8 +15,11 @@
 
 #include "SessionConnections.hpp"
 
+#include <map>
+
 #include <boost/foreach.hpp>
 #include <boost/format.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 
@@ -49,6 +52,74 @@ namespace connections {
 
 namespace {
 
+// cached catalog listings (tables per connection, fields per table).
+// listing a catalog evaluates R on the main thread -- and for drivers
+// like spark performs a remote query -- while the pane re-requests the
+// listings every time it refreshes, so serve repeats from a short-lived
+// cache and re-query only when it expires or the connection reports a
+// change
+
+const int kCatalogCacheExpirySeconds = 60;
+
+struct CatalogCacheEntry
+{
+   boost::posix_time::ptime time;
+   json::Value result;
+};
+
+std::map<std::string, CatalogCacheEntry> s_catalogCache;
+
+std::string catalogCacheKey(const std::string& type,
+                            const std::string& host,
+                            const std::string& table)
+{
+   return type + "\n" + host + "\n" + table;
+}
+
+// drop all cached listings for the given connection (its table list and
+// any field listings)
+void invalidateCatalogCache(const std::string& type, const std::string& host)
+{
+   std::string prefix = type + "\n" + host + "\n";
+   std::map<std::string, CatalogCacheEntry>::iterator it =
+                                                   s_catalogCache.begin();
+   while (it != s_catalogCache.end())
+   {
+      if (boost::algorithm::starts_with(it->first, prefix))
+         s_catalogCache.erase(it++);
+      else
+         ++it;
+   }
+}
+
+bool lookupCatalogCache(const std::string& key, json::Value* pResult)
+{
+   using namespace boost::posix_time;
+
+   std::map<std::string, CatalogCacheEntry>::iterator it =
+                                                s_catalogCache.find(key);
+   if (it == s_catalogCache.end())
+      return false;
+
+   if ((microsec_clock::universal_time() - it->second.time) >=
+                                 seconds(kCatalogCacheExpirySeconds))
+   {
+      s_catalogCache.erase(it);
+      return false;
+   }
+
+   *pResult = it->second.result;
+   return true;
+}
+
+void storeCatalogCache(const std::string& key, const json::Value& result)
+{
+   CatalogCacheEntry entry;
+   entry.time = boost::posix_time::microsec_clock::universal_time();
+   entry.result = result;
+   s_catalogCache[key] = entry;
+}
+
 
 SEXP rs_connectionOpened(SEXP typeSEXP,
                          SEXP hostSEXP,
@@ -85,6 +156,9 @@ SEXP rs_connectionOpened(SEXP typeSEXP,
    // update active connections
    activeConnections().add(connection.id);
 
+   // a (re)opened connection may present a different catalog
+   invalidateCatalogCache(type, host);
+
    // fire connection opended event
    ClientEvent event(client_events::kConnectionOpened,
                      connectionJson(connection));
@@ -101,6 +175,8 @@ SEXP rs_connectionClosed(SEXP typeSEXP, SEXP hostSEXP)
    // update active connections
    activeConnections().remove(ConnectionId(type, host));
 
+   invalidateCatalogCache(type, host);
+
    return R_NilValue;
 }
 
@@ -111,6 +187,10 @@ SEXP rs_connectionUpdated(SEXP typeSEXP, SEXP hostSEXP, SEXP hintSEXP)
    std::string hint = r::sexp::safeAsString(hintSEXP);
    ConnectionId id(type, host);
 
+   // the driver reported a catalog change (e.g. table created or
+   // removed) -- drop the cached listings so they are re-queried
+   invalidateCatalogCache(type, host);
+
    json::Object updatedJson;
    updatedJson["id"] = connectionIdJson(id);
    updatedJson["hint"] = hint;
@@ -344,6 +424,18 @@ void connectionListTables(const json::JsonRpcRequest& request,
    // response
    json::JsonRpcResponse response;
 
+   // serve from the catalog cache when possible
+   std::string cacheKey = catalogCacheKey(connection.id.type,
+                                          connection.id.host,
+                                          "");
+   json::Value cachedResult;
+   if (lookupCatalogCache(cacheKey, &cachedResult))
+   {
+      response.setResult(cachedResult);
+      continuation(Success(), &response);
+      return;
+   }
+
    // get the list of tables
    std::vector<std::string> tables;
    error = r::exec::RFunction(".rs.connectionListTables",
@@ -356,7 +448,9 @@ void connectionListTables(const json::JsonRpcRequest& request,
    }
    else
    {
-      response.setResult(json::toJsonArray((tables)));
+      json::Value result = json::toJsonArray(tables);
+      storeCatalogCache(cacheKey, result);
+      response.setResult(result);
       continuation(Success(), &response);
    }
 }
@@ -364,7 +458,8 @@ void connectionListTables(const json::JsonRpcRequest& request,
 void sendResponse(const Error& error,
                   SEXP sexpResult,
                   const json::JsonRpcFunctionContinuation& continuation,
-                  const ErrorLocation& errorLocation)
+                  const ErrorLocation& errorLocation,
+                  const std::string& cacheKey = std::string())
 {
    // response
    json::JsonRpcResponse response;
@@ -385,6 +480,8 @@ void sendResponse(const Error& error,
       }
       else
       {
+         if (!cacheKey.empty())
+            storeCatalogCache(cacheKey, jsonResult);
          response.setResult(jsonResult);
          continuation(Success(), &response);
       }
@@ -406,6 +503,19 @@ void connectionListFields(const json::JsonRpcRequest& request,
       return;
    }
 
+   // serve from the catalog cache when possible
+   std::string cacheKey = catalogCacheKey(connection.id.type,
+                                          connection.id.host,
+                                          table);
+   json::Value cachedResult;
+   if (lookupCatalogCache(cacheKey, &cachedResult))
+   {
+      json::JsonRpcResponse response;
+      response.setResult(cachedResult);
+      continuation(Success(), &response);
+      return;
+   }
+
    // get the list of fields
    r::sexp::Protect rProtect;
    SEXP sexpResult;
@@ -416,8 +526,8 @@ void connectionListFields(const json::JsonRpcRequest& request,
                                  table).call(&sexpResult, &rProtect);
 
 
-   // send the response
-   sendResponse(error, sexpResult, continuation, ERROR_LOCATION);
+   // send the response (caching the field listing on success)
+   sendResponse(error, sexpResult, continuation, ERROR_LOCATION, cacheKey);
 }
 
 void connectionPreviewTable(const json::JsonRpcRequest& request,
@@ -66,6 +66,10 @@
 // special cell values
 #define SPECIAL_CELL_NA 0
 
+// the largest number of formatted pages we cache per frame (scrolling
+// back over previously formatted rows is served from this cache)
+#define MAX_CACHED_PAGES 50
+
 using namespace rstudio::core;
 
 namespace rstudio {
@@ -289,6 +293,14 @@ struct CachedFrame
    int workingOrderCol;
    std::string workingOrderDir;
 
+   // Formatted pages of the frame, keyed by the page parameters (range,
+   // order, search, and filters). Pages are formatted in R one column at a
+   // time, so re-serving a page the user scrolls back to from this cache
+   // avoids a round-trip through r::exec per column. The cache dies with
+   // the CachedFrame, which onDetectChanges replaces whenever the
+   // underlying object changes.
+   std::map<std::string, json::Value> pageCache;
+
    // NB: There's no protection on this SEXP and it may be a stale pointer!
    // Used only to test for changes.
    SEXP observedSEXP;
@@ -512,9 +524,40 @@ json::Value getData(SEXP dataSEXP, const http::Fields& fields)
    bool needsTransform = ordercol > 0 || hasFilter || !search.empty();
    bool hasTransform = false;
 
+   // compute a key identifying this page of the view (everything the
+   // response depends on except the draw counter)
+   std::string pageKey = boost::lexical_cast<std::string>(start) + "\n" +
+         boost::lexical_cast<std::string>(length) + "\n" +
+         boost::lexical_cast<std::string>(ordercol) + "\n" +
+         orderdir + "\n" + search;
+   for (unsigned i = 0; i < filters.size(); i++)
+   {
+      pageKey += "\n" + filters[i];
+   }
+
    // check to see if we have an ordered/filtered view we can build from
-   std::map<std::string, CachedFrame>::iterator cachedFrame = 
+   std::map<std::string, CachedFrame>::iterator cachedFrame =
       s_cachedFrames.find(cacheKey);
+
+   // serve the page from the frame's formatted page cache if we can (the
+   // draw counter is the DataTables request sequence number and is the only
+   // thing that varies between identical requests)
+   if (cachedFrame != s_cachedFrames.end())
+   {
+      std::map<std::string, json::Value>::const_iterator pageIt =
+         cachedFrame->second.pageCache.find(pageKey);
+      if (pageIt != cachedFrame->second.pageCache.end())
+      {
+         json::Object cachedResult = pageIt->second.get_obj();
+         cachedResult["draw"] = draw;
+         return cachedResult;
+      }
+   }
+
+   // whether the data we're about to transform is the original (unfiltered)
+   // frame; when it is, sorting can use cached per-column order indexes
+   bool transformOriginal = true;
+
    if (needsTransform)
    {
       if (cachedFrame != s_cachedFrames.end())
@@ -543,6 +586,7 @@ json::Value getData(SEXP dataSEXP, const http::Fields& fields)
                // requested; transform the filtered set instead of starting
                // from scratch
                dataSEXP = workingDataSEXP;
+               transformOriginal = false;
             }
          }
       }
@@ -558,6 +602,8 @@ json::Value getData(SEXP dataSEXP, const http::Fields& fields)
       transform.addParam("search", search);    // global search (across cols)
       transform.addParam("col", ordercol);     // which column to order on
       transform.addParam("dir", orderdir);     // order direction ("asc"/"desc")
+      transform.addParam("cacheKey", cacheKey);        // for order index cache
+      transform.addParam("original", transformOriginal); // sorting orig frame?
       transform.call(&dataSEXP, &protect);
       if (error)
          throw r::exec::RErrorException(error.summary());
@@ -683,6 +729,15 @@ json::Value getData(SEXP dataSEXP, const http::Fields& fields)
    result["recordsTotal"] = nrow;
    result["recordsFiltered"] = filteredNRow;
    result["data"] = data;
+
+   // remember the formatted page so scrolling back to it doesn't re-enter R
+   if (cachedFrame != s_cachedFrames.end())
+   {
+      if (cachedFrame->second.pageCache.size() >= MAX_CACHED_PAGES)
+         cachedFrame->second.pageCache.clear();
+      cachedFrame->second.pageCache[pageKey] = result;
+   }
+
    return result;
 }
 
@@ -963,6 +1018,12 @@ Error initialize()
    module_context::events().onClientInit.connect(onClientInit);
    addSuspendHandler(SuspendHandler(onSuspend, onResume));
 
+   // cached frames for closed viewer tabs are removed eagerly but
+   // orphaned cache files (e.g. from sessions which exited uncleanly)
+   // accumulate without limit -- evict the oldest once over budget
+   module_context::scheduleCacheTrim(FilePath(viewerCacheDir()),
+                                     100 * 1024 * 1024);
+
    using boost::bind;
    using namespace rstudio::r::function_hook ;
    using namespace session::module_context;
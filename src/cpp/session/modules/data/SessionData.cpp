@@ -15,6 +15,11 @@
 
 #include "SessionData.hpp"
 
+#include <fstream>
+#include <sstream>
+
+#include <boost/algorithm/string/predicate.hpp>
+
 #include <core/Exec.hpp>
  
 #include <r/RExec.hpp>
@@ -203,6 +208,119 @@ private:
 
 boost::shared_ptr<AsyncDataPreviewRProcess> s_pActiveDataPreview;
 
+// head slice used to preview large delimited text files -- the preview
+// only ever displays the first few thousand rows, so there is no need
+// for each option change (delimiter, column types, etc.) to re-read the
+// entire (possibly multi-GB) source file
+
+// don't bother slicing files below this size
+const uintmax_t kMinSliceableFileSize = 8 * 1024 * 1024;
+
+// extra lines included beyond the requested preview rows -- covers the
+// header row, comment lines, and readr's type-guessing window
+const int kPreviewSliceMarginLines = 1100;
+
+// lines included when the preview doesn't specify a row limit
+const int kDefaultPreviewSliceLines = 10000;
+
+FilePath s_previewSlicePath;
+std::string s_previewSliceKey;
+
+int intField(const json::Object& object, const std::string& name,
+             int defaultValue)
+{
+   json::Object::const_iterator it = object.find(name);
+   if (it != object.end() && json::isType<int>(it->second))
+      return it->second.get_int();
+   return defaultValue;
+}
+
+// return a bounded head slice of the given file. the slice is cached and
+// keyed on the file's identity so repeated previews while the user
+// toggles import options re-read a few thousand lines rather than the
+// whole file. returns an empty FilePath if the slice can't be produced
+// (callers fall back to the original file).
+FilePath previewSliceForFile(const FilePath& filePath, int lines)
+{
+   std::ostringstream keyStream;
+   keyStream << filePath.absolutePath() << ":" << filePath.lastWriteTime()
+             << ":" << filePath.size() << ":" << lines;
+   std::string key = keyStream.str();
+
+   if (key == s_previewSliceKey && s_previewSlicePath.exists())
+      return s_previewSlicePath;
+
+   std::ifstream in(filePath.absolutePath().c_str(),
+                    std::ios::in | std::ios::binary);
+   if (!in)
+      return FilePath();
+
+   FilePath slicePath = module_context::tempFile("data-preview-", "txt");
+   std::ofstream out(slicePath.absolutePath().c_str(),
+                     std::ios::out | std::ios::binary);
+   if (!out)
+      return FilePath();
+
+   // NOTE: the slice always ends at a line boundary, but a quoted field
+   // spanning the boundary can still be cut short; at worst the preview
+   // reports a parsing problem on its final record
+   std::string line;
+   for (int i = 0; i < lines && std::getline(in, line); i++)
+      out << line << "\n";
+   out.close();
+
+   // replace any previous slice
+   if (!s_previewSlicePath.empty())
+   {
+      Error error = s_previewSlicePath.removeIfExists();
+      if (error)
+         LOG_ERROR(error);
+   }
+   s_previewSlicePath = slicePath;
+   s_previewSliceKey = key;
+
+   return slicePath;
+}
+
+// rewrite a preview request for a large local delimited text file to
+// read from a cached head slice of the file instead of the file itself
+void useHeadSliceForTextPreview(json::JsonRpcRequest* pRequest)
+{
+   if (pRequest->params.empty() ||
+       !json::isType<json::Object>(pRequest->params[0]))
+   {
+      return;
+   }
+   json::Object options = pRequest->params[0].get_obj();
+
+   // only local delimited text files are sliceable
+   std::string mode, location;
+   Error error = json::readObject(options,
+                                  "mode", &mode,
+                                  "importLocation", &location);
+   if (error || mode != "text" ||
+       boost::algorithm::contains(location, "://"))
+   {
+      return;
+   }
+
+   FilePath filePath = module_context::resolveAliasedPath(location);
+   if (!filePath.exists() || filePath.size() < kMinSliceableFileSize)
+      return;
+
+   int maxRows = intField(options, "maxRows", -1);
+   int skip = intField(options, "skip", 0);
+   int lines = (maxRows > 0) ? skip + maxRows + kPreviewSliceMarginLines
+                             : skip + kDefaultPreviewSliceLines;
+
+   FilePath slicePath = previewSliceForFile(filePath, lines);
+   if (slicePath.empty())
+      return;
+
+   options["importLocation"] = slicePath.absolutePath();
+   pRequest->params[0] = options;
+}
+
 bool getPreviewDataImportAsync(
         const json::JsonRpcRequest& request,
         const json::JsonRpcFunctionContinuation& continuation)
@@ -214,7 +332,11 @@ bool getPreviewDataImportAsync(
    }
    else
    {
-      s_pActiveDataPreview = AsyncDataPreviewRProcess::create(request, continuation);
+      json::JsonRpcRequest previewRequest = request;
+      useHeadSliceForTextPreview(&previewRequest);
+
+      s_pActiveDataPreview = AsyncDataPreviewRProcess::create(previewRequest,
+                                                              continuation);
       return false;
    }
 }
@@ -15,6 +15,11 @@
 
 #include "EnvironmentMonitor.hpp"
 
+#include <algorithm>
+#include <sstream>
+
+#include <core/Hash.hpp>
+
 #include <r/RSexp.hpp>
 #include <r/RInterface.hpp>
 #include <session/SessionModuleContext.hpp>
@@ -69,6 +74,58 @@ void removeVarFromList(std::vector<r::sexp::Variable>* pEnv,
    }
 }
 
+// Build a bounded fingerprint of a binding's value. In-place modifications
+// (e.g. x[1] <- 2 on an unshared vector) don't change the address of the
+// bound SEXP, so the address-based set differences below miss them entirely;
+// summarizing the type, length, and a bounded prefix of the payload catches
+// the common cases without walking large objects. Unevaluated promises are
+// left untouched (fingerprinting them would force evaluation).
+std::string contentFingerprint(SEXP valueSEXP)
+{
+   if (valueSEXP == NULL || isUnevaluatedPromise(valueSEXP))
+      return std::string();
+
+   std::ostringstream ostr;
+   int type = TYPEOF(valueSEXP);
+   int length = r::sexp::length(valueSEXP);
+   ostr << type << "," << length << ",";
+
+   // bound the number of elements inspected so fingerprinting stays O(1)
+   // even for very large objects (changes beyond the cap fall back to the
+   // existing address-based detection)
+   int elements = std::min(length, 64);
+   switch (type)
+   {
+      case REALSXP:
+         ostr.write(reinterpret_cast<const char*>(REAL(valueSEXP)),
+                    elements * sizeof(double));
+         break;
+      case INTSXP:
+         ostr.write(reinterpret_cast<const char*>(INTEGER(valueSEXP)),
+                    elements * sizeof(int));
+         break;
+      case LGLSXP:
+         ostr.write(reinterpret_cast<const char*>(LOGICAL(valueSEXP)),
+                    elements * sizeof(int));
+         break;
+      case STRSXP:
+         for (int i = 0; i < elements; i++)
+         {
+            SEXP charSEXP = STRING_ELT(valueSEXP, i);
+            if (charSEXP != NULL && charSEXP != NA_STRING)
+               ostr << CHAR(charSEXP);
+            ostr << ",";
+         }
+         break;
+      default:
+         // other types (lists, environments, functions, etc.) are
+         // fingerprinted by type and length only
+         break;
+   }
+
+   return core::hash::crc32Hash(ostr.str());
+}
+
 } // anonymous namespace
 
 EnvironmentMonitor::EnvironmentMonitor() :
@@ -150,6 +207,15 @@ void EnvironmentMonitor::checkForChanges()
    std::for_each(currentEnv.begin(), currentEnv.end(),
                  boost::bind(addUnevaledPromise, &currentPromises, _1));
 
+   // fingerprint the current bindings (bounded per binding; see
+   // contentFingerprint for rationale)
+   std::map<std::string, std::string> currentFingerprints;
+   for (std::vector<r::sexp::Variable>::const_iterator it = currentEnv.begin();
+        it != currentEnv.end(); it++)
+   {
+      currentFingerprints[it->first] = contentFingerprint(it->second);
+   }
+
    bool refreshEnqueued = false;
    if (!initialized_)
    {
@@ -214,6 +280,27 @@ void EnvironmentMonitor::checkForChanges()
       // if a refresh is scheduled there's no need to emit add events one by one
       if (!refreshEnqueued)
       {
+         // detect in-place modifications: bindings whose address didn't
+         // change (so the set differences above can't see them) but whose
+         // content fingerprint did--process as assigns so the client
+         // re-describes just those bindings. note that bindings which were
+         // re-assigned (address changed) fail the binary search below and
+         // are already covered by addedVars.
+         for (std::vector<r::sexp::Variable>::const_iterator it =
+                 currentEnv.begin(); it != currentEnv.end(); it++)
+         {
+            if (!std::binary_search(lastEnv_.begin(), lastEnv_.end(), *it))
+               continue;
+
+            std::map<std::string, std::string>::const_iterator fingerprintIt =
+               lastContentFingerprints_.find(it->first);
+            if (fingerprintIt != lastContentFingerprints_.end() &&
+                fingerprintIt->second != currentFingerprints[it->first])
+            {
+               addedVars.push_back(*it);
+            }
+         }
+
          // have any promises been evaluated since we last checked?
          if (currentPromises != unevaledPromises_)
          {
@@ -235,6 +322,7 @@ void EnvironmentMonitor::checkForChanges()
 
    unevaledPromises_ = currentPromises;
    lastEnv_ = currentEnv;
+   lastContentFingerprints_ = currentFingerprints;
 }
 
 } // namespace environment
@@ -13,6 +13,9 @@
  *
  */
 
+#include <map>
+#include <string>
+
 #include <r/RSexp.hpp>
 #include <r/RInterface.hpp>
 
@@ -38,6 +41,10 @@ private:
 
    std::vector<r::sexp::Variable> lastEnv_;
    std::vector<r::sexp::Variable> unevaledPromises_;
+
+   // content fingerprints from the last check; used to detect in-place
+   // modifications, which don't change the address of the bound SEXP
+   std::map<std::string, std::string> lastContentFingerprints_;
    r::sexp::PreservedSEXP environment_;
    bool initialized_;
    bool refreshOnInit_;
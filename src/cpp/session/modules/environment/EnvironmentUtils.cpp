@@ -15,10 +15,15 @@
 
 #include "EnvironmentUtils.hpp"
 
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
 #include <r/RExec.hpp>
 #include <r/RJson.hpp>
 #include <core/FileSerializer.hpp>
 #include <core/FileUtils.hpp>
+#include <core/SafeConvert.hpp>
 #include <session/SessionModuleContext.hpp>
 
 using namespace rstudio::core;
@@ -33,6 +38,73 @@ namespace {
 // of a variable
 const char UNKNOWN_VALUE[] = "<unknown>";
 
+// objects over this size get a deferred listing rather than a computed
+// value (must match the threshold in .rs.describeObject)
+const double kLargeObjectBytes = 524288;
+
+// replicate the formatting of print(object.size(x), units = "auto")
+std::string formatObjectSize(double size)
+{
+   const double kKb = 1024;
+   const double kMb = kKb * 1024;
+   const double kGb = kMb * 1024;
+
+   std::string units("bytes");
+   if (size >= kGb)
+   {
+      size /= kGb;
+      units = "Gb";
+   }
+   else if (size >= kMb)
+   {
+      size /= kMb;
+      units = "Mb";
+   }
+   else if (size >= kKb)
+   {
+      size /= kKb;
+      units = "Kb";
+   }
+
+   // R rounds to one decimal and drops a trailing .0
+   double rounded = ::floor((size * 10) + 0.5) / 10;
+   std::ostringstream oss;
+   if (rounded == ::floor(rounded))
+      oss << static_cast<boost::int64_t>(rounded);
+   else
+      oss << std::fixed << std::setprecision(1) << rounded;
+   oss << " " << units;
+   return oss.str();
+}
+
+// build the environment pane entry for a large plain vector directly
+// from its header -- the .rs.describeObject round trip (and its
+// object.size traversal) is pure overhead here since large objects get
+// a deferred listing anyway
+json::Object largeVectorVarToJson(const std::string& name, SEXP varSEXP)
+{
+   double size = r::sexp::approximateVectorBytes(varSEXP);
+   int length = r::sexp::length(varSEXP);
+   std::string type = r::sexp::implicitVectorClass(varSEXP);
+
+   std::string lengthDesc;
+   if (length > 1)
+      lengthDesc = safe_convert::numberToString(length) + " elements, ";
+
+   json::Object varJson;
+   varJson["name"] = name;
+   varJson["type"] = type;
+   varJson["is_data"] = false;
+   varJson["value"] = "Large " + type + " (" + lengthDesc +
+                      formatObjectSize(size) + ")";
+   varJson["description"] = std::string("");
+   varJson["size"] = size;
+   varJson["length"] = length;
+   varJson["contents"] = json::Array();
+   varJson["contents_deferred"] = true;
+   return varJson;
+}
+
 json::Value descriptionOfVar(SEXP var)
 {
    std::string value;
@@ -123,6 +195,15 @@ json::Value varToJson(SEXP env, const r::sexp::Variable& var)
    // For all other value types, construct the definition normally.
    else
    {
+      // large unclassed atomic vectors get a deferred listing; we can build
+      // that entry directly from the vector's header without the R round
+      // trip (or object.size's traversal of the object)
+      if (r::sexp::isPlainAtomicVector(varSEXP) &&
+          r::sexp::approximateVectorBytes(varSEXP) > kLargeObjectBytes)
+      {
+         return largeVectorVarToJson(var.first, varSEXP);
+      }
+
       SEXP description;
       json::Value val;
       r::sexp::Protect protect;
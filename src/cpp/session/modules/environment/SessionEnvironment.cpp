@@ -17,6 +17,7 @@
 #include "EnvironmentMonitor.hpp"
 
 #include <algorithm>
+#include <sstream>
 
 #include <core/Exec.hpp>
 #include <core/RecursionGuard.hpp>
@@ -904,6 +905,17 @@ SEXP rs_isBrowserActive()
    return r::sexp::create(s_browserActive, &protect);
 }
 
+// return the address of the underlying SEXP as a string -- used to key
+// the object size memoization cache (see .rs.sizeOfObject)
+SEXP rs_objectAddress(SEXP objSEXP)
+{
+   std::ostringstream ostr;
+   ostr << reinterpret_cast<const void*>(objSEXP);
+
+   r::sexp::Protect protect;
+   return r::sexp::create(ostr.str(), &protect);
+}
+
 Error initialize()
 {
    // store on the heap so that the destructor is never called (so we
@@ -929,6 +941,11 @@ Error initialize()
             (DL_FUNC) rs_isBrowserActive,
             0);
 
+   r::routines::registerCallMethod(
+            "rs_objectAddress",
+            (DL_FUNC) rs_objectAddress,
+            1);
+
    R_CallMethodDef methodDef ;
    methodDef.name = "rs_jumpToFunction" ;
    methodDef.fun = (DL_FUNC) rs_jumpToFunction ;
@@ -39,10 +39,11 @@ void handleMathJax(const http::Request& request, http::Response* pResponse)
    // extract path from URI
    std::string path = request.path().substr(strlen(kMathJaxURIPrefix));
    
-   // construct path to resource
+   // construct path to resource (served through the in-memory asset
+   // cache -- a single page load pulls a burst of mathjax files)
    FilePath mathjaxPath = options().mathjaxPath();
    FilePath resourcePath = mathjaxPath.complete(path);
-   pResponse->setCacheableFile(resourcePath, request);
+   module_context::setCacheableFileResponse(resourcePath, request, pResponse);
 }
 
 } // end anonymous namespace
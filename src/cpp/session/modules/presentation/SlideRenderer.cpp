@@ -16,6 +16,8 @@
 
 #include "SlideRenderer.hpp"
 
+#include <map>
+
 #include <boost/foreach.hpp>
 #include <boost/format.hpp>
 #include <boost/regex.hpp>
@@ -321,6 +323,43 @@ Error slideToHtml(const Slide& slide,
    return Success();
 }
 
+// cache of per-slide rendered html keyed by the inputs to slideToHtml.
+// markdown rendering dominates deck re-render time and a save typically
+// touches a single slide, so unchanged slides are assembled from the
+// cache rather than re-rendered. the cache is rebuilt on every render
+// pass so entries for edited or removed slides don't accumulate
+struct SlideHtmlCacheEntry
+{
+   std::string head;
+   std::string html;
+};
+
+std::map<std::string, SlideHtmlCacheEntry> s_slideHtmlCache;
+
+std::string slideHtmlCacheKey(const Slide& slide,
+                              int slideNumber,
+                              const std::string& extraContent,
+                              const std::string& incremental)
+{
+   // covers every slide-specific input consumed by slideToHtml (the
+   // media/quiz content and slide number participate via extraContent
+   // and slideNumber respectively)
+   std::ostringstream ostr;
+   ostr << slideNumber << "\n"
+        << slide.type() << "\n"
+        << slide.showTitle() << "\n"
+        << slide.cssClass() << "\n"
+        << slide.left() << "\n"
+        << slide.right() << "\n"
+        << incremental << "\n";
+   BOOST_FOREACH(const std::string& field, slide.invalidFields())
+   {
+      ostr << field << ",";
+   }
+   ostr << "\n" << extraContent << "\n" << slide.content();
+   return ostr.str();
+}
+
 } // anonymous namespace
 
 
@@ -340,6 +379,10 @@ Error renderSlides(const SlideDeck& slideDeck,
    // track json version of slide list
    SlideNavigationList navigationList(slideDeck.navigation());
 
+   // per-slide html cache for this render pass (swapped into the global
+   // cache on success so stale entries are pruned)
+   std::map<std::string, SlideHtmlCacheEntry> slideHtmlCache;
+
    // now the slides
    std::string cmdPad(8, ' ');
    int slideNumber = 0;
@@ -494,16 +537,37 @@ Error renderSlides(const SlideDeck& slideDeck,
       }
 
 
-      // render markdown
+      // render markdown (served from the cache when this slide last
+      // rendered with identical inputs)
       std::string headContent, htmlContent;
-      Error error = slideToHtml(slide,
-                                slideNumber,
-                                ostrMedia.str(),
-                                incremental,
-                                &headContent,
-                                &htmlContent);
-      if (error)
-         return error;
+      std::string cacheKey = slideHtmlCacheKey(slide,
+                                               slideNumber,
+                                               ostrMedia.str(),
+                                               incremental);
+      std::map<std::string, SlideHtmlCacheEntry>::const_iterator cacheIt =
+                                             s_slideHtmlCache.find(cacheKey);
+      if (cacheIt != s_slideHtmlCache.end())
+      {
+         headContent = cacheIt->second.head;
+         htmlContent = cacheIt->second.html;
+      }
+      else
+      {
+         Error error = slideToHtml(slide,
+                                   slideNumber,
+                                   ostrMedia.str(),
+                                   incremental,
+                                   &headContent,
+                                   &htmlContent);
+         if (error)
+            return error;
+      }
+
+      // retain for the next render pass
+      SlideHtmlCacheEntry cacheEntry;
+      cacheEntry.head = headContent;
+      cacheEntry.html = htmlContent;
+      slideHtmlCache[cacheKey] = cacheEntry;
 
       // record head
       pSlidesHead->append(headContent);
@@ -546,6 +610,10 @@ Error renderSlides(const SlideDeck& slideDeck,
    *pRevealConfig = ostrRevealConfig.str();
    *pInitActions = ostrInitActions.str();
    *pSlideActions = ostrSlideActions.str();
+
+   // install this pass's cache (drops entries no longer referenced)
+   s_slideHtmlCache.swap(slideHtmlCache);
+
    return Success();
 }
 
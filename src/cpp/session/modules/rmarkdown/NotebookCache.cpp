@@ -29,6 +29,8 @@
 #include <core/Algorithm.hpp>
 #include <core/Exec.hpp>
 #include <core/FileSerializer.hpp>
+#include <core/Hash.hpp>
+#include <core/json/JsonRpc.hpp>
 
 #include <r/RExec.hpp>
 #include <r/RRoutines.hpp>
@@ -615,8 +617,151 @@ Error extractRmdFromNotebook(const json::JsonRpcRequest& request,
    return Success();
 }
 
+// ---- chunk content-hash index -------------------------------------------
+
+// name of the persistent index file (lives at the cache root so it spans
+// documents and sessions) and a bound on its size; entries are kept in
+// execution order so the bound drops the oldest first
+#define kChunkHashIndexFile "chunk-hash-index"
+const std::size_t kMaxChunkHashIndexEntries = 500;
+
+FilePath chunkHashIndexPath()
+{
+   return notebookCacheRoot().complete(kChunkHashIndexFile);
+}
+
+json::Array readChunkHashIndex()
+{
+   FilePath indexPath = chunkHashIndexPath();
+   if (!indexPath.exists())
+      return json::Array();
+
+   std::string contents;
+   Error error = core::readStringFromFile(indexPath, &contents);
+   if (error)
+   {
+      LOG_ERROR(error);
+      return json::Array();
+   }
+
+   json::Value indexVal;
+   if (!json::parse(contents, &indexVal) ||
+       indexVal.type() != json::ArrayType)
+   {
+      return json::Array();
+   }
+
+   return indexVal.get_array();
+}
+
+void writeChunkHashIndex(const json::Array& index)
+{
+   std::ostringstream ostr;
+   json::write(index, ostr);
+   Error error = core::writeStringToFile(chunkHashIndexPath(), ostr.str());
+   if (error)
+      LOG_ERROR(error);
+}
+
 } // anonymous namespace
 
+std::string chunkContentHash(const std::string& code,
+                             const json::Object& chunkOptions)
+{
+   // the options object serializes with sorted keys, so the written form
+   // is canonical for a given set of options
+   std::ostringstream ostr;
+   json::write(chunkOptions, ostr);
+   return core::hash::crc32HexHash(code + "\n" + ostr.str());
+}
+
+void recordChunkExecutionHash(const std::string& docId,
+                              const std::string& chunkId,
+                              const std::string& nbCtxId,
+                              const std::string& contentHash)
+{
+   // resolve the document path; unsaved documents aren't indexed since
+   // their cache folders don't survive the session
+   std::string docPath;
+   Error error = source_database::getPath(docId, &docPath);
+   if (error)
+   {
+      LOG_ERROR(error);
+      return;
+   }
+   if (docPath.empty())
+      return;
+
+   // drop entries superseded by this execution: the same chunk (its output
+   // folder now holds this execution's results) or the same hash (newest
+   // result wins)
+   json::Array index = readChunkHashIndex();
+   json::Array updated;
+   BOOST_FOREACH(const json::Value& entryVal, index)
+   {
+      if (entryVal.type() != json::ObjectType)
+         continue;
+      std::string entryHash, entryDocId, entryChunkId;
+      Error entryError = json::readObject(entryVal.get_obj(),
+                                          "hash", &entryHash,
+                                          "doc_id", &entryDocId,
+                                          "chunk_id", &entryChunkId);
+      if (entryError)
+         continue;
+      if (entryHash == contentHash ||
+          (entryDocId == docId && entryChunkId == chunkId))
+      {
+         continue;
+      }
+      updated.push_back(entryVal);
+   }
+
+   json::Object entry;
+   entry["hash"] = contentHash;
+   entry["doc_path"] = docPath;
+   entry["doc_id"] = docId;
+   entry["chunk_id"] = chunkId;
+   entry["ctx_id"] = nbCtxId;
+   updated.push_back(entry);
+
+   while (updated.size() > kMaxChunkHashIndexEntries)
+      updated.erase(updated.begin());
+
+   writeChunkHashIndex(updated);
+}
+
+FilePath findCachedChunkOutput(const std::string& contentHash)
+{
+   json::Array index = readChunkHashIndex();
+   for (json::Array::reverse_iterator it = index.rbegin();
+        it != index.rend();
+        ++it)
+   {
+      if (it->type() != json::ObjectType)
+         continue;
+      std::string entryHash, docPath, docId, chunkId, ctxId;
+      Error error = json::readObject(it->get_obj(),
+                                     "hash", &entryHash,
+                                     "doc_path", &docPath,
+                                     "doc_id", &docId,
+                                     "chunk_id", &chunkId,
+                                     "ctx_id", &ctxId);
+      if (error)
+         continue;
+      if (entryHash != contentHash)
+         continue;
+
+      // verify the indexed output folder still exists (caches are swept
+      // periodically, so entries can outlive their outputs)
+      FilePath outputPath = chunkOutputPath(docPath, docId, chunkId, ctxId,
+                                            ContextSaved);
+      if (outputPath.exists())
+         return outputPath;
+   }
+
+   return FilePath();
+}
+
 FilePath notebookCacheRoot()
 { 
    return module_context::sharedScratchPath().childPath("notebooks");
@@ -675,6 +820,9 @@ Error initCache()
 
    module_context::events().onSourceEditorFileSaved.connect(onDocSaved);
 
+   // shed unused caches when the session is under memory pressure
+   module_context::events().onMemoryPressure.connect(cleanUnusedCaches);
+
    RS_REGISTER_CALL_METHOD(rs_chunkCacheFolder, 1);
 
    module_context::scheduleDelayedWork(boost::posix_time::seconds(30),
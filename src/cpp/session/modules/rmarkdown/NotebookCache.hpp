@@ -53,6 +53,8 @@
 
 #include <string>
 
+#include <core/json/Json.hpp>
+
 namespace rstudio {
 namespace core {
    class FilePath;
@@ -74,9 +76,25 @@ core::FilePath chunkCacheFolder(const std::string& docPath,
 core::FilePath chunkCacheFolder(const std::string& docPath, 
       const std::string& docId);
 
-core::FilePath chunkCacheFolder(const core::FilePath& path, 
+core::FilePath chunkCacheFolder(const core::FilePath& path,
       const std::string& docId, const std::string& nbCtxId);
 
+// content-hash index over executed chunks. records which cached output
+// folder was produced by executing a given (code, options) pair so that an
+// identical chunk -- in a later session or another copy of the document --
+// can locate that output and offer it without re-executing.
+std::string chunkContentHash(const std::string& code,
+                             const core::json::Object& chunkOptions);
+
+void recordChunkExecutionHash(const std::string& docId,
+                              const std::string& chunkId,
+                              const std::string& nbCtxId,
+                              const std::string& contentHash);
+
+// returns the output folder of a previously executed chunk with the given
+// content hash (empty path if none is recorded or it no longer exists)
+core::FilePath findCachedChunkOutput(const std::string& contentHash);
+
 core::Error initCache();
 
 } // namespace notebook
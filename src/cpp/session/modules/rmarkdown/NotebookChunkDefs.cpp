@@ -17,6 +17,9 @@
 #include "NotebookCache.hpp"
 #include "NotebookChunkDefs.hpp"
 
+#include <ctime>
+#include <map>
+
 #include <boost/foreach.hpp>
 
 #include <core/json/Json.hpp>
@@ -40,6 +43,12 @@ namespace rmarkdown {
 namespace notebook {
 namespace {
 
+// cache of parsed chunk definition files, keyed by path. the defs file is
+// re-read and re-parsed on every chunk update (setChunkDefs compares the
+// old definitions against the new ones) and on many client requests, so
+// keep the parsed contents around until the file changes on disk
+std::map<std::string, std::pair<std::time_t, json::Object> > s_chunkDefsCache;
+
 SEXP rs_getRmdWorkingDir(SEXP rmdFileSEXP, SEXP docIdSEXP)
 {
    r::sexp::Protect protect;
@@ -127,7 +136,17 @@ FilePath chunkDefinitionsPath(const std::string& docPath,
 
 Error getChunkJson(const FilePath& defs, json::Object *pJson)
 {
-   // read the defs file 
+   // check for cached contents which are still current
+   std::time_t writeTime = defs.lastWriteTime();
+   std::map<std::string, std::pair<std::time_t, json::Object> >::iterator it =
+         s_chunkDefsCache.find(defs.absolutePath());
+   if (it != s_chunkDefsCache.end() && it->second.first == writeTime)
+   {
+      *pJson = it->second.second;
+      return Success();
+   }
+
+   // read the defs file
    std::string contents;
    Error error = readStringFromFile(defs, &contents);
    if (error)
@@ -135,16 +154,36 @@ Error getChunkJson(const FilePath& defs, json::Object *pJson)
 
    // pull out the contents
    json::Value defContents;
-   if (!json::parse(contents, &defContents) || 
+   if (!json::parse(contents, &defContents) ||
        defContents.type() != json::ObjectType)
       return Error(json::errc::ParseError, ERROR_LOCATION);
 
    *pJson = defContents.get_obj();
 
+   // cache the parsed contents
+   s_chunkDefsCache[defs.absolutePath()] = std::make_pair(writeTime, *pJson);
+
+   return Success();
+}
+
+Error setChunkJson(const FilePath& defs, const json::Object& json)
+{
+   std::ostringstream oss;
+   json::write(json, oss);
+
+   Error error = writeStringToFile(defs, oss.str());
+   if (error)
+      return error;
+
+   // refresh the parsed cache in place so the write isn't followed by
+   // a re-read and re-parse on the next access
+   s_chunkDefsCache[defs.absolutePath()] =
+         std::make_pair(defs.lastWriteTime(), json);
+
    return Success();
 }
 
-Error getChunkValues(const std::string& docPath, const std::string& docId, 
+Error getChunkValues(const std::string& docPath, const std::string& docId,
       json::Object* pValues)
 
 {
@@ -206,16 +245,13 @@ Error setChunkDefs(boost::shared_ptr<source_database::SourceDocument> pDoc,
    defContents[kChunkDefs] = newDefs;
    defContents[kChunkDocWriteTime] = static_cast<boost::int64_t>(docTime);
 
-   std::ostringstream oss;
-   json::write(defContents, oss);
-
-   error = writeStringToFile(defFile, oss.str());
+   error = setChunkJson(defFile, defContents);
    if (error)
    {
       LOG_ERROR(error);
       return error;
    }
-   
+
    return Success();
 }
 
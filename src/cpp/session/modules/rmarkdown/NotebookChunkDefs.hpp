@@ -47,6 +47,10 @@ namespace notebook {
 
 core::Error getChunkJson(const core::FilePath& defs, core::json::Object *pJson);
 
+// write the defs file and refresh the parsed cache in place
+core::Error setChunkJson(const core::FilePath& defs,
+                         const core::json::Object& json);
+
 namespace {
 
 template <typename T>
@@ -149,11 +153,10 @@ core::Error setChunkValue(const std::string& docPath,
          return error;
    }
 
-   // update key and write out new contents
+   // update key and write out new contents (keeping the parsed cache
+   // current so the write isn't followed by a re-read)
    defs[key] = value;
-   std::ostringstream oss;
-   core::json::write(defs, oss);
-   return core::writeStringToFile(defFile, oss.str());
+   return setChunkJson(defFile, defs);
 }
 
 core::Error initChunkDefs();
@@ -39,6 +39,7 @@
 #include <r/RSexp.hpp>
 
 #include <core/Exec.hpp>
+#include <core/StringUtils.hpp>
 #include <core/Thread.hpp>
 
 #include <session/SessionModuleContext.hpp>
@@ -64,7 +65,17 @@ enum ChunkExecState
    ChunkExecCancelled = 2
 };
 
-// represents the global queue of work 
+// represents the global queue of work
+//
+// NOTE: chunk execution is strictly serial by design, and this isn't just
+// an implementation convenience: chunks evaluate in the session's global
+// environment (each typically depends on state left behind by its
+// predecessors), and output capture works by routing chunk code through
+// the session's own console (see ChunkExecContext and the console input
+// loopback below). executing chunks concurrently in worker processes
+// would both change evaluation semantics and bypass the capture
+// machinery, so any future parallelism needs to be designed around
+// explicit state handoff rather than bolted on here
 class NotebookQueue : boost::noncopyable
 {
 public:
@@ -143,6 +154,23 @@ public:
                execContext_->onExprComplete();
             }
 
+            // record the chunk's content hash in the notebook cache's hash
+            // index so identical chunks (in a later session or another copy
+            // of the document) can locate this output; skip chunks that
+            // produced errors
+            if (execContext_ &&
+                execUnit_->execScope() == ExecScopeChunk &&
+                !execContext_->hasErrors())
+            {
+               recordChunkExecutionHash(
+                  execUnit_->docId(),
+                  execUnit_->chunkId(),
+                  notebookCtxId(),
+                  chunkContentHash(
+                     string_utils::wideToUtf8(execUnit_->code()),
+                     execContext_->options().chunkOptions()));
+            }
+
             // unit has finished executing; remove it from the queue
             popUnit(execUnit_);
 
@@ -55,6 +55,13 @@
 #define kMathjaxSegment "mathjax"
 #define kMathjaxBeginComment "<!-- dynamically load mathjax"
 
+// NOTE: render is always invoked on the whole document. incremental
+// re-knitting (skipping chunks whose source is unchanged) cannot be
+// implemented from this side: a chunk's output depends on the state left
+// behind by the chunks before it, and tracking those dependencies is
+// knitr's job -- documents that want chunk-level reuse should set the
+// knitr cache=TRUE chunk option, which performs exactly that analysis
+// inside the render process
 #define kStandardRenderFunc "rmarkdown::render"
 #define kShinyRenderFunc "rmarkdown::run"
 
@@ -680,11 +687,22 @@ boost::shared_ptr<RenderRmd> s_pCurrentRender_;
 // generally be fast (a few milliseconds); we use this asynchronous
 // implementation in case the file system is slow (e.g. slow or remote disk)
 // or there are many thousands of packages (e.g. all of CRAN).
+// cache of discovered templates -- discovery spawns a fresh R process and
+// pays rmarkdown's load time, so once a discovery pass completes we replay
+// its results for subsequent requests and invalidate only when the package
+// library changes
+std::vector<json::Object> s_discoveredTemplates;
+bool s_templateDiscoveryComplete = false;
+
 class DiscoverTemplates : public async_r::AsyncRProcess
 {
 public:
    static boost::shared_ptr<DiscoverTemplates> create()
    {
+      // reset the cache (it will be repopulated by this discovery pass)
+      s_discoveredTemplates.clear();
+      s_templateDiscoveryComplete = false;
+
       boost::shared_ptr<DiscoverTemplates> pDiscover(new DiscoverTemplates());
       pDiscover->start("rmarkdown:::list_template_dirs()", FilePath(),
                        async_r::R_PROCESS_VANILLA);
@@ -753,6 +771,9 @@ private:
          dataJson["description"] = description;
          dataJson["create_dir"] = createDir;
 
+         // cache for replay on subsequent discovery requests
+         s_discoveredTemplates.push_back(dataJson);
+
          // emit to the client
          ClientEvent event(client_events::kRmdTemplateDiscovered, dataJson);
          module_context::enqueClientEvent(event);
@@ -761,6 +782,10 @@ private:
 
    void onCompleted(int exitStatus)
    {
+      // only mark the cache usable if discovery ran to completion
+      if (exitStatus == EXIT_SUCCESS)
+         s_templateDiscoveryComplete = true;
+
       module_context::enqueClientEvent(
                ClientEvent(client_events::kRmdTemplateDiscoveryCompleted));
    }
@@ -1140,6 +1165,19 @@ Error discoverRmdTemplates(const json::JsonRpcRequest&,
    {
       pResponse->setResult(false);
    }
+   else if (s_templateDiscoveryComplete)
+   {
+      // replay the cached results rather than spawning another R process
+      // (the cache is invalidated when the package library changes)
+      BOOST_FOREACH(const json::Object& dataJson, s_discoveredTemplates)
+      {
+         module_context::enqueClientEvent(
+               ClientEvent(client_events::kRmdTemplateDiscovered, dataJson));
+      }
+      module_context::enqueClientEvent(
+               ClientEvent(client_events::kRmdTemplateDiscoveryCompleted));
+      pResponse->setResult(true);
+   }
    else
    {
       s_pTemplateDiscovery_ = DiscoverTemplates::create();
@@ -1149,6 +1187,14 @@ Error discoverRmdTemplates(const json::JsonRpcRequest&,
    return Success();
 }
 
+void onPackageLibraryMutated()
+{
+   // package installs and removals can add or remove templates, so force a
+   // fresh discovery pass on the next request
+   s_discoveredTemplates.clear();
+   s_templateDiscoveryComplete = false;
+}
+
 Error createRmdFromTemplate(const json::JsonRpcRequest& request,
                             json::JsonRpcResponse* pResponse)
 {
@@ -1408,6 +1454,8 @@ Error initialize()
                                         .connect(onDetectRmdSourceType);
    module_context::events().onClientInit.connect(onClientInit);
    module_context::events().onShutdown.connect(onShutdown);
+   module_context::events().onPackageLibraryMutated.connect(
+                                 onPackageLibraryMutated);
    module_context::addSuspendHandler(SuspendHandler(onSuspend, onResume));
 
    // load output paths if saved
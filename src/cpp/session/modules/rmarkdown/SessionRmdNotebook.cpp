@@ -128,6 +128,58 @@ Error refreshChunkOutput(const json::JsonRpcRequest& request,
    return Success();
 }
 
+// offers the output of a previously executed identical chunk: if the
+// content-hash index has an entry for (code, options) -- possibly recorded
+// in an earlier session or against another copy of the document -- the
+// indexed output folder is copied into this chunk's output folder and
+// replayed to the client. returns whether output was adopted. note that
+// adopted output does not reproduce the chunk's side effects in the R
+// session, so the client should present it as cached rather than silently
+// substituting it for execution.
+Error adoptCachedChunkOutput(const json::JsonRpcRequest& request,
+                             json::JsonRpcResponse* pResponse)
+{
+   std::string docPath, docId, chunkId, requestId, code;
+   json::Object chunkOptions;
+   Error error = json::readParams(request.params, &docPath, &docId, &chunkId,
+         &requestId, &code, &chunkOptions);
+   if (error)
+      return error;
+
+   pResponse->setResult(false);
+
+   // look for output recorded against an identical (code, options) pair
+   FilePath cachedOutput = findCachedChunkOutput(
+                                    chunkContentHash(code, chunkOptions));
+   if (cachedOutput.empty())
+      return Success();
+
+   // copy it into this chunk's output folder (unless the index pointed
+   // right back at this chunk)
+   FilePath outputPath = chunkOutputPath(docPath, docId, chunkId,
+                                         notebookCtxId(), ContextExact);
+   if (cachedOutput != outputPath)
+   {
+      error = outputPath.removeIfExists();
+      if (error)
+         return error;
+      error = outputPath.ensureDirectory();
+      if (error)
+         return error;
+      error = cachedOutput.copyDirectoryRecursive(outputPath);
+      if (error)
+         return error;
+   }
+
+   // replay the adopted output to the client once the response is sent
+   pResponse->setAfterResponse(
+         boost::bind(enqueueChunkOutput, docPath, docId, chunkId,
+                     notebookCtxId(), requestId));
+
+   pResponse->setResult(true);
+   return Success();
+}
+
 void emitOutputFinished(const std::string& docId, const std::string& chunkId,
       int scope)
 {
@@ -177,6 +229,8 @@ Error initialize()
    ExecBlock initBlock;
    initBlock.addFunctions()
       (bind(registerRpcMethod, "refresh_chunk_output", refreshChunkOutput))
+      (bind(registerRpcMethod, "adopt_cached_chunk_output",
+            adoptCachedChunkOutput))
       (bind(module_context::sourceModuleRFile, "SessionRmdNotebook.R"))
       (bind(initOutput))
       (bind(initCache))
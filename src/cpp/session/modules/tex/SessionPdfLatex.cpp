@@ -20,6 +20,7 @@
 
 #include <core/system/Environment.hpp>
 #include <core/FileSerializer.hpp>
+#include <core/Hash.hpp>
 
 #include <session/projects/SessionProjects.hpp>
 
@@ -245,6 +246,25 @@ bool logIncludesRerun(const FilePath& logFilePath)
    return logContents.find("Rerun to get") != std::string::npos;
 }
 
+// hash of a file's contents (empty if the file doesn't exist) -- used to
+// skip makeindex passes whose input is unchanged (latex rewrites the .idx
+// on every pass, usually with identical contents)
+std::string fileContentsHash(const FilePath& filePath)
+{
+   if (!filePath.exists())
+      return std::string();
+
+   std::string contents;
+   Error error = core::readStringFromFile(filePath, &contents);
+   if (error)
+   {
+      LOG_ERROR(error);
+      return std::string();
+   }
+
+   return core::hash::crc32Hash(contents);
+}
+
 } // anonymous namespace
 
 const char * const kFileLineErrorOption = "-file-line-error";
@@ -386,11 +406,26 @@ core::Error texToPdf(const core::FilePath& texProgramPath,
    int misses = countCitationMisses(logFilePath);
    int previousMisses = 0;
 
+   // hash of the .idx contents as of the last makeindex run
+   std::string indexedIdxHash;
+
    // resolve citation misses and index
    for (int i=0; i<10; i++)
    {
+      // determine what work (if any) this iteration has to do -- if the
+      // aux files have already reached fixpoint (no unresolved citations,
+      // no new index input, no rerun hint in the log) then another latex
+      // pass would just reproduce the same output, so stop here
+      bool needBibtex = misses > 0 && !bibtexProgramPath.empty();
+      std::string idxHash = fileContentsHash(idxFilePath);
+      bool needMakeindex = !idxHash.empty() &&
+                           !makeindexProgramPath.empty() &&
+                           idxHash != indexedIdxHash;
+      if (!needBibtex && !needMakeindex && !logIncludesRerun(logFilePath))
+         break;
+
       // run bibtex if necessary
-      if (misses > 0 && !bibtexProgramPath.empty())
+      if (needBibtex)
       {
          core::system::ProcessResult result;
          Error error = core::system::runProgram(
@@ -407,7 +442,7 @@ core::Error texToPdf(const core::FilePath& texProgramPath,
       previousMisses = misses;
 
       // run makeindex if necessary
-      if (idxFilePath.exists() && !makeindexProgramPath.empty())
+      if (needMakeindex)
       {
          Error error = core::system::runProgram(
                string_utils::utf8ToSystem(makeindexProgramPath.absolutePath()),
@@ -419,6 +454,8 @@ core::Error texToPdf(const core::FilePath& texProgramPath,
             LOG_ERROR(error);
          else if (pResult->exitStatus != EXIT_SUCCESS)
             return Success(); // pass error state on to caller
+         else
+            indexedIdxHash = idxHash;
       }
 
       // re-run latex
@@ -15,6 +15,10 @@
 
 #include "SessionSynctex.hpp"
 
+#include <ctime>
+
+#include <boost/shared_ptr.hpp>
+
 #include <core/Error.hpp>
 #include <core/FilePath.hpp>
 #include <core/Exec.hpp>
@@ -38,6 +42,33 @@ namespace synctex {
 
 namespace {
 
+// cache of the most recently parsed synctex scanner -- parsing a large
+// .synctex.gz takes seconds, and forward/inverse searches arrive in bursts
+// against the same pdf. keyed on the pdf path and invalidated when the pdf
+// is rewritten (recompiles rewrite the pdf and its synctex file together)
+boost::shared_ptr<core::tex::Synctex> s_pSynctex;
+std::string s_synctexPdfPath;
+std::time_t s_synctexPdfWriteTime = 0;
+
+boost::shared_ptr<core::tex::Synctex> synctexForPdf(const FilePath& pdfFile)
+{
+   if (s_pSynctex &&
+       s_synctexPdfPath == pdfFile.absolutePath() &&
+       s_synctexPdfWriteTime == pdfFile.lastWriteTime())
+   {
+      return s_pSynctex;
+   }
+
+   boost::shared_ptr<core::tex::Synctex> pSynctex(new core::tex::Synctex());
+   if (!pSynctex->parse(pdfFile))
+      return boost::shared_ptr<core::tex::Synctex>();
+
+   s_pSynctex = pSynctex;
+   s_synctexPdfPath = pdfFile.absolutePath();
+   s_synctexPdfWriteTime = pdfFile.lastWriteTime();
+   return pSynctex;
+}
+
 json::Value toJson(const FilePath& pdfFile,
                    const core::tex::PdfLocation& pdfLoc,
                    bool fromClick)
@@ -245,8 +276,8 @@ Error synctexInverseSearch(const json::JsonRpcRequest& request,
       return error;
    FilePath pdfPath = module_context::resolveAliasedPath(file);
 
-   core::tex::Synctex synctex;
-   if (synctex.parse(pdfPath))
+   boost::shared_ptr<core::tex::Synctex> pSynctex = synctexForPdf(pdfPath);
+   if (pSynctex)
    {
       if (!fromClick)
       {
@@ -254,14 +285,14 @@ Error synctexInverseSearch(const json::JsonRpcRequest& request,
          // the passed x and y coordinates since they represent the
          // top of the user-visible content (in case the page is
          // scrolled down from the top)
-         core::tex::PdfLocation contLoc = synctex.topOfPageContent(page);
+         core::tex::PdfLocation contLoc = pSynctex->topOfPageContent(page);
          x = std::max((float)x, contLoc.x());
          y = std::max((float)y, contLoc.y());
       }
 
       core::tex::PdfLocation pdfLocation(page, x, y, width, height);
 
-      core::tex::SourceLocation srcLoc = synctex.inverseSearch(pdfLocation);
+      core::tex::SourceLocation srcLoc = pSynctex->inverseSearch(pdfLocation);
       applyInverseConcordance(&srcLoc);
 
       pResponse->setResult(toJson(srcLoc));
@@ -324,13 +355,13 @@ Error forwardSearch(const FilePath& rootFile,
    // determine pdf
    FilePath pdfFile = rootFile.parent().complete(rootFile.stem() + ".pdf");
 
-   core::tex::Synctex synctex;
-   if (synctex.parse(pdfFile))
+   boost::shared_ptr<core::tex::Synctex> pSynctex = synctexForPdf(pdfFile);
+   if (pSynctex)
    {
       core::tex::SourceLocation srcLoc(inputFile, line, column);
       applyForwardConcordance(rootFile, &srcLoc);
 
-      core::tex::PdfLocation pdfLoc = synctex.forwardSearch(srcLoc);
+      core::tex::PdfLocation pdfLoc = pSynctex->forwardSearch(srcLoc);
       *pPdfLocation = toJson(pdfFile, pdfLoc, fromClick);
    }
    else
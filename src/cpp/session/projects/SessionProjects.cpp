@@ -522,15 +522,24 @@ void onFilesChanged(const std::vector<core::system::FileChangeEvent>& events)
       if (event.fileInfo().absolutePath() ==
           s_projectContext.file().absolutePath())
       {
+         // capture prefs prior to the sync so we can detect whether the
+         // project file edit actually touched them (edits to other
+         // fields, e.g. build options, don't require the client to
+         // re-apply every project pref)
+         json::Object previousUiPrefs = s_projectContext.uiPrefs();
+
          // update project context
          syncProjectFileChanges();
 
          // fire event to client
-         json::Object dataJson;
-         dataJson["type"] = "project";
-         dataJson["prefs"] = s_projectContext.uiPrefs();
-         ClientEvent event(client_events::kUiPrefsChanged, dataJson);
-         module_context::enqueClientEvent(event);
+         if (s_projectContext.uiPrefs() != previousUiPrefs)
+         {
+            json::Object dataJson;
+            dataJson["type"] = "project";
+            dataJson["prefs"] = s_projectContext.uiPrefs();
+            ClientEvent event(client_events::kUiPrefsChanged, dataJson);
+            module_context::enqueClientEvent(event);
+         }
 
          break;
       }
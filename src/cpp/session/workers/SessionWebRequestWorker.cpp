@@ -13,8 +13,27 @@
  *
  */
 
+#include <sstream>
+#include <string>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
 #include <core/Error.hpp>
+#include <core/FilePath.hpp>
+#include <core/FileSerializer.hpp>
+#include <core/Hash.hpp>
+#include <core/Log.hpp>
+#include <core/SafeConvert.hpp>
 
+#include <core/http/Request.hpp>
+#include <core/http/Response.hpp>
+#include <core/http/URL.hpp>
+#include <core/http/Util.hpp>
+#include <core/http/TcpIpBlockingClient.hpp>
+#include <core/http/TcpIpBlockingClientSsl.hpp>
+
+#include <session/SessionOptions.hpp>
 #include <session/SessionWorkerContext.hpp>
 
 using namespace rstudio::core;
@@ -26,16 +45,262 @@ namespace web_request {
 
 namespace {
 
+// cached response entry (one json file per url in the web-cache
+// directory within user scratch, so all of a user's sessions on the
+// host share it). NOTE: the cache deliberately lives in per-user
+// rather than host-global storage -- a world-writable shared cache
+// would let any user on the host poison responses served to others
+struct CacheEntry
+{
+   CacheEntry() : status(0) {}
+   int status;
+   std::string contentType;
+   std::string eTag;
+   std::string lastModified;
+   boost::posix_time::ptime expires;
+   std::string body;
+};
+
+FilePath webCacheDir()
+{
+   FilePath cacheDir = options().userScratchPath().complete("web-cache");
+   Error error = cacheDir.ensureDirectory();
+   if (error)
+      LOG_ERROR(error);
+   return cacheDir;
+}
+
+FilePath cacheEntryPath(const std::string& url)
+{
+   // content-addressed by url hash
+   return webCacheDir().complete(hash::crc32HexHash(url) + ".json");
+}
+
+double millisSinceEpoch(const boost::posix_time::ptime& time)
+{
+   boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+   return static_cast<double>((time - epoch).total_milliseconds());
+}
+
+boost::posix_time::ptime timeFromMillisSinceEpoch(double millis)
+{
+   boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+   return epoch + boost::posix_time::milliseconds(
+                                       static_cast<boost::int64_t>(millis));
+}
+
+bool readCacheEntry(const std::string& url, CacheEntry* pEntry)
+{
+   FilePath entryPath = cacheEntryPath(url);
+   if (!entryPath.exists())
+      return false;
+
+   std::string contents;
+   Error error = readStringFromFile(entryPath, &contents);
+   if (error)
+      return false;
+
+   json::Value entryJson;
+   if (!json::parse(contents, &entryJson) ||
+       !json::isType<json::Object>(entryJson))
+   {
+      return false;
+   }
+
+   std::string cachedUrl;
+   double expiresMillis = 0;
+   error = json::readObject(entryJson.get_obj(),
+                            "url", &cachedUrl,
+                            "status", &pEntry->status,
+                            "content_type", &pEntry->contentType,
+                            "etag", &pEntry->eTag,
+                            "last_modified", &pEntry->lastModified,
+                            "expires", &expiresMillis,
+                            "body", &pEntry->body);
+   if (error)
+      return false;
+
+   // guard against a (crc32) hash collision
+   if (cachedUrl != url)
+      return false;
+
+   pEntry->expires = timeFromMillisSinceEpoch(expiresMillis);
+   return true;
+}
+
+void writeCacheEntry(const std::string& url, const CacheEntry& entry)
+{
+   json::Object entryJson;
+   entryJson["url"] = url;
+   entryJson["status"] = entry.status;
+   entryJson["content_type"] = entry.contentType;
+   entryJson["etag"] = entry.eTag;
+   entryJson["last_modified"] = entry.lastModified;
+   entryJson["expires"] = millisSinceEpoch(entry.expires);
+   entryJson["body"] = entry.body;
+
+   std::ostringstream ostr;
+   json::write(entryJson, ostr);
+
+   // write to a temp file then move into place so concurrent sessions
+   // never observe a partially written entry
+   FilePath tempPath;
+   Error error = FilePath::tempFilePath(&tempPath);
+   if (!error)
+      error = writeStringToFile(tempPath, ostr.str());
+   if (!error)
+      error = tempPath.move(cacheEntryPath(url));
+   if (error)
+      LOG_ERROR(error);
+}
+
+// compute the expiry of a fetched response from its cache headers
+// (Cache-Control max-age wins over Expires per rfc 2616). responses
+// with no freshness information expire immediately, which means we
+// still consult the origin but can revalidate rather than re-download
+boost::posix_time::ptime responseExpiry(const http::Response& response)
+{
+   boost::posix_time::ptime now =
+                     boost::posix_time::microsec_clock::universal_time();
+
+   std::string cacheControl = response.headerValue("Cache-Control");
+   std::string::size_type pos = cacheControl.find("max-age=");
+   if (pos != std::string::npos)
+   {
+      std::string maxAge = cacheControl.substr(pos + 8);
+      maxAge = maxAge.substr(0, maxAge.find(','));
+      return now + boost::posix_time::seconds(
+                        safe_convert::stringTo<long>(maxAge, 0));
+   }
+
+   std::string expires = response.headerValue("Expires");
+   if (!expires.empty())
+   {
+      boost::posix_time::ptime expiry = http::util::parseHttpDate(expires);
+      if (!expiry.is_not_a_date_time())
+         return expiry;
+   }
+
+   return now;
+}
+
+bool isCacheable(const http::Response& response)
+{
+   std::string cacheControl = response.headerValue("Cache-Control");
+   return cacheControl.find("no-store") == std::string::npos &&
+          cacheControl.find("private") == std::string::npos;
+}
+
+Error sendWebRequest(const http::URL& url,
+                     const http::Request& request,
+                     http::Response* pResponse)
+{
+   std::string port = safe_convert::numberToString(url.port());
+   if (boost::algorithm::iequals(url.protocol(), "https"))
+   {
+      // no explicit port in an https url means 443, not the URL
+      // class's default of 80
+      if (url.host().find(':') == std::string::npos)
+         port = "443";
+      return http::sendSslRequest(url.hostname(), port, true,
+                                  request, pResponse);
+   }
+   else
+   {
+      return http::sendRequest(url.hostname(), port, request, pResponse);
+   }
+}
+
+void setWebRequestResult(const CacheEntry& entry,
+                         bool fromCache,
+                         json::JsonRpcResponse* pResponse)
+{
+   json::Object resultJson;
+   resultJson["status"] = entry.status;
+   resultJson["content_type"] = entry.contentType;
+   resultJson["content"] = entry.body;
+   resultJson["from_cache"] = fromCache;
+   pResponse->setResult(resultJson);
+}
+
 Error webRequest(const json::JsonRpcRequest& request,
                  json::JsonRpcResponse* pResponse)
 {
+   // read the url param
+   std::string url;
+   Error error = json::readParams(request.params, &url);
+   if (error)
+      return error;
+
+   // validate it
+   http::URL parsedUrl(url);
+   if (!parsedUrl.isValid())
+      return Error(json::errc::ParamInvalid, ERROR_LOCATION);
+
+   // serve directly from the shared cache while the entry is fresh
+   boost::posix_time::ptime now =
+                     boost::posix_time::microsec_clock::universal_time();
+   CacheEntry entry;
+   bool haveEntry = readCacheEntry(url, &entry);
+   if (haveEntry && now < entry.expires)
+   {
+      setWebRequestResult(entry, true, pResponse);
+      return Success();
+   }
 
+   // fetch from the origin (conditionally if we have a stale entry)
+   http::Request httpRequest;
+   httpRequest.setMethod("GET");
+   httpRequest.setUri(parsedUrl.path().empty() ? "/" : parsedUrl.path());
+   httpRequest.setHost(parsedUrl.host());
+   httpRequest.setHeader("Accept", "*/*");
+   httpRequest.setHeader("Connection", "close");
+   if (haveEntry)
+   {
+      if (!entry.eTag.empty())
+         httpRequest.setHeader("If-None-Match", entry.eTag);
+      if (!entry.lastModified.empty())
+         httpRequest.setHeader("If-Modified-Since", entry.lastModified);
+   }
 
+   http::Response httpResponse;
+   error = sendWebRequest(parsedUrl, httpRequest, &httpResponse);
+   if (error)
+   {
+      // serve a stale entry rather than failing outright if the
+      // origin is unreachable
+      if (haveEntry)
+      {
+         setWebRequestResult(entry, true, pResponse);
+         return Success();
+      }
+      return error;
+   }
 
+   // not modified -- extend the cached entry's freshness and serve it
+   if (haveEntry && httpResponse.statusCode() == http::status::NotModified)
+   {
+      entry.expires = responseExpiry(httpResponse);
+      writeCacheEntry(url, entry);
+      setWebRequestResult(entry, true, pResponse);
+      return Success();
+   }
+
+   // full response -- cache it if its headers permit
+   entry.status = httpResponse.statusCode();
+   entry.contentType = httpResponse.contentType();
+   entry.eTag = httpResponse.headerValue("ETag");
+   entry.lastModified = httpResponse.headerValue("Last-Modified");
+   entry.expires = responseExpiry(httpResponse);
+   entry.body = httpResponse.body();
+   if (entry.status == http::status::Ok && isCacheable(httpResponse))
+      writeCacheEntry(url, entry);
+
+   setWebRequestResult(entry, false, pResponse);
    return Success();
 }
 
-} // anonymouys namespace
+} // anonymous namespace
 
 Error initialize()
 {
@@ -46,7 +311,3 @@ Error initialize()
 } // namespace workers
 } // namespace session
 } // namespace rstudio
-
-
-
-
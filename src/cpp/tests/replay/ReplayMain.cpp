@@ -0,0 +1,240 @@
+/*
+ * ReplayMain.cpp
+ *
+ * Copyright (C) 2009-16 by RStudio, Inc.
+ *
+ * Unless you have received this program directly from RStudio pursuant
+ * to the terms of a commercial license agreement with RStudio, then
+ * this program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http://www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ *
+ */
+
+// replays json-rpc traffic captured from a live session (via the
+// RSTUDIO_SESSION_TRAFFIC_LOG tap in the session http connection
+// listener) against a session listening on tcp, preserving the
+// captured inter-request pacing scaled by a speed multiplier, and
+// reports per-request latencies. typical usage:
+//
+//   RSTUDIO_SESSION_TRAFFIC_LOG=/tmp/traffic.log rsession ...
+//   rstudio-session-replay /tmp/traffic.log localhost 8787 2.0
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+
+#include <core/Error.hpp>
+#include <core/Log.hpp>
+#include <core/FilePath.hpp>
+#include <core/FileSerializer.hpp>
+#include <core/SafeConvert.hpp>
+#include <core/system/System.hpp>
+
+#include <core/http/Request.hpp>
+#include <core/http/Response.hpp>
+#include <core/http/TcpIpBlockingClient.hpp>
+
+#include <core/json/JsonRpc.hpp>
+
+using namespace rstudio;
+using namespace rstudio::core;
+
+namespace {
+
+// one captured request (see connection::logTrafficIfEnabled)
+struct TrafficRecord
+{
+   TrafficRecord() : time(0) {}
+   double time;  // milliseconds since the unix epoch
+   std::string method;
+   std::string uri;
+   std::string body;
+};
+
+Error readTrafficLog(const FilePath& logPath,
+                     std::vector<TrafficRecord>* pRecords)
+{
+   std::string contents;
+   Error error = readStringFromFile(logPath, &contents);
+   if (error)
+      return error;
+
+   std::istringstream istr(contents);
+   std::string line;
+   while (std::getline(istr, line))
+   {
+      if (line.empty())
+         continue;
+
+      json::Value recordJson;
+      if (!json::parse(line, &recordJson) ||
+          !json::isType<json::Object>(recordJson))
+      {
+         LOG_WARNING_MESSAGE("Skipping malformed traffic record: " + line);
+         continue;
+      }
+
+      TrafficRecord record;
+      error = json::readObject(recordJson.get_obj(),
+                               "time", &record.time,
+                               "method", &record.method,
+                               "uri", &record.uri,
+                               "body", &record.body);
+      if (error)
+      {
+         LOG_ERROR(error);
+         continue;
+      }
+
+      pRecords->push_back(record);
+   }
+
+   return Success();
+}
+
+double percentile(const std::vector<double>& sorted, double p)
+{
+   if (sorted.empty())
+      return 0;
+   std::size_t index = static_cast<std::size_t>(p * (sorted.size() - 1));
+   return sorted[index];
+}
+
+} // anonymous namespace
+
+
+int main(int argc, char** argv)
+{
+   core::system::initializeStderrLog("rstudio-session-replay",
+                                     core::system::kLogLevelWarning);
+
+   // ignore SIGPIPE
+   Error error = core::system::ignoreSignal(core::system::SigPipe);
+   if (error)
+      LOG_ERROR(error);
+
+   if (argc < 4)
+   {
+      std::cerr << "usage: rstudio-session-replay "
+                << "<traffic-log> <host> <port> [speed]" << std::endl
+                << "  speed is a multiplier applied to the captured "
+                << "pacing (2.0 = twice as fast, default 1.0)" << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   FilePath logPath(argv[1]);
+   std::string host(argv[2]);
+   std::string port(argv[3]);
+   double speed = (argc > 4)
+               ? safe_convert::stringTo<double>(argv[4], 1.0)
+               : 1.0;
+   if (speed <= 0)
+      speed = 1.0;
+
+   // read the captured traffic
+   std::vector<TrafficRecord> records;
+   error = readTrafficLog(logPath, &records);
+   if (error)
+   {
+      LOG_ERROR(error);
+      return EXIT_FAILURE;
+   }
+   if (records.empty())
+   {
+      std::cerr << "No traffic records found in "
+                << logPath.absolutePath() << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   // replay, preserving scaled inter-request pacing
+   using namespace boost::posix_time;
+   ptime startTime = microsec_clock::universal_time();
+   double firstCaptureTime = records[0].time;
+
+   std::vector<double> latencies;
+   int errorCount = 0, httpErrorCount = 0, skippedCount = 0;
+
+   for (std::size_t i = 0; i < records.size(); i++)
+   {
+      const TrafficRecord& record = records[i];
+
+      // skip event long-polls -- they block on the server for up to
+      // ~50 seconds and so would serialize the replay rather than
+      // exercise it
+      if (record.uri.find("events/get_events") != std::string::npos)
+      {
+         skippedCount++;
+         continue;
+      }
+
+      // wait until this request is due
+      long dueMs = static_cast<long>(
+                     (record.time - firstCaptureTime) / speed);
+      time_duration elapsed = microsec_clock::universal_time() - startTime;
+      if (elapsed.total_milliseconds() < dueMs)
+      {
+         boost::this_thread::sleep(
+            milliseconds(dueMs - elapsed.total_milliseconds()));
+      }
+
+      // send the request and time the round trip
+      http::Request request;
+      request.setMethod(record.method);
+      request.setUri(record.uri);
+      request.setHost(host);
+      request.setHeader("Connection", "close");
+      if (!record.body.empty())
+      {
+         request.setContentType("application/json");
+         request.setBody(record.body);
+      }
+
+      http::Response response;
+      ptime sendTime = microsec_clock::universal_time();
+      error = http::sendRequest(host, port, request, &response);
+      time_duration roundTrip = microsec_clock::universal_time() - sendTime;
+
+      if (error)
+      {
+         LOG_ERROR(error);
+         errorCount++;
+         continue;
+      }
+      if (response.statusCode() != http::status::Ok)
+         httpErrorCount++;
+
+      latencies.push_back(
+         static_cast<double>(roundTrip.total_microseconds()) / 1000.0);
+   }
+
+   // report latencies
+   std::sort(latencies.begin(), latencies.end());
+   double totalMs = 0;
+   for (std::size_t i = 0; i < latencies.size(); i++)
+      totalMs += latencies[i];
+
+   std::cout << "Replayed " << latencies.size() << " requests at "
+             << speed << "x ("
+             << skippedCount << " event polls skipped, "
+             << errorCount << " send errors, "
+             << httpErrorCount << " non-200 responses)" << std::endl;
+   if (!latencies.empty())
+   {
+      std::cout << "Latency (ms): "
+                << "min=" << latencies.front()
+                << " mean=" << (totalMs / latencies.size())
+                << " median=" << percentile(latencies, 0.5)
+                << " p90=" << percentile(latencies, 0.9)
+                << " max=" << latencies.back() << std::endl;
+   }
+
+   return (errorCount == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}